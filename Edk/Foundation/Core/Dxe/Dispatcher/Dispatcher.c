@@ -560,6 +560,12 @@ Returns:
     }
   } while (ReadyToRun);
 
+  //
+  // The streams cached for the drivers just dispatched are not needed
+  // any more
+  //
+  CoreFlushSectionCache ();
+
   mDispatcherRunning = FALSE;
 
   return ReturnStatus;
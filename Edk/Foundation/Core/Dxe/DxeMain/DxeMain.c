@@ -916,6 +916,11 @@ Returns:
     ASSERT_EFI_ERROR (Status);
   }  
 
+  //
+  // Report how much work ConnectController() did during this boot
+  //
+  CoreDumpDriverBindingStatistics ();
+
   //
   // Terminate memory services if the MapKey matches
   //
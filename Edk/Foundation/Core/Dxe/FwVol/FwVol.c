@@ -221,6 +221,7 @@ Returns:
   EFI_FFS_FILE_STATE                    FileState;
   UINT8                                 *TopFvAddress;
   UINTN                                 TestLength;
+  FFS_FILE_LIST_ENTRY                   **HashTail;
 
 
   Fvb = FvDevice->Fvb;
@@ -305,6 +306,10 @@ Returns:
   //
   Status = EFI_SUCCESS;
   InitializeListHead (&FvDevice->FfsFileListHeader);
+  for (Index = 0; Index <= EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE; Index++) {
+    InitializeListHead (&FvDevice->FfsFileTypeList[Index]);
+  }
+  EfiCommonLibZeroMem (FvDevice->FfsFileHash, sizeof (FvDevice->FfsFileHash));
 
   //
   // Build FFS list
@@ -371,6 +376,24 @@ Returns:
     
       FfsFileEntry->FfsHeader = FfsHeader;
       InsertTailList (&FvDevice->FfsFileListHeader, &FfsFileEntry->Link);
+
+      //
+      // Index the file by type and by name. Files are appended, so the
+      // first file found by either index is the first one in the volume.
+      //
+      InitializeListHead (&FfsFileEntry->TypeLink);
+      if ((FfsHeader->Type != EFI_FV_FILETYPE_ALL) &&
+          (FfsHeader->Type <= EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE)) {
+        InsertTailList (&FvDevice->FfsFileTypeList[FfsHeader->Type], &FfsFileEntry->TypeLink);
+      }
+
+      if (FfsHeader->Type != EFI_FV_FILETYPE_FFS_PAD) {
+        HashTail = &FvDevice->FfsFileHash[FFS_FILE_HASH (&FfsHeader->Name)];
+        while (*HashTail != NULL) {
+          HashTail = &(*HashTail)->HashNext;
+        }
+        *HashTail = FfsFileEntry;
+      }
     }
 
     FfsHeader =  (EFI_FFS_FILE_HEADER *)(((UINT8 *)FfsHeader) + FileLength);
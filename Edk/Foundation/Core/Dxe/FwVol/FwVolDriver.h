@@ -46,13 +46,35 @@ Abstract:
 //
 // Used to track all non-deleted files
 //
-typedef struct {
+typedef struct _FFS_FILE_LIST_ENTRY {
   EFI_LIST_ENTRY                  Link;
   EFI_FFS_FILE_HEADER             *FfsHeader;
   UINTN                           StreamHandle;
   EFI_SECTION_EXTRACTION_PROTOCOL *Sep;
+  //
+  // Link in the list of the files of the same type, only used for the
+  // types up to EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE
+  //
+  EFI_LIST_ENTRY                  TypeLink;
+  //
+  // Next file in the same bucket of the name hash
+  //
+  struct _FFS_FILE_LIST_ENTRY     *HashNext;
 } FFS_FILE_LIST_ENTRY;
 
+#define FFS_FILE_ENTRY_FROM_TYPE_LINK(a)  _CR(a, FFS_FILE_LIST_ENTRY, TypeLink)
+
+//
+// Number of buckets of the file name hash, must be 2^n
+//
+#define FFS_FILE_HASH_SIZE      64
+//
+// The name may come from a device path node, so it is read a byte at a time
+//
+#define FFS_FILE_HASH(Guid)     \
+  ((((UINT8 *) (Guid))[0] ^ ((UINT8 *) (Guid))[5] ^ \
+    ((UINT8 *) (Guid))[10] ^ ((UINT8 *) (Guid))[15]) & (FFS_FILE_HASH_SIZE - 1))
+
 typedef struct {
   UINTN                                   Signature;
   EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL      *Fvb;
@@ -71,6 +93,13 @@ typedef struct {
   EFI_LIST_ENTRY                          FfsFileListHeader;
 
   UINT8                                   ErasePolarity;
+
+  //
+  // Indexes over FfsFileListHeader built by FvCheck, both keep the order
+  // of the files in the volume. Pad files are in neither of them.
+  //
+  EFI_LIST_ENTRY                          FfsFileTypeList[EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE + 1];
+  FFS_FILE_LIST_ENTRY                     *FfsFileHash[FFS_FILE_HASH_SIZE];
 } FV_DEVICE;
 
 #define FV_DEVICE_FROM_THIS(a) CR(a, FV_DEVICE, Fv, FV_DEVICE_SIGNATURE)
@@ -42,6 +42,116 @@ Required Alignment    Alignment Value in FFS       Alignment Value in
 
 UINT8 mFvAttributes[] = {0, 4, 7, 9, 10, 12, 15, 16}; 
 
+STATIC
+FFS_FILE_LIST_ENTRY *
+FvFindNextFile (
+  IN FV_DEVICE                      *FvDevice,
+  IN FFS_FILE_LIST_ENTRY            *Key,
+  IN EFI_FV_FILETYPE                FileType
+  )
+/*++
+
+Routine Description:
+    Finds the first non-pad file after Key that matches FileType. The files
+    of one type are walked on their own list unless the previous file was
+    of another type, which happens when the caller changed the filter
+    between two GetNextFile () calls.
+
+Arguments:
+    FvDevice      -   The firmware volume device.
+    Key           -   The file to start after, NULL to start at the first
+                      file of the volume.
+    FileType      -   The type of file to search for, 0 for all types.
+
+Returns:
+    The file list entry found, NULL if there is none.
+
+--*/
+{
+  EFI_LIST_ENTRY                    *Link;
+  EFI_LIST_ENTRY                    *TypeList;
+  FFS_FILE_LIST_ENTRY               *FfsFileEntry;
+
+  if (FileType != EFI_FV_FILETYPE_ALL) {
+    TypeList = &FvDevice->FfsFileTypeList[FileType];
+    if (Key == NULL) {
+      Link = TypeList;
+    } else if (Key->FfsHeader->Type == FileType) {
+      Link = &Key->TypeLink;
+    } else {
+      Link = NULL;
+    }
+
+    if (Link != NULL) {
+      if (Link->ForwardLink == TypeList) {
+        return NULL;
+      }
+      return FFS_FILE_ENTRY_FROM_TYPE_LINK (Link->ForwardLink);
+    }
+  }
+
+  Link = (Key == NULL) ? &FvDevice->FfsFileListHeader : &Key->Link;
+  while (Link->ForwardLink != &FvDevice->FfsFileListHeader) {
+    Link = Link->ForwardLink;
+    FfsFileEntry = (FFS_FILE_LIST_ENTRY *) Link;
+
+    //
+    // we ignore pad files
+    //
+    if (FfsFileEntry->FfsHeader->Type == EFI_FV_FILETYPE_FFS_PAD) {
+      continue;
+    }
+
+    if ((FileType == EFI_FV_FILETYPE_ALL) || (FileType == FfsFileEntry->FfsHeader->Type)) {
+      return FfsFileEntry;
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+EFI_STATUS
+FvGetFileKeyByName (
+  IN  FV_DEVICE                     *FvDevice,
+  IN  EFI_GUID                      *NameGuid,
+  OUT FFS_FILE_LIST_ENTRY           **Key
+  )
+/*++
+
+Routine Description:
+    Looks a file up in the name index of the volume and returns the key
+    with which GetNextFile () for all file types returns that file.
+
+Arguments:
+    FvDevice      -   The firmware volume device.
+    NameGuid      -   The name of the file.
+    Key           -   Returns the key, the file right before the one found
+                      or NULL if it is the first file of the volume.
+
+Returns:
+    EFI_SUCCESS   -   The file is found.
+    EFI_NOT_FOUND -   There is no file with that name.
+
+--*/
+{
+  FFS_FILE_LIST_ENTRY               *FfsFileEntry;
+
+  FfsFileEntry = FvDevice->FfsFileHash[FFS_FILE_HASH (NameGuid)];
+  while (FfsFileEntry != NULL) {
+    if (EfiCompareGuid (&FfsFileEntry->FfsHeader->Name, NameGuid)) {
+      *Key = NULL;
+      if (FfsFileEntry->Link.BackLink != &FvDevice->FfsFileListHeader) {
+        *Key = (FFS_FILE_LIST_ENTRY *) FfsFileEntry->Link.BackLink;
+      }
+      return EFI_SUCCESS;
+    }
+    FfsFileEntry = FfsFileEntry->HashNext;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
 
 STATIC
 EFI_FV_FILE_ATTRIBUTES
@@ -129,7 +239,6 @@ Returns:
   EFI_FV_ATTRIBUTES                           FvAttributes;
   EFI_FFS_FILE_HEADER                         *FfsFileHeader;
   UINTN                                       *KeyValue;
-  EFI_LIST_ENTRY                              *Link;
   FFS_FILE_LIST_ENTRY                         *FfsFileEntry;
   UINTN                                       FileLength;
 
@@ -154,57 +263,23 @@ Returns:
     return EFI_NOT_FOUND;
   }
 
+  //
+  // Key is pointer to FFsFileEntry, so get next one
+  //
   KeyValue = (UINTN *)Key;
-  for (;;) {
-    if (*KeyValue == 0) {
-      //
-      // Search for 1st matching file
-      //
-      Link = &FvDevice->FfsFileListHeader;
-    } else {
-      //
-      // Key is pointer to FFsFileEntry, so get next one
-      //
-      Link = (EFI_LIST_ENTRY *)(*KeyValue);
-    }
-
-    if (Link->ForwardLink == &FvDevice->FfsFileListHeader) {
-      //
-      // Next is end of list so we did not find data
-      //
-      return EFI_NOT_FOUND;
-    }
-
-    FfsFileEntry = (FFS_FILE_LIST_ENTRY *)Link->ForwardLink;
-    FfsFileHeader = (EFI_FFS_FILE_HEADER *)FfsFileEntry->FfsHeader;
-
+  FfsFileEntry = FvFindNextFile (FvDevice, (FFS_FILE_LIST_ENTRY *)(*KeyValue), *FileType);
+  if (FfsFileEntry == NULL) {
     //
-    // remember the key
+    // Next is end of list so we did not find data
     //
-    *KeyValue = (UINTN)FfsFileEntry;
-
-    if (FfsFileHeader->Type == EFI_FV_FILETYPE_FFS_PAD) {
-      //
-      // we ignore pad files
-      //
-      continue;
-    }
-
-    if (*FileType == 0) {
-      //
-      // Process all file types so we have a match
-      //
-      break;
-    }
-
-    if (*FileType == FfsFileHeader->Type) {
-      //
-      // Found a matching file type
-      //
-      break;
-    }
+    return EFI_NOT_FOUND;
+  }
 
-  } 
+  //
+  // remember the key
+  //
+  *KeyValue = (UINTN)FfsFileEntry;
+  FfsFileHeader = (EFI_FFS_FILE_HEADER *)FfsFileEntry->FfsHeader;
 
   //
   // Return FileType, NameGuid, and Attributes
@@ -302,24 +377,27 @@ Returns:
   
 
   //
-  // Keep looking until we find the matching NameGuid.
+  // Look the file up in the name index, then let FvGetNextFile return its
+  // information by starting the search from the file right before it.
   // The Key is really an FfsFileEntry
   //
-  FvDevice->LastKey = 0;
-  do {
-    LocalFoundType = 0;
-    Status = FvGetNextFile (
-              This,
-              &FvDevice->LastKey,
-              &LocalFoundType,
-              &SearchNameGuid,
-              &LocalAttributes,
-              &FileSize
-              );
-    if (EFI_ERROR (Status)) {
-      return EFI_NOT_FOUND;
-    }
-  } while (!EfiCompareGuid (&SearchNameGuid, NameGuid));
+  Status = FvGetFileKeyByName (FvDevice, (EFI_GUID *) NameGuid, &FvDevice->LastKey);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  LocalFoundType = 0;
+  Status = FvGetNextFile (
+            This,
+            &FvDevice->LastKey,
+            &LocalFoundType,
+            &SearchNameGuid,
+            &LocalAttributes,
+            &FileSize
+            );
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
 
   //
   // Get a pointer to the header
@@ -578,7 +656,6 @@ Returns:
   EFI_FV_ATTRIBUTES                           FvAttributes;
   EFI_FFS_FILE_HEADER                         *FfsFileHeader;
   UINTN                                       *KeyValue;
-  EFI_LIST_ENTRY                              *Link;
   FFS_FILE_LIST_ENTRY                         *FfsFileEntry;
   UINTN                                       FileLength;
 
@@ -603,57 +680,23 @@ Returns:
     return EFI_NOT_FOUND;
   }
 
+  //
+  // Key is pointer to FFsFileEntry, so get next one
+  //
   KeyValue = (UINTN *)Key;
-  for (;;) {
-    if (*KeyValue == 0) {
-      //
-      // Search for 1st matching file
-      //
-      Link = &FvDevice->FfsFileListHeader;
-    } else {
-      //
-      // Key is pointer to FFsFileEntry, so get next one
-      //
-      Link = (EFI_LIST_ENTRY *)(*KeyValue);
-    }
-
-    if (Link->ForwardLink == &FvDevice->FfsFileListHeader) {
-      //
-      // Next is end of list so we did not find data
-      //
-      return EFI_NOT_FOUND;
-    }
-
-    FfsFileEntry = (FFS_FILE_LIST_ENTRY *)Link->ForwardLink;
-    FfsFileHeader = (EFI_FFS_FILE_HEADER *)FfsFileEntry->FfsHeader;
-
+  FfsFileEntry = FvFindNextFile (FvDevice, (FFS_FILE_LIST_ENTRY *)(*KeyValue), *FileType);
+  if (FfsFileEntry == NULL) {
     //
-    // remember the key
+    // Next is end of list so we did not find data
     //
-    *KeyValue = (UINTN)FfsFileEntry;
-
-    if (FfsFileHeader->Type == EFI_FV_FILETYPE_FFS_PAD) {
-      //
-      // we ignore pad files
-      //
-      continue;
-    }
-
-    if (*FileType == 0) {
-      //
-      // Process all file types so we have a match
-      //
-      break;
-    }
-
-    if (*FileType == FfsFileHeader->Type) {
-      //
-      // Found a matching file type
-      //
-      break;
-    }
+    return EFI_NOT_FOUND;
+  }
 
-  } 
+  //
+  // remember the key
+  //
+  *KeyValue = (UINTN)FfsFileEntry;
+  FfsFileHeader = (EFI_FFS_FILE_HEADER *)FfsFileEntry->FfsHeader;
 
   //
   // Return FileType, NameGuid, and Attributes
@@ -751,24 +794,27 @@ Returns:
   
 
   //
-  // Keep looking until we find the matching NameGuid.
+  // Look the file up in the name index, then let FvGetNextFile return its
+  // information by starting the search from the file right before it.
   // The Key is really an FfsFileEntry
   //
-  FvDevice->LastKey = 0;
-  do {
-    LocalFoundType = 0;
-    Status = FvGetNextFile (
-              This,
-              &FvDevice->LastKey,
-              &LocalFoundType,
-              &SearchNameGuid,
-              &LocalAttributes,
-              &FileSize
-              );
-    if (EFI_ERROR (Status)) {
-      return EFI_NOT_FOUND;
-    }
-  } while (!EfiCompareGuid (&SearchNameGuid, (EFI_GUID*)NameGuid));
+  Status = FvGetFileKeyByName (FvDevice, (EFI_GUID *) NameGuid, &FvDevice->LastKey);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  LocalFoundType = 0;
+  Status = FvGetNextFile (
+            This,
+            &FvDevice->LastKey,
+            &LocalFoundType,
+            &SearchNameGuid,
+            &LocalAttributes,
+            &FileSize
+            );
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
 
   //
   // Get a pointer to the header
@@ -968,3 +1014,151 @@ Done:
 
 #endif
 
+
+EFI_STATUS
+CoreFvGetSectionInPlace (
+  IN  VOID                              *FwVol,
+  IN  EFI_GUID                          *NameGuid,
+  IN  EFI_SECTION_TYPE                  SectionType,
+  OUT VOID                              **Buffer,
+  OUT UINTN                             *BufferSize,
+  OUT EFI_PHYSICAL_ADDRESS              *MappedAddress OPTIONAL
+  )
+/*++
+
+Routine Description:
+    Locates a leaf section of a file in a firmware volume produced by the
+    DXE core and returns a pointer to it in the cached copy of the volume,
+    so the caller can consume it without the copies made by ReadSection ().
+    Only the sections at the top level of the file are looked at, a section
+    inside an encapsulation section must still be read with ReadSection ().
+    ReadSection () searches an encapsulation section before the sections
+    that follow it, so the file is not handled here either if an
+    encapsulation section comes before the first section of SectionType.
+    The returned buffer is owned by the firmware volume and must not be
+    freed or modified.
+
+Arguments:
+    FwVol             -   The firmware volume protocol instance.
+    NameGuid          -   Pointer to an EFI_GUID, which is the filename.
+    SectionType       -   Indicates the section type to return.
+    Buffer            -   Returns the pointer to the section data (not
+                          including section header).
+    BufferSize        -   Returns the size of the section data.
+    MappedAddress     -   Returns the address of the section data in the
+                          volume itself if the volume is memory mapped,
+                          otherwise 0.
+
+Returns:
+    EFI_SUCCESS                     - The section is found.
+    EFI_UNSUPPORTED                 - The firmware volume is not produced
+                                      by the DXE core.
+    EFI_NOT_FOUND                   - The file or the top level section
+                                      is not found, or it may be preceded
+                                      by one in an encapsulation section.
+
+--*/
+{
+  EFI_STATUS                        Status;
+#if (PI_SPECIFICATION_VERSION < 0x00010000)
+  EFI_FIRMWARE_VOLUME_PROTOCOL      *This;
+#else
+  EFI_FIRMWARE_VOLUME2_PROTOCOL     *This;
+#endif
+  FFS_FILE_LIST_ENTRY               *Key;
+  EFI_FV_FILETYPE                   FileType;
+  EFI_GUID                          SearchNameGuid;
+  EFI_FV_FILE_ATTRIBUTES            FileAttributes;
+  UINTN                             FileSize;
+  UINT8                             *Section;
+  UINT8                             *FileEnd;
+  UINTN                             SectionLength;
+  FV_DEVICE                         *FvDevice;
+  EFI_FVB_ATTRIBUTES                FvbAttributes;
+  EFI_PHYSICAL_ADDRESS              FvAddress;
+
+  This = FwVol;
+  if (This->ReadSection != FvReadFileSection) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Find the file with a private key, so LastKey of ReadFile () is untouched
+  //
+  Status = FvGetFileKeyByName (FV_DEVICE_FROM_THIS (This), NameGuid, &Key);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  FileType = 0;
+  Status = FvGetNextFile (
+            This,
+            &Key,
+            &FileType,
+            &SearchNameGuid,
+            &FileAttributes,
+            &FileSize
+            );
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (FileType == EFI_FV_FILETYPE_RAW) {
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Walk the top level sections, each of them starts on a 4 byte boundary
+  //
+  *Buffer = NULL;
+  Section = (UINT8 *) (Key->FfsHeader + 1);
+  FileEnd = Section + FileSize;
+
+  while ((UINTN) (FileEnd - Section) >= sizeof (EFI_COMMON_SECTION_HEADER)) {
+    SectionLength = SECTION_SIZE (Section);
+    if ((SectionLength < sizeof (EFI_COMMON_SECTION_HEADER)) ||
+        (SectionLength > (UINTN) (FileEnd - Section))) {
+      break;
+    }
+
+    if (((EFI_COMMON_SECTION_HEADER *) Section)->Type == SectionType) {
+      *Buffer     = Section + sizeof (EFI_COMMON_SECTION_HEADER);
+      *BufferSize = SectionLength - sizeof (EFI_COMMON_SECTION_HEADER);
+      break;
+    }
+
+    if ((((EFI_COMMON_SECTION_HEADER *) Section)->Type == EFI_SECTION_COMPRESSION) ||
+        (((EFI_COMMON_SECTION_HEADER *) Section)->Type == EFI_SECTION_GUID_DEFINED)) {
+      break;
+    }
+
+    SectionLength = (SectionLength + 3) & ~((UINTN) 3);
+    if (SectionLength >= (UINTN) (FileEnd - Section)) {
+      break;
+    }
+    Section += SectionLength;
+  }
+
+  if (*Buffer == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (MappedAddress != NULL) {
+    //
+    // The cache is a copy of the volume minus its header, so the section is
+    // at the same offset in a memory mapped volume
+    //
+    *MappedAddress = 0;
+    FvDevice       = FV_DEVICE_FROM_THIS (This);
+    Status = FvDevice->Fvb->GetVolumeAttributes (FvDevice->Fvb, &FvbAttributes);
+    if (!EFI_ERROR (Status) && ((FvbAttributes & EFI_FVB_MEMORY_MAPPED) != 0)) {
+      Status = FvDevice->Fvb->GetPhysicalAddress (FvDevice->Fvb, &FvAddress);
+      if (!EFI_ERROR (Status)) {
+        *MappedAddress = FvAddress + FvDevice->FwVolHeader->HeaderLength +
+                         (UINTN) ((UINT8 *) *Buffer - FvDevice->CachedFv);
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
@@ -33,6 +33,72 @@ Revision History
 #include EFI_PROTOCOL_DEFINITION(PlatformDriverOverride)
 #include EFI_PROTOCOL_DEFINITION(BusSpecificDriverOverride)
 
+//
+// The Driver Binding Protocol instances sorted by Version, from highest to
+// lowest. Instances with the same Version keep the handle database order.
+// The table is only rebuilt after a Driver Binding Protocol is installed or
+// uninstalled, instead of on every ConnectController().
+//
+typedef struct {
+  EFI_HANDLE                   DriverBindingHandle;
+  EFI_DRIVER_BINDING_PROTOCOL  *DriverBinding;
+} DRIVER_BINDING_CACHE_ENTRY;
+
+STATIC DRIVER_BINDING_CACHE_ENTRY  *mDriverBindingCache      = NULL;
+STATIC UINTN                       mDriverBindingCacheCount  = 0;
+STATIC BOOLEAN                     mDriverBindingCacheValid  = FALSE;
+
+//
+// Incremented each time the cache is invalidated, so a connect that is in
+// progress can tell that its copy of the table is out of date.
+//
+STATIC UINTN                       mDriverBindingCacheKey    = 0;
+
+//
+// Driver Binding usage counters for this boot
+//
+typedef struct {
+  UINTN   SupportedCalls;
+  UINTN   SupportedSkipped;
+  UINTN   StartCalls;
+  UINTN   CacheRebuilds;
+} DRIVER_BINDING_STATISTICS;
+
+STATIC DRIVER_BINDING_STATISTICS   mDriverBindingStatistics;
+
+//
+// Incremented whenever the handle database changes in a way that may turn
+// an unsupported controller into a supported one: a protocol is installed,
+// uninstalled or reinstalled, or a BY_DRIVER open is closed outside of a
+// Supported() call.
+//
+STATIC UINT64                      mDriverBindingHintKey     = 0;
+STATIC BOOLEAN                     mDriverBindingProbe       = FALSE;
+
+#ifdef EFI_DRIVER_BINDING_HINT
+//
+// Supported() hint cache. For each controller it records which drivers
+// returned EFI_UNSUPPORTED while the handle database was unchanged, so they
+// are not asked again until mDriverBindingHintKey changes. This is only safe
+// when the Supported() functions of the platform depend on the handle
+// database alone, so it is enabled with EFI_DRIVER_BINDING_HINT.
+//
+#define DRIVER_BINDING_HINT_SIGNATURE  EFI_SIGNATURE_32('d','b','h','t')
+#define DRIVER_BINDING_HINT_HASH_SIZE  64
+
+typedef struct {
+  UINTN           Signature;
+  EFI_LIST_ENTRY  Link;
+  EFI_HANDLE      ControllerHandle;
+  UINTN           CacheKey;
+  UINT64          HintKey;
+  UINT8           Rejected[1];
+} DRIVER_BINDING_HINT;
+
+STATIC EFI_LIST_ENTRY              mDriverBindingHintHash[DRIVER_BINDING_HINT_HASH_SIZE];
+STATIC BOOLEAN                     mDriverBindingHintInit    = FALSE;
+#endif
+
 //
 // Driver Support Function Prototypes
 //
@@ -343,7 +409,261 @@ Returns:
     }
   }
 }
- 
+
+VOID
+CoreNotifyDriverBindingChange (
+  IN EFI_GUID                  *Protocol OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Called by the handle database services when a protocol interface is 
+  installed, uninstalled or reinstalled, or when a BY_DRIVER open is closed.
+  Invalidates the Supported() hints, and the sorted Driver Binding Protocol
+  table if the protocol is the Driver Binding Protocol.
+
+Arguments:
+
+  Protocol  - The protocol that was installed or uninstalled, or NULL if
+              a BY_DRIVER open was closed.
+
+Returns:
+
+  None.
+
+--*/
+{
+  if (Protocol == NULL) {
+    //
+    // Supported() opens and closes protocols BY_DRIVER all the time, and that
+    // does not change what other drivers support.
+    //
+    if (mDriverBindingProbe) {
+      return;
+    }
+  } else if (EfiCompareGuid (Protocol, &gEfiDriverBindingProtocolGuid)) {
+    mDriverBindingCacheValid = FALSE;
+    mDriverBindingCacheKey++;
+  }
+
+  mDriverBindingHintKey++;
+}
+
+VOID
+CoreDumpDriverBindingStatistics (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Print the Driver Binding Protocol usage counters of this boot.
+
+Arguments:
+
+  None.
+
+Returns:
+
+  None.
+
+--*/
+{
+  DEBUG ((
+    EFI_D_INFO,
+    "DriverBinding: %d Supported() calls, %d skipped, %d Start() calls, %d table rebuilds\n",
+    mDriverBindingStatistics.SupportedCalls,
+    mDriverBindingStatistics.SupportedSkipped,
+    mDriverBindingStatistics.StartCalls,
+    mDriverBindingStatistics.CacheRebuilds
+    ));
+}
+
+STATIC
+EFI_STATUS
+CoreBuildDriverBindingCache (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Rebuild the table of Driver Binding Protocol instances sorted by Version
+  if it has been invalidated.
+
+Arguments:
+
+  None.
+
+Returns:
+
+  EFI_SUCCESS           - The table is up to date.
+  EFI_NOT_FOUND         - There is no Driver Binding Protocol instance.
+  EFI_OUT_OF_RESOURCES  - No enough system resources to build the table.
+
+--*/
+{
+  EFI_STATUS                   Status;
+  UINTN                        DriverBindingHandleCount;
+  EFI_HANDLE                   *DriverBindingHandleBuffer;
+  DRIVER_BINDING_CACHE_ENTRY   *Cache;
+  DRIVER_BINDING_CACHE_ENTRY   Entry;
+  EFI_DRIVER_BINDING_PROTOCOL  *DriverBinding;
+  UINTN                        Count;
+  UINTN                        Index;
+  UINTN                        SortIndex;
+
+  if (mDriverBindingCacheValid) {
+    return (mDriverBindingCacheCount == 0) ? EFI_NOT_FOUND : EFI_SUCCESS;
+  }
+
+  //
+  // Get list of all Driver Binding Protocol Instances
+  //
+  Status = CoreLocateHandleBuffer (
+             ByProtocol,   
+             &gEfiDriverBindingProtocolGuid,  
+             NULL,
+             &DriverBindingHandleCount, 
+             &DriverBindingHandleBuffer
+             );
+  if (EFI_ERROR (Status) || (DriverBindingHandleCount == 0)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Cache = CoreAllocateBootServicesPool (sizeof (DRIVER_BINDING_CACHE_ENTRY) * DriverBindingHandleCount);
+  if (Cache == NULL) {
+    CoreFreePool (DriverBindingHandleBuffer);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Insertion sort on Version from highest to lowest, so instances with the
+  // same Version stay in handle database order.
+  //
+  Count = 0;
+  for (Index = 0; Index < DriverBindingHandleCount; Index++) {
+    Status = CoreHandleProtocol (
+               DriverBindingHandleBuffer[Index],
+               &gEfiDriverBindingProtocolGuid,
+               &DriverBinding
+               );
+    if (EFI_ERROR (Status) || DriverBinding == NULL) {
+      continue;
+    }
+
+    Entry.DriverBindingHandle = DriverBindingHandleBuffer[Index];
+    Entry.DriverBinding       = DriverBinding;
+
+    for (SortIndex = Count; SortIndex > 0; SortIndex--) {
+      if (Cache[SortIndex - 1].DriverBinding->Version >= DriverBinding->Version) {
+        break;
+      }
+      Cache[SortIndex] = Cache[SortIndex - 1];
+    }
+    Cache[SortIndex] = Entry;
+    Count++;
+  }
+
+  CoreFreePool (DriverBindingHandleBuffer);
+
+  if (mDriverBindingCache != NULL) {
+    CoreFreePool (mDriverBindingCache);
+  }
+
+  mDriverBindingCache      = Cache;
+  mDriverBindingCacheCount = Count;
+  mDriverBindingCacheValid = TRUE;
+  mDriverBindingStatistics.CacheRebuilds++;
+
+  return (Count == 0) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
+#ifdef EFI_DRIVER_BINDING_HINT
+STATIC
+DRIVER_BINDING_HINT *
+CoreGetDriverBindingHint (
+  IN EFI_HANDLE                ControllerHandle,
+  IN UINTN                     CacheKey
+  )
+/*++
+
+Routine Description:
+
+  Get the Supported() hint of ControllerHandle, creating it if needed.
+  Hints learned before the last handle database change are reset.
+
+Arguments:
+
+  ControllerHandle  - Handle of the controller.
+  CacheKey          - The Driver Binding table the caller's indices refer to.
+
+Returns:
+
+  The hint of the controller, or NULL if it can't be used.
+
+--*/
+{
+  EFI_LIST_ENTRY       *Head;
+  EFI_LIST_ENTRY       *Link;
+  DRIVER_BINDING_HINT  *Hint;
+  DRIVER_BINDING_HINT  *Found;
+  UINTN                Index;
+
+  if (CacheKey != mDriverBindingCacheKey) {
+    return NULL;
+  }
+
+  if (!mDriverBindingHintInit) {
+    for (Index = 0; Index < DRIVER_BINDING_HINT_HASH_SIZE; Index++) {
+      InitializeListHead (&mDriverBindingHintHash[Index]);
+    }
+    mDriverBindingHintInit = TRUE;
+  }
+
+  Head  = &mDriverBindingHintHash[((UINTN) ControllerHandle >> 4) % DRIVER_BINDING_HINT_HASH_SIZE];
+  Found = NULL;
+
+  //
+  // Free the stale hints of this bucket on the way. They belong to an older
+  // table or handle database, possibly to handles that no longer exist.
+  //
+  Link = Head->ForwardLink;
+  while (Link != Head) {
+    Hint = CR (Link, DRIVER_BINDING_HINT, Link, DRIVER_BINDING_HINT_SIGNATURE);
+    Link = Link->ForwardLink;
+
+    if ((Hint->CacheKey != CacheKey) || (Hint->HintKey != mDriverBindingHintKey)) {
+      RemoveEntryList (&Hint->Link);
+      CoreFreePool (Hint);
+      continue;
+    }
+
+    if (Hint->ControllerHandle == ControllerHandle) {
+      Found = Hint;
+    }
+  }
+
+  if (Found != NULL) {
+    return Found;
+  }
+
+  Hint = CoreAllocateZeroBootServicesPool (sizeof (DRIVER_BINDING_HINT) + mDriverBindingCacheCount / 8);
+  if (Hint == NULL) {
+    return NULL;
+  }
+
+  Hint->Signature        = DRIVER_BINDING_HINT_SIGNATURE;
+  Hint->ControllerHandle = ControllerHandle;
+  Hint->CacheKey         = CacheKey;
+  Hint->HintKey          = mDriverBindingHintKey;
+  InsertTailList (Head, &Hint->Link);
+
+  return Hint;
+}
+#endif
+
 STATIC
 EFI_STATUS 
 CoreConnectSingleController (
@@ -379,16 +699,19 @@ Returns:
   EFI_BUS_SPECIFIC_DRIVER_OVERRIDE_PROTOCOL  *BusSpecificDriverOverride;
   UINTN                                      DriverBindingHandleCount;
   EFI_HANDLE                                 *DriverBindingHandleBuffer;
-  UINTN                                      NewDriverBindingHandleCount;
-  EFI_HANDLE                                 *NewDriverBindingHandleBuffer;
   EFI_DRIVER_BINDING_PROTOCOL                *DriverBinding;
   UINTN                                      NumberOfSortedDriverBindingProtocols;
   EFI_DRIVER_BINDING_PROTOCOL                **SortedDriverBindingProtocols;
-  UINT32                                     HighestVersion;
-  UINTN                                      HighestIndex;
+  UINTN                                      *SortedCacheIndex;
+  UINTN                                      CacheKey;
+  UINTN                                      CacheIndex;
   UINTN                                      SortIndex;
   BOOLEAN                                    OneStarted;
   BOOLEAN                                    DriverFound;
+#ifdef EFI_DRIVER_BINDING_HINT
+  DRIVER_BINDING_HINT                        *Hint;
+  UINT64                                     HintKey;
+#endif
 
   //
   // Initialize local variables
@@ -399,28 +722,34 @@ Returns:
   SortedDriverBindingProtocols          = NULL;
 
   //
-  // Get list of all Driver Binding Protocol Instances
+  // Get the Driver Binding Protocol Instances, already sorted by Version
   //
-  Status = CoreLocateHandleBuffer (
-             ByProtocol,   
-             &gEfiDriverBindingProtocolGuid,  
-             NULL,
-             &DriverBindingHandleCount, 
-             &DriverBindingHandleBuffer
-             );
-  if (EFI_ERROR (Status) || (DriverBindingHandleCount == 0)) {
-    return EFI_NOT_FOUND;
+  Status = CoreBuildDriverBindingCache ();
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
 
+  CacheKey                 = mDriverBindingCacheKey;
+  DriverBindingHandleCount = mDriverBindingCacheCount;
+
   //
-  // Allocate a duplicate array for the sorted Driver Binding Protocol Instances
+  // Allocate the arrays for the handles, the sorted Driver Binding Protocol Instances
+  // and their index in the cache with one allocation
   //
-  SortedDriverBindingProtocols = CoreAllocateBootServicesPool (sizeof (VOID *) * DriverBindingHandleCount);
-  if (SortedDriverBindingProtocols == NULL) {
-    CoreFreePool (DriverBindingHandleBuffer);
+  DriverBindingHandleBuffer = CoreAllocateBootServicesPool (
+                                (sizeof (EFI_HANDLE) + sizeof (VOID *) + sizeof (UINTN)) * DriverBindingHandleCount
+                                );
+  if (DriverBindingHandleBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
 
+  SortedDriverBindingProtocols = (EFI_DRIVER_BINDING_PROTOCOL **) (DriverBindingHandleBuffer + DriverBindingHandleCount);
+  SortedCacheIndex             = (UINTN *) (SortedDriverBindingProtocols + DriverBindingHandleCount);
+
+  for (Index = 0; Index < DriverBindingHandleCount; Index++) {
+    DriverBindingHandleBuffer[Index] = mDriverBindingCache[Index].DriverBindingHandle;
+  }
+
   //
   // Add Driver Binding Protocols from Context Driver Image Handles first
   //
@@ -495,64 +824,54 @@ Returns:
   }
 
   //
-  // Then add all the remaining Driver Binding Protocols
-  //
-  SortIndex = NumberOfSortedDriverBindingProtocols;
-  for (Index = 0; Index < DriverBindingHandleCount; Index++) {
-    AddSortedDriverBindingProtocol (
-      DriverBindingHandleBuffer[Index],
-      &NumberOfSortedDriverBindingProtocols, 
-      SortedDriverBindingProtocols,
-      DriverBindingHandleCount,
-      DriverBindingHandleBuffer,
-      FALSE
-      );
-  }
-
-  //
-  // Free the Driver Binding Handle Buffer
-  //
-  CoreFreePool (DriverBindingHandleBuffer);
-
-  //
-  // If the number of Driver Binding Protocols has increased since this function started, then return
+  // If the Driver Binding Protocols have changed since this function started, then return
   // EFI_NOT_READY, so it will be restarted
   //
-  Status = CoreLocateHandleBuffer (
-             ByProtocol,   
-             &gEfiDriverBindingProtocolGuid,  
-             NULL,
-             &NewDriverBindingHandleCount, 
-             &NewDriverBindingHandleBuffer
-             );
-  CoreFreePool (NewDriverBindingHandleBuffer);
-  if (NewDriverBindingHandleCount > DriverBindingHandleCount) {
+  if (CacheKey != mDriverBindingCacheKey) {
     //
     // Free any buffers that were allocated with AllocatePool()
     //
-    CoreFreePool (SortedDriverBindingProtocols);
+    CoreFreePool (DriverBindingHandleBuffer);
 
     return EFI_NOT_READY;
   }
 
   //
-  // Sort the remaining DriverBinding Protocol based on their Version field from
-  // highest to lowest.
+  // Find the cache index of the override drivers
   //
-  for ( ; SortIndex < NumberOfSortedDriverBindingProtocols; SortIndex++) {
-    HighestVersion = SortedDriverBindingProtocols[SortIndex]->Version;
-    HighestIndex   = SortIndex;
-    for (Index = SortIndex + 1; Index < NumberOfSortedDriverBindingProtocols; Index++) {
-      if (SortedDriverBindingProtocols[Index]->Version > HighestVersion) {
-        HighestVersion = SortedDriverBindingProtocols[Index]->Version;
-        HighestIndex   = Index;
+  for (SortIndex = 0; SortIndex < NumberOfSortedDriverBindingProtocols; SortIndex++) {
+    SortedCacheIndex[SortIndex] = DriverBindingHandleCount;
+    for (CacheIndex = 0; CacheIndex < DriverBindingHandleCount; CacheIndex++) {
+      if (mDriverBindingCache[CacheIndex].DriverBinding == SortedDriverBindingProtocols[SortIndex]) {
+        SortedCacheIndex[SortIndex] = CacheIndex;
+        break;
       }
     }
-    if (SortIndex != HighestIndex) {
-      DriverBinding = SortedDriverBindingProtocols[SortIndex];
-      SortedDriverBindingProtocols[SortIndex] = SortedDriverBindingProtocols[HighestIndex];
-      SortedDriverBindingProtocols[HighestIndex] = DriverBinding;
+  }
+
+  //
+  // Then add all the remaining Driver Binding Protocols. The cache is already sorted
+  // by Version from highest to lowest.
+  //
+  SortIndex = NumberOfSortedDriverBindingProtocols;
+  for (CacheIndex = 0; CacheIndex < DriverBindingHandleCount; CacheIndex++) {
+    if (DriverBindingHandleBuffer[CacheIndex] == NULL) {
+      continue;
+    }
+
+    DriverBinding = mDriverBindingCache[CacheIndex].DriverBinding;
+    for (Index = 0; Index < SortIndex; Index++) {
+      if (SortedDriverBindingProtocols[Index] == DriverBinding) {
+        break;
+      }
+    }
+    if (Index < SortIndex) {
+      continue;
     }
+
+    SortedDriverBindingProtocols[NumberOfSortedDriverBindingProtocols] = DriverBinding;
+    SortedCacheIndex[NumberOfSortedDriverBindingProtocols]             = CacheIndex;
+    NumberOfSortedDriverBindingProtocols++;
   }
 
   //
@@ -571,11 +890,43 @@ Returns:
     for (Index = 0; (Index < NumberOfSortedDriverBindingProtocols) && !DriverFound; Index++) {
       if (SortedDriverBindingProtocols[Index] != NULL) {
         DriverBinding = SortedDriverBindingProtocols[Index];
+        CacheIndex    = SortedCacheIndex[Index];
+
+#ifdef EFI_DRIVER_BINDING_HINT
+        //
+        // Skip the driver if it did not support ControllerHandle since the last
+        // change of the handle database. The hint is only kept when there is no
+        // RemainingDevicePath, since that also changes the answer.
+        //
+        Hint = NULL;
+        if ((RemainingDevicePath == NULL) && (CacheIndex < DriverBindingHandleCount)) {
+          Hint = CoreGetDriverBindingHint (ControllerHandle, CacheKey);
+          if ((Hint != NULL) && ((Hint->Rejected[CacheIndex / 8] & (1 << (CacheIndex % 8))) != 0)) {
+            mDriverBindingStatistics.SupportedSkipped++;
+            continue;
+          }
+        }
+        HintKey = mDriverBindingHintKey;
+#endif
+
+        mDriverBindingStatistics.SupportedCalls++;
+        mDriverBindingProbe = TRUE;
         Status = DriverBinding->Supported(
                                   DriverBinding, 
                                   ControllerHandle,
                                   RemainingDevicePath
                                   );
+        mDriverBindingProbe = FALSE;
+
+#ifdef EFI_DRIVER_BINDING_HINT
+        //
+        // The answer is only recorded if nothing changed during Supported()
+        //
+        if ((Status == EFI_UNSUPPORTED) && (Hint != NULL) && (HintKey == mDriverBindingHintKey)) {
+          Hint->Rejected[CacheIndex / 8] |= (UINT8) (1 << (CacheIndex % 8));
+        }
+#endif
+
         if (!EFI_ERROR (Status)) {
           SortedDriverBindingProtocols[Index] = NULL;
           DriverFound = TRUE;
@@ -584,6 +935,7 @@ Returns:
           // A driver was found that supports ControllerHandle, so attempt to start the driver
           // on ControllerHandle.
           //
+          mDriverBindingStatistics.StartCalls++;
           PERF_START (DriverBinding->DriverBindingHandle, DRIVERBINDING_START_TOK, NULL, 0);
           Status = DriverBinding->Start (
                                     DriverBinding, 
@@ -606,7 +958,7 @@ Returns:
   //
   // Free any buffers that were allocated with AllocatePool()
   //
-  CoreFreePool (SortedDriverBindingProtocols);
+  CoreFreePool (DriverBindingHandleBuffer);
 
   //
   // If at least one driver was started on ControllerHandle, then return EFI_SUCCESS.
@@ -299,6 +299,8 @@ Returns:
   // Update the interface on the protocol
   //
   Prot->Interface = NewInterface;
+  CoreRemoveDevicePathTrieEntry (Handle, Protocol, OldInterface);
+  CoreAddDevicePathTrieEntry (Handle, Protocol, NewInterface);
 
   //
   // Add this protocol interface to the tail of the
@@ -312,6 +314,8 @@ Returns:
   gHandleDatabaseKey++;
   Handle->Key = gHandleDatabaseKey;
 
+  CoreNotifyDriverBindingChange (Protocol);
+
   //
   // Release the lock and connect all drivers to UserHandle
   //
@@ -328,6 +328,84 @@ Returns:
 --*/
 ;
 
+VOID
+CoreAddDevicePathTrieEntry (
+  IN IHANDLE                   *Handle,
+  IN EFI_GUID                  *Protocol,
+  IN VOID                      *Interface
+  )
+/*++
+
+Routine Description:
+
+  Add a handle to the device path trie used by CoreLocateDevicePath (),
+  if Protocol is the Device Path Protocol.
+  N.B.  The gProtocolDatabaseLock must be owned
+
+Arguments:
+
+  Handle    - The handle the protocol was installed on
+  Protocol  - The protocol that was installed
+  Interface - The interface of the protocol
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+CoreRemoveDevicePathTrieEntry (
+  IN IHANDLE                   *Handle,
+  IN EFI_GUID                  *Protocol,
+  IN VOID                      *Interface
+  )
+/*++
+
+Routine Description:
+
+  Remove a handle from the device path trie used by CoreLocateDevicePath (),
+  if Protocol is the Device Path Protocol.
+  N.B.  The gProtocolDatabaseLock must be owned
+
+Arguments:
+
+  Handle    - The handle the protocol was uninstalled from
+  Protocol  - The protocol that was uninstalled
+  Interface - The interface of the protocol
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+CoreNotifyDriverBindingChange (
+  IN EFI_GUID                  *Protocol OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Called by the handle database services when a protocol interface is 
+  installed, uninstalled or reinstalled, or when a BY_DRIVER open is closed,
+  so ConnectController() can refresh its Driver Binding Protocol caches.
+
+Arguments:
+
+  Protocol  - The protocol that was installed or uninstalled, or NULL if
+              a BY_DRIVER open was closed.
+
+Returns:
+
+  None
+
+--*/
+;
+
 //
 // Externs
 //
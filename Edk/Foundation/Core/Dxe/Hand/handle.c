@@ -559,6 +559,8 @@ Returns:
   if (Notify) {
     CoreNotifyProtocolEntry (ProtEntry);
   }
+  CoreAddDevicePathTrieEntry (Handle, Protocol, Interface);
+  CoreNotifyDriverBindingChange (Protocol);
   Status = EFI_SUCCESS;
 
 Done:
@@ -886,6 +888,8 @@ Returns:
     //
     Prot->Signature = 0;
     CoreFreePool (Prot);
+    CoreRemoveDevicePathTrieEntry (Handle, Protocol, Interface);
+    CoreNotifyDriverBindingChange (Protocol);
     Status = EFI_SUCCESS;
   }
 
@@ -1390,6 +1394,9 @@ Returns:
     OpenData = CR (Link, OPEN_PROTOCOL_DATA, Link, OPEN_PROTOCOL_DATA_SIGNATURE);
     Link = Link->ForwardLink;
     if ((OpenData->AgentHandle == AgentHandle) && (OpenData->ControllerHandle == ControllerHandle)) {
+        if ((OpenData->Attributes & EFI_OPEN_PROTOCOL_BY_DRIVER) != 0) {
+          CoreNotifyDriverBindingChange (NULL);
+        }
         RemoveEntryList (&OpenData->Link);  
         ProtocolInterface->OpenListCount--;
         CoreFreePool (OpenData);
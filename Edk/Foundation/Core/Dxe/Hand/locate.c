@@ -28,6 +28,48 @@ Revision History
 //
 UINTN mEfiLocateHandleRequest = 0;
 
+//
+// Device path trie. Each trie node stands for one device path node, and lists
+// the handles whose Device Path Protocol ends there. CoreLocateDevicePath ()
+// walks the source device path down the trie once, instead of comparing it
+// with the device path of every handle. The trie is kept up to date when the
+// Device Path Protocol is installed, uninstalled or reinstalled.
+//
+#define DEVICE_PATH_TRIE_NODE_SIGNATURE    EFI_SIGNATURE_32('d','p','t','n')
+#define DEVICE_PATH_TRIE_HANDLE_SIGNATURE  EFI_SIGNATURE_32('d','p','t','h')
+#define DEVICE_PATH_TRIE_HASH_SIZE         256
+#define DEVICE_PATH_TRIE_HANDLE_HASH_SIZE  64
+
+typedef struct _DEVICE_PATH_TRIE_NODE {
+  UINTN                           Signature;
+  EFI_LIST_ENTRY                  HashLink;   // Link on mDevicePathTrieHash
+  struct _DEVICE_PATH_TRIE_NODE   *Parent;
+  UINTN                           ChildCount;
+  EFI_LIST_ENTRY                  Handles;    // DEVICE_PATH_TRIE_HANDLE list
+  UINTN                           Hash;
+  EFI_DEVICE_PATH_PROTOCOL        *Node;      // Copy of the device path node
+} DEVICE_PATH_TRIE_NODE;
+
+typedef struct {
+  UINTN                           Signature;
+  EFI_LIST_ENTRY                  Link;       // Link on DEVICE_PATH_TRIE_NODE.Handles
+  EFI_LIST_ENTRY                  HashLink;   // Link on mDevicePathTrieHandleHash
+  IHANDLE                         *Handle;
+  VOID                            *Interface;
+  DEVICE_PATH_TRIE_NODE           *TrieNode;
+} DEVICE_PATH_TRIE_HANDLE;
+
+STATIC DEVICE_PATH_TRIE_NODE  mDevicePathTrieRoot;
+STATIC EFI_LIST_ENTRY         mDevicePathTrieHash[DEVICE_PATH_TRIE_HASH_SIZE];
+STATIC EFI_LIST_ENTRY         mDevicePathTrieHandleHash[DEVICE_PATH_TRIE_HANDLE_HASH_SIZE];
+STATIC BOOLEAN                mDevicePathTrieInit  = FALSE;
+
+//
+// Cleared if the trie could not be updated, CoreLocateDevicePath () then
+// goes back to comparing the device path of every handle.
+//
+STATIC BOOLEAN                mDevicePathTrieValid = TRUE;
+
 //
 // Internal prototypes
 //
@@ -417,6 +459,414 @@ Returns:
 }
 
 
+STATIC
+VOID
+CoreInitializeDevicePathTrie (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Initialize the device path trie on first use.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN  Index;
+
+  if (mDevicePathTrieInit) {
+    return;
+  }
+
+  mDevicePathTrieRoot.Signature  = DEVICE_PATH_TRIE_NODE_SIGNATURE;
+  mDevicePathTrieRoot.Parent     = NULL;
+  mDevicePathTrieRoot.ChildCount = 0;
+  mDevicePathTrieRoot.Hash       = 0;
+  mDevicePathTrieRoot.Node       = NULL;
+  InitializeListHead (&mDevicePathTrieRoot.HashLink);
+  InitializeListHead (&mDevicePathTrieRoot.Handles);
+
+  for (Index = 0; Index < DEVICE_PATH_TRIE_HASH_SIZE; Index++) {
+    InitializeListHead (&mDevicePathTrieHash[Index]);
+  }
+
+  for (Index = 0; Index < DEVICE_PATH_TRIE_HANDLE_HASH_SIZE; Index++) {
+    InitializeListHead (&mDevicePathTrieHandleHash[Index]);
+  }
+
+  mDevicePathTrieInit = TRUE;
+}
+
+STATIC
+UINTN
+CoreHashDevicePathTrieNode (
+  IN DEVICE_PATH_TRIE_NODE     *Parent,
+  IN EFI_DEVICE_PATH_PROTOCOL  *Node
+  )
+/*++
+
+Routine Description:
+
+  Hash a device path node under its parent trie node.
+
+Arguments:
+
+  Parent  - The parent trie node
+  Node    - The device path node
+
+Returns:
+
+  The hash value
+
+--*/
+{
+  UINT8  *Byte;
+  UINTN  Length;
+  UINTN  Hash;
+
+  Hash   = (UINTN) Parent;
+  Byte   = (UINT8 *) Node;
+  Length = DevicePathNodeLength (Node);
+
+  while (Length-- > 0) {
+    Hash = (Hash * 31) + *Byte++;
+  }
+
+  return Hash;
+}
+
+STATIC
+DEVICE_PATH_TRIE_NODE *
+CoreFindDevicePathTrieChild (
+  IN DEVICE_PATH_TRIE_NODE     *Parent,
+  IN EFI_DEVICE_PATH_PROTOCOL  *Node,
+  IN UINTN                     Hash
+  )
+/*++
+
+Routine Description:
+
+  Find the child of a trie node that matches a device path node.
+
+Arguments:
+
+  Parent  - The parent trie node
+  Node    - The device path node
+  Hash    - The hash of Node under Parent
+
+Returns:
+
+  The child trie node, or NULL if there is none.
+
+--*/
+{
+  EFI_LIST_ENTRY         *Head;
+  EFI_LIST_ENTRY         *Link;
+  DEVICE_PATH_TRIE_NODE  *Child;
+  UINTN                  Length;
+
+  if (Parent->ChildCount == 0) {
+    return NULL;
+  }
+
+  Length = DevicePathNodeLength (Node);
+  Head   = &mDevicePathTrieHash[Hash % DEVICE_PATH_TRIE_HASH_SIZE];
+
+  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
+    Child = CR (Link, DEVICE_PATH_TRIE_NODE, HashLink, DEVICE_PATH_TRIE_NODE_SIGNATURE);
+
+    if ((Child->Hash == Hash) &&
+        (Child->Parent == Parent) &&
+        (DevicePathNodeLength (Child->Node) == Length) &&
+        (EfiCompareMem (Child->Node, Node, Length) == 0)) {
+      return Child;
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+VOID
+CorePruneDevicePathTrie (
+  IN DEVICE_PATH_TRIE_NODE     *TrieNode
+  )
+/*++
+
+Routine Description:
+
+  Free TrieNode and its parents as long as they have no handle and no child.
+
+Arguments:
+
+  TrieNode  - The trie node to start from
+
+Returns:
+
+  None
+
+--*/
+{
+  DEVICE_PATH_TRIE_NODE  *Parent;
+
+  while ((TrieNode != &mDevicePathTrieRoot) &&
+         (TrieNode->ChildCount == 0) &&
+         IsListEmpty (&TrieNode->Handles)) {
+    Parent = TrieNode->Parent;
+    RemoveEntryList (&TrieNode->HashLink);
+    TrieNode->Signature = 0;
+    CoreFreePool (TrieNode);
+
+    Parent->ChildCount--;
+    TrieNode = Parent;
+  }
+}
+
+VOID
+CoreAddDevicePathTrieEntry (
+  IN IHANDLE                   *Handle,
+  IN EFI_GUID                  *Protocol,
+  IN VOID                      *Interface
+  )
+/*++
+
+Routine Description:
+
+  Add a handle to the device path trie if Protocol is the Device Path
+  Protocol. N.B. The gProtocolDatabaseLock must be owned.
+
+Arguments:
+
+  Handle    - The handle the protocol was installed on
+  Protocol  - The protocol that was installed
+  Interface - The interface of the protocol
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_DEVICE_PATH_PROTOCOL  *Node;
+  DEVICE_PATH_TRIE_NODE     *Current;
+  DEVICE_PATH_TRIE_NODE     *Child;
+  DEVICE_PATH_TRIE_HANDLE   *Entry;
+  UINTN                     Length;
+  UINTN                     Hash;
+
+  if (!EfiCompareGuid (Protocol, &gEfiDevicePathProtocolGuid) || !mDevicePathTrieValid) {
+    return;
+  }
+
+  //
+  // A NULL device path can't match anything
+  //
+  if (Interface == NULL) {
+    return;
+  }
+
+  CoreInitializeDevicePathTrie ();
+
+  Current = &mDevicePathTrieRoot;
+
+  for (Node = Interface; !IsDevicePathEnd (Node); Node = NextDevicePathNode (Node)) {
+    Length = DevicePathNodeLength (Node);
+    if (Length < sizeof (EFI_DEVICE_PATH_PROTOCOL)) {
+      //
+      // A malformed device path can't be walked, so it can't be matched
+      // either. Drop the trie nodes that were only created for it.
+      //
+      CorePruneDevicePathTrie (Current);
+      return;
+    }
+
+    Hash  = CoreHashDevicePathTrieNode (Current, Node);
+    Child = CoreFindDevicePathTrieChild (Current, Node, Hash);
+    if (Child == NULL) {
+      Child = CoreAllocateBootServicesPool (sizeof (DEVICE_PATH_TRIE_NODE) + Length);
+      if (Child == NULL) {
+        mDevicePathTrieValid = FALSE;
+        return;
+      }
+
+      Child->Signature  = DEVICE_PATH_TRIE_NODE_SIGNATURE;
+      Child->Parent     = Current;
+      Child->ChildCount = 0;
+      Child->Hash       = Hash;
+      Child->Node       = (EFI_DEVICE_PATH_PROTOCOL *) (Child + 1);
+      InitializeListHead (&Child->Handles);
+      EfiCopyMem (Child->Node, Node, Length);
+
+      InsertTailList (&mDevicePathTrieHash[Hash % DEVICE_PATH_TRIE_HASH_SIZE], &Child->HashLink);
+      Current->ChildCount++;
+    }
+
+    Current = Child;
+  }
+
+  Entry = CoreAllocateBootServicesPool (sizeof (DEVICE_PATH_TRIE_HANDLE));
+  if (Entry == NULL) {
+    mDevicePathTrieValid = FALSE;
+    return;
+  }
+
+  Entry->Signature = DEVICE_PATH_TRIE_HANDLE_SIGNATURE;
+  Entry->Handle    = Handle;
+  Entry->Interface = Interface;
+  Entry->TrieNode  = Current;
+
+  //
+  // Keep the installation order, it decides between handles with the
+  // same device path.
+  //
+  InsertTailList (&Current->Handles, &Entry->Link);
+  InsertTailList (
+    &mDevicePathTrieHandleHash[((UINTN) Handle >> 4) % DEVICE_PATH_TRIE_HANDLE_HASH_SIZE],
+    &Entry->HashLink
+    );
+}
+
+VOID
+CoreRemoveDevicePathTrieEntry (
+  IN IHANDLE                   *Handle,
+  IN EFI_GUID                  *Protocol,
+  IN VOID                      *Interface
+  )
+/*++
+
+Routine Description:
+
+  Remove a handle from the device path trie if Protocol is the Device Path
+  Protocol. N.B. The gProtocolDatabaseLock must be owned.
+
+Arguments:
+
+  Handle    - The handle the protocol was uninstalled from
+  Protocol  - The protocol that was uninstalled
+  Interface - The interface of the protocol
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_LIST_ENTRY           *Head;
+  EFI_LIST_ENTRY           *Link;
+  DEVICE_PATH_TRIE_HANDLE  *Entry;
+
+  if (!EfiCompareGuid (Protocol, &gEfiDevicePathProtocolGuid) || !mDevicePathTrieValid) {
+    return;
+  }
+
+  CoreInitializeDevicePathTrie ();
+
+  Head = &mDevicePathTrieHandleHash[((UINTN) Handle >> 4) % DEVICE_PATH_TRIE_HANDLE_HASH_SIZE];
+
+  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
+    Entry = CR (Link, DEVICE_PATH_TRIE_HANDLE, HashLink, DEVICE_PATH_TRIE_HANDLE_SIGNATURE);
+
+    if ((Entry->Handle == Handle) && (Entry->Interface == Interface)) {
+      RemoveEntryList (&Entry->HashLink);
+      RemoveEntryList (&Entry->Link);
+      CorePruneDevicePathTrie (Entry->TrieNode);
+
+      Entry->Signature = 0;
+      CoreFreePool (Entry);
+      return;
+    }
+  }
+}
+
+STATIC
+EFI_STATUS
+CoreLocateDevicePathInTrie (
+  IN EFI_GUID                       *Protocol,
+  IN EFI_DEVICE_PATH_PROTOCOL       *SourcePath,
+  OUT EFI_HANDLE                    *Device,
+  OUT INTN                          *BestMatch
+  )
+/*++
+
+Routine Description:
+
+  Find the handle with the longest device path that is a prefix of
+  SourcePath and that supports Protocol, by walking the device path trie.
+
+Arguments:
+
+  Protocol    - The protocol to search for
+  SourcePath  - The device path to match
+  Device      - The handle found
+  BestMatch   - The size of the matched device path, not counting the end
+                node, or -1 if no handle matched
+
+Returns:
+
+  EFI_SUCCESS      - The trie was searched.
+  EFI_UNSUPPORTED  - The trie is not usable, the caller must search the
+                     handles.
+
+--*/
+{
+  EFI_DEVICE_PATH_PROTOCOL  *Node;
+  DEVICE_PATH_TRIE_NODE     *Current;
+  DEVICE_PATH_TRIE_HANDLE   *Entry;
+  EFI_LIST_ENTRY            *Link;
+  INTN                      Size;
+
+  *BestMatch = -1;
+
+  if (!mDevicePathTrieValid) {
+    return EFI_UNSUPPORTED;
+  }
+
+  CoreAcquireProtocolLock ();
+
+  CoreInitializeDevicePathTrie ();
+
+  Current = &mDevicePathTrieRoot;
+  Node    = SourcePath;
+  Size    = 0;
+
+  while (Current != NULL) {
+    //
+    // The protocol is only checked on the handles that end at this node
+    //
+    for (Link = Current->Handles.ForwardLink; Link != &Current->Handles; Link = Link->ForwardLink) {
+      Entry = CR (Link, DEVICE_PATH_TRIE_HANDLE, Link, DEVICE_PATH_TRIE_HANDLE_SIGNATURE);
+      if (CoreGetProtocolInterface (Entry->Handle, Protocol) != NULL) {
+        *BestMatch = Size;
+        *Device    = Entry->Handle;
+        break;
+      }
+    }
+
+    if (IsDevicePathEnd (Node) || (DevicePathNodeLength (Node) < sizeof (EFI_DEVICE_PATH_PROTOCOL))) {
+      break;
+    }
+
+    Current = CoreFindDevicePathTrieChild (
+                Current,
+                Node,
+                CoreHashDevicePathTrieNode (Current, Node)
+                );
+    Size   += DevicePathNodeLength (Node);
+    Node    = NextDevicePathNode (Node);
+  }
+
+  CoreReleaseProtocolLock ();
+  return EFI_SUCCESS;
+}
+
 EFI_BOOTSERVICE
 EFI_STATUS
 EFIAPI
@@ -481,6 +931,19 @@ Returns:
     return EFI_INVALID_PARAMETER;
   }
 
+  //
+  // Walk the device path trie if it is usable
+  //
+  Status = CoreLocateDevicePathInTrie (Protocol, SourcePath, Device, &BestMatch);
+  if (!EFI_ERROR (Status)) {
+    if (BestMatch == -1) {
+      return EFI_NOT_FOUND;
+    }
+
+    *DevicePath = (EFI_DEVICE_PATH_PROTOCOL *) (((UINT8 *) SourcePath) + BestMatch);
+    return EFI_SUCCESS;
+  }
+
   //
   // Get a list of all handles that support the requested protocol
   //
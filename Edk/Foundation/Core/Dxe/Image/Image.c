@@ -226,6 +226,7 @@ Returns:
   EFI_TCG_PLATFORM_PROTOCOL *TcgPlatformProtocol;
   IMAGE_FILE_HANDLE         *FHandle;
   BOOLEAN                   NeedAllocateAddress;
+  BOOLEAN                   ExecuteInPlace;
 #ifdef EFI_LOAD_DRIVER_AT_FIXED_OFFSET
   BOOLEAN OffsetMode;
   STATIC BOOLEAN PrintTopAddress = TRUE;
@@ -263,11 +264,22 @@ Returns:
     }
   }
 
+  //
+  // An image in a memory mapped firmware volume that is linked at its
+  // address there runs in place, without a copy or relocation
+  //
+  ExecuteInPlace = FALSE;
+  if (DstBuffer == 0 && !(Attribute & EFI_LOAD_PE_IMAGE_ATTRIBUTE_RUNTIME_REGISTRATION)) {
+    ExecuteInPlace = CoreImageCanExecuteInPlace ((IMAGE_FILE_HANDLE *) Pe32Handle, &Image->ImageContext);
+  }
+
   //
   // Allocate memory of the correct memory type aligned on the required image boundary.
   //
   DstBufAlocated = FALSE;
-  if (DstBuffer == 0) {
+  if (ExecuteInPlace) {
+    Image->NumberOfPages = 0;
+  } else if (DstBuffer == 0) {
     //
     // Allocate Destination Buffer as caller did not pass it in.
     //
@@ -387,17 +399,19 @@ Returns:
     Image->ImageContext.ImageAddress = DstBuffer;
   }
   
-  Image->ImageBasePage = Image->ImageContext.ImageAddress;
-  Image->ImageContext.ImageAddress = 
-                        (Image->ImageContext.ImageAddress + Image->ImageContext.SectionAlignment - 1) & 
-                        ~((UINTN) Image->ImageContext.SectionAlignment - 1);
+  if (!ExecuteInPlace) {
+    Image->ImageBasePage = Image->ImageContext.ImageAddress;
+    Image->ImageContext.ImageAddress = 
+                          (Image->ImageContext.ImageAddress + Image->ImageContext.SectionAlignment - 1) & 
+                          ~((UINTN) Image->ImageContext.SectionAlignment - 1);
 
-  //
-  // Load the image from the file into the allocated memory
-  //
-  Status = gEfiPeiPeCoffLoader->LoadImage (gEfiPeiPeCoffLoader, &(Image->ImageContext));
-  if (EFI_ERROR (Status)) {
-    goto Done;
+    //
+    // Load the image from the file into the allocated memory
+    //
+    Status = gEfiPeiPeCoffLoader->LoadImage (gEfiPeiPeCoffLoader, &(Image->ImageContext));
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
   }
     
   //
@@ -444,20 +458,22 @@ Returns:
     ASSERT_EFI_ERROR (Status);
   }
 
-  //
-  // Relocate the image in memory
-  //
-  Status = gEfiPeiPeCoffLoader->RelocateImage (gEfiPeiPeCoffLoader, &(Image->ImageContext));
-  if (EFI_ERROR (Status)) {
-    goto Done;
-  }
+  if (!ExecuteInPlace) {
+    //
+    // Relocate the image in memory
+    //
+    Status = gEfiPeiPeCoffLoader->RelocateImage (gEfiPeiPeCoffLoader, &(Image->ImageContext));
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
 
-  //
-  // Flush the Instruction Cache
-  //
-  Status = CoreFlushICache (Image->ImageContext.ImageAddress, Image->ImageContext.ImageSize);
-  if (EFI_ERROR (Status)) {
-    goto Done;
+    //
+    // Flush the Instruction Cache
+    //
+    Status = CoreFlushICache (Image->ImageContext.ImageAddress, Image->ImageContext.ImageSize);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
   }
 
   //
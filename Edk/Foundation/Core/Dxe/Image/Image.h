@@ -99,10 +99,11 @@ typedef struct {
 //
 #define IMAGE_FILE_HANDLE_SIGNATURE       EFI_SIGNATURE_32('i','m','g','f')
 typedef struct {
-  UINTN               Signature;
-  BOOLEAN             FreeBuffer;
-  VOID                *Source;
-  UINTN               SourceSize;
+  UINTN                 Signature;
+  BOOLEAN               FreeBuffer;
+  VOID                  *Source;
+  UINTN                 SourceSize;
+  EFI_PHYSICAL_ADDRESS  MappedSource;   // Address of Source in a memory mapped FV, or 0
 } IMAGE_FILE_HANDLE;
 
 
@@ -202,6 +203,32 @@ Returns:
 --*/
 ;
 
+BOOLEAN
+CoreImageCanExecuteInPlace (
+  IN     IMAGE_FILE_HANDLE                     *ImageFileHandle,
+  IN OUT EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext
+  )
+/*++
+
+Routine Description:
+
+  Checks whether an image read from a memory mapped firmware volume can
+  run where it is stored in the volume, and if so fills in the entry point
+  of the image context.
+
+Arguments:
+
+  ImageFileHandle    - Handle of the image file
+  
+  ImageContext       - Image context filled in by GetImageInfo ()
+    
+Returns:
+
+  TRUE if the image can execute in place, FALSE otherwise
+
+--*/
+;
+
 //
 // Image processing worker functions
 //
@@ -151,6 +151,27 @@ Returns:
     if (NameGuid != NULL) {
 
       SectionType = EFI_SECTION_PE32;
+
+      //
+      // The loader copies the image into its own buffer anyway, so an
+      // unencapsulated PE32 section of a volume owned by the core is
+      // used in place rather than read out through ReadSection ()
+      //
+      Status = CoreFvGetSectionInPlace (
+                 FwVol,
+                 NameGuid,
+                 SectionType,
+                 &Pe32Buffer,
+                 &Pe32BufferSize,
+                 &ImageFileHandle->MappedSource
+                 );
+      if (!EFI_ERROR (Status)) {
+        ImageFileHandle->Source     = Pe32Buffer;
+        ImageFileHandle->SourceSize = Pe32BufferSize;
+        ImageFileHandle->FreeBuffer = FALSE;
+        goto Done;
+      }
+
       Pe32Buffer  = NULL;
       Status = FwVol->ReadSection (
                         FwVol, 
@@ -463,6 +484,103 @@ Returns:
   return EFI_SUCCESS;
 }
 
+
+BOOLEAN
+CoreImageCanExecuteInPlace (
+  IN     IMAGE_FILE_HANDLE                     *ImageFileHandle,
+  IN OUT EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext
+  )
+/*++
+
+Routine Description:
+
+  Checks whether an image read from a memory mapped firmware volume can
+  run where it is stored in the volume, and if so fills in the entry point
+  of the image context.
+
+  This is only the case for a PE32 image that was linked at its address in
+  the volume, so it needs no relocation, and whose sections are stored at
+  their image offsets with no uninitialized data to clear. Sections must
+  not be writable, since writes would change the volume and a later load
+  of the same image would start from the changed data. Runtime drivers,
+  which are relocated again by SetVirtualAddressMap (), and images with a
+  resource directory, whose HII resources are located by LoadImage (), are
+  always loaded into memory.
+
+Arguments:
+
+  ImageFileHandle    - Handle of the image file
+  
+  ImageContext       - Image context filled in by GetImageInfo ()
+    
+Returns:
+
+  TRUE if the image can execute in place, FALSE otherwise
+
+--*/
+{
+  EFI_IMAGE_OPTIONAL_HEADER_PTR_UNION  Hdr;
+  EFI_IMAGE_SECTION_HEADER             *Section;
+  EFI_IMAGE_DATA_DIRECTORY             *DirectoryEntry;
+  UINT32                               NumberOfRvaAndSizes;
+  UINTN                                Index;
+
+  if (ImageFileHandle->MappedSource == 0 ||
+      ImageContext->IsTeImage ||
+      ImageContext->ImageType == EFI_IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER ||
+      ImageContext->ImageAddress != ImageFileHandle->MappedSource ||
+      ImageContext->SectionAlignment == 0 ||
+      (ImageContext->ImageAddress & (ImageContext->SectionAlignment - 1)) != 0 ||
+      ImageContext->ImageSize > ImageFileHandle->SourceSize ||
+      ImageContext->PeCoffHeaderOffset + sizeof (EFI_IMAGE_NT_HEADERS64) > ImageFileHandle->SourceSize) {
+    return FALSE;
+  }
+
+  Hdr.Union = (EFI_IMAGE_OPTIONAL_HEADER_UNION *) ((UINT8 *) ImageFileHandle->Source + ImageContext->PeCoffHeaderOffset);
+
+  //
+  // GetImageInfo () adds debug data stored past the sections to the image
+  // size, LoadImage () would move it into the image. PE32 and PE32+ have the
+  // same offset for SizeOfImage.
+  //
+  if (ImageContext->ImageSize != Hdr.Pe32->OptionalHeader.SizeOfImage) {
+    return FALSE;
+  }
+
+  //
+  // Use Machine to identify PE32/PE32+ as PeCoffLoader does
+  //
+  if (Hdr.Pe32->FileHeader.Machine == EFI_IMAGE_MACHINE_IA32) {
+    NumberOfRvaAndSizes = Hdr.Pe32->OptionalHeader.NumberOfRvaAndSizes;
+    DirectoryEntry      = &Hdr.Pe32->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_RESOURCE];
+  } else {
+    NumberOfRvaAndSizes = Hdr.Pe32Plus->OptionalHeader.NumberOfRvaAndSizes;
+    DirectoryEntry      = &Hdr.Pe32Plus->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_RESOURCE];
+  }
+  if (NumberOfRvaAndSizes > EFI_IMAGE_DIRECTORY_ENTRY_RESOURCE && DirectoryEntry->Size != 0) {
+    return FALSE;
+  }
+
+  Section = (EFI_IMAGE_SECTION_HEADER *) (
+              (UINT8 *) &Hdr.Pe32->OptionalHeader +
+              Hdr.Pe32->FileHeader.SizeOfOptionalHeader
+              );
+  if ((UINTN) ((UINT8 *) (Section + Hdr.Pe32->FileHeader.NumberOfSections) - (UINT8 *) ImageFileHandle->Source) >
+      ImageFileHandle->SourceSize) {
+    return FALSE;
+  }
+  for (Index = 0; Index < Hdr.Pe32->FileHeader.NumberOfSections; Index++, Section++) {
+    if (Section->PointerToRawData != Section->VirtualAddress ||
+        Section->Misc.VirtualSize > Section->SizeOfRawData ||
+        (Section->Characteristics & EFI_IMAGE_SCN_MEM_WRITE) != 0) {
+      return FALSE;
+    }
+  }
+
+  ImageContext->EntryPoint = ImageContext->ImageAddress + Hdr.Pe32->OptionalHeader.AddressOfEntryPoint;
+  return TRUE;
+}
+
 EFI_STATUS
 CoreDevicePathToInterface (
   IN EFI_GUID                     *Protocol,
@@ -0,0 +1,1599 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  ImageLoadTest.c
+
+Abstract:
+
+  Host test and benchmark for reading PE32 images out of firmware volumes.
+
+  The DXE core FwVol driver, the section extraction protocol, ImageFile.c
+  and the PE/COFF loader are linked into a host program. A firmware volume
+  of synthetic X64 drivers is built in memory and exposed through a memory
+  mapped firmware volume block. The test checks that
+
+    - CoreFvGetSectionInPlace returns the same PE32 section as ReadSection,
+      and refuses files where an encapsulation section comes first, since
+      ReadSection would return the image inside it,
+    - CoreOpenImageFile reads those files through ReadSection,
+    - the reported mapped address holds the section in the volume,
+    - CoreImageCanExecuteInPlace only accepts read only images linked at
+      their address in the volume,
+    - the batched relocation runs give the same image as the per entry
+      relocation used when fixup data is recorded.
+
+  With -b the program times loading every driver of the volume the way
+  the core did before (ReadSection copy, per entry relocation), with the
+  section used in place and batched relocation, and executing in place.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Image.h"
+#include "FwVolDriver.h"
+
+extern EFI_PEI_PE_COFF_LOADER_PROTOCOL  mPeCoffLoader;
+
+#define TEST_PAGE_SIZE          0x1000
+#define TEST_FV_SIZE            (32 * 1024 * 1024)
+#define TEST_LINK_ADDRESS       0x10000000
+#define TEST_MAX_FILES          128
+
+//
+// Kinds of drivers put in the volume
+//
+typedef enum {
+  DriverXip,              // read only, linked at its address in the volume
+  DriverXipWritable,      // linked at its address, but has a .data section
+  DriverXipBss,           // linked at its address, with uninitialized data
+  DriverXipResource,      // linked at its address, with a resource directory
+  DriverXipRuntime,       // linked at its address, but a runtime driver
+  DriverRelocated,        // linked elsewhere, stored right after the header
+  DriverEncapsulated,     // a compression section comes before the PE32
+  DriverEncapsulatedLast  // the PE32 comes before a compression section
+} TEST_DRIVER_KIND;
+
+typedef struct {
+  EFI_GUID          Name;
+  TEST_DRIVER_KIND  Kind;
+  UINT8             *Image;       // the image ReadSection returns, in the volume
+  UINTN             ImageSize;
+} TEST_FILE;
+
+typedef struct {
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  Fvb;
+  UINT8                               *Base;
+  UINTN                               Size;
+  BOOLEAN                             MemoryMapped;
+} TEST_FVB;
+
+typedef struct {
+  MEDIA_FW_VOL_FILEPATH_DEVICE_PATH   FvFile;
+  EFI_DEVICE_PATH_PROTOCOL            End;
+} TEST_FV_FILE_DEVICE_PATH;
+
+static UINTN              mFailures = 0;
+static TEST_FVB           mTestFvb;
+static FV_DEVICE          *mTestFv;
+static TEST_FILE          mFiles[TEST_MAX_FILES];
+static UINTN              mFileCount;
+static UINT8              *mFvEnd;
+static EFI_HANDLE         mFvHandle = (EFI_HANDLE) &mFvHandle;
+
+//
+// Protocols installed by the code under test
+//
+#define TEST_MAX_PROTOCOLS      8
+
+static EFI_GUID           *mProtocolGuid[TEST_MAX_PROTOCOLS];
+static VOID               *mProtocolInterface[TEST_MAX_PROTOCOLS];
+static UINTN              mProtocolCount;
+
+//
+// The firmware volume protocol template of FwVol.c
+//
+extern FV_DEVICE          mFvDevice;
+
+static
+VOID
+Check (
+  IN BOOLEAN  Condition,
+  IN char     *Test,
+  IN char     *What
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Condition - The result of the check
+  Test      - Name of the test
+  What      - The condition that was checked
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Condition) {
+    return ;
+  }
+
+  if (mFailures < 20) {
+    printf ("FAIL: %s: %s\n", Test, What);
+  }
+
+  mFailures++;
+}
+
+static
+VOID *
+AllocatePages (
+  IN UINTN  Size
+  )
+/*++
+
+Routine Description:
+
+  Allocate a page aligned buffer. The host C library of the tools has no
+  aligned allocator, so the original pointer is kept below the buffer.
+
+Arguments:
+
+  Size - Number of bytes
+
+Returns:
+
+  The buffer, free it with FreePages ().
+
+--*/
+{
+  UINT8   *Raw;
+  UINT8   *Buffer;
+
+  Raw = malloc (Size + TEST_PAGE_SIZE);
+  if (Raw == NULL) {
+    return NULL;
+  }
+
+  Buffer = (UINT8 *) (((UINTN) Raw + TEST_PAGE_SIZE) & ~(UINTN) (TEST_PAGE_SIZE - 1));
+  ((VOID **) Buffer)[-1] = Raw;
+  return Buffer;
+}
+
+static
+VOID
+FreePages (
+  IN VOID   *Buffer
+  )
+{
+  free (((VOID **) Buffer)[-1]);
+}
+
+//
+// The DXE core services used by the linked modules
+//
+
+VOID *
+CoreAllocateBootServicesPool (
+  IN  UINTN   AllocationSize
+  )
+{
+  return malloc (AllocationSize != 0 ? AllocationSize : 1);
+}
+
+VOID *
+CoreAllocateZeroBootServicesPool (
+  IN  UINTN   AllocationSize
+  )
+{
+  return calloc (1, AllocationSize != 0 ? AllocationSize : 1);
+}
+
+VOID *
+CoreAllocateCopyPool (
+  IN  UINTN   AllocationSize,
+  IN  VOID    *Buffer
+  )
+{
+  VOID  *Memory;
+
+  Memory = malloc (AllocationSize);
+  if (Memory != NULL) {
+    memcpy (Memory, Buffer, AllocationSize);
+  }
+
+  return Memory;
+}
+
+VOID *
+CoreAllocateRuntimePool (
+  IN  UINTN   AllocationSize
+  )
+{
+  return malloc (AllocationSize);
+}
+
+EFI_STATUS
+EFIAPI
+CoreFreePool (
+  IN VOID        *Buffer
+  )
+{
+  free (Buffer);
+  return EFI_SUCCESS;
+}
+
+EFI_TPL
+EFIAPI
+CoreRaiseTpl (
+  IN EFI_TPL      NewTpl
+  )
+{
+  return EFI_TPL_APPLICATION;
+}
+
+VOID
+EFIAPI
+CoreRestoreTpl (
+  IN EFI_TPL NewTpl
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+CoreInstallProtocolInterface (
+  IN OUT EFI_HANDLE     *UserHandle,
+  IN EFI_GUID           *Protocol,
+  IN EFI_INTERFACE_TYPE InterfaceType,
+  IN VOID               *Interface
+  )
+{
+  if (mProtocolCount == TEST_MAX_PROTOCOLS) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mProtocolGuid[mProtocolCount]      = Protocol;
+  mProtocolInterface[mProtocolCount] = Interface;
+  mProtocolCount++;
+  if (*UserHandle == NULL) {
+    *UserHandle = (EFI_HANDLE) &mProtocolInterface[mProtocolCount - 1];
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+CoreLocateProtocol (
+  IN  EFI_GUID  *Protocol,
+  IN  VOID      *Registration OPTIONAL,
+  OUT VOID      **Interface
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mProtocolCount; Index++) {
+    if (EfiCompareGuid (mProtocolGuid[Index], Protocol)) {
+      *Interface = mProtocolInterface[Index];
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+EFI_STATUS
+EFIAPI
+CoreHandleProtocol (
+  IN  EFI_HANDLE       UserHandle,
+  IN  EFI_GUID         *Protocol,
+  OUT VOID             **Interface
+  )
+{
+  if (UserHandle == mFvHandle &&
+      EfiCompareGuid (Protocol, &gEfiFirmwareVolumeProtocolGuid)) {
+    *Interface = &mTestFv->Fv;
+    return EFI_SUCCESS;
+  }
+
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+CoreLocateDevicePath (
+  IN EFI_GUID                       *Protocol,
+  IN OUT EFI_DEVICE_PATH_PROTOCOL   **FilePath,
+  OUT EFI_HANDLE                    *Device
+  )
+/*++
+
+Routine Description:
+
+  Every device path used by the test is a firmware volume file node of the
+  test volume, so the volume handle matches with nothing consumed.
+
+--*/
+{
+  if (EfiCompareGuid (Protocol, &gEfiFirmwareVolumeProtocolGuid)) {
+    *Device = mFvHandle;
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+EFI_GUID *
+CoreGetNameGuidFromFwVolDevicePathNode (
+  IN  MEDIA_FW_VOL_FILEPATH_DEVICE_PATH   *FvDevicePathNode
+  )
+{
+  if (DevicePathType (&FvDevicePathNode->Header) == MEDIA_DEVICE_PATH &&
+      DevicePathSubType (&FvDevicePathNode->Header) == MEDIA_FV_FILEPATH_DP) {
+    return &FvDevicePathNode->NameGuid;
+  }
+
+  return NULL;
+}
+
+EFI_STATUS
+EFIAPI
+CoreLocateHandle (
+  IN     EFI_LOCATE_SEARCH_TYPE         SearchType,
+  IN     EFI_GUID                       *Protocol OPTIONAL,
+  IN     VOID                           *SearchKey OPTIONAL,
+  IN OUT UINTN                          *BufferSize,
+  OUT    EFI_HANDLE                     *Buffer
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+EFI_EVENT
+CoreCreateProtocolNotifyEvent (
+  IN EFI_GUID             *ProtocolGuid,
+  IN EFI_TPL              NotifyTpl,
+  IN EFI_EVENT_NOTIFY     NotifyFunction,
+  IN VOID                 *NotifyContext,
+  OUT VOID                **Registration,
+  IN  BOOLEAN             SignalFlag
+  )
+{
+  return NULL;
+}
+
+EFI_STATUS
+EFIAPI
+CoreCloseEvent (
+  IN EFI_EVENT            Event
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_DEVICE_PATH_PROTOCOL *
+CoreDuplicateDevicePath (
+  IN EFI_DEVICE_PATH_PROTOCOL   *DevicePath
+  )
+{
+  return NULL;
+}
+
+//
+// The memory routines of the PEI library the PE/COFF loader is built with
+//
+
+VOID
+ZeroMem (
+  IN VOID   *Buffer,
+  IN UINTN  Size
+  )
+{
+  memset (Buffer, 0, Size);
+}
+
+VOID
+CopyMem (
+  IN VOID   *Destination,
+  IN VOID   *Source,
+  IN UINTN  Length
+  )
+{
+  memmove (Destination, Source, Length);
+}
+
+//
+// The memory mapped firmware volume block of the test volume
+//
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbGetAttributes (
+  IN  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT EFI_FVB_ATTRIBUTES                  *Attributes
+  )
+{
+  *Attributes = EFI_FVB_READ_STATUS | EFI_FVB_ERASE_POLARITY;
+  if (mTestFvb.MemoryMapped) {
+    *Attributes |= EFI_FVB_MEMORY_MAPPED;
+  }
+
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbGetPhysicalAddress (
+  IN  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT EFI_PHYSICAL_ADDRESS                *Address
+  )
+{
+  if (!mTestFvb.MemoryMapped) {
+    return EFI_UNSUPPORTED;
+  }
+
+  *Address = (EFI_PHYSICAL_ADDRESS) (UINTN) mTestFvb.Base;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbRead (
+  IN     EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN     EFI_LBA                             Lba,
+  IN     UINTN                               Offset,
+  IN OUT UINTN                               *NumBytes,
+  OUT    UINT8                               *Buffer
+  )
+{
+  UINTN  Start;
+
+  Start = (UINTN) Lba * TEST_PAGE_SIZE + Offset;
+  if (Start + *NumBytes > mTestFvb.Size) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  memcpy (Buffer, mTestFvb.Base + Start, *NumBytes);
+  return EFI_SUCCESS;
+}
+
+//
+// Building the test volume
+//
+
+static
+UINT32
+Random (
+  VOID
+  )
+{
+  static UINT32  State = 0x2545F491;
+
+  State ^= State << 13;
+  State ^= State >> 17;
+  State ^= State << 5;
+  return State;
+}
+
+static
+VOID
+MakeName (
+  IN  UINTN     Index,
+  OUT EFI_GUID  *Name
+  )
+{
+  memset (Name, 0, sizeof (*Name));
+  Name->Data1    = 0x1A6E0000 | (UINT32) Index;
+  Name->Data2    = 0x7E57;
+  Name->Data4[0] = (UINT8) (Index * 37);
+  Name->Data4[7] = (UINT8) (Index * 101);
+}
+
+static
+UINT8 *
+SetSectionHeader (
+  IN  UINT8             *Section,
+  IN  UINTN             Size,
+  IN  EFI_SECTION_TYPE  Type
+  )
+{
+  EFI_COMMON_SECTION_HEADER  *Header;
+
+  Header          = (EFI_COMMON_SECTION_HEADER *) Section;
+  Header->Size[0] = (UINT8) Size;
+  Header->Size[1] = (UINT8) (Size >> 8);
+  Header->Size[2] = (UINT8) (Size >> 16);
+  Header->Type    = Type;
+  return Section + sizeof (EFI_COMMON_SECTION_HEADER);
+}
+
+static
+UINTN
+BuildPeImage (
+  OUT UINT8             *Image,
+  IN  UINT64            ImageBase,
+  IN  UINTN             TextSize,
+  IN  TEST_DRIVER_KIND  Kind
+  )
+/*++
+
+Routine Description:
+
+  Build an X64 driver with a .text, a .rdata or .data and a .reloc
+  section, stored with file offsets equal to the section RVAs. The code
+  and data sections hold pointers into the image every 40 bytes, each with
+  a DIR64 relocation, broken up by runs of HIGHLOW and ABSOLUTE entries.
+
+Arguments:
+
+  Image     - Buffer for the image
+  ImageBase - Address the image is linked at
+  TextSize  - Size of .text, a multiple of the page size
+  Kind      - What kind of driver to build
+
+Returns:
+
+  The size of the image.
+
+--*/
+{
+  EFI_IMAGE_DOS_HEADER      *DosHdr;
+  EFI_IMAGE_NT_HEADERS64    *PeHdr;
+  EFI_IMAGE_SECTION_HEADER  *Section;
+  EFI_IMAGE_BASE_RELOCATION *Block;
+  UINT16                    *Entry;
+  UINTN                     DataRva;
+  UINTN                     DataSize;
+  UINTN                     RelocRva;
+  UINTN                     RelocSize;
+  UINTN                     ImageSize;
+  UINTN                     Page;
+  UINTN                     Offset;
+  UINTN                     Count;
+
+  DataRva   = TEST_PAGE_SIZE + TextSize;
+  DataSize  = (TextSize / 4 + TEST_PAGE_SIZE - 1) & ~(TEST_PAGE_SIZE - 1);
+  RelocRva  = DataRva + DataSize;
+
+  //
+  // Fill the headers, code and data with noise, then place the pointers
+  //
+  for (Offset = 0; Offset < RelocRva; Offset++) {
+    Image[Offset] = (UINT8) Random ();
+  }
+
+  Block = (EFI_IMAGE_BASE_RELOCATION *) (Image + RelocRva);
+  for (Page = TEST_PAGE_SIZE; Page < RelocRva; Page += TEST_PAGE_SIZE) {
+    Block->VirtualAddress = (UINT32) Page;
+    Entry = (UINT16 *) (Block + 1);
+    Count = 0;
+    for (Offset = 0; Offset + 8 <= TEST_PAGE_SIZE; Offset += 40) {
+      if ((Offset / 40) % 16 == 7) {
+        *(UINT32 *) (Image + Page + Offset) = (UINT32) (ImageBase + Page + Offset);
+        Entry[Count++] = (UINT16) ((EFI_IMAGE_REL_BASED_HIGHLOW << 12) | Offset);
+      } else {
+        *(UINT64 *) (Image + Page + Offset) = ImageBase + ((Page + Offset * 7) % RelocRva);
+        Entry[Count++] = (UINT16) ((EFI_IMAGE_REL_BASED_DIR64 << 12) | Offset);
+      }
+      if ((Offset / 40) % 32 == 31) {
+        Entry[Count++] = (UINT16) (EFI_IMAGE_REL_BASED_ABSOLUTE << 12);
+      }
+    }
+    if ((Count & 1) != 0) {
+      Entry[Count++] = (UINT16) (EFI_IMAGE_REL_BASED_ABSOLUTE << 12);
+    }
+    Block->SizeOfBlock = (UINT32) (sizeof (EFI_IMAGE_BASE_RELOCATION) + Count * sizeof (UINT16));
+    Block = (EFI_IMAGE_BASE_RELOCATION *) ((UINT8 *) Block + Block->SizeOfBlock);
+  }
+  RelocSize = (UINT8 *) Block - (Image + RelocRva);
+  ImageSize = (RelocRva + RelocSize + TEST_PAGE_SIZE - 1) & ~(TEST_PAGE_SIZE - 1);
+  memset (Image + RelocRva + RelocSize, 0, ImageSize - RelocRva - RelocSize);
+
+  //
+  // Headers
+  //
+  memset (Image, 0, TEST_PAGE_SIZE);
+  DosHdr           = (EFI_IMAGE_DOS_HEADER *) Image;
+  DosHdr->e_magic  = EFI_IMAGE_DOS_SIGNATURE;
+  DosHdr->e_lfanew = 0x80;
+
+  PeHdr = (EFI_IMAGE_NT_HEADERS64 *) (Image + DosHdr->e_lfanew);
+  PeHdr->Signature                        = EFI_IMAGE_NT_SIGNATURE;
+  PeHdr->FileHeader.Machine               = EFI_IMAGE_MACHINE_X64;
+  PeHdr->FileHeader.NumberOfSections      = 3;
+  PeHdr->FileHeader.SizeOfOptionalHeader  = sizeof (EFI_IMAGE_OPTIONAL_HEADER64);
+  PeHdr->FileHeader.Characteristics       = EFI_IMAGE_FILE_EXECUTABLE_IMAGE;
+  PeHdr->OptionalHeader.Magic             = EFI_IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+  PeHdr->OptionalHeader.AddressOfEntryPoint = TEST_PAGE_SIZE + 0x10;
+  PeHdr->OptionalHeader.ImageBase         = ImageBase;
+  PeHdr->OptionalHeader.SectionAlignment  = TEST_PAGE_SIZE;
+  PeHdr->OptionalHeader.FileAlignment     = TEST_PAGE_SIZE;
+  PeHdr->OptionalHeader.SizeOfImage       = (UINT32) ImageSize;
+  PeHdr->OptionalHeader.SizeOfHeaders     = TEST_PAGE_SIZE;
+  PeHdr->OptionalHeader.Subsystem         = EFI_IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER;
+  PeHdr->OptionalHeader.NumberOfRvaAndSizes = EFI_IMAGE_NUMBER_OF_DIRECTORY_ENTRIES;
+  PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress = (UINT32) RelocRva;
+  PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].Size           = (UINT32) RelocSize;
+
+  if (Kind == DriverXipRuntime) {
+    PeHdr->OptionalHeader.Subsystem = EFI_IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER;
+  }
+  if (Kind == DriverXipResource) {
+    //
+    // Only the presence of the directory matters, it is never parsed
+    //
+    PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress = (UINT32) DataRva;
+    PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_RESOURCE].Size           = 0;
+    PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_RESOURCE].Size           = sizeof (EFI_IMAGE_RESOURCE_DIRECTORY);
+    memset (Image + DataRva, 0, sizeof (EFI_IMAGE_RESOURCE_DIRECTORY));
+  }
+
+  Section = (EFI_IMAGE_SECTION_HEADER *) (PeHdr + 1);
+  memcpy (Section->Name, ".text", 6);
+  Section->Misc.VirtualSize = (UINT32) TextSize;
+  Section->VirtualAddress   = TEST_PAGE_SIZE;
+  Section->SizeOfRawData    = (UINT32) TextSize;
+  Section->PointerToRawData = TEST_PAGE_SIZE;
+  Section->Characteristics  = EFI_IMAGE_SCN_CNT_CODE | EFI_IMAGE_SCN_MEM_EXECUTE | EFI_IMAGE_SCN_MEM_READ;
+  Section++;
+
+  memcpy (Section->Name, ".rdata", 7);
+  Section->Misc.VirtualSize = (UINT32) DataSize;
+  Section->VirtualAddress   = (UINT32) DataRva;
+  Section->SizeOfRawData    = (UINT32) DataSize;
+  Section->PointerToRawData = (UINT32) DataRva;
+  Section->Characteristics  = EFI_IMAGE_SCN_CNT_INITIALIZED_DATA | EFI_IMAGE_SCN_MEM_READ;
+  if (Kind == DriverXipWritable) {
+    memcpy (Section->Name, ".data", 6);
+    Section->Characteristics |= EFI_IMAGE_SCN_MEM_WRITE;
+  }
+  if (Kind == DriverXipBss) {
+    Section->SizeOfRawData = (UINT32) (DataSize / 2);
+  }
+  Section++;
+
+  memcpy (Section->Name, ".reloc", 7);
+  Section->Misc.VirtualSize = (UINT32) RelocSize;
+  Section->VirtualAddress   = (UINT32) RelocRva;
+  Section->SizeOfRawData    = (UINT32) (ImageSize - RelocRva);
+  Section->PointerToRawData = (UINT32) RelocRva;
+  Section->Characteristics  = EFI_IMAGE_SCN_CNT_INITIALIZED_DATA | EFI_IMAGE_SCN_MEM_DISCARDABLE | EFI_IMAGE_SCN_MEM_READ;
+
+  return ImageSize;
+}
+
+static
+UINT8 *
+AddFile (
+  IN  UINT8             *FvCursor,
+  IN  TEST_DRIVER_KIND  Kind,
+  IN  UINTN             TextSize
+  )
+/*++
+
+Routine Description:
+
+  Append a driver file to the test volume. Files whose image is linked at
+  its address in the volume get a leading raw section that pads the PE32
+  data to a page boundary.
+
+Arguments:
+
+  FvCursor - Where the file starts, 8 byte aligned
+  Kind     - What kind of driver to add
+  TextSize - Size of the .text section of the image
+
+Returns:
+
+  The end of the file.
+
+--*/
+{
+  EFI_FFS_FILE_HEADER       *FfsHeader;
+  TEST_FILE                 *File;
+  UINT8                     *Section;
+  UINT8                     *Image;
+  UINT8                     *Inner;
+  UINTN                     ImageSize;
+  UINTN                     InnerSize;
+  UINTN                     PadSize;
+  UINTN                     Index;
+  UINT8                     Sum;
+  EFI_COMPRESSION_SECTION   *Compression;
+
+  File = &mFiles[mFileCount];
+  Image     = NULL;
+  ImageSize = 0;
+  MakeName (mFileCount, &File->Name);
+  File->Kind = Kind;
+  mFileCount++;
+
+  FfsHeader = (EFI_FFS_FILE_HEADER *) FvCursor;
+  Section   = (UINT8 *) (FfsHeader + 1);
+
+  switch (Kind) {
+  case DriverRelocated:
+    Image     = Section + sizeof (EFI_COMMON_SECTION_HEADER);
+    ImageSize = BuildPeImage (Image, TEST_LINK_ADDRESS, TextSize, Kind);
+    Section   = SetSectionHeader (Section, ImageSize + sizeof (EFI_COMMON_SECTION_HEADER), EFI_SECTION_PE32) + ImageSize;
+    break;
+
+  case DriverEncapsulated:
+  case DriverEncapsulatedLast:
+    //
+    // The image ReadSection returns is the first PE32 in depth first order
+    //
+    if (Kind == DriverEncapsulatedLast) {
+      Image     = Section + sizeof (EFI_COMMON_SECTION_HEADER);
+      ImageSize = BuildPeImage (Image, TEST_LINK_ADDRESS, TextSize, Kind);
+      Section   = SetSectionHeader (Section, ImageSize + sizeof (EFI_COMMON_SECTION_HEADER), EFI_SECTION_PE32) + ImageSize;
+    }
+
+    Compression = (EFI_COMPRESSION_SECTION *) Section;
+    Inner       = (UINT8 *) (Compression + 1) + sizeof (EFI_COMMON_SECTION_HEADER);
+    InnerSize   = BuildPeImage (Inner, TEST_LINK_ADDRESS, TextSize, Kind);
+    SetSectionHeader ((UINT8 *) (Compression + 1), InnerSize + sizeof (EFI_COMMON_SECTION_HEADER), EFI_SECTION_PE32);
+    Compression->UncompressedLength = (UINT32) (InnerSize + sizeof (EFI_COMMON_SECTION_HEADER));
+    Compression->CompressionType    = EFI_NOT_COMPRESSED;
+    SetSectionHeader (Section, sizeof (EFI_COMPRESSION_SECTION) + Compression->UncompressedLength, EFI_SECTION_COMPRESSION);
+    Section = Inner + InnerSize;
+
+    if (Kind == DriverEncapsulated) {
+      Image     = Inner;
+      ImageSize = InnerSize;
+      Section   = (UINT8 *) (((UINTN) Section + 3) & ~(UINTN) 3);
+      Section   = SetSectionHeader (Section, TEST_PAGE_SIZE + sizeof (EFI_COMMON_SECTION_HEADER), EFI_SECTION_PE32);
+      BuildPeImage (Section, TEST_LINK_ADDRESS, TEST_PAGE_SIZE, DriverRelocated);
+      Section  += TEST_PAGE_SIZE;
+    }
+    break;
+
+  default:
+    Image = (UINT8 *) (((UINTN) Section + 2 * sizeof (EFI_COMMON_SECTION_HEADER) + TEST_PAGE_SIZE - 1) & ~(UINTN) (TEST_PAGE_SIZE - 1));
+    PadSize = Image - sizeof (EFI_COMMON_SECTION_HEADER) - Section;
+    memset (Section + sizeof (EFI_COMMON_SECTION_HEADER), 0, PadSize - sizeof (EFI_COMMON_SECTION_HEADER));
+    SetSectionHeader (Section, PadSize, EFI_SECTION_RAW);
+    ImageSize = BuildPeImage (Image, (UINT64) (UINTN) Image, TextSize, Kind);
+    SetSectionHeader (Image - sizeof (EFI_COMMON_SECTION_HEADER), ImageSize + sizeof (EFI_COMMON_SECTION_HEADER), EFI_SECTION_PE32);
+    Section   = Image + ImageSize;
+    break;
+  }
+
+  File->Image     = Image;
+  File->ImageSize = ImageSize;
+
+  //
+  // File header, with the state bits inverted for an erase polarity of 1
+  //
+  memcpy (&FfsHeader->Name, &File->Name, sizeof (EFI_GUID));
+  FfsHeader->Type       = EFI_FV_FILETYPE_DRIVER;
+  FfsHeader->Attributes = 0;
+  FfsHeader->Size[0]    = (UINT8) (Section - FvCursor);
+  FfsHeader->Size[1]    = (UINT8) ((Section - FvCursor) >> 8);
+  FfsHeader->Size[2]    = (UINT8) ((Section - FvCursor) >> 16);
+  FfsHeader->IntegrityCheck.Checksum.Header = 0;
+  FfsHeader->IntegrityCheck.Checksum.File   = FFS_FIXED_CHECKSUM;
+  FfsHeader->State      = 0;
+  Sum = 0;
+  for (Index = 0; Index < sizeof (EFI_FFS_FILE_HEADER); Index++) {
+    Sum = (UINT8) (Sum + ((UINT8 *) FfsHeader)[Index]);
+  }
+  FfsHeader->IntegrityCheck.Checksum.Header = (UINT8) (0x100 - (UINT8) (Sum - FFS_FIXED_CHECKSUM));
+  FfsHeader->State = (EFI_FFS_FILE_STATE) ~(EFI_FILE_HEADER_CONSTRUCTION | EFI_FILE_HEADER_VALID | EFI_FILE_DATA_VALID);
+
+  return (UINT8 *) (((UINTN) Section + 7) & ~(UINTN) 7);
+}
+
+static
+VOID
+CloseVolume (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Free the firmware volume device of the test volume, the way
+  FreeFvDeviceResource does.
+
+--*/
+{
+  FFS_FILE_LIST_ENTRY  *FfsFileEntry;
+  EFI_LIST_ENTRY       *Link;
+
+  if (mTestFv == NULL) {
+    return ;
+  }
+
+  Link = mTestFv->FfsFileListHeader.ForwardLink;
+  while (Link != &mTestFv->FfsFileListHeader) {
+    FfsFileEntry = (FFS_FILE_LIST_ENTRY *) Link;
+    Link         = Link->ForwardLink;
+    if (FfsFileEntry->StreamHandle != 0) {
+      FfsFileEntry->Sep->CloseSectionStream (FfsFileEntry->Sep, FfsFileEntry->StreamHandle);
+    }
+    free (FfsFileEntry);
+  }
+
+  free (mTestFv->CachedFv);
+  free (mTestFv->FwVolHeader);
+  free (mTestFv);
+  mTestFv = NULL;
+}
+
+static
+VOID
+OpenVolume (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Layer the DXE core firmware volume protocol on the test volume the way
+  NotifyFwVolBlock does, dropping any device of an earlier volume.
+
+--*/
+{
+  EFI_STATUS  Status;
+
+  CloseVolume ();
+
+  mTestFv = CoreAllocateCopyPool (sizeof (FV_DEVICE), &mFvDevice);
+  mTestFv->Fvb    = &mTestFvb.Fvb;
+  mTestFv->Handle = mFvHandle;
+  Status = GetFwVolHeader (&mTestFvb.Fvb, &mTestFv->FwVolHeader);
+  Check (!EFI_ERROR (Status) && VerifyFvHeaderChecksum (mTestFv->FwVolHeader), "OpenVolume", "volume header is valid");
+  Status = FvCheck (mTestFv);
+  Check (!EFI_ERROR (Status), "OpenVolume", "FvCheck () accepts the volume");
+}
+
+static
+VOID
+BuildVolume (
+  IN  TEST_DRIVER_KIND  *Kinds,
+  IN  UINTN             Count,
+  IN  UINTN             TextSize
+  )
+/*++
+
+Routine Description:
+
+  Build a firmware volume with one driver of each given kind, and layer the
+  DXE core firmware volume protocol on it the way NotifyFwVolBlock does.
+
+Arguments:
+
+  Kinds    - The kind of each driver
+  Count    - Number of drivers
+  TextSize - Size of the .text section of each image
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FwVolHeader;
+  UINT8                       *Cursor;
+  UINT16                      Sum;
+  UINTN                       Index;
+
+  if (mTestFvb.Base == NULL) {
+    mTestFvb.Base = AllocatePages (TEST_FV_SIZE);
+    mTestFvb.Size = TEST_FV_SIZE;
+  }
+  mTestFvb.Fvb.GetVolumeAttributes = TestFvbGetAttributes;
+  mTestFvb.Fvb.GetPhysicalAddress  = TestFvbGetPhysicalAddress;
+  mTestFvb.Fvb.Read                = TestFvbRead;
+  mTestFvb.MemoryMapped            = TRUE;
+
+  memset (mTestFvb.Base, 0xFF, mTestFvb.Size);
+  FwVolHeader = (EFI_FIRMWARE_VOLUME_HEADER *) mTestFvb.Base;
+  memset (FwVolHeader, 0, sizeof (*FwVolHeader) + sizeof (EFI_FV_BLOCK_MAP_ENTRY));
+  memcpy (&FwVolHeader->FileSystemGuid, &gEfiFirmwareFileSystemGuid, sizeof (EFI_GUID));
+  FwVolHeader->FvLength     = mTestFvb.Size;
+  FwVolHeader->Signature    = EFI_FVH_SIGNATURE;
+  FwVolHeader->Attributes   = EFI_FVB_READ_STATUS | EFI_FVB_ERASE_POLARITY | EFI_FVB_MEMORY_MAPPED;
+  FwVolHeader->HeaderLength = (UINT16) (sizeof (*FwVolHeader) + sizeof (EFI_FV_BLOCK_MAP_ENTRY));
+  FwVolHeader->Revision     = EFI_FVH_REVISION;
+  FwVolHeader->FvBlockMap[0].NumBlocks   = (UINT32) (mTestFvb.Size / TEST_PAGE_SIZE);
+  FwVolHeader->FvBlockMap[0].BlockLength = TEST_PAGE_SIZE;
+  Sum = 0;
+  for (Index = 0; Index < FwVolHeader->HeaderLength / sizeof (UINT16); Index++) {
+    Sum = (UINT16) (Sum + ((UINT16 *) FwVolHeader)[Index]);
+  }
+  FwVolHeader->Checksum = (UINT16) (0x10000 - Sum);
+
+  mFileCount = 0;
+  Cursor     = mTestFvb.Base + FwVolHeader->HeaderLength;
+  for (Index = 0; Index < Count; Index++) {
+    Cursor = AddFile (Cursor, Kinds[Index], TextSize);
+  }
+  mFvEnd = Cursor;
+
+  OpenVolume ();
+}
+
+//
+// The tests
+//
+
+static
+EFI_STATUS
+OpenImage (
+  IN  TEST_FILE           *File,
+  OUT IMAGE_FILE_HANDLE   *FHand
+  )
+/*++
+
+Routine Description:
+
+  Open the image of a file of the test volume through its device path, as
+  CoreLoadImage does.
+
+--*/
+{
+  TEST_FV_FILE_DEVICE_PATH  DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL  *FilePath;
+  EFI_HANDLE                DeviceHandle;
+  UINT32                    AuthenticationStatus;
+
+  DevicePath.FvFile.Header.Type    = MEDIA_DEVICE_PATH;
+  DevicePath.FvFile.Header.SubType = MEDIA_FV_FILEPATH_DP;
+  SetDevicePathNodeLength (&DevicePath.FvFile.Header, sizeof (MEDIA_FW_VOL_FILEPATH_DEVICE_PATH));
+  memcpy (&DevicePath.FvFile.NameGuid, &File->Name, sizeof (EFI_GUID));
+  SetDevicePathEndNode (&DevicePath.End);
+
+  FilePath = (EFI_DEVICE_PATH_PROTOCOL *) &DevicePath;
+  return CoreOpenImageFile (FALSE, NULL, 0, &FilePath, &DeviceHandle, FHand, &AuthenticationStatus);
+}
+
+static
+VOID
+CloseImage (
+  IN  IMAGE_FILE_HANDLE   *FHand
+  )
+{
+  if (FHand->FreeBuffer) {
+    CoreFreePool (FHand->Source);
+  }
+}
+
+static
+EFI_STATUS
+GetImageInfo (
+  IN  IMAGE_FILE_HANDLE                     *FHand,
+  OUT EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext
+  )
+{
+  memset (ImageContext, 0, sizeof (*ImageContext));
+  ImageContext->Handle    = FHand;
+  ImageContext->ImageRead = (EFI_PEI_PE_COFF_LOADER_READ_FILE) CoreReadImageFile;
+  return mPeCoffLoader.GetImageInfo (&mPeCoffLoader, ImageContext);
+}
+
+static
+EFI_STATUS
+LoadImage (
+  IN OUT EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext,
+  IN     UINT8                                 *Destination,
+  IN     BOOLEAN                               RecordFixups
+  )
+/*++
+
+Routine Description:
+
+  Load and relocate an image to Destination the way CoreLoadPeImage does.
+  With RecordFixups the loader records fixup data as for a runtime driver,
+  which makes it take the per entry relocation path.
+
+--*/
+{
+  EFI_STATUS  Status;
+
+  ImageContext->ImageAddress = (EFI_PHYSICAL_ADDRESS) (UINTN) Destination;
+  Status = mPeCoffLoader.LoadImage (&mPeCoffLoader, ImageContext);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ImageContext->FixupData = NULL;
+  if (RecordFixups) {
+    ImageContext->FixupData = malloc ((UINTN) ImageContext->FixupDataSize);
+  }
+
+  Status = mPeCoffLoader.RelocateImage (&mPeCoffLoader, ImageContext);
+
+  free (ImageContext->FixupData);
+  ImageContext->FixupData = NULL;
+  return Status;
+}
+
+static
+VOID
+ReferenceRelocate (
+  IN OUT UINT8   *Image,
+  IN     UINT64  NewBase
+  )
+/*++
+
+Routine Description:
+
+  Load an image stored with file offsets equal to the section RVAs in
+  place: clear the uninitialized data, then apply the base relocations one
+  entry at a time.
+
+--*/
+{
+  EFI_IMAGE_NT_HEADERS64     *PeHdr;
+  EFI_IMAGE_SECTION_HEADER   *Section;
+  EFI_IMAGE_BASE_RELOCATION  *Block;
+  UINT8                      *BlockEnd;
+  UINT16                     *Entry;
+  UINT64                     Adjust;
+  UINTN                      Index;
+
+  PeHdr    = (EFI_IMAGE_NT_HEADERS64 *) (Image + ((EFI_IMAGE_DOS_HEADER *) Image)->e_lfanew);
+  Section  = (EFI_IMAGE_SECTION_HEADER *) (PeHdr + 1);
+  for (Index = 0; Index < PeHdr->FileHeader.NumberOfSections; Index++, Section++) {
+    if (Section->SizeOfRawData < Section->Misc.VirtualSize) {
+      memset (Image + Section->VirtualAddress + Section->SizeOfRawData, 0, Section->Misc.VirtualSize - Section->SizeOfRawData);
+    }
+  }
+
+  Adjust   = NewBase - PeHdr->OptionalHeader.ImageBase;
+  Block    = (EFI_IMAGE_BASE_RELOCATION *) (Image + PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress);
+  BlockEnd = (UINT8 *) Block + PeHdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].Size;
+
+  while ((UINT8 *) Block < BlockEnd) {
+    for (Entry = (UINT16 *) (Block + 1); (UINT8 *) Entry < (UINT8 *) Block + Block->SizeOfBlock; Entry++) {
+      switch (*Entry >> 12) {
+      case EFI_IMAGE_REL_BASED_DIR64:
+        *(UINT64 *) (Image + Block->VirtualAddress + (*Entry & 0xFFF)) += Adjust;
+        break;
+      case EFI_IMAGE_REL_BASED_HIGHLOW:
+        *(UINT32 *) (Image + Block->VirtualAddress + (*Entry & 0xFFF)) += (UINT32) Adjust;
+        break;
+      }
+    }
+    Block = (EFI_IMAGE_BASE_RELOCATION *) ((UINT8 *) Block + Block->SizeOfBlock);
+  }
+}
+
+static TEST_DRIVER_KIND mTestKinds[] = {
+  DriverXip,
+  DriverXipWritable,
+  DriverRelocated,
+  DriverEncapsulated,
+  DriverXipBss,
+  DriverXip,
+  DriverEncapsulatedLast,
+  DriverXipResource,
+  DriverXipRuntime,
+  DriverRelocated,
+  DriverXip
+};
+
+#define TEST_KIND_COUNT   (sizeof (mTestKinds) / sizeof (mTestKinds[0]))
+
+static
+VOID
+TestSectionInPlace (
+  VOID
+  )
+{
+  EFI_FIRMWARE_VOLUME_PROTOCOL  OtherFv;
+  TEST_FILE                     *File;
+  EFI_GUID                      Missing;
+  VOID                          *Buffer;
+  UINTN                         BufferSize;
+  VOID                          *ReadBuffer;
+  UINTN                         ReadBufferSize;
+  EFI_PHYSICAL_ADDRESS          MappedAddress;
+  UINT32                        AuthenticationStatus;
+  EFI_STATUS                    Status;
+  EFI_STATUS                    ReadStatus;
+  UINTN                         Index;
+
+  BuildVolume (mTestKinds, TEST_KIND_COUNT, 4 * TEST_PAGE_SIZE);
+
+  for (Index = 0; Index < mFileCount; Index++) {
+    File = &mFiles[Index];
+
+    ReadBuffer = NULL;
+    ReadStatus = mTestFv->Fv.ReadSection (
+                               &mTestFv->Fv,
+                               &File->Name,
+                               EFI_SECTION_PE32,
+                               0,
+                               &ReadBuffer,
+                               &ReadBufferSize,
+                               &AuthenticationStatus
+                               );
+    Check (!EFI_ERROR (ReadStatus), "SectionInPlace", "ReadSection () finds the image");
+    Check (
+      !EFI_ERROR (ReadStatus) && ReadBufferSize == File->ImageSize &&
+      memcmp (ReadBuffer, File->Image, File->ImageSize) == 0,
+      "SectionInPlace",
+      "ReadSection () returns the first PE32 in depth first order"
+      );
+
+    MappedAddress = 1;
+    Status = CoreFvGetSectionInPlace (&mTestFv->Fv, &File->Name, EFI_SECTION_PE32, &Buffer, &BufferSize, &MappedAddress);
+    if (File->Kind == DriverEncapsulated) {
+      Check (Status == EFI_NOT_FOUND, "SectionInPlace", "a file with a leading encapsulation section is refused");
+    } else {
+      Check (Status == EFI_SUCCESS, "SectionInPlace", "the top level PE32 is found");
+      Check (
+        Status == EFI_SUCCESS && BufferSize == ReadBufferSize &&
+        memcmp (Buffer, ReadBuffer, BufferSize) == 0,
+        "SectionInPlace",
+        "the section matches ReadSection ()"
+        );
+      Check (
+        (UINT8 *) Buffer >= mTestFv->CachedFv && (UINT8 *) Buffer < mTestFv->EndOfCachedFv,
+        "SectionInPlace",
+        "the section is in the volume cache"
+        );
+      Check (MappedAddress == (UINTN) File->Image, "SectionInPlace", "the mapped address is the section in the volume");
+    }
+
+    if (ReadBuffer != NULL) {
+      CoreFreePool (ReadBuffer);
+    }
+  }
+
+  //
+  // Without a mapping the section is still found, with no mapped address
+  //
+  mTestFvb.MemoryMapped = FALSE;
+  File = &mFiles[0];
+  MappedAddress = 1;
+  Status = CoreFvGetSectionInPlace (&mTestFv->Fv, &File->Name, EFI_SECTION_PE32, &Buffer, &BufferSize, &MappedAddress);
+  Check (Status == EFI_SUCCESS && MappedAddress == 0, "SectionInPlace", "no mapped address for an unmapped volume");
+  Status = CoreFvGetSectionInPlace (&mTestFv->Fv, &File->Name, EFI_SECTION_PE32, &Buffer, &BufferSize, NULL);
+  Check (Status == EFI_SUCCESS, "SectionInPlace", "the mapped address is optional");
+  mTestFvb.MemoryMapped = TRUE;
+
+  Status = CoreFvGetSectionInPlace (&mTestFv->Fv, &File->Name, EFI_SECTION_VERSION, &Buffer, &BufferSize, NULL);
+  Check (Status == EFI_NOT_FOUND, "SectionInPlace", "a missing section type is not found");
+
+  MakeName (TEST_MAX_FILES, &Missing);
+  Status = CoreFvGetSectionInPlace (&mTestFv->Fv, &Missing, EFI_SECTION_PE32, &Buffer, &BufferSize, NULL);
+  Check (Status == EFI_NOT_FOUND, "SectionInPlace", "a missing file is not found");
+
+  OtherFv = mTestFv->Fv;
+  OtherFv.ReadSection = NULL;
+  Status = CoreFvGetSectionInPlace (&OtherFv, &File->Name, EFI_SECTION_PE32, &Buffer, &BufferSize, NULL);
+  Check (Status == EFI_UNSUPPORTED, "SectionInPlace", "a volume of another driver is refused");
+}
+
+static
+VOID
+TestOpenImageFile (
+  VOID
+  )
+{
+  TEST_FILE           *File;
+  IMAGE_FILE_HANDLE   FHand;
+  EFI_STATUS          Status;
+  UINTN               Index;
+
+  BuildVolume (mTestKinds, TEST_KIND_COUNT, 4 * TEST_PAGE_SIZE);
+
+  for (Index = 0; Index < mFileCount; Index++) {
+    File   = &mFiles[Index];
+    Status = OpenImage (File, &FHand);
+    Check (Status == EFI_SUCCESS, "OpenImageFile", "the image is opened");
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+
+    Check (
+      FHand.SourceSize == File->ImageSize && memcmp (FHand.Source, File->Image, File->ImageSize) == 0,
+      "OpenImageFile",
+      "the image is the one ReadSection () returns"
+      );
+    if (File->Kind == DriverEncapsulated) {
+      Check (FHand.FreeBuffer && FHand.MappedSource == 0, "OpenImageFile", "an encapsulated image is read out");
+    } else {
+      Check (!FHand.FreeBuffer, "OpenImageFile", "a top level image is used in place");
+      Check (FHand.MappedSource == (UINTN) File->Image, "OpenImageFile", "the mapped source is the image in the volume");
+    }
+
+    CloseImage (&FHand);
+  }
+}
+
+static
+VOID
+TestExecuteInPlace (
+  VOID
+  )
+{
+  EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  ImageContext;
+  TEST_FILE                             *File;
+  IMAGE_FILE_HANDLE                     FHand;
+  EFI_STATUS                            Status;
+  BOOLEAN                               InPlace;
+  UINTN                                 Index;
+  UINTN                                 Pass;
+
+  BuildVolume (mTestKinds, TEST_KIND_COUNT, 4 * TEST_PAGE_SIZE);
+
+  for (Pass = 0; Pass < 2; Pass++) {
+    //
+    // The second pass is over a volume that is not memory mapped
+    //
+    mTestFvb.MemoryMapped = (BOOLEAN) (Pass == 0);
+    OpenVolume ();
+
+    for (Index = 0; Index < mFileCount; Index++) {
+      File   = &mFiles[Index];
+      Status = OpenImage (File, &FHand);
+      if (!EFI_ERROR (Status)) {
+        Status = GetImageInfo (&FHand, &ImageContext);
+      }
+      Check (Status == EFI_SUCCESS, "ExecuteInPlace", "the image is opened");
+      if (EFI_ERROR (Status)) {
+        continue;
+      }
+
+      InPlace = CoreImageCanExecuteInPlace (&FHand, &ImageContext);
+      if (Pass == 0 && File->Kind == DriverXip) {
+        Check (InPlace, "ExecuteInPlace", "a read only image linked in the volume runs in place");
+        Check (
+          ImageContext.EntryPoint == (UINTN) File->Image + TEST_PAGE_SIZE + 0x10,
+          "ExecuteInPlace",
+          "the entry point is in the volume"
+          );
+      } else {
+        Check (!InPlace, "ExecuteInPlace", "any other image is loaded into memory");
+      }
+
+      CloseImage (&FHand);
+    }
+  }
+
+  mTestFvb.MemoryMapped = TRUE;
+  OpenVolume ();
+}
+
+static
+VOID
+TestRelocation (
+  VOID
+  )
+{
+  EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  ImageContext;
+  TEST_FILE                             *File;
+  IMAGE_FILE_HANDLE                     FHand;
+  EFI_STATUS                            Status;
+  UINT8                                 *Destination;
+  UINT8                                 *Batched;
+  UINT8                                 *Reference;
+  UINTN                                 Index;
+  UINTN                                 HeaderSize;
+
+  BuildVolume (mTestKinds, TEST_KIND_COUNT, 16 * TEST_PAGE_SIZE);
+
+  for (Index = 0; Index < mFileCount; Index++) {
+    File   = &mFiles[Index];
+    Status = OpenImage (File, &FHand);
+    if (!EFI_ERROR (Status)) {
+      Status = GetImageInfo (&FHand, &ImageContext);
+    }
+    Check (Status == EFI_SUCCESS, "Relocation", "the image is opened");
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+
+    //
+    // The reference is built from the image ReadSection () returns, so do not
+    // relocate anything else
+    //
+    if (FHand.SourceSize != File->ImageSize || memcmp (FHand.Source, File->Image, File->ImageSize) != 0) {
+      Check (FALSE, "Relocation", "the opened image is the one ReadSection () returns");
+      CloseImage (&FHand);
+      continue;
+    }
+
+    Destination = AllocatePages ((UINTN) ImageContext.ImageSize);
+    Batched     = malloc ((UINTN) ImageContext.ImageSize);
+    Reference   = malloc ((UINTN) ImageContext.ImageSize);
+    HeaderSize  = (UINTN) ImageContext.SizeOfHeaders;
+
+    //
+    // The loader leaves the section tails past the virtual size alone
+    //
+    memset (Destination, 0, (UINTN) ImageContext.ImageSize);
+    Status = LoadImage (&ImageContext, Destination, FALSE);
+    Check (Status == EFI_SUCCESS, "Relocation", "the image is loaded with batched relocation");
+    memcpy (Batched, Destination, (UINTN) ImageContext.ImageSize);
+
+    memset (Destination, 0, (UINTN) ImageContext.ImageSize);
+    Status = LoadImage (&ImageContext, Destination, TRUE);
+    Check (Status == EFI_SUCCESS, "Relocation", "the image is loaded with per entry relocation");
+    Check (
+      memcmp (Batched, Destination, (UINTN) ImageContext.ImageSize) == 0,
+      "Relocation",
+      "batched and per entry relocation give the same image"
+      );
+
+    memcpy (Reference, File->Image, (UINTN) ImageContext.ImageSize);
+    ReferenceRelocate (Reference, (UINT64) (UINTN) Destination);
+    Check (
+      memcmp (Batched + HeaderSize, Reference + HeaderSize, (UINTN) ImageContext.ImageSize - HeaderSize) == 0,
+      "Relocation",
+      "the sections match the reference relocation"
+      );
+
+    FreePages (Destination);
+    free (Batched);
+    free (Reference);
+    CloseImage (&FHand);
+  }
+}
+
+//
+// The benchmark
+//
+
+typedef enum {
+  LoadReadSection,
+  LoadInPlace,
+  LoadExecuteInPlace
+} TEST_LOAD_MODE;
+
+static
+double
+TimeLoads (
+  IN  TEST_LOAD_MODE  Mode,
+  IN  UINTN           Passes
+  )
+/*++
+
+Routine Description:
+
+  Load every driver of the test volume Passes times, each pass on a newly
+  opened volume so that no section stream is cached.
+
+Returns:
+
+  The microseconds per driver.
+
+--*/
+{
+  EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  ImageContext;
+  IMAGE_FILE_HANDLE                     FHand;
+  EFI_STATUS                            Status;
+  UINT8                                 *Destination;
+  VOID                                  *Buffer;
+  UINTN                                 BufferSize;
+  UINT32                                AuthenticationStatus;
+  clock_t                               Elapsed;
+  clock_t                               Start;
+  UINTN                                 Pass;
+  UINTN                                 Index;
+
+  Elapsed = 0;
+  for (Pass = 0; Pass < Passes; Pass++) {
+    OpenVolume ();
+
+    Start = clock ();
+    for (Index = 0; Index < mFileCount; Index++) {
+      if (Mode == LoadReadSection) {
+        //
+        // The path before the section was used in place: a copy out of
+        // the stream, then the loader copy
+        //
+        Buffer = NULL;
+        Status = mTestFv->Fv.ReadSection (
+                               &mTestFv->Fv,
+                               &mFiles[Index].Name,
+                               EFI_SECTION_PE32,
+                               0,
+                               &Buffer,
+                               &BufferSize,
+                               &AuthenticationStatus
+                               );
+        memset (&FHand, 0, sizeof (FHand));
+        FHand.Signature  = IMAGE_FILE_HANDLE_SIGNATURE;
+        FHand.FreeBuffer = TRUE;
+        FHand.Source     = Buffer;
+        FHand.SourceSize = BufferSize;
+      } else {
+        Status = OpenImage (&mFiles[Index], &FHand);
+      }
+      if (!EFI_ERROR (Status)) {
+        Status = GetImageInfo (&FHand, &ImageContext);
+      }
+      if (EFI_ERROR (Status)) {
+        printf ("Benchmark failed to open driver %u\n", (unsigned) Index);
+        exit (1);
+      }
+
+      if (Mode == LoadExecuteInPlace && CoreImageCanExecuteInPlace (&FHand, &ImageContext)) {
+        CloseImage (&FHand);
+        continue;
+      }
+
+      Destination = AllocatePages ((UINTN) ImageContext.ImageSize);
+      Status = LoadImage (&ImageContext, Destination, FALSE);
+      if (EFI_ERROR (Status)) {
+        printf ("Benchmark failed to load driver %u\n", (unsigned) Index);
+        exit (1);
+      }
+      FreePages (Destination);
+      CloseImage (&FHand);
+    }
+    Elapsed += clock () - Start;
+  }
+
+  return (double) Elapsed * 1e6 / CLOCKS_PER_SEC / Passes / mFileCount;
+}
+
+static
+double
+TimeRelocations (
+  IN  BOOLEAN         RecordFixups,
+  IN  UINTN           Passes
+  )
+/*++
+
+Routine Description:
+
+  Relocate the first driver of the test volume Passes times.
+
+Returns:
+
+  The microseconds per relocation.
+
+--*/
+{
+  EFI_PEI_PE_COFF_LOADER_IMAGE_CONTEXT  ImageContext;
+  IMAGE_FILE_HANDLE                     FHand;
+  UINT8                                 *Destination;
+  clock_t                               Start;
+  UINTN                                 Pass;
+
+  OpenImage (&mFiles[0], &FHand);
+  GetImageInfo (&FHand, &ImageContext);
+  Destination = AllocatePages ((UINTN) ImageContext.ImageSize);
+  ImageContext.ImageAddress = (EFI_PHYSICAL_ADDRESS) (UINTN) Destination;
+  mPeCoffLoader.LoadImage (&mPeCoffLoader, &ImageContext);
+  ImageContext.FixupData = NULL;
+  if (RecordFixups) {
+    ImageContext.FixupData = malloc ((UINTN) ImageContext.FixupDataSize);
+  }
+
+  //
+  // Relocating again at the same address applies an adjustment of 0 after
+  // the first pass, which costs the same
+  //
+  Start = clock ();
+  for (Pass = 0; Pass < Passes; Pass++) {
+    mPeCoffLoader.RelocateImage (&mPeCoffLoader, &ImageContext);
+  }
+  Start = clock () - Start;
+
+  free (ImageContext.FixupData);
+  FreePages (Destination);
+  CloseImage (&FHand);
+  return (double) Start * 1e6 / CLOCKS_PER_SEC / Passes;
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+{
+  TEST_DRIVER_KIND  Kinds[48];
+  UINTN             Index;
+  UINTN             TextSize;
+  double            ReadSection;
+  double            InPlace;
+  double            ExecuteInPlace;
+  double            PerEntry;
+  double            Batched;
+
+  for (Index = 0; Index < 48; Index++) {
+    Kinds[Index] = DriverXip;
+  }
+
+  printf ("Loading 48 drivers from a memory mapped volume, us per driver\n");
+  printf ("%-10s %12s %12s %12s\n", "Image KB", "ReadSection", "In place", "XIP");
+  for (TextSize = 16 * 1024; TextSize <= 256 * 1024; TextSize *= 4) {
+    BuildVolume (Kinds, 48, TextSize);
+    ReadSection    = TimeLoads (LoadReadSection, 20);
+    InPlace        = TimeLoads (LoadInPlace, 20);
+    ExecuteInPlace = TimeLoads (LoadExecuteInPlace, 20);
+    printf (
+      "%-10u %12.1f %12.1f %12.2f\n",
+      (unsigned) (mFiles[0].ImageSize / 1024),
+      ReadSection,
+      InPlace,
+      ExecuteInPlace
+      );
+  }
+
+  printf ("\nRelocating one driver, us per image\n");
+  printf ("%-10s %12s %12s\n", "Image KB", "Per entry", "Batched");
+  for (TextSize = 16 * 1024; TextSize <= 256 * 1024; TextSize *= 4) {
+    BuildVolume (Kinds, 1, TextSize);
+    PerEntry = TimeRelocations (TRUE, 2000);
+    Batched  = TimeRelocations (FALSE, 2000);
+    printf ("%-10u %12.1f %12.1f\n", (unsigned) (mFiles[0].ImageSize / 1024), PerEntry, Batched);
+  }
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, or the benchmark when called with -b.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  EFI_HANDLE  Handle;
+
+  Handle = NULL;
+  InitializeSectionExtraction (Handle, NULL);
+
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  TestSectionInPlace ();
+  TestOpenImageFile ();
+  TestExecuteInPlace ();
+  TestRelocation ();
+
+  if (mFailures != 0) {
+    printf ("ImageLoadTest: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("ImageLoadTest: all checks passed\n");
+  return 0;
+}
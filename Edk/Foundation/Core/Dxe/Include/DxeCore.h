@@ -1338,6 +1338,26 @@ Returns:
 --*/
 ;
 
+VOID
+CoreDumpDriverBindingStatistics (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Print the Driver Binding Protocol usage counters of this boot.
+
+Arguments:
+
+  None
+
+Returns:
+  
+  None
+--*/
+;
+
 EFI_BOOTSERVICE11
 EFI_STATUS 
 EFIAPI
@@ -2438,6 +2458,41 @@ Returns:
 --*/
 ;
 
+EFI_STATUS
+CoreFvGetSectionInPlace (
+  IN  VOID                              *FwVol,
+  IN  EFI_GUID                          *NameGuid,
+  IN  EFI_SECTION_TYPE                  SectionType,
+  OUT VOID                              **Buffer,
+  OUT UINTN                             *BufferSize,
+  OUT EFI_PHYSICAL_ADDRESS              *MappedAddress OPTIONAL
+  )
+/*++
+
+Routine Description:
+    Locates a top level leaf section of a file in a firmware volume produced
+    by the DXE core and returns a pointer to it in the cached copy of the
+    volume. Files where an encapsulation section precedes the section are
+    not handled. The returned buffer must not be freed or modified.
+
+Arguments:
+    FwVol         - The firmware volume protocol instance.
+    NameGuid      - Pointer to an EFI_GUID, which is the filename.
+    SectionType   - Indicates the section type to return.
+    Buffer        - Returns the pointer to the section data.
+    BufferSize    - Returns the size of the section data.
+    MappedAddress - Returns the address of the section data in a memory
+                    mapped volume, otherwise 0.
+
+Returns:
+    EFI_SUCCESS     - The section is found.
+    EFI_UNSUPPORTED - The firmware volume is not produced by the DXE core.
+    EFI_NOT_FOUND   - The file or the top level section is not found, or an
+                      encapsulation section precedes it.
+
+--*/
+;
+
 EFI_STATUS
 EFIAPI
 InitializeSectionExtraction (
@@ -2461,6 +2516,26 @@ Returns:
 --*/
 ;
 
+VOID
+CoreFlushSectionCache (
+  VOID
+  )
+/*++
+
+Routine Description:
+  Frees all the entries of the section cache and forgets the sections
+  extracted once.  Called when the dispatcher has no more drivers to start,
+  so the streams kept for the dispatch don't stay allocated for BDS.
+
+Arguments:
+  None
+
+Returns:
+  None
+
+--*/
+;
+
 EFI_STATUS
 CoreProcessFirmwareVolume (
   IN  VOID                         *FvHeader,
@@ -107,6 +107,52 @@ typedef struct {
 
 #define NULL_STREAM_HANDLE    0
 
+//
+// The streams produced by decompression and GUIDed extraction are kept in
+// a cache keyed by the content of the encapsulation section, so the same
+// section opened again through another stream (the depex, image and UI
+// reads of one file during dispatch) is not decompressed again.  The cache
+// is bounded by SECTION_CACHE_MAX_SIZE bytes, the least recently used
+// entries are evicted first.  A stream is only cached once its section has
+// been extracted before, so sections opened once are never copied, and the
+// cache is flushed when the dispatcher runs out of drivers to start.
+//
+#define CORE_SECTION_CACHE_SIGNATURE  EFI_SIGNATURE_32('S','X','C','E')
+#define CACHE_ENTRY_FROM_LINK(Node) \
+  CR (Node, CORE_SECTION_CACHE_ENTRY, Link, CORE_SECTION_CACHE_SIGNATURE)
+
+#define SECTION_CACHE_MAX_SIZE  0x800000
+
+//
+// Only the start of a section is hashed, a hash match is confirmed by a
+// full compare.  The sections extracted once are remembered by hash and
+// size in a ring of SECTION_CACHE_SEEN_COUNT entries.
+//
+#define SECTION_CACHE_HASH_SIZE   0x100
+#define SECTION_CACHE_SEEN_COUNT  64
+
+typedef struct {
+  UINT32                      Signature;
+  EFI_LIST_ENTRY              Link;
+  UINT32                      Hash;
+  //
+  // Copy of the encapsulation section, compared on a hash match
+  //
+  UINT8                       *Section;
+  UINT32                      SectionSize;
+  UINT8                       *Stream;
+  UINTN                       StreamLength;
+  //
+  // Authentication status returned by the GUIDed extraction
+  //
+  UINT32                      AuthenticationStatus;
+} CORE_SECTION_CACHE_ENTRY;
+
+typedef struct {
+  UINT32                      Hash;
+  UINT32                      SectionSize;
+} CORE_SECTION_CACHE_SEEN;
+
 typedef struct {
   CORE_SECTION_CHILD_NODE     *ChildNode;
   CORE_SECTION_STREAM_NODE    *ParentStream;
@@ -222,12 +268,49 @@ IsValidSectionStream (
   IN  VOID                                    *SectionStream,
   IN  UINTN                                   SectionStreamLength
   );
+
+STATIC
+UINT32
+SectionCacheHash (
+  IN  VOID                                    *Section,
+  IN  UINT32                                  SectionSize
+  );
+
+STATIC
+BOOLEAN
+SectionCacheLookup (
+  IN  VOID                                    *Section,
+  IN  UINT32                                  SectionSize,
+  IN  UINT32                                  Hash,
+  OUT VOID                                    **Stream,
+  OUT UINTN                                   *StreamLength,
+  OUT UINT32                                  *AuthenticationStatus
+  );
+
+STATIC
+VOID
+SectionCacheInsert (
+  IN  VOID                                    *Section,
+  IN  UINT32                                  SectionSize,
+  IN  UINT32                                  Hash,
+  IN  VOID                                    *Stream,
+  IN  UINTN                                   StreamLength,
+  IN  UINT32                                  AuthenticationStatus
+  );
   
 //
 // Module globals
 //
 EFI_LIST mStreamRoot = INITIALIZE_LIST_HEAD_VARIABLE (mStreamRoot);
 
+EFI_LIST mSectionCache = INITIALIZE_LIST_HEAD_VARIABLE (mSectionCache);
+
+UINTN mSectionCacheSize = 0;
+
+CORE_SECTION_CACHE_SEEN mSectionCacheSeen[SECTION_CACHE_SEEN_COUNT];
+
+UINTN mSectionCacheSeenNext = 0;
+
 EFI_HANDLE mSectionExtractionHandle = NULL;
 
 EFI_SECTION_EXTRACTION_PROTOCOL mSectionExtraction = { 
@@ -760,6 +843,7 @@ Returns:
   UINTN                                        NewStreamBufferSize;
   UINT32                                       AuthenticationStatus;
   UINT32                                       SectionLength;
+  UINT32                                       Hash;
     
   CORE_SECTION_CHILD_NODE                      *Node;
 
@@ -796,10 +880,29 @@ Returns:
       
       CompressionHeader = (EFI_COMPRESSION_SECTION *) SectionHeader;
       
+      NewStreamBuffer = NULL;
+      NewStreamBufferSize = 0;
+      Hash = 0;
+      if ((CompressionHeader->UncompressedLength > 0) &&
+          (CompressionHeader->CompressionType != EFI_NOT_COMPRESSED)) {
+        //
+        // A stream decompressed before is handed out as a copy from the cache
+        //
+        Hash = SectionCacheHash (SectionHeader, Node->Size);
+        SectionCacheLookup (
+          SectionHeader,
+          Node->Size,
+          Hash,
+          &NewStreamBuffer,
+          &NewStreamBufferSize,
+          &AuthenticationStatus
+          );
+      }
+
       //
       // Allocate space for the new stream
       //
-      if (CompressionHeader->UncompressedLength > 0) {
+      if ((NewStreamBuffer == NULL) && (CompressionHeader->UncompressedLength > 0)) {
         NewStreamBufferSize = CompressionHeader->UncompressedLength;
         NewStreamBuffer = CoreAllocateBootServicesPool (NewStreamBufferSize);
         if (NewStreamBuffer == NULL) {
@@ -853,10 +956,17 @@ Returns:
                                  );
           ASSERT_EFI_ERROR (Status);
           CoreFreePool (ScratchBuffer);                                           
+          if (!EFI_ERROR (Status)) {
+            SectionCacheInsert (
+              SectionHeader,
+              Node->Size,
+              Hash,
+              NewStreamBuffer,
+              NewStreamBufferSize,
+              0
+              );
+          }
         }
-      } else {
-        NewStreamBuffer = NULL;
-        NewStreamBufferSize = 0;
       }
       
       Status = OpenSectionStreamEx (
@@ -878,20 +988,39 @@ Returns:
       Node->EncapsulationGuid = &GuidedHeader->SectionDefinitionGuid;
       Status = CoreLocateProtocol (Node->EncapsulationGuid, NULL, &GuidedExtraction);
       if (!EFI_ERROR (Status)) {
-        //
-        // NewStreamBuffer is always allocated by ExtractSection... No caller
-        // allocation here.
-        //
-        Status = GuidedExtraction->ExtractSection (
-                                     GuidedExtraction,
-                                     GuidedHeader,
-                                     &NewStreamBuffer,
-                                     &NewStreamBufferSize,
-                                     &AuthenticationStatus
-                                     );
-        if (EFI_ERROR (Status)) {
-          CoreFreePool (*ChildNode);
-          return EFI_PROTOCOL_ERROR;
+        Hash = SectionCacheHash (SectionHeader, Node->Size);
+        if (!SectionCacheLookup (
+               SectionHeader,
+               Node->Size,
+               Hash,
+               &NewStreamBuffer,
+               &NewStreamBufferSize,
+               &AuthenticationStatus
+               )) {
+          //
+          // NewStreamBuffer is always allocated by ExtractSection... No caller
+          // allocation here.
+          //
+          Status = GuidedExtraction->ExtractSection (
+                                       GuidedExtraction,
+                                       GuidedHeader,
+                                       &NewStreamBuffer,
+                                       &NewStreamBufferSize,
+                                       &AuthenticationStatus
+                                       );
+          if (EFI_ERROR (Status)) {
+            CoreFreePool (*ChildNode);
+            return EFI_PROTOCOL_ERROR;
+          }
+
+          SectionCacheInsert (
+            SectionHeader,
+            Node->Size,
+            Hash,
+            NewStreamBuffer,
+            NewStreamBufferSize,
+            AuthenticationStatus
+            );
         }
         
         //
@@ -1350,3 +1479,231 @@ Returns:
   ASSERT (FALSE);
   return FALSE;
 }
+
+
+STATIC
+UINT32
+SectionCacheHash (
+  IN  VOID              *Section,
+  IN  UINT32            SectionSize
+  )
+/*++
+
+Routine Description:
+  Worker function.  Computes the FNV-1a hash of the size and the first
+  SECTION_CACHE_HASH_SIZE bytes of an encapsulation section, used to pick
+  the candidates in the section cache.
+
+Arguments:
+  Section               - The encapsulation section, including its header
+  SectionSize           - The size of the section in bytes
+
+Returns:
+  The hash of the section
+
+--*/
+{
+  UINT8                       *Byte;
+  UINT32                      Hash;
+  UINT32                      Index;
+
+  Hash = 0x811C9DC5;
+  for (Index = 0; Index < sizeof (SectionSize); Index++) {
+    Hash = (Hash ^ (UINT8) (SectionSize >> (Index * 8))) * 0x01000193;
+  }
+
+  if (SectionSize > SECTION_CACHE_HASH_SIZE) {
+    SectionSize = SECTION_CACHE_HASH_SIZE;
+  }
+
+  for (Byte = Section; SectionSize > 0; SectionSize--, Byte++) {
+    Hash = (Hash ^ *Byte) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+
+STATIC
+BOOLEAN
+SectionCacheLookup (
+  IN  VOID              *Section,
+  IN  UINT32            SectionSize,
+  IN  UINT32            Hash,
+  OUT VOID              **Stream,
+  OUT UINTN             *StreamLength,
+  OUT UINT32            *AuthenticationStatus
+  )
+/*++
+
+Routine Description:
+  Worker function.  Searches the section cache for the stream extracted from
+  an identical encapsulation section and returns a copy of it.  The entry
+  found becomes the most recently used one.
+
+Arguments:
+  Section               - The encapsulation section, including its header
+  SectionSize           - The size of the section in bytes
+  Hash                  - The hash of the section from SectionCacheHash
+  Stream                - Returns the copy of the stream, which is owned
+                          by the caller
+  StreamLength          - Returns the size of the stream in bytes
+  AuthenticationStatus  - Returns the authentication status the extraction
+                          produced
+
+Returns:
+  TRUE                  - The stream is found and copied
+  FALSE                 - The section is not in the cache, or the copy
+                          could not be allocated
+
+--*/
+{
+  EFI_LIST_ENTRY              *Link;
+  CORE_SECTION_CACHE_ENTRY    *Entry;
+  VOID                        *Buffer;
+
+  for (Link = mSectionCache.ForwardLink; Link != &mSectionCache; Link = Link->ForwardLink) {
+    Entry = CACHE_ENTRY_FROM_LINK (Link);
+    if ((Entry->Hash != Hash) || (Entry->SectionSize != SectionSize) ||
+        (EfiCompareMem (Entry->Section, Section, SectionSize) != 0)) {
+      continue;
+    }
+
+    Buffer = CoreAllocateBootServicesPool (Entry->StreamLength);
+    if (Buffer == NULL) {
+      return FALSE;
+    }
+    EfiCommonLibCopyMem (Buffer, Entry->Stream, Entry->StreamLength);
+
+    RemoveEntryList (&Entry->Link);
+    InsertHeadList (&mSectionCache, &Entry->Link);
+
+    *Stream               = Buffer;
+    *StreamLength         = Entry->StreamLength;
+    *AuthenticationStatus = Entry->AuthenticationStatus;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+STATIC
+VOID
+SectionCacheInsert (
+  IN  VOID              *Section,
+  IN  UINT32            SectionSize,
+  IN  UINT32            Hash,
+  IN  VOID              *Stream,
+  IN  UINTN             StreamLength,
+  IN  UINT32            AuthenticationStatus
+  )
+/*++
+
+Routine Description:
+  Worker function.  Adds a copy of an encapsulation section and of the
+  stream extracted from it to the section cache, evicting the least
+  recently used entries to stay under SECTION_CACHE_MAX_SIZE.  The first
+  time a section is extracted it is only remembered, the copies are made
+  when it is extracted again.  The cache is only an optimization, so
+  failures are silently ignored.
+
+Arguments:
+  Section               - The encapsulation section, including its header
+  SectionSize           - The size of the section in bytes
+  Hash                  - The hash of the section from SectionCacheHash
+  Stream                - The stream extracted from the section
+  StreamLength          - The size of the stream in bytes
+  AuthenticationStatus  - The authentication status the extraction produced
+
+Returns:
+  None
+
+--*/
+{
+  CORE_SECTION_CACHE_ENTRY    *Entry;
+  UINTN                       EntrySize;
+  UINTN                       Index;
+
+  EntrySize = sizeof (CORE_SECTION_CACHE_ENTRY) + SectionSize + StreamLength;
+  if ((StreamLength == 0) || (EntrySize > SECTION_CACHE_MAX_SIZE / 2)) {
+    return;
+  }
+
+  for (Index = 0; Index < SECTION_CACHE_SEEN_COUNT; Index++) {
+    if ((mSectionCacheSeen[Index].SectionSize == SectionSize) &&
+        (mSectionCacheSeen[Index].Hash == Hash)) {
+      break;
+    }
+  }
+
+  if (Index == SECTION_CACHE_SEEN_COUNT) {
+    mSectionCacheSeen[mSectionCacheSeenNext].Hash        = Hash;
+    mSectionCacheSeen[mSectionCacheSeenNext].SectionSize = SectionSize;
+    mSectionCacheSeenNext = (mSectionCacheSeenNext + 1) % SECTION_CACHE_SEEN_COUNT;
+    return;
+  }
+
+  mSectionCacheSeen[Index].SectionSize = 0;
+
+  while (mSectionCacheSize + EntrySize > SECTION_CACHE_MAX_SIZE) {
+    Entry = CACHE_ENTRY_FROM_LINK (mSectionCache.BackLink);
+    RemoveEntryList (&Entry->Link);
+    mSectionCacheSize -= sizeof (CORE_SECTION_CACHE_ENTRY) + Entry->SectionSize + Entry->StreamLength;
+    CoreFreePool (Entry);
+  }
+
+  //
+  // The entry, the section and the stream share one allocation
+  //
+  Entry = CoreAllocateBootServicesPool (EntrySize);
+  if (Entry == NULL) {
+    return;
+  }
+
+  Entry->Signature            = CORE_SECTION_CACHE_SIGNATURE;
+  Entry->Hash                 = Hash;
+  Entry->Section              = (UINT8 *) (Entry + 1);
+  Entry->SectionSize          = SectionSize;
+  Entry->Stream               = Entry->Section + SectionSize;
+  Entry->StreamLength         = StreamLength;
+  Entry->AuthenticationStatus = AuthenticationStatus;
+  EfiCommonLibCopyMem (Entry->Section, Section, SectionSize);
+  EfiCommonLibCopyMem (Entry->Stream, Stream, StreamLength);
+
+  InsertHeadList (&mSectionCache, &Entry->Link);
+  mSectionCacheSize += EntrySize;
+}
+
+
+VOID
+CoreFlushSectionCache (
+  VOID
+  )
+/*++
+
+Routine Description:
+  Frees all the entries of the section cache and forgets the sections
+  extracted once.  Called when the dispatcher has no more drivers to start,
+  so the streams kept for the dispatch don't stay allocated for BDS.
+
+Arguments:
+  None
+
+Returns:
+  None
+
+--*/
+{
+  CORE_SECTION_CACHE_ENTRY    *Entry;
+
+  while (!IsListEmpty (&mSectionCache)) {
+    Entry = CACHE_ENTRY_FROM_LINK (mSectionCache.ForwardLink);
+    RemoveEntryList (&Entry->Link);
+    CoreFreePool (Entry);
+  }
+
+  mSectionCacheSize     = 0;
+  mSectionCacheSeenNext = 0;
+  EfiCommonLibZeroMem (mSectionCacheSeen, sizeof (mSectionCacheSeen));
+}
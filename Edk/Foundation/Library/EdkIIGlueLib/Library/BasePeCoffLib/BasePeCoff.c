@@ -641,6 +641,31 @@ GluePeCoffLoaderRelocateImage (
     //
     while (Reloc < RelocEnd) {
 
+      if (FixupData == NULL) {
+        //
+        // With no fixup data to record, a run of the same type of full
+        // width fixups is applied in a tight loop rather than one switch
+        // dispatch per entry. Linkers emit long runs of these.
+        //
+        if (((*Reloc) >> 12) == EFI_IMAGE_REL_BASED_DIR64) {
+          do {
+            F64   = (UINT64 *) (FixupBase + (*Reloc & 0xFFF));
+            *F64  = *F64 + (UINT64) Adjust;
+            Reloc += 1;
+          } while ((Reloc < RelocEnd) && (((*Reloc) >> 12) == EFI_IMAGE_REL_BASED_DIR64));
+          continue;
+        }
+
+        if (((*Reloc) >> 12) == EFI_IMAGE_REL_BASED_HIGHLOW) {
+          do {
+            F32   = (UINT32 *) (FixupBase + (*Reloc & 0xFFF));
+            *F32  = *F32 + (UINT32) Adjust;
+            Reloc += 1;
+          } while ((Reloc < RelocEnd) && (((*Reloc) >> 12) == EFI_IMAGE_REL_BASED_HIGHLOW));
+          continue;
+        }
+      }
+
       Fixup = FixupBase + (*Reloc & 0xFFF);
       switch ((*Reloc) >> 12) {
       case EFI_IMAGE_REL_BASED_ABSOLUTE:
@@ -45,11 +45,33 @@ Returns:
 
 --*/
 {
-  UINTN Index;
+  UINT64  *Left;
+  UINT64  *Right;
+  UINT32  *Left32;
+  UINT32  *Right32;
+  UINTN   Index;
 
   //
-  // compare byte by byte
+  // GUIDs embedded in IFR opcodes, device path nodes and FFS/section
+  // headers may be packed at any byte offset, and unaligned loads fault on
+  // IPF. Only use wide compares when both GUIDs allow them, and compare
+  // byte by byte otherwise.
   //
+  if ((((UINTN) Guid1 | (UINTN) Guid2) & (sizeof (UINT64) - 1)) == 0) {
+    Left  = (UINT64 *) Guid1;
+    Right = (UINT64 *) Guid2;
+    return (BOOLEAN) ((Left[0] == Right[0]) && (Left[1] == Right[1]));
+  }
+
+  if ((((UINTN) Guid1 | (UINTN) Guid2) & (sizeof (UINT32) - 1)) == 0) {
+    Left32  = (UINT32 *) Guid1;
+    Right32 = (UINT32 *) Guid2;
+    return (BOOLEAN) ((Left32[0] == Right32[0]) &&
+                      (Left32[1] == Right32[1]) &&
+                      (Left32[2] == Right32[2]) &&
+                      (Left32[3] == Right32[3]));
+  }
+
   for (Index = 0; Index < 16; ++Index) {
     if (*(((UINT8*) Guid1) + Index) != *(((UINT8*) Guid2) + Index)) {
       return FALSE;
@@ -47,28 +47,54 @@ Returns:
 
   = 0     if MemOne == MemTwo
 
+  > 0     if the first differing byte of MemOne is greater (as UINT8)
+
+  < 0     if the first differing byte of MemOne is smaller (as UINT8)
+
 --*/
 {
-  INTN ReturnValue;
-
-  if (!(EFI_UINTN_ALIGNED (MemOne) || EFI_UINTN_ALIGNED (MemTwo) || EFI_UINTN_ALIGNED (Length))) {
-    //
-    // If Destination/Source/Length are aligned do UINTN conpare
-    //
-    for (; Length > 0; Length -= sizeof (INTN), MemOne = (VOID *)((UINTN)MemOne + sizeof (INTN)), MemTwo = (VOID *)((UINTN)MemTwo + sizeof (INTN))) {
-      if (*(INTN *)MemOne != *(INTN *)MemTwo) {
-        break;
+  UINT8 *Byte1;
+  UINT8 *Byte2;
+  UINTN *Word1;
+  UINTN *Word2;
+
+  Byte1 = (UINT8 *) MemOne;
+  Byte2 = (UINT8 *) MemTwo;
+
+  //
+  // Word compares need both buffers to share the same misalignment. Byte
+  // compare up to the alignment boundary, then skip over equal words and
+  // let the byte loop locate the first difference inside a mismatching word.
+  //
+  if ((((UINTN) Byte1 ^ (UINTN) Byte2) & EFI_UINTN_ALIGN_MASK) == 0) {
+    while ((Length > 0) && (EFI_UINTN_ALIGNED (Byte1) != 0)) {
+      if (*Byte1 != *Byte2) {
+        return (INTN) *Byte1 - (INTN) *Byte2;
       }
+      Byte1++;
+      Byte2++;
+      Length--;
     }
+
+    Word1 = (UINTN *) Byte1;
+    Word2 = (UINTN *) Byte2;
+    while ((Length >= 2 * sizeof (UINTN)) && (Word1[0] == Word2[0]) && (Word1[1] == Word2[1])) {
+      Word1  += 2;
+      Word2  += 2;
+      Length -= 2 * sizeof (UINTN);
+    }
+    while ((Length >= sizeof (UINTN)) && (*Word1 == *Word2)) {
+      Word1++;
+      Word2++;
+      Length -= sizeof (UINTN);
+    }
+    Byte1 = (UINT8 *) Word1;
+    Byte2 = (UINT8 *) Word2;
   }
 
-  //
-  // If Destination/Source/Length not aligned do byte compare
-  //
-  for (; Length > 0; Length--, MemOne = (VOID *)((UINTN)MemOne + 1), MemTwo = (VOID *)((UINTN)MemTwo + 1)) {
-    ReturnValue = (INTN)(*(INT8 *)MemOne - *(INT8 *)MemTwo);
-    if (ReturnValue != 0) {
-      return ReturnValue;
+  for (; Length > 0; Length--, Byte1++, Byte2++) {
+    if (*Byte1 != *Byte2) {
+      return (INTN) *Byte1 - (INTN) *Byte2;
     }
   }
 
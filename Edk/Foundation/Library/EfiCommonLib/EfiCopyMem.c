@@ -23,6 +23,8 @@ Abstract:
 --*/
 
 #include "Tiano.h"
+#include "EfiCommonLib.h"
+#include "EfiMemSimd.h"
 
 VOID
 EfiCommonLibCopyMem (
@@ -50,20 +52,94 @@ Returns:
 
 --*/
 {
-  CHAR8 *Destination8;
-  CHAR8 *Source8;
-
-  if (Source < Destination) {
-    Destination8  = (CHAR8 *) Destination + Length - 1;
-    Source8       = (CHAR8 *) Source + Length - 1;
-    while (Length--) {
-      *(Destination8--) = *(Source8--);
+  UINT8 *Destination8;
+  UINT8 *Source8;
+  UINTN *DestinationN;
+  UINTN *SourceN;
+#ifdef EFI_COMMON_LIB_SIMD
+  UINTN Done;
+#endif
+
+  if ((Length == 0) || (Destination == Source)) {
+    return ;
+  }
+
+  Destination8  = (UINT8 *) Destination;
+  Source8       = (UINT8 *) Source;
+
+  if ((UINTN) Destination8 - (UINTN) Source8 < Length) {
+    //
+    // Destination starts inside the source buffer, so copy from the top down.
+    //
+#ifdef EFI_COMMON_LIB_SIMD
+    if (Length >= EFI_MEM_SIMD_THRESHOLD) {
+      Length -= EfiCommonLibCopyMemBackwardSimd (Destination8, Source8, Length);
+    }
+#endif
+    Destination8 += Length;
+    Source8      += Length;
+    if ((((UINTN) Destination8 ^ (UINTN) Source8) & EFI_UINTN_ALIGN_MASK) == 0) {
+      while ((Length > 0) && (EFI_UINTN_ALIGNED (Destination8) != 0)) {
+        *(--Destination8) = *(--Source8);
+        Length--;
+      }
+      DestinationN  = (UINTN *) Destination8;
+      SourceN       = (UINTN *) Source8;
+      while (Length >= 2 * sizeof (UINTN)) {
+        DestinationN -= 2;
+        SourceN      -= 2;
+        DestinationN[1] = SourceN[1];
+        DestinationN[0] = SourceN[0];
+        Length -= 2 * sizeof (UINTN);
+      }
+      if (Length >= sizeof (UINTN)) {
+        *(--DestinationN) = *(--SourceN);
+        Length -= sizeof (UINTN);
+      }
+      Destination8  = (UINT8 *) DestinationN;
+      Source8       = (UINT8 *) SourceN;
     }
-  } else {
-    Destination8  = (CHAR8 *) Destination;
-    Source8       = (CHAR8 *) Source;
-    while (Length--) {
+    while (Length-- > 0) {
+      *(--Destination8) = *(--Source8);
+    }
+    return ;
+  }
+
+#ifdef EFI_COMMON_LIB_SIMD
+  if (Length >= EFI_MEM_SIMD_THRESHOLD) {
+    Done          = EfiCommonLibCopyMemForwardSimd (Destination8, Source8, Length);
+    Destination8 += Done;
+    Source8      += Done;
+    Length       -= Done;
+  }
+#endif
+
+  //
+  // Word copies need Destination and Source to share the same misalignment.
+  //
+  if ((((UINTN) Destination8 ^ (UINTN) Source8) & EFI_UINTN_ALIGN_MASK) == 0) {
+    while ((Length > 0) && (EFI_UINTN_ALIGNED (Destination8) != 0)) {
       *(Destination8++) = *(Source8++);
+      Length--;
+    }
+    DestinationN  = (UINTN *) Destination8;
+    SourceN       = (UINTN *) Source8;
+    while (Length >= 2 * sizeof (UINTN)) {
+      DestinationN[0] = SourceN[0];
+      DestinationN[1] = SourceN[1];
+      DestinationN   += 2;
+      SourceN        += 2;
+      Length         -= 2 * sizeof (UINTN);
     }
+    if (Length >= sizeof (UINTN)) {
+      *(DestinationN++) = *(SourceN++);
+      Length -= sizeof (UINTN);
+    }
+    Destination8  = (UINT8 *) DestinationN;
+    Source8       = (UINT8 *) SourceN;
+  }
+
+  while (Length-- > 0) {
+    *(Destination8++) = *(Source8++);
   }
 }
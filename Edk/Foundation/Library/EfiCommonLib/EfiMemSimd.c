@@ -0,0 +1,207 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  EfiMemSimd.c
+
+Abstract:
+
+  SSE2 kernels for large EfiCommonLibCopyMem/EfiCommonLibSetMem requests,
+  for GCC and Clang builds that target SSE2 (all X64 builds, and IA32
+  builds with -msse2).
+
+  Like the MASM EfiCopyMemSSE2/EfiSetMemSSE2 variants, the kernels are
+  picked when the library is built. Nothing is probed or patched at
+  runtime, so the same code is safe in runtime drivers after
+  SetVirtualAddressMap and in code that cannot execute privileged
+  instructions. Only XMM registers are used, which the UEFI calling
+  convention already treats as volatile.
+
+--*/
+
+#include "Tiano.h"
+#include "EfiCommonLib.h"
+#include "EfiMemSimd.h"
+
+#ifdef EFI_COMMON_LIB_SIMD
+
+#include <emmintrin.h>
+
+//
+// The destination is first brought to 16-byte alignment (byte copies for
+// CopyMem, one unaligned store for SetMem), then 64 bytes are moved per
+// iteration. Loads of an iteration always precede its stores, which keeps
+// the forward kernel safe for Destination < Source and the backward kernel
+// safe for Destination > Source.
+//
+
+UINTN
+EfiCommonLibCopyMemForwardSimd (
+  IN UINT8        *Destination,
+  IN CONST UINT8  *Source,
+  IN UINTN        Length
+  )
+/*++
+
+Routine Description:
+
+  Copy the leading part of a buffer from low to high addresses with SSE2.
+  Safe when Destination <= Source.
+
+Arguments:
+
+  Destination - Target of copy
+
+  Source      - Place to copy from
+
+  Length      - Number of bytes in the buffer, at least EFI_MEM_SIMD_THRESHOLD
+
+Returns:
+
+  Number of leading bytes copied. The caller copies the remainder.
+
+--*/
+{
+  UINTN   Head;
+  UINTN   Done;
+  __m128i Xmm0;
+  __m128i Xmm1;
+  __m128i Xmm2;
+  __m128i Xmm3;
+
+  //
+  // The unaligned head is copied byte by byte so that the stores never
+  // touch source bytes that a later load still needs.
+  //
+  Head = (16 - ((UINTN) Destination & 15)) & 15;
+  for (Done = 0; Done < Head; Done++) {
+    Destination[Done] = Source[Done];
+  }
+
+  for (Done = Head; Length - Done >= 64; Done += 64) {
+    Xmm0 = _mm_loadu_si128 ((CONST __m128i *) (Source + Done));
+    Xmm1 = _mm_loadu_si128 ((CONST __m128i *) (Source + Done + 16));
+    Xmm2 = _mm_loadu_si128 ((CONST __m128i *) (Source + Done + 32));
+    Xmm3 = _mm_loadu_si128 ((CONST __m128i *) (Source + Done + 48));
+    _mm_store_si128 ((__m128i *) (Destination + Done), Xmm0);
+    _mm_store_si128 ((__m128i *) (Destination + Done + 16), Xmm1);
+    _mm_store_si128 ((__m128i *) (Destination + Done + 32), Xmm2);
+    _mm_store_si128 ((__m128i *) (Destination + Done + 48), Xmm3);
+  }
+
+  return Done;
+}
+
+UINTN
+EfiCommonLibCopyMemBackwardSimd (
+  IN UINT8        *Destination,
+  IN CONST UINT8  *Source,
+  IN UINTN        Length
+  )
+/*++
+
+Routine Description:
+
+  Copy the trailing part of a buffer from high to low addresses with SSE2.
+  Safe when Destination > Source.
+
+Arguments:
+
+  Destination - Start of the copy target
+
+  Source      - Start of the copy source
+
+  Length      - Number of bytes in the buffer, at least EFI_MEM_SIMD_THRESHOLD
+
+Returns:
+
+  Number of trailing bytes copied. The caller copies the remainder,
+  which always starts at Destination/Source.
+
+--*/
+{
+  UINTN   Tail;
+  UINTN   End;
+  __m128i Xmm0;
+  __m128i Xmm1;
+  __m128i Xmm2;
+  __m128i Xmm3;
+
+  End   = Length;
+  Tail  = (UINTN) (Destination + End) & 15;
+  while (Tail-- > 0) {
+    End--;
+    Destination[End] = Source[End];
+  }
+
+  while (End >= 64) {
+    End -= 64;
+    Xmm3 = _mm_loadu_si128 ((CONST __m128i *) (Source + End + 48));
+    Xmm2 = _mm_loadu_si128 ((CONST __m128i *) (Source + End + 32));
+    Xmm1 = _mm_loadu_si128 ((CONST __m128i *) (Source + End + 16));
+    Xmm0 = _mm_loadu_si128 ((CONST __m128i *) (Source + End));
+    _mm_store_si128 ((__m128i *) (Destination + End + 48), Xmm3);
+    _mm_store_si128 ((__m128i *) (Destination + End + 32), Xmm2);
+    _mm_store_si128 ((__m128i *) (Destination + End + 16), Xmm1);
+    _mm_store_si128 ((__m128i *) (Destination + End), Xmm0);
+  }
+
+  return Length - End;
+}
+
+UINTN
+EfiCommonLibSetMemSimd (
+  IN UINT8  *Buffer,
+  IN UINTN  Size,
+  IN UINT8  Value
+  )
+/*++
+
+Routine Description:
+
+  Set the leading part of a buffer to Value with SSE2.
+
+Arguments:
+
+  Buffer  - Memory to set.
+
+  Size    - Number of bytes in the buffer, at least EFI_MEM_SIMD_THRESHOLD
+
+  Value   - Value of the set operation.
+
+Returns:
+
+  Number of leading bytes set. The caller sets the remainder.
+
+--*/
+{
+  UINTN   Head;
+  UINTN   Done;
+  __m128i Xmm0;
+
+  Xmm0 = _mm_set1_epi8 ((char) Value);
+  Head = (16 - ((UINTN) Buffer & 15)) & 15;
+  if (Head != 0) {
+    _mm_storeu_si128 ((__m128i *) Buffer, Xmm0);
+  }
+
+  for (Done = Head; Size - Done >= 64; Done += 64) {
+    _mm_store_si128 ((__m128i *) (Buffer + Done), Xmm0);
+    _mm_store_si128 ((__m128i *) (Buffer + Done + 16), Xmm0);
+    _mm_store_si128 ((__m128i *) (Buffer + Done + 32), Xmm0);
+    _mm_store_si128 ((__m128i *) (Buffer + Done + 48), Xmm0);
+  }
+
+  return Done;
+}
+
+#endif
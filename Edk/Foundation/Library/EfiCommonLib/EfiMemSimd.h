@@ -0,0 +1,131 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  EfiMemSimd.h
+
+Abstract:
+
+  Internal interface between the portable C memory routines and the
+  GCC/Clang SSE2 kernels in EfiMemSimd.c.
+
+  The kernels are chosen when the library is built, not at runtime.
+  EFI_COMMON_LIB_SIMD is only defined when the compiler targets SSE2,
+  which X64 always does and IA32 does with -msse2. Other tool chains and
+  processors keep the pure C word paths. There are no dispatch pointers
+  for SetVirtualAddressMap to miss, and no CPU feature probing that needs
+  privileged instructions.
+
+--*/
+
+#ifndef _EFI_MEM_SIMD_H_
+#define _EFI_MEM_SIMD_H_
+
+#if defined (__GNUC__) && defined (__SSE2__)
+#define EFI_COMMON_LIB_SIMD   1
+#endif
+
+//
+// Buffers shorter than this are handled by the word paths. The vector
+// kernels only pay off once the head/tail alignment work is amortized.
+//
+#define EFI_MEM_SIMD_THRESHOLD  256
+
+#ifdef EFI_COMMON_LIB_SIMD
+
+UINTN
+EfiCommonLibCopyMemForwardSimd (
+  IN UINT8        *Destination,
+  IN CONST UINT8  *Source,
+  IN UINTN        Length
+  )
+/*++
+
+Routine Description:
+
+  Copy the leading part of a buffer from low to high addresses with SSE2.
+  Safe when Destination <= Source.
+
+Arguments:
+
+  Destination - Target of copy
+
+  Source      - Place to copy from
+
+  Length      - Number of bytes in the buffer
+
+Returns:
+
+  Number of leading bytes copied. The caller copies the remainder.
+
+--*/
+;
+
+UINTN
+EfiCommonLibCopyMemBackwardSimd (
+  IN UINT8        *Destination,
+  IN CONST UINT8  *Source,
+  IN UINTN        Length
+  )
+/*++
+
+Routine Description:
+
+  Copy the trailing part of a buffer from high to low addresses with SSE2.
+  Safe when Destination > Source.
+
+Arguments:
+
+  Destination - Start of the copy target
+
+  Source      - Start of the copy source
+
+  Length      - Number of bytes in the buffer
+
+Returns:
+
+  Number of trailing bytes copied. The caller copies the remainder,
+  which always starts at Destination/Source.
+
+--*/
+;
+
+UINTN
+EfiCommonLibSetMemSimd (
+  IN UINT8  *Buffer,
+  IN UINTN  Size,
+  IN UINT8  Value
+  )
+/*++
+
+Routine Description:
+
+  Set the leading part of a buffer to Value with SSE2.
+
+Arguments:
+
+  Buffer  - Memory to set.
+
+  Size    - Number of bytes in the buffer
+
+  Value   - Value of the set operation.
+
+Returns:
+
+  Number of leading bytes set. The caller sets the remainder.
+
+--*/
+;
+
+#endif
+
+#endif
@@ -24,6 +24,7 @@ Abstract:
 
 #include "Tiano.h"
 #include "EfiCommonLib.h"
+#include "EfiMemSimd.h"
 
 
 VOID
@@ -52,14 +53,47 @@ Returns:
 
 --*/
 {
-  INT8  *Ptr;
-
-  if (Value == 0) {
-    EfiCommonLibZeroMem (Buffer, Size);
-  } else {
-    Ptr = Buffer;
-    while (Size--) {
-      *(Ptr++) = Value;
+  UINT8 *Ptr;
+  UINTN *PtrN;
+  UINTN Pattern;
+
+  Ptr = (UINT8 *) Buffer;
+
+#ifdef EFI_COMMON_LIB_SIMD
+  if (Size >= EFI_MEM_SIMD_THRESHOLD) {
+    Pattern = EfiCommonLibSetMemSimd (Ptr, Size, Value);
+    Ptr    += Pattern;
+    Size   -= Pattern;
+  }
+#endif
+
+  while ((Size > 0) && (EFI_UINTN_ALIGNED (Ptr) != 0)) {
+    *(Ptr++) = Value;
+    Size--;
+  }
+
+  if (Size >= sizeof (UINTN)) {
+    //
+    // ((UINTN) -1 / 0xFF) is 0x0101...01, so this replicates Value into
+    // every byte of a UINTN for both 32-bit and 64-bit processors.
+    //
+    Pattern = ((UINTN) -1 / 0xFF) * Value;
+
+    PtrN = (UINTN *) Ptr;
+    while (Size >= 2 * sizeof (UINTN)) {
+      PtrN[0] = Pattern;
+      PtrN[1] = Pattern;
+      PtrN   += 2;
+      Size   -= 2 * sizeof (UINTN);
+    }
+    if (Size >= sizeof (UINTN)) {
+      *(PtrN++) = Pattern;
+      Size -= sizeof (UINTN);
     }
+    Ptr = (UINT8 *) PtrN;
+  }
+
+  while (Size-- > 0) {
+    *(Ptr++) = Value;
   }
 }
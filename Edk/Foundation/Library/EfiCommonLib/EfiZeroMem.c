@@ -23,6 +23,7 @@ Abstract:
 --*/
 
 #include "Tiano.h"
+#include "EfiCommonLib.h"
 
 
 VOID
@@ -48,10 +49,5 @@ Returns:
 
 --*/
 {
-  INT8  *Ptr;
-
-  Ptr = Buffer;
-  while (Size--) {
-    *(Ptr++) = 0;
-  }
+  EfiCommonLibSetMem (Buffer, Size, 0);
 }
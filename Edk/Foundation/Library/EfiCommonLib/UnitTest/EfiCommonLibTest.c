@@ -0,0 +1,647 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  EfiCommonLibTest.c
+
+Abstract:
+
+  Host test and benchmark for the EfiCommonLib memory routines.
+
+  The test checks EfiCommonLibCopyMem, EfiCommonLibSetMem,
+  EfiCommonLibZeroMem, EfiCompareMem and EfiCompareGuid against byte by
+  byte reference versions, for every source/destination alignment pair,
+  overlapping and disjoint buffers, and lengths on both sides of the word
+  and SIMD thresholds. EfiCompareGuid is also run on GUIDs at every byte
+  offset, as found packed in IFR, device paths and FFS headers.
+
+  With -b the program times the library routines against the byte loops
+  the library used before the word and SIMD paths were added.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Tiano.h"
+#include "EfiCommonLib.h"
+
+INTN
+EfiCompareMem (
+  IN VOID     *MemOne,
+  IN VOID     *MemTwo,
+  IN UINTN    Length
+  );
+
+BOOLEAN
+EfiCompareGuid (
+  IN EFI_GUID *Guid1,
+  IN EFI_GUID *Guid2
+  );
+
+#define TEST_ALIGNMENTS     33
+#define TEST_BUFFER_SIZE    8192
+#define TEST_GUARD_SIZE     64
+
+//
+// Lengths around every interesting boundary: byte tail, UINTN words, the
+// two word unroll, EFI_MEM_SIMD_THRESHOLD and the SIMD unroll.
+//
+static UINTN  mTestLengths[] = {
+  0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65,
+  127, 128, 129, 255, 256, 257, 300, 319, 320, 321, 511, 512, 513,
+  1023, 1024, 1025, 1100, 2047, 2048, 2049
+};
+
+#define TEST_LENGTH_COUNT   (sizeof (mTestLengths) / sizeof (mTestLengths[0]))
+
+static UINTN  mFailures = 0;
+
+typedef
+VOID
+(*COPY_ROUTINE) (
+  IN VOID   *Destination,
+  IN VOID   *Source,
+  IN UINTN  Length
+  );
+
+typedef
+VOID
+(*SET_ROUTINE) (
+  IN VOID   *Buffer,
+  IN UINTN  Size,
+  IN UINT8  Value
+  );
+
+static
+VOID
+ReferenceCopyMem (
+  IN VOID   *Destination,
+  IN VOID   *Source,
+  IN UINTN  Length
+  )
+/*++
+
+Routine Description:
+
+  Byte by byte copy that handles overlap, as the library did before the
+  word paths were added.
+
+Arguments:
+
+  Destination - Target of copy
+  Source      - Place to copy from
+  Length      - Number of bytes to copy
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT8 *Destination8;
+  UINT8 *Source8;
+
+  Destination8  = (UINT8 *) Destination;
+  Source8       = (UINT8 *) Source;
+  if (Source8 > Destination8) {
+    while (Length-- > 0) {
+      *(Destination8++) = *(Source8++);
+    }
+  } else if (Source8 < Destination8) {
+    while (Length-- > 0) {
+      Destination8[Length] = Source8[Length];
+    }
+  }
+}
+
+static
+VOID
+ReferenceSetMem (
+  IN VOID   *Buffer,
+  IN UINTN  Size,
+  IN UINT8  Value
+  )
+/*++
+
+Routine Description:
+
+  Byte by byte set, as the library did before the word paths were added.
+
+Arguments:
+
+  Buffer  - Memory to set
+  Size    - Number of bytes to set
+  Value   - Value of the set operation
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT8 *Ptr;
+
+  Ptr = (UINT8 *) Buffer;
+  while (Size-- > 0) {
+    *(Ptr++) = Value;
+  }
+}
+
+static
+VOID
+Fail (
+  IN char   *Test,
+  IN UINTN  DestinationOffset,
+  IN UINTN  SourceOffset,
+  IN UINTN  Length
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Test              - Name of the failing check
+  DestinationOffset - Destination (or first buffer) offset
+  SourceOffset      - Source (or second buffer) offset
+  Length            - Length of the operation
+
+Returns:
+
+  None
+
+--*/
+{
+  if (mFailures < 20) {
+    printf (
+      "FAIL: %s DestinationOffset=%u SourceOffset=%u Length=%u\n",
+      Test,
+      (unsigned) DestinationOffset,
+      (unsigned) SourceOffset,
+      (unsigned) Length
+      );
+  }
+
+  mFailures++;
+}
+
+static
+VOID
+FillPattern (
+  IN UINT8  *Buffer,
+  IN UINTN  Size,
+  IN UINTN  Seed
+  )
+/*++
+
+Routine Description:
+
+  Fill a buffer with a byte pattern that differs for every Seed.
+
+--*/
+{
+  UINTN Index;
+
+  for (Index = 0; Index < Size; Index++) {
+    Buffer[Index] = (UINT8) ((Index * 131 + Seed * 7 + 1) & 0xFF);
+  }
+}
+
+static
+VOID
+TestCopyMem (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check EfiCommonLibCopyMem on disjoint buffers and on overlapping buffers
+  in both directions, for every alignment pair and every test length. The
+  bytes around the destination must not change.
+
+--*/
+{
+  static UINT8  Actual[TEST_BUFFER_SIZE];
+  static UINT8  Expected[TEST_BUFFER_SIZE];
+  UINTN         DestinationOffset;
+  UINTN         SourceOffset;
+  UINTN         LengthIndex;
+  UINTN         Length;
+  UINTN         Distance;
+
+  for (LengthIndex = 0; LengthIndex < TEST_LENGTH_COUNT; LengthIndex++) {
+    Length = mTestLengths[LengthIndex];
+    for (DestinationOffset = 0; DestinationOffset < TEST_ALIGNMENTS; DestinationOffset++) {
+      for (SourceOffset = 0; SourceOffset < TEST_ALIGNMENTS; SourceOffset++) {
+        //
+        // Disjoint buffers: source in the upper half, destination in the
+        // lower half of the same array.
+        //
+        FillPattern (Actual, TEST_BUFFER_SIZE, Length + SourceOffset);
+        memcpy (Expected, Actual, TEST_BUFFER_SIZE);
+        ReferenceCopyMem (
+          Expected + TEST_GUARD_SIZE + DestinationOffset,
+          Expected + TEST_BUFFER_SIZE / 2 + SourceOffset,
+          Length
+          );
+        EfiCommonLibCopyMem (
+          Actual + TEST_GUARD_SIZE + DestinationOffset,
+          Actual + TEST_BUFFER_SIZE / 2 + SourceOffset,
+          Length
+          );
+        if (memcmp (Actual, Expected, TEST_BUFFER_SIZE) != 0) {
+          Fail ("CopyMem", DestinationOffset, SourceOffset, Length);
+        }
+
+        //
+        // Overlapping buffers, destination above and below the source.
+        //
+        for (Distance = 1; Distance <= 65; Distance += 16) {
+          FillPattern (Actual, TEST_BUFFER_SIZE, Length + Distance);
+          memcpy (Expected, Actual, TEST_BUFFER_SIZE);
+          ReferenceCopyMem (
+            Expected + TEST_GUARD_SIZE + SourceOffset + Distance + DestinationOffset,
+            Expected + TEST_GUARD_SIZE + SourceOffset,
+            Length
+            );
+          EfiCommonLibCopyMem (
+            Actual + TEST_GUARD_SIZE + SourceOffset + Distance + DestinationOffset,
+            Actual + TEST_GUARD_SIZE + SourceOffset,
+            Length
+            );
+          if (memcmp (Actual, Expected, TEST_BUFFER_SIZE) != 0) {
+            Fail ("CopyMem overlap up", DestinationOffset, SourceOffset, Length);
+          }
+
+          FillPattern (Actual, TEST_BUFFER_SIZE, Length + Distance);
+          memcpy (Expected, Actual, TEST_BUFFER_SIZE);
+          ReferenceCopyMem (
+            Expected + TEST_GUARD_SIZE + DestinationOffset,
+            Expected + TEST_GUARD_SIZE + DestinationOffset + Distance + SourceOffset,
+            Length
+            );
+          EfiCommonLibCopyMem (
+            Actual + TEST_GUARD_SIZE + DestinationOffset,
+            Actual + TEST_GUARD_SIZE + DestinationOffset + Distance + SourceOffset,
+            Length
+            );
+          if (memcmp (Actual, Expected, TEST_BUFFER_SIZE) != 0) {
+            Fail ("CopyMem overlap down", DestinationOffset, SourceOffset, Length);
+          }
+        }
+      }
+    }
+  }
+}
+
+static
+VOID
+TestSetMem (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check EfiCommonLibSetMem and EfiCommonLibZeroMem at every alignment and
+  test length. The bytes around the buffer must not change.
+
+--*/
+{
+  static UINT8  Actual[TEST_BUFFER_SIZE];
+  static UINT8  Expected[TEST_BUFFER_SIZE];
+  UINTN         Offset;
+  UINTN         LengthIndex;
+  UINTN         Length;
+
+  for (LengthIndex = 0; LengthIndex < TEST_LENGTH_COUNT; LengthIndex++) {
+    Length = mTestLengths[LengthIndex];
+    for (Offset = 0; Offset < TEST_ALIGNMENTS; Offset++) {
+      FillPattern (Actual, TEST_BUFFER_SIZE, Offset);
+      memcpy (Expected, Actual, TEST_BUFFER_SIZE);
+      ReferenceSetMem (Expected + TEST_GUARD_SIZE + Offset, Length, 0xA5);
+      EfiCommonLibSetMem (Actual + TEST_GUARD_SIZE + Offset, Length, 0xA5);
+      if (memcmp (Actual, Expected, TEST_BUFFER_SIZE) != 0) {
+        Fail ("SetMem", Offset, 0, Length);
+      }
+
+      FillPattern (Actual, TEST_BUFFER_SIZE, Offset);
+      memcpy (Expected, Actual, TEST_BUFFER_SIZE);
+      ReferenceSetMem (Expected + TEST_GUARD_SIZE + Offset, Length, 0);
+      EfiCommonLibZeroMem (Actual + TEST_GUARD_SIZE + Offset, Length);
+      if (memcmp (Actual, Expected, TEST_BUFFER_SIZE) != 0) {
+        Fail ("ZeroMem", Offset, 0, Length);
+      }
+    }
+  }
+}
+
+static
+INTN
+Sign (
+  IN INTN Value
+  )
+/*++
+
+Routine Description:
+
+  Return -1, 0 or 1 for a negative, zero or positive Value.
+
+--*/
+{
+  return (Value > 0) ? 1 : ((Value < 0) ? -1 : 0);
+}
+
+static
+VOID
+TestCompareMem (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check that EfiCompareMem returns 0 for equal buffers, and the sign of the
+  first differing byte, compared as UINT8, for every position of a single
+  difference.
+
+--*/
+{
+  static UINT8  One[TEST_BUFFER_SIZE];
+  static UINT8  Two[TEST_BUFFER_SIZE];
+  UINTN         OneOffset;
+  UINTN         TwoOffset;
+  UINTN         LengthIndex;
+  UINTN         Length;
+  UINTN         Position;
+
+  for (LengthIndex = 0; LengthIndex < TEST_LENGTH_COUNT; LengthIndex++) {
+    Length = mTestLengths[LengthIndex];
+    if (Length > 300) {
+      continue;
+    }
+
+    for (OneOffset = 0; OneOffset < 17; OneOffset++) {
+      for (TwoOffset = 0; TwoOffset < 17; TwoOffset++) {
+        FillPattern (One + OneOffset, Length, Length);
+        FillPattern (Two + TwoOffset, Length, Length);
+        if (EfiCompareMem (One + OneOffset, Two + TwoOffset, Length) != 0) {
+          Fail ("CompareMem equal", OneOffset, TwoOffset, Length);
+        }
+
+        for (Position = 0; Position < Length; Position++) {
+          One[OneOffset + Position] = 0x80;
+          Two[TwoOffset + Position] = 0x7F;
+          if (Sign (EfiCompareMem (One + OneOffset, Two + TwoOffset, Length)) != 1 ||
+              Sign (EfiCompareMem (Two + TwoOffset, One + OneOffset, Length)) != -1) {
+            Fail ("CompareMem differ", OneOffset, TwoOffset, Length);
+          }
+
+          FillPattern (One + OneOffset, Length, Length);
+          FillPattern (Two + TwoOffset, Length, Length);
+        }
+      }
+    }
+  }
+}
+
+static
+VOID
+TestCompareGuid (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check EfiCompareGuid with both GUIDs at every byte offset, so that the
+  8-byte, 4-byte and byte paths all run, for equal GUIDs and for GUIDs
+  that differ in any one byte.
+
+--*/
+{
+  UINT64  Storage1[6];
+  UINT64  Storage2[6];
+  UINT8   *Guid1;
+  UINT8   *Guid2;
+  UINTN   Offset1;
+  UINTN   Offset2;
+  UINTN   Position;
+
+  for (Offset1 = 0; Offset1 < 16; Offset1++) {
+    for (Offset2 = 0; Offset2 < 16; Offset2++) {
+      Guid1 = (UINT8 *) Storage1 + Offset1;
+      Guid2 = (UINT8 *) Storage2 + Offset2;
+      FillPattern (Guid1, sizeof (EFI_GUID), 3);
+      FillPattern (Guid2, sizeof (EFI_GUID), 3);
+      if (!EfiCompareGuid ((EFI_GUID *) Guid1, (EFI_GUID *) Guid2)) {
+        Fail ("CompareGuid equal", Offset1, Offset2, sizeof (EFI_GUID));
+      }
+
+      for (Position = 0; Position < sizeof (EFI_GUID); Position++) {
+        Guid2[Position] ^= 0x10;
+        if (EfiCompareGuid ((EFI_GUID *) Guid1, (EFI_GUID *) Guid2)) {
+          Fail ("CompareGuid differ", Offset1, Offset2, Position);
+        }
+
+        Guid2[Position] ^= 0x10;
+      }
+    }
+  }
+}
+
+static
+double
+TimeCopy (
+  IN COPY_ROUTINE   Copy,
+  IN UINT8          *Destination,
+  IN UINT8          *Source,
+  IN UINTN          Size,
+  IN UINTN          Count
+  )
+/*++
+
+Routine Description:
+
+  Return the processor time, in seconds, that Count calls of Copy take.
+  The routine is called through a pointer so that it is not inlined and
+  the repeated calls are not optimized away.
+
+--*/
+{
+  clock_t Start;
+  UINTN   Iteration;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < Count; Iteration++) {
+    Copy (Destination, Source, Size);
+  }
+
+  return (double) (clock () - Start) / CLOCKS_PER_SEC;
+}
+
+static
+double
+TimeSet (
+  IN SET_ROUTINE    Set,
+  IN UINT8          *Buffer,
+  IN UINTN          Size,
+  IN UINTN          Count
+  )
+/*++
+
+Routine Description:
+
+  Return the processor time, in seconds, that Count calls of Set take.
+
+--*/
+{
+  clock_t Start;
+  UINTN   Iteration;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < Count; Iteration++) {
+    Set (Buffer, Size, (UINT8) Iteration);
+  }
+
+  return (double) (clock () - Start) / CLOCKS_PER_SEC;
+}
+
+static
+double
+MegabytesPerSecond (
+  IN UINTN    Bytes,
+  IN double   Seconds
+  )
+/*++
+
+Routine Description:
+
+  Convert a byte count and a time into MB/s.
+
+--*/
+{
+  return Bytes / 1048576.0 / ((Seconds > 0) ? Seconds : 1e-9);
+}
+
+//
+// Volatile so that the compiler cannot see which routine is timed.
+//
+static COPY_ROUTINE volatile  mLibraryCopy    = EfiCommonLibCopyMem;
+static COPY_ROUTINE volatile  mReferenceCopy  = ReferenceCopyMem;
+static SET_ROUTINE volatile   mLibrarySet     = EfiCommonLibSetMem;
+static SET_ROUTINE volatile   mReferenceSet   = ReferenceSetMem;
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Time CopyMem and SetMem for a range of sizes, each against the byte loop
+  the library used before. Every size moves the same total number of bytes
+  so the MB/s figures compare directly. The buffers are offset by one byte
+  from their allocation to include the alignment head.
+
+  GCC turns the reference byte loops into memcpy/memset calls unless the
+  test is built with -fno-tree-loop-distribute-patterns.
+
+--*/
+{
+  static UINTN  Sizes[] = { 16, 64, 256, 4096, 65536, 1024 * 1024 };
+  UINT8         *Source;
+  UINT8         *Destination;
+  UINTN         Index;
+  UINTN         Count;
+  UINTN         Total;
+
+  Total       = 256 * 1024 * 1024;
+  Source      = malloc (Sizes[5] + 64);
+  Destination = malloc (Sizes[5] + 64);
+  if (Source == NULL || Destination == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  FillPattern (Source, Sizes[5] + 64, 0);
+  printf ("%-10s %8s %14s %14s\n", "Operation", "Size", "Library MB/s", "Byte MB/s");
+  for (Index = 0; Index < sizeof (Sizes) / sizeof (Sizes[0]); Index++) {
+    Count = Total / Sizes[Index];
+    printf (
+      "%-10s %8u %14.0f %14.0f\n",
+      "CopyMem",
+      (unsigned) Sizes[Index],
+      MegabytesPerSecond (Total, TimeCopy (mLibraryCopy, Destination + 1, Source + 1, Sizes[Index], Count)),
+      MegabytesPerSecond (Total, TimeCopy (mReferenceCopy, Destination + 1, Source + 1, Sizes[Index], Count))
+      );
+    printf (
+      "%-10s %8u %14.0f %14.0f\n",
+      "SetMem",
+      (unsigned) Sizes[Index],
+      MegabytesPerSecond (Total, TimeSet (mLibrarySet, Destination + 1, Sizes[Index], Count)),
+      MegabytesPerSecond (Total, TimeSet (mReferenceSet, Destination + 1, Sizes[Index], Count))
+      );
+  }
+
+  free (Source);
+  free (Destination);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, or the benchmark when called with -b.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  TestCopyMem ();
+  TestSetMem ();
+  TestCompareMem ();
+  TestCompareGuid ();
+
+  if (mFailures != 0) {
+    printf ("EfiCommonLibTest: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("EfiCommonLibTest: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,29 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  FaultTolerantWriteLiteMultiple.c
+
+Abstract:
+
+  Companion of EFI_FTW_LITE_PROTOCOL that applies several writes to one
+  target block as a single fault tolerant update.
+
+--*/
+
+#include "Tiano.h"
+#include EFI_PROTOCOL_DEFINITION (FaultTolerantWriteLiteMultiple)
+
+EFI_GUID gEfiFaultTolerantWriteLiteMultipleProtocolGuid = EFI_FTW_LITE_MULTIPLE_PROTOCOL_GUID;
+
+EFI_GUID_STRING (&gEfiFaultTolerantWriteLiteMultipleProtocolGuid, "FaultTolerantWriteLiteMultiple Protocol", 
+                 "Fault Tolerant Write Lite Multiple protocol");
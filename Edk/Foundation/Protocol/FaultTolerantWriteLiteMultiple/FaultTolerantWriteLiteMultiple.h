@@ -0,0 +1,97 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  FaultTolerantWriteLiteMultiple.h
+
+Abstract:
+
+  Companion of EFI_FTW_LITE_PROTOCOL that applies several writes to one
+  target block as a single fault tolerant update.
+
+  The FTW Lite driver installs it on the handle of EFI_FTW_LITE_PROTOCOL.
+  Callers that find no instance use EFI_FTW_LITE_PROTOCOL.Write () for
+  each write instead.
+
+--*/
+
+#ifndef _FW_FAULT_TOLERANT_WRITE_LITE_MULTIPLE_PROTOCOL_H_
+#define _FW_FAULT_TOLERANT_WRITE_LITE_MULTIPLE_PROTOCOL_H_
+
+#define EFI_FTW_LITE_MULTIPLE_PROTOCOL_GUID \
+{ 0x5ff7d1d1, 0x1056, 0x4f48, 0xb6, 0x3f, 0x31, 0x45, 0x8f, 0xf5, 0xf5, 0x20 }
+
+//
+// Forward reference for pure ANSI compatability
+//
+EFI_FORWARD_DECLARATION (EFI_FTW_LITE_MULTIPLE_PROTOCOL);
+
+//
+// One of the writes of a WriteMultiple () request
+//
+typedef struct {
+  UINTN                                Offset;
+  UINTN                                NumBytes;
+  VOID                                 *Buffer;
+} EFI_FTW_LITE_WRITE_DATA;
+
+//
+// Protocol API definitions
+//
+
+typedef
+EFI_STATUS
+(EFIAPI * EFI_FTW_LITE_WRITE_MULTIPLE) (
+  IN EFI_FTW_LITE_MULTIPLE_PROTOCOL    *This,
+  IN EFI_HANDLE                        FvbHandle,
+  IN EFI_LBA                           Lba,
+  IN UINTN                             WriteCount,
+  IN EFI_FTW_LITE_WRITE_DATA           *Writes
+  );
+/*++
+
+Routine Description:
+
+  Applies several writes to the same target block as one fault tolerant
+  update. The writes share one record in fault tolerant storage and one
+  spare block cycle, so the target block is either left with its original
+  contents or with all the writes applied. Writes are applied in array
+  order, a later write wins where two of them overlap.
+
+Arguments:
+
+  This             - Calling context
+  FvBlockHandle    - The handle of FVB protocol that provides services for 
+                     reading, writing, and erasing the target block.
+  Lba              - The logical block address of the target block.  
+  WriteCount       - The number of entries in Writes.
+  Writes           - The offset within the target block, the number of
+                     bytes and the data of each write.
+
+Returns:
+
+  EFI_SUCCESS            - The function completed successfully
+  EFI_INVALID_PARAMETER  - WriteCount is 0 or Writes is NULL.
+  Others                 - As returned by EFI_FTW_LITE_PROTOCOL.Write ().
+
+--*/
+
+//
+// Protocol declaration
+//
+typedef struct _EFI_FTW_LITE_MULTIPLE_PROTOCOL {
+  EFI_FTW_LITE_WRITE_MULTIPLE      WriteMultiple;
+} EFI_FTW_LITE_MULTIPLE_PROTOCOL;
+
+extern EFI_GUID gEfiFaultTolerantWriteLiteMultipleProtocolGuid;
+
+#endif
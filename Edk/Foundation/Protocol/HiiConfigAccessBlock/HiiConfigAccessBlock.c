@@ -0,0 +1,27 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  HiiConfigAccessBlock.c
+
+Abstract:
+
+  Binary companion of EFI_HII_CONFIG_ACCESS_PROTOCOL for Buffer storage.
+
+--*/
+
+#include "Tiano.h"
+#include EFI_PROTOCOL_DEFINITION (HiiConfigAccessBlock)
+
+EFI_GUID gEfiHiiConfigAccessBlockProtocolGuid = EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL_GUID;
+
+EFI_GUID_STRING (&gEfiHiiConfigAccessBlockProtocolGuid, "HII Config Access Block Protocol", "HII Config Access Block Protocol");
@@ -0,0 +1,122 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  HiiConfigAccessBlock.h
+
+Abstract:
+
+  Binary companion of EFI_HII_CONFIG_ACCESS_PROTOCOL for Buffer storage.
+
+  A configuration driver may install it next to its ConfigAccess protocol,
+  the browser then transfers Buffer storage settings as raw bytes instead of
+  building <ConfigResp> strings which the driver converts again by
+  BlockToConfig()/ConfigToBlock(). Only the bytes covered by the <BlockName>s
+  of a request are transferred, exactly as in the string based interface.
+
+--*/
+
+#ifndef _HII_CONFIG_ACCESS_BLOCK_H_
+#define _HII_CONFIG_ACCESS_BLOCK_H_
+
+#define EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL_GUID \
+  { \
+    0x7b3b2ee5, 0x3c56, 0x4f1a, 0x8a, 0x2b, 0x0f, 0x6e, 0x91, 0xd4, 0x55, 0x3c \
+  }
+
+//
+// Forward reference for pure ANSI compatability
+//
+EFI_FORWARD_DECLARATION (EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL);
+
+//
+// Binary form of <BlockName> ::= 'OFFSET='<Number>&'WIDTH='<Number>
+//
+typedef struct {
+  UINT16                                     Offset;
+  UINT16                                     Width;
+} EFI_HII_BLOCK_ELEMENT;
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_HII_ACCESS_EXTRACT_BLOCK) (
+  IN  EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL   *This,
+  IN  CONST EFI_STRING                       ConfigHdr,
+  IN  UINTN                                  ElementCount,
+  IN  CONST EFI_HII_BLOCK_ELEMENT            *Element,
+  IN OUT UINT8                               *Block,
+  IN  UINTN                                  BlockSize
+  )
+/*++
+
+  Routine Description:
+    Read the current settings of the requested elements of a Buffer storage.
+
+  Arguments:
+    This          - Points to the EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL.
+    ConfigHdr     - A null-terminated Unicode string in <ConfigHdr> format
+                    which identifies the Buffer storage.
+    ElementCount  - Number of entries in Element.
+    Element       - The byte ranges of the storage to read.
+    Block         - The image of the storage, only the requested byte ranges
+                    are updated.
+    BlockSize     - Size of Block in bytes.
+
+  Returns:
+    EFI_SUCCESS           - The requested byte ranges are filled in.
+    EFI_NOT_FOUND         - ConfigHdr doesn't match any Buffer storage of this driver.
+    EFI_INVALID_PARAMETER - An element is beyond Block or the storage.
+
+--*/
+;
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_HII_ACCESS_ROUTE_BLOCK) (
+  IN  EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL   *This,
+  IN  CONST EFI_STRING                       ConfigHdr,
+  IN  UINTN                                  ElementCount,
+  IN  CONST EFI_HII_BLOCK_ELEMENT            *Element,
+  IN  CONST UINT8                            *Block,
+  IN  UINTN                                  BlockSize
+  )
+/*++
+
+  Routine Description:
+    Apply new settings to the requested elements of a Buffer storage.
+
+  Arguments:
+    This          - Points to the EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL.
+    ConfigHdr     - A null-terminated Unicode string in <ConfigHdr> format
+                    which identifies the Buffer storage.
+    ElementCount  - Number of entries in Element.
+    Element       - The byte ranges of the storage to update.
+    Block         - The image of the storage, only the requested byte ranges
+                    are taken from it.
+    BlockSize     - Size of Block in bytes.
+
+  Returns:
+    EFI_SUCCESS           - The requested byte ranges are stored.
+    EFI_NOT_FOUND         - ConfigHdr doesn't match any Buffer storage of this driver.
+    EFI_INVALID_PARAMETER - An element is beyond Block or the storage.
+
+--*/
+;
+
+typedef struct _EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL {
+  EFI_HII_ACCESS_EXTRACT_BLOCK      ExtractBlock;
+  EFI_HII_ACCESS_ROUTE_BLOCK        RouteBlock;
+} EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL;
+
+extern EFI_GUID gEfiHiiConfigAccessBlockProtocolGuid;
+
+#endif
@@ -0,0 +1,29 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation                                                         
+All rights reserved. This program and the accompanying materials                          
+are licensed and made available under the terms and conditions of the BSD License         
+which accompanies this distribution.  The full text of the license may be found at        
+http://opensource.org/licenses/bsd-license.php                                            
+                                                                                          
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,                     
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED. 
+
+Module Name:
+
+  MnpPollDebug.c
+
+Abstract:
+
+--*/
+
+#include "EfiSpec.h"
+#include EFI_PROTOCOL_DEFINITION (MnpPollDebug)
+
+EFI_GUID gEfiMnpPollDebugProtocolGuid = EFI_MNP_POLL_DEBUG_PROTOCOL_GUID;
+
+EFI_GUID_STRING (
+  &gEfiMnpPollDebugProtocolGuid, 
+  "MNP Poll Debug Protocol",  
+  "MNP Poll Debug Protocol"
+  );
@@ -0,0 +1,80 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation                                                         
+All rights reserved. This program and the accompanying materials                          
+are licensed and made available under the terms and conditions of the BSD License         
+which accompanies this distribution.  The full text of the license may be found at        
+http://opensource.org/licenses/bsd-license.php                                            
+                                                                                          
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,                     
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED. 
+
+Module Name:
+
+  MnpPollDebug.h
+
+Abstract:
+
+  Debug protocol installed by MNP on the controller handle next to the MNP
+  service binding protocol. It reports how the adaptive system poll behaves
+  on a NIC, and allows its parameters to be tuned at runtime.
+
+  EFI_MNP_POLL_DEBUG_PROTOCOL is a private protocol, not defined by UEFI2.0
+
+--*/
+
+#ifndef _MNP_POLL_DEBUG_H_
+#define _MNP_POLL_DEBUG_H_
+
+#define EFI_MNP_POLL_DEBUG_PROTOCOL_GUID \
+  {0xb8fb194d, 0x1a7d, 0x4784, 0x9d, 0xa2, 0x4d, 0xe8, 0x49, 0xd3, 0x7a, 0x60}
+
+typedef struct _EFI_MNP_POLL_DEBUG_PROTOCOL EFI_MNP_POLL_DEBUG_PROTOCOL;
+
+//
+// Intervals are in 100ns units, as used by gBS->SetTimer.
+//
+typedef struct {
+  UINT64                    MinInterval;        // Interval after a poll that received frames
+  UINT64                    MaxInterval;        // Upper bound of the idle back off
+  UINT32                    PollBudget;         // Maximum frames drained by one poll
+} EFI_MNP_POLL_PARAMETERS;
+
+typedef struct {
+  UINT64                    PollCount;          // Number of timer driven polls
+  UINT64                    IdlePollCount;      // Polls that found no frame
+  UINT64                    PacketCount;        // Frames received by timer driven polls
+  UINT64                    BudgetExhaustedCount; // Polls that stopped at PollBudget
+  UINT32                    MaxPacketsPerPoll;  // Largest number of frames in one poll
+  UINT64                    CurrentInterval;    // Interval the poll timer is armed with
+} EFI_MNP_POLL_STATISTICS;
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_MNP_POLL_DEBUG_GET_STATISTICS) (
+  IN  EFI_MNP_POLL_DEBUG_PROTOCOL *This,
+  OUT EFI_MNP_POLL_STATISTICS     *Statistics,
+  OUT EFI_MNP_POLL_PARAMETERS     *Parameters    OPTIONAL
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_MNP_POLL_DEBUG_RESET_STATISTICS) (
+  IN EFI_MNP_POLL_DEBUG_PROTOCOL  *This
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_MNP_POLL_DEBUG_SET_PARAMETERS) (
+  IN EFI_MNP_POLL_DEBUG_PROTOCOL  *This,
+  IN EFI_MNP_POLL_PARAMETERS      *Parameters
+  );
+
+struct _EFI_MNP_POLL_DEBUG_PROTOCOL {
+  EFI_MNP_POLL_DEBUG_GET_STATISTICS   GetStatistics;
+  EFI_MNP_POLL_DEBUG_RESET_STATISTICS ResetStatistics;
+  EFI_MNP_POLL_DEBUG_SET_PARAMETERS   SetParameters;
+};
+
+extern EFI_GUID gEfiMnpPollDebugProtocolGuid;
+#endif
@@ -0,0 +1,37 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation                                                         
+All rights reserved. This program and the accompanying materials                          
+are licensed and made available under the terms and conditions of the BSD License         
+which accompanies this distribution.  The full text of the license may be found at        
+http://opensource.org/licenses/bsd-license.php                                            
+                                                                                          
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,                     
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED. 
+
+Module Name:
+
+  UsbAsyncBulk.c
+
+Abstract:
+
+--*/
+
+#include "EfiSpec.h"
+#include EFI_PROTOCOL_DEFINITION (UsbAsyncBulk)
+
+EFI_GUID gEfiUsb2HcAsyncBulkProtocolGuid = EFI_USB2_HC_ASYNC_BULK_PROTOCOL_GUID;
+
+EFI_GUID_STRING (
+  &gEfiUsb2HcAsyncBulkProtocolGuid, 
+  "USB2 HC Async Bulk Protocol",  
+  "USB2 HC Async Bulk Protocol"
+  );
+
+EFI_GUID gEfiUsbIoAsyncBulkProtocolGuid = EFI_USB_IO_ASYNC_BULK_PROTOCOL_GUID;
+
+EFI_GUID_STRING (
+  &gEfiUsbIoAsyncBulkProtocolGuid, 
+  "USB IO Async Bulk Protocol",  
+  "USB IO Async Bulk Protocol"
+  );
@@ -0,0 +1,141 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation                                                         
+All rights reserved. This program and the accompanying materials                          
+are licensed and made available under the terms and conditions of the BSD License         
+which accompanies this distribution.  The full text of the license may be found at        
+http://opensource.org/licenses/bsd-license.php                                            
+                                                                                          
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,                     
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED. 
+
+Module Name:
+
+  UsbAsyncBulk.h
+
+Abstract:
+
+  Non-blocking bulk transfer interfaces. The host controller driver installs
+  EFI_USB2_HC_ASYNC_BULK_PROTOCOL next to USB2_HC, and the USB bus driver
+  installs EFI_USB_IO_ASYNC_BULK_PROTOCOL next to each USB_IO built on such
+  a host controller. A class driver can queue several bulk transfers and
+  have them run back to back instead of blocking on each of them in turn.
+
+  Transfers queued to the same endpoint run in submission order, and the
+  data toggle carries over from one to the next. When one of them fails
+  or is cancelled before it finishes, the transfers queued after it on
+  that endpoint are aborted with EFI_USB_ERR_NOTEXECUTE. Completion is
+  detected by the host controller's periodic monitor, or earlier by
+  calling Poll. The callback is invoked once for each transfer that is
+  not cancelled.
+
+  EFI_USB2_HC_ASYNC_BULK_PROTOCOL and EFI_USB_IO_ASYNC_BULK_PROTOCOL are
+  private protocols, not defined by UEFI2.0
+
+--*/
+
+#ifndef _USB_ASYNC_BULK_H_
+#define _USB_ASYNC_BULK_H_
+
+#include EFI_PROTOCOL_DEFINITION (UsbHostController)
+
+#define EFI_USB2_HC_ASYNC_BULK_PROTOCOL_GUID \
+  {0x2af08ce6, 0x0460, 0x4596, 0xa1, 0x13, 0x94, 0x06, 0x3d, 0x2a, 0xc6, 0xbe}
+
+#define EFI_USB_IO_ASYNC_BULK_PROTOCOL_GUID \
+  {0x944025d9, 0xea51, 0x4e60, 0x8b, 0x64, 0x5c, 0xad, 0xc9, 0xf3, 0x0b, 0x48}
+
+typedef struct _EFI_USB2_HC_ASYNC_BULK_PROTOCOL EFI_USB2_HC_ASYNC_BULK_PROTOCOL;
+typedef struct _EFI_USB_IO_ASYNC_BULK_PROTOCOL  EFI_USB_IO_ASYNC_BULK_PROTOCOL;
+
+//
+// Called when a queued bulk transfer finishes. DataLength is the amount
+// of data transferred, DataToggle the next data toggle of the endpoint.
+//
+typedef
+VOID
+(EFIAPI *EFI_USB_ASYNC_BULK_CALLBACK) (
+  IN VOID                     *Context,
+  IN UINTN                    DataLength,
+  IN UINT8                    DataToggle,
+  IN UINT32                   UsbResult
+  );
+
+//
+// Host controller level interface
+//
+typedef
+EFI_STATUS
+(EFIAPI *EFI_USB2_HC_ASYNC_BULK_SUBMIT) (
+  IN  EFI_USB2_HC_ASYNC_BULK_PROTOCOL     *This,
+  IN  UINT8                               DeviceAddress,
+  IN  UINT8                               EndPointAddress,
+  IN  UINT8                               DeviceSpeed,
+  IN  UINTN                               MaximumPacketLength,
+  IN  VOID                                *Data,
+  IN  UINTN                               DataLength,
+  IN  UINT8                               DataToggle,
+  IN  EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  IN  EFI_USB_ASYNC_BULK_CALLBACK         Callback,
+  IN  VOID                                *Context,
+  OUT VOID                                **Request
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_USB2_HC_ASYNC_BULK_POLL) (
+  IN  EFI_USB2_HC_ASYNC_BULK_PROTOCOL     *This
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_USB2_HC_ASYNC_BULK_CANCEL) (
+  IN  EFI_USB2_HC_ASYNC_BULK_PROTOCOL     *This,
+  IN  VOID                                *Request,
+  OUT UINT8                               *DataToggle   OPTIONAL
+  );
+
+struct _EFI_USB2_HC_ASYNC_BULK_PROTOCOL {
+  EFI_USB2_HC_ASYNC_BULK_SUBMIT           Submit;
+  EFI_USB2_HC_ASYNC_BULK_POLL             Poll;
+  EFI_USB2_HC_ASYNC_BULK_CANCEL           Cancel;
+};
+
+//
+// USB_IO level interface, the device and endpoint state
+// (address, speed, data toggle) is managed by the bus driver.
+//
+typedef
+EFI_STATUS
+(EFIAPI *EFI_USB_IO_ASYNC_BULK_SUBMIT) (
+  IN  EFI_USB_IO_ASYNC_BULK_PROTOCOL      *This,
+  IN  UINT8                               DeviceEndpoint,
+  IN  VOID                                *Data,
+  IN  UINTN                               DataLength,
+  IN  EFI_USB_ASYNC_BULK_CALLBACK         Callback,
+  IN  VOID                                *Context,
+  OUT VOID                                **Request
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_USB_IO_ASYNC_BULK_POLL) (
+  IN  EFI_USB_IO_ASYNC_BULK_PROTOCOL      *This
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_USB_IO_ASYNC_BULK_CANCEL) (
+  IN  EFI_USB_IO_ASYNC_BULK_PROTOCOL      *This,
+  IN  VOID                                *Request
+  );
+
+struct _EFI_USB_IO_ASYNC_BULK_PROTOCOL {
+  EFI_USB_IO_ASYNC_BULK_SUBMIT            Submit;
+  EFI_USB_IO_ASYNC_BULK_POLL              Poll;
+  EFI_USB_IO_ASYNC_BULK_CANCEL            Cancel;
+};
+
+extern EFI_GUID gEfiUsb2HcAsyncBulkProtocolGuid;
+extern EFI_GUID gEfiUsbIoAsyncBulkProtocolGuid;
+#endif
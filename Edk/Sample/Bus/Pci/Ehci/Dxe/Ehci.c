@@ -139,10 +139,11 @@ EhcReset (
     }
     
     //
-    // Clean up the asynchronous transfers, currently only
-    // interrupt supports asynchronous operation.
+    // Clean up the asynchronous interrupt transfers and
+    // the queued bulk transfers.
     //
     EhciDelAllAsyncIntTransfers (Ehc);
+    EhciDelAllAsyncBulkTransfers (Ehc);
     EhcAckAllInterrupt (Ehc);
     EhcFreeSched (Ehc);
 
@@ -947,6 +948,204 @@ ON_EXIT:
   return Status;
 }
 
+STATIC
+EFI_STATUS
+EFIAPI
+EhcAsyncBulkSubmit (
+  IN  EFI_USB2_HC_ASYNC_BULK_PROTOCOL     *This,
+  IN  UINT8                               DeviceAddress,
+  IN  UINT8                               EndPointAddress,
+  IN  UINT8                               DeviceSpeed,
+  IN  UINTN                               MaximumPacketLength,
+  IN  VOID                                *Data,
+  IN  UINTN                               DataLength,
+  IN  UINT8                               DataToggle,
+  IN  EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  IN  EFI_USB_ASYNC_BULK_CALLBACK         Callback,
+  IN  VOID                                *Context,
+  OUT VOID                                **Request
+  )
+/*++
+
+  Routine Description:
+
+    Queue a bulk transfer to a bulk endpoint of a USB device without
+    waiting for it. It is started once the transfers queued before
+    it to the same endpoint finish.
+
+  Arguments:
+
+    This                - This EFI_USB2_HC_ASYNC_BULK_PROTOCOL instance.
+    DeviceAddress       - Target device address
+    EndPointAddress     - Endpoint number and its direction in bit 7.
+    DeviceSpeed         - Device speed, Low speed device doesn't support 
+                          bulk transfer.
+    MaximumPacketLength - Maximum packet size the endpoint is capable of 
+                          sending or receiving.
+    Data                - The buffer of data to transmit from or receive
+                          into. It must stay valid until the transfer ends.
+    DataLength          - The lenght of the data buffer
+    DataToggle          - The data toggle to start with if no other transfer
+                          is queued to the endpoint. Otherwise the toggle 
+                          continues from the transfer ahead of it.
+    Translator          - A pointr to the transaction translator data.
+    Callback            - The function to call when the transfer ends
+    Context             - The context to the callback
+    Request             - Return the handle to cancel the transfer with
+
+  Returns:
+
+    EFI_SUCCESS           : The transfer is queued.
+    EFI_OUT_OF_RESOURCES  : The transfer failed due to lack of resource.
+    EFI_INVALID_PARAMETER : Some parameters are invalid.
+    EFI_DEVICE_ERROR      : The transfer failed due to host controller error.
+
+--*/
+{
+  USB2_HC_DEV             *Ehc;
+  URB                     *Urb;
+  EFI_TPL                 OldTpl;
+  EFI_STATUS              Status;
+
+  //
+  // Validate the parameters
+  //
+  if ((Data == NULL) || (DataLength == 0) || (Callback == NULL) || (Request == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((DataToggle != 0) && (DataToggle != 1)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((DeviceSpeed == EFI_USB_SPEED_LOW) ||
+      ((DeviceSpeed == EFI_USB_SPEED_FULL) && (MaximumPacketLength > 64)) ||
+      ((EFI_USB_SPEED_HIGH == DeviceSpeed) && (MaximumPacketLength > 512))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl  = gBS->RaiseTPL (EHC_TPL);
+  Ehc     = EHC_FROM_ASYNC_BULK (This);
+  Status  = EFI_SUCCESS;
+
+  if (EhcIsHalt (Ehc) || EhcIsSysError (Ehc)) {
+    EHC_ERROR (("EhcAsyncBulkSubmit: HC is halted\n"));
+
+    EhcAckAllInterrupt (Ehc);
+    Status = EFI_DEVICE_ERROR;
+    goto ON_EXIT;
+  }
+
+  Urb = EhcCreateUrb (
+          Ehc,
+          DeviceAddress,
+          EndPointAddress,
+          DeviceSpeed,
+          DataToggle,
+          MaximumPacketLength,
+          Translator,
+          EHC_BULK_TRANSFER,
+          NULL,
+          Data,
+          DataLength,
+          NULL,
+          Context,
+          1
+          );
+
+  if (Urb == NULL) {
+    EHC_ERROR (("EhcAsyncBulkSubmit: failed to create URB\n"));
+
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ON_EXIT;
+  }
+
+  Urb->BulkCallback = Callback;
+  EhcLinkAsyncBulkTransfer (Ehc, Urb);
+
+  *Request = Urb;
+
+ON_EXIT:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+EhcAsyncBulkPoll (
+  IN  EFI_USB2_HC_ASYNC_BULK_PROTOCOL     *This
+  )
+/*++
+
+  Routine Description:
+
+    Check the queued bulk transfers now instead of waiting for the
+    asynchronous monitor. The callbacks of the finished transfers
+    are called before it returns.
+
+  Arguments:
+
+    This - This EFI_USB2_HC_ASYNC_BULK_PROTOCOL instance.
+
+  Returns:
+
+    EFI_SUCCESS : The queued transfers are checked.
+
+--*/
+{
+  USB2_HC_DEV             *Ehc;
+  EFI_TPL                 OldTpl;
+
+  OldTpl  = gBS->RaiseTPL (EHC_TPL);
+  Ehc     = EHC_FROM_ASYNC_BULK (This);
+
+  EhcMoniteAsyncBulkTransfers (Ehc, OldTpl);
+
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+EhcAsyncBulkCancel (
+  IN  EFI_USB2_HC_ASYNC_BULK_PROTOCOL     *This,
+  IN  VOID                                *Request,
+  OUT UINT8                               *DataToggle   OPTIONAL
+  )
+/*++
+
+  Routine Description:
+
+    Cancel a queued bulk transfer. Its callback isn't called.
+
+  Arguments:
+
+    This       - This EFI_USB2_HC_ASYNC_BULK_PROTOCOL instance.
+    Request    - The handle returned by Submit
+    DataToggle - Return the next data toggle of the endpoint
+
+  Returns:
+
+    EFI_SUCCESS   : The transfer is cancelled.
+    EFI_NOT_FOUND : The transfer has ended or is cancelled.
+
+--*/
+{
+  USB2_HC_DEV             *Ehc;
+  EFI_TPL                 OldTpl;
+  EFI_STATUS              Status;
+
+  OldTpl  = gBS->RaiseTPL (EHC_TPL);
+  Ehc     = EHC_FROM_ASYNC_BULK (This);
+
+  Status  = EhcCancelAsyncBulkTransfer (Ehc, (URB *) Request, DataToggle, OldTpl);
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -1494,9 +1693,14 @@ EhcCreateUsb2Hc (
   Ehc->Usb2Hc.MajorRevision             = 0x2;
   Ehc->Usb2Hc.MinorRevision             = 0x0;
 
+  Ehc->AsyncBulk.Submit                 = EhcAsyncBulkSubmit;
+  Ehc->AsyncBulk.Poll                   = EhcAsyncBulkPoll;
+  Ehc->AsyncBulk.Cancel                 = EhcAsyncBulkCancel;
+
   Ehc->PciIo = PciIo;
 
   InitializeListHead (&Ehc->AsyncIntTransfers);
+  InitializeListHead (&Ehc->AsyncBulkTransfers);
 
   Ehc->HcStructParams = EhcReadCapRegister (Ehc, EHC_HCSPARAMS_OFFSET);
   Ehc->HcCapParams    = EhcReadCapRegister (Ehc, EHC_HCCPARAMS_OFFSET);
@@ -1626,11 +1830,13 @@ EhcDriverBindingStart (
     goto CLOSE_PCIIO;
   }
 
-  Status = gBS->InstallProtocolInterface (
+  Status = gBS->InstallMultipleProtocolInterfaces (
                   &Controller,
                   &gEfiUsb2HcProtocolGuid,
-                  EFI_NATIVE_INTERFACE,
-                  &Ehc->Usb2Hc
+                  &Ehc->Usb2Hc,
+                  &gEfiUsb2HcAsyncBulkProtocolGuid,
+                  &Ehc->AsyncBulk,
+                  NULL
                   );
 
   if (EFI_ERROR (Status)) {
@@ -1695,10 +1901,13 @@ EhcDriverBindingStart (
   return EFI_SUCCESS;
 
 UNINSTALL_USBHC:
-  gBS->UninstallProtocolInterface (
+  gBS->UninstallMultipleProtocolInterfaces (
          Controller,
          &gEfiUsb2HcProtocolGuid,
-         &Ehc->Usb2Hc
+         &Ehc->Usb2Hc,
+         &gEfiUsb2HcAsyncBulkProtocolGuid,
+         &Ehc->AsyncBulk,
+         NULL
          );
 
 FREE_POOL:
@@ -1778,16 +1987,21 @@ EhcDriverBindingStop (
   gBS->SetTimer (Ehc->PollTimer, TimerCancel, EHC_ASYNC_POLL_INTERVAL);
   EhcHaltHC (Ehc, EHC_GENERIC_TIMEOUT);
 
-  Status = gBS->UninstallProtocolInterface (
+  Status = gBS->UninstallMultipleProtocolInterfaces (
                   Controller,
                   &gEfiUsb2HcProtocolGuid,
-                  Usb2Hc
+                  Usb2Hc,
+                  &gEfiUsb2HcAsyncBulkProtocolGuid,
+                  &Ehc->AsyncBulk,
+                  NULL
                   );
 
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
+  EhciDelAllAsyncBulkTransfers (Ehc);
+
   if (Ehc->PollTimer != NULL) {
     gBS->CloseEvent (Ehc->PollTimer);
   }
@@ -29,6 +29,7 @@ Revision History
 #include EFI_PROTOCOL_DEFINITION (DriverBinding)
 #include EFI_PROTOCOL_DEFINITION (PciIo)
 #include EFI_PROTOCOL_DEFINITION (UsbHostController)
+#include EFI_PROTOCOL_DEFINITION (UsbAsyncBulk)
 #include EFI_PROTOCOL_DEFINITION (ComponentName)
 #include EFI_PROTOCOL_DEFINITION (ComponentName2)
 
@@ -97,10 +98,12 @@ enum {
           (EHC_BIT_IS_SET(EhcReadOpReg ((Ehc), (Offset)), (Bit)))
           
 #define EHC_FROM_THIS(a)   CR(a, USB2_HC_DEV, Usb2Hc, USB2_HC_DEV_SIGNATURE)
+#define EHC_FROM_ASYNC_BULK(a) CR(a, USB2_HC_DEV, AsyncBulk, USB2_HC_DEV_SIGNATURE)
 
 typedef struct _USB2_HC_DEV {
   UINTN                     Signature;
   EFI_USB2_HC_PROTOCOL      Usb2Hc;
+  EFI_USB2_HC_ASYNC_BULK_PROTOCOL AsyncBulk;
 
   EFI_PCI_IO_PROTOCOL       *PciIo;
   USBHC_MEM_POOL            *MemPool;
@@ -129,6 +132,13 @@ typedef struct _USB2_HC_DEV {
   // list. It acts as the reclamation header. 
   //
   EHC_QH                   *ReclaimHead;
+
+  //
+  // Bulk transfers queued through EFI_USB2_HC_ASYNC_BULK_PROTOCOL,
+  // in submission order. Only the first transfer to each endpoint
+  // has its QH linked after the ReclaimHead.
+  //
+  EFI_LIST_ENTRY            AsyncBulkTransfers;
   
   //
   // Peroidic (interrupt) transfer schedule data:
@@ -296,10 +296,10 @@ EhcLinkQhToAsync (
 Routine Description:
 
   Link the queue head to the asynchronous schedule list.
-  UEFI only supports one CTRL/BULK transfer at a time
-  due to its interfaces. This simplifies the AsynList
-  management: A reclamation header is always linked to
-  the AsyncListAddr, the only active QH is appended to it.
+  A reclamation header is always linked to the AsyncListAddr,
+  new QH is inserted right after it. Besides the synchronous
+  CTRL/BULK transfer, the queued bulk transfers may have their
+  QHs in the list at the same time, one for each endpoint.
 
 Arguments:
 
@@ -324,7 +324,7 @@ Returns:
   Qh->NextQh              = Head->NextQh;
   Head->NextQh            = Qh;
 
-  Qh->QhHw.HorizonLink    = QH_LINK (Head, EHC_TYPE_QH, FALSE);;
+  Qh->QhHw.HorizonLink    = Head->QhHw.HorizonLink;
   Head->QhHw.HorizonLink  = QH_LINK (Qh, EHC_TYPE_QH, FALSE);
 }
 
@@ -351,22 +351,30 @@ Returns:
 
 --*/
 {
-  EHC_QH                  *Head;
+  EHC_QH                  *Prev;
   EFI_STATUS              Status;
 
-  ASSERT (Ehc->ReclaimHead->NextQh == Qh);
-
   //
-  // Remove the QH from reclamation head, then update the hardware
-  // visiable part: Only need to loopback the ReclaimHead. The Qh
-  // is pointing to ReclaimHead (which is staill in the list).
+  // Find the QH in front of this one. The last QH in the
+  // list is pointing back to the ReclaimHead in hardware.
   //
-  Head                    = Ehc->ReclaimHead;
+  Prev = Ehc->ReclaimHead;
 
-  Head->NextQh            = Qh->NextQh;
+  while ((Prev->NextQh != NULL) && (Prev->NextQh != Qh)) {
+    Prev = Prev->NextQh;
+  }
+
+  ASSERT (Prev->NextQh == Qh);
+
+  //
+  // Remove the QH from the list, then update the hardware visiable
+  // part: the previous QH inherits the horizontal link of the Qh.
+  // The Qh keeps its own link in case EHCI is still working on it.
+  //
+  Prev->NextQh            = Qh->NextQh;
   Qh->NextQh              = NULL;
 
-  Head->QhHw.HorizonLink  = QH_LINK (Head, EHC_TYPE_QH, FALSE);
+  Prev->QhHw.HorizonLink  = Qh->QhHw.HorizonLink;
 
   //
   // Set and wait the door bell to synchronize with the hardware
@@ -836,6 +844,388 @@ Returns:
   }
 }
 
+STATIC
+BOOLEAN
+EhcIsSameEndpoint (
+  IN USB_ENDPOINT         *Ep1,
+  IN USB_ENDPOINT         *Ep2
+  )
+/*++
+
+Routine Description:
+
+  Check whether two endpoints are the same device endpoint
+
+Arguments:
+
+  Ep1 - The first endpoint
+  Ep2 - The second endpoint
+
+Returns:
+
+  TRUE if they are the same, otherwise FALSE
+
+--*/
+{
+  return (BOOLEAN) ((Ep1->DevAddr == Ep2->DevAddr) &&
+                    (Ep1->EpAddr == Ep2->EpAddr) &&
+                    (Ep1->Direction == Ep2->Direction));
+}
+
+VOID
+EhcLinkAsyncBulkTransfer (
+  IN USB2_HC_DEV          *Ehc,
+  IN URB                  *Urb
+  )
+/*++
+
+Routine Description:
+
+  Queue a bulk transfer. Its QH is linked to the asynchronous
+  schedule list at once if no other transfer is queued to the
+  same endpoint. Otherwise it waits for the transfers ahead of
+  it to finish, see EhcRetireAsyncBulkTransfer.
+
+Arguments:
+
+  Ehc - The EHCI device
+  Urb - The URB of the bulk transfer
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_LIST_ENTRY          *Entry;
+  URB                     *Queued;
+
+  Urb->Linked = TRUE;
+
+  EFI_LIST_FOR_EACH (Entry, &Ehc->AsyncBulkTransfers) {
+    Queued = EFI_LIST_CONTAINER (Entry, URB, UrbList);
+
+    if (EhcIsSameEndpoint (&Queued->Ep, &Urb->Ep)) {
+      Urb->Linked = FALSE;
+      break;
+    }
+  }
+
+  InsertTailList (&Ehc->AsyncBulkTransfers, &Urb->UrbList);
+
+  if (Urb->Linked) {
+    EhcLinkQhToAsync (Ehc, Urb->Qh);
+  }
+}
+
+STATIC
+VOID
+EhcRetireAsyncBulkTransfer (
+  IN USB2_HC_DEV          *Ehc,
+  IN URB                  *Urb,
+  IN EFI_LIST_ENTRY       *Done
+  )
+/*++
+
+Routine Description:
+
+  Remove a queued bulk transfer from the schedule. If it finished
+  OK, the next transfer queued to the endpoint is started with the
+  data toggle it left. Otherwise, the transfers queued after it to
+  the endpoint are aborted and moved to the Done list.
+
+Arguments:
+
+  Ehc  - The EHCI device
+  Urb  - The URB to remove, its result has been checked
+  Done - The list to put the aborted URBs on
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_LIST_ENTRY          *Entry;
+  EFI_LIST_ENTRY          *Next;
+  URB                     *Queued;
+  BOOLEAN                 Abort;
+
+  if (Urb->Linked) {
+    EhcUnlinkQhFromAsync (Ehc, Urb->Qh);
+    Urb->Linked = FALSE;
+  }
+
+  Abort = (BOOLEAN) (Urb->Result != EFI_USB_NOERROR);
+  Entry = Urb->UrbList.ForwardLink;
+
+  RemoveEntryList (&Urb->UrbList);
+
+  while (Entry != &Ehc->AsyncBulkTransfers) {
+    Next    = Entry->ForwardLink;
+    Queued  = EFI_LIST_CONTAINER (Entry, URB, UrbList);
+
+    if (EhcIsSameEndpoint (&Queued->Ep, &Urb->Ep)) {
+      if (!Abort) {
+        Queued->Qh->QhHw.DataToggle = Urb->DataToggle;
+        Queued->Linked              = TRUE;
+
+        EhcLinkQhToAsync (Ehc, Queued->Qh);
+        break;
+      }
+
+      Queued->Result      = EFI_USB_ERR_NOTEXECUTE;
+      Queued->Completed   = 0;
+      Queued->DataToggle  = Urb->DataToggle;
+
+      RemoveEntryList (Entry);
+      InsertTailList (Done, Entry);
+    }
+
+    Entry = Next;
+  }
+}
+
+STATIC
+VOID
+EhcCompleteAsyncBulkTransfers (
+  IN USB2_HC_DEV          *Ehc,
+  IN EFI_LIST_ENTRY       *Done,
+  IN EFI_TPL              OldTpl
+  )
+/*++
+
+Routine Description:
+
+  Release the finished bulk transfers and call their callbacks.
+  The URB is freed before the callback so the data are in the
+  user's buffer when it is called.
+
+Arguments:
+
+  Ehc    - The EHCI device
+  Done   - The list of finished URBs
+  OldTpl - The TPL to call the callbacks at
+
+Returns:
+
+  None
+
+--*/
+{
+  URB                         *Urb;
+  EFI_USB_ASYNC_BULK_CALLBACK Callback;
+  VOID                        *Context;
+  UINTN                       Completed;
+  UINT8                       DataToggle;
+  UINT32                      Result;
+
+  if (IsListEmpty (Done)) {
+    return ;
+  }
+
+  Ehc->PciIo->Flush (Ehc->PciIo);
+
+  while (!IsListEmpty (Done)) {
+    Urb         = EFI_LIST_CONTAINER (Done->ForwardLink, URB, UrbList);
+    Callback    = Urb->BulkCallback;
+    Context     = Urb->Context;
+    Completed   = Urb->Completed;
+    DataToggle  = Urb->DataToggle;
+    Result      = Urb->Result;
+
+    RemoveEntryList (&Urb->UrbList);
+    EhcFreeUrb (Ehc, Urb);
+
+    if (Callback != NULL) {
+      gBS->RestoreTPL (OldTpl);
+      Callback (Context, Completed, DataToggle, Result);
+      gBS->RaiseTPL (EHC_TPL);
+    }
+  }
+}
+
+VOID
+EhcMoniteAsyncBulkTransfers (
+  IN USB2_HC_DEV          *Ehc,
+  IN EFI_TPL              OldTpl
+  )
+/*++
+
+Routine Description:
+
+  Check the queued bulk transfers, start the ones waiting for
+  a finished transfer and call the callbacks of the finished
+  ones. It is called at EHC_TPL.
+
+Arguments:
+
+  Ehc    - The EHCI device
+  OldTpl - The TPL to call the callbacks at
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_LIST_ENTRY          Done;
+  EFI_LIST_ENTRY          *Entry;
+  URB                     *Urb;
+  BOOLEAN                 Finished;
+
+  InitializeListHead (&Done);
+
+  //
+  // Retiring a transfer may start or abort others in the list,
+  // so scan again from the head after each finished transfer.
+  // There are only a few transfers queued at the same time.
+  //
+  do {
+    Finished = FALSE;
+    Urb      = NULL;
+
+    EFI_LIST_FOR_EACH (Entry, &Ehc->AsyncBulkTransfers) {
+      Urb = EFI_LIST_CONTAINER (Entry, URB, UrbList);
+
+      if (Urb->Linked && EhcCheckUrbResult (Ehc, Urb)) {
+        Finished = TRUE;
+        break;
+      }
+    }
+
+    if (Finished) {
+      EhcRetireAsyncBulkTransfer (Ehc, Urb, &Done);
+      InsertTailList (&Done, &Urb->UrbList);
+    }
+  } while (Finished);
+
+  EhcCompleteAsyncBulkTransfers (Ehc, &Done, OldTpl);
+}
+
+EFI_STATUS
+EhcCancelAsyncBulkTransfer (
+  IN  USB2_HC_DEV         *Ehc,
+  IN  URB                 *Request,
+  OUT UINT8               *DataToggle,
+  IN  EFI_TPL             OldTpl
+  )
+/*++
+
+Routine Description:
+
+  Cancel a queued bulk transfer. Its callback isn't called.
+  The transfers queued after it to the same endpoint are
+  aborted unless it had already finished OK.
+
+Arguments:
+
+  Ehc        - The EHCI device
+  Request    - The URB of the transfer to cancel
+  DataToggle - Return the next data toggle of the endpoint
+  OldTpl     - The TPL to call the callbacks of aborted transfers at
+
+Returns:
+
+  EFI_SUCCESS   - The transfer is cancelled
+  EFI_NOT_FOUND - The transfer isn't queued
+
+--*/
+{
+  EFI_LIST_ENTRY          Done;
+  EFI_LIST_ENTRY          *Entry;
+  URB                     *Urb;
+
+  Urb = NULL;
+
+  EFI_LIST_FOR_EACH (Entry, &Ehc->AsyncBulkTransfers) {
+    Urb = EFI_LIST_CONTAINER (Entry, URB, UrbList);
+
+    if (Urb == Request) {
+      break;
+    }
+  }
+
+  if (Entry == &Ehc->AsyncBulkTransfers) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (Urb->Linked) {
+    EhcCheckUrbResult (Ehc, Urb);
+  } else {
+    Urb->Result     = EFI_USB_ERR_NOTEXECUTE;
+    Urb->DataToggle = Urb->Ep.Toggle;
+  }
+
+  if (DataToggle != NULL) {
+    *DataToggle = Urb->DataToggle;
+  }
+
+  InitializeListHead (&Done);
+  EhcRetireAsyncBulkTransfer (Ehc, Urb, &Done);
+
+  Ehc->PciIo->Flush (Ehc->PciIo);
+  EhcFreeUrb (Ehc, Urb);
+
+  EhcCompleteAsyncBulkTransfers (Ehc, &Done, OldTpl);
+  return EFI_SUCCESS;
+}
+
+VOID
+EhciDelAllAsyncBulkTransfers (
+  IN USB2_HC_DEV          *Ehc
+  )
+/*++
+
+Routine Description:
+
+  Remove all the queued bulk transfers when the schedule is
+  about to be freed. Their callbacks are called with
+  EFI_USB_ERR_SYSTEM at the current TPL.
+
+Arguments:
+
+  Ehc - The EHCI device
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_LIST_ENTRY          Done;
+  EFI_LIST_ENTRY          *Entry;
+  EFI_LIST_ENTRY          *Next;
+  URB                     *Urb;
+  EFI_TPL                 OldTpl;
+
+  InitializeListHead (&Done);
+
+  //
+  // EHCI is halted, no need to unlink the QHs one by one with
+  // the door bell. The whole asynchronous list is freed later.
+  //
+  EFI_LIST_FOR_EACH_SAFE (Entry, Next, &Ehc->AsyncBulkTransfers) {
+    Urb             = EFI_LIST_CONTAINER (Entry, URB, UrbList);
+    Urb->Linked     = FALSE;
+    Urb->Result     = EFI_USB_ERR_SYSTEM;
+    Urb->Completed  = 0;
+    Urb->DataToggle = Urb->Ep.Toggle;
+
+    RemoveEntryList (Entry);
+    InsertTailList (&Done, Entry);
+  }
+
+  if (Ehc->ReclaimHead != NULL) {
+    Ehc->ReclaimHead->NextQh          = NULL;
+    Ehc->ReclaimHead->QhHw.HorizonLink = QH_LINK (Ehc->ReclaimHead, EHC_TYPE_QH, FALSE);
+  }
+
+  OldTpl = gBS->RaiseTPL (EHC_TPL);
+  EhcCompleteAsyncBulkTransfers (Ehc, &Done, OldTpl);
+  gBS->RestoreTPL (OldTpl);
+}
+
 STATIC
 EFI_STATUS
 EhcFlushAsyncIntMap (
@@ -1015,6 +1405,11 @@ Returns:
   OldTpl  = gBS->RaiseTPL (EHC_TPL);
   Ehc     = (USB2_HC_DEV *) Context;
 
+  //
+  // Complete the queued bulk transfers nobody is polling for
+  //
+  EhcMoniteAsyncBulkTransfers (Ehc, OldTpl);
+
   EFI_LIST_FOR_EACH_SAFE (Entry, Next, &Ehc->AsyncIntTransfers) {
     Urb = EFI_LIST_CONTAINER (Entry, URB, UrbList);
 
@@ -246,6 +246,110 @@ Returns:
 --*/
 ;
 
+VOID
+EhcLinkAsyncBulkTransfer (
+  IN USB2_HC_DEV          *Ehc,
+  IN URB                  *Urb
+  )
+/*++
+
+Routine Description:
+
+  Queue a bulk transfer. Its QH is linked to the asynchronous
+  schedule list at once if no other transfer is queued to the
+  same endpoint. Otherwise it waits for the transfers ahead of
+  it to finish, see EhcRetireAsyncBulkTransfer.
+
+Arguments:
+
+  Ehc - The EHCI device
+  Urb - The URB of the bulk transfer
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+EhcMoniteAsyncBulkTransfers (
+  IN USB2_HC_DEV          *Ehc,
+  IN EFI_TPL              OldTpl
+  )
+/*++
+
+Routine Description:
+
+  Check the queued bulk transfers, start the ones waiting for
+  a finished transfer and call the callbacks of the finished
+  ones. It is called at EHC_TPL.
+
+Arguments:
+
+  Ehc    - The EHCI device
+  OldTpl - The TPL to call the callbacks at
+
+Returns:
+
+  None
+
+--*/
+;
+
+EFI_STATUS
+EhcCancelAsyncBulkTransfer (
+  IN  USB2_HC_DEV         *Ehc,
+  IN  URB                 *Request,
+  OUT UINT8               *DataToggle,
+  IN  EFI_TPL             OldTpl
+  )
+/*++
+
+Routine Description:
+
+  Cancel a queued bulk transfer. Its callback isn't called.
+  The transfers queued after it to the same endpoint are
+  aborted unless it had already finished OK.
+
+Arguments:
+
+  Ehc        - The EHCI device
+  Request    - The URB of the transfer to cancel
+  DataToggle - Return the next data toggle of the endpoint
+  OldTpl     - The TPL to call the callbacks of aborted transfers at
+
+Returns:
+
+  EFI_SUCCESS   - The transfer is cancelled
+  EFI_NOT_FOUND - The transfer isn't queued
+
+--*/
+;
+
+VOID
+EhciDelAllAsyncBulkTransfers (
+  IN USB2_HC_DEV          *Ehc
+  )
+/*++
+
+Routine Description:
+
+  Remove all the queued bulk transfers when the schedule is
+  about to be freed. Their callbacks are called with
+  EFI_USB_ERR_SYSTEM at the current TPL.
+
+Arguments:
+
+  Ehc - The EHCI device
+
+Returns:
+
+  None
+
+--*/
+;
+
 
 VOID
 EFIAPI
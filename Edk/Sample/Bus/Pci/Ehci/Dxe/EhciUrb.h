@@ -230,6 +230,8 @@ typedef struct _URB {
   VOID                            *DataMap;
   EFI_ASYNC_USB_TRANSFER_CALLBACK Callback; 
   VOID                            *Context;
+  EFI_USB_ASYNC_BULK_CALLBACK     BulkCallback; // Queued bulk transfer only
+  BOOLEAN                         Linked;       // Queued bulk transfer's QH is in the async list
 
   //
   // Schedule data
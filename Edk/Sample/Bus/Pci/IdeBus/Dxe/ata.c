@@ -1285,6 +1285,7 @@ AtaBlkIoReadBlocks (
   EFI_BLOCK_IO_MEDIA  *Media;
   UINTN               BlockSize;
   UINTN               NumberOfBlocks;
+  IDE_READ_BLOCKS     ReadBlocks;
   EFI_STATUS          Status;
 
   if (Buffer == NULL) {
@@ -1329,27 +1330,28 @@ AtaBlkIoReadBlocks (
     return EFI_INVALID_PARAMETER;
   }
 
-  Status = EFI_SUCCESS;
   if (IdeBlkIoDevice->Type == Ide48bitAddressingHardDisk) {
     //
     // For ATA/ATAPI-6 device(capcity > 120GB), use ATA-6 read block mechanism
     //
     if (IdeBlkIoDevice->UdmaMode.Valid) {
-      Status = AtaUdmaReadExt (IdeBlkIoDevice, Buffer, LBA, NumberOfBlocks);
+      ReadBlocks = AtaUdmaReadExt;
     } else {
-      Status = AtaReadSectorsExt (IdeBlkIoDevice, Buffer, LBA, NumberOfBlocks);
+      ReadBlocks = AtaReadSectorsExt;
     }
   } else {
     //
     // For ATA-3 compatible device, use ATA-3 read block mechanism
     //
     if (IdeBlkIoDevice->UdmaMode.Valid) {
-      Status = AtaUdmaRead (IdeBlkIoDevice, Buffer, LBA, NumberOfBlocks);
+      ReadBlocks = AtaUdmaRead;
     } else {
-      Status = AtaReadSectors (IdeBlkIoDevice, Buffer, LBA, NumberOfBlocks);
+      ReadBlocks = AtaReadSectors;
     }
   }
 
+  Status = IdeReadAheadReadBlocks (IdeBlkIoDevice, ReadBlocks, Buffer, LBA, NumberOfBlocks);
+
   if (EFI_ERROR (Status)) {
     AtaSoftReset (IdeBlkIoDevice);
     return EFI_DEVICE_ERROR;
@@ -2767,6 +2769,140 @@ AtaUdmaWrite (
   return DoAtaUdma (IdeDev, DataBuffer, StartLba, NumberOfBlocks, AtaUdmaWriteOp);
 }
 
+STATIC
+IDE_DMA_PRD *
+AtaUdmaPlacePrdTable (
+  IN  UINT8               *Region,
+  IN  UINTN               PrdTableSize
+  )
+/*++
+  Name:
+  
+        AtaUdmaPlacePrdTable
+
+  Purpose: 
+  
+        Place a PRD table in a region of twice its size so that the
+        table doesn't cross a 64K boundary.
+
+  Parameters:
+  
+        UINT8     IN    *Region
+          The start of the region, below 4G and 4 bytes aligned.
+
+        UINTN     IN    PrdTableSize
+          The size of the PRD table in bytes.
+
+  Returns:  
+
+        The start of the PRD table.
+
+--*/
+{
+  if (((UINTN) Region & 0x0FFFF) > (((UINTN) Region + PrdTableSize - 1) & 0x0FFFF)) {
+    return (IDE_DMA_PRD *) ((UINTN) (Region + 0x10000) & 0xFFFF0000);
+  }
+
+  return (IDE_DMA_PRD *) Region;
+}
+
+STATIC
+EFI_STATUS
+AtaUdmaBuildPrdTable (
+  IN  IDE_BLK_IO_DEV                 *IdeDev,
+  IN  EFI_PCI_IO_PROTOCOL_OPERATION  PciIoProtocolOp,
+  IN  VOID                           *DataBuffer,
+  IN  UINTN                          ByteCount,
+  IN  IDE_DMA_PRD                    *PrdTable,
+  OUT VOID                           **Map
+  )
+/*++
+  Name:
+  
+        AtaUdmaBuildPrdTable
+
+  Purpose: 
+  
+        Map the data buffer of one UDMA command for bus master access
+        and describe it in a PRD table. No region of the table crosses
+        a 64K boundary.
+
+  Parameters:
+  
+        IDE_BLK_IO_DEV  IN    *IdeDev
+          pointer pointing to IDE_BLK_IO_DEV data structure, used
+          to record all the information of the IDE device.
+
+        EFI_PCI_IO_PROTOCOL_OPERATION   IN   PciIoProtocolOp
+          The bus master operation to map the buffer for.
+
+        VOID      IN    *DataBuffer
+          The data buffer of the command.
+
+        UINTN     IN    ByteCount
+          The number of bytes the command transfers.
+
+        IDE_DMA_PRD   IN    *PrdTable
+          The PRD table to fill.
+
+        VOID      OUT   **Map
+          The mapping to unmap once the command is done.
+
+  Returns:  
+
+        EFI_SUCCESS
+          The buffer is mapped and the PRD table is built.
+
+        EFI_OUT_OF_RESOURCES
+          The buffer can't be mapped.
+
+--*/
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  DeviceAddress;
+  UINT8                 *PrdBuffer;
+  UINTN                 ByteAvailable;
+
+  Status = IdeDev->PciIo->Map (
+                     IdeDev->PciIo, 
+                     PciIoProtocolOp, 
+                     DataBuffer, 
+                     &ByteCount, 
+                     &DeviceAddress,
+                     Map
+                     );
+  if (EFI_ERROR (Status)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  PrdBuffer = (UINT8 *) ((UINTN) DeviceAddress);
+  while (TRUE) {
+
+    ByteAvailable = 0x10000 - ((UINTN) PrdBuffer & 0xFFFF);
+
+    if (ByteCount <= ByteAvailable) {
+      PrdTable->RegionBaseAddr = (UINT32) ((UINTN) PrdBuffer);
+      PrdTable->ByteCount      = (UINT16) ByteCount;
+      PrdTable->EndOfTable     = 0x8000;
+      break;
+    }
+
+    //
+    // The table is reused, so clear the end mark a previous,
+    // shorter command may have left here.
+    //
+    PrdTable->RegionBaseAddr = (UINT32) ((UINTN) PrdBuffer);
+    PrdTable->ByteCount      = (UINT16) ByteAvailable;
+    PrdTable->EndOfTable     = 0;
+
+    ByteCount -= ByteAvailable;
+    PrdBuffer += ByteAvailable;
+    PrdTable++;
+  }
+
+  return EFI_SUCCESS;
+}
+
 EFI_STATUS
 DoAtaUdma (
   IN  IDE_BLK_IO_DEV      *IdeDev,
@@ -2784,6 +2920,11 @@ DoAtaUdma (
   
         Perform an ATA Udma operation (Read, ReadExt, Write, WriteExt)
 
+        The transfer is split into commands of at most MaxDmaCommandSectors
+        sectors. Two PRD tables are used in turn: while the bus master runs
+        one command, the buffer of the next one is mapped and its PRD table
+        is built, so the next command is issued as soon as this one is done.
+
   Parameters:
   
         IDE_BLK_IO_DEV  IN    *IdeDev
@@ -2810,26 +2951,26 @@ DoAtaUdma (
 
 --*/
 {
-  IDE_DMA_PRD                   *PrdAddr;
-  IDE_DMA_PRD                   *UsedPrdAddr;
-  IDE_DMA_PRD                   *TempPrdAddr;
+  IDE_DMA_PRD                   *PrdTable[2];
+  VOID                          *Map[2];
+  UINTN                         BlockCount[2];
+  UINTN                         Current;
+  UINTN                         Next;
+  BOOLEAN                       NextPlanned;
+  BOOLEAN                       NextReady;
   UINT8                         RegisterValue;
   UINT8                         Device;
   UINT64                        IoPortForBmic;
   UINT64                        IoPortForBmis;
   UINT64                        IoPortForBmid;
   EFI_STATUS                    Status;
-  UINTN                         PrdTableNum;
-  UINTN                         ByteCount;
-  UINTN                         ByteAvailable;
-  UINT8                         *PrdBuffer;
+  UINTN                         PrdTableSize;
+  UINTN                         BlockSize;
   UINTN                         RemainBlockNum;
   UINT8                         DeviceControl;
   UINT32                        Count;
   UINTN                         PageCount;
-  VOID                          *Map;
   EFI_PHYSICAL_ADDRESS          MemPage;
-  EFI_PHYSICAL_ADDRESS          DeviceAddress;
   UINTN                         MaxDmaCommandSectors;
   EFI_PCI_IO_PROTOCOL_OPERATION PciIoProtocolOp;
   UINT8                         AtaCommand;
@@ -2909,95 +3050,73 @@ DoAtaUdma (
                       &RegisterValue
                       );
 
-  Status = EFI_SUCCESS;
+  BlockSize = IdeDev->BlkIo.Media->BlockSize;
 
-  RemainBlockNum = NumberOfBlocks;
-  while (RemainBlockNum > 0) {
+  //
+  // Calculate the number of PRD entries of the largest command, making
+  // sure no memory region crosses a 64K boundary. Both PRD tables are
+  // allocated once for the whole transfer, each in a region twice its
+  // size so that it can be placed in one 64K page.
+  //
+  if (NumberOfBlocks >= MaxDmaCommandSectors) {
+    PrdTableSize = MaxDmaCommandSectors * BlockSize;
+  } else {
+    PrdTableSize = NumberOfBlocks * BlockSize;
+  }
 
-    if (RemainBlockNum >= MaxDmaCommandSectors) {
-      //
-      //  SectorCount is used to record the number of sectors to be read
-      //  Max 256 sectors can be transfered at a time.
-      //
-      NumberOfBlocks = MaxDmaCommandSectors;
-      RemainBlockNum -= MaxDmaCommandSectors;
-    } else {
-      NumberOfBlocks  = (UINT16) RemainBlockNum;
-      RemainBlockNum  = 0;
-    }
+  PrdTableSize = (((PrdTableSize >> 16) + 1) + 1) * sizeof (IDE_DMA_PRD);
 
-    //
-    // Calculate the number of PRD table to make sure the memory region
-    // not cross 64K boundary
-    //
-    ByteCount   = NumberOfBlocks * IdeDev->BlkIo.Media->BlockSize;
-    PrdTableNum = ((ByteCount >> 16) + 1) + 1;
+  MemPage = 0xFFFFFFFF;
+  PageCount = EFI_SIZE_TO_PAGES (2 * 2 * PrdTableSize);
+  Status = gBS->AllocatePages (
+                  AllocateMaxAddress,
+                  EfiBootServicesData,
+                  PageCount,
+                  &MemPage
+                  );
+  if (EFI_ERROR (Status)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  EfiZeroMem ((VOID *) ((UINTN) MemPage), EFI_PAGES_TO_SIZE (PageCount));   
 
-    //
-    // Build PRD table
-    //
-    MemPage = 0xFFFFFFFF;
-    PageCount = EFI_SIZE_TO_PAGES (2 * PrdTableNum * sizeof (IDE_DMA_PRD));
-    Status = gBS->AllocatePages (
-                    AllocateMaxAddress,
-                    EfiBootServicesData,
-                    PageCount,
-                    &MemPage
-                    );
-    if (EFI_ERROR (Status)) {
-      return EFI_OUT_OF_RESOURCES;
-    }
-    EfiZeroMem ((VOID *) ((UINTN) MemPage), EFI_PAGES_TO_SIZE (PageCount));   
-    
-    PrdAddr = (IDE_DMA_PRD *) ((UINTN) MemPage);
-    //
-    // To make sure PRD is allocated in one 64K page
-    //
-    if (((UINTN) PrdAddr & 0x0FFFF) > (((UINTN) PrdAddr + PrdTableNum * sizeof (IDE_DMA_PRD) - 1) & 0x0FFFF)) {
-      UsedPrdAddr = (IDE_DMA_PRD *) ((UINTN) ((UINT8 *) PrdAddr + 0x10000) & 0xFFFF0000);
-    } else {
-      if ((UINTN) PrdAddr & 0x03) {
-        UsedPrdAddr = (IDE_DMA_PRD *) ((UINTN) ((UINT8 *) PrdAddr + 0x04) & 0xFFFFFFFC);
-      } else {
-        UsedPrdAddr = PrdAddr;
-      }
-    }
+  PrdTable[0] = AtaUdmaPlacePrdTable ((UINT8 *) ((UINTN) MemPage), PrdTableSize);
+  PrdTable[1] = AtaUdmaPlacePrdTable ((UINT8 *) ((UINTN) MemPage) + 2 * PrdTableSize, PrdTableSize);
 
-    //
-    // Build the PRD table
-    //
-    Status = IdeDev->PciIo->Map (
-                       IdeDev->PciIo, 
-                       PciIoProtocolOp, 
-                       DataBuffer, 
-                       &ByteCount, 
-                       &DeviceAddress,
-                       &Map
-                       );
-    if (EFI_ERROR (Status)) {
-      gBS->FreePages (MemPage, PageCount);
-      return EFI_OUT_OF_RESOURCES;
-    }    
-    PrdBuffer   = (UINT8 *) ((UINTN) DeviceAddress);
-    TempPrdAddr = UsedPrdAddr;
-    while (TRUE) {
+  //
+  // Build the PRD table of the first command
+  //
+  RemainBlockNum  = NumberOfBlocks;
+  Current         = 0;
 
-      ByteAvailable = 0x10000 - ((UINTN) PrdBuffer & 0xFFFF);
+  if (RemainBlockNum >= MaxDmaCommandSectors) {
+    BlockCount[Current] = MaxDmaCommandSectors;
+  } else {
+    BlockCount[Current] = RemainBlockNum;
+  }
 
-      if (ByteCount <= ByteAvailable) {
-        TempPrdAddr->RegionBaseAddr = (UINT32) ((UINTN) PrdBuffer);
-        TempPrdAddr->ByteCount      = (UINT16) ByteCount;
-        TempPrdAddr->EndOfTable     = 0x8000;
-        break;
-      }
+  RemainBlockNum -= BlockCount[Current];
 
-      TempPrdAddr->RegionBaseAddr = (UINT32) ((UINTN) PrdBuffer);
-      TempPrdAddr->ByteCount      = (UINT16) ByteAvailable;
+  Status = AtaUdmaBuildPrdTable (
+             IdeDev,
+             PciIoProtocolOp,
+             DataBuffer,
+             BlockCount[Current] * BlockSize,
+             PrdTable[Current],
+             &Map[Current]
+             );
+  if (EFI_ERROR (Status)) {
+    gBS->FreePages (MemPage, PageCount);
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-      ByteCount -= ByteAvailable;
-      PrdBuffer += ByteAvailable;
-      TempPrdAddr++;
-    }
+  while (TRUE) {
+    //
+    //  NumberOfBlocks is used to record the number of sectors of this command
+    //
+    NumberOfBlocks  = BlockCount[Current];
+    Next            = 1 - Current;
+    NextPlanned     = (BOOLEAN) (RemainBlockNum > 0);
+    NextReady       = FALSE;
 
     //
     // Set the base address to BMID register
@@ -3008,7 +3127,7 @@ DoAtaUdma (
                         EFI_PCI_IO_PASS_THROUGH_BAR,
                         IoPortForBmid,
                         1,
-                        &UsedPrdAddr
+                        &PrdTable[Current]
                         );
 
     //
@@ -3059,9 +3178,9 @@ DoAtaUdma (
     }
 
     if (EFI_ERROR (Status)) {
-      gBS->FreePages (MemPage, PageCount);
-      IdeDev->PciIo->Unmap (IdeDev->PciIo, Map);
-      return EFI_DEVICE_ERROR;
+      IdeDev->PciIo->Unmap (IdeDev->PciIo, Map[Current]);
+      Status = EFI_DEVICE_ERROR;
+      break;
     }
 
     //
@@ -3087,14 +3206,40 @@ DoAtaUdma (
                         &RegisterValue
                         );
 
+    //
+    // While the bus master moves the data of this command, map the
+    // buffer of the next one and build its PRD table in the other table.
+    //
+    if (NextPlanned) {
+      if (RemainBlockNum >= MaxDmaCommandSectors) {
+        BlockCount[Next] = MaxDmaCommandSectors;
+      } else {
+        BlockCount[Next] = RemainBlockNum;
+      }
+
+      RemainBlockNum -= BlockCount[Next];
+
+      NextReady = (BOOLEAN) !EFI_ERROR (
+                               AtaUdmaBuildPrdTable (
+                                 IdeDev,
+                                 PciIoProtocolOp,
+                                 (UINT8 *) DataBuffer + NumberOfBlocks * BlockSize,
+                                 BlockCount[Next] * BlockSize,
+                                 PrdTable[Next],
+                                 &Map[Next]
+                                 )
+                               );
+    }
+
     //
     // Check the INTERRUPT and ERROR bit of BMIS
     // Max transfer number of sectors for one command is 65536(32Mbyte),
     // it will cost 1 second to transfer these data in UDMA mode 2(33.3MBps).
-    // So set the variable Count to 2000, for about 2 second timeout time.
+    // So poll every 100us for about 2 second timeout time. The short
+    // interval lets the next command start soon after this one is done.
     //
     Status = EFI_SUCCESS;
-    Count  = 2000;
+    Count  = 20000;
     while (TRUE) {
 
       IdeDev->PciIo->Io.Read (
@@ -3113,12 +3258,11 @@ DoAtaUdma (
         break;
       }
 
-      gBS->Stall (1000);
+      gBS->Stall (100);
       Count --;
     }
 
-    gBS->FreePages (MemPage, PageCount);
-    IdeDev->PciIo->Unmap (IdeDev->PciIo, Map);
+    IdeDev->PciIo->Unmap (IdeDev->PciIo, Map[Current]);
     //
     // Read BMIS register and clear ERROR and INTR bit
     //
@@ -3168,12 +3312,28 @@ DoAtaUdma (
                         &RegisterValue
                         );
     if (EFI_ERROR (Status)) {
+      if (NextReady) {
+        IdeDev->PciIo->Unmap (IdeDev->PciIo, Map[Next]);
+      }
       break;
     }
-    DataBuffer = (UINT8 *) DataBuffer + NumberOfBlocks * IdeDev->BlkIo.Media->BlockSize;
-    StartLba += NumberOfBlocks;
+
+    if (!NextPlanned) {
+      break;
+    }
+
+    if (!NextReady) {
+      Status = EFI_OUT_OF_RESOURCES;
+      break;
+    }
+
+    DataBuffer  = (UINT8 *) DataBuffer + NumberOfBlocks * BlockSize;
+    StartLba   += NumberOfBlocks;
+    Current     = Next;
   }
 
+  gBS->FreePages (MemPage, PageCount);
+
   //
   // Disable interrupt of Select device
   //
@@ -1934,6 +1934,7 @@ AtapiBlkIoReadBlocks (
       IdeBlkIoDevice->Cache = NULL;
     }
 
+    IdeInvalidateReadAhead (IdeBlkIoDevice);
     return Status;
   }
   //
@@ -1950,6 +1951,8 @@ AtapiBlkIoReadBlocks (
       gBS->FreePool (IdeBlkIoDevice->Cache);
       IdeBlkIoDevice->Cache = NULL;
     }
+
+    IdeInvalidateReadAhead (IdeBlkIoDevice);
     return EFI_NO_MEDIA;
 
   }
@@ -1960,6 +1963,8 @@ AtapiBlkIoReadBlocks (
       gBS->FreePool (IdeBlkIoDevice->Cache);
       IdeBlkIoDevice->Cache = NULL;
     }
+
+    IdeInvalidateReadAhead (IdeBlkIoDevice);
     return EFI_MEDIA_CHANGED;
   }
 
@@ -1981,9 +1986,10 @@ AtapiBlkIoReadBlocks (
 
   //
   // if all the parameters are valid, then perform read sectors command
-  // to transfer data from device to host.
+  // to transfer data from device to host. Optical media is mostly read
+  // a few blocks at a time in order, so go through the read-ahead window.
   //
-  Status = AtapiReadSectors (IdeBlkIoDevice, Buffer, LBA, NumberOfBlocks);
+  Status = IdeReadAheadReadBlocks (IdeBlkIoDevice, AtapiReadSectors, Buffer, LBA, NumberOfBlocks);
   if (EFI_ERROR (Status)) {
     return EFI_DEVICE_ERROR;
   }
@@ -1601,6 +1601,12 @@ Returns:
     IdeBlkIoDevice->Cache = NULL;
   }
 
+  if (IdeBlkIoDevice->ReadAhead != NULL) {
+    gBS->FreePool (IdeBlkIoDevice->ReadAhead);
+    IdeBlkIoDevice->ReadAhead       = NULL;
+    IdeBlkIoDevice->ReadAheadBlocks = 0;
+  }
+
   if (IdeBlkIoDevice->pIdData != NULL) {
     gBS->FreePool (IdeBlkIoDevice->pIdData);
     IdeBlkIoDevice->pIdData = NULL;
@@ -2107,3 +2113,141 @@ Returns:
 
   return ;
 }
+
+EFI_STATUS
+IdeReadAheadReadBlocks (
+  IN  IDE_BLK_IO_DEV   *IdeDev,
+  IN  IDE_READ_BLOCKS  ReadBlocks,
+  IN  VOID             *Buffer,
+  IN  EFI_LBA          Lba,
+  IN  UINTN            NumberOfBlocks
+  )
+/*++
+
+Routine Description:
+
+  Read blocks through the device's read-ahead window. A small read that
+  continues the previous one fills the window with the blocks following
+  it, and later reads inside the window are copied from memory. If the
+  window cannot be filled, only the caller's blocks are read, and no
+  window overlapping the failed one is filled until the read-ahead state
+  is invalidated.
+
+Arguments:
+
+  IdeDev          - The IDE device to read from
+  ReadBlocks      - The routine that reads from the device
+  Buffer          - The buffer to read into
+  Lba             - The first block to read
+  NumberOfBlocks  - Number of blocks to read
+
+Returns:
+
+  The status of ReadBlocks, or EFI_SUCCESS if the blocks are in the window
+
+--*/
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  UINTN               BlockSize;
+  UINTN               WindowBlocks;
+  EFI_LBA             ReadLba;
+  EFI_STATUS          Status;
+
+  Media         = IdeDev->BlkIo.Media;
+  BlockSize     = Media->BlockSize;
+  WindowBlocks  = IDE_READ_AHEAD_SIZE / BlockSize;
+  ReadLba       = IdeDev->NextReadLba;
+
+  IdeDev->NextReadLba = Lba + NumberOfBlocks;
+
+  //
+  // Copy the blocks if all of them are in the window
+  //
+  if ((IdeDev->ReadAheadBlocks != 0) &&
+      (Lba >= IdeDev->ReadAheadLba) &&
+      (Lba + NumberOfBlocks <= IdeDev->ReadAheadLba + IdeDev->ReadAheadBlocks)) {
+    EfiCopyMem (
+      Buffer,
+      IdeDev->ReadAhead + (UINTN) (Lba - IdeDev->ReadAheadLba) * BlockSize,
+      NumberOfBlocks * BlockSize
+      );
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Random reads and reads as large as the window go to the device
+  //
+  if ((Lba != ReadLba) || (NumberOfBlocks >= WindowBlocks)) {
+    return ReadBlocks (IdeDev, Buffer, Lba, NumberOfBlocks);
+  }
+
+  //
+  // Fill the window from Lba, but not beyond the end of the media
+  //
+  if (Lba + WindowBlocks - 1 > Media->LastBlock) {
+    WindowBlocks = (UINTN) (Media->LastBlock - Lba + 1);
+  }
+
+  //
+  // Don't read ahead over blocks that a fill has failed on, each bad
+  // block may cost the full command timeout again
+  //
+  if ((IdeDev->ReadAheadFailedBlocks != 0) &&
+      (Lba < IdeDev->ReadAheadFailedLba + IdeDev->ReadAheadFailedBlocks) &&
+      (Lba + WindowBlocks > IdeDev->ReadAheadFailedLba)) {
+    return ReadBlocks (IdeDev, Buffer, Lba, NumberOfBlocks);
+  }
+
+  if (IdeDev->ReadAhead == NULL) {
+    IdeDev->ReadAhead = EfiLibAllocatePool (IDE_READ_AHEAD_SIZE);
+
+    if (IdeDev->ReadAhead == NULL) {
+      return ReadBlocks (IdeDev, Buffer, Lba, NumberOfBlocks);
+    }
+  }
+
+  IdeDev->ReadAheadBlocks = 0;
+  Status = ReadBlocks (IdeDev, IdeDev->ReadAhead, Lba, WindowBlocks);
+
+  if (EFI_ERROR (Status)) {
+    //
+    // The blocks read ahead may be the bad ones, so remember the window
+    // and don't fail the request until its own blocks have been tried.
+    //
+    IdeDev->ReadAheadFailedLba    = Lba;
+    IdeDev->ReadAheadFailedBlocks = WindowBlocks;
+    return ReadBlocks (IdeDev, Buffer, Lba, NumberOfBlocks);
+  }
+
+  IdeDev->ReadAheadLba    = Lba;
+  IdeDev->ReadAheadBlocks = WindowBlocks;
+
+  EfiCopyMem (Buffer, IdeDev->ReadAhead, NumberOfBlocks * BlockSize);
+  return EFI_SUCCESS;
+}
+
+VOID
+IdeInvalidateReadAhead (
+  IN  IDE_BLK_IO_DEV   *IdeDev
+  )
+/*++
+
+Routine Description:
+
+  Drop the blocks in the read-ahead window, and forget the window that
+  could not be filled, because the media has been written, changed or
+  reset.
+
+Arguments:
+
+  IdeDev  - The IDE device
+
+Returns:
+
+  None
+
+--*/
+{
+  IdeDev->ReadAheadBlocks       = 0;
+  IdeDev->ReadAheadFailedBlocks = 0;
+}
@@ -29,6 +29,18 @@ Revision History
 #ifndef _IDE_H
 #define _IDE_H
 
+//
+// The device read routines IdeReadAheadReadBlocks() reads through
+//
+typedef
+EFI_STATUS
+(*IDE_READ_BLOCKS) (
+  IN  IDE_BLK_IO_DEV  *IdeDev,
+  IN  VOID            *DataBuffer,
+  IN  EFI_LBA         StartLba,
+  IN  UINTN           NumberOfBlocks
+  );
+
 //
 // Helper functions Prototype
 //
@@ -1779,6 +1791,63 @@ Arguments:
 Returns:
 
 
+--*/
+;
+
+EFI_STATUS
+IdeReadAheadReadBlocks (
+  IN  IDE_BLK_IO_DEV   *IdeDev,
+  IN  IDE_READ_BLOCKS  ReadBlocks,
+  IN  VOID             *Buffer,
+  IN  EFI_LBA          Lba,
+  IN  UINTN            NumberOfBlocks
+  )
+/*++
+
+Routine Description:
+
+  Read blocks through the device's read-ahead window. A small read that
+  continues the previous one fills the window with the blocks following
+  it, and later reads inside the window are copied from memory. If the
+  window cannot be filled, only the caller's blocks are read, and no
+  window overlapping the failed one is filled until the read-ahead state
+  is invalidated.
+
+Arguments:
+
+  IdeDev          - The IDE device to read from
+  ReadBlocks      - The routine that reads from the device
+  Buffer          - The buffer to read into
+  Lba             - The first block to read
+  NumberOfBlocks  - Number of blocks to read
+
+Returns:
+
+  The status of ReadBlocks, or EFI_SUCCESS if the blocks are in the window
+
+--*/
+;
+
+VOID
+IdeInvalidateReadAhead (
+  IN  IDE_BLK_IO_DEV   *IdeDev
+  )
+/*++
+
+Routine Description:
+
+  Drop the blocks in the read-ahead window, and forget the window that
+  could not be filled, because the media has been written, changed or
+  reset.
+
+Arguments:
+
+  IdeDev  - The IDE device
+
+Returns:
+
+  None
+
 --*/
 ;
 
@@ -1145,6 +1145,7 @@ Returns:
   EFI_STATUS      Status;
 
   IdeBlkIoDevice = IDE_BLOCK_IO_DEV_FROM_THIS (This);
+  IdeInvalidateReadAhead (IdeBlkIoDevice);
   //
   // Requery IDE IO resources in case of the switch of native and legacy modes
   //
@@ -1277,6 +1278,10 @@ Returns:
 
   IdeBlkIoDevice = IDE_BLOCK_IO_DEV_FROM_THIS (This);
   //
+  // The blocks written may be in the read-ahead window
+  //
+  IdeInvalidateReadAhead (IdeBlkIoDevice);
+  //
   // Requery IDE IO resources in case of the switch of native and legacy modes
   //
   ReassignIdeResources (IdeBlkIoDevice);
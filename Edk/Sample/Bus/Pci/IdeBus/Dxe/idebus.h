@@ -62,6 +62,11 @@ typedef struct {
 
 #define IDE_BLK_IO_DEV_SIGNATURE  EFI_SIGNATURE_32 ('i', 'b', 'i', 'd')
 
+//
+// Size of the read-ahead window of sequential BlockIo reads
+//
+#define IDE_READ_AHEAD_SIZE       0x10000
+
 typedef struct {
   UINT32                      Signature;
 
@@ -93,6 +98,19 @@ typedef struct {
   UINT8                       SenseDataNumber;
   UINT8                       *Cache;
 
+  //
+  // Read-ahead window: ReadAheadBlocks blocks from ReadAheadLba are
+  // in ReadAhead. NextReadLba is where a sequential read would start.
+  // ReadAheadFailedBlocks blocks from ReadAheadFailedLba are the last
+  // window that could not be filled, and are not read ahead again.
+  //
+  UINT8                       *ReadAhead;
+  EFI_LBA                     ReadAheadLba;
+  UINTN                       ReadAheadBlocks;
+  EFI_LBA                     NextReadLba;
+  EFI_LBA                     ReadAheadFailedLba;
+  UINTN                       ReadAheadFailedBlocks;
+
   //
   // ExitBootService Event, it is used to clear pending IDE interrupt
   //
@@ -11,10 +11,11 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 Module Name:
 
-    EhciMem.c
+    UsbHcMem.c
 
 Abstract:
 
+    Memory pool shared by the USB host controller drivers.
 
 Revision History
 --*/
@@ -61,22 +62,25 @@ Returns:
   if (Block == NULL) {
     return NULL;
   }
-  
+
   //
   // each bit in the bit array represents USBHC_MEM_UNIT
-  // bytes of memory in the memory block.
+  // bytes of memory in the memory block. A page always
+  // fills whole words of the bit array.
   //
-  ASSERT (USBHC_MEM_UNIT * 8 <= EFI_PAGE_SIZE);
+  ASSERT (USBHC_MEM_UNIT * USBHC_MEM_WORD_BITS <= EFI_PAGE_SIZE);
 
-  Block->BufLen   = EFI_PAGES_TO_SIZE (Pages);
-  Block->BitsLen  = Block->BufLen / (USBHC_MEM_UNIT * 8);
-  Block->Bits     = EfiLibAllocateZeroPool (Block->BitsLen);
+  Block->BufLen     = EFI_PAGES_TO_SIZE (Pages);
+  Block->BitsLen    = Block->BufLen / (USBHC_MEM_UNIT * USBHC_MEM_WORD_BITS);
+  Block->FreeUnits  = Block->BufLen / USBHC_MEM_UNIT;
+  Block->Hint       = 0;
+  Block->Bits       = EfiLibAllocateZeroPool (Block->BitsLen * sizeof (UINTN));
 
   if (Block->Bits == NULL) {
     gBS->FreePool (Block);
     return NULL;
   }
-  
+
   //
   // Allocate the number of Pages of memory, then map it for
   // bus master read and write.
@@ -107,7 +111,7 @@ Returns:
   if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (Pages))) {
     goto FREE_BUFFER;
   }
-  
+
   //
   // Check whether the data structure used by the host controller
   // should be restricted into the same 4G
@@ -123,7 +127,7 @@ Returns:
 
   DEBUG ((mUsbHcDebugLevel, "UsbHcAllocMemBlock: block %x created with buffer %x\n",
                           Block, Block->Buf));
-  
+
   return Block;
 
 FREE_BUFFER:
@@ -153,9 +157,9 @@ Arguments:
   Block  - The memory block to free
 
 Returns:
-  
+
   VOID
-  
+
 --*/
 {
   EFI_PCI_IO_PROTOCOL     *PciIo;
@@ -174,6 +178,112 @@ Returns:
   gBS->FreePool (Block);
 }
 
+STATIC
+UINTN
+UsbHcLowestZeroBit (
+  IN UINTN                Word
+  )
+/*++
+
+Routine Description:
+
+  Find the lowest zero bit in a word of the bit array
+
+Arguments:
+
+  Word  - The word to search, it must have at least one zero bit
+
+Returns:
+
+  The index of the lowest zero bit
+
+--*/
+{
+  UINTN                   Bit;
+
+  ASSERT (Word != (UINTN) -1);
+
+#ifdef __GNUC__
+  Bit = (UINTN) __builtin_ctzll ((unsigned long long) ~Word);
+#else
+  Word  = ~Word;
+  Bit   = 0;
+
+  while ((Word & 0xFF) == 0) {
+    Word >>= 8;
+    Bit   += 8;
+  }
+
+  while ((Word & 0x01) == 0) {
+    Word >>= 1;
+    Bit++;
+  }
+#endif
+
+  return Bit;
+}
+
+STATIC
+VOID
+UsbHcMarkMemUnits (
+  IN USBHC_MEM_BLOCK      *Block,
+  IN UINTN                Start,
+  IN UINTN                Units,
+  IN BOOLEAN              Allocated
+  )
+/*++
+
+Routine Description:
+
+  Set or clear the bits of some consecutive memory units,
+  a word at a time.
+
+Arguments:
+
+  Block     - The memory block the units belong to
+  Start     - The first unit to mark
+  Units     - Number of memory units to mark
+  Allocated - TRUE to mark the units allocated, FALSE to mark them free
+
+Returns:
+
+  VOID
+
+--*/
+{
+  UINTN                   Index;
+  UINTN                   Bit;
+  UINTN                   Count;
+  UINTN                   Mask;
+
+  Index = Start / USBHC_MEM_WORD_BITS;
+  Bit   = Start % USBHC_MEM_WORD_BITS;
+
+  while (Units > 0) {
+    ASSERT (Index < Block->BitsLen);
+
+    Count = USBHC_MEM_WORD_BITS - Bit;
+
+    if (Count > Units) {
+      Count = Units;
+    }
+
+    Mask = USBHC_MEM_MASK (Bit, Count);
+
+    if (Allocated) {
+      ASSERT ((Block->Bits[Index] & Mask) == 0);
+      Block->Bits[Index] |= Mask;
+    } else {
+      ASSERT ((Block->Bits[Index] & Mask) == Mask);
+      Block->Bits[Index] &= ~Mask;
+    }
+
+    Units -= Count;
+    Bit    = 0;
+    Index++;
+  }
+}
+
 STATIC
 VOID *
 UsbHcAllocMemFromBlock (
@@ -189,71 +299,104 @@ Routine Description:
 Arguments:
 
   Block   - The memory block to allocate memory from
-  Mem     - The variable to store the memory allocated
   Units   - Number of memory units to allocate
 
 Returns:
 
-  EFI_SUCCESS   : The needed memory is allocated
-  EFI_NOT_FOUND : Can't find the free memory
+  The allocated memory or NULL if the block can't satisfy the request
 
 --*/
 {
-  UINTN                   Byte;
-  UINT8                   Bit;
-  UINTN                   StartByte;
-  UINT8                   StartBit;
+  UINTN                   Index;
+  UINTN                   Bit;
+  UINTN                   Word;
+  UINTN                   Start;
   UINTN                   Available;
-  UINTN                   Count;
 
   ASSERT ((Block != 0) && (Units != 0));
 
-  StartByte  = 0;
-  StartBit   = 0;
-  Available  = 0;
+  if (Block->FreeUnits < Units) {
+    return NULL;
+  }
 
-  for (Byte = 0, Bit = 0; Byte < Block->BitsLen;) {
-    //
-    // If current bit is zero, the corresponding memory unit is
-    // available, otherwise we need to restart our searching.
-    // Available counts the consective number of zero bit.
-    //
-    if (!USB_HC_BIT_IS_SET (Block->Bits[Byte], Bit)) {
-      Available++;
+  Start     = 0;
+  Available = 0;
+
+  //
+  // Search from the hint word: all the words before it are full.
+  // Available counts the consecutive free units found so far,
+  // and a full or empty word is accounted for as a whole.
+  //
+  for (Index = Block->Hint; Index < Block->BitsLen; Index++) {
+    Word = Block->Bits[Index];
+
+    if (Word == (UINTN) -1) {
+      Available = 0;
+      continue;
+    }
+
+    if (Word == 0) {
+      if (Available == 0) {
+        Start = Index * USBHC_MEM_WORD_BITS;
+      }
+
+      Available += USBHC_MEM_WORD_BITS;
 
       if (Available >= Units) {
         break;
       }
 
-      NEXT_BIT (Byte, Bit);
+      continue;
+    }
 
-    } else {
-      NEXT_BIT (Byte, Bit);
+    //
+    // A partially allocated word. If no run is pending, jump
+    // to its lowest free unit instead of testing each bit.
+    //
+    Bit = 0;
+
+    if (Available == 0) {
+      Bit = UsbHcLowestZeroBit (Word);
+    }
+
+    for (; Bit < USBHC_MEM_WORD_BITS; Bit++) {
+      if ((Word & ((UINTN) 1 << Bit)) == 0) {
+        if (Available == 0) {
+          Start = Index * USBHC_MEM_WORD_BITS + Bit;
+        }
+
+        Available++;
+
+        if (Available >= Units) {
+          break;
+        }
+
+      } else {
+        Available = 0;
+      }
+    }
 
-      Available  = 0;
-      StartByte  = Byte;
-      StartBit   = Bit;
+    if (Available >= Units) {
+      break;
     }
   }
 
   if (Available < Units) {
     return NULL;
   }
-  
+
   //
-  // Mark the memory as allocated
+  // Mark the memory as allocated, then move the hint past
+  // the words that have become full.
   //
-  Byte  = StartByte;
-  Bit   = StartBit;
-
-  for (Count = 0; Count < Units; Count++) {
-    ASSERT (!USB_HC_BIT_IS_SET (Block->Bits[Byte], Bit));
+  UsbHcMarkMemUnits (Block, Start, Units, TRUE);
+  Block->FreeUnits -= Units;
 
-    Block->Bits[Byte] |= USB_HC_BIT (Bit);
-    NEXT_BIT (Byte, Bit);
+  while ((Block->Hint < Block->BitsLen) && (Block->Bits[Block->Hint] == (UINTN) -1)) {
+    Block->Hint++;
   }
 
-  return Block->Buf + (StartByte * 8 + StartBit) * USBHC_MEM_UNIT;
+  return Block->Buf + Start * USBHC_MEM_UNIT;
 }
 
 STATIC
@@ -306,15 +449,7 @@ Returns:
 
 --*/
 {
-  UINTN                   Index;
-
-  for (Index = 0; Index < Block->BitsLen; Index++) {
-    if (Block->Bits[Index] != 0) {
-      return FALSE;
-    }
-  }
-
-  return TRUE;
+  return (BOOLEAN) (Block->FreeUnits == Block->BufLen / USBHC_MEM_UNIT);
 }
 
 STATIC
@@ -353,6 +488,35 @@ Returns:
   }
 }
 
+STATIC
+BOOLEAN
+UsbHcIsMemInBlock (
+  IN USBHC_MEM_BLOCK      *Block,
+  IN UINT8                *Mem,
+  IN UINTN                AllocSize
+  )
+/*++
+
+Routine Description:
+
+  Check whether the memory block completely contains the memory
+
+Arguments:
+
+  Block     - The memory block to check
+  Mem       - The start of the memory
+  AllocSize - The rounded size of the memory
+
+Returns:
+
+  TRUE  : The memory is inside the memory block
+  FALSE : The memory isn't inside the memory block
+
+--*/
+{
+  return (BOOLEAN) ((Block->Buf <= Mem) && ((Mem + AllocSize) <= (Block->Buf + Block->BufLen)));
+}
+
 USBHC_MEM_POOL *
 UsbHcInitMemPool (
   IN EFI_PCI_IO_PROTOCOL  *PciIo,
@@ -369,7 +533,7 @@ Arguments:
 
   Pool    - The USB memory pool to initialize
   PciIo   - The PciIo that can be used to access the host controller
-  Check4G - Whether the host controller requires allocated memory 
+  Check4G - Whether the host controller requires allocated memory
             from one 4G address space.
   Which4G - The 4G memory area each memory allocated should be from
 
@@ -382,7 +546,7 @@ Returns:
 {
   USBHC_MEM_POOL          *Pool;
 
-  Pool = EfiLibAllocatePool (sizeof (USBHC_MEM_POOL));
+  Pool = EfiLibAllocateZeroPool (sizeof (USBHC_MEM_POOL));
 
   if (Pool == NULL) {
     return Pool;
@@ -392,6 +556,7 @@ Returns:
   Pool->Check4G = Check4G;
   Pool->Which4G = Which4G;
   Pool->Head    = UsbHcAllocMemBlock (Pool, USBHC_MEM_DEFAULT_PAGES);
+  Pool->Hint    = Pool->Head;
 
   if (Pool->Head == NULL) {
     gBS->FreePool (Pool);
@@ -429,7 +594,8 @@ Returns:
   //
   // Unlink all the memory blocks from the pool, then free them.
   // UsbHcUnlinkMemBlock can't be used to unlink and free the
-  // first block.
+  // first block. The free lists point into the blocks, so they
+  // go away with them.
   //
   for (Block = Pool->Head->Next; Block != NULL; Block = Pool->Head->Next) {
     UsbHcUnlinkMemBlock (Pool->Head, Block);
@@ -461,7 +627,7 @@ Arguments:
 Returns:
 
   The allocated memory or NULL
-  
+
 --*/
 {
   USBHC_MEM_BLOCK         *Head;
@@ -469,26 +635,46 @@ Returns:
   USBHC_MEM_BLOCK         *NewBlock;
   VOID                    *Mem;
   UINTN                   AllocSize;
+  UINTN                   Units;
   UINTN                   Pages;
 
   Mem       = NULL;
   AllocSize = USBHC_MEM_ROUND (Size);
+  Units     = AllocSize / USBHC_MEM_UNIT;
   Head      = Pool->Head;
   ASSERT (Head != NULL);
 
   //
-  // First check whether current memory blocks can satisfy the allocation.
+  // Small allocations are first served from their size class's
+  // free list. The memory there is still marked allocated.
   //
-  for (Block = Head; Block != NULL; Block = Block->Next) {
-    Mem = UsbHcAllocMemFromBlock (Block, AllocSize / USBHC_MEM_UNIT);
+  if ((Units != 0) && (Units <= USBHC_MEM_CLASS_NUM) && (Pool->FreeList[Units - 1] != NULL)) {
+    Mem                         = Pool->FreeList[Units - 1];
+    Pool->FreeList[Units - 1]   = *(VOID **) Mem;
+    Pool->FreeCount[Units - 1]--;
 
-    if (Mem != NULL) {
-      EfiZeroMem (Mem, Size);
-      break;
+    EfiZeroMem (Mem, Size);
+    return Mem;
+  }
+
+  //
+  // Then check whether current memory blocks can satisfy the
+  // allocation, starting with the block last allocated from.
+  //
+  Mem = UsbHcAllocMemFromBlock (Pool->Hint, Units);
+
+  for (Block = Head; (Mem == NULL) && (Block != NULL); Block = Block->Next) {
+    if (Block != Pool->Hint) {
+      Mem = UsbHcAllocMemFromBlock (Block, Units);
+
+      if (Mem != NULL) {
+        Pool->Hint = Block;
+      }
     }
   }
 
   if (Mem != NULL) {
+    EfiZeroMem (Mem, Size);
     return Mem;
   }
 
@@ -510,12 +696,13 @@ Returns:
     DEBUG ((mUsbHcDebugLevel, "UsbHcAllocateMem: failed to allocate block\n"));
     return NULL;
   }
-  
+
   //
   // Add the new memory block to the pool, then allocate memory from it
   //
   UsbHcInsertMemBlockToPool (Head, NewBlock);
-  Mem = UsbHcAllocMemFromBlock (NewBlock, AllocSize / USBHC_MEM_UNIT);
+  Pool->Hint  = NewBlock;
+  Mem         = UsbHcAllocMemFromBlock (NewBlock, Units);
 
   if (Mem != NULL) {
     EfiZeroMem (Mem, Size);
@@ -552,37 +739,41 @@ Returns:
   USBHC_MEM_BLOCK         *Block;
   UINT8                   *ToFree;
   UINTN                   AllocSize;
-  UINTN                   Byte;
-  UINTN                   Bit;
-  UINTN                   Count;
+  UINTN                   Units;
+  UINTN                   Start;
 
   Head      = Pool->Head;
   AllocSize = USBHC_MEM_ROUND (Size);
+  Units     = AllocSize / USBHC_MEM_UNIT;
   ToFree    = (UINT8 *) Mem;
 
-  for (Block = Head; Block != NULL; Block = Block->Next) {
-    //
-    // scan the memory block list for the memory block that
-    // completely contains the memory to free.
-    //
-    if ((Block->Buf <= ToFree) && ((ToFree + AllocSize) <= (Block->Buf + Block->BufLen))) {
-      //
-      // compute the start byte and bit in the bit array
-      //
-      Byte  = ((ToFree - Block->Buf) / USBHC_MEM_UNIT) / 8;
-      Bit   = ((ToFree - Block->Buf) / USBHC_MEM_UNIT) % 8;
-
-      //
-      // reset associated bits in bit arry
-      //
-      for (Count = 0; Count < (AllocSize / USBHC_MEM_UNIT); Count++) {
-        ASSERT (USB_HC_BIT_IS_SET (Block->Bits[Byte], Bit));
-
-        Block->Bits[Byte] ^= (UINT8) USB_HC_BIT (Bit);
-        NEXT_BIT (Byte, Bit);
-      }
+  //
+  // Keep the small memory on its size class's free list if
+  // there is room. The first pointer of the memory links it.
+  // Only the head block, which is never released, backs the
+  // free lists, so they don't pin the other blocks.
+  //
+  if ((Units != 0) && (Units <= USBHC_MEM_CLASS_NUM) &&
+      (Pool->FreeCount[Units - 1] < USBHC_MEM_CLASS_DEPTH) &&
+      UsbHcIsMemInBlock (Head, ToFree, AllocSize)) {
+    *(VOID **) ToFree           = Pool->FreeList[Units - 1];
+    Pool->FreeList[Units - 1]   = ToFree;
+    Pool->FreeCount[Units - 1]++;
+    return ;
+  }
 
-      break;
+  //
+  // scan the memory block list for the memory block that
+  // completely contains the memory to free, starting with
+  // the block last allocated from.
+  //
+  Block = Pool->Hint;
+
+  if (!UsbHcIsMemInBlock (Block, ToFree, AllocSize)) {
+    for (Block = Head; Block != NULL; Block = Block->Next) {
+      if (UsbHcIsMemInBlock (Block, ToFree, AllocSize)) {
+        break;
+      }
     }
   }
 
@@ -593,12 +784,32 @@ Returns:
   //
   ASSERT (Block != NULL);
 
+  if (Block == NULL) {
+    return ;
+  }
+
+  //
+  // reset associated bits in bit array
+  //
+  Start = (ToFree - Block->Buf) / USBHC_MEM_UNIT;
+
+  UsbHcMarkMemUnits (Block, Start, Units, FALSE);
+  Block->FreeUnits += Units;
+
+  if (Start / USBHC_MEM_WORD_BITS < Block->Hint) {
+    Block->Hint = Start / USBHC_MEM_WORD_BITS;
+  }
+
   //
   // Release the current memory block if it is empty and not the head
   //
   if ((Block != Head) && UsbHcIsMemBlockEmpty (Block)) {
     DEBUG ((mUsbHcDebugLevel, "UsbHcFreeMem: block %x is empty, recycle\n", Block));
 
+    if (Pool->Hint == Block) {
+      Pool->Hint = Head;
+    }
+
     UsbHcUnlinkMemBlock (Head, Block);
     UsbHcFreeMemBlock (Pool, Block);
   }
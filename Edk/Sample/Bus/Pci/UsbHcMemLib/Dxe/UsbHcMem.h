@@ -11,17 +11,18 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 Module Name:
 
-  EhciMem.h
+  UsbHcMem.h
 
 Abstract:
 
-  This file contains the definination for host controller memory management routines
+  This file contains the definination for host controller memory management
+  routines. They are shared by the EHCI and UHCI drivers.
 
 Revision History
 --*/
 
-#ifndef _EFI_EHCI_MEM_H_
-#define _EFI_EHCI_MEM_H_
+#ifndef _EFI_USBHC_MEM_H_
+#define _EFI_USBHC_MEM_H_
 
 #include "Tiano.h"
 #include "EfiDriverLib.h"
@@ -29,61 +30,71 @@ Revision History
 
 #include EFI_PROTOCOL_DEFINITION (PciIo)
 
-#define USB_HC_BIT(a)                  ((UINTN)(1 << (a)))
-
-#define USB_HC_BIT_IS_SET(Data, Bit)   \
-          ((BOOLEAN)(((Data) & USB_HC_BIT(Bit)) == USB_HC_BIT(Bit)))
-
 #define USB_HC_HIGH_32BIT(Addr64)    \
           ((UINT32)(RShiftU64((UINTN)(Addr64), 32) & 0XFFFFFFFF))
 
 EFI_FORWARD_DECLARATION (USBHC_MEM_BLOCK);
 
+//
+// Each bit in the Bits array records whether one USBHC_MEM_UNIT
+// of the block is allocated. The array is scanned a UINTN word
+// at a time, Hint is the first word that may still have a free
+// unit, and FreeUnits lets a block that is too full be skipped
+// without looking at its bits.
+//
 typedef struct _USBHC_MEM_BLOCK {
-  UINT8                   *Bits;    // Bit array to record which unit is allocated
-  UINTN                   BitsLen; 
+  UINTN                   *Bits;    // Bit array to record which unit is allocated
+  UINTN                   BitsLen;  // Number of UINTN words in Bits
+  UINTN                   Hint;     // All the words before it are full
+  UINTN                   FreeUnits;
   UINT8                   *Buf;
   UINT8                   *BufHost;
   UINTN                   BufLen;   // Memory size in bytes
-  VOID                    *Mapping;     
+  VOID                    *Mapping;
   USBHC_MEM_BLOCK         *Next;
 } USBHC_MEM_BLOCK;
 
+enum {
+  USBHC_MEM_UNIT           = 64,     // Memory allocation unit, must be 2^n, n>4
+
+  USBHC_MEM_UNIT_MASK      = USBHC_MEM_UNIT - 1,
+  USBHC_MEM_DEFAULT_PAGES  = 16,
+
+  //
+  // Freed memory of up to USBHC_MEM_CLASS_NUM units is kept on a
+  // per size free list, at most USBHC_MEM_CLASS_DEPTH entries each,
+  // so the QH/QTD/TD churn of the transfers doesn't touch the bits.
+  //
+  USBHC_MEM_CLASS_NUM      = 4,
+  USBHC_MEM_CLASS_DEPTH    = 32,
+
+  USBHC_MEM_WORD_BITS      = sizeof (UINTN) * 8,
+};
+
 //
-// USBHC_MEM_POOL is used to manage the memory used by USB 
+// USBHC_MEM_POOL is used to manage the memory used by USB
 // host controller. EHCI requires the control memory and transfer
-// data to be on the same 4G memory. 
+// data to be on the same 4G memory.
 //
 typedef struct _USBHC_MEM_POOL {
-  EFI_PCI_IO_PROTOCOL     *PciIo;       
-  BOOLEAN                 Check4G;      
-  UINT32                  Which4G;      
+  EFI_PCI_IO_PROTOCOL     *PciIo;
+  BOOLEAN                 Check4G;
+  UINT32                  Which4G;
   USBHC_MEM_BLOCK         *Head;
+  USBHC_MEM_BLOCK         *Hint;    // The block last allocated from
+  VOID                    *FreeList[USBHC_MEM_CLASS_NUM];
+  UINTN                   FreeCount[USBHC_MEM_CLASS_NUM];
 } USBHC_MEM_POOL;
 
-enum {
-  USBHC_MEM_UNIT           = 64,     // Memory allocation unit, must be 2^n, n>4
-  
-  USBHC_MEM_UNIT_MASK      = USBHC_MEM_UNIT - 1,
-  USBHC_MEM_DEFAULT_PAGES  = 16,
-};
-
 #define USBHC_MEM_ROUND(Len)  (((Len) + USBHC_MEM_UNIT_MASK) & (~USBHC_MEM_UNIT_MASK))
 
 //
-// Advance the byte and bit to the next bit, adjust byte accordingly.
+// The mask of Count bits starting from Bit in one word
 //
-#define NEXT_BIT(Byte, Bit)   \
-          do {                \
-            (Bit)++;          \
-            if ((Bit) > 7) {  \
-              (Byte)++;       \
-              (Bit) = 0;      \
-            }                 \
-          } while (0)       
+#define USBHC_MEM_MASK(Bit, Count)  \
+          (((Count) >= USBHC_MEM_WORD_BITS) ? (UINTN) -1 : ((((UINTN) 1 << (Count)) - 1) << (Bit)))
 
 
-            
 USBHC_MEM_POOL *
 UsbHcInitMemPool (
   IN EFI_PCI_IO_PROTOCOL  *PciIo,
@@ -100,7 +111,7 @@ Arguments:
 
   Pool    - The USB memory pool to initialize
   PciIo   - The PciIo that can be used to access the host controller
-  Check4G - Whether the host controller requires allocated memory 
+  Check4G - Whether the host controller requires allocated memory
             from one 4G address space.
   Which4G - The 4G memory area each memory allocated should be from
 
@@ -111,7 +122,7 @@ Returns:
 
 --*/
 ;
-            
+
 
 EFI_STATUS
 UsbHcFreeMemPool (
@@ -156,7 +167,7 @@ Arguments:
 Returns:
 
   The allocated memory or NULL
-  
+
 --*/
 ;
 
@@ -80,6 +80,31 @@ Returns:
 
 --*/
 {
+  USB_ASYNC_BULK_REQUEST  *AsyncRequest;
+
+  //
+  // Cancel the bulk transfers still queued, then remove the
+  // async bulk protocol if it has been installed.
+  //
+  while (!IsListEmpty (&UsbIf->AsyncBulkRequests)) {
+    AsyncRequest = CR (
+                     UsbIf->AsyncBulkRequests.ForwardLink,
+                     USB_ASYNC_BULK_REQUEST,
+                     Link,
+                     USB_ASYNC_BULK_SIGNATURE
+                     );
+
+    UsbIf->AsyncBulk.Cancel (&UsbIf->AsyncBulk, AsyncRequest);
+  }
+
+  if (UsbIf->Device->Bus->Usb2HcAsyncBulk != NULL) {
+    gBS->UninstallProtocolInterface (
+           UsbIf->Handle,
+           &gEfiUsbIoAsyncBulkProtocolGuid,
+           &UsbIf->AsyncBulk
+           );
+  }
+
   UsbCloseHostProtoByChild (UsbIf->Device->Bus, UsbIf->Handle);
 
   gBS->UninstallMultipleProtocolInterfaces (
@@ -138,6 +163,9 @@ Returns:
   UsbIf->IfDesc     = IfDesc;
   UsbIf->IfSetting  = IfDesc->Settings[IfDesc->ActiveIndex];
   UsbIf->UsbIo      = mUsbIoProtocol;
+  UsbIf->AsyncBulk  = mUsbIoAsyncBulkProtocol;
+
+  InitializeListHead (&UsbIf->AsyncBulkRequests);
   
   //
   // Install protocols for USBIO and device path
@@ -194,6 +222,23 @@ Returns:
     goto ON_ERROR;
   }
 
+  //
+  // Let the class drivers queue bulk transfers if the host
+  // controller supports it. The USB IO works without it.
+  //
+  if (Device->Bus->Usb2HcAsyncBulk != NULL) {
+    Status = gBS->InstallProtocolInterface (
+                    &UsbIf->Handle,
+                    &gEfiUsbIoAsyncBulkProtocolGuid,
+                    EFI_NATIVE_INTERFACE,
+                    &UsbIf->AsyncBulk
+                    );
+
+    if (EFI_ERROR (Status)) {
+      USB_ERROR (("UsbCreateInterface: failed to install async bulk - %r\n", Status));
+    }
+  }
+
   return UsbIf;
 
 ON_ERROR:
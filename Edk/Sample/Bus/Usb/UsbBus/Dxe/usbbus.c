@@ -295,6 +295,308 @@ ON_EXIT:
   return Status;
 }
 
+STATIC
+VOID
+EFIAPI
+UsbIoAsyncBulkDone (
+  IN VOID                 *Context,
+  IN UINTN                DataLength,
+  IN UINT8                DataToggle,
+  IN UINT32               UsbResult
+  )
+/*++
+
+Routine Description:
+
+  Host controller callback of a queued bulk transfer. Update the 
+  endpoint's data toggle, then pass the result to the USB IO user.
+
+Arguments:
+
+  Context    - The USB_ASYNC_BULK_REQUEST of the transfer
+  DataLength - The amount of data transferred
+  DataToggle - The next data toggle of the endpoint
+  UsbResult  - The result of the transfer
+
+Returns:
+
+  None
+
+--*/
+{
+  USB_ASYNC_BULK_REQUEST      *Request;
+  EFI_USB_ASYNC_BULK_CALLBACK Callback;
+  VOID                        *CallbackContext;
+  USB_DEVICE                  *Dev;
+  EFI_TPL                     OldTpl;
+
+  OldTpl  = gBS->RaiseTPL (USB_BUS_TPL);
+
+  Request = (USB_ASYNC_BULK_REQUEST *) Context;
+  ASSERT (Request->Signature == USB_ASYNC_BULK_SIGNATURE);
+
+  Dev                     = Request->UsbIf->Device;
+  Request->EpDesc->Toggle = DataToggle;
+
+  //
+  // Clear TT buffer when CTRL/BULK split transaction failes,
+  // the same as UsbIoBulkTransfer. Transfers aborted because
+  // of an earlier failure aren't executed at all.
+  //
+  if ((UsbResult != EFI_USB_NOERROR) && (UsbResult != EFI_USB_ERR_NOTEXECUTE) &&
+      (Dev->Translator.TranslatorHubAddress != 0)) {
+    UsbHubCtrlClearTTBuffer (
+      Dev->Bus->Devices[Dev->Translator.TranslatorHubAddress], 
+      Dev->Translator.TranslatorPortNumber,         
+      Dev->Address, 
+      0, 
+      USB_ENDPOINT_BULK
+      );
+  }
+
+  Callback        = Request->Callback;
+  CallbackContext = Request->Context;
+
+  RemoveEntryList (&Request->Link);
+  gBS->FreePool (Request);
+
+  gBS->RestoreTPL (OldTpl);
+
+  Callback (CallbackContext, DataLength, DataToggle, UsbResult);
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+UsbIoAsyncBulkSubmit (
+  IN  EFI_USB_IO_ASYNC_BULK_PROTOCOL  *This,
+  IN  UINT8                           Endpoint,
+  IN  VOID                            *Data,
+  IN  UINTN                           DataLength,
+  IN  EFI_USB_ASYNC_BULK_CALLBACK     Callback,
+  IN  VOID                            *Context,
+  OUT VOID                            **Request
+  )
+/*++
+
+Routine Description:
+
+  Queue a bulk transfer to the device endpoint without waiting for it
+
+Arguments:
+
+  This            - The USB IO async bulk instance
+  Endpoint        - The device endpoint
+  Data            - The data to transfer, valid until the transfer ends
+  DataLength      - The length of the data to transfer
+  Callback        - The function to call when the transfer ends
+  Context         - The context to the callback
+  Request         - Return the handle to cancel the transfer with
+  
+Returns:
+
+  EFI_SUCCESS           - The bulk transfer is queued
+  EFI_INVALID_PARAMETER - Some parameters are invalid
+  Others                - Failed to queue the transfer
+
+--*/
+{
+  USB_DEVICE              *Dev;
+  USB_INTERFACE           *UsbIf;
+  USB_ENDPOINT_DESC       *EpDesc;
+  USB_ASYNC_BULK_REQUEST  *AsyncRequest;
+  USB_BUS                 *Bus;
+  EFI_TPL                 OldTpl;
+  EFI_STATUS              Status;
+
+  if ((USB_ENDPOINT_ADDR (Endpoint) == 0) || (USB_ENDPOINT_ADDR(Endpoint) > 15) ||
+      (Callback == NULL) || (Request == NULL)) {
+
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl  = gBS->RaiseTPL (USB_BUS_TPL);
+  
+  UsbIf   = USB_INTERFACE_FROM_ASYNC_BULK (This);
+  Dev     = UsbIf->Device;
+  Bus     = Dev->Bus;
+
+  if (Bus->Usb2HcAsyncBulk == NULL) {
+    Status = EFI_UNSUPPORTED;
+    goto ON_EXIT;
+  }
+
+  EpDesc  = UsbGetEndpointDesc (UsbIf, Endpoint);
+
+  if ((EpDesc == NULL) || (USB_ENDPOINT_TYPE (&EpDesc->Desc) != USB_ENDPOINT_BULK)) {
+    Status = EFI_INVALID_PARAMETER;
+    goto ON_EXIT;
+  }
+
+  AsyncRequest = EfiLibAllocateZeroPool (sizeof (USB_ASYNC_BULK_REQUEST));
+
+  if (AsyncRequest == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ON_EXIT;
+  }
+
+  AsyncRequest->Signature = USB_ASYNC_BULK_SIGNATURE;
+  AsyncRequest->UsbIf     = UsbIf;
+  AsyncRequest->EpDesc    = EpDesc;
+  AsyncRequest->Callback  = Callback;
+  AsyncRequest->Context   = Context;
+
+  //
+  // The toggle is only used if nothing else is queued to the 
+  // endpoint, the host controller carries it over otherwise.
+  //
+  Status = Bus->Usb2HcAsyncBulk->Submit (
+                                   Bus->Usb2HcAsyncBulk,
+                                   Dev->Address,
+                                   Endpoint,
+                                   Dev->Speed,
+                                   EpDesc->Desc.MaxPacketSize,
+                                   Data,
+                                   DataLength,
+                                   EpDesc->Toggle,
+                                   &Dev->Translator,
+                                   UsbIoAsyncBulkDone,
+                                   AsyncRequest,
+                                   &AsyncRequest->HcRequest
+                                   );
+
+  if (EFI_ERROR (Status)) {
+    gBS->FreePool (AsyncRequest);
+    goto ON_EXIT;
+  }
+
+  InsertTailList (&UsbIf->AsyncBulkRequests, &AsyncRequest->Link);
+  *Request = AsyncRequest;
+
+ON_EXIT:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+UsbIoAsyncBulkPoll (
+  IN  EFI_USB_IO_ASYNC_BULK_PROTOCOL  *This
+  )
+/*++
+
+Routine Description:
+
+  Check the queued bulk transfers now, the callbacks of
+  the finished ones are called before it returns.
+
+Arguments:
+
+  This            - The USB IO async bulk instance
+  
+Returns:
+
+  EFI_SUCCESS     - The queued transfers are checked
+  EFI_UNSUPPORTED - The host controller can't queue bulk transfers
+
+--*/
+{
+  USB_INTERFACE           *UsbIf;
+  USB_BUS                 *Bus;
+  EFI_TPL                 OldTpl;
+  EFI_STATUS              Status;
+
+  OldTpl  = gBS->RaiseTPL (USB_BUS_TPL);
+  
+  UsbIf   = USB_INTERFACE_FROM_ASYNC_BULK (This);
+  Bus     = UsbIf->Device->Bus;
+  Status  = EFI_UNSUPPORTED;
+
+  if (Bus->Usb2HcAsyncBulk != NULL) {
+    Status = Bus->Usb2HcAsyncBulk->Poll (Bus->Usb2HcAsyncBulk);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+UsbIoAsyncBulkCancel (
+  IN  EFI_USB_IO_ASYNC_BULK_PROTOCOL  *This,
+  IN  VOID                            *Request
+  )
+/*++
+
+Routine Description:
+
+  Cancel a queued bulk transfer, its callback isn't called. 
+  The transfers queued after it to the same endpoint are
+  aborted unless it had already finished OK.
+
+Arguments:
+
+  This            - The USB IO async bulk instance
+  Request         - The handle returned by Submit
+  
+Returns:
+
+  EFI_SUCCESS     - The transfer is cancelled
+  EFI_NOT_FOUND   - The transfer has ended or is cancelled
+
+--*/
+{
+  USB_INTERFACE           *UsbIf;
+  USB_BUS                 *Bus;
+  USB_ASYNC_BULK_REQUEST  *AsyncRequest;
+  EFI_LIST_ENTRY          *Entry;
+  EFI_TPL                 OldTpl;
+  EFI_STATUS              Status;
+  UINT8                   Toggle;
+
+  OldTpl  = gBS->RaiseTPL (USB_BUS_TPL);
+  
+  UsbIf   = USB_INTERFACE_FROM_ASYNC_BULK (This);
+  Bus     = UsbIf->Device->Bus;
+  Status  = EFI_NOT_FOUND;
+
+  for (Entry = UsbIf->AsyncBulkRequests.ForwardLink; 
+       Entry != &UsbIf->AsyncBulkRequests; 
+       Entry = Entry->ForwardLink) {
+
+    AsyncRequest = CR (Entry, USB_ASYNC_BULK_REQUEST, Link, USB_ASYNC_BULK_SIGNATURE);
+
+    if (AsyncRequest != Request) {
+      continue;
+    }
+
+    //
+    // The host controller may call back for the transfers aborted
+    // with this one, which removes them from the list. So stop the
+    // search before cancelling it.
+    //
+    RemoveEntryList (&AsyncRequest->Link);
+
+    Status = Bus->Usb2HcAsyncBulk->Cancel (
+                                     Bus->Usb2HcAsyncBulk,
+                                     AsyncRequest->HcRequest,
+                                     &Toggle
+                                     );
+
+    if (!EFI_ERROR (Status)) {
+      AsyncRequest->EpDesc->Toggle = Toggle;
+    }
+
+    gBS->FreePool (AsyncRequest);
+    break;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -1035,6 +1337,25 @@ Returns:
     goto CLOSE_HC;
   }
 
+  //
+  // Queuing bulk transfers is optional, the USB IO async bulk
+  // protocol is installed only if the USB_HC2 driver supports it.
+  //
+  if (UsbBus->Usb2Hc != NULL) {
+    Status = gBS->OpenProtocol (
+                    Controller,
+                    &gEfiUsb2HcAsyncBulkProtocolGuid,
+                    (VOID **) &(UsbBus->Usb2HcAsyncBulk),
+                    This->DriverBindingHandle,
+                    Controller,
+                    EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                    );
+
+    if (EFI_ERROR (Status)) {
+      UsbBus->Usb2HcAsyncBulk = NULL;
+    }
+  }
+
   UsbHcReset (UsbBus, EFI_USB_HC_RESET_GLOBAL);
   UsbHcSetState (UsbBus, EfiUsbHcStateOperational);
 
@@ -1152,6 +1473,12 @@ EFI_USB_IO_PROTOCOL mUsbIoProtocol = {
   UsbIoPortReset
 };
 
+EFI_USB_IO_ASYNC_BULK_PROTOCOL mUsbIoAsyncBulkProtocol = {
+  UsbIoAsyncBulkSubmit,
+  UsbIoAsyncBulkPoll,
+  UsbIoAsyncBulkCancel
+};
+
 EFI_DRIVER_ENTRY_POINT (UsbBusDriverEntryPoint)
 
 EFI_STATUS
@@ -30,6 +30,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include EFI_PROTOCOL_DEFINITION (DriverBinding)
 #include EFI_PROTOCOL_DEFINITION (DevicePath)
 #include EFI_PROTOCOL_DEFINITION (UsbHostController)
+#include EFI_PROTOCOL_DEFINITION (UsbAsyncBulk)
 #include EFI_PROTOCOL_DEFINITION (ComponentName)
 #include EFI_PROTOCOL_DEFINITION (ComponentName2)
 
@@ -123,6 +124,7 @@ enum {
 
   USB_INTERFACE_SIGNATURE   = EFI_SIGNATURE_32 ('U', 'S', 'B', 'I'),
   USB_BUS_SIGNATURE         = EFI_SIGNATURE_32 ('U', 'S', 'B', 'B'),
+  USB_ASYNC_BULK_SIGNATURE  = EFI_SIGNATURE_32 ('U', 'S', 'B', 'Q'),
 };
 
 #define USB_BIT(a)                  ((UINTN)(1 << (a)))
@@ -134,6 +136,9 @@ enum {
 #define USB_INTERFACE_FROM_USBIO(a) \
           CR(a, USB_INTERFACE, UsbIo, USB_INTERFACE_SIGNATURE)
 
+#define USB_INTERFACE_FROM_ASYNC_BULK(a) \
+          CR(a, USB_INTERFACE, AsyncBulk, USB_INTERFACE_SIGNATURE)
+
 #define USB_BUS_FROM_THIS(a) \
           CR(a, USB_BUS, BusId, USB_BUS_SIGNATURE)
 
@@ -198,6 +203,13 @@ typedef struct _USB_INTERFACE {
   EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
   BOOLEAN                   IsManaged;
 
+  //
+  // Bulk transfers queued through the async bulk protocol,
+  // it is only installed if the host controller supports it.
+  //
+  EFI_USB_IO_ASYNC_BULK_PROTOCOL  AsyncBulk;
+  EFI_LIST_ENTRY            AsyncBulkRequests;
+
   //
   // Hub device special data
   //
@@ -234,6 +246,7 @@ typedef struct _USB_BUS {
   EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
   EFI_USB2_HC_PROTOCOL      *Usb2Hc;
   EFI_USB_HC_PROTOCOL       *UsbHc;
+  EFI_USB2_HC_ASYNC_BULK_PROTOCOL *Usb2HcAsyncBulk; // NULL if the HC can't queue bulk transfers
   
   //
   // An array of device that is on the bus. Devices[0] is 
@@ -253,6 +266,20 @@ typedef struct _USB_BUS {
   
 } USB_BUS;
 
+//
+// A bulk transfer queued through EFI_USB_IO_ASYNC_BULK_PROTOCOL,
+// linked to its interface until the host controller finishes it.
+//
+typedef struct _USB_ASYNC_BULK_REQUEST {
+  UINTN                       Signature;
+  EFI_LIST_ENTRY              Link;
+  USB_INTERFACE               *UsbIf;
+  USB_ENDPOINT_DESC           *EpDesc;
+  VOID                        *HcRequest;
+  EFI_USB_ASYNC_BULK_CALLBACK Callback;
+  VOID                        *Context;
+} USB_ASYNC_BULK_REQUEST;
+
 
 #define USB_US_LAND_ID   0x0409
 
@@ -295,6 +322,7 @@ UsbBusRecursivelyConnectWantedUsbIo (
   );
 
 extern EFI_USB_IO_PROTOCOL           mUsbIoProtocol;
+extern EFI_USB_IO_ASYNC_BULK_PROTOCOL mUsbIoAsyncBulkProtocol;
 extern EFI_DRIVER_BINDING_PROTOCOL   mUsbBusDriverBinding;
 #if (EFI_SPECIFICATION_VERSION >= 0x00020000)
 extern EFI_COMPONENT_NAME2_PROTOCOL  mUsbBusComponentName;
@@ -35,6 +35,7 @@ Revision History
 
 #include EFI_PROTOCOL_DEFINITION (DriverBinding)
 #include EFI_PROTOCOL_DEFINITION (UsbIo)
+#include EFI_PROTOCOL_DEFINITION (UsbAsyncBulk)
 #include EFI_PROTOCOL_DEFINITION (BlockIo)
 
 #define USB_IS_IN_ENDPOINT(EndPointAddr)      (((EndPointAddr) & 0x80) == 0x80)
@@ -78,6 +79,7 @@ typedef
 EFI_STATUS
 (*USB_MASS_INIT_TRANSPORT) (
   IN  EFI_USB_IO_PROTOCOL     *Usb,
+  IN  EFI_HANDLE              Controller,
   OUT VOID                    **Context    OPTIONAL
   );
 
@@ -38,6 +38,7 @@ STATIC
 EFI_STATUS
 UsbBotInit (
   IN  EFI_USB_IO_PROTOCOL       * UsbIo,
+  IN  EFI_HANDLE                Controller,
   OUT VOID                      **Context OPTIONAL
   )
 /*++
@@ -51,6 +52,7 @@ Routine Description:
 Arguments:
 
   UsbIo       - The USB IO protocol to use
+  Controller  - The handle of the USB IO, used to find the async bulk protocol
   Context     - The variable to save the context to
 
 Returns:
@@ -134,6 +136,19 @@ Returns:
   UsbBot->CbwTag = 0x01;
 
   if (Context != NULL) {
+    //
+    // If the bus driver can queue bulk transfers, the three phases
+    // of a command are queued together. Otherwise use the USB IO.
+    //
+    Status = gBS->HandleProtocol (
+                    Controller,
+                    &gEfiUsbIoAsyncBulkProtocolGuid,
+                    &UsbBot->AsyncBulk
+                    );
+    if (EFI_ERROR (Status)) {
+      UsbBot->AsyncBulk = NULL;
+    }
+
     *Context = UsbBot;
   } else {
     gBS->FreePool (UsbBot);
@@ -146,6 +161,55 @@ ON_ERROR:
   return Status;
 }
 
+STATIC
+VOID
+UsbBotFillCbw (
+  IN  USB_BOT_PROTOCOL        *UsbBot,
+  OUT USB_BOT_CBW             *Cbw,
+  IN  UINT8                   *Cmd,
+  IN  UINT8                   CmdLen,
+  IN  EFI_USB_DATA_DIRECTION  DataDir,
+  IN  UINT32                  TransLen,
+  IN  UINT8                   Lun
+  )
+/*++
+
+Routine Description:
+
+  Build the CBW for the command
+
+Arguments:
+
+  UsbBot    - The USB BOT device
+  Cbw       - The CBW to fill in
+  Cmd       - The command to transfer to device
+  CmdLen    - the length of the command
+  DataDir   - The direction of the data
+  TransLen  - The expected length of the data
+  Lun       - The number of logic unit
+
+Returns:
+
+  None
+
+--*/
+{
+  ASSERT ((CmdLen > 0) && (CmdLen <= USB_BOT_MAX_CMDLEN));
+
+  //
+  // Fill in the CSW. Only the first LUN is supported now.
+  //
+  Cbw->Signature = USB_BOT_CBW_SIGNATURE;
+  Cbw->Tag       = UsbBot->CbwTag;
+  Cbw->DataLen   = TransLen;
+  Cbw->Flag      = ((DataDir == EfiUsbDataIn) ? 0x80 : 0);
+  Cbw->Lun       = Lun;
+  Cbw->CmdLen    = CmdLen;
+
+  EfiZeroMem (Cbw->CmdBlock, USB_BOT_MAX_CMDLEN);
+  EfiCopyMem (Cbw->CmdBlock, Cmd, CmdLen);
+}
+
 STATIC
 EFI_STATUS
 UsbBotSendCommand (
@@ -185,20 +249,7 @@ Returns:
   UINTN                     DataLen;
   UINTN                     Timeout;
 
-  ASSERT ((CmdLen > 0) && (CmdLen <= USB_BOT_MAX_CMDLEN));
-
-  //
-  // Fill in the CSW. Only the first LUN is supported now.
-  //
-  Cbw.Signature = USB_BOT_CBW_SIGNATURE;
-  Cbw.Tag       = UsbBot->CbwTag;
-  Cbw.DataLen   = TransLen;
-  Cbw.Flag      = ((DataDir == EfiUsbDataIn) ? 0x80 : 0);
-  Cbw.Lun       = Lun;
-  Cbw.CmdLen    = CmdLen;
-
-  EfiZeroMem (Cbw.CmdBlock, USB_BOT_MAX_CMDLEN);
-  EfiCopyMem (Cbw.CmdBlock, Cmd, CmdLen);
+  UsbBotFillCbw (UsbBot, &Cbw, Cmd, CmdLen, DataDir, TransLen, Lun);
 
   Result        = 0;
   DataLen       = sizeof (USB_BOT_CBW);
@@ -402,6 +453,327 @@ Returns:
   return Status;
 }
 
+STATIC
+VOID
+EFIAPI
+UsbBotAsyncStageDone (
+  IN VOID                     *Context,
+  IN UINTN                    DataLength,
+  IN UINT8                    DataToggle,
+  IN UINT32                   UsbResult
+  )
+/*++
+
+Routine Description:
+
+  Callback of the queued CBW, data or CSW transfer
+
+Arguments:
+
+  Context    - The USB_BOT_ASYNC_STAGE of the transfer
+  DataLength - The amount of data transferred
+  DataToggle - The next data toggle, managed by the bus driver
+  UsbResult  - The result of the transfer
+
+Returns:
+
+  None
+
+--*/
+{
+  USB_BOT_ASYNC_STAGE       *Stage;
+
+  Stage           = (USB_BOT_ASYNC_STAGE *) Context;
+  Stage->Length   = DataLength;
+  Stage->Result   = UsbResult;
+  Stage->Done     = TRUE;
+}
+
+STATIC
+EFI_STATUS
+UsbBotSubmitStage (
+  IN USB_BOT_PROTOCOL         *UsbBot,
+  IN USB_BOT_ASYNC_STAGE      *Stage,
+  IN UINT8                    Endpoint,
+  IN VOID                     *Data,
+  IN UINTN                    DataLen
+  )
+/*++
+
+Routine Description:
+
+  Queue one of the CBW, data and CSW transfers
+
+Arguments:
+
+  UsbBot    - The USB BOT device
+  Stage     - The stage to track the transfer with
+  Endpoint  - The bulk endpoint to use
+  Data      - The buffer of the transfer
+  DataLen   - The length of the buffer
+
+Returns:
+
+  EFI_SUCCESS - The transfer is queued
+  Others      - Failed to queue the transfer
+
+--*/
+{
+  EFI_STATUS                Status;
+
+  Stage->Done     = FALSE;
+  Stage->Length   = 0;
+  Stage->Result   = EFI_USB_ERR_NOTEXECUTE;
+
+  Status = UsbBot->AsyncBulk->Submit (
+                                UsbBot->AsyncBulk,
+                                Endpoint,
+                                Data,
+                                DataLen,
+                                UsbBotAsyncStageDone,
+                                Stage,
+                                &Stage->Request
+                                );
+  if (EFI_ERROR (Status)) {
+    Stage->Done = TRUE;
+  }
+
+  return Status;
+}
+
+STATIC
+VOID
+UsbBotCancelStage (
+  IN USB_BOT_PROTOCOL         *UsbBot,
+  IN USB_BOT_ASYNC_STAGE      *Stage
+  )
+/*++
+
+Routine Description:
+
+  Cancel a queued transfer if it hasn't finished
+
+Arguments:
+
+  UsbBot    - The USB BOT device
+  Stage     - The stage of the transfer
+
+Returns:
+
+  None
+
+--*/
+{
+  if (!Stage->Done) {
+    UsbBot->AsyncBulk->Cancel (UsbBot->AsyncBulk, Stage->Request);
+    Stage->Done = TRUE;
+  }
+}
+
+STATIC
+EFI_STATUS
+UsbBotExecCommandAsync (
+  IN  USB_BOT_PROTOCOL        *UsbBot,
+  IN  VOID                    *Cmd,
+  IN  UINT8                   CmdLen,
+  IN  EFI_USB_DATA_DIRECTION  DataDir,
+  IN  VOID                    *Data,
+  IN  UINT32                  DataLen,
+  IN  UINT8                   Lun,
+  IN  UINT32                  Timeout,
+  OUT UINT8                   *Result
+  )
+/*++
+
+Routine Description:
+
+  Queue the CBW, data and CSW transfers of a command together so
+  that each phase starts as soon as the one before it finishes,
+  instead of waiting for them one by one. The IN transfers are
+  queued ahead of the CBW, the device NAKs them until it gets the
+  command. If any phase fails, the same recovery as the separate
+  phases is applied.
+
+Arguments:
+
+  UsbBot    - The USB BOT device
+  Cmd       - The high level command
+  CmdLen    - The command length
+  DataDir   - The direction of the data transfer
+  Data      - The buffer to hold data
+  DataLen   - The length of the data
+  Lun       - The number of logic unit
+  Timeout   - The time to wait command 
+  Result    - The command status in the CSW
+
+Returns:
+
+  EFI_UNSUPPORTED  - Nothing is sent, use the separate phases instead
+  EFI_NOT_READY    - The device return NAK to the command
+  EFI_SUCCESS      - Command execute result is retrieved and in the Result.
+  Others           - Failed to execute the command
+
+--*/
+{
+  EFI_USB_IO_ASYNC_BULK_PROTOCOL  *AsyncBulk;
+  USB_BOT_CBW                     Cbw;
+  USB_BOT_CSW                     Csw;
+  USB_BOT_ASYNC_STAGE             CbwStage;
+  USB_BOT_ASYNC_STAGE             DataStage;
+  USB_BOT_ASYNC_STAGE             CswStage;
+  UINT8                           InEndpoint;
+  UINT8                           OutEndpoint;
+  UINT8                           DataEndpoint;
+  BOOLEAN                         HasData;
+  BOOLEAN                         Failed;
+  UINTN                           Index;
+  UINTN                           Loop;
+  EFI_STATUS                      Status;
+
+  AsyncBulk     = UsbBot->AsyncBulk;
+  InEndpoint    = UsbBot->BulkInEndpoint->EndpointAddress;
+  OutEndpoint   = UsbBot->BulkOutEndpoint->EndpointAddress;
+  HasData       = (BOOLEAN) ((DataDir != EfiUsbNoData) && (DataLen != 0));
+  DataEndpoint  = ((DataDir == EfiUsbDataIn) ? InEndpoint : OutEndpoint);
+
+  UsbBotFillCbw (UsbBot, &Cbw, Cmd, CmdLen, DataDir, DataLen, Lun);
+  EfiZeroMem (&Csw, sizeof (USB_BOT_CSW));
+
+  DataStage.Done    = TRUE;
+  DataStage.Result  = EFI_USB_NOERROR;
+  CbwStage.Done     = TRUE;
+  CbwStage.Result   = EFI_USB_NOERROR;
+
+  //
+  // Queue the IN transfers first, nothing is sent to the device
+  // before the CBW is queued. If the CBW can't be queued, the
+  // command can still be executed phase by phase.
+  //
+  if (HasData && (DataDir == EfiUsbDataIn)) {
+    Status = UsbBotSubmitStage (UsbBot, &DataStage, InEndpoint, Data, DataLen);
+    if (EFI_ERROR (Status)) {
+      return EFI_UNSUPPORTED;
+    }
+  }
+
+  Status = UsbBotSubmitStage (UsbBot, &CswStage, InEndpoint, &Csw, sizeof (USB_BOT_CSW));
+  if (!EFI_ERROR (Status)) {
+    Status = UsbBotSubmitStage (UsbBot, &CbwStage, OutEndpoint, &Cbw, sizeof (USB_BOT_CBW));
+  }
+
+  if (EFI_ERROR (Status)) {
+    UsbBotCancelStage (UsbBot, &DataStage);
+    UsbBotCancelStage (UsbBot, &CswStage);
+    return EFI_UNSUPPORTED;
+  }
+
+  if (HasData && (DataDir == EfiUsbDataOut)) {
+    Status = UsbBotSubmitStage (UsbBot, &DataStage, OutEndpoint, Data, DataLen);
+    if (EFI_ERROR (Status)) {
+      //
+      // The CBW may have been sent, the device has to be reset.
+      //
+      DEBUG ((mUsbBotError, "UsbBotExecCommandAsync: failed to queue data (%r)\n", Status));
+      UsbBotCancelStage (UsbBot, &CbwStage);
+      UsbBotCancelStage (UsbBot, &CswStage);
+      UsbBotResetDevice (UsbBot, FALSE);
+      UsbBot->CbwTag++;
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  //
+  // Wait for all the transfers to finish or one of them to fail
+  //
+  Loop    = (USB_BOT_SEND_CBW_TIMEOUT + Timeout + USB_BOT_RECV_CSW_TIMEOUT) / USB_BOT_ASYNC_POLL_STALL + 1;
+  Failed  = FALSE;
+
+  for (Index = 0; Index < Loop; Index++) {
+    AsyncBulk->Poll (AsyncBulk);
+
+    Failed = (BOOLEAN) ((CbwStage.Done && (CbwStage.Result != EFI_USB_NOERROR)) ||
+                        (DataStage.Done && (DataStage.Result != EFI_USB_NOERROR)) ||
+                        (CswStage.Done && (CswStage.Result != EFI_USB_NOERROR)));
+
+    if (Failed || (CbwStage.Done && DataStage.Done && CswStage.Done)) {
+      break;
+    }
+
+    gBS->Stall (USB_BOT_ASYNC_POLL_STALL);
+  }
+
+  if (!Failed && !(CbwStage.Done && DataStage.Done && CswStage.Done)) {
+    DEBUG ((mUsbBotError, "UsbBotExecCommandAsync: command timeout\n"));
+
+    UsbBotCancelStage (UsbBot, &CbwStage);
+    UsbBotCancelStage (UsbBot, &DataStage);
+    UsbBotCancelStage (UsbBot, &CswStage);
+    UsbBotResetDevice (UsbBot, FALSE);
+    UsbBot->CbwTag++;
+    return EFI_TIMEOUT;
+  }
+
+  //
+  // The command phase failed, the same as UsbBotSendCommand. The data
+  // transfer queued after the CBW has been aborted by the bus driver.
+  //
+  if (CbwStage.Done && (CbwStage.Result != EFI_USB_NOERROR)) {
+    DEBUG ((mUsbBotError, "UsbBotExecCommandAsync: CBW failed with %x\n", CbwStage.Result));
+
+    UsbBotCancelStage (UsbBot, &DataStage);
+    UsbBotCancelStage (UsbBot, &CswStage);
+
+    if (USB_IS_ERROR (CbwStage.Result, EFI_USB_ERR_STALL) && DataDir == EfiUsbDataOut) {
+      UsbBotResetDevice (UsbBot, FALSE);
+    } else if (USB_IS_ERROR (CbwStage.Result, EFI_USB_ERR_NAK)) {
+      return EFI_NOT_READY;
+    }
+
+    return EFI_DEVICE_ERROR;
+  }
+
+  //
+  // The data or status phase failed, clear the stall then read
+  // the CSW again the same as UsbBotGetStatus.
+  //
+  if (DataStage.Done && (DataStage.Result != EFI_USB_NOERROR)) {
+    DEBUG ((mUsbBotError, "UsbBotExecCommandAsync: data failed with %x\n", DataStage.Result));
+
+    UsbBotCancelStage (UsbBot, &CswStage);
+
+    if (USB_IS_ERROR (DataStage.Result, EFI_USB_ERR_STALL)) {
+      UsbClearEndpointStall (UsbBot->UsbIo, DataEndpoint);
+    }
+
+    return UsbBotGetStatus (UsbBot, DataLen, Result);
+  }
+
+  if (CswStage.Result != EFI_USB_NOERROR) {
+    DEBUG ((mUsbBotError, "UsbBotExecCommandAsync: CSW failed with %x\n", CswStage.Result));
+
+    if (USB_IS_ERROR (CswStage.Result, EFI_USB_ERR_STALL)) {
+      UsbClearEndpointStall (UsbBot->UsbIo, InEndpoint);
+    }
+
+    return UsbBotGetStatus (UsbBot, DataLen, Result);
+  }
+
+  //
+  // Invalid CSW or phase error needs reset recovery
+  //
+  UsbBot->CbwTag++;
+
+  if ((Csw.Signature != USB_BOT_CSW_SIGNATURE) || (Csw.CmdStatus == USB_BOT_COMMAND_ERROR)) {
+    DEBUG ((mUsbBotError, "UsbBotExecCommandAsync: invalid CSW or phase error\n"));
+
+    UsbBotResetDevice (UsbBot, FALSE);
+    return EFI_DEVICE_ERROR;
+  }
+
+  *Result = Csw.CmdStatus;
+  return EFI_SUCCESS;
+}
+
 STATIC
 EFI_STATUS
 UsbBotExecCommand (
@@ -449,6 +821,37 @@ Returns:
   *CmdStatus  = USB_MASS_CMD_FAIL;
   UsbBot      = (USB_BOT_PROTOCOL *) Context;
 
+  //
+  // Queue all the three phases together if the bus driver supports
+  // it, fall back to execute them one by one if it can't be queued.
+  //
+  if (UsbBot->AsyncBulk != NULL) {
+    Status = UsbBotExecCommandAsync (
+               UsbBot,
+               Cmd,
+               CmdLen,
+               DataDir,
+               Data,
+               DataLen,
+               Lun,
+               Timeout,
+               &Result
+               );
+
+    if (Status != EFI_UNSUPPORTED) {
+      if (EFI_ERROR (Status)) {
+        DEBUG ((mUsbBotError, "UsbBotExecCommand: UsbBotExecCommandAsync (%r)\n", Status));
+        return Status;
+      }
+
+      if (Result == 0) {
+        *CmdStatus = USB_MASS_CMD_SUCCESS;
+      }
+
+      return EFI_SUCCESS;
+    }
+  }
+
   //
   // Send the command to the device. Return immediately if device
   // rejects the command.
@@ -60,6 +60,11 @@ enum {
   USB_BOT_SEND_CBW_TIMEOUT     = 3 * USB_MASS_1_SECOND,
   USB_BOT_RECV_CSW_TIMEOUT     = 3 * USB_MASS_1_SECOND,
   USB_BOT_RESET_DEVICE_TIMEOUT = 3 * USB_MASS_1_SECOND,
+
+  //
+  // Interval to poll the queued CBW/data/CSW transfers, set by experience
+  //
+  USB_BOT_ASYNC_POLL_STALL     = 20,
 };
 
 //
@@ -95,7 +100,19 @@ typedef struct {
   EFI_USB_ENDPOINT_DESCRIPTOR   *BulkOutEndpoint;
   UINT32                        CbwTag;
   EFI_USB_IO_PROTOCOL           *UsbIo;
+  EFI_USB_IO_ASYNC_BULK_PROTOCOL *AsyncBulk;  // NULL if the bus can't queue transfers
 } USB_BOT_PROTOCOL;
 
+//
+// One of the CBW, data and CSW transfers queued together
+// by UsbBotExecCommandAsync.
+//
+typedef struct {
+  VOID                          *Request;
+  BOOLEAN                       Done;
+  UINTN                         Length;
+  UINT32                        Result;
+} USB_BOT_ASYNC_STAGE;
+
 extern USB_MASS_TRANSPORT mUsbBotTransport;
 #endif
@@ -40,6 +40,7 @@ STATIC
 EFI_STATUS
 UsbCbiInit (
   IN  EFI_USB_IO_PROTOCOL   *UsbIo,
+  IN  EFI_HANDLE            Controller,
   OUT VOID                  **Context       OPTIONAL
   )
 /*++
@@ -52,6 +53,7 @@ Routine Description:
 Arguments:
 
   UsbIo       - The USB IO to use
+  Controller  - The handle of the USB IO, not used by CBI
   Context     - The variable to save context in
 
 Returns:
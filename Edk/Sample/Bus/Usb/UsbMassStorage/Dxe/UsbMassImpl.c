@@ -433,7 +433,7 @@ Returns:
     *Transport = mUsbMassTransport[Index];
 
     if (Interface.InterfaceProtocol == (*Transport)->Protocol) {
-      Status  = (*Transport)->Init (UsbIo, Context);
+      Status  = (*Transport)->Init (UsbIo, Controller, Context);
       break;
     }
   }
@@ -772,7 +772,7 @@ Returns:
   for (Index = 0; mUsbMassTransport[Index] != NULL; Index++) {
     Transport = mUsbMassTransport[Index];
     if (Interface.InterfaceProtocol == Transport->Protocol) {
-      Status = Transport->Init (UsbIo, NULL);
+      Status = Transport->Init (UsbIo, Controller, NULL);
       break;
     }
   }
@@ -308,6 +308,11 @@ Returns:
   //
   gBS->SetWatchdogTimer (5 * 60, 0x0000, 0x00, NULL);
 
+  //
+  // Remember the boot path, the next boot may connect only this path
+  //
+  BdsLibRecordConnectReplay (Option, DevicePath);
+
   //
   // Write boot to OS performance data for UEFI boot
   //
@@ -333,6 +338,15 @@ Done:
         &Option->BootCurrent
         );
 
+  //
+  // The boot failed, so drop the boot path record. If only the recorded
+  // boot path was connected, connect everything before the next boot
+  // option is tried.
+  //
+  if (EFI_ERROR (Status)) {
+    BdsLibConnectReplayFallback ();
+  }
+
   //
   // Raise the TPL level back to EFI_TPL_DRIVER
   //
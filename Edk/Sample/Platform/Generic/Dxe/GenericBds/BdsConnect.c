@@ -21,6 +21,31 @@ Abstract:
 
 #include "BdsLib.h"
 
+//
+// The boot path replay record. It is saved in a NV variable when a boot
+// option is about to be started, and holds the device path that was used
+// to load the boot image and the CRC of the boot/console configuration at
+// that time. If the configuration is unchanged on the next boot, connecting
+// the recorded device path is enough to reach the boot device.
+//
+#define BDS_CONNECT_REPLAY_SIGNATURE  EFI_SIGNATURE_32 ('B', 'D', 'R', 'P')
+#define BDS_CONNECT_REPLAY_VARIABLE   L"BdsConnectReplay"
+
+typedef struct {
+  UINT32                    Signature;
+  UINT32                    ConfigCrc;
+  //
+  // EFI_DEVICE_PATH_PROTOCOL  DevicePath[];
+  //
+} BDS_CONNECT_REPLAY_HEADER;
+
+EFI_GUID  mBdsConnectReplayGuid = { 0x5d1c0ad2, 0x8e4b, 0x4c4f, { 0x9a, 0x27, 0x31, 0x6b, 0xe0, 0x4d, 0x72, 0xc9 } };
+
+//
+// Whether this boot only connected the recorded boot path.
+//
+BOOLEAN   mBdsConnectReplayed = FALSE;
+
 VOID
 BdsLibConnectAll (
   VOID
@@ -52,7 +77,9 @@ Returns:
   //
   // Generic way to connect all the drivers
   //
+  PERF_START (0, L"ConnectAll", L"BDS", 0);
   BdsLibConnectAllDriversToAllControllers ();
+  PERF_END (0, L"ConnectAll", L"BDS", 0);
 
   //
   // Here we have the assumption that we have already had
@@ -460,3 +487,324 @@ Returns:
   
   return EFI_NOT_FOUND;
 }
+
+STATIC
+UINT32
+BdsConnectReplayConfigCrc (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Compute the CRC of the variables which decide what the boot path
+  replay needs to connect: the boot order, the first boot option, the
+  driver order and the console variables.
+
+Arguments:
+
+  None
+
+Returns:
+
+  The CRC of the boot configuration.
+
+--*/
+{
+  CHAR16    *VarName[6];
+  UINT32    VarCrc[6];
+  UINT32    Crc;
+  UINTN     Index;
+  UINTN     Size;
+  VOID      *Var;
+  UINT16    *BootOrder;
+  CHAR16    BootOption[10];
+
+  VarName[0] = L"BootOrder";
+  VarName[1] = L"DriverOrder";
+  VarName[2] = L"ConIn";
+  VarName[3] = L"ConOut";
+  VarName[4] = L"ErrOut";
+  VarName[5] = NULL;
+
+  BootOrder = BdsLibGetVariableAndSize (L"BootOrder", &gEfiGlobalVariableGuid, &Size);
+  if ((BootOrder != NULL) && (Size >= sizeof (UINT16))) {
+    SPrint (BootOption, sizeof (BootOption), L"Boot%04x", BootOrder[0]);
+    VarName[5] = BootOption;
+  }
+
+  if (BootOrder != NULL) {
+    gBS->FreePool (BootOrder);
+  }
+
+  for (Index = 0; Index < sizeof (VarName) / sizeof (VarName[0]); Index++) {
+    VarCrc[Index] = 0;
+
+    if (VarName[Index] == NULL) {
+      continue;
+    }
+
+    Var = BdsLibGetVariableAndSize (VarName[Index], &gEfiGlobalVariableGuid, &Size);
+    if (Var != NULL) {
+      gBS->CalculateCrc32 (Var, Size, &VarCrc[Index]);
+      gBS->FreePool (Var);
+    }
+  }
+
+  Crc = 0;
+  gBS->CalculateCrc32 (VarCrc, sizeof (VarCrc), &Crc);
+  return Crc;
+}
+
+STATIC
+BOOLEAN
+BdsConnectReplayPathValid (
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath,
+  IN UINTN                     MaxSize
+  )
+/*++
+
+Routine Description:
+
+  Check that the recorded device path is well formed and ends within
+  the variable data.
+
+Arguments:
+
+  DevicePath  - The recorded device path
+  MaxSize     - The size of the variable data holding the device path
+
+Returns:
+
+  TRUE if the device path is well formed, otherwise FALSE.
+
+--*/
+{
+  UINTN     Size;
+  UINTN     NodeLength;
+
+  Size = 0;
+
+  while (Size + sizeof (EFI_DEVICE_PATH_PROTOCOL) <= MaxSize) {
+    NodeLength = DevicePathNodeLength (DevicePath);
+
+    if ((NodeLength < sizeof (EFI_DEVICE_PATH_PROTOCOL)) || (Size + NodeLength > MaxSize)) {
+      return FALSE;
+    }
+
+    if (IsDevicePathEnd (DevicePath)) {
+      return TRUE;
+    }
+
+    Size      += NodeLength;
+    DevicePath = NextDevicePathNode (DevicePath);
+  }
+
+  return FALSE;
+}
+
+VOID
+BdsLibInvalidateConnectReplay (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Delete the boot path replay record, so the next boot connects all
+  the drivers to all the controllers.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  gRT->SetVariable (
+        BDS_CONNECT_REPLAY_VARIABLE,
+        &mBdsConnectReplayGuid,
+        EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_NON_VOLATILE,
+        0,
+        NULL
+        );
+}
+
+EFI_STATUS
+BdsLibConnectReplay (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Connect only the device path recorded by the last boot, instead of
+  all the drivers to all the controllers. The platform calls this when
+  it assumes no configuration changes, and falls back to BdsLibConnectAll ()
+  if it fails.
+
+Arguments:
+
+  None
+
+Returns:
+
+  EFI_SUCCESS   - The recorded boot path is connected.
+  EFI_NOT_FOUND - There is no record, the boot configuration has changed
+                  or the recorded device path can't be connected any more.
+
+--*/
+{
+  EFI_STATUS                Status;
+  BDS_CONNECT_REPLAY_HEADER *Record;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  UINTN                     Size;
+
+  Record = BdsLibGetVariableAndSize (
+             BDS_CONNECT_REPLAY_VARIABLE,
+             &mBdsConnectReplayGuid,
+             &Size
+             );
+  if (Record == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  DevicePath = (EFI_DEVICE_PATH_PROTOCOL *) (Record + 1);
+
+  if ((Size <= sizeof (BDS_CONNECT_REPLAY_HEADER)) ||
+      (Record->Signature != BDS_CONNECT_REPLAY_SIGNATURE) ||
+      (Record->ConfigCrc != BdsConnectReplayConfigCrc ()) ||
+      !BdsConnectReplayPathValid (DevicePath, Size - sizeof (BDS_CONNECT_REPLAY_HEADER))) {
+    DEBUG ((EFI_D_INFO, "BDS: boot configuration changed, connect all\n"));
+    gBS->FreePool (Record);
+    BdsLibInvalidateConnectReplay ();
+    return EFI_NOT_FOUND;
+  }
+
+  PERF_START (0, L"ConnectReplay", L"BDS", 0);
+  Status = BdsLibConnectDevicePath (DevicePath);
+  PERF_END (0, L"ConnectReplay", L"BDS", 0);
+
+  gBS->FreePool (Record);
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((EFI_D_INFO, "BDS: recorded boot path not found, connect all\n"));
+    BdsLibInvalidateConnectReplay ();
+    return EFI_NOT_FOUND;
+  }
+
+  mBdsConnectReplayed = TRUE;
+  return EFI_SUCCESS;
+}
+
+VOID
+BdsLibRecordConnectReplay (
+  IN BDS_COMMON_OPTION         *Option,
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath
+  )
+/*++
+
+Routine Description:
+
+  Record the device path used to load the boot image, so the next boot
+  can replay it with BdsLibConnectReplay (). Only the first option in
+  BootOrder is recorded, because that is the one the next boot will try.
+  Booting any other option, such as BootNext or a hotkey, deletes the record.
+  The variable is only written when the record changes.
+
+Arguments:
+
+  Option      - The boot option being booted
+  DevicePath  - The device path of the boot image
+
+Returns:
+
+  None
+
+--*/
+{
+  BDS_CONNECT_REPLAY_HEADER *Record;
+  BDS_CONNECT_REPLAY_HEADER *OldRecord;
+  UINT16                    *BootOrder;
+  UINTN                     Size;
+  UINTN                     OldSize;
+
+  BootOrder = BdsLibGetVariableAndSize (L"BootOrder", &gEfiGlobalVariableGuid, &Size);
+
+  if ((BootOrder == NULL) || (Size < sizeof (UINT16)) || (BootOrder[0] != Option->BootCurrent)) {
+    if (BootOrder != NULL) {
+      gBS->FreePool (BootOrder);
+    }
+
+    BdsLibInvalidateConnectReplay ();
+    return ;
+  }
+
+  gBS->FreePool (BootOrder);
+
+  Size   = sizeof (BDS_CONNECT_REPLAY_HEADER) + EfiDevicePathSize (DevicePath);
+  Record = EfiLibAllocatePool (Size);
+  if (Record == NULL) {
+    return ;
+  }
+
+  Record->Signature = BDS_CONNECT_REPLAY_SIGNATURE;
+  Record->ConfigCrc = BdsConnectReplayConfigCrc ();
+  EfiCopyMem (Record + 1, DevicePath, Size - sizeof (BDS_CONNECT_REPLAY_HEADER));
+
+  OldRecord = BdsLibGetVariableAndSize (
+                BDS_CONNECT_REPLAY_VARIABLE,
+                &mBdsConnectReplayGuid,
+                &OldSize
+                );
+
+  if ((OldRecord == NULL) || (OldSize != Size) || (EfiCompareMem (OldRecord, Record, Size) != 0)) {
+    gRT->SetVariable (
+          BDS_CONNECT_REPLAY_VARIABLE,
+          &mBdsConnectReplayGuid,
+          EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_NON_VOLATILE,
+          Size,
+          Record
+          );
+  }
+
+  if (OldRecord != NULL) {
+    gBS->FreePool (OldRecord);
+  }
+
+  gBS->FreePool (Record);
+}
+
+VOID
+BdsLibConnectReplayFallback (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Called when a boot option fails. Drop the boot path record, so the next
+  boot does the full enumeration. If this boot only connected the recorded
+  boot path, connect all the drivers to all the controllers now, since the
+  devices of the other boot options may not be connected yet.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  BdsLibInvalidateConnectReplay ();
+
+  if (mBdsConnectReplayed) {
+    mBdsConnectReplayed = FALSE;
+    BdsLibConnectAll ();
+  }
+}
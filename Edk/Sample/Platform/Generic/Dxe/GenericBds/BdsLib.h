@@ -275,6 +275,27 @@ BdsLibConnectDevicePath (
   IN EFI_DEVICE_PATH_PROTOCOL  *DevicePathToConnect
   );
 
+EFI_STATUS
+BdsLibConnectReplay (
+  VOID
+  );
+
+VOID
+BdsLibRecordConnectReplay (
+  IN BDS_COMMON_OPTION         *Option,
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath
+  );
+
+VOID
+BdsLibInvalidateConnectReplay (
+  VOID
+  );
+
+VOID
+BdsLibConnectReplayFallback (
+  VOID
+  );
+
 EFI_STATUS
 BdsLibConnectAllEfi (
   VOID
@@ -337,9 +337,14 @@ Returns:
     PlatformBdsDiagnostics (IGNORE, TRUE);
 
     //
-    // Perform some platform specific connect sequence
+    // Only connect the device path the last boot went through, if the
+    // boot configuration has not changed since. Otherwise perform the
+    // platform specific connect sequence, which connects all devices.
+    // BdsLibBootViaBootOption () connects the rest if the boot fails.
     //
-    PlatformBdsConnectSequence ();
+    if (EFI_ERROR (BdsLibConnectReplay ())) {
+      PlatformBdsConnectSequence ();
+    }
 
     //
     // Notes: current time out = 0 can not enter the
@@ -30,9 +30,29 @@ Abstract:
 #undef realloc
 #undef free
 //
-// Start of allocation list.
+// Hash table of allocations, indexed by the caller's buffer address.
 //
-static MY_ALLOC_STRUCT  *MyAllocData = NULL;
+static MY_ALLOC_STRUCT  **MyAllocTable    = NULL;
+static UINTN            MyAllocTableSize  = 0;
+static UINTN            MyAllocCount      = 0;
+
+//
+// Arena state.  New arena allocations are carved from the front of the
+// current slab.
+//
+static BOOLEAN          MyAllocArenaMode  = FALSE;
+static UINTN            MyAllocArenaCount = 0;
+static UINT8            *MyAllocSlab      = NULL;
+static UINTN            MyAllocSlabFree   = 0;
+
+//
+// Statistics reported by MyCheck() and at exit.
+//
+static UINTN            MyAllocTotalCount   = 0;
+static UINT64           MyAllocTotalBytes   = 0;
+static UINTN            MyAllocCurrentBytes = 0;
+static UINTN            MyAllocPeakBytes    = 0;
+static UINTN            MyAllocSlabBytes    = 0;
 
 //
 //
@@ -40,6 +60,313 @@ static MY_ALLOC_STRUCT  *MyAllocData = NULL;
 static UINT32           MyAllocHeadMagik  = MYALLOC_HEAD_MAGIK;
 static UINT32           MyAllocTailMagik  = MYALLOC_TAIL_MAGIK;
 
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+UINTN
+MyAllocHash (
+  VOID       *Ptr
+  )
+// *++
+// Description:
+//
+//  Return the hash bucket of a caller's buffer.
+//
+// Parameters:
+//
+//  Ptr := Pointer to the caller's buffer.
+//
+// Returns:
+//
+//  Index into MyAllocTable.
+//
+// --*/
+//
+{
+  return (((UINTN) Ptr >> 3) ^ ((UINTN) Ptr >> 15)) & (MyAllocTableSize - 1);
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+UINTN
+MyAllocChecksum (
+  MY_ALLOC_STRUCT *Tmp
+  )
+// *++
+// Description:
+//
+//  Compute the checksum of an allocation structure.
+//
+// Parameters:
+//
+//  Tmp := Allocation structure.
+//
+// Returns:
+//
+//  The value Tmp->Cksum must hold.
+//
+// --*/
+//
+{
+  return (UINTN) Tmp + Tmp->Line + Tmp->Size + (UINTN) (Tmp->File) + (UINTN) (Tmp->Buffer) + Tmp->Arena;
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+BOOLEAN
+MyAllocValid (
+  MY_ALLOC_STRUCT *Tmp
+  )
+// *++
+// Description:
+//
+//  Check one allocation for a corrupted structure or an overflow or
+//  underflow of the caller's buffer.
+//
+// Parameters:
+//
+//  Tmp := Allocation structure to check.
+//
+// Returns:
+//
+//  TRUE if the allocation is intact.
+//
+// --*/
+//
+{
+  if (Tmp->Cksum != MyAllocChecksum (Tmp) ||
+      memcmp(Tmp->Buffer, &MyAllocHeadMagik, sizeof MyAllocHeadMagik) ||
+      memcmp(&Tmp->Buffer[Tmp->Size + sizeof(UINT32)], &MyAllocTailMagik, sizeof MyAllocTailMagik)) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+MY_ALLOC_STRUCT **
+MyAllocFind (
+  VOID       *Ptr
+  )
+// *++
+// Description:
+//
+//  Find the allocation that owns a caller's buffer.
+//
+// Parameters:
+//
+//  Ptr := Pointer to the caller's buffer.
+//
+// Returns:
+//
+//  Pointer to the link that points to the allocation, so that it can be
+//  unlinked, or NULL if Ptr was not allocated by MyAlloc().
+//
+// --*/
+//
+{
+  MY_ALLOC_STRUCT **Link;
+
+  if (MyAllocTable == NULL) {
+    return NULL;
+  }
+
+  for (Link = &MyAllocTable[MyAllocHash (Ptr)]; *Link != NULL; Link = &(*Link)->Next) {
+    if (&(*Link)->Buffer[sizeof (UINT32)] == Ptr) {
+      return Link;
+    }
+  }
+
+  return NULL;
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+VOID
+MyAllocReport (
+  VOID
+  )
+// *++
+// Description:
+//
+//  Append the allocation statistics of this run to the file named by the
+//  MYALLOC_REPORT environment variable.  Registered with atexit().
+//
+// Parameters:
+//
+//  n/a
+//
+// Returns:
+//
+//  n/a
+//
+// --*/
+//
+{
+  CHAR8 *ReportName;
+  FILE  *ReportFile;
+
+  ReportName = getenv (MYALLOC_REPORT_ENV);
+  if (ReportName == NULL || ReportName[0] == 0) {
+    return ;
+  }
+
+  ReportFile = fopen (ReportName, "a");
+  if (ReportFile == NULL) {
+    return ;
+  }
+
+  fprintf (
+    ReportFile,
+    "%s Allocations=%u, Total=%I64u, Peak=%u, Slabs=%u\n",
+    (_pgmptr != NULL) ? _pgmptr : "?",
+    MyAllocTotalCount,
+    MyAllocTotalBytes,
+    MyAllocPeakBytes,
+    MyAllocSlabBytes
+    );
+
+  fclose (ReportFile);
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+VOID
+MyAllocGrowTable (
+  VOID
+  )
+// *++
+// Description:
+//
+//  Create the hash table on first use and double it once it holds more
+//  than two allocations per bucket.  If memory cannot be allocated for
+//  the first table exit(1) is called.  Failing to grow the table only
+//  makes lookups slower.
+//
+// Parameters:
+//
+//  n/a
+//
+// Returns:
+//
+//  n/a
+//
+// --*/
+//
+{
+  MY_ALLOC_STRUCT **OldTable;
+  MY_ALLOC_STRUCT *Tmp;
+  UINTN           OldSize;
+  UINTN           Index;
+  UINTN           Bucket;
+
+  if (MyAllocTable == NULL) {
+    MyAllocTable = calloc (MYALLOC_HASH_SIZE, sizeof (MY_ALLOC_STRUCT *));
+    if (MyAllocTable == NULL) {
+      printf ("\nMyAlloc()\nOut of memory.\n");
+      exit (1);
+    }
+
+    MyAllocTableSize = MYALLOC_HASH_SIZE;
+    atexit (MyAllocReport);
+    return ;
+  }
+
+  if (MyAllocCount < 2 * MyAllocTableSize) {
+    return ;
+  }
+
+  OldTable      = MyAllocTable;
+  OldSize       = MyAllocTableSize;
+  MyAllocTable  = calloc (OldSize * 2, sizeof (MY_ALLOC_STRUCT *));
+  if (MyAllocTable == NULL) {
+    MyAllocTable = OldTable;
+    return ;
+  }
+
+  MyAllocTableSize = OldSize * 2;
+  for (Index = 0; Index < OldSize; Index++) {
+    while (OldTable[Index] != NULL) {
+      Tmp                   = OldTable[Index];
+      OldTable[Index]       = Tmp->Next;
+      Bucket                = MyAllocHash (&Tmp->Buffer[sizeof (UINT32)]);
+      Tmp->Next             = MyAllocTable[Bucket];
+      MyAllocTable[Bucket]  = Tmp;
+    }
+  }
+
+  free (OldTable);
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+static
+VOID *
+MyAllocFromArena (
+  UINTN      Size
+  )
+// *++
+// Description:
+//
+//  Carve zeroed storage from the current arena slab, starting a new slab
+//  when the current one is full.  Requests larger than a quarter of a
+//  slab get a slab of their own so that little of a slab is wasted.
+//
+// Parameters:
+//
+//  Size := Number of bytes needed.
+//
+// Returns:
+//
+//  Pointer to UINT64 aligned storage, or NULL if out of memory.
+//
+// --*/
+//
+{
+  UINT8 *Storage;
+
+  Size = (Size + 7) &~7;
+
+  if (Size > MYALLOC_SLAB_SIZE / 4) {
+    Storage = calloc (1, Size);
+    if (Storage != NULL) {
+      MyAllocSlabBytes += Size;
+    }
+
+    return Storage;
+  }
+
+  if (Size > MyAllocSlabFree) {
+    Storage = calloc (1, MYALLOC_SLAB_SIZE);
+    if (Storage == NULL) {
+      return NULL;
+    }
+
+    MyAllocSlab       = Storage;
+    MyAllocSlabFree   = MYALLOC_SLAB_SIZE;
+    MyAllocSlabBytes += MYALLOC_SLAB_SIZE;
+  }
+
+  Storage           = MyAllocSlab;
+  MyAllocSlab      += Size;
+  MyAllocSlabFree  -= Size;
+
+  return Storage;
+}
 //
 // ////////////////////////////////////////////////////////////////////////////
 //
@@ -61,7 +388,8 @@ MyCheck (
 //  Final := When FALSE, MyCheck() returns if the allocated memory chain
 //           has not been corrupted.  When TRUE, MyCheck() returns if there
 //           are no un-freed allocations.  If there are un-freed allocations,
-//           they are displayed and exit(1) is called.
+//           they are displayed and exit(1) is called.  The allocation
+//           statistics are displayed either way.
 //
 //
 //  File := Set to __FILE__ by macro expansion.
@@ -76,6 +404,7 @@ MyCheck (
 //
 {
   MY_ALLOC_STRUCT *Tmp;
+  UINTN           Index;
 
   //
   // Check parameters.
@@ -106,10 +435,12 @@ MyCheck (
   //
   // Check structure contents.
   //
-  for (Tmp = MyAllocData; Tmp != NULL; Tmp = Tmp->Next) {
-    if (memcmp(Tmp->Buffer, &MyAllocHeadMagik, sizeof MyAllocHeadMagik) ||
-        memcmp(&Tmp->Buffer[Tmp->Size + sizeof(UINT32)], &MyAllocTailMagik, sizeof MyAllocTailMagik)) {
-      break;
+  Tmp = NULL;
+  for (Index = 0; Index < MyAllocTableSize && Tmp == NULL; Index++) {
+    for (Tmp = MyAllocTable[Index]; Tmp != NULL; Tmp = Tmp->Next) {
+      if (!MyAllocValid (Tmp)) {
+        break;
+      }
     }
   }
   //
@@ -132,10 +463,23 @@ MyCheck (
     exit (1);
   }
   //
-  // If Final is TRUE, display the state of the structure chain.
+  // If Final is TRUE, display the state of the structure chain.  Arena
+  // allocations are released at exit and are not reported.
   //
   if (Final) {
-    if (MyAllocData != NULL) {
+    printf (
+      "\nMyCheck(Final=%u, File=%s, Line=%u)"
+      "\nAllocations=%u, Total=%I64u, Peak=%u, Slabs=%u\n",
+      Final,
+      File,
+      Line,
+      MyAllocTotalCount,
+      MyAllocTotalBytes,
+      MyAllocPeakBytes,
+      MyAllocSlabBytes
+      );
+
+    if (MyAllocCount > MyAllocArenaCount) {
       printf (
         "\nMyCheck(Final=%u, File=%s, Line=%u)"
         "\nSome allocated items have not been freed.\n",
@@ -144,15 +488,21 @@ MyCheck (
         Line
         );
 
-      for (Tmp = MyAllocData; Tmp != NULL; Tmp = Tmp->Next) {
-        printf (
-          "File=%s, Line=%u, nSize=%u, Head=%xh, Tail=%xh\n",
-          Tmp->File,
-          Tmp->Line,
-          Tmp->Size,
-          *(UINT32 *) (Tmp->Buffer),
-          *(UINT32 *) (&Tmp->Buffer[Tmp->Size + sizeof (UINT32)])
-          );
+      for (Index = 0; Index < MyAllocTableSize; Index++) {
+        for (Tmp = MyAllocTable[Index]; Tmp != NULL; Tmp = Tmp->Next) {
+          if (Tmp->Arena) {
+            continue;
+          }
+
+          printf (
+            "File=%s, Line=%u, nSize=%u, Head=%xh, Tail=%xh\n",
+            Tmp->File,
+            Tmp->Line,
+            Tmp->Size,
+            *(UINT32 *) (Tmp->Buffer),
+            *(UINT32 *) (&Tmp->Buffer[Tmp->Size + sizeof (UINT32)])
+            );
+        }
       }
     }
   }
@@ -170,10 +520,9 @@ MyAlloc (
 // *++
 // Description:
 //
-//  Allocate a new link in the allocation chain along with enough storage
+//  Allocate a new entry in the allocation table along with enough storage
 //  for the File[] string, requested Size and alignment overhead.  If
-//  memory cannot be allocated or the allocation chain has been corrupted,
-//  exit(1) will be called.
+//  memory cannot be allocated exit(1) will be called.
 //
 // Parameters:
 //
@@ -193,6 +542,8 @@ MyAlloc (
 {
   MY_ALLOC_STRUCT *Tmp;
   UINTN           Len;
+  UINTN           BlockSize;
+  UINTN           Bucket;
 
   //
   // Check for invalid parameters.
@@ -222,17 +573,21 @@ MyAlloc (
     exit (1);
   }
   //
-  // Check the allocation list for corruption.
+  // Make room for the new entry.  The rest of the table is not checked
+  // here, that would make every allocation walk every other one.  Each
+  // buffer is checked when it is freed, and MyCheck() checks them all.
   //
-  MyCheck (0, __FILE__, __LINE__);
+  MyAllocGrowTable ();
 
   //
   // Allocate a new entry.
   //
-  Tmp = calloc (
-          1,
-          sizeof (MY_ALLOC_STRUCT) + Len + 1 + sizeof (UINT64) + Size + (sizeof MyAllocHeadMagik) + (sizeof MyAllocTailMagik)
-          );
+  BlockSize = sizeof (MY_ALLOC_STRUCT) + Len + 1 + sizeof (UINT64) + Size + (sizeof MyAllocHeadMagik) + (sizeof MyAllocTailMagik);
+  if (MyAllocArenaMode) {
+    Tmp = MyAllocFromArena (BlockSize);
+  } else {
+    Tmp = calloc (1, BlockSize);
+  }
 
   if (Tmp == NULL) {
     printf (
@@ -246,13 +601,15 @@ MyAlloc (
     exit (1);
   }
   //
-  // Fill in the new entry.
+  // Fill in the new entry.  The caller's buffer follows the head signature
+  // on a 64-bit boundary after the __FILE__ string.
   //
   Tmp->File = ((UINT8 *) Tmp) + sizeof (MY_ALLOC_STRUCT);
   strcpy (Tmp->File, File);
   Tmp->Line   = Line;
   Tmp->Size   = Size;
-  Tmp->Buffer = (UINT8 *) (((UINTN) Tmp + Len + 9) &~7);
+  Tmp->Arena  = MyAllocArenaMode;
+  Tmp->Buffer = (UINT8 *) ((((UINTN) Tmp->File + Len + 1 + sizeof (UINT32) + 7) &~7) - sizeof (UINT32));
 
   memcpy (Tmp->Buffer, &MyAllocHeadMagik, sizeof MyAllocHeadMagik);
 
@@ -262,10 +619,24 @@ MyAlloc (
     sizeof MyAllocTailMagik
     );
 
-  Tmp->Next   = MyAllocData;
-  Tmp->Cksum  = (UINTN) Tmp + (UINTN) (Tmp->Next) + Tmp->Line + Tmp->Size + (UINTN) (Tmp->File) + (UINTN) (Tmp->Buffer);
+  Tmp->Cksum  = MyAllocChecksum (Tmp);
 
-  MyAllocData = Tmp;
+  Bucket                = MyAllocHash (&Tmp->Buffer[sizeof (UINT32)]);
+  Tmp->Next             = MyAllocTable[Bucket];
+  MyAllocTable[Bucket]  = Tmp;
+  MyAllocCount++;
+  if (Tmp->Arena) {
+    MyAllocArenaCount++;
+  }
+  //
+  // Update the statistics.
+  //
+  MyAllocTotalCount++;
+  MyAllocTotalBytes   += Size;
+  MyAllocCurrentBytes += Size;
+  if (MyAllocCurrentBytes > MyAllocPeakBytes) {
+    MyAllocPeakBytes = MyAllocCurrentBytes;
+  }
 
   return Tmp->Buffer + sizeof (UINT32);
 }
@@ -304,6 +675,7 @@ MyRealloc (
 // --*/
 //
 {
+  MY_ALLOC_STRUCT **Link;
   MY_ALLOC_STRUCT *Tmp;
   VOID            *Buffer;
 
@@ -336,29 +708,26 @@ MyRealloc (
     exit (1);
   }
   //
-  // Find existing buffer in allocation list.
+  // Find existing buffer in allocation table.
   //
   if (Ptr == NULL) {
     Tmp = NULL;
-  } else if (&MyAllocData->Buffer[sizeof (UINT32)] == Ptr) {
-    Tmp = MyAllocData;
   } else {
-    for (Tmp = MyAllocData;; Tmp = Tmp->Next) {
-      if (Tmp->Next == NULL) {
-        printf (
-          "\nMyRealloc(Ptr=%xh, Size=%u, File=%s, Line=%u)"
-          "\nCould not find buffer.\n",
-          Ptr,
-          Size,
-          File,
-          Line
-          );
-
-        exit (1);
-      }
+    Link = MyAllocFind (Ptr);
+    if (Link == NULL) {
+      printf (
+        "\nMyRealloc(Ptr=%xh, Size=%u, File=%s, Line=%u)"
+        "\nCould not find buffer.\n",
+        Ptr,
+        Size,
+        File,
+        Line
+        );
 
-      Tmp = Tmp->Next;
+      exit (1);
     }
+
+    Tmp = *Link;
   }
   //
   // Allocate new buffer, copy old data, free old buffer.
@@ -409,8 +778,8 @@ MyFree (
 // --*/
 //
 {
+  MY_ALLOC_STRUCT **Link;
   MY_ALLOC_STRUCT *Tmp;
-  MY_ALLOC_STRUCT *Tmp2;
 
   //
   // Check for invalid parameter(s).
@@ -447,7 +816,7 @@ MyFree (
   //
   // Fail if nothing is allocated.
   //
-  if (MyAllocData == NULL) {
+  if (MyAllocCount == 0) {
     printf (
       "\nMyFree(Ptr=%xh, File=%s, Line=%u)"
       "\nCalled before memory allocated.\n",
@@ -459,56 +828,88 @@ MyFree (
     exit (1);
   }
   //
-  // Check for corrupted allocation list.
+  // Look the buffer up in its hash bucket.
   //
-  MyCheck (0, __FILE__, __LINE__);
+  Link = MyAllocFind (Ptr);
+  if (Link == NULL) {
+    printf (
+      "\nMyFree(Ptr=%xh, File=%s, Line=%u)\n"
+      "\nNot found.\n",
+      Ptr,
+      File,
+      Line
+      );
+
+    exit (1);
+  }
+
+  Tmp = *Link;
 
   //
-  // Need special check for first item in list.
+  // Check the buffer for an overflow or underflow.
   //
-  if (&MyAllocData->Buffer[sizeof (UINT32)] == Ptr) {
-    //
-    // Unlink first item in list.
-    //
-    Tmp         = MyAllocData;
-    MyAllocData = MyAllocData->Next;
-  } else {
-    //
-    // Walk list looking for matching item.
-    //
-    for (Tmp = MyAllocData;; Tmp = Tmp->Next) {
-      //
-      // Fail if end of list is reached.
-      //
-      if (Tmp->Next == NULL) {
-        printf (
-          "\nMyFree(Ptr=%xh, File=%s, Line=%u)\n"
-          "\nNot found.\n",
-          Ptr,
-          File,
-          Line
-          );
-
-        exit (1);
-      }
-      //
-      // Leave loop when match is found.
-      //
-      if (&Tmp->Next->Buffer[sizeof (UINT32)] == Ptr) {
-        break;
-      }
-    }
-    //
-    // Unlink item from list.
-    //
-    Tmp2      = Tmp->Next;
-    Tmp->Next = Tmp->Next->Next;
-    Tmp       = Tmp2;
+  if (!MyAllocValid (Tmp)) {
+    printf (
+      "\nMyFree(Ptr=%xh, File=%s, Line=%u)""\nStructure corrupted!"
+      "\nFile=%s, Line=%u, nSize=%u, Head=%xh, Tail=%xh\n",
+      Ptr,
+      File,
+      Line,
+      Tmp->File,
+      Tmp->Line,
+      Tmp->Size,
+      *(UINT32 *) (Tmp->Buffer),
+      *(UINT32 *) (&Tmp->Buffer[Tmp->Size + sizeof (UINT32)])
+      );
+
+    exit (1);
   }
   //
-  // Release item.
+  // Unlink item from table.
+  //
+  *Link = Tmp->Next;
+  MyAllocCount--;
+  MyAllocCurrentBytes -= Tmp->Size;
+
+  //
+  // Release item.  Arena storage is only released at exit.
   //
-  free (Tmp);
+  if (Tmp->Arena) {
+    MyAllocArenaCount--;
+  } else {
+    free (Tmp);
+  }
+}
+//
+// ////////////////////////////////////////////////////////////////////////////
+//
+//
+VOID
+MyAllocArena (
+  BOOLEAN    Enable
+  )
+// *++
+// Description:
+//
+//  Switch arena mode on or off for the allocations that follow.  Arena
+//  allocations are carved from large slabs, are checked like any other
+//  allocation and may be freed, but their storage is only released when
+//  the program exits.  Unfreed arena allocations are not reported as
+//  leaks by MyCheck().
+//
+// Parameters:
+//
+//  Enable := TRUE to allocate from the arena, FALSE to go back to
+//            allocating each buffer separately.
+//
+// Returns:
+//
+//  n/a
+//
+// --*/
+//
+{
+  MyAllocArenaMode = Enable;
 }
 
 #endif /* USE_MYALLOC */
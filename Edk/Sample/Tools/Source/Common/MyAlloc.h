@@ -47,6 +47,7 @@ Abstract:
 #define realloc(ptr, size)  MyRealloc ((ptr), (size), __FILE__, __LINE__)
 #define free(ptr)           MyFree ((ptr), __FILE__, __LINE__)
 #define alloc_check(final)  MyCheck ((final), __FILE__, __LINE__)
+#define alloc_arena(enable) MyAllocArena ((enable))
 
 //
 // Structure for checking/tracking memory allocations.
@@ -58,12 +59,16 @@ typedef struct MyAllocStruct {
   UINTN                 Size;
   UINT8                 *File;
   UINT8                 *Buffer;
+  BOOLEAN               Arena;
 } MY_ALLOC_STRUCT;
 //
-// Cksum := (UINTN)This + (UINTN)Next + Line + Size + (UINTN)File +
-//          (UINTN)Buffer;
+// Cksum := (UINTN)This + Line + Size + (UINTN)File + (UINTN)Buffer +
+//          Arena;
 //
-// Next := Pointer to next allocation structure in the list.
+// Next := Pointer to next allocation structure in the same hash bucket.
+//         Allocations are hashed on the caller's buffer address so that
+//         MyFree() and MyRealloc() find them without walking every
+//         allocation.
 //
 // Line := __LINE__
 //
@@ -78,12 +83,35 @@ typedef struct MyAllocStruct {
 //           this will place the first caller address on a 64-bit
 //           boundary.
 //
+// Arena := TRUE if the allocation was carved from an arena slab.  See
+//          MyAllocArena().
+//
 //
 // Signatures used to check for buffer overflow/underflow conditions.
 //
 #define MYALLOC_HEAD_MAGIK  0xBADFACED
 #define MYALLOC_TAIL_MAGIK  0xDEADBEEF
 
+//
+// Initial number of hash buckets.  The table doubles whenever it holds
+// more than two allocations per bucket.
+//
+#define MYALLOC_HASH_SIZE   1024
+
+//
+// Size of the slabs arena allocations are carved from.  Larger arena
+// allocations get a slab of their own.
+//
+#define MYALLOC_SLAB_SIZE   (256 * 1024)
+
+//
+// If this environment variable names a file, a line with the tool name,
+// the number of allocations, the total bytes allocated, the peak bytes in
+// use and the bytes taken by arena slabs is appended to the file when the
+// tool exits.
+//
+#define MYALLOC_REPORT_ENV  "MYALLOC_REPORT"
+
 VOID
 MyCheck (
   BOOLEAN      Final,
@@ -103,7 +131,8 @@ MyCheck (
 //  Final := When FALSE, MyCheck() returns if the allocated memory chain
 //           has not been corrupted.  When TRUE, MyCheck() returns if there
 //           are no un-freed allocations.  If there are un-freed allocations,
-//           they are displayed and exit(1) is called.
+//           they are displayed and exit(1) is called.  The allocation
+//           statistics are displayed either way.
 //
 //
 //  File := Set to __FILE__ by macro expansion.
@@ -127,10 +156,11 @@ MyAlloc (
 // *++
 // Description:
 //
-//  Allocate a new link in the allocation chain along with enough storage
+//  Allocate a new entry in the allocation table along with enough storage
 //  for the File[] string, requested Size and alignment overhead.  If
-//  memory cannot be allocated or the allocation chain has been corrupted,
-//  exit(1) will be called.
+//  memory cannot be allocated exit(1) will be called.  Only MyFree() and
+//  MyCheck() check buffers for corruption, so allocating stays fast with
+//  many allocations outstanding.
 //
 // Parameters:
 //
@@ -191,7 +221,8 @@ MyFree (
 // *++
 // Description:
 //
-//  Release a previously allocated buffer.  Invalid parameters will cause
+//  Release a previously allocated buffer after checking it for overflow
+//  and underflow.  Invalid parameters or a corrupted buffer will cause
 //  MyFree() to fail with an exit(1) call.
 //
 // Parameters:
@@ -209,12 +240,40 @@ MyFree (
 //
 // --*/
 //
+VOID
+MyAllocArena (
+  BOOLEAN    Enable
+  )
+;
+//
+// *++
+// Description:
+//
+//  Switch arena mode on or off for the allocations that follow.  Arena
+//  allocations are carved from large slabs, are checked like any other
+//  allocation and may be freed, but their storage is only released when
+//  the program exits.  Unfreed arena allocations are not reported as
+//  leaks by MyCheck().  Use it around bulk, short lived allocations that
+//  the tool would otherwise leave for exit to clean up.
+//
+// Parameters:
+//
+//  Enable := TRUE to allocate from the arena, FALSE to go back to
+//            allocating each buffer separately.
+//
+// Returns:
+//
+//  n/a
+//
+// --*/
+//
 #else /* USE_MYALLOC */
 
 //
 // Nothing to do when USE_MYALLOC is zero.
 //
 #define alloc_check(final)
+#define alloc_arena(enable)
 
 #endif /* USE_MYALLOC */
 #endif /* _MYALLOC_H_ */
@@ -131,6 +131,455 @@ Returns:
   return InputBuffer;
 }
 
+//
+// Index of a MEMORY_FILE built by IndexInfFile. The file is read once into
+// an array of lines, and each section string queried is resolved to its
+// lines and a token hash the first time it is used. The lines are split
+// with the same ReadLine and strtok calls as the scanning code below, so
+// the results are the same as rescanning the file.
+//
+#define INF_INDEX_HASH_SIZE  64
+
+typedef struct {
+  CHAR8 *Text;      // The line with comments stripped
+  CHAR8 *Token;     // First token of the line, NULL for a blank line
+  CHAR8 *Value;     // The string following the =, NULL if there is none
+  CHAR8 *Next;      // File position following the line
+} INF_LINE;
+
+typedef struct _INF_TOKEN {
+  struct _INF_TOKEN   *Next;
+  CHAR8               *Name;
+  UINTN               Count;
+  UINTN               MaxCount;
+  CHAR8               **Value;    // Value of each instance in file order
+} INF_TOKEN;
+
+typedef struct _INF_SECTION {
+  struct _INF_SECTION *Next;
+  CHAR8               *Name;
+  BOOLEAN             Found;
+  BOOLEAN             ReadError;  // Section header is the last line
+  UINTN               Header;     // Line index of the section header
+  CHAR8               *Body;      // File position following the header
+  UINTN               EntryCount;
+  INF_LINE            **Entry;    // Non-blank lines of the section
+  INF_TOKEN           *Token[INF_INDEX_HASH_SIZE];
+} INF_SECTION;
+
+typedef struct _INF_INDEX {
+  struct _INF_INDEX   *Next;
+  MEMORY_FILE         *File;
+  CHAR8               *FileImage;
+  CHAR8               *Eof;
+  UINTN               LineCount;
+  INF_LINE            *Line;
+  INF_SECTION         *Section[INF_INDEX_HASH_SIZE];
+} INF_INDEX;
+
+STATIC INF_INDEX  *mInfIndexList = NULL;
+
+STATIC
+UINTN
+HashInfString (
+  IN CHAR8          *String
+  )
+/*++
+
+Routine Description:
+
+  Hash a section or token string into an index bucket.
+
+Arguments:
+
+  String        The string to hash.
+
+Returns:
+
+  The bucket number.
+
+--*/
+{
+  UINTN Hash;
+
+  Hash = 0;
+  while (*String != 0) {
+    Hash = Hash * 31 + (UINT8) *String;
+    String++;
+  }
+
+  return Hash % INF_INDEX_HASH_SIZE;
+}
+
+STATIC
+VOID
+FreeInfSection (
+  IN INF_SECTION    *InfSection
+  )
+/*++
+
+Routine Description:
+
+  Free a resolved section and its token hash.
+
+Arguments:
+
+  InfSection    The section to free.
+
+Returns:
+
+  None
+
+--*/
+{
+  INF_TOKEN *InfToken;
+  UINTN     Index;
+
+  for (Index = 0; Index < INF_INDEX_HASH_SIZE; Index++) {
+    while (InfSection->Token[Index] != NULL) {
+      InfToken                  = InfSection->Token[Index];
+      InfSection->Token[Index]  = InfToken->Next;
+      free (InfToken->Value);
+      free (InfToken);
+    }
+  }
+
+  free (InfSection->Entry);
+  free (InfSection->Name);
+  free (InfSection);
+}
+
+STATIC
+EFI_STATUS
+AddInfTokenValue (
+  IN INF_SECTION    *InfSection,
+  IN INF_LINE       *InfLine
+  )
+/*++
+
+Routine Description:
+
+  Record the value of a section line under its token.
+
+Arguments:
+
+  InfSection    The section the line belongs to.
+  InfLine       A non-blank line of the section.
+
+Returns:
+
+  EFI_SUCCESS           The value is recorded.
+  EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+--*/
+{
+  INF_TOKEN *InfToken;
+  CHAR8     **Value;
+  UINTN     Bucket;
+
+  Bucket = HashInfString (InfLine->Token);
+  for (InfToken = InfSection->Token[Bucket]; InfToken != NULL; InfToken = InfToken->Next) {
+    if (strcmp (InfToken->Name, InfLine->Token) == 0) {
+      break;
+    }
+  }
+
+  if (InfToken == NULL) {
+    InfToken = malloc (sizeof (INF_TOKEN));
+    if (InfToken == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    memset (InfToken, 0, sizeof (INF_TOKEN));
+    InfToken->Name            = InfLine->Token;
+    InfToken->Next            = InfSection->Token[Bucket];
+    InfSection->Token[Bucket] = InfToken;
+  }
+
+  if (InfToken->Count == InfToken->MaxCount) {
+    Value = realloc (InfToken->Value, (InfToken->MaxCount + 4) * sizeof (CHAR8 *));
+    if (Value == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    InfToken->Value     = Value;
+    InfToken->MaxCount += 4;
+  }
+
+  InfToken->Value[InfToken->Count++] = InfLine->Value;
+  return EFI_SUCCESS;
+}
+
+STATIC
+INF_SECTION *
+LookupInfSection (
+  IN MEMORY_FILE    *InputFile,
+  IN CHAR8          *Section
+  )
+/*++
+
+Routine Description:
+
+  Find the indexed section of a memory file, resolving the section string
+  against the indexed lines the first time it is queried.
+
+Arguments:
+
+  InputFile     Memory file image.
+  Section       The section to search for, a string within [].
+
+Returns:
+
+  The indexed section, whether it was found in the file or not.
+  NULL if the file is not indexed or memory allocation failed.
+
+--*/
+{
+  INF_INDEX   *InfIndex;
+  INF_SECTION *InfSection;
+  INF_LINE    *InfLine;
+  UINTN       Bucket;
+  UINTN       Index;
+
+  for (InfIndex = mInfIndexList; InfIndex != NULL; InfIndex = InfIndex->Next) {
+    if (InfIndex->File == InputFile &&
+        InfIndex->FileImage == InputFile->FileImage &&
+        InfIndex->Eof == InputFile->Eof
+        ) {
+      break;
+    }
+  }
+
+  if (InfIndex == NULL) {
+    return NULL;
+  }
+
+  Bucket = HashInfString (Section);
+  for (InfSection = InfIndex->Section[Bucket]; InfSection != NULL; InfSection = InfSection->Next) {
+    if (strcmp (InfSection->Name, Section) == 0) {
+      return InfSection;
+    }
+  }
+
+  InfSection = malloc (sizeof (INF_SECTION));
+  if (InfSection == NULL) {
+    return NULL;
+  }
+
+  memset (InfSection, 0, sizeof (INF_SECTION));
+  InfSection->Name = malloc (strlen (Section) + 1);
+  if (InfSection->Name == NULL) {
+    free (InfSection);
+    return NULL;
+  }
+
+  strcpy (InfSection->Name, Section);
+
+  //
+  // The section string may be anywhere within a line
+  //
+  for (Index = 0; Index < InfIndex->LineCount; Index++) {
+    if (strstr (InfIndex->Line[Index].Text, Section) != NULL) {
+      InfSection->Found   = TRUE;
+      InfSection->Header  = Index;
+      InfSection->Body    = InfIndex->Line[Index].Next;
+      break;
+    }
+  }
+
+  if (InfSection->Found) {
+    InfSection->ReadError = (BOOLEAN) (Index == InfIndex->LineCount - 1);
+    InfSection->Entry     = malloc ((InfIndex->LineCount - Index) * sizeof (INF_LINE *));
+    if (InfSection->Entry == NULL) {
+      FreeInfSection (InfSection);
+      return NULL;
+    }
+
+    for (Index++; Index < InfIndex->LineCount; Index++) {
+      InfLine = &InfIndex->Line[Index];
+      if (InfLine->Token == NULL) {
+        continue;
+      }
+
+      if (InfLine->Token[0] == '[') {
+        break;
+      }
+
+      InfSection->Entry[InfSection->EntryCount++] = InfLine;
+      if (EFI_ERROR (AddInfTokenValue (InfSection, InfLine))) {
+        FreeInfSection (InfSection);
+        return NULL;
+      }
+    }
+  }
+
+  InfSection->Next          = InfIndex->Section[Bucket];
+  InfIndex->Section[Bucket] = InfSection;
+  return InfSection;
+}
+
+EFI_STATUS
+IndexInfFile (
+  IN MEMORY_FILE    *InputFile
+  )
+/*++
+
+Routine Description:
+
+  Reads the memory file once and builds a section and token index for it.
+  Until FreeInfFileIndex is called, FindSection, FindToken and
+  FindTokenInstanceInSection answer queries on this file from the index
+  instead of rescanning the file image.
+
+Arguments:
+
+  InputFile     Memory file image. It must not change while it is indexed.
+
+Returns:
+
+  EFI_SUCCESS             The index is built.
+  EFI_INVALID_PARAMETER   Input argument was null.
+  EFI_OUT_OF_RESOURCES    Memory allocation failed.
+
+--*/
+{
+  CHAR8     InputBuffer[_MAX_PATH];
+  INF_INDEX *InfIndex;
+  INF_LINE  *InfLine;
+  INF_LINE  *Line;
+  CHAR8     *Text;
+  CHAR8     *CurrentToken;
+  UINTN     MaxLineCount;
+  UINTN     Length;
+
+  if (InputFile == NULL ||
+      InputFile->FileImage == NULL ||
+      InputFile->Eof == NULL ||
+      InputFile->CurrentFilePointer == NULL
+      ) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  FreeInfFileIndex (InputFile);
+
+  InfIndex = malloc (sizeof (INF_INDEX));
+  if (InfIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  memset (InfIndex, 0, sizeof (INF_INDEX));
+  InfIndex->File      = InputFile;
+  InfIndex->FileImage = InputFile->FileImage;
+  InfIndex->Eof       = InputFile->Eof;
+  MaxLineCount        = 0;
+
+  InputFile->CurrentFilePointer = InputFile->FileImage;
+  while (InputFile->CurrentFilePointer < InputFile->Eof) {
+    ReadLine (InputFile, InputBuffer, _MAX_PATH);
+
+    if (InfIndex->LineCount == MaxLineCount) {
+      Line = realloc (InfIndex->Line, (MaxLineCount * 2 + 64) * sizeof (INF_LINE));
+      if (Line == NULL) {
+        InfIndex->Next  = mInfIndexList;
+        mInfIndexList   = InfIndex;
+        FreeInfFileIndex (InputFile);
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      InfIndex->Line  = Line;
+      MaxLineCount    = MaxLineCount * 2 + 64;
+    }
+    //
+    // Keep the whole line for section matching, followed by a copy
+    // that is split into the token and its value.
+    //
+    Length  = strlen (InputBuffer) + 1;
+    Text    = malloc (Length * 2);
+    if (Text == NULL) {
+      InfIndex->Next  = mInfIndexList;
+      mInfIndexList   = InfIndex;
+      FreeInfFileIndex (InputFile);
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    memcpy (Text, InputBuffer, Length);
+    memcpy (Text + Length, InputBuffer, Length);
+
+    InfLine         = &InfIndex->Line[InfIndex->LineCount++];
+    InfLine->Text   = Text;
+    InfLine->Token  = NULL;
+    InfLine->Value  = NULL;
+    InfLine->Next   = InputFile->CurrentFilePointer;
+
+    CurrentToken = strtok (Text + Length, " \t\n");
+    if (CurrentToken != NULL) {
+      InfLine->Token  = CurrentToken;
+      InfLine->Value  = strtok (NULL, "= \t\n");
+    }
+  }
+
+  InputFile->CurrentFilePointer = InputFile->FileImage;
+
+  InfIndex->Next  = mInfIndexList;
+  mInfIndexList   = InfIndex;
+  return EFI_SUCCESS;
+}
+
+VOID
+FreeInfFileIndex (
+  IN MEMORY_FILE    *InputFile
+  )
+/*++
+
+Routine Description:
+
+  Frees the index built by IndexInfFile. Queries on the file scan the
+  file image again afterwards.
+
+Arguments:
+
+  InputFile     Memory file image.
+
+Returns:
+
+  None
+
+--*/
+{
+  INF_INDEX   **Link;
+  INF_INDEX   *InfIndex;
+  INF_SECTION *InfSection;
+  UINTN       Index;
+
+  for (Link = &mInfIndexList; *Link != NULL; Link = &(*Link)->Next) {
+    if ((*Link)->File == InputFile) {
+      break;
+    }
+  }
+
+  if (*Link == NULL) {
+    return;
+  }
+
+  InfIndex  = *Link;
+  *Link     = InfIndex->Next;
+
+  for (Index = 0; Index < INF_INDEX_HASH_SIZE; Index++) {
+    while (InfIndex->Section[Index] != NULL) {
+      InfSection                = InfIndex->Section[Index];
+      InfIndex->Section[Index]  = InfSection->Next;
+      FreeInfSection (InfSection);
+    }
+  }
+
+  for (Index = 0; Index < InfIndex->LineCount; Index++) {
+    free (InfIndex->Line[Index].Text);
+  }
+
+  free (InfIndex->Line);
+  free (InfIndex);
+}
+
 BOOLEAN
 FindSection (
   IN MEMORY_FILE    *InputFile,
@@ -155,8 +604,9 @@ Returns:
 
 --*/
 {
-  CHAR8 InputBuffer[_MAX_PATH];
-  CHAR8 *CurrentToken;
+  CHAR8       InputBuffer[_MAX_PATH];
+  CHAR8       *CurrentToken;
+  INF_SECTION *InfSection;
 
   //
   // Verify input is not NULL
@@ -166,6 +616,20 @@ Returns:
   assert (InputFile->CurrentFilePointer);
   assert (Section);
 
+  //
+  // Use the index if the file has one
+  //
+  InfSection = LookupInfSection (InputFile, Section);
+  if (InfSection != NULL) {
+    if (!InfSection->Found) {
+      InputFile->CurrentFilePointer = InputFile->Eof;
+      return FALSE;
+    }
+
+    InputFile->CurrentFilePointer = InfSection->Body;
+    return TRUE;
+  }
+
   //
   // Rewind to beginning of file
   //
@@ -224,11 +688,13 @@ Returns:
 
 --*/
 {
-  CHAR8   InputBuffer[_MAX_PATH];
-  CHAR8   *CurrentToken;
-  BOOLEAN ParseError;
-  BOOLEAN ReadError;
-  UINTN   Occurrance;
+  CHAR8       InputBuffer[_MAX_PATH];
+  CHAR8       *CurrentToken;
+  BOOLEAN     ParseError;
+  BOOLEAN     ReadError;
+  UINTN       Occurrance;
+  INF_SECTION *InfSection;
+  INF_TOKEN   *InfToken;
 
   //
   // Check input parameters
@@ -245,6 +711,35 @@ Returns:
     return EFI_INVALID_PARAMETER;
   }
   //
+  // Use the index if the file has one
+  //
+  InfSection = LookupInfSection (InputFile, Section);
+  if (InfSection != NULL) {
+    if (!InfSection->Found) {
+      return EFI_NOT_FOUND;
+    }
+
+    if (InfSection->ReadError) {
+      return EFI_LOAD_ERROR;
+    }
+
+    InfToken = InfSection->Token[HashInfString (Token)];
+    while (InfToken != NULL && strcmp (InfToken->Name, Token) != 0) {
+      InfToken = InfToken->Next;
+    }
+
+    if (InfToken == NULL || Instance >= InfToken->Count) {
+      return EFI_NOT_FOUND;
+    }
+
+    if (InfToken->Value[Instance] == NULL) {
+      return EFI_ABORTED;
+    }
+
+    strcpy (Value, InfToken->Value[Instance]);
+    return EFI_SUCCESS;
+  }
+  //
   // Initialize error codes
   //
   ParseError  = FALSE;
@@ -377,12 +872,13 @@ Returns:
 
 --*/
 {
-  CHAR8   InputBuffer[_MAX_PATH];
-  CHAR8   *CurrentToken;
-  CHAR8   *CurrentValue;
-  BOOLEAN ParseError;
-  BOOLEAN ReadError;
-  UINTN   InstanceIndex;
+  CHAR8       InputBuffer[_MAX_PATH];
+  CHAR8       *CurrentToken;
+  CHAR8       *CurrentValue;
+  BOOLEAN     ParseError;
+  BOOLEAN     ReadError;
+  UINTN       InstanceIndex;
+  INF_SECTION *InfSection;
 
   //
   // Check input parameters
@@ -397,6 +893,31 @@ Returns:
     return EFI_INVALID_PARAMETER;
   }
   //
+  // Use the index if the file has one
+  //
+  InfSection = LookupInfSection (InputFile, Section);
+  if (InfSection != NULL) {
+    if (!InfSection->Found) {
+      return EFI_NOT_FOUND;
+    }
+
+    if (InfSection->ReadError) {
+      return EFI_LOAD_ERROR;
+    }
+
+    if (Instance >= InfSection->EntryCount) {
+      return EFI_NOT_FOUND;
+    }
+
+    if (InfSection->Entry[Instance]->Value == NULL) {
+      return EFI_ABORTED;
+    }
+
+    strcpy (Token, InfSection->Entry[Instance]->Token);
+    strcpy (Value, InfSection->Entry[Instance]->Value);
+    return EFI_SUCCESS;
+  }
+  //
   // Initialize error codes
   //
   ParseError  = FALSE;
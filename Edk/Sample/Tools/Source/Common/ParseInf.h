@@ -162,6 +162,54 @@ Returns:
 
 --*/
 
+EFI_STATUS
+IndexInfFile (
+  IN MEMORY_FILE    *InputFile
+  )
+;
+/*++
+
+Routine Description:
+
+  Reads the memory file once and builds a section and token index for it.
+  Until FreeInfFileIndex is called, FindSection, FindToken and
+  FindTokenInstanceInSection answer queries on this file from the index
+  instead of rescanning the file image.
+
+Arguments:
+
+  InputFile     Memory file image. It must not change while it is indexed.
+
+Returns:
+
+  EFI_SUCCESS             The index is built.
+  EFI_INVALID_PARAMETER   Input argument was null.
+  EFI_OUT_OF_RESOURCES    Memory allocation failed.
+
+--*/
+
+VOID
+FreeInfFileIndex (
+  IN MEMORY_FILE    *InputFile
+  )
+;
+/*++
+
+Routine Description:
+
+  Frees the index built by IndexInfFile. Queries on the file scan the
+  file image again afterwards.
+
+Arguments:
+
+  InputFile     Memory file image.
+
+Returns:
+
+  None
+
+--*/
+
 EFI_STATUS
 StringToGuid (
   IN CHAR8        *AsciiGuidBuffer,
@@ -0,0 +1,628 @@
+/*++
+
+Copyright (c) 2009, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  SectionCache.c
+
+Abstract:
+
+  Content addressed cache of generated sections. Each section is saved in
+  its own file in the cache directory, named after a hash of the section
+  parameters and the input bytes. The directory also holds a statistics
+  file with the hit and miss counts and the size of the cache, which every
+  run of a tool updates when it closes the cache.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <process.h>    // for _getpid()
+#include <direct.h>     // for _mkdir()
+#include <io.h>         // for _findfirst()
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/utime.h>  // for _utime()
+
+#include "TianoCommon.h"
+#include "Crc32.h"
+#include "SectionCache.h"
+
+#define SECTION_CACHE_SIGNATURE       EFI_SIGNATURE_32 ('S', 'C', 'H', 'E')
+#define SECTION_CACHE_STATISTICS_FILE "Statistics.txt"
+
+//
+// Length of the name of a cache file, without the directory
+//
+#define SECTION_CACHE_NAME_LENGTH     (32 + sizeof (".sec") - 1)
+
+//
+// 64-bit FNV-1a offset basis
+//
+#define FNV_OFFSET_HIGH               0xCBF29CE4
+#define FNV_OFFSET_LOW                0x84222325
+
+//
+// Each cache file is this header followed by the section
+//
+typedef struct {
+  UINT32            Signature;
+  UINT32            OutputSize;
+  SECTION_CACHE_KEY Key;
+} SECTION_CACHE_ENTRY_HEADER;
+
+typedef struct {
+  CHAR8   Name[_MAX_PATH];
+  UINT32  Size;
+  time_t  Time;
+} SECTION_CACHE_FILE;
+
+static struct {
+  BOOLEAN Enabled;
+  CHAR8   Directory[_MAX_PATH];
+  UINT32  MaxSize;
+  UINT32  ToolTime;
+  UINT32  Hits;
+  UINT32  Misses;
+  UINT32  AddedSize;
+} mCache;
+
+static
+VOID
+SectionCacheHash (
+  IN UINT8      *Data,
+  IN UINT32     DataSize,
+  IN OUT UINT64 *Hash
+  )
+/*++
+
+Routine Description:
+
+  Continue a 64-bit FNV-1a hash over a block of data.
+
+Arguments:
+
+  Data      - Data to hash
+  DataSize  - Size of Data in bytes
+  Hash      - The hash so far, updated on return
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT64  Value;
+
+  Value = *Hash;
+  while (DataSize-- != 0) {
+    Value ^= *Data++;
+    //
+    // Multiply by the FNV prime, 2^40 + 0x1B3
+    //
+    Value = (Value << 40) + Value * 0x1B3;
+  }
+
+  *Hash = Value;
+}
+
+static
+VOID
+SectionCacheFileName (
+  IN SECTION_CACHE_KEY  *Key,
+  OUT CHAR8             *FileName
+  )
+/*++
+
+Routine Description:
+
+  Build the name of the cache file holding the section for a key.
+
+Arguments:
+
+  Key       - The key of the section
+  FileName  - Buffer of _MAX_PATH characters receiving the file name
+
+Returns:
+
+  None
+
+--*/
+{
+  sprintf (
+    FileName,
+    "%s\\%08X%08X%08X%08X.sec",
+    mCache.Directory,
+    Key->InputSize,
+    Key->InputCrc,
+    (UINT32) (Key->Hash >> 32),
+    (UINT32) Key->Hash
+    );
+}
+
+static
+EFI_STATUS
+SectionCacheReadFile (
+  IN CHAR8              *FileName,
+  IN SECTION_CACHE_KEY  *Key,
+  OUT UINT8             *Output,
+  IN OUT UINT32         *OutputSize
+  )
+/*++
+
+Routine Description:
+
+  Read the section from a cache file, checking that the file is complete
+  and was written for the same key.
+
+Arguments:
+
+  FileName    - The cache file
+  Key         - Key of the section looked for
+  Output      - Buffer to copy the section to
+  OutputSize  - On input the size of Output, on output the size of the section
+
+Returns:
+
+  EFI_SUCCESS           The section is copied to Output.
+  EFI_BUFFER_TOO_SMALL  Output is too small, OutputSize is the size needed.
+  EFI_NOT_FOUND         The file can't be used.
+
+--*/
+{
+  FILE                        *InFile;
+  SECTION_CACHE_ENTRY_HEADER  Header;
+  UINT8                       *Buffer;
+  long                        FileSize;
+  EFI_STATUS                  Status;
+
+  InFile = fopen (FileName, "rb");
+  if (InFile == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  Status = EFI_NOT_FOUND;
+  fseek (InFile, 0, SEEK_END);
+  FileSize = ftell (InFile);
+  fseek (InFile, 0, SEEK_SET);
+  if ((fread (&Header, sizeof (Header), 1, InFile) == 1) &&
+      (Header.Signature == SECTION_CACHE_SIGNATURE) &&
+      (memcmp (&Header.Key, Key, sizeof (SECTION_CACHE_KEY)) == 0) &&
+      ((UINT32) FileSize == sizeof (Header) + Header.OutputSize)
+      ) {
+    if (Header.OutputSize > *OutputSize) {
+      Status = EFI_BUFFER_TOO_SMALL;
+    } else {
+      //
+      // Output may be the input buffer, so don't touch it until the whole
+      // section has been read.
+      //
+      Buffer = (UINT8 *) malloc (Header.OutputSize + 1);
+      if (Buffer != NULL) {
+        if (fread (Buffer, 1, Header.OutputSize, InFile) == Header.OutputSize) {
+          memcpy (Output, Buffer, Header.OutputSize);
+          Status = EFI_SUCCESS;
+        }
+
+        free (Buffer);
+      }
+    }
+
+    *OutputSize = Header.OutputSize;
+  }
+
+  fclose (InFile);
+  return Status;
+}
+
+EFI_STATUS
+SectionCacheOpen (
+  IN CHAR8    *CacheDirectory,
+  IN UINT32   MaxSizeInMb
+  )
+/*++
+
+Routine Description:
+
+  Enable the section cache for this run of the tool.
+
+Arguments:
+
+  CacheDirectory  - Directory holding the cache, or NULL to use EFI_SECTION_CACHE
+  MaxSizeInMb     - Size the cache is trimmed to, or 0 to use EFI_SECTION_CACHE_SIZE
+
+Returns:
+
+  EFI_SUCCESS             The cache is enabled, or no cache was requested.
+  EFI_INVALID_PARAMETER   The directory name is too long.
+
+--*/
+{
+  CHAR8         *Value;
+  struct _stat  ToolStat;
+
+  memset (&mCache, 0, sizeof (mCache));
+  if (CacheDirectory == NULL) {
+    CacheDirectory = getenv (SECTION_CACHE_DIRECTORY_ENV);
+    if ((CacheDirectory == NULL) || (CacheDirectory[0] == 0)) {
+      return EFI_SUCCESS;
+    }
+  }
+  //
+  // Leave room for the cache file names
+  //
+  if (strlen (CacheDirectory) + 40 >= _MAX_PATH) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  strcpy (mCache.Directory, CacheDirectory);
+  if (MaxSizeInMb == 0) {
+    Value = getenv (SECTION_CACHE_SIZE_ENV);
+    if (Value != NULL) {
+      MaxSizeInMb = (UINT32) atoi (Value);
+    }
+
+    if (MaxSizeInMb == 0) {
+      MaxSizeInMb = SECTION_CACHE_DEFAULT_SIZE;
+    }
+  }
+  //
+  // Sizes are kept in a UINT32
+  //
+  if (MaxSizeInMb > 2047) {
+    MaxSizeInMb = 2047;
+  }
+
+  mCache.MaxSize  = MaxSizeInMb << 20;
+  //
+  // Sections made by an older build of the tool (or its compression
+  // library) must not be used, so the tool's timestamp goes into the keys.
+  //
+  if ((_pgmptr != NULL) && (_stat (_pgmptr, &ToolStat) == 0)) {
+    mCache.ToolTime = (UINT32) ToolStat.st_mtime;
+  }
+  //
+  // The directory may exist already
+  //
+  _mkdir (mCache.Directory);
+  mCache.Enabled  = TRUE;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+SectionCacheLookup (
+  IN  UINT8               *Input,
+  IN  UINT32              InputSize,
+  IN  CHAR8               *Parameters,
+  OUT SECTION_CACHE_KEY   *Key,
+  OUT UINT8               *Output,
+  IN OUT UINT32           *OutputSize
+  )
+/*++
+
+Routine Description:
+
+  Look for the section previously generated from the same input bytes and
+  parameters.
+
+Arguments:
+
+  Input       - The data the section is generated from
+  InputSize   - Size of Input in bytes
+  Parameters  - String naming everything besides Input that the section depends on
+  Key         - Returns the key to pass to SectionCacheInsert on a miss
+  Output      - Buffer to copy the cached section to. It may be Input.
+  OutputSize  - On input the size of Output, on output the size of the section
+
+Returns:
+
+  EFI_SUCCESS           The section was found in the cache.
+  EFI_BUFFER_TOO_SMALL  Output is too small, OutputSize is the size needed.
+  EFI_NOT_FOUND         The section is not cached, or the cache is disabled.
+
+--*/
+{
+  CHAR8       FileName[_MAX_PATH];
+  EFI_STATUS  Status;
+
+  memset (Key, 0, sizeof (SECTION_CACHE_KEY));
+  if (!mCache.Enabled) {
+    return EFI_NOT_FOUND;
+  }
+
+  Key->InputSize  = InputSize;
+  Key->Hash       = ((UINT64) FNV_OFFSET_HIGH << 32) | FNV_OFFSET_LOW;
+  //
+  // Hash the parameters with their terminator, so they can't run into the data
+  //
+  SectionCacheHash ((UINT8 *) &mCache.ToolTime, sizeof (mCache.ToolTime), &Key->Hash);
+  SectionCacheHash ((UINT8 *) Parameters, strlen (Parameters) + 1, &Key->Hash);
+  SectionCacheHash (Input, InputSize, &Key->Hash);
+  if (InputSize != 0) {
+    CalculateCrc32 (Input, InputSize, &Key->InputCrc);
+  }
+
+  SectionCacheFileName (Key, FileName);
+  Status = SectionCacheReadFile (FileName, Key, Output, OutputSize);
+  if (Status == EFI_NOT_FOUND) {
+    mCache.Misses++;
+  } else if (Status == EFI_SUCCESS) {
+    //
+    // Touch the file so eviction sees it as recently used
+    //
+    _utime (FileName, NULL);
+    mCache.Hits++;
+  }
+
+  return Status;
+}
+
+VOID
+SectionCacheInsert (
+  IN SECTION_CACHE_KEY    *Key,
+  IN UINT8                *Output,
+  IN UINT32               OutputSize
+  )
+/*++
+
+Routine Description:
+
+  Save a generated section in the cache. Failures are ignored.
+
+Arguments:
+
+  Key         - The key returned by SectionCacheLookup for the section input
+  Output      - The generated section
+  OutputSize  - Size of Output in bytes
+
+Returns:
+
+  None
+
+--*/
+{
+  CHAR8                       FileName[_MAX_PATH];
+  CHAR8                       TempFileName[_MAX_PATH];
+  FILE                        *OutFile;
+  SECTION_CACHE_ENTRY_HEADER  Header;
+  BOOLEAN                     Written;
+
+  if (!mCache.Enabled || (OutputSize > mCache.MaxSize)) {
+    return;
+  }
+
+  Header.Signature  = SECTION_CACHE_SIGNATURE;
+  Header.OutputSize = OutputSize;
+  memcpy (&Header.Key, Key, sizeof (SECTION_CACHE_KEY));
+  //
+  // Write a file of our own, then rename it, so a tool running in parallel
+  // never reads a partly written section.
+  //
+  SectionCacheFileName (Key, FileName);
+  sprintf (TempFileName, "%s.%d", FileName, _getpid ());
+  OutFile = fopen (TempFileName, "wb");
+  if (OutFile == NULL) {
+    return;
+  }
+
+  Written = (BOOLEAN) ((fwrite (&Header, sizeof (Header), 1, OutFile) == 1) &&
+                       (fwrite (Output, 1, OutputSize, OutFile) == OutputSize));
+  if (fclose (OutFile) != 0) {
+    Written = FALSE;
+  }
+
+  if (!Written || (rename (TempFileName, FileName) != 0)) {
+    //
+    // Out of disk space, or another tool added the same section first
+    //
+    remove (TempFileName);
+    return;
+  }
+
+  mCache.AddedSize += sizeof (Header) + OutputSize;
+}
+
+static
+int
+CompareCacheFileTime (
+  IN const void *Arg1,
+  IN const void *Arg2
+  )
+{
+  time_t  Time1;
+  time_t  Time2;
+
+  Time1 = ((SECTION_CACHE_FILE *) Arg1)->Time;
+  Time2 = ((SECTION_CACHE_FILE *) Arg2)->Time;
+  return (Time1 < Time2) ? -1 : ((Time1 > Time2) ? 1 : 0);
+}
+
+static
+UINT32
+SectionCacheEvict (
+  IN OUT UINT32   *CacheSize
+  )
+/*++
+
+Routine Description:
+
+  Delete the least recently used sections until the cache is down to three
+  quarters of its limit, so it isn't trimmed again by the next run.
+
+Arguments:
+
+  CacheSize   - Returns the size of the sections left in the cache
+
+Returns:
+
+  The number of sections deleted
+
+--*/
+{
+  CHAR8               Pattern[_MAX_PATH];
+  struct _finddata_t  FindData;
+  intptr_t            FindHandle;
+  SECTION_CACHE_FILE  *Files;
+  SECTION_CACHE_FILE  *NewFiles;
+  UINT32              FileCount;
+  UINT32              MaxFileCount;
+  UINT32              Index;
+  UINT32              Total;
+  UINT32              Evicted;
+
+  sprintf (Pattern, "%s\\*.sec", mCache.Directory);
+  FindHandle = _findfirst (Pattern, &FindData);
+  if (FindHandle == -1) {
+    *CacheSize = 0;
+    return 0;
+  }
+
+  Files         = NULL;
+  FileCount     = 0;
+  MaxFileCount  = 0;
+  Total         = 0;
+  do {
+    if (FileCount == MaxFileCount) {
+      MaxFileCount  = (MaxFileCount == 0) ? 256 : MaxFileCount * 2;
+      NewFiles      = (SECTION_CACHE_FILE *) realloc (Files, MaxFileCount * sizeof (SECTION_CACHE_FILE));
+      if (NewFiles == NULL) {
+        break;
+      }
+
+      Files = NewFiles;
+    }
+
+    //
+    // Leave files that were not written by the cache alone
+    //
+    if (strlen (FindData.name) != SECTION_CACHE_NAME_LENGTH) {
+      continue;
+    }
+
+    sprintf (Files[FileCount].Name, "%s\\%s", mCache.Directory, FindData.name);
+    Files[FileCount].Size = (UINT32) FindData.size;
+    Files[FileCount].Time = FindData.time_write;
+    Total += Files[FileCount].Size;
+    FileCount++;
+  } while (_findnext (FindHandle, &FindData) == 0);
+
+  _findclose (FindHandle);
+  Evicted = 0;
+  if (Total > mCache.MaxSize) {
+    qsort (Files, FileCount, sizeof (SECTION_CACHE_FILE), CompareCacheFileTime);
+    for (Index = 0; (Index < FileCount) && (Total > mCache.MaxSize / 4 * 3); Index++) {
+      if (remove (Files[Index].Name) == 0) {
+        Total -= Files[Index].Size;
+        Evicted++;
+      }
+    }
+  }
+
+  if (Files != NULL) {
+    free (Files);
+  }
+
+  *CacheSize = Total;
+  return Evicted;
+}
+
+VOID
+SectionCacheClose (
+  IN BOOLEAN    Verbose
+  )
+/*++
+
+Routine Description:
+
+  Add the hits and misses of this run to the statistics kept in the cache
+  directory and evict the least recently used sections if the cache has
+  grown past its size limit.
+
+Arguments:
+
+  Verbose     - Print the statistics of this run and of the cache.
+
+Returns:
+
+  None
+
+--*/
+{
+  CHAR8   FileName[_MAX_PATH];
+  FILE    *StatFile;
+  UINT32  Hits;
+  UINT32  Misses;
+  UINT32  Evictions;
+  UINT32  CacheSize;
+
+  if (!mCache.Enabled) {
+    return;
+  }
+  //
+  // Tools running in parallel may update the statistics at the same time,
+  // so the counts are only a guide. The cache size is corrected whenever
+  // the cache is trimmed.
+  //
+  Hits      = 0;
+  Misses    = 0;
+  Evictions = 0;
+  CacheSize = 0;
+  sprintf (FileName, "%s\\%s", mCache.Directory, SECTION_CACHE_STATISTICS_FILE);
+  StatFile = fopen (FileName, "r");
+  if (StatFile != NULL) {
+    if (fscanf (
+          StatFile,
+          "Hits=%u Misses=%u Evictions=%u Size=%u",
+          &Hits,
+          &Misses,
+          &Evictions,
+          &CacheSize
+          ) != 4) {
+      Hits      = 0;
+      Misses    = 0;
+      Evictions = 0;
+      CacheSize = 0;
+    }
+
+    fclose (StatFile);
+  }
+
+  Hits      += mCache.Hits;
+  Misses    += mCache.Misses;
+  CacheSize += mCache.AddedSize;
+  if (CacheSize > mCache.MaxSize) {
+    Evictions += SectionCacheEvict (&CacheSize);
+  }
+
+  if ((mCache.Hits != 0) || (mCache.Misses != 0)) {
+    StatFile = fopen (FileName, "w");
+    if (StatFile != NULL) {
+      fprintf (StatFile, "Hits=%u\nMisses=%u\nEvictions=%u\nSize=%u\n", Hits, Misses, Evictions, CacheSize);
+      fclose (StatFile);
+    }
+  }
+
+  if (Verbose) {
+    fprintf (
+      stdout,
+      "Section cache: %u hits, %u misses. Cache totals: %u hits, %u misses, %u evictions, %u bytes\n",
+      mCache.Hits,
+      mCache.Misses,
+      Hits,
+      Misses,
+      Evictions,
+      CacheSize
+      );
+  }
+
+  mCache.Enabled = FALSE;
+}
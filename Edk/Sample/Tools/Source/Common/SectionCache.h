@@ -0,0 +1,164 @@
+/*++
+
+Copyright (c) 2009, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  SectionCache.h
+
+Abstract:
+
+  Header file for the content addressed cache of generated sections that
+  is shared by the section and FFS file generation tools.
+
+--*/
+
+#ifndef _SECTION_CACHE_H
+#define _SECTION_CACHE_H
+
+#include "TianoCommon.h"
+
+//
+// Environment variables used when the tool is not given a cache directory.
+// The size is in megabytes.
+//
+#define SECTION_CACHE_DIRECTORY_ENV   "EFI_SECTION_CACHE"
+#define SECTION_CACHE_SIZE_ENV        "EFI_SECTION_CACHE_SIZE"
+#define SECTION_CACHE_DEFAULT_SIZE    256
+
+//
+// Identifies the input of a cached section. The hash covers the section
+// parameters and the input bytes, the CRC and size the input bytes only.
+//
+typedef struct {
+  UINT32  InputSize;
+  UINT32  InputCrc;
+  UINT64  Hash;
+} SECTION_CACHE_KEY;
+
+EFI_STATUS
+SectionCacheOpen (
+  IN CHAR8    *CacheDirectory,
+  IN UINT32   MaxSizeInMb
+  )
+;
+
+/*++
+
+Routine Description:
+
+  Enable the section cache for this run of the tool.
+
+Arguments:
+
+  CacheDirectory  - Directory holding the cache. If NULL, the directory named
+                    by the EFI_SECTION_CACHE environment variable is used, and
+                    if that is not set the cache stays disabled.
+  MaxSizeInMb     - Size the cache is trimmed to. If 0, the value of the
+                    EFI_SECTION_CACHE_SIZE environment variable is used, or
+                    SECTION_CACHE_DEFAULT_SIZE.
+
+Returns:
+
+  EFI_SUCCESS             The cache is enabled, or no cache was requested.
+  EFI_INVALID_PARAMETER   The directory name is too long.
+
+--*/
+
+EFI_STATUS
+SectionCacheLookup (
+  IN  UINT8               *Input,
+  IN  UINT32              InputSize,
+  IN  CHAR8               *Parameters,
+  OUT SECTION_CACHE_KEY   *Key,
+  OUT UINT8               *Output,
+  IN OUT UINT32           *OutputSize
+  )
+;
+
+/*++
+
+Routine Description:
+
+  Look for the section previously generated from the same input bytes and
+  parameters.
+
+Arguments:
+
+  Input       - The data the section is generated from
+  InputSize   - Size of Input in bytes
+  Parameters  - String naming everything besides Input that the section
+                depends on, such as the section and compression types
+  Key         - Returns the key to pass to SectionCacheInsert on a miss
+  Output      - Buffer to copy the cached section to. It may be the same
+                buffer as Input, which is only overwritten on a hit.
+  OutputSize  - On input the size of Output. Returns the size of the
+                cached section.
+
+Returns:
+
+  EFI_SUCCESS           The section was found in the cache.
+  EFI_BUFFER_TOO_SMALL  Output is too small, OutputSize is the size needed.
+  EFI_NOT_FOUND         The section is not cached, or the cache is disabled.
+
+--*/
+
+VOID
+SectionCacheInsert (
+  IN SECTION_CACHE_KEY    *Key,
+  IN UINT8                *Output,
+  IN UINT32               OutputSize
+  )
+;
+
+/*++
+
+Routine Description:
+
+  Save a generated section in the cache. Failures are ignored, the cache
+  never fails the build.
+
+Arguments:
+
+  Key         - The key returned by SectionCacheLookup for the section input
+  Output      - The generated section
+  OutputSize  - Size of Output in bytes
+
+Returns:
+
+  None
+
+--*/
+
+VOID
+SectionCacheClose (
+  IN BOOLEAN    Verbose
+  )
+;
+
+/*++
+
+Routine Description:
+
+  Add the hits and misses of this run to the statistics kept in the cache
+  directory and evict the least recently used sections if the cache has
+  grown past its size limit.
+
+Arguments:
+
+  Verbose     - Print the statistics of this run and of the cache.
+
+Returns:
+
+  None
+
+--*/
+
+#endif
@@ -0,0 +1,867 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  ParseInfTest.c
+
+Abstract:
+
+  Test and benchmark for the INF memory file index in ParseInf.c.
+
+  The test generates a platform FV INF and a GenFfsFile package file, runs
+  FindSection, FindToken and FindTokenInstanceInSection queries on them
+  without an index, then with the index built by IndexInfFile, then again
+  after FreeInfFileIndex, and checks that every query returns the same
+  status, value and file position each time. The INF has comments, blank
+  lines, repeated tokens, tokens without a value and a section that is
+  the last line of the file.
+
+  With -b the program times the lookups ParseFvInf in GenFvImage makes on
+  FV INFs of 100 to 4000 files, with and without the index.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ParseInf.h"
+
+#define TEST_FILES          300
+#define TEST_COMPONENTS     8
+#define TEST_MAX_INSTANCE   (TEST_FILES + 4)
+
+//
+// Section and token strings used by GenFvImage
+//
+static CHAR8  *mSections[] = {
+  "[options]",
+  "[attributes]",
+  "[files]",
+  "[components]",
+  "[last]",
+  "[nosuch]",
+  "[",
+  "options"
+};
+
+static CHAR8  *mTokens[] = {
+  "EFI_BASE_ADDRESS",
+  "EFI_FILE_NAME",
+  "EFI_SYM_FILE_NAME",
+  "EFI_NUM_BLOCKS",
+  "EFI_BLOCK_SIZE",
+  "EFI_FV_GUID",
+  "EFI_READ_STATUS",
+  "EFI_WRITE_STATUS",
+  "EFI_ERASE_POLARITY",
+  "EFI_ALIGNMENT_64K",
+  "EFI_NO_VALUE",
+  "EFI_FILE_NAME=Build\\Packed.ffs",
+  "NOSUCH"
+};
+
+static CHAR8  *mAttributes[] = {
+  "EFI_READ_DISABLED_CAP",
+  "EFI_READ_ENABLED_CAP",
+  "EFI_READ_STATUS",
+  "EFI_WRITE_DISABLED_CAP",
+  "EFI_WRITE_ENABLED_CAP",
+  "EFI_WRITE_STATUS",
+  "EFI_LOCK_CAP",
+  "EFI_LOCK_STATUS",
+  "EFI_STICKY_WRITE",
+  "EFI_MEMORY_MAPPED",
+  "EFI_ERASE_POLARITY",
+  "EFI_READ_LOCK_CAP",
+  "EFI_READ_LOCK_STATUS",
+  "EFI_WRITE_LOCK_CAP",
+  "EFI_WRITE_LOCK_STATUS",
+  "EFI_ALIGNMENT_CAP",
+  "EFI_ALIGNMENT_2",
+  "EFI_ALIGNMENT_4",
+  "EFI_ALIGNMENT_8",
+  "EFI_ALIGNMENT_16",
+  "EFI_ALIGNMENT_32",
+  "EFI_ALIGNMENT_64",
+  "EFI_ALIGNMENT_128",
+  "EFI_ALIGNMENT_256",
+  "EFI_ALIGNMENT_512",
+  "EFI_ALIGNMENT_1K",
+  "EFI_ALIGNMENT_2K",
+  "EFI_ALIGNMENT_4K",
+  "EFI_ALIGNMENT_8K",
+  "EFI_ALIGNMENT_16K",
+  "EFI_ALIGNMENT_32K",
+  "EFI_ALIGNMENT_64K"
+};
+
+#define COUNT_OF(Array)  (sizeof (Array) / sizeof ((Array)[0]))
+
+//
+// The result of one query
+//
+typedef struct {
+  EFI_STATUS  Status;
+  UINTN       Position;
+  UINT32      Crc;
+} TEST_RESULT;
+
+static UINTN  mFailures = 0;
+
+static
+VOID
+Check (
+  IN BOOLEAN  Condition,
+  IN char     *Test,
+  IN char     *What
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Condition - The result of the check
+  Test      - Name of the test
+  What      - The condition that was checked
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Condition) {
+    return ;
+  }
+
+  if (mFailures < 20) {
+    printf ("FAIL: %s: %s\n", Test, What);
+  }
+
+  mFailures++;
+}
+
+static
+UINT32
+Crc32 (
+  IN UINT32   Crc,
+  IN CHAR8    *String
+  )
+/*++
+
+Routine Description:
+
+  Continue a CRC32 over a null terminated string, including the null.
+
+Arguments:
+
+  Crc     - CRC of the data before the string
+  String  - The string
+
+Returns:
+
+  The updated CRC.
+
+--*/
+{
+  UINTN   Bit;
+
+  Crc = ~Crc;
+  do {
+    Crc ^= (UINT8) *String;
+    for (Bit = 0; Bit < 8; Bit++) {
+      Crc = (Crc >> 1) ^ (0xEDB88320 & (0 - (Crc & 1)));
+    }
+  } while (*String++ != 0);
+
+  return ~Crc;
+}
+
+static
+CHAR8 *
+Append (
+  IN OUT CHAR8  *End,
+  IN     CHAR8  *Line
+  )
+/*++
+
+Routine Description:
+
+  Append a line and a CR LF to a file image.
+
+Arguments:
+
+  End   - End of the image so far
+  Line  - The line to append
+
+Returns:
+
+  The new end of the image.
+
+--*/
+{
+  strcpy (End, Line);
+  End += strlen (Line);
+  *End++ = '\r';
+  *End++ = '\n';
+  *End = 0;
+  return End;
+}
+
+static
+VOID
+OpenImage (
+  OUT MEMORY_FILE   *File,
+  IN  CHAR8         *Image
+  )
+/*++
+
+Routine Description:
+
+  Make a memory file of a null terminated image.
+
+Arguments:
+
+  File  - The memory file
+  Image - The file image
+
+Returns:
+
+  None
+
+--*/
+{
+  File->FileImage           = Image;
+  File->Eof                 = Image + strlen (Image);
+  File->CurrentFilePointer  = Image;
+}
+
+static
+CHAR8 *
+BuildFvInf (
+  IN UINTN    FileCount,
+  IN BOOLEAN  Tricky
+  )
+/*++
+
+Routine Description:
+
+  Generate a platform FV INF like the ones the build feeds GenFvImage.
+
+Arguments:
+
+  FileCount - Number of EFI_FILE_NAME lines in [files]
+  Tricky    - Add comments, blank lines, repeated tokens and tokens
+              without a value
+
+Returns:
+
+  The null terminated image, to be freed by the caller.
+
+--*/
+{
+  CHAR8   *Image;
+  CHAR8   *End;
+  CHAR8   Line[_MAX_PATH];
+  UINTN   Index;
+
+  Image = malloc (4096 + FileCount * 96 + COUNT_OF (mAttributes) * 64);
+  if (Image == NULL) {
+    printf ("ParseInfTest: out of memory\n");
+    exit (1);
+  }
+
+  End = Image;
+  End = Append (End, "// Generated FV INF");
+  End = Append (End, "[options]");
+  End = Append (End, "EFI_BASE_ADDRESS = 0xFFF00000");
+  End = Append (End, "EFI_FILE_NAME = FvMain.fv");
+  End = Append (End, "EFI_SYM_FILE_NAME = FvMain.sym");
+  End = Append (End, "EFI_NUM_BLOCKS = 0x10");
+  End = Append (End, "EFI_BLOCK_SIZE = 0x10000");
+  if (Tricky) {
+    End = Append (End, "EFI_NUM_BLOCKS=0x20   // second block map");
+    End = Append (End, "   ");
+    End = Append (End, "EFI_BLOCK_SIZE    =    0x1000");
+    End = Append (End, "EFI_NO_VALUE");
+    End = Append (End, "EFI_FV_GUID = 7A9354D9-0468-444a-81CE-0BF617D890DF");
+  }
+
+  End = Append (End, "");
+  End = Append (End, "[attributes]");
+  for (Index = 0; Index < COUNT_OF (mAttributes); Index++) {
+    sprintf (Line, "%s = %s", mAttributes[Index], (Index % 3) ? "TRUE" : "FALSE");
+    End = Append (End, Line);
+  }
+
+  End = Append (End, "");
+  End = Append (End, "[files]");
+  for (Index = 0; Index < FileCount; Index++) {
+    if (Tricky && (Index % 7) == 3) {
+      End = Append (End, "// EFI_FILE_NAME = Build\\Commented.ffs");
+    }
+
+    if (Tricky && (Index % 11) == 5) {
+      End = Append (End, "");
+    }
+
+    if (Tricky && Index == FileCount / 2) {
+      End = Append (End, "EFI_FILE_NAME=Build\\Packed.ffs");
+    }
+
+    sprintf (
+      Line,
+      "EFI_FILE_NAME = Build\\IA32\\%08X-0000-0000-0000-%012X-Driver%u.ffs%s",
+      (unsigned) (Index * 2654435761U),
+      (unsigned) Index,
+      (unsigned) Index,
+      (Tricky && (Index % 5) == 1) ? "   // trailing comment" : ""
+      );
+    End = Append (End, Line);
+  }
+
+  End = Append (End, "[components]");
+  for (Index = 0; Index < TEST_COMPONENTS; Index++) {
+    sprintf (Line, "Component%u = 0x%x", (unsigned) Index, (unsigned) (Index * 0x1000));
+    End = Append (End, Line);
+  }
+
+  if (Tricky) {
+    End = Append (End, "NoValueComponent");
+    //
+    // A section header on the last line of the file is a read error
+    //
+    strcpy (End, "[last]\r\n");
+  }
+
+  return Image;
+}
+
+static
+CHAR8 *
+BuildPackage (
+  IN BOOLEAN  CrLf
+  )
+/*++
+
+Routine Description:
+
+  Generate a GenFfsFile package file. GenFfsFile finds its [.] section
+  in the indexed package image.
+
+Arguments:
+
+  CrLf  - TRUE for CR LF line ends, FALSE for LF
+
+Returns:
+
+  The null terminated image, to be freed by the caller.
+
+--*/
+{
+  static CHAR8  *Lines[] = {
+    "PACKAGE.INF",
+    "// a [.] in a comment is not a section",
+    "[.]",
+    "BASE_NAME                   = Driver",
+    "FFS_FILEGUID                = 7A9354D9-0468-444a-81CE-0BF617D890DF",
+    "FFS_FILETYPE                = EFI_FV_FILETYPE_DRIVER",
+    "FFS_ATTRIB_CHECKSUM         = TRUE",
+    "IMAGE_SCRIPT =",
+    "{",
+    "  Compress (dummy) {",
+    "    Driver.pe32",
+    "  }",
+    "}"
+  };
+  CHAR8         *Image;
+  CHAR8         *End;
+  UINTN         Index;
+
+  Image = malloc (1024);
+  if (Image == NULL) {
+    printf ("ParseInfTest: out of memory\n");
+    exit (1);
+  }
+
+  End = Image;
+  for (Index = 0; Index < COUNT_OF (Lines); Index++) {
+    strcpy (End, Lines[Index]);
+    End += strlen (Lines[Index]);
+    if (CrLf) {
+      *End++ = '\r';
+    }
+
+    *End++ = '\n';
+  }
+
+  *End = 0;
+  return Image;
+}
+
+static
+UINTN
+RunQueries (
+  IN  MEMORY_FILE   *File,
+  OUT TEST_RESULT   *Result
+  )
+/*++
+
+Routine Description:
+
+  Run every FindSection, FindToken and FindTokenInstanceInSection query
+  of the test on a memory file and record the results.
+
+Arguments:
+
+  File    - The memory file
+  Result  - Receives the result of each query, or NULL to just run them
+
+Returns:
+
+  The number of queries.
+
+--*/
+{
+  CHAR8       Token[_MAX_PATH];
+  CHAR8       Value[_MAX_PATH];
+  UINTN       Count;
+  UINTN       Section;
+  UINTN       Index;
+  UINTN       Instance;
+  EFI_STATUS  Status;
+
+  Count = 0;
+  for (Section = 0; Section < COUNT_OF (mSections); Section++) {
+    Status = FindSection (File, mSections[Section]) ? EFI_SUCCESS : EFI_NOT_FOUND;
+    if (Result != NULL) {
+      Result[Count].Status    = Status;
+      Result[Count].Position  = File->CurrentFilePointer - File->FileImage;
+      Result[Count].Crc       = 0;
+    }
+
+    Count++;
+
+    for (Index = 0; Index < COUNT_OF (mTokens); Index++) {
+      for (Instance = 0; Instance < TEST_MAX_INSTANCE; Instance++) {
+        strcpy (Value, "unchanged");
+        Status = FindToken (File, mSections[Section], mTokens[Index], Instance, Value);
+        if (Result != NULL) {
+          Result[Count].Status    = Status;
+          Result[Count].Position  = 0;
+          Result[Count].Crc       = Crc32 (0, Value);
+        }
+
+        Count++;
+        if (Status == EFI_NOT_FOUND && Instance > 2) {
+          break;
+        }
+      }
+    }
+
+    for (Instance = 0; Instance < TEST_MAX_INSTANCE; Instance++) {
+      strcpy (Token, "unchanged");
+      strcpy (Value, "unchanged");
+      Status = FindTokenInstanceInSection (File, mSections[Section], Instance, Token, Value);
+      if (Result != NULL) {
+        Result[Count].Status    = Status;
+        Result[Count].Position  = 0;
+        Result[Count].Crc       = Crc32 (Crc32 (0, Token), Value);
+      }
+
+      Count++;
+      if (Status == EFI_NOT_FOUND && Instance > 2) {
+        break;
+      }
+    }
+  }
+
+  return Count;
+}
+
+static
+VOID
+CompareQueries (
+  IN MEMORY_FILE    *File,
+  IN char           *Test,
+  IN UINTN          MinFound
+  )
+/*++
+
+Routine Description:
+
+  Check that the queries give the same results without the index, with
+  it and after it is freed.
+
+Arguments:
+
+  File      - The memory file
+  Test      - Name of the test
+  MinFound  - Number of queries that should at least succeed
+
+Returns:
+
+  None
+
+--*/
+{
+  TEST_RESULT *Scan;
+  TEST_RESULT *Indexed;
+  TEST_RESULT *Freed;
+  UINTN       Count;
+  UINTN       Index;
+  UINTN       Found;
+
+  Count   = RunQueries (File, NULL);
+  Scan    = malloc (Count * sizeof (TEST_RESULT));
+  Indexed = malloc (Count * sizeof (TEST_RESULT));
+  Freed   = malloc (Count * sizeof (TEST_RESULT));
+  if (Scan == NULL || Indexed == NULL || Freed == NULL) {
+    printf ("ParseInfTest: out of memory\n");
+    exit (1);
+  }
+
+  RunQueries (File, Scan);
+
+  Check ((BOOLEAN) (IndexInfFile (File) == EFI_SUCCESS), Test, "IndexInfFile succeeds");
+  Check ((BOOLEAN) (RunQueries (File, Indexed) == Count), Test, "same number of indexed queries");
+  //
+  // Indexing again replaces the old index
+  //
+  Check ((BOOLEAN) (IndexInfFile (File) == EFI_SUCCESS), Test, "IndexInfFile succeeds twice");
+  Check ((BOOLEAN) (RunQueries (File, Indexed) == Count), Test, "same number of reindexed queries");
+  FreeInfFileIndex (File);
+  FreeInfFileIndex (File);
+  Check ((BOOLEAN) (RunQueries (File, Freed) == Count), Test, "same number of queries after free");
+
+  Found = 0;
+  for (Index = 0; Index < Count; Index++) {
+    Check (
+      (BOOLEAN) (Scan[Index].Status == Indexed[Index].Status &&
+                 Scan[Index].Position == Indexed[Index].Position &&
+                 Scan[Index].Crc == Indexed[Index].Crc),
+      Test,
+      "indexed query matches the scan"
+      );
+    Check (
+      (BOOLEAN) (Scan[Index].Status == Freed[Index].Status &&
+                 Scan[Index].Position == Freed[Index].Position &&
+                 Scan[Index].Crc == Freed[Index].Crc),
+      Test,
+      "query after FreeInfFileIndex matches the scan"
+      );
+    if (Scan[Index].Status == EFI_SUCCESS) {
+      Found++;
+    }
+  }
+  //
+  // Make sure the queries do find things
+  //
+  Check ((BOOLEAN) (Found >= MinFound), Test, "queries find the tokens");
+
+  free (Scan);
+  free (Indexed);
+  free (Freed);
+}
+
+static
+VOID
+TestFvInf (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Compare the indexed and scanned queries on generated FV INFs.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  MEMORY_FILE Inf;
+  MEMORY_FILE Other;
+  CHAR8       *Image;
+  CHAR8       *OtherImage;
+  CHAR8       Value[_MAX_PATH];
+
+  Image = BuildFvInf (TEST_FILES, FALSE);
+  OpenImage (&Inf, Image);
+  CompareQueries (&Inf, "FV INF", TEST_FILES);
+  free (Image);
+
+  Image = BuildFvInf (TEST_FILES, TRUE);
+  OpenImage (&Inf, Image);
+  CompareQueries (&Inf, "FV INF with comments and odd lines", TEST_FILES);
+
+  //
+  // Only the indexed file is answered from the index
+  //
+  OtherImage = BuildFvInf (3, FALSE);
+  OpenImage (&Other, OtherImage);
+  IndexInfFile (&Inf);
+  Check (
+    (BOOLEAN) (FindToken (&Other, "[files]", "EFI_FILE_NAME", 3, Value) == EFI_NOT_FOUND),
+    "Two files",
+    "the other file is not answered from the index"
+    );
+  Check (
+    (BOOLEAN) (FindToken (&Inf, "[files]", "EFI_FILE_NAME", 3, Value) == EFI_SUCCESS),
+    "Two files",
+    "the indexed file is answered"
+    );
+  FreeInfFileIndex (&Other);
+  Check (
+    (BOOLEAN) (FindToken (&Inf, "[files]", "EFI_FILE_NAME", 3, Value) == EFI_SUCCESS),
+    "Two files",
+    "freeing the other file keeps the index"
+    );
+  FreeInfFileIndex (&Inf);
+
+  free (OtherImage);
+  free (Image);
+}
+
+static
+VOID
+TestPackage (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check the [.] lookup GenFfsFile makes on its package file.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  MEMORY_FILE Package;
+  CHAR8       *Image;
+  BOOLEAN     Found;
+
+  Image = BuildPackage (TRUE);
+  OpenImage (&Package, Image);
+  IndexInfFile (&Package);
+  Found = FindSection (&Package, "[.]");
+  Check (Found, "Package", "[.] is found");
+  Check (
+    (BOOLEAN) (Found && strncmp (Package.CurrentFilePointer, "BASE_NAME ", 10) == 0),
+    "Package",
+    "the file position follows the [.] line"
+    );
+  FreeInfFileIndex (&Package);
+  Check (
+    (BOOLEAN) (FindSection (&Package, "[.]") && strncmp (Package.CurrentFilePointer, "BASE_NAME ", 10) == 0),
+    "Package",
+    "the scan stops at the same place"
+    );
+  CompareQueries (&Package, "Package", 6);
+  free (Image);
+
+  //
+  // ReadLine drops the last character of each line as the CR, so neither
+  // the scan nor the index finds "[.]" with LF line ends. GenFfsFile falls
+  // back to reading the package file token by token then.
+  //
+  Image = BuildPackage (FALSE);
+  OpenImage (&Package, Image);
+  Check ((BOOLEAN) !FindSection (&Package, "[.]"), "LF package", "the scan does not find [.]");
+  IndexInfFile (&Package);
+  Check ((BOOLEAN) !FindSection (&Package, "[.]"), "LF package", "the index does not find [.]");
+  FreeInfFileIndex (&Package);
+  free (Image);
+}
+
+static
+UINTN
+ParseLikeGenFvImage (
+  IN MEMORY_FILE    *Inf
+  )
+/*++
+
+Routine Description:
+
+  Make the lookups ParseFvInf makes: the options and attributes once each,
+  the block map pairs and then every file name in turn.
+
+Arguments:
+
+  Inf - The FV INF
+
+Returns:
+
+  The number of files found.
+
+--*/
+{
+  CHAR8   Value[_MAX_PATH];
+  CHAR8   Token[_MAX_PATH];
+  UINTN   Index;
+
+  FindToken (Inf, "[options]", "EFI_BASE_ADDRESS", 0, Value);
+  FindToken (Inf, "[options]", "EFI_FV_GUID", 0, Value);
+  FindToken (Inf, "[options]", "EFI_FILE_NAME", 0, Value);
+  FindToken (Inf, "[options]", "EFI_SYM_FILE_NAME", 0, Value);
+  for (Index = 0; Index < COUNT_OF (mAttributes); Index++) {
+    FindToken (Inf, "[attributes]", mAttributes[Index], 0, Value);
+  }
+
+  for (Index = 0; FindToken (Inf, "[options]", "EFI_NUM_BLOCKS", Index, Value) == EFI_SUCCESS; Index++) {
+    FindToken (Inf, "[options]", "EFI_BLOCK_SIZE", Index, Value);
+  }
+
+  FindToken (Inf, "[options]", "EFI_BLOCK_SIZE", Index, Value);
+
+  for (Index = 0; FindToken (Inf, "[files]", "EFI_FILE_NAME", Index, Value) == EFI_SUCCESS; Index++) {
+    ;
+  }
+
+  if (FindSection (Inf, "[components]")) {
+    while (FindTokenInstanceInSection (Inf, "[components]", Index, Token, Value) == EFI_SUCCESS) {
+      Index++;
+    }
+  }
+
+  return Index;
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Time the ParseFvInf lookups on FV INFs of growing size, rescanning the
+  file for every lookup and with the index.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  static UINTN  FileCounts[] = { 100, 500, 1000, 2000, 4000 };
+  MEMORY_FILE   Inf;
+  CHAR8         *Image;
+  UINTN         Index;
+  UINTN         Runs;
+  UINTN         Run;
+  UINTN         ScanFiles;
+  UINTN         IndexFiles;
+  clock_t       Start;
+  double        Scan;
+  double        Indexed;
+
+  printf ("FV INF files   rescan (ms)   indexed (ms)   speedup\n");
+  for (Index = 0; Index < COUNT_OF (FileCounts); Index++) {
+    Image = BuildFvInf (FileCounts[Index], TRUE);
+    OpenImage (&Inf, Image);
+    Runs = 4000 / FileCounts[Index];
+
+    Start = clock ();
+    for (Run = 0; Run < Runs; Run++) {
+      ScanFiles = ParseLikeGenFvImage (&Inf);
+    }
+
+    Scan = (double) (clock () - Start) * 1000 / CLOCKS_PER_SEC / Runs;
+
+    //
+    // The indexed time includes building and freeing the index
+    //
+    Start = clock ();
+    for (Run = 0; Run < Runs * 20; Run++) {
+      IndexInfFile (&Inf);
+      IndexFiles = ParseLikeGenFvImage (&Inf);
+      FreeInfFileIndex (&Inf);
+    }
+
+    Indexed = (double) (clock () - Start) * 1000 / CLOCKS_PER_SEC / (Runs * 20);
+
+    if (ScanFiles != IndexFiles) {
+      printf ("ParseInfTest: the index found %u files, the scan %u\n", (unsigned) IndexFiles, (unsigned) ScanFiles);
+    }
+
+    printf (
+      "%12u %13.2f %14.3f %8.0fx\n",
+      (unsigned) FileCounts[Index],
+      Scan,
+      Indexed,
+      Scan / Indexed
+      );
+    free (Image);
+  }
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, or the benchmark when called with -b.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  TestFvInf ();
+  TestPackage ();
+
+  if (mFailures != 0) {
+    printf ("ParseInfTest: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("ParseInfTest: all checks passed\n");
+  return 0;
+}
@@ -30,6 +30,7 @@ Abstract:
 #include "EfiCustomizedCompress.h"
 #include "crc32.h"
 #include "GenFfsFile.h"
+#include "SectionCache.h"
 #include <stdio.h>
 #include <ctype.h>  // for isalpha()
 //
@@ -70,6 +71,14 @@ FindSectionInPackage (
   IN OUT UINT32   *LineNumber
   );
 
+static
+INT32
+SeekSectionInPackage (
+  IN CHAR8        *PackagePath,
+  IN CHAR8        *Section,
+  IN FILE         *Package
+  );
+
 static
 STATUS
 ProcessCommandLineArgs (
@@ -124,6 +133,7 @@ static struct {
   UINT8   PrimaryPackagePath[_MAX_PATH];
   UINT8   OverridePackagePath[_MAX_PATH];
   UINT8   OutputFilePath[_MAX_PATH];
+  UINT8   CacheDirectory[_MAX_PATH];
   BOOLEAN Verbose;
   MACRO   *MacroList;
 } mGlobals;
@@ -209,6 +219,10 @@ Returns:
     "                     Optional.",
     "  -d Name=Value      Add a macro definition for the package file. Optional.",
     "  -o OutputFile      Specifies the file name of output file. Optional.",
+    "  -cache CacheDir    Keeps compressed sections in CacheDir and reuses them",
+    "                     when the input is unchanged. Optional, defaults to the",
+    "                     directory in the "SECTION_CACHE_DIRECTORY_ENV" environment",
+    "                     variable.",
     "  -v                 Verbose. Optional.",
     NULL
   };
@@ -496,6 +510,99 @@ Returns:
   return 0;
 }
 
+static
+INT32
+SeekSectionInPackage (
+  IN CHAR8        *PackagePath,
+  IN CHAR8        *Section,
+  IN FILE         *Package
+  )
+/*++
+
+Routine Description:
+
+  Positions the package file just after the line holding the section, using
+  an indexed memory image of the package instead of reading the package
+  token by token from the start.
+
+Arguments:
+
+  PackagePath - Path of the package file
+
+  Section     - Section to find, for example "[.]"
+
+  Package     - Open package file to position
+
+Returns:
+
+  -1          - Section not found or the package could not be read
+   0          - Success
+
+--*/
+{
+  MEMORY_FILE PackageFile;
+  FILE        *ImageFile;
+  CHAR8       *Image;
+  long        PackageSize;
+  long        Offset;
+
+  //
+  // Read the package in binary mode so that offsets into the image are file
+  // offsets. GetFileImage is not used because its buffer does not come from
+  // the MyAlloc heap this file allocates and frees from.
+  //
+  ImageFile = fopen (PackagePath, "rb");
+  if (ImageFile == NULL) {
+    return -1;
+  }
+
+  Image = NULL;
+  if (fseek (ImageFile, 0, SEEK_END) == 0) {
+    PackageSize = ftell (ImageFile);
+    if (PackageSize >= 0) {
+      //
+      // ReadLine needs the image to be null terminated
+      //
+      Image = (CHAR8 *) malloc (PackageSize + 1);
+    }
+  }
+
+  if (Image != NULL) {
+    rewind (ImageFile);
+    if (fread (Image, 1, PackageSize, ImageFile) != (size_t) PackageSize) {
+      free (Image);
+      Image = NULL;
+    }
+  }
+
+  fclose (ImageFile);
+  if (Image == NULL) {
+    return -1;
+  }
+
+  Image[PackageSize] = 0;
+
+  PackageFile.FileImage           = Image;
+  PackageFile.Eof                 = Image + PackageSize;
+  PackageFile.CurrentFilePointer  = Image;
+
+  Offset = -1;
+  if (IndexInfFile (&PackageFile) == EFI_SUCCESS) {
+    if (FindSection (&PackageFile, Section)) {
+      Offset = (long) (PackageFile.CurrentFilePointer - Image);
+    }
+
+    FreeInfFileIndex (&PackageFile);
+  }
+
+  free (Image);
+  if (Offset < 0 || fseek (Package, Offset, SEEK_SET) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
 static
 EFI_STATUS
 GenSimpleGuidSection (
@@ -625,6 +732,9 @@ Returns:
   EFI_COMPRESSION_SECTION CompressionSet;
   UINT8                   CompressionType;
   COMPRESS_FUNCTION       CompressFunction;
+  CHAR8                   CacheParameters[_MAX_PATH + 16];
+  SECTION_CACHE_KEY       CacheKey;
+  UINT32                  CacheSize;
 
   Status            = EFI_SUCCESS;
   CompData          = NULL;
@@ -662,6 +772,16 @@ Returns:
     CompressFunction  = (COMPRESS_FUNCTION) CustomizedCompress;
   }
   //
+  // Reuse the section if the same data was compressed before
+  //
+  sprintf (CacheParameters, "GenFfsFile %.*s", _MAX_PATH, Type);
+  CacheSize = *BufferSize;
+  Status = SectionCacheLookup (FileBuffer, DataSize, CacheParameters, &CacheKey, FileBuffer, &CacheSize);
+  if (Status == EFI_SUCCESS || Status == EFI_BUFFER_TOO_SMALL) {
+    *BufferSize = CacheSize;
+    return Status;
+  }
+  //
   // Compress the raw data
   //
   Status = CompressFunction (FileBuffer, DataSize, CompData, &CompSize);
@@ -719,6 +839,7 @@ Returns:
     TotalSize++;
   }
 
+  SectionCacheInsert (&CacheKey, FileBuffer, TotalSize);
   *BufferSize = TotalSize;
 
   if (CompData != NULL) {
@@ -2303,7 +2424,16 @@ here:
     }
 
     LineNumber = 1;
-    FindSectionInPackage (".", PrimaryPackage, &LineNumber);
+    if (SeekSectionInPackage (mGlobals.PrimaryPackagePath, "[.]", PrimaryPackage) != 0) {
+      //
+      // ReadLine drops the last character of each line as the CR, so the
+      // index does not find "[.]" in a package with LF line ends. Scan the
+      // package for it instead.
+      //
+      rewind (PrimaryPackage);
+      FindSectionInPackage (".", PrimaryPackage, &LineNumber);
+    }
+
     while (_strcmpi (InputString, "IMAGE_SCRIPT") != 0) {
       GetNextLine (InputString, PrimaryPackage, &LineNumber);
       CheckSlash (InputString, PrimaryPackage, &LineNumber);
@@ -2554,10 +2684,23 @@ Returns:
     return Status;
   }
 
+  if (SectionCacheOpen (mGlobals.CacheDirectory[0] ? (CHAR8 *) mGlobals.CacheDirectory : NULL, 0) != EFI_SUCCESS) {
+    Error (
+      NULL,
+      0,
+      0,
+      mGlobals.CacheDirectory[0] ? (CHAR8 *) mGlobals.CacheDirectory : SECTION_CACHE_DIRECTORY_ENV,
+      "section cache directory name is too long"
+      );
+    return STATUS_ERROR;
+  }
+
   Status = MainEntry (argc, argv, TRUE);
   if (Status == STATUS_SUCCESS) {
     MainEntry (argc, argv, FALSE);
   }
+
+  SectionCacheClose (mGlobals.Verbose);
   //
   // If any errors were reported via the standard error reporting
   // routines, then the status has been saved. Get the value and
@@ -2677,6 +2820,24 @@ Returns:
       strcpy (mGlobals.OutputFilePath, Argv[1]);
       Argc--;
       Argv++;
+    } else if (_strcmpi (Argv[0], "-cache") == 0) {
+      //
+      // OPTION: -cache CacheDirectory
+      // Make sure there is another argument, then save it to our globals.
+      //
+      if (Argc < 2) {
+        Error (NULL, 0, 0, Argv[0], "option requires the cache directory name");
+        return STATUS_ERROR;
+      }
+
+      if (strlen (Argv[1]) >= _MAX_PATH) {
+        Error (NULL, 0, 0, Argv[1], "cache directory name is too long");
+        return STATUS_ERROR;
+      }
+
+      strcpy (mGlobals.CacheDirectory, Argv[1]);
+      Argc--;
+      Argv++;
     } else if (_strcmpi (Argv[0], "-v") == 0) {
       //
       // OPTION: -v       verbose
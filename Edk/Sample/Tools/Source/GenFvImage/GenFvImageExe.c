@@ -91,6 +91,9 @@ Returns:
     "  "UTILITY_NAME" [OPTION]",
     "Options:",
     "  -I FvInfFileName  The name of the image description file.",
+    "  -J ThreadNumber   The number of threads copying files into the FV,",
+    "                    1 copies them serially. The default is one thread",
+    "                    per processor.",
     NULL
   };
 
@@ -114,8 +117,11 @@ Arguments:
 
   FvInfFileName      The name of an FV image description file.
 
+  ThreadNumber       The number of threads copying files into the FV.
+
   Arguments come in pair in any order.
     -I FvInfFileName 
+    -J ThreadNumber
 
 Returns:
 
@@ -133,6 +139,8 @@ Returns:
   CHAR8       InfFileName[_MAX_PATH];
   CHAR8       *InfFileImage;
   UINTN       InfFileSize;
+  UINTN       ThreadNumber;
+  UINT64      Value64;
   UINT8       *FvImage;
   UINTN       FvImageSize;
   UINT8       Index;
@@ -158,7 +166,7 @@ Returns:
   //
   // Verify the correct number of arguments
   //
-  if (argc != MAX_ARGS) {
+  if ((argc < 3) || (argc > MAX_ARGS) || ((argc & 1) == 0)) {
     Error (NULL, 0, 0, "invalid number of input parameters specified", NULL);
     PrintUsage ();
     return GetUtilityStatus ();
@@ -167,11 +175,12 @@ Returns:
   // Initialize variables
   //
   strcpy (InfFileName, "");
+  ThreadNumber = 0;
 
   //
   // Parse the command line arguments
   //
-  for (Index = 1; Index < MAX_ARGS; Index += 2) {
+  for (Index = 1; Index < argc; Index += 2) {
     //
     // Make sure argument pair begin with - or /
     //
@@ -204,6 +213,17 @@ Returns:
       }
       break;
 
+    case 'J':
+    case 'j':
+      if (EFI_ERROR (AsciiStringToUint64 (argv[Index + 1], FALSE, &Value64)) || (Value64 == 0)) {
+        Error (NULL, 0, 0, argv[Index + 1], "ThreadNumber must be a number of 1 or more");
+        PrintUsage ();
+        return GetUtilityStatus ();
+      }
+
+      ThreadNumber = (UINTN) Value64;
+      break;
+
     default:
       Error (NULL, 0, 0, argv[Index], "unrecognized argument");
       PrintUsage ();
@@ -224,6 +244,7 @@ Returns:
   Status = GenerateFvImage (
             InfFileImage,
             InfFileSize,
+            ThreadNumber,
             &FvImage,
             &FvImageSize,
             &FvFileName,
@@ -44,7 +44,7 @@ Abstract:
 //
 // The maximum number of arguments accepted from the command line.
 //
-#define MAX_ARGS  3
+#define MAX_ARGS  5
 
 //
 // The function that displays general utility information
@@ -1423,17 +1423,7 @@ Returns:
 
 --*/
 {
-  CHAR8   *Destination8;
-  CHAR8   *Source8;
-  UINT32  Length;
-
-  Destination8  = Buffer;
-  Source8       = (CHAR8 *) ((UINTN) FileHandle + FileOffset);
-  Length        = *ReadSize;
-  while (Length--) {
-    *(Destination8++) = *(Source8++);
-  }
-
+  memcpy (Buffer, (UINT8 *) FileHandle + FileOffset, *ReadSize);
   return EFI_SUCCESS;
 }
 
@@ -1969,11 +1959,338 @@ Returns:
   return EFI_SUCCESS;
 }
 
+EFI_STATUS
+MapInputFile (
+  IN CHAR8                    *FileName,
+  OUT MAPPED_FILE             *MappedFile
+  )
+/*++
+
+Routine Description:
+
+  This function maps a file into memory read-only, so that its contents can
+  be used without reading them into an allocated buffer.
+
+Arguments:
+
+  FileName        The file to map.
+  MappedFile      Returns the view of the file. It must be released with
+                  UnmapInputFile, also when this function fails.
+
+Returns:
+
+  EFI_SUCCESS              The function completed successfully.
+  EFI_ABORTED              The file could not be opened or mapped.
+
+--*/
+{
+  memset (MappedFile, 0, sizeof (MAPPED_FILE));
+
+  MappedFile->FileHandle = CreateFile (
+                            FileName,
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            NULL,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                            NULL
+                            );
+  if (MappedFile->FileHandle == INVALID_HANDLE_VALUE) {
+    MappedFile->FileHandle = NULL;
+    Error (NULL, 0, 0, FileName, "failed to open file for reading");
+    return EFI_ABORTED;
+  }
+  //
+  // An empty file cannot be mapped
+  //
+  MappedFile->FileSize = GetFileSize (MappedFile->FileHandle, NULL);
+  if (MappedFile->FileSize == 0 || MappedFile->FileSize == INVALID_FILE_SIZE) {
+    Error (NULL, 0, 0, FileName, "failed to read input file contents");
+    return EFI_ABORTED;
+  }
+
+  MappedFile->MappingHandle = CreateFileMapping (MappedFile->FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (MappedFile->MappingHandle != NULL) {
+    MappedFile->FileImage = (UINT8 *) MapViewOfFile (MappedFile->MappingHandle, FILE_MAP_READ, 0, 0, 0);
+  }
+
+  if (MappedFile->FileImage == NULL) {
+    Error (NULL, 0, 0, FileName, "failed to read input file contents");
+    return EFI_ABORTED;
+  }
+
+  return EFI_SUCCESS;
+}
+
+VOID
+UnmapInputFile (
+  IN OUT MAPPED_FILE          *MappedFile
+  )
+/*++
+
+Routine Description:
+
+  This function releases a file mapped by MapInputFile.
+
+Arguments:
+
+  MappedFile      The view of the file.
+
+Returns:
+
+  None
+
+--*/
+{
+  if (MappedFile->FileImage != NULL) {
+    UnmapViewOfFile (MappedFile->FileImage);
+  }
+
+  if (MappedFile->MappingHandle != NULL) {
+    CloseHandle (MappedFile->MappingHandle);
+  }
+
+  if (MappedFile->FileHandle != NULL) {
+    CloseHandle (MappedFile->FileHandle);
+  }
+
+  memset (MappedFile, 0, sizeof (MAPPED_FILE));
+}
+
+UINTN
+CalculateFvImageCapacity (
+  IN FV_INFO                  *FvInfo,
+  IN MAPPED_FILE              *FvFiles,
+  IN UINTN                    FileCount
+  )
+/*++
+
+Routine Description:
+
+  This function calculates how large an FV with AUTO size can grow while the
+  given files are added to it.  Allocating this much up front lets the FV
+  grow block by block without reallocating and copying the image.
+
+Arguments:
+
+  FvInfo          Pointer to information about the FV.
+  FvFiles         The mapped FFS files that will be added to the FV.
+  FileCount       The number of files in FvFiles.
+
+Returns:
+
+  The capacity in bytes, a multiple of the FV block size.
+
+--*/
+{
+  UINTN   Capacity;
+  UINTN   BlockLength;
+  UINTN   Index;
+  UINT32  Alignment;
+
+  Capacity = sizeof (EFI_FIRMWARE_VOLUME_HEADER) + MAX_NUMBER_OF_FV_BLOCKS * sizeof (EFI_FV_BLOCK_MAP_ENTRY);
+  for (Index = 0; Index < FileCount; Index++) {
+    //
+    // Files start on 8 byte boundaries, and aligned files may need a pad
+    // file in front of them
+    //
+    Capacity += (FvFiles[Index].FileSize + 7) & ~((UINTN) 7);
+    if (!EFI_ERROR (ReadFfsAlignment ((EFI_FFS_FILE_HEADER *) FvFiles[Index].FileImage, &Alignment)) && Alignment > 8) {
+      Capacity += Alignment + sizeof (EFI_FFS_FILE_HEADER);
+    }
+  }
+  //
+  // Leave a spare block, and round up to whole blocks
+  //
+  BlockLength = FvInfo->FvBlocks[0].BlockLength;
+  if (BlockLength == 0) {
+    return Capacity;
+  }
+
+  Capacity += BlockLength;
+  return ((Capacity + BlockLength - 1) / BlockLength) * BlockLength;
+}
+
+VOID
+UnmapFvFiles (
+  IN OUT MAPPED_FILE          *FvFiles,
+  IN UINTN                    FileCount
+  )
+/*++
+
+Routine Description:
+
+  This function unmaps the FFS files of an FV and frees the array holding
+  them.
+
+Arguments:
+
+  FvFiles         The mapped FFS files, may be NULL.
+  FileCount       The number of files in FvFiles.
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN Index;
+
+  if (FvFiles == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < FileCount; Index++) {
+    UnmapInputFile (&FvFiles[Index]);
+  }
+
+  free (FvFiles);
+}
+
+DWORD
+WINAPI
+CopyFvFilesThreadProc (
+  IN LPVOID                   Context
+  )
+/*++
+
+Routine Description:
+
+  Thread function that copies FFS files into the places AddFile reserved for
+  them in the FV image, until all the files have been taken.  The files do
+  not overlap, so any number of threads can run this at once.
+
+Arguments:
+
+  Context         The FV_FILE_COPY_CONTEXT of the FV image.
+
+Returns:
+
+  0
+
+--*/
+{
+  FV_FILE_COPY_CONTEXT  *CopyContext;
+  UINTN                 Index;
+  EFI_FFS_FILE_HEADER   *FfsFile;
+
+  CopyContext = (FV_FILE_COPY_CONTEXT *) Context;
+  for (;;) {
+    Index = (UINTN) (InterlockedIncrement (&CopyContext->NextFile) - 1);
+    if (Index >= CopyContext->FileCount) {
+      return 0;
+    }
+
+    if (CopyContext->FileOffsets[Index] == FV_FILE_COPIED) {
+      continue;
+    }
+
+    FfsFile = (EFI_FFS_FILE_HEADER *) (CopyContext->FvImage + CopyContext->FileOffsets[Index]);
+    memcpy (FfsFile, CopyContext->FvFiles[Index].FileImage, CopyContext->FvFiles[Index].FileSize);
+
+    //
+    // Update the file state based on polarity of the FV.
+    //
+    UpdateFfsFileState (FfsFile, (EFI_FIRMWARE_VOLUME_HEADER *) CopyContext->FvImage);
+  }
+}
+
+VOID
+CopyFvFiles (
+  IN UINT8                    *FvImage,
+  IN MAPPED_FILE              *FvFiles,
+  IN UINTN                    *FileOffsets,
+  IN UINTN                    FileCount,
+  IN UINTN                    ThreadNumber
+  )
+/*++
+
+Routine Description:
+
+  This function copies the FFS files laid out by AddFile into the FV image.
+  The files are independent once their offsets are known, so they are
+  copied by several threads, by default one per processor.  The result
+  does not depend on the number of threads.
+
+Arguments:
+
+  FvImage         The FV image.
+  FvFiles         The mapped FFS files.
+  FileOffsets     The offset of each file in the FV image, or FV_FILE_COPIED
+                  if AddFile copied the file already.
+  FileCount       The number of files in FvFiles.
+  ThreadNumber    The number of threads copying files, 1 copies them in
+                  this thread only, 0 uses one thread per processor.
+
+Returns:
+
+  None
+
+--*/
+{
+  FV_FILE_COPY_CONTEXT  CopyContext;
+  SYSTEM_INFO           SystemInfo;
+  HANDLE                ThreadHandle[MAXIMUM_WAIT_OBJECTS];
+  UINTN                 Index;
+
+  CopyContext.FvImage     = FvImage;
+  CopyContext.FvFiles     = FvFiles;
+  CopyContext.FileOffsets = FileOffsets;
+  CopyContext.FileCount   = FileCount;
+  CopyContext.NextFile    = 0;
+
+  if (ThreadNumber == 0) {
+    GetSystemInfo (&SystemInfo);
+    ThreadNumber = SystemInfo.dwNumberOfProcessors;
+  }
+
+  if (ThreadNumber > MAXIMUM_WAIT_OBJECTS) {
+    ThreadNumber = MAXIMUM_WAIT_OBJECTS;
+  }
+
+  if (ThreadNumber > FileCount) {
+    ThreadNumber = FileCount;
+  }
+  //
+  // This thread copies files too, so start one thread less.  If a thread
+  // cannot be created, the ones that run just copy more files.
+  //
+  for (Index = 0; Index + 1 < ThreadNumber; Index++) {
+    ThreadHandle[Index] = CreateThread (
+                            NULL,                   // default security attributes
+                            0,                      // use default stack size
+                            CopyFvFilesThreadProc,  // thread function
+                            &CopyContext,           // the files to copy
+                            0,                      // use default creation flags
+                            NULL                    // thread identifier not needed
+                            );
+    if (ThreadHandle[Index] == NULL) {
+      break;
+    }
+  }
+
+  ThreadNumber = Index;
+  CopyFvFilesThreadProc (&CopyContext);
+
+  //
+  // Wait until all threads have terminated
+  //
+  if (ThreadNumber != 0) {
+    WaitForMultipleObjects ((DWORD) ThreadNumber, ThreadHandle, TRUE, INFINITE);
+  }
+
+  for (Index = 0; Index < ThreadNumber; Index++) {
+    CloseHandle (ThreadHandle[Index]);
+  }
+}
+
 EFI_STATUS
 AddFile (
   IN OUT MEMORY_FILE          *FvImage,
   IN FV_INFO                  *FvInfo,
   IN UINTN                    Index,
+  IN MAPPED_FILE              *NewFile,
+  OUT UINTN                   *FileOffset,
   IN OUT EFI_FFS_FILE_HEADER  **VtfFileImage,
   IN OUT MEMORY_FILE          *SymImage,
   IN OUT UINTN                *FvImageCapacity
@@ -1982,8 +2299,10 @@ AddFile (
 
 Routine Description:
 
-  This function adds a file to the FV image.  The file will pad to the
-  appropriate alignment if required.
+  This function lays out a file in the FV image.  The file will pad to the
+  appropriate alignment if required.  A VTF file is copied to the top of the
+  FV right away.  Space is reserved for any other file, and CopyFvFiles
+  copies it in once all the files are laid out.
 
 Arguments:
 
@@ -1991,6 +2310,10 @@ Arguments:
                   must be valid.
   FvInfo          Pointer to information about the FV.
   Index           The file in the FvInfo file list to add.
+  NewFile         The file to add, mapped by MapInputFile.  It is copied
+                  into the FV image and not modified.
+  FileOffset      Returns the offset reserved for the file in the FV image, or
+                  FV_FILE_COPIED if the file was copied already.
   VtfFileImage    A pointer to the VTF file within the FvImage.  If this is equal
                   to the end of the FvImage then no VTF previously found.
   SymImage        The memory image of the Sym file to update if symbols are present.
@@ -2006,10 +2329,8 @@ Returns:
 
 --*/
 {
-  FILE                  *NewFile;
   UINTN                 FileSize;
   UINT8                 *FileBuffer;
-  UINTN                 NumBytesRead;
   UINT32                CurrentFileAlignment;
   EFI_STATUS            Status;
   EFI_PHYSICAL_ADDRESS  CurrentFileBaseAddress;
@@ -2023,47 +2344,17 @@ Returns:
   //
   // Verify input parameters.
   //
-  if (FvImage == NULL || FvInfo == NULL || FvInfo->FvFiles[Index][0] == 0 || VtfFileImage == NULL || SymImage == NULL) {
+  if (FvImage == NULL || FvInfo == NULL || FvInfo->FvFiles[Index][0] == 0 || NewFile == NULL || VtfFileImage == NULL || SymImage == NULL) {
     return EFI_INVALID_PARAMETER;
   }
   //
-  // Read the file to add
-  //
-  NewFile = fopen (FvInfo->FvFiles[Index], "rb");
-
-  if (NewFile == NULL) {
-    Error (NULL, 0, 0, FvInfo->FvFiles[Index], "failed to open file for reading");
-    return EFI_ABORTED;
-  }
-  //
-  // Get the file size
+  // Use the file contents straight from the mapping. The file state is
+  // updated on the copy in the FV image.
   //
-  FileSize = _filelength (_fileno (NewFile));
+  FileSize    = NewFile->FileSize;
+  FileBuffer  = NewFile->FileImage;
+  *FileOffset = FV_FILE_COPIED;
 
-  //
-  // Read the file into a buffer
-  //
-  FileBuffer = malloc (FileSize);
-  if (FileBuffer == NULL) {
-    Error (NULL, 0, 0, "memory allocation failure", NULL);
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  NumBytesRead = fread (FileBuffer, sizeof (UINT8), FileSize, NewFile);
-
-  //
-  // Done with the file, from this point on we will just use the buffer read.
-  //
-  fclose (NewFile);
-
-  //
-  // Verify read successful
-  //
-  if (NumBytesRead != sizeof (UINT8) * FileSize) {
-    Error (NULL, 0, 0, FvInfo->FvFiles[Index], "failed to read input file contents");
-    Status = EFI_ABORTED;
-    goto Exit;
-  }
   //
   // Verify space exists to add the file
   //
@@ -2083,14 +2374,6 @@ Returns:
       }
     }
   }
-  //
-  // Update the file state based on polarity of the FV.
-  //
-  UpdateFfsFileState (
-    (EFI_FFS_FILE_HEADER *) FileBuffer,
-    (EFI_FIRMWARE_VOLUME_HEADER *) FvImage->FileImage
-    );
-
   //
   // If we have a VTF file, add it at the top.
   //
@@ -2120,6 +2403,11 @@ Returns:
         FileSize - sizeof (EFI_FFS_FILE_HEADER)
         );
 
+      //
+      // Update the file state based on polarity of the FV.
+      //
+      UpdateFfsFileState (*VtfFileImage, (EFI_FIRMWARE_VOLUME_HEADER *) FvImage->FileImage);
+
       //
       // re-calculate the VTF File Header
       //
@@ -2221,9 +2509,10 @@ Returns:
   }
 
   //
-  // Copy the file
+  // Reserve the space for the file. The FV image may still be reallocated,
+  // so remember the offset rather than the address.
   //
-  memcpy (FvImage->CurrentFilePointer, FileBuffer, FileSize);
+  *FileOffset = (UINTN) FvImage->CurrentFilePointer - (UINTN) FvImage->FileImage;
 
   //
   // If the file is XIP, rebase
@@ -2236,11 +2525,12 @@ Returns:
   //      return EFI_ABORTED;
   //    }
   //
-  // Update Symbol file
+  // Update Symbol file. The symbols come from the input file, as it has
+  // not been copied into the FV image yet.
   //
   Status = AddSymFile (
             CurrentFileBaseAddress,
-            (EFI_FFS_FILE_HEADER *) FvImage->CurrentFilePointer,
+            (EFI_FFS_FILE_HEADER *) FileBuffer,
             SymImage,
             FvInfo->FvFiles[Index]
             );
@@ -2259,10 +2549,6 @@ Returns:
   }
 
 Exit:
-  //
-  // Free allocated memory.
-  //
-  free (FileBuffer);
   return Status;
 }
 
@@ -2887,6 +3173,7 @@ EFI_STATUS
 GenerateFvImage (
   IN CHAR8    *InfFileImage,
   IN UINTN    InfFileSize,
+  IN UINTN    ThreadNumber,
   OUT UINT8   **FvImage,
   OUT UINTN   *FvImageSize,
   OUT CHAR8   **FvFileName,
@@ -2904,6 +3191,8 @@ Arguments:
 
   InfFileImage  Buffer containing the INF file contents.
   InfFileSize   Size of the contents of the InfFileImage buffer.
+  ThreadNumber  Number of threads copying the FFS files into the FV image,
+                0 for one thread per processor.
   FvImage       Pointer to the FV image created.
   FvImageSize   Size of the FV image created and pointed to by FvImage.
   FvFileName    Requested name for the FV file.
@@ -2929,6 +3218,9 @@ Returns:
   EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
   EFI_FFS_FILE_HEADER         *VtfFileImage;
   UINTN                       FvImageCapacity;
+  MAPPED_FILE                 *FvFiles;
+  UINTN                       *FileOffsets;
+  UINTN                       FileCount;
 
   //
   // Check for invalid parameter
@@ -2944,9 +3236,12 @@ Returns:
   InfMemoryFile.Eof                 = InfFileImage + InfFileSize;
 
   //
-  // Parse the FV inf file for header information
+  // Parse the FV inf file for header information. ParseFvInf looks up
+  // many tokens, so index the file once rather than rescan it per token.
   //
+  IndexInfFile (&InfMemoryFile);
   Status = ParseFvInf (&InfMemoryFile, &FvInfo);
+  FreeInfFileIndex (&InfMemoryFile);
   if (EFI_ERROR (Status)) {
     printf ("ERROR: Could not parse the input INF file.\n");
     return EFI_ABORTED;
@@ -2957,6 +3252,37 @@ Returns:
   strcpy (*FvFileName, FvInfo.FvName);
   strcpy (*SymFileName, FvInfo.SymName);
 
+  //
+  // Map the FFS files up front.  They are copied straight from the mapping
+  // into the FV image, and their sizes give the capacity of an AUTO sized FV.
+  //
+  FvFiles     = NULL;
+  FileOffsets = NULL;
+  FileCount   = 0;
+  while (FvInfo.FvFiles[FileCount][0] != 0) {
+    FileCount++;
+  }
+
+  if (FileCount != 0) {
+    FvFiles     = malloc (FileCount * sizeof (MAPPED_FILE));
+    FileOffsets = malloc (FileCount * sizeof (UINTN));
+    if (FvFiles == NULL || FileOffsets == NULL) {
+      free (FvFiles);
+      free (FileOffsets);
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    memset (FvFiles, 0, FileCount * sizeof (MAPPED_FILE));
+    for (Index = 0; Index < FileCount; Index++) {
+      Status = MapInputFile (FvInfo.FvFiles[Index], &FvFiles[Index]);
+      if (EFI_ERROR (Status)) {
+        printf ("ERROR: Could not add file %s.\n", FvInfo.FvFiles[Index]);
+        UnmapFvFiles (FvFiles, FileCount);
+        free (FileOffsets);
+        return EFI_ABORTED;
+      }
+    }
+  }
   //
   // Calculate the FV size
   //
@@ -2969,7 +3295,7 @@ Returns:
     //
     FvInfo.FvBlocks[0].NumBlocks = 1;
     *FvImageSize    = FvInfo.FvBlocks[0].BlockLength;
-    FvImageCapacity = FV_CAPACITY_INCREASE_UNIT;
+    FvImageCapacity = CalculateFvImageCapacity (&FvInfo, FvFiles, FileCount);
   }
 
   //
@@ -2977,6 +3303,8 @@ Returns:
   //
   *FvImage = malloc (FvImageCapacity);
   if (*FvImage == NULL) {
+    UnmapFvFiles (FvFiles, FileCount);
+    free (FileOffsets);
     return EFI_OUT_OF_RESOURCES;
   }
   //
@@ -2984,6 +3312,8 @@ Returns:
   //
   *SymImage = malloc (SYMBOL_FILE_SIZE);
   if (*SymImage == NULL) {
+    UnmapFvFiles (FvFiles, FileCount);
+    free (FileOffsets);
     return EFI_OUT_OF_RESOURCES;
   }
   //
@@ -3088,13 +3418,22 @@ Returns:
   VtfFileImage = (EFI_FFS_FILE_HEADER *) FvImageMemoryFile.Eof;
 
   //
-  // Add files to FV
+  // Lay out the files in the FV
   //
   for (Index = 0; FvInfo.FvFiles[Index][0] != 0; Index++) {
     //
     // Add the file
     //
-    Status = AddFile (&FvImageMemoryFile, &FvInfo, Index, &VtfFileImage, &SymImageMemoryFile, &FvImageCapacity);
+    Status = AddFile (
+              &FvImageMemoryFile,
+              &FvInfo,
+              Index,
+              &FvFiles[Index],
+              &FileOffsets[Index],
+              &VtfFileImage,
+              &SymImageMemoryFile,
+              &FvImageCapacity
+              );
 
     //
     // Update FvImageSize and FvImage as they may be changed in AddFile routine
@@ -3109,11 +3448,19 @@ Returns:
     //
     if (EFI_ERROR (Status)) {
       printf ("ERROR: Could not add file %s.\n", FvInfo.FvFiles[Index]);
+      UnmapFvFiles (FvFiles, FileCount);
+      free (FileOffsets);
       free (*FvImage);
       return EFI_ABORTED;
     }
   }
   //
+  // Now that the layout is final, copy the files into the FV
+  //
+  CopyFvFiles (FvImageMemoryFile.FileImage, FvFiles, FileOffsets, FileCount, ThreadNumber);
+  UnmapFvFiles (FvFiles, FileCount);
+  free (FileOffsets);
+  //
   // If there is a VTF file, some special actions need to occur.
   //
   if ((UINTN) VtfFileImage != (UINTN) FvImageMemoryFile.Eof) {
@@ -56,6 +56,7 @@ EFI_STATUS
 GenerateFvImage (
   IN CHAR8    *InfFileImage,
   IN UINTN    InfFileSize,
+  IN UINTN    ThreadNumber,
   OUT UINT8   **FvImage,
   OUT UINTN   *FvImageSize,
   OUT CHAR8   **FvFileName,
@@ -75,6 +76,8 @@ Arguments:
 
   InfFileImage  Buffer containing the INF file contents.
   InfFileSize   Size of the contents of the InfFileImage buffer.
+  ThreadNumber  Number of threads copying the FFS files into the FV image,
+                0 for one thread per processor.
   FvImage       Pointer to the FV image created.
   FvImageSize   Size of the FV image created and pointed to by FvImage.
   FvFileName    Requested name for the FV file.
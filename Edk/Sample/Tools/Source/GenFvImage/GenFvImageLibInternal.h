@@ -202,6 +202,33 @@ typedef struct {
   COMPONENT_INFO          FvComponents[MAX_NUMBER_OF_COMPONENTS_IN_FV];
 } FV_INFO;
 
+//
+// Read-only view of an input file mapped into memory
+//
+typedef struct {
+  HANDLE                  FileHandle;
+  HANDLE                  MappingHandle;
+  UINT8                   *FileImage;
+  UINTN                   FileSize;
+} MAPPED_FILE;
+
+//
+// Offset of a file that AddFile has already copied into the FV image
+//
+#define FV_FILE_COPIED                  ((UINTN) -1)
+
+//
+// The FFS files laid out in an FV image, shared by the threads copying
+// them into the image
+//
+typedef struct {
+  UINT8                   *FvImage;
+  MAPPED_FILE             *FvFiles;
+  UINTN                   *FileOffsets;
+  UINTN                   FileCount;
+  volatile LONG           NextFile;
+} FV_FILE_COPY_CONTEXT;
+
 //
 // Private function prototypes
 //
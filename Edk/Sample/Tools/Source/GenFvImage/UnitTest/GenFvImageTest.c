@@ -0,0 +1,402 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  GenFvImageTest.c
+
+Abstract:
+
+  Check that GenFvImage builds the same FV whatever number of threads
+  copies the FFS files into it.
+
+  The program writes 400 FFS files of random size and alignment under
+  WorkDir, and FV descriptions of an erase polarity 1 FV holding all of
+  them and an erase polarity 0 FV holding the first 100. It builds each FV
+  with -J 1, with -J ThreadNumber and with the default of one thread per
+  processor, times the runs and byte-compares each FV with the -J 1 one.
+
+    GenFvImageTest GenFvImage WorkDir [ThreadNumber]
+
+--*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <direct.h>
+
+#define TEST_FILES            400
+#define TEST_MIN_FILE_SIZE    30
+#define TEST_MAX_FILE_SIZE    60000
+#define TEST_THREADS          8
+#define TEST_FFS_HEADER_SIZE  24
+#define TEST_FFS_FILE_TYPE    0x07    // EFI_FV_FILETYPE_DRIVER
+#define TEST_FFS_FILE_STATE   0x07    // header construction, header valid, data valid
+
+#define COUNT_OF(Array)  (sizeof (Array) / sizeof ((Array)[0]))
+
+//
+// The FVs built by each run
+//
+typedef struct {
+  char      *Name;
+  unsigned  FileCount;
+  unsigned  ErasePolarity;
+} TEST_FV;
+
+static TEST_FV        mFvs[] = {
+  { "Polarity1", TEST_FILES,     1 },
+  { "Polarity0", TEST_FILES / 4, 0 }
+};
+
+static char           *mAttributes[] = {
+  "EFI_READ_DISABLED_CAP",
+  "EFI_READ_ENABLED_CAP",
+  "EFI_READ_STATUS",
+  "EFI_WRITE_DISABLED_CAP",
+  "EFI_WRITE_ENABLED_CAP",
+  "EFI_WRITE_STATUS",
+  "EFI_LOCK_CAP",
+  "EFI_LOCK_STATUS",
+  "EFI_STICKY_WRITE",
+  "EFI_MEMORY_MAPPED",
+  "EFI_ALIGNMENT_CAP",
+  "EFI_ALIGNMENT_2",
+  "EFI_ALIGNMENT_4",
+  "EFI_ALIGNMENT_8",
+  "EFI_ALIGNMENT_16",
+  "EFI_ALIGNMENT_32",
+  "EFI_ALIGNMENT_64",
+  "EFI_ALIGNMENT_128",
+  "EFI_ALIGNMENT_256",
+  "EFI_ALIGNMENT_512",
+  "EFI_ALIGNMENT_1K",
+  "EFI_ALIGNMENT_2K",
+  "EFI_ALIGNMENT_4K",
+  "EFI_ALIGNMENT_8K",
+  "EFI_ALIGNMENT_16K",
+  "EFI_ALIGNMENT_32K",
+  "EFI_ALIGNMENT_64K"
+};
+
+static unsigned long  mSeed = 7;
+
+static
+unsigned
+Random (
+  unsigned  Limit
+  )
+/*++
+
+Routine Description:
+
+  A small linear congruential generator, so every run writes the same files.
+
+Arguments:
+
+  Limit - The result is below Limit
+
+Returns:
+
+  A pseudo random number.
+
+--*/
+{
+  mSeed = mSeed * 1103515245 + 12345;
+  return (unsigned) ((mSeed >> 16) & 0x7FFF) % Limit;
+}
+
+static
+int
+WriteFfsFiles (
+  char  *WorkDir
+  )
+/*++
+
+Routine Description:
+
+  Write the FFS files. Each file has a random name GUID, a random size and
+  data alignment, and random data. The header checksums are not checked
+  by GenFvImage, the files do not ask for them.
+
+Arguments:
+
+  WorkDir - Directory of the files
+
+Returns:
+
+  0 on success, 1 if a file could not be written.
+
+--*/
+{
+  static unsigned char  Buffer[TEST_MAX_FILE_SIZE];
+  char                  Path[_MAX_PATH];
+  FILE                  *Fptr;
+  unsigned              Index;
+  unsigned              Size;
+  unsigned              Byte;
+
+  _mkdir (WorkDir);
+  for (Index = 0; Index < TEST_FILES; Index++) {
+    Size = TEST_MIN_FILE_SIZE + ((Random (0x8000) << 15) | Random (0x8000)) % (TEST_MAX_FILE_SIZE - TEST_MIN_FILE_SIZE);
+    for (Byte = 0; Byte < 16; Byte++) {
+      Buffer[Byte] = (unsigned char) Random (0x100);
+    }
+
+    Buffer[16] = 0;
+    Buffer[17] = 0;
+    Buffer[18] = TEST_FFS_FILE_TYPE;
+    Buffer[19] = (unsigned char) (Random (8) << 3);
+    Buffer[20] = (unsigned char) Size;
+    Buffer[21] = (unsigned char) (Size >> 8);
+    Buffer[22] = (unsigned char) (Size >> 16);
+    Buffer[23] = TEST_FFS_FILE_STATE;
+    for (Byte = TEST_FFS_HEADER_SIZE; Byte < Size; Byte++) {
+      Buffer[Byte] = (unsigned char) Random (0x100);
+    }
+
+    sprintf (Path, "%s\\File%u.ffs", WorkDir, Index);
+    if ((Fptr = fopen (Path, "wb")) == NULL) {
+      printf ("GenFvImageTest: could not write %s\n", Path);
+      return 1;
+    }
+
+    fwrite (Buffer, 1, Size, Fptr);
+    fclose (Fptr);
+  }
+
+  return 0;
+}
+
+static
+int
+WriteFvInf (
+  char     *WorkDir,
+  TEST_FV  *Fv,
+  char     *RunName
+  )
+/*++
+
+Routine Description:
+
+  Write the description of an FV for one run. The runs build the same FV
+  into different FV files.
+
+Arguments:
+
+  WorkDir - Directory of the files
+  Fv      - The FV to describe
+  RunName - Name of the run, part of the INF and FV file names
+
+Returns:
+
+  0 on success, 1 if the file could not be written.
+
+--*/
+{
+  char      Path[_MAX_PATH];
+  FILE      *Fptr;
+  unsigned  Index;
+
+  sprintf (Path, "%s\\%s%s.inf", WorkDir, Fv->Name, RunName);
+  if ((Fptr = fopen (Path, "w")) == NULL) {
+    printf ("GenFvImageTest: could not write %s\n", Path);
+    return 1;
+  }
+
+  fprintf (Fptr, "[options]\n");
+  fprintf (Fptr, "EFI_BASE_ADDRESS = 0x100000\n");
+  fprintf (Fptr, "EFI_FILE_NAME = %s\\%s%s.fv\n", WorkDir, Fv->Name, RunName);
+  fprintf (Fptr, "EFI_NUM_BLOCKS = AUTO\n");
+  fprintf (Fptr, "EFI_BLOCK_SIZE = 0x1000\n");
+  fprintf (Fptr, "[attributes]\n");
+  fprintf (Fptr, "EFI_ERASE_POLARITY = %u\n", Fv->ErasePolarity);
+  for (Index = 0; Index < COUNT_OF (mAttributes); Index++) {
+    fprintf (Fptr, "%s = TRUE\n", mAttributes[Index]);
+  }
+
+  fprintf (Fptr, "[files]\n");
+  for (Index = 0; Index < Fv->FileCount; Index++) {
+    fprintf (Fptr, "EFI_FILE_NAME = %s\\File%u.ffs\n", WorkDir, Index);
+  }
+
+  fclose (Fptr);
+  return 0;
+}
+
+static
+char *
+ReadFv (
+  char     *WorkDir,
+  TEST_FV  *Fv,
+  char     *RunName,
+  long     *Size
+  )
+/*++
+
+Routine Description:
+
+  Read the FV file built by a run.
+
+Arguments:
+
+  WorkDir - Directory of the files
+  Fv      - The FV
+  RunName - Name of the run
+  Size    - Returns the file size
+
+Returns:
+
+  The allocated file content, NULL if it could not be read.
+
+--*/
+{
+  char  Path[_MAX_PATH];
+  FILE  *Fptr;
+  char  *Buffer;
+
+  sprintf (Path, "%s\\%s%s.fv", WorkDir, Fv->Name, RunName);
+  if ((Fptr = fopen (Path, "rb")) == NULL) {
+    return NULL;
+  }
+
+  fseek (Fptr, 0, SEEK_END);
+  *Size = ftell (Fptr);
+  fseek (Fptr, 0, SEEK_SET);
+  Buffer = malloc (*Size + 1);
+  if ((Buffer != NULL) && (fread (Buffer, 1, *Size, Fptr) != (size_t) *Size)) {
+    free (Buffer);
+    Buffer = NULL;
+  }
+
+  fclose (Fptr);
+  return Buffer;
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Write the FFS files, build each FV with each thread number and compare
+  the FVs with the serially built one.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - GenFvImage, WorkDir and an optional thread number
+
+Returns:
+
+  0 if every run succeeded and built the same FV, 1 otherwise.
+
+--*/
+{
+  char      *Runs[3][2];
+  char      ThreadOption[32];
+  char      Command[3 * _MAX_PATH];
+  char      *Expected;
+  char      *Actual;
+  long      ExpectedSize;
+  long      ActualSize;
+  unsigned  FvIndex;
+  unsigned  RunIndex;
+  DWORD     Start;
+  DWORD     Elapsed;
+  int       Failed;
+
+  if (argc < 3) {
+    printf ("usage: GenFvImageTest GenFvImage WorkDir [ThreadNumber]\n");
+    return 1;
+  }
+
+  sprintf (ThreadOption, "-J %d", (argc > 3) ? atoi (argv[3]) : TEST_THREADS);
+
+  //
+  // Each run has a name and the thread option passed to GenFvImage
+  //
+  Runs[0][0] = "Serial";
+  Runs[0][1] = "-J 1";
+  Runs[1][0] = "Threads";
+  Runs[1][1] = ThreadOption;
+  Runs[2][0] = "Default";
+  Runs[2][1] = "";
+
+  if (WriteFfsFiles (argv[2]) != 0) {
+    return 1;
+  }
+
+  Failed = 0;
+  for (FvIndex = 0; FvIndex < COUNT_OF (mFvs); FvIndex++) {
+    Expected     = NULL;
+    ExpectedSize = 0;
+    for (RunIndex = 0; RunIndex < COUNT_OF (Runs); RunIndex++) {
+      if (WriteFvInf (argv[2], &mFvs[FvIndex], Runs[RunIndex][0]) != 0) {
+        return 1;
+      }
+
+      sprintf (
+        Command,
+        "\"%s\" -I \"%s\\%s%s.inf\" %s",
+        argv[1],
+        argv[2],
+        mFvs[FvIndex].Name,
+        Runs[RunIndex][0],
+        Runs[RunIndex][1]
+        );
+      Start = GetTickCount ();
+      if (system (Command) != 0) {
+        printf ("GenFvImageTest: %s failed\n", Command);
+        Failed = 1;
+        continue;
+      }
+
+      Elapsed = GetTickCount () - Start;
+      Actual  = ReadFv (argv[2], &mFvs[FvIndex], Runs[RunIndex][0], &ActualSize);
+      if (Actual == NULL) {
+        printf ("GenFvImageTest: could not read the FV of %s\n", Command);
+        Failed = 1;
+        continue;
+      }
+
+      if (Expected == NULL) {
+        Expected     = Actual;
+        ExpectedSize = ActualSize;
+        printf ("%s %-6s %-8s %6u ms   %ld bytes\n", mFvs[FvIndex].Name, Runs[RunIndex][1], Runs[RunIndex][0], (unsigned) Elapsed, ActualSize);
+        continue;
+      }
+
+      if ((ActualSize != ExpectedSize) || (memcmp (Actual, Expected, ActualSize) != 0)) {
+        printf ("%s %-6s %-8s %6u ms   DIFFERENT\n", mFvs[FvIndex].Name, Runs[RunIndex][1], Runs[RunIndex][0], (unsigned) Elapsed);
+        Failed = 1;
+      } else {
+        printf ("%s %-6s %-8s %6u ms   same\n", mFvs[FvIndex].Name, Runs[RunIndex][1], Runs[RunIndex][0], (unsigned) Elapsed);
+      }
+
+      free (Actual);
+    }
+
+    free (Expected);
+  }
+
+  if (Failed) {
+    printf ("GenFvImageTest: the FVs built with different thread numbers differ\n");
+    return 1;
+  }
+
+  printf ("GenFvImageTest: all FVs are the same\n");
+  return 0;
+}
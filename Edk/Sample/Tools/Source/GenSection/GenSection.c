@@ -25,6 +25,7 @@ Abstract:
 #include "EfiCustomizedCompress.h"
 #include "Crc32.h"
 #include "EfiUtilityMsgs.h"
+#include "SectionCache.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -97,6 +98,9 @@ PrintUsageMessage (
     "Common Options:",
     "  -i InputFile    Specifies the input file",
     "  -o OutputFile   Specifies the output file",
+    "  -cache CacheDir Keeps compressed sections in CacheDir and reuses them when",
+    "                  the input is unchanged. Optional, defaults to the directory",
+    "                  in the "SECTION_CACHE_DIRECTORY_ENV" environment variable.",
     "  -s SectionType  Specifies the type of the section, which can be one of",
     NULL
   };
@@ -419,6 +423,10 @@ Returns:
   EFI_STATUS              Status;
   EFI_COMPRESSION_SECTION CompressionSect;
   COMPRESS_FUNCTION       CompressFunction;
+  CHAR8                   CacheParameters[64];
+  SECTION_CACHE_KEY       CacheKey;
+  UINT8                   *CachedSection;
+  UINT32                  CachedSectionSize;
 
   if (SectionType != EFI_SECTION_COMPRESSION) {
     Error (NULL, 0, 0, "parameter must be EFI_SECTION_COMPRESSION", NULL);
@@ -489,6 +497,44 @@ Returns:
   }
 
   if (CompressFunction != NULL) {
+    //
+    // Reuse the section if the same data was compressed before
+    //
+    sprintf (CacheParameters, "GenSection %d %d", (int) SectionType, (int) SectionSubType);
+    CachedSection     = NULL;
+    CachedSectionSize = 0;
+    Status = SectionCacheLookup (
+              FileBuffer,
+              (UINT32) InputLength,
+              CacheParameters,
+              &CacheKey,
+              CachedSection,
+              &CachedSectionSize
+              );
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      CachedSection = (UINT8 *) malloc (CachedSectionSize);
+      if (CachedSection != NULL) {
+        Status = SectionCacheLookup (
+                  FileBuffer,
+                  (UINT32) InputLength,
+                  CacheParameters,
+                  &CacheKey,
+                  CachedSection,
+                  &CachedSectionSize
+                  );
+      }
+    }
+
+    if (Status == EFI_SUCCESS) {
+      fwrite (CachedSection, CachedSectionSize, 1, OutFile);
+      free (CachedSection);
+      free (FileBuffer);
+      return EFI_SUCCESS;
+    }
+
+    if (CachedSection != NULL) {
+      free (CachedSection);
+    }
 
     Status = CompressFunction (FileBuffer, InputLength, OutputBuffer, &CompressedLength);
     if (Status == EFI_BUFFER_TOO_SMALL) {
@@ -536,6 +582,16 @@ Returns:
 
   fwrite (&CompressionSect, sizeof (CompressionSect), 1, OutFile);
   fwrite (FileBuffer, CompressedLength, 1, OutFile);
+  if (CompressFunction != NULL) {
+    CachedSection = (UINT8 *) malloc (TotalLength);
+    if (CachedSection != NULL) {
+      memcpy (CachedSection, &CompressionSect, sizeof (CompressionSect));
+      memcpy (CachedSection + sizeof (CompressionSect), FileBuffer, CompressedLength);
+      SectionCacheInsert (&CacheKey, CachedSection, (UINT32) TotalLength);
+      free (CachedSection);
+    }
+  }
+
   free (FileBuffer);
   return EFI_SUCCESS;
 }
@@ -706,6 +762,7 @@ Returns:
 
   char                      **InputFileName;
   char                      *OutputFileName;
+  char                      *CacheDirectory;
   char                      AuxString[500] = { 0 };
 
   char                      *ParamSectionType;
@@ -719,6 +776,7 @@ Returns:
 
   InputFileName         = NULL;
   OutputFileName        = PARAMETER_NOT_SPECIFIED;
+  CacheDirectory        = NULL;
   ParamSectionType      = PARAMETER_NOT_SPECIFIED;
   ParamSectionSubType   = PARAMETER_NOT_SPECIFIED;
   ParamLength           = PARAMETER_NOT_SPECIFIED;
@@ -835,6 +893,12 @@ Returns:
       //
       Index++;
       ParamDigitalSignature = argv[Index];
+    } else if (_strcmpi (argv[Index], "-cache") == 0) {
+      //
+      // Section cache directory
+      //
+      Index++;
+      CacheDirectory = argv[Index];
     } else if (_strcmpi (argv[Index], "-?") == 0) {
       PrintUsageMessage ();
       return STATUS_ERROR;
@@ -928,6 +992,19 @@ Returns:
 
     return GetUtilityStatus ();
   }
+
+  if (SectionCacheOpen (CacheDirectory, 0) != EFI_SUCCESS) {
+    Error (
+      NULL,
+      0,
+      0,
+      (CacheDirectory != NULL) ? CacheDirectory : SECTION_CACHE_DIRECTORY_ENV,
+      "section cache directory name is too long"
+      );
+    fclose (OutFile);
+    remove (OutputFileName);
+    return GetUtilityStatus ();
+  }
   //
   // At this point, we've fully validated the command line, and opened appropriate
   // files, so let's go and do what we've been asked to do...
@@ -1004,6 +1081,7 @@ Returns:
     free (InputFileName);
   }
 
+  SectionCacheClose (FALSE);
   fclose (OutFile);
   //
   // If we had errors, then delete the output file
@@ -20,6 +20,7 @@ Abstract:
 
 --*/
 
+#include <windows.h>  // for GetFileAttributesEx()
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -40,9 +41,13 @@ typedef struct _STRING_LIST {
 #define UTILITY_VERSION   "v1.0"
 
 #define MAX_LINE_LEN      2048
+#ifdef MAX_PATH
+#undef MAX_PATH
+#endif
 #define MAX_PATH          2048
 #define START_NEST_DEPTH  1
 #define MAX_NEST_DEPTH    1000  // just in case we get in an endless loop.
+#define FILE_HASH_SIZE    0x1000
 //
 // Define the relative paths used by the special #include macros
 //
@@ -108,6 +113,39 @@ typedef enum {
   SearchAllPaths,
 } FILE_SEARCH_TYPE;
 
+//
+// One #include line of a file. A malformed include line is kept as an
+// item with a non-zero EndChar, and ends the list.
+//
+typedef struct _INCLUDE_ITEM {
+  struct _INCLUDE_ITEM  *Next;
+  FILE_SEARCH_TYPE      SearchType;
+  UINT32                LineNum;
+  INT8                  EndChar;        // missing closing character if malformed
+  INT8                  *Name;
+} INCLUDE_ITEM;
+
+typedef enum {
+  FileStateUnknown,
+  FileStatePresent,
+  FileStateMissing,
+} FILE_STATE;
+
+//
+// Everything we know about one file name: whether it exists, and the
+// include lines found in the file once it has been scanned. The include
+// lines are kept on the entry of the full path of the file, so different
+// spellings of a file name share one scan.
+//
+typedef struct _FILE_ENTRY {
+  struct _FILE_ENTRY  *Next;            // hash chain
+  struct _FILE_ENTRY  *FullPath;        // entry of the full path, NULL until needed
+  INT8                *Name;
+  FILE_STATE          State;
+  BOOLEAN             Scanned;          // Includes is valid
+  INCLUDE_ITEM        *Includes;
+} FILE_ENTRY;
+
 //
 // Here's all our globals. We need a linked list of include paths, a linked
 // list of source files, a linked list of subdirectories (appended to each
@@ -135,6 +173,11 @@ static struct {
   INT8        *OutFileName;             // -o option
 } mGlobals;
 
+//
+// Every file name looked up on disk, hashed by full path
+//
+static FILE_ENTRY *mFileHash[FILE_HASH_SIZE];
+
 static
 STATUS
 ProcessFile (
@@ -154,7 +197,7 @@ ProcessClOutput (
   );
 
 static
-FILE  *
+BOOLEAN
 FindFile (
   INT8              *FileName,
   UINT32            FileNameLen,
@@ -168,6 +211,25 @@ PrintDependency (
   INT8    *DependentFile
   );
 
+static
+BOOLEAN
+FileExists (
+  INT8    *FileName
+  );
+
+static
+STATUS
+GetIncludeList (
+  INT8          *FileName,
+  INCLUDE_ITEM  **Includes
+  );
+
+static
+void
+FreeFileTable (
+  VOID
+  );
+
 static
 void
 ReplaceSymbols (
@@ -296,6 +358,7 @@ Finish:
   // Free up memory
   //
   FreeLists ();
+  FreeFileTable ();
   //
   // Free up our processed files list
   //
@@ -350,7 +413,7 @@ ProcessFile (
 
 Routine Description:
 
-  Given a source file name, open the file and parse all #include lines.
+  Given a source file name, find the file and process all its #include lines.
   
 Arguments:
 
@@ -366,23 +429,15 @@ Returns:
   
 --*/
 {
-  FILE        *Fptr;
-  INT8        Line[MAX_LINE_LEN];
-  INT8        *Cptr;
-  INT8        *EndPtr;
-  INT8        *SaveCptr;
-  INT8        EndChar;
-  INT8        FileNameCopy[MAX_PATH];
-  INT8        MacroIncludeFileName[MAX_LINE_LEN];
-  INT8        SumDepsFile[MAX_PATH];
-  STATUS      Status;
-  UINT32      Index;
-  UINT32      LineNum;
-  STRING_LIST *ListPtr;
-  STRING_LIST ParentPath;
+  INT8          *Cptr;
+  INT8          FileNameCopy[MAX_PATH];
+  INT8          SumDepsFile[MAX_PATH];
+  STATUS        Status;
+  STRING_LIST   *ListPtr;
+  STRING_LIST   ParentPath;
+  INCLUDE_ITEM  *Include;
 
   Status  = STATUS_SUCCESS;
-  Fptr    = NULL;
   //
   // Print the file being processed. Indent so you can tell the include nesting
   // depth.
@@ -409,12 +464,10 @@ Returns:
       strcat (SumDepsFile, ".dep");
     }
     //
-    // See if the summary dep file exists. Could use _stat() function, but
-    // it's less portable.
+    // See if the summary dep file exists.
     //
-    if ((Fptr = fopen (SumDepsFile, "r")) != NULL) {
+    if (FileExists (SumDepsFile)) {
       PrintDependency (TargetFileName, SumDepsFile);
-      fclose (Fptr);
       return STATUS_SUCCESS;
     }
   }
@@ -424,7 +477,7 @@ Returns:
   //
   if (NestDepth > MAX_NEST_DEPTH) {
     Error (NULL, 0, 0, FileName, "max nesting depth exceeded on file");
-    goto Finish;
+    return Status;
   }
   //
   // Make a local copy of the filename. Then we can manipulate it
@@ -434,9 +487,9 @@ Returns:
   
   if (FileSearchType == SearchCurrentDir) {
     //
-    // Try to open the source file locally
+    // Try to find the source file locally
     //
-    if ((Fptr = fopen (FileNameCopy, "r")) == NULL) {
+    if (!FileExists (FileNameCopy)) {
       Error (NULL, 0, 0, FileNameCopy, "could not open source file");
       return STATUS_ERROR;
     }
@@ -444,8 +497,7 @@ Returns:
     //
     // Try to find it among the paths.
     //
-    Fptr = FindFile (FileNameCopy, sizeof (FileNameCopy), FileSearchType);
-    if (Fptr == NULL) {
+    if (!FindFile (FileNameCopy, sizeof (FileNameCopy), FileSearchType)) {
       //
       // If this is not the top-level file, and the command-line argument
       // said to ignore missing files, then return ok
@@ -455,21 +507,29 @@ Returns:
           if (!mGlobals.QuietMode) {
             DebugMsg (NULL, 0, 0, FileNameCopy, "could not find file");
           }
-
-          return STATUS_SUCCESS;
         } else {
           Error (NULL, 0, 0, FileNameCopy, "could not find file");
-          return STATUS_ERROR;
+          Status = STATUS_ERROR;
         }
       } else {
         //
         // Top-level (first) file. Emit an error.
         //
         Error (NULL, 0, 0, FileNameCopy, "could not find file");
-        return STATUS_ERROR;
+        Status = STATUS_ERROR;
       }
+
+      return Status;
     }
   }
+  //
+  // Get the include lines of the file, scanning it if this is the first
+  // time we see it
+  //
+  Status = GetIncludeList (FileNameCopy, &Include);
+  if (Status != STATUS_SUCCESS) {
+    return Status;
+  }
 
   //
   // If we're not doing duplicates, and we've already seen this filename,
@@ -492,7 +552,6 @@ Returns:
       if (mGlobals.Verbose) {
         DebugMsg (NULL, 0, 0, FileNameCopy, "duplicate include -- not processed again");
       }
-      fclose (Fptr);
       return STATUS_SUCCESS;
     }
 
@@ -522,10 +581,151 @@ Returns:
   ParentPath.Str = FileNameCopy;
   mGlobals.ParentPaths = &ParentPath;
   
+  //
+  // Now process the include files in the order they appear in the file
+  //
+  for (; (Include != NULL) && (Status == STATUS_SUCCESS); Include = Include->Next) {
+    if (Include->EndChar != 0) {
+      Warning (FileNameCopy, Include->LineNum, 0, "malformed include", "missing closing %c", Include->EndChar);
+      Status = STATUS_WARNING;
+      break;
+    }
+    //
+    // Skip system <include> files if asked to
+    //
+    if ((Include->SearchType == SearchIncludePaths) && mGlobals.NoSystem) {
+      continue;
+    }
+
+    Status = ProcessFile (TargetFileName, Include->Name, NestDepth + 1, 
+                          ProcessedFiles, Include->SearchType);
+  }
+  //
+  // Pop the file path from ParentPaths
+  //
+  mGlobals.ParentPaths = ParentPath.Next;
+
+  return Status;
+}
+
+static
+STATUS
+AddInclude (
+  INCLUDE_ITEM      ***Tail,
+  INT8              *Name,
+  FILE_SEARCH_TYPE  SearchType,
+  UINT32            LineNum,
+  INT8              EndChar
+  )
+/*++
+
+Routine Description:
+
+  Add an include line to the end of an include list.
+  
+Arguments:
+
+  Tail       - the next pointer of the last item of the list, updated
+  Name       - name of the included file
+  SearchType - how to search for the included file
+  LineNum    - line number of the include line
+  EndChar    - missing closing character of a malformed include line, or 0
+
+Returns:
+
+  standard status.
+  
+--*/
+{
+  INCLUDE_ITEM  *Include;
+
+  Include = malloc (sizeof (INCLUDE_ITEM));
+  if (Include != NULL) {
+    Include->Name = malloc (strlen (Name) + 1);
+    if (Include->Name == NULL) {
+      free (Include);
+      Include = NULL;
+    }
+  }
+
+  if (Include == NULL) {
+    Error (__FILE__, __LINE__, 0, "memory allocation failure", NULL);
+    return STATUS_ERROR;
+  }
+
+  strcpy (Include->Name, Name);
+  Include->Next       = NULL;
+  Include->SearchType = SearchType;
+  Include->LineNum    = LineNum;
+  Include->EndChar    = EndChar;
+  **Tail              = Include;
+  *Tail               = &Include->Next;
+  return STATUS_SUCCESS;
+}
+
+static
+void
+FreeIncludes (
+  INCLUDE_ITEM  *Include
+  )
+{
+  INCLUDE_ITEM  *Next;
+
+  while (Include != NULL) {
+    Next = Include->Next;
+    free (Include->Name);
+    free (Include);
+    Include = Next;
+  }
+}
+
+static
+STATUS
+ScanIncludes (
+  INT8          *FileName,
+  INCLUDE_ITEM  **Includes
+  )
+/*++
+
+Routine Description:
+
+  Open a file and make a list of all its #include lines. Nothing is
+  searched for here, so the list only depends on the file contents.
+  
+Arguments:
+
+  FileName - name of the file to scan
+  Includes - the include list returned. The caller frees it.
+
+Returns:
+
+  standard status.
+  
+--*/
+{
+  FILE          *Fptr;
+  INT8          Line[MAX_LINE_LEN];
+  INT8          *Cptr;
+  INT8          *EndPtr;
+  INT8          *SaveCptr;
+  INT8          EndChar;
+  INT8          MacroIncludeFileName[MAX_LINE_LEN];
+  STATUS        Status;
+  UINT32        Index;
+  UINT32        LineNum;
+  INCLUDE_ITEM  **Tail;
+
+  *Includes = NULL;
+  Tail      = Includes;
+  if ((Fptr = fopen (FileName, "r")) == NULL) {
+    Error (NULL, 0, 0, FileName, "could not open file for reading");
+    return STATUS_ERROR;
+  }
   //
   // Now read in lines and find all #include lines. Allow them to indent, and
   // to put spaces between the # and include.
   //
+  Status  = STATUS_SUCCESS;
   LineNum = 0;
   while ((fgets (Line, sizeof (Line), Fptr) != NULL) && (Status == STATUS_SUCCESS)) {
     LineNum++;
@@ -580,11 +780,10 @@ Returns:
           }
       
           //
-          // Null terminate the filename and try to process it.
+          // Null terminate the filename and add it to the list.
           //
           *EndPtr = 0;
-          Status  = ProcessFile (TargetFileName, Cptr, NestDepth + 1, 
-                                 ProcessedFiles, SearchAllPaths);
+          Status  = AddInclude (&Tail, Cptr, SearchAllPaths, LineNum, 0);
         } else {
           //
           // Handle special #include MACRO_NAME(file)
@@ -638,10 +837,9 @@ Returns:
                 strcat (MacroIncludeFileName, Cptr);
                 strcat (MacroIncludeFileName, ".h");
                 //
-                // Process immediately, then break out of the outside FOR loop.
+                // Add it to the list, then break out of the outside FOR loop.
                 //
-                Status = ProcessFile (TargetFileName, MacroIncludeFileName, NestDepth + 1, 
-                                      ProcessedFiles, SearchAllPaths);
+                Status = AddInclude (&Tail, MacroIncludeFileName, SearchAllPaths, LineNum, 0);
                 break;
               }
             }
@@ -654,17 +852,11 @@ Returns:
           // Don't recognize the include line? Ignore it. We assume that the
           // file compiles anyway.
           //
-          if (mMacroConversion[Index].IncludeMacroName == NULL) {
-            //
-            // Warning (FileNameCopy, LineNum, 0, "could not parse line", NULL);
-            // Status = STATUS_WARNING;
-            //
-          }
         }
         //
         // Process "normal" includes. If the endchar is 0, then the
-        // file has already been processed. Otherwise look for the
-        // endchar > or ", and process the include file.
+        // file has already been added. Otherwise look for the
+        // endchar > or ", and add the include file.
         //
         if (EndChar != 0) {
           Cptr++;
@@ -675,48 +867,40 @@ Returns:
 
           if (*EndPtr == EndChar) {
             //
-            // If we're processing it, do it
+            // Null terminate the filename and add it to the list. System
+            // <include> files are only searched for along the include paths.
             //
-            if (EndChar != '>') {
-              //
-              // Null terminate the filename and try to process it.
-              //
-              *EndPtr = 0;
-              Status  = ProcessFile (TargetFileName, Cptr, NestDepth + 1, 
-                                     ProcessedFiles, SearchAllPaths);
-            } else if (!mGlobals.NoSystem) {
-              //
-              // Null terminate the filename and try to process it.
-              //
-              *EndPtr = 0;
-              Status  = ProcessFile (TargetFileName, Cptr, NestDepth + 1, 
-                                     ProcessedFiles, SearchIncludePaths);
-            }
+            *EndPtr = 0;
+            Status  = AddInclude (
+                        &Tail,
+                        Cptr,
+                        (EndChar == '>') ? SearchIncludePaths : SearchAllPaths,
+                        LineNum,
+                        0
+                        );
           } else {
-            Warning (FileNameCopy, LineNum, 0, "malformed include", "missing closing %c", EndChar);
-            Status = STATUS_WARNING;
-            goto Finish;
+            //
+            // Keep the malformed line so the warning comes out in the same
+            // place when the file is processed. Nothing after it is used.
+            //
+            Status = AddInclude (&Tail, "", SearchAllPaths, LineNum, EndChar);
+            break;
           }
         }
       }
     }
   }
-  //
-  // Pop the file path from ParentPaths
-  //
-  mGlobals.ParentPaths = ParentPath.Next;  
 
-Finish:
-  //
-  // Close open files and return status
-  //
-  if (Fptr != NULL) {
-    fclose (Fptr);
+  fclose (Fptr);
+  if (Status != STATUS_SUCCESS) {
+    FreeIncludes (*Includes);
+    *Includes = NULL;
   }
 
   return Status;
 }
 
+
 static
 STATUS
 ProcessClOutput (
@@ -940,14 +1124,13 @@ ReplaceSymbols (
 // Given a filename, try to find it along the include paths.
 //
 static
-FILE *
+BOOLEAN
 FindFile (
   INT8              *FileName,
   UINT32            FileNameLen,
   FILE_SEARCH_TYPE  FileSearchType
   )
 {
-  FILE        *Fptr;
   STRING_LIST *List;
   STRING_LIST *SubDir;
   INT8        FullFileName[MAX_PATH * 2];
@@ -971,14 +1154,14 @@ FindFile (
           List->Str,
           FileName
           );
-        return NULL;
+        return FALSE;
       }
       //
-      // Append the filename to this include path and try to open the file.
+      // Append the filename to this include path and see if the file is there.
       //
       strcpy (FullFileName, List->Str);
       strcat (FullFileName, FileName);
-      if ((Fptr = fopen (FullFileName, "r")) != NULL) {
+      if (FileExists (FullFileName)) {
         //
         // Return the file name
         //
@@ -987,11 +1170,11 @@ FindFile (
           //
           // fprintf (stdout, "File length > %d: %s\n", FileNameLen, FullFileName);
           //
-          return NULL;
+          return FALSE;
         }
   
         strcpy (FileName, FullFileName);
-        return Fptr;
+        return TRUE;
       }
   
       List = List->Next;
@@ -1013,14 +1196,14 @@ FindFile (
         List->Str,
         FileName
         );
-      return NULL;
+      return FALSE;
     }
     //
-    // Append the filename to this include path and try to open the file.
+    // Append the filename to this include path and see if the file is there.
     //
     strcpy (FullFileName, List->Str);
     strcat (FullFileName, FileName);
-    if ((Fptr = fopen (FullFileName, "r")) != NULL) {
+    if (FileExists (FullFileName)) {
       //
       // Return the file name
       //
@@ -1029,11 +1212,11 @@ FindFile (
         //
         // fprintf (stdout, "File length > %d: %s\n", FileNameLen, FullFileName);
         //
-        return NULL;
+        return FALSE;
       }
 
       strcpy (FileName, FullFileName);
-      return Fptr;
+      return TRUE;
     }
     //
     // Didn't find it there. Now try this directory with every subdirectory
@@ -1043,17 +1226,17 @@ FindFile (
       strcpy (FullFileName, List->Str);
       strcat (FullFileName, SubDir->Str);
       strcat (FullFileName, FileName);
-      if ((Fptr = fopen (FullFileName, "r")) != NULL) {
+      if (FileExists (FullFileName)) {
         //
         // Return the file name
         //
         if (FileNameLen <= strlen (FullFileName)) {
           Error (__FILE__, __LINE__, 0, "application error", "internal path name of insufficient length");
-          return NULL;
+          return FALSE;
         }
 
         strcpy (FileName, FullFileName);
-        return Fptr;
+        return TRUE;
       }
     }
 
@@ -1062,7 +1245,200 @@ FindFile (
   //
   // Not found
   //
-  return NULL;
+  return FALSE;
+}
+
+static
+UINT32
+HashFileName (
+  INT8    *FileName
+  )
+{
+  UINT32  Hash;
+
+  //
+  // File names are compared without case, so hash them that way too
+  //
+  for (Hash = 0; *FileName != 0; FileName++) {
+    Hash = (Hash * 31) + toupper (*FileName);
+  }
+
+  return Hash % FILE_HASH_SIZE;
+}
+
+static
+FILE_ENTRY *
+LookupFileEntry (
+  INT8    *FileName
+  )
+/*++
+
+Routine Description:
+
+  Find the entry of a file name in the file table, adding one if the
+  name is not in the table yet.
+
+Arguments:
+
+  FileName - the file name
+
+Returns:
+
+  The file entry, or NULL if out of memory.
+
+--*/
+{
+  FILE_ENTRY  *Entry;
+  UINT32      Hash;
+
+  Hash = HashFileName (FileName);
+  for (Entry = mFileHash[Hash]; Entry != NULL; Entry = Entry->Next) {
+    if (_stricmp (FileName, Entry->Name) == 0) {
+      return Entry;
+    }
+  }
+
+  Entry = malloc (sizeof (FILE_ENTRY));
+  if (Entry != NULL) {
+    memset (Entry, 0, sizeof (FILE_ENTRY));
+    Entry->Name = malloc (strlen (FileName) + 1);
+    if (Entry->Name == NULL) {
+      free (Entry);
+      Entry = NULL;
+    }
+  }
+
+  if (Entry == NULL) {
+    Error (__FILE__, __LINE__, 0, "memory allocation failure", NULL);
+    return NULL;
+  }
+
+  strcpy (Entry->Name, FileName);
+  Entry->State    = FileStateUnknown;
+  Entry->Next     = mFileHash[Hash];
+  mFileHash[Hash] = Entry;
+  return Entry;
+}
+
+static
+BOOLEAN
+FileExists (
+  INT8    *FileName
+  )
+/*++
+
+Routine Description:
+
+  See if a file exists. Each file is only looked up on disk once, so
+  include files shared by many source files, and the include paths they
+  are not in, are not probed over and over.
+
+Arguments:
+
+  FileName - the file name
+
+Returns:
+
+  TRUE if the file exists.
+
+--*/
+{
+  FILE_ENTRY                *Entry;
+  WIN32_FILE_ATTRIBUTE_DATA FileData;
+
+  Entry = LookupFileEntry (FileName);
+  if (Entry == NULL) {
+    return FALSE;
+  }
+
+  if (Entry->State == FileStateUnknown) {
+    if (GetFileAttributesEx (FileName, GetFileExInfoStandard, &FileData) &&
+        ((FileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)) {
+      Entry->State = FileStatePresent;
+    } else {
+      Entry->State = FileStateMissing;
+    }
+  }
+
+  return (BOOLEAN) (Entry->State == FileStatePresent);
+}
+
+static
+STATUS
+GetIncludeList (
+  INT8          *FileName,
+  INCLUDE_ITEM  **Includes
+  )
+/*++
+
+Routine Description:
+
+  Get the include lines of a file that FileExists() has found. The file
+  is only scanned the first time, whatever name it is reached by.
+
+Arguments:
+
+  FileName - the file name
+  Includes - the include list returned. It belongs to the file table.
+
+Returns:
+
+  standard status.
+
+--*/
+{
+  FILE_ENTRY  *Entry;
+  INT8        FullPath[MAX_PATH];
+  STATUS      Status;
+
+  Entry = LookupFileEntry (FileName);
+  if (Entry == NULL) {
+    return STATUS_ERROR;
+  }
+
+  if (Entry->FullPath == NULL) {
+    if (_fullpath (FullPath, FileName, sizeof (FullPath)) != NULL) {
+      Entry->FullPath = LookupFileEntry (FullPath);
+      if (Entry->FullPath == NULL) {
+        return STATUS_ERROR;
+      }
+    } else {
+      Entry->FullPath = Entry;
+    }
+  }
+
+  Entry = Entry->FullPath;
+  if (!Entry->Scanned) {
+    Status = ScanIncludes (FileName, &Entry->Includes);
+    if (Status != STATUS_SUCCESS) {
+      return Status;
+    }
+
+    Entry->Scanned = TRUE;
+  }
+
+  *Includes = Entry->Includes;
+  return STATUS_SUCCESS;
+}
+
+static
+void
+FreeFileTable (
+  VOID
+  )
+{
+  FILE_ENTRY  *Entry;
+  UINT32      Index;
+
+  for (Index = 0; Index < FILE_HASH_SIZE; Index++) {
+    while (mFileHash[Index] != NULL) {
+      Entry            = mFileHash[Index];
+      mFileHash[Index] = Entry->Next;
+      FreeIncludes (Entry->Includes);
+      free (Entry->Name);
+      free (Entry);
+    }
+  }
 }
 //
 // Process the command-line arguments
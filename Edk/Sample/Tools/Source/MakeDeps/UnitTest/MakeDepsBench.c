@@ -0,0 +1,508 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  MakeDepsBench.c
+
+Abstract:
+
+  Benchmark and output check for MakeDeps.
+
+  The program writes a synthetic source tree under WorkDir: 480 C sources,
+  each including eight shared headers and a local one, and 300 headers
+  spread over three include directories. Each header includes up to six
+  others, some of them missing and some through EFI_PROTOCOL_DEFINITION.
+  25 empty include directories are searched first, the way a module build
+  passes the include paths of every package it uses.
+
+  It then runs MakeDeps on all the sources and times the run. Given a
+  reference MakeDeps, a build of an earlier version, it runs that first
+  and checks that both write the same dependency file.
+
+    MakeDepsBench MakeDeps WorkDir [ReferenceMakeDeps]
+
+--*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <direct.h>
+
+#define BENCH_SOURCES         480
+#define BENCH_HEADERS         300
+#define BENCH_SHARED_HEADERS  250
+#define BENCH_MISSING         20
+#define BENCH_EMPTY_PATHS     25
+#define BENCH_PROTOCOL_EVERY  37
+
+#define COUNT_OF(Array)  (sizeof (Array) / sizeof ((Array)[0]))
+
+//
+// The MakeDeps runs. An empty tool name runs the reference MakeDeps.
+//
+typedef struct {
+  char  *Name;
+  char  *Options;
+} BENCH_RUN;
+
+static BENCH_RUN  mRuns[] = {
+  { "reference", "" },
+  { "MakeDeps",  "" }
+};
+
+static char           *mHeaderDirs[] = { "inc", "inc2", "inc2\\sub" };
+
+static unsigned long  mSeed = 7;
+
+static
+unsigned
+Random (
+  unsigned  Limit
+  )
+/*++
+
+Routine Description:
+
+  A small linear congruential generator, so every run writes the same tree.
+
+Arguments:
+
+  Limit - The result is below Limit
+
+Returns:
+
+  A pseudo random number.
+
+--*/
+{
+  mSeed = mSeed * 1103515245 + 12345;
+  return (unsigned) ((mSeed >> 16) & 0x7FFF) % Limit;
+}
+
+static
+int
+WriteTreeFile (
+  char  *WorkDir,
+  char  *FileName,
+  char  *Text
+  )
+/*++
+
+Routine Description:
+
+  Write a text file of the tree.
+
+Arguments:
+
+  WorkDir  - Root of the tree
+  FileName - File name relative to WorkDir
+  Text     - Content of the file
+
+Returns:
+
+  0 on success, 1 if the file could not be written.
+
+--*/
+{
+  char  Path[_MAX_PATH];
+  FILE  *Fptr;
+
+  sprintf (Path, "%s\\%s", WorkDir, FileName);
+  if ((Fptr = fopen (Path, "w")) == NULL) {
+    printf ("MakeDepsBench: could not write %s\n", Path);
+    return 1;
+  }
+
+  fputs (Text, Fptr);
+  fclose (Fptr);
+  return 0;
+}
+
+static
+int
+WriteTree (
+  char  *WorkDir
+  )
+/*++
+
+Routine Description:
+
+  Write the synthetic source tree under WorkDir.
+
+Arguments:
+
+  WorkDir - Root of the tree
+
+Returns:
+
+  0 on success, 1 if a file could not be written.
+
+--*/
+{
+  char      Path[_MAX_PATH];
+  char      Name[_MAX_PATH];
+  char      Text[1024];
+  unsigned  Dir[BENCH_HEADERS];
+  unsigned  Index;
+  unsigned  Count;
+  unsigned  Include;
+
+  _mkdir (WorkDir);
+  for (Index = 0; Index < COUNT_OF (mHeaderDirs); Index++) {
+    sprintf (Path, "%s\\%s", WorkDir, mHeaderDirs[Index]);
+    _mkdir (Path);
+  }
+
+  for (Index = 1; Index <= BENCH_EMPTY_PATHS; Index++) {
+    sprintf (Path, "%s\\p%u", WorkDir, Index);
+    _mkdir (Path);
+  }
+
+  sprintf (Path, "%s\\src", WorkDir);
+  _mkdir (Path);
+  sprintf (Path, "%s\\inc\\Protocol", WorkDir);
+  _mkdir (Path);
+
+  for (Index = 0; Index < BENCH_HEADERS; Index++) {
+    Dir[Index] = Random (COUNT_OF (mHeaderDirs));
+  }
+
+  //
+  // Headers only include headers after them, names past the last header
+  // are missing
+  //
+  for (Index = 0; Index < BENCH_HEADERS; Index++) {
+    Text[0] = 0;
+    for (Count = Random (7); Count != 0; Count--) {
+      Include = Index + 1 + Random (BENCH_HEADERS + BENCH_MISSING - Index);
+      if (Include < BENCH_HEADERS) {
+        sprintf (Name, "h%u.h", Include);
+      } else {
+        sprintf (Name, "missing%u.h", Include);
+      }
+
+      if (Random (2) == 0) {
+        sprintf (Text + strlen (Text), "#include \"%s\"\n", Name);
+      } else {
+        sprintf (Text + strlen (Text), "  #  include <%s>\n", Name);
+      }
+    }
+
+    if (Index % BENCH_PROTOCOL_EVERY == 0) {
+      sprintf (Text + strlen (Text), "#include EFI_PROTOCOL_DEFINITION(P%u)\n", Index);
+
+      sprintf (Path, "%s\\inc\\Protocol\\P%u", WorkDir, Index);
+      _mkdir (Path);
+      sprintf (Name, "inc\\Protocol\\P%u\\P%u.h", Index, Index);
+      sprintf (Path, "#include \"h%u.h\"\n", (Index + 3 < BENCH_HEADERS) ? Index + 3 : BENCH_HEADERS - 1);
+      if (WriteTreeFile (WorkDir, Name, Path) != 0) {
+        return 1;
+      }
+    }
+
+    sprintf (Name, "%s\\h%u.h", mHeaderDirs[Dir[Index]], Index);
+    if (WriteTreeFile (WorkDir, Name, Text) != 0) {
+      return 1;
+    }
+  }
+
+  for (Index = 0; Index < BENCH_SOURCES; Index++) {
+    Text[0] = 0;
+    for (Count = 0; Count < 8; Count++) {
+      sprintf (Text + strlen (Text), "#include \"h%u.h\"\n", Random (BENCH_SHARED_HEADERS));
+    }
+
+    sprintf (Text + strlen (Text), "#include \"local%u.h\"\n", Index);
+    sprintf (Name, "src\\s%u.c", Index);
+    if (WriteTreeFile (WorkDir, Name, Text) != 0) {
+      return 1;
+    }
+
+    sprintf (Text, "#include <h%u.h>\n", Random (BENCH_HEADERS));
+    sprintf (Name, "src\\local%u.h", Index);
+    if (WriteTreeFile (WorkDir, Name, Text) != 0) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static
+char *
+BuildArguments (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Build the arguments every run passes: all the sources, the empty include
+  paths before the real ones, and the sub directory.
+
+Arguments:
+
+  None
+
+Returns:
+
+  The allocated argument string.
+
+--*/
+{
+  char      *Arguments;
+  unsigned  Index;
+
+  Arguments = malloc (BENCH_SOURCES * 32 + BENCH_EMPTY_PATHS * 16 + 256);
+  if (Arguments == NULL) {
+    return NULL;
+  }
+
+  Arguments[0] = 0;
+  for (Index = 0; Index < BENCH_SOURCES; Index++) {
+    sprintf (Arguments + strlen (Arguments), " -f src\\s%u.c", Index);
+  }
+
+  for (Index = 1; Index <= BENCH_EMPTY_PATHS; Index++) {
+    sprintf (Arguments + strlen (Arguments), " -i p%u", Index);
+  }
+
+  strcat (Arguments, " -i inc -i inc2 -s sub -ignorenotfound -q");
+  return Arguments;
+}
+
+static
+int
+RunMakeDeps (
+  char   *MakeDeps,
+  char   *WorkDir,
+  char   *Options,
+  char   *Arguments,
+  char   *OutputFile,
+  DWORD  *Elapsed
+  )
+/*++
+
+Routine Description:
+
+  Run MakeDeps in WorkDir and time it. The command line is longer than
+  the command interpreter takes, so the tool is started with CreateProcess.
+
+Arguments:
+
+  MakeDeps   - Path of the MakeDeps to run
+  WorkDir    - Root of the tree
+  Options    - Options of this run
+  Arguments  - Arguments of every run
+  OutputFile - Dependency file to write, relative to WorkDir
+  Elapsed    - Returns the run time in milliseconds
+
+Returns:
+
+  0 if MakeDeps succeeded, 1 otherwise.
+
+--*/
+{
+  char                 *Command;
+  STARTUPINFO          StartupInfo;
+  PROCESS_INFORMATION  ProcessInfo;
+  DWORD                Start;
+  DWORD                ExitCode;
+
+  Command = malloc (strlen (MakeDeps) + strlen (Options) + strlen (Arguments) + strlen (OutputFile) + 16);
+  if (Command == NULL) {
+    return 1;
+  }
+
+  sprintf (Command, "\"%s\" %s%s -o %s", MakeDeps, Options, Arguments, OutputFile);
+
+  memset (&StartupInfo, 0, sizeof (StartupInfo));
+  StartupInfo.cb = sizeof (StartupInfo);
+  Start = GetTickCount ();
+  if (!CreateProcess (NULL, Command, NULL, NULL, FALSE, 0, NULL, WorkDir, &StartupInfo, &ProcessInfo)) {
+    printf ("MakeDepsBench: could not run %s\n", MakeDeps);
+    free (Command);
+    return 1;
+  }
+
+  WaitForSingleObject (ProcessInfo.hProcess, INFINITE);
+  *Elapsed = GetTickCount () - Start;
+  GetExitCodeProcess (ProcessInfo.hProcess, &ExitCode);
+  CloseHandle (ProcessInfo.hThread);
+  CloseHandle (ProcessInfo.hProcess);
+  free (Command);
+
+  if (ExitCode != 0) {
+    printf ("MakeDepsBench: %s %s failed\n", MakeDeps, Options);
+    return 1;
+  }
+
+  return 0;
+}
+
+static
+char *
+ReadOutput (
+  char  *WorkDir,
+  char  *OutputFile,
+  long  *Size
+  )
+/*++
+
+Routine Description:
+
+  Read a dependency file written by a run.
+
+Arguments:
+
+  WorkDir    - Root of the tree
+  OutputFile - Dependency file, relative to WorkDir
+  Size       - Returns the file size
+
+Returns:
+
+  The allocated file content, NULL if it could not be read.
+
+--*/
+{
+  char  Path[_MAX_PATH];
+  FILE  *Fptr;
+  char  *Buffer;
+
+  sprintf (Path, "%s\\%s", WorkDir, OutputFile);
+  if ((Fptr = fopen (Path, "rb")) == NULL) {
+    return NULL;
+  }
+
+  fseek (Fptr, 0, SEEK_END);
+  *Size = ftell (Fptr);
+  fseek (Fptr, 0, SEEK_SET);
+  Buffer = malloc (*Size + 1);
+  if ((Buffer != NULL) && (fread (Buffer, 1, *Size, Fptr) != (size_t) *Size)) {
+    free (Buffer);
+    Buffer = NULL;
+  }
+
+  fclose (Fptr);
+  return Buffer;
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Write the tree, run the reference MakeDeps if given and MakeDeps, and
+  compare their outputs.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - MakeDeps, WorkDir and an optional reference MakeDeps
+
+Returns:
+
+  0 if every run succeeded and wrote the same output, 1 otherwise.
+
+--*/
+{
+  char      *Arguments;
+  char      *Expected;
+  char      *Actual;
+  char      *Tool;
+  char      OutputFile[32];
+  long      ExpectedSize;
+  long      ActualSize;
+  unsigned  Index;
+  DWORD     Elapsed;
+  int       Failed;
+
+  if (argc < 3) {
+    printf ("usage: MakeDepsBench MakeDeps WorkDir [ReferenceMakeDeps]\n");
+    return 1;
+  }
+
+  if (WriteTree (argv[2]) != 0) {
+    return 1;
+  }
+
+  if ((Arguments = BuildArguments ()) == NULL) {
+    return 1;
+  }
+
+  printf (
+    "%u sources, %u headers, %u include paths\n",
+    BENCH_SOURCES,
+    BENCH_HEADERS,
+    BENCH_EMPTY_PATHS + 2
+    );
+  printf ("MakeDeps run                 time (ms)   output\n");
+
+  Failed       = 0;
+  Expected     = NULL;
+  ExpectedSize = 0;
+  for (Index = 0; Index < COUNT_OF (mRuns); Index++) {
+    Tool = argv[1];
+    if (Index == 0) {
+      if (argc < 4) {
+        continue;
+      }
+
+      Tool = argv[3];
+    }
+
+    sprintf (OutputFile, "Run%u.dep", Index);
+    if (RunMakeDeps (Tool, argv[2], mRuns[Index].Options, Arguments, OutputFile, &Elapsed) != 0) {
+      Failed = 1;
+      continue;
+    }
+
+    Actual = ReadOutput (argv[2], OutputFile, &ActualSize);
+    if (Actual == NULL) {
+      printf ("MakeDepsBench: could not read %s\n", OutputFile);
+      Failed = 1;
+      continue;
+    }
+
+    if (Expected == NULL) {
+      Expected     = Actual;
+      ExpectedSize = ActualSize;
+      printf ("%-28s %9u   %ld bytes\n", mRuns[Index].Name, (unsigned) Elapsed, ActualSize);
+      continue;
+    }
+
+    if ((ActualSize != ExpectedSize) || (memcmp (Actual, Expected, ActualSize) != 0)) {
+      printf ("%-28s %9u   DIFFERENT\n", mRuns[Index].Name, (unsigned) Elapsed);
+      Failed = 1;
+    } else {
+      printf ("%-28s %9u   same\n", mRuns[Index].Name, (unsigned) Elapsed);
+    }
+
+    free (Actual);
+  }
+
+  free (Expected);
+  free (Arguments);
+
+  if (Failed) {
+    printf ("MakeDepsBench: the runs did not all write the same output\n");
+    return 1;
+  }
+
+  printf ("MakeDepsBench: all runs wrote the same output\n");
+  return 0;
+}
@@ -80,13 +80,15 @@ typedef struct {
 // their list of strings.
 //
 typedef struct _STRING_LIST {
-  struct _STRING_LIST *Next;
-  UINT32              Size;         // number of bytes in string, including null terminator
-  WCHAR               *LanguageName;
-  WCHAR               *StringName;  // for example STR_ID_TEXT1
-  WCHAR               *Scope;       //
-  WCHAR               *Str;         // the actual string
-  UINT16              Flags;        // properties of this string (used, undefined)
+  struct _STRING_LIST   *Next;
+  struct _STRING_LIST   *HashNext;    // next string in the same StringHash[] bucket
+  struct _LANGUAGE_LIST *Lang;        // language list the string is on
+  UINT32                Size;         // number of bytes in string, including null terminator
+  WCHAR                 *LanguageName;
+  WCHAR                 *StringName;  // for example STR_ID_TEXT1
+  WCHAR                 *Scope;       //
+  WCHAR                 *Str;         // the actual string
+  UINT16                Flags;        // properties of this string (used, undefined)
 } STRING_LIST;
 
 typedef struct _LANGUAGE_LIST {
@@ -103,10 +105,19 @@ typedef struct _LANGUAGE_LIST {
 //
 typedef struct _STRING_IDENTIFIER {
   struct _STRING_IDENTIFIER *Next;
+  struct _STRING_IDENTIFIER *HashNext;  // next identifier in the same IdentifierHash[] bucket
   UINT32                    Index;  // only need 16 bits, but makes it easier with UINT32
   WCHAR                     *StringName;
   UINT16                    Flags;  // if someone referenced it via STRING_TOKEN()
 } STRING_IDENTIFIER;
+
+//
+// String identifiers are hashed by name, and strings by language name plus
+// string name. Both sizes must be powers of 2.
+//
+#define IDENTIFIER_HASH_SIZE  0x1000
+#define STRING_HASH_SIZE      0x2000
+
 //
 // Keep our globals in this structure to be as modular as possible.
 //
@@ -122,8 +133,22 @@ typedef struct {
   UINT32            NumStringIdentifiersReferenced;
   STRING_IDENTIFIER *CurrentStringIdentifier; // keep track of the last string identifier they added
   WCHAR             *CurrentScope;
+  STRING_IDENTIFIER *IdentifierHash[IDENTIFIER_HASH_SIZE];
+  STRING_LIST       *StringHash[STRING_HASH_SIZE];
+  STRING_IDENTIFIER **IdentifierTable;        // string identifiers by index, built on demand
+  UINT32            IdentifierTableSize;
+  BOOLEAN           IdentifierTableValid;
 } STRING_DB_DATA;
 
+//
+// The database file is read into memory in one piece and parsed from there.
+//
+typedef struct {
+  UINT8   *Buffer;
+  UINT32  Size;
+  UINT32  Offset;
+} DB_READ_BUFFER;
+
 static STRING_DB_DATA mDBData;
 
 static const char     *mSourceFileHeader[] = {
@@ -163,6 +188,13 @@ StringDBFindLanguageList (
   WCHAR *LanguageName
   );
 
+static
+UINT32
+StringDBHashName (
+  WCHAR   *Name,
+  UINT32  Hash
+  );
+
 static
 void
 StringDBWriteStandardFileHeader (
@@ -193,7 +225,7 @@ StringDBWriteStringIdentifier (
 static
 STATUS
 StringDBReadStringIdentifier (
-  FILE                *DBFptr
+  DB_READ_BUFFER      *DBBuffer
   );
 
 static
@@ -207,7 +239,7 @@ StringDBWriteLanguageDefinition (
 static
 STATUS
 StringDBReadLanguageDefinition (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
   );
 
 static
@@ -224,15 +256,23 @@ StringDBWriteString (
 static
 STATUS
 StringDBReadString (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
+  );
+
+static
+STATUS
+StringDBReadData (
+  DB_READ_BUFFER  *DBBuffer,
+  VOID            *Data,
+  UINT32          Size
   );
 
 static
 STATUS
 StringDBReadGenericString (
-  FILE      *DBFptr,
-  UINT16    *Size,
-  WCHAR     **Str
+  DB_READ_BUFFER  *DBBuffer,
+  UINT16          *Size,
+  WCHAR           **Str
   );
 
 static
@@ -328,6 +368,11 @@ StringDBDestructor (
     FREE (mDBData.StringIdentifier);
     mDBData.StringIdentifier = NextIdentifier;
   }
+
+  if (mDBData.IdentifierTable != NULL) {
+    FREE (mDBData.IdentifierTable);
+    mDBData.IdentifierTable = NULL;
+  }
   //
   // Free the filename
   //
@@ -881,6 +926,7 @@ StringDBAddStringIdentifier (
   )
 {
   STRING_IDENTIFIER *StringIdentifier;
+  STRING_IDENTIFIER **Link;
   STATUS            Status;
   //
   // If it was already used for some other language, then we don't
@@ -936,6 +982,16 @@ StringDBAddStringIdentifier (
   mDBData.LastStringIdentifier    = StringIdentifier;
   mDBData.CurrentStringIdentifier = StringIdentifier;
   *NewId                          = (UINT16) StringIdentifier->Index;
+  //
+  // And to the end of its hash chain, so lookups still find the first one added
+  //
+  Link = &mDBData.IdentifierHash[StringDBHashName (StringName, 0) & (IDENTIFIER_HASH_SIZE - 1)];
+  while (*Link != NULL) {
+    Link = &(*Link)->HashNext;
+  }
+
+  *Link = StringIdentifier;
+  mDBData.IdentifierTableValid = FALSE;
   return Status;
 }
 
@@ -979,6 +1035,7 @@ StringDBAddString (
   LANGUAGE_LIST     *Lang;
   UINT32            Size;
   STRING_LIST       *Str;
+  STRING_LIST       **Link;
   UINT16            StringIndex;
   WCHAR             TempLangName[4];
   STRING_IDENTIFIER *StringIdentifier;
@@ -1090,6 +1147,7 @@ StringDBAddString (
 
   memset ((char *) Str, 0, sizeof (STRING_LIST));
   Size              = (wcslen (String) + 1) * sizeof (WCHAR);
+  Str->Lang         = Lang;
   Str->Flags        = Flags;
   Str->Scope        = Scope;
   Str->StringName   = StringIdentifier->StringName;
@@ -1119,6 +1177,15 @@ StringDBAddString (
   }
 
   Lang->LastString = Str;
+  //
+  // Keep the hash chains in the same order as the language lists
+  //
+  Link = &mDBData.StringHash[StringDBHashName (Str->StringName, StringDBHashName (Lang->LanguageName, 0)) & (STRING_HASH_SIZE - 1)];
+  while (*Link != NULL) {
+    Link = &(*Link)->HashNext;
+  }
+
+  *Link = Str;
   return STATUS_SUCCESS;
 }
 
@@ -1280,13 +1347,13 @@ StringDBFindStringIdentifierByName (
 {
   STRING_IDENTIFIER *Identifier;
 
-  Identifier = mDBData.StringIdentifier;
+  Identifier = mDBData.IdentifierHash[StringDBHashName (StringName, 0) & (IDENTIFIER_HASH_SIZE - 1)];
   while (Identifier != NULL) {
     if (wcscmp (StringName, Identifier->StringName) == 0) {
       return Identifier;
     }
 
-    Identifier = Identifier->Next;
+    Identifier = Identifier->HashNext;
   }
 
   return NULL;
@@ -1299,7 +1366,54 @@ StringDBFindStringIdentifierByIndex (
   )
 {
   STRING_IDENTIFIER *Identifier;
+  UINT32            Size;
+
+  //
+  // The dump routines look up every index in turn, so (re)build a table
+  // of the identifiers by index after any have been added or renumbered.
+  //
+  if (!mDBData.IdentifierTableValid) {
+    Size = 0;
+    for (Identifier = mDBData.StringIdentifier; Identifier != NULL; Identifier = Identifier->Next) {
+      if (Identifier->Index >= Size) {
+        Size = Identifier->Index + 1;
+      }
+    }
+
+    if (Size > mDBData.IdentifierTableSize) {
+      if (mDBData.IdentifierTable != NULL) {
+        FREE (mDBData.IdentifierTable);
+      }
+
+      mDBData.IdentifierTableSize = 0;
+      mDBData.IdentifierTable     = (STRING_IDENTIFIER **) MALLOC (Size * sizeof (STRING_IDENTIFIER *));
+      if (mDBData.IdentifierTable != NULL) {
+        mDBData.IdentifierTableSize = Size;
+      }
+    }
+
+    if (mDBData.IdentifierTable != NULL) {
+      memset (mDBData.IdentifierTable, 0, mDBData.IdentifierTableSize * sizeof (STRING_IDENTIFIER *));
+      for (Identifier = mDBData.StringIdentifier; Identifier != NULL; Identifier = Identifier->Next) {
+        if (mDBData.IdentifierTable[Identifier->Index] == NULL) {
+          mDBData.IdentifierTable[Identifier->Index] = Identifier;
+        }
+      }
 
+      mDBData.IdentifierTableValid = TRUE;
+    }
+  }
+
+  if (mDBData.IdentifierTableValid) {
+    if (StringIndex >= mDBData.IdentifierTableSize) {
+      return NULL;
+    }
+
+    return mDBData.IdentifierTable[StringIndex];
+  }
+  //
+  // Out of memory for the table, so fall back to walking the list
+  //
   Identifier = mDBData.StringIdentifier;
   while (Identifier != NULL) {
     if (Identifier->Index == StringIndex) {
@@ -1312,6 +1426,37 @@ StringDBFindStringIdentifierByIndex (
   return NULL;
 }
 
+/*++
+
+Routine Description:
+
+  Hash a string identifier or language name for the database lookup tables.
+
+Arguments:
+
+  Name    - the name to hash
+  Hash    - starting value, to chain the hashes of several names
+
+Returns:
+
+  The hash value. Callers mask it to their table size.
+
+--*/
+static
+UINT32
+StringDBHashName (
+  WCHAR   *Name,
+  UINT32  Hash
+  )
+{
+  while (*Name != 0) {
+    Hash = Hash * 31 + (UINT32) *Name;
+    Name++;
+  }
+
+  return Hash;
+}
+
 /*****************************************************************************/
 static
 void
@@ -1484,9 +1629,12 @@ StringDBReadDatabase (
   STATUS              Status;
   FILE                *DBFptr;
   DB_DATA_ITEM_HEADER DataItemHeader;
+  DB_READ_BUFFER      DBBuffer;
+  long                FileSize;
 
-  Status  = STATUS_SUCCESS;
-  DBFptr  = NULL;
+  Status          = STATUS_SUCCESS;
+  DBFptr          = NULL;
+  DBBuffer.Buffer = NULL;
   //
   //  if (Verbose) {
   //    fprintf (stdout, "Reading database file %s\n", DBFileName);
@@ -1503,9 +1651,38 @@ StringDBReadDatabase (
     return STATUS_ERROR;
   }
   //
+  // Read the whole file in with one read, then parse the items from memory
+  //
+  fseek (DBFptr, 0, SEEK_END);
+  FileSize = ftell (DBFptr);
+  fseek (DBFptr, 0, SEEK_SET);
+  if (FileSize < 0) {
+    Error (NULL, 0, 0, DBFileName, "failed to get the size of the database file");
+    Status = STATUS_ERROR;
+    goto Finish;
+  }
+
+  DBBuffer.Size   = (UINT32) FileSize;
+  DBBuffer.Offset = 0;
+  DBBuffer.Buffer = (UINT8 *) MALLOC (DBBuffer.Size + 1);
+  if (DBBuffer.Buffer == NULL) {
+    Error (NULL, 0, 0, NULL, "memory allocation failed reading the database");
+    Status = STATUS_ERROR;
+    goto Finish;
+  }
+
+  if (fread (DBBuffer.Buffer, 1, DBBuffer.Size, DBFptr) != DBBuffer.Size) {
+    Error (NULL, 0, 0, DBFileName, "failed to read database file");
+    Status = STATUS_ERROR;
+    goto Finish;
+  }
+
+  fclose (DBFptr);
+  DBFptr = NULL;
+  //
   // Read and verify the database header
   //
-  if (fread ((void *) &DbHeader, sizeof (STRING_DB_HEADER), 1, DBFptr) != 1) {
+  if (StringDBReadData (&DBBuffer, &DbHeader, sizeof (STRING_DB_HEADER)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, DBFileName, "failed to read header from database file");
     Status = STATUS_ERROR;
     goto Finish;
@@ -1525,18 +1702,18 @@ StringDBReadDatabase (
   //
   // Read remaining items
   //
-  while (fread (&DataItemHeader, sizeof (DataItemHeader), 1, DBFptr) == 1) {
+  while (StringDBReadData (&DBBuffer, &DataItemHeader, sizeof (DataItemHeader)) == STATUS_SUCCESS) {
     switch (DataItemHeader.DataType) {
     case DB_DATA_TYPE_STRING_IDENTIFIER:
-      StringDBReadStringIdentifier (DBFptr);
+      StringDBReadStringIdentifier (&DBBuffer);
       break;
 
     case DB_DATA_TYPE_LANGUAGE_DEFINITION:
-      StringDBReadLanguageDefinition (DBFptr);
+      StringDBReadLanguageDefinition (&DBBuffer);
       break;
 
     case DB_DATA_TYPE_STRING_DEFINITION:
-      StringDBReadString (DBFptr);
+      StringDBReadString (&DBBuffer);
       break;
 
     default:
@@ -1547,7 +1724,7 @@ StringDBReadDatabase (
         "database corrupted",
         "invalid data item type 0x%X at offset 0x%X",
         (UINT32) DataItemHeader.DataType,
-        ftell (DBFptr) - sizeof (DataItemHeader)
+        DBBuffer.Offset - sizeof (DataItemHeader)
         );
       Status = STATUS_ERROR;
       goto Finish;
@@ -1558,6 +1735,12 @@ Finish:
   if (DBFptr != NULL) {
     fclose (DBFptr);
   }
+  //
+  // Everything read from the buffer has been copied into the database
+  //
+  if (DBBuffer.Buffer != NULL) {
+    FREE (DBBuffer.Buffer);
+  }
 
   return Status;
 }
@@ -1970,7 +2153,7 @@ StringDBWriteStringIdentifier (
 static
 STATUS
 StringDBReadStringIdentifier (
-  FILE                *DBFptr
+  DB_READ_BUFFER      *DBBuffer
   )
 {
   WCHAR   *IdentifierName;
@@ -1978,17 +2161,17 @@ StringDBReadStringIdentifier (
   UINT16  StringId;
   UINT16  Size;
 
-  if (fread (&StringId, sizeof (StringId), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &StringId, sizeof (StringId)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read StringId from database", NULL);
     return STATUS_ERROR;
   }
 
-  if (fread (&Flags, sizeof (Flags), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &Flags, sizeof (Flags)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read StringId flags from database", NULL);
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &IdentifierName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &IdentifierName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
@@ -1996,7 +2179,6 @@ StringDBReadStringIdentifier (
   //
   // printf ("STRID:  0x%04X %S\n", (UINT32)StringId, IdentifierName);
   //
-  FREE (IdentifierName);
   return STATUS_SUCCESS;
 }
 
@@ -2048,7 +2230,7 @@ StringDBWriteString (
 static
 STATUS
 StringDBReadString (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
   )
 {
   UINT16  Flags;
@@ -2058,24 +2240,24 @@ StringDBReadString (
   WCHAR   *Scope;
   WCHAR   *Str;
 
-  if (fread (&Flags, sizeof (Flags), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &Flags, sizeof (Flags)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read string flags from database", NULL);
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &Language) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &Language) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &StringName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &StringName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &Scope) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &Scope) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &Str) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &Str) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
   //
@@ -2089,16 +2271,6 @@ StringDBReadString (
   //
   // printf ("DBReadString: %S.%S.%S\n", Language, StringName, Scope);
   //
-  FREE (Language);
-  FREE (StringName);
-  if (Str != NULL) {
-    FREE (Str);
-  }
-
-  if (Scope != NULL) {
-    FREE (Scope);
-  }
-
   return STATUS_SUCCESS;
 }
 
@@ -2132,7 +2304,7 @@ StringDBWriteLanguageDefinition (
 static
 STATUS
 StringDBReadLanguageDefinition (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
   )
 {
   WCHAR   *LanguageName;
@@ -2140,60 +2312,81 @@ StringDBReadLanguageDefinition (
   UINT16  Size;
   STATUS  Status;
 
-  if (StringDBReadGenericString (DBFptr, &Size, &LanguageName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &LanguageName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &PrintableLanguageName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &PrintableLanguageName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
   //
   // printf("LANG: %S %S\n", LanguageName, PrintableLanguageName);
   //
   Status = StringDBAddLanguage (LanguageName, PrintableLanguageName);
-  FREE (LanguageName);
-  FREE (PrintableLanguageName);
   return Status;
 }
 //
+// Copy the next Size bytes of the database buffer to Data and move past them.
+//
+static
+STATUS
+StringDBReadData (
+  DB_READ_BUFFER  *DBBuffer,
+  VOID            *Data,
+  UINT32          Size
+  )
+{
+  if (DBBuffer->Size - DBBuffer->Offset < Size) {
+    return STATUS_ERROR;
+  }
+
+  memcpy (Data, DBBuffer->Buffer + DBBuffer->Offset, Size);
+  DBBuffer->Offset += Size;
+  return STATUS_SUCCESS;
+}
+//
 // All unicode strings in the database consist of a UINT16 length
 // field, followed by the string itself. This routine reads one
-// of those and returns the info.
+// of those and returns the info. The string returned points into
+// the database buffer, so callers copy whatever they keep.
 //
 static
 STATUS
 StringDBReadGenericString (
-  FILE      *DBFptr,
-  UINT16    *Size,
-  WCHAR     **Str
+  DB_READ_BUFFER  *DBBuffer,
+  UINT16          *Size,
+  WCHAR           **Str
   )
 {
   UINT16  LSize;
   UINT16  Flags;
   WCHAR   *LStr;
 
-  if (fread (&LSize, sizeof (UINT16), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &LSize, sizeof (UINT16)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read a string length field from the database", NULL);
     return STATUS_ERROR;
   }
 
-  if (fread (&Flags, sizeof (UINT16), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &Flags, sizeof (UINT16)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read a string flags field from the database", NULL);
     return STATUS_ERROR;
   }
-
-  LStr = MALLOC (LSize);
-  if (LStr == NULL) {
-    Error (__FILE__, __LINE__, 0, "memory allocation failed reading the database", NULL);
-    return STATUS_ERROR;
-  }
-
-  if (fread (LStr, sizeof (WCHAR), (UINT32) LSize / sizeof (WCHAR), DBFptr) != (UINT32) LSize / sizeof (WCHAR)) {
+  //
+  // Every string was written with its null terminator. Check for it, since
+  // the string is used in place.
+  //
+  LStr = (WCHAR *) (DBBuffer->Buffer + DBBuffer->Offset);
+  if ((LSize < sizeof (WCHAR)) ||
+      ((LSize % sizeof (WCHAR)) != 0) ||
+      (DBBuffer->Size - DBBuffer->Offset < LSize) ||
+      (LStr[LSize / sizeof (WCHAR) - 1] != 0)
+      ) {
     Error (NULL, 0, 0, "failed to read string from database", NULL);
-    Error (NULL, 0, 0, "database read failure", "offset 0x%X", ftell (DBFptr));
-    free (LStr);
+    Error (NULL, 0, 0, "database read failure", "offset 0x%X", DBBuffer->Offset);
     return STATUS_ERROR;
   }
+
+  DBBuffer->Offset += LSize;
   //
   // printf ("DBR: %S\n", LStr);
   //
@@ -2291,10 +2484,11 @@ StringDBFindString (
   for (Lang = mDBData.LanguageList; Lang != NULL; Lang = Lang->Next) {
     if (wcscmp (LanguageName, Lang->LanguageName) == 0) {
       //
-      // Found language match. Try to find string name match
+      // Found language match. Try to find string name match in its hash chain
       //
-      for (CurrString = Lang->String; CurrString != NULL; CurrString = CurrString->Next) {
-        if (wcscmp (StringName, CurrString->StringName) == 0) {
+      CurrString = mDBData.StringHash[StringDBHashName (StringName, StringDBHashName (Lang->LanguageName, 0)) & (STRING_HASH_SIZE - 1)];
+      for (; CurrString != NULL; CurrString = CurrString->HashNext) {
+        if ((CurrString->Lang == Lang) && (wcscmp (StringName, CurrString->StringName) == 0)) {
           //
           // Found a string name match. See if we're supposed to find
           // a scope match.
@@ -2445,6 +2639,7 @@ StringDBAssignStringIndexes (
   }
 
   mDBData.NumStringIdentifiers = Index;
+  mDBData.IdentifierTableValid = FALSE;
 }
 
 static
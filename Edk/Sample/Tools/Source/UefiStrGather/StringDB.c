@@ -62,6 +62,13 @@ StringDBFindStringIdentifierByIndex (
   UINT32    Index
   );
 
+static
+UINT32
+StringDBHashName (
+  WCHAR   *Name,
+  UINT32  Hash
+  );
+
 static
 void
 StringDBWriteStandardFileHeader (
@@ -105,7 +112,7 @@ StringDBWriteStringIdentifier (
 static
 STATUS
 StringDBReadStringIdentifier (
-  FILE                *DBFptr
+  DB_READ_BUFFER      *DBBuffer
   );
 
 static
@@ -120,7 +127,7 @@ StringDBWriteLanguageDefinition (
 static
 STATUS
 StringDBReadLanguageDefinition (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
   );
 
 static
@@ -137,15 +144,23 @@ StringDBWriteString (
 static
 STATUS
 StringDBReadString (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
+  );
+
+static
+STATUS
+StringDBReadData (
+  DB_READ_BUFFER  *DBBuffer,
+  VOID            *Data,
+  UINT32          Size
   );
 
 static
 STATUS
 StringDBReadGenericString (
-  FILE      *DBFptr,
-  UINT16    *Size,
-  WCHAR     **Str
+  DB_READ_BUFFER  *DBBuffer,
+  UINT16          *Size,
+  WCHAR           **Str
   );
 
 static
@@ -242,6 +257,11 @@ StringDBDestructor (
     FREE (mDBData.StringIdentifier);
     mDBData.StringIdentifier = NextIdentifier;
   }
+
+  if (mDBData.IdentifierTable != NULL) {
+    FREE (mDBData.IdentifierTable);
+    mDBData.IdentifierTable = NULL;
+  }
   //
   // Free the filename
   //
@@ -358,6 +378,7 @@ StringDBAddStringIdentifier (
   )
 {
   STRING_IDENTIFIER *StringIdentifier;
+  STRING_IDENTIFIER **Link;
   STATUS            Status;
   //
   // If it was already used for some other language, then we don't
@@ -413,6 +434,16 @@ StringDBAddStringIdentifier (
   mDBData.LastStringIdentifier    = StringIdentifier;
   mDBData.CurrentStringIdentifier = StringIdentifier;
   *NewId                          = (UINT16) StringIdentifier->Index;
+  //
+  // And to the end of its hash chain, so lookups still find the first one added
+  //
+  Link = &mDBData.IdentifierHash[StringDBHashName (StringName, 0) & (IDENTIFIER_HASH_SIZE - 1)];
+  while (*Link != NULL) {
+    Link = &(*Link)->HashNext;
+  }
+
+  *Link = StringIdentifier;
+  mDBData.IdentifierTableValid = FALSE;
   return Status;
 }
 
@@ -456,6 +487,7 @@ StringDBAddString (
   LANGUAGE_LIST     *Lang;
   UINT32            Size;
   STRING_LIST       *Str;
+  STRING_LIST       **Link;
   UINT16            StringIndex;
   STRING_IDENTIFIER *StringIdentifier;
 
@@ -540,6 +572,7 @@ StringDBAddString (
 
   memset ((char *) Str, 0, sizeof (STRING_LIST));
   Size              = (wcslen (String) + 1) * sizeof (WCHAR);
+  Str->Lang         = Lang;
   Str->Flags        = Flags;
   Str->Scope        = Scope;
   Str->StringName   = StringIdentifier->StringName;
@@ -569,6 +602,15 @@ StringDBAddString (
   }
 
   Lang->LastString = Str;
+  //
+  // Keep the hash chains in the same order as the language lists
+  //
+  Link = &mDBData.StringHash[StringDBHashName (Str->StringName, StringDBHashName (Lang->LanguageName, 0)) & (STRING_HASH_SIZE - 1)];
+  while (*Link != NULL) {
+    Link = &(*Link)->HashNext;
+  }
+
+  *Link = Str;
   return STATUS_SUCCESS;
 }
 
@@ -764,13 +806,13 @@ StringDBFindStringIdentifierByName (
 {
   STRING_IDENTIFIER *Identifier;
 
-  Identifier = mDBData.StringIdentifier;
+  Identifier = mDBData.IdentifierHash[StringDBHashName (StringName, 0) & (IDENTIFIER_HASH_SIZE - 1)];
   while (Identifier != NULL) {
     if (wcscmp (StringName, Identifier->StringName) == 0) {
       return Identifier;
     }
 
-    Identifier = Identifier->Next;
+    Identifier = Identifier->HashNext;
   }
 
   return NULL;
@@ -783,7 +825,54 @@ StringDBFindStringIdentifierByIndex (
   )
 {
   STRING_IDENTIFIER *Identifier;
+  UINT32            Size;
+
+  //
+  // The dump routines look up every index in turn, so (re)build a table
+  // of the identifiers by index after any have been added or renumbered.
+  //
+  if (!mDBData.IdentifierTableValid) {
+    Size = 0;
+    for (Identifier = mDBData.StringIdentifier; Identifier != NULL; Identifier = Identifier->Next) {
+      if (Identifier->Index >= Size) {
+        Size = Identifier->Index + 1;
+      }
+    }
 
+    if (Size > mDBData.IdentifierTableSize) {
+      if (mDBData.IdentifierTable != NULL) {
+        FREE (mDBData.IdentifierTable);
+      }
+
+      mDBData.IdentifierTableSize = 0;
+      mDBData.IdentifierTable     = (STRING_IDENTIFIER **) MALLOC (Size * sizeof (STRING_IDENTIFIER *));
+      if (mDBData.IdentifierTable != NULL) {
+        mDBData.IdentifierTableSize = Size;
+      }
+    }
+
+    if (mDBData.IdentifierTable != NULL) {
+      memset (mDBData.IdentifierTable, 0, mDBData.IdentifierTableSize * sizeof (STRING_IDENTIFIER *));
+      for (Identifier = mDBData.StringIdentifier; Identifier != NULL; Identifier = Identifier->Next) {
+        if (mDBData.IdentifierTable[Identifier->Index] == NULL) {
+          mDBData.IdentifierTable[Identifier->Index] = Identifier;
+        }
+      }
+
+      mDBData.IdentifierTableValid = TRUE;
+    }
+  }
+
+  if (mDBData.IdentifierTableValid) {
+    if (StringIndex >= mDBData.IdentifierTableSize) {
+      return NULL;
+    }
+
+    return mDBData.IdentifierTable[StringIndex];
+  }
+  //
+  // Out of memory for the table, so fall back to walking the list
+  //
   Identifier = mDBData.StringIdentifier;
   while (Identifier != NULL) {
     if (Identifier->Index == StringIndex) {
@@ -796,6 +885,37 @@ StringDBFindStringIdentifierByIndex (
   return NULL;
 }
 
+/*++
+
+Routine Description:
+
+  Hash a string identifier or language name for the database lookup tables.
+
+Arguments:
+
+  Name    - the name to hash
+  Hash    - starting value, to chain the hashes of several names
+
+Returns:
+
+  The hash value. Callers mask it to their table size.
+
+--*/
+static
+UINT32
+StringDBHashName (
+  WCHAR   *Name,
+  UINT32  Hash
+  )
+{
+  while (*Name != 0) {
+    Hash = Hash * 31 + (UINT32) *Name;
+    Name++;
+  }
+
+  return Hash;
+}
+
 /*****************************************************************************/
 static
 void
@@ -968,9 +1088,12 @@ StringDBReadDatabase (
   STATUS              Status;
   FILE                *DBFptr;
   DB_DATA_ITEM_HEADER DataItemHeader;
+  DB_READ_BUFFER      DBBuffer;
+  long                FileSize;
 
-  Status  = STATUS_SUCCESS;
-  DBFptr  = NULL;
+  Status          = STATUS_SUCCESS;
+  DBFptr          = NULL;
+  DBBuffer.Buffer = NULL;
   //
   //  if (Verbose) {
   //    fprintf (stdout, "Reading database file %s\n", DBFileName);
@@ -987,9 +1110,38 @@ StringDBReadDatabase (
     return STATUS_ERROR;
   }
   //
+  // Read the whole file in with one read, then parse the items from memory
+  //
+  fseek (DBFptr, 0, SEEK_END);
+  FileSize = ftell (DBFptr);
+  fseek (DBFptr, 0, SEEK_SET);
+  if (FileSize < 0) {
+    Error (NULL, 0, 0, DBFileName, "failed to get the size of the database file");
+    Status = STATUS_ERROR;
+    goto Finish;
+  }
+
+  DBBuffer.Size   = (UINT32) FileSize;
+  DBBuffer.Offset = 0;
+  DBBuffer.Buffer = (UINT8 *) MALLOC (DBBuffer.Size + 1);
+  if (DBBuffer.Buffer == NULL) {
+    Error (NULL, 0, 0, NULL, "memory allocation failed reading the database");
+    Status = STATUS_ERROR;
+    goto Finish;
+  }
+
+  if (fread (DBBuffer.Buffer, 1, DBBuffer.Size, DBFptr) != DBBuffer.Size) {
+    Error (NULL, 0, 0, DBFileName, "failed to read database file");
+    Status = STATUS_ERROR;
+    goto Finish;
+  }
+
+  fclose (DBFptr);
+  DBFptr = NULL;
+  //
   // Read and verify the database header
   //
-  if (fread ((void *) &DbHeader, sizeof (STRING_DB_HEADER), 1, DBFptr) != 1) {
+  if (StringDBReadData (&DBBuffer, &DbHeader, sizeof (STRING_DB_HEADER)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, DBFileName, "failed to read header from database file");
     Status = STATUS_ERROR;
     goto Finish;
@@ -1009,18 +1161,18 @@ StringDBReadDatabase (
   //
   // Read remaining items
   //
-  while (fread (&DataItemHeader, sizeof (DataItemHeader), 1, DBFptr) == 1) {
+  while (StringDBReadData (&DBBuffer, &DataItemHeader, sizeof (DataItemHeader)) == STATUS_SUCCESS) {
     switch (DataItemHeader.DataType) {
     case DB_DATA_TYPE_STRING_IDENTIFIER:
-      StringDBReadStringIdentifier (DBFptr);
+      StringDBReadStringIdentifier (&DBBuffer);
       break;
 
     case DB_DATA_TYPE_LANGUAGE_DEFINITION:
-      StringDBReadLanguageDefinition (DBFptr);
+      StringDBReadLanguageDefinition (&DBBuffer);
       break;
 
     case DB_DATA_TYPE_STRING_DEFINITION:
-      StringDBReadString (DBFptr);
+      StringDBReadString (&DBBuffer);
       break;
 
     default:
@@ -1031,7 +1183,7 @@ StringDBReadDatabase (
         "database corrupted",
         "invalid data item type 0x%X at offset 0x%X",
         (UINT32) DataItemHeader.DataType,
-        ftell (DBFptr) - sizeof (DataItemHeader)
+        DBBuffer.Offset - sizeof (DataItemHeader)
         );
       Status = STATUS_ERROR;
       goto Finish;
@@ -1042,6 +1194,12 @@ Finish:
   if (DBFptr != NULL) {
     fclose (DBFptr);
   }
+  //
+  // Everything read from the buffer has been copied into the database
+  //
+  if (DBBuffer.Buffer != NULL) {
+    FREE (DBBuffer.Buffer);
+  }
 
   return Status;
 }
@@ -1454,7 +1612,7 @@ StringDBWriteStringIdentifier (
 static
 STATUS
 StringDBReadStringIdentifier (
-  FILE                *DBFptr
+  DB_READ_BUFFER      *DBBuffer
   )
 {
   WCHAR   *IdentifierName;
@@ -1462,17 +1620,17 @@ StringDBReadStringIdentifier (
   UINT16  StringId;
   UINT16  Size;
 
-  if (fread (&StringId, sizeof (StringId), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &StringId, sizeof (StringId)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read StringId from database", NULL);
     return STATUS_ERROR;
   }
 
-  if (fread (&Flags, sizeof (Flags), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &Flags, sizeof (Flags)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read StringId flags from database", NULL);
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &IdentifierName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &IdentifierName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
@@ -1480,7 +1638,6 @@ StringDBReadStringIdentifier (
   //
   // printf ("STRID:  0x%04X %S\n", (UINT32)StringId, IdentifierName);
   //
-  FREE (IdentifierName);
   return STATUS_SUCCESS;
 }
 
@@ -1532,7 +1689,7 @@ StringDBWriteString (
 static
 STATUS
 StringDBReadString (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
   )
 {
   UINT16  Flags;
@@ -1542,24 +1699,24 @@ StringDBReadString (
   WCHAR   *Scope;
   WCHAR   *Str;
 
-  if (fread (&Flags, sizeof (Flags), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &Flags, sizeof (Flags)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read string flags from database", NULL);
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &Language) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &Language) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &StringName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &StringName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &Scope) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &Scope) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &Str) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &Str) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
   //
@@ -1573,16 +1730,6 @@ StringDBReadString (
   //
   // printf ("DBReadString: %S.%S.%S\n", Language, StringName, Scope);
   //
-  FREE (Language);
-  FREE (StringName);
-  if (Str != NULL) {
-    FREE (Str);
-  }
-
-  if (Scope != NULL) {
-    FREE (Scope);
-  }
-
   return STATUS_SUCCESS;
 }
 
@@ -1621,7 +1768,7 @@ StringDBWriteLanguageDefinition (
 static
 STATUS
 StringDBReadLanguageDefinition (
-  FILE            *DBFptr
+  DB_READ_BUFFER  *DBBuffer
   )
 {
   WCHAR   *LanguageName = NULL;
@@ -1630,15 +1777,15 @@ StringDBReadLanguageDefinition (
   UINT16  Size;
   STATUS  Status;
 
-  if (StringDBReadGenericString (DBFptr, &Size, &LanguageName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &LanguageName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &PrintableLanguageName) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &PrintableLanguageName) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
-  if (StringDBReadGenericString (DBFptr, &Size, &SecondaryLanguageList) != STATUS_SUCCESS) {
+  if (StringDBReadGenericString (DBBuffer, &Size, &SecondaryLanguageList) != STATUS_SUCCESS) {
     return STATUS_ERROR;
   }
 
@@ -1646,50 +1793,70 @@ StringDBReadLanguageDefinition (
   // printf("LANG: %S %S\n", LanguageName, PrintableLanguageName);
   //
   Status = StringDBAddLanguage (LanguageName, PrintableLanguageName, SecondaryLanguageList);
-  FREE (LanguageName);
-  FREE (PrintableLanguageName);
-  FREE (SecondaryLanguageList);
   return Status;
 }
 //
+// Copy the next Size bytes of the database buffer to Data and move past them.
+//
+static
+STATUS
+StringDBReadData (
+  DB_READ_BUFFER  *DBBuffer,
+  VOID            *Data,
+  UINT32          Size
+  )
+{
+  if (DBBuffer->Size - DBBuffer->Offset < Size) {
+    return STATUS_ERROR;
+  }
+
+  memcpy (Data, DBBuffer->Buffer + DBBuffer->Offset, Size);
+  DBBuffer->Offset += Size;
+  return STATUS_SUCCESS;
+}
+//
 // All unicode strings in the database consist of a UINT16 length
 // field, followed by the string itself. This routine reads one
-// of those and returns the info.
+// of those and returns the info. The string returned points into
+// the database buffer, so callers copy whatever they keep.
 //
 static
 STATUS
 StringDBReadGenericString (
-  FILE      *DBFptr,
-  UINT16    *Size,
-  WCHAR     **Str
+  DB_READ_BUFFER  *DBBuffer,
+  UINT16          *Size,
+  WCHAR           **Str
   )
 {
   UINT16  LSize;
   UINT16  Flags;
   WCHAR   *LStr;
 
-  if (fread (&LSize, sizeof (UINT16), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &LSize, sizeof (UINT16)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read a string length field from the database", NULL);
     return STATUS_ERROR;
   }
 
-  if (fread (&Flags, sizeof (UINT16), 1, DBFptr) != 1) {
+  if (StringDBReadData (DBBuffer, &Flags, sizeof (UINT16)) != STATUS_SUCCESS) {
     Error (NULL, 0, 0, "failed to read a string flags field from the database", NULL);
     return STATUS_ERROR;
   }
-
-  LStr = MALLOC (LSize);
-  if (LStr == NULL) {
-    Error (__FILE__, __LINE__, 0, "memory allocation failed reading the database", NULL);
-    return STATUS_ERROR;
-  }
-
-  if (fread (LStr, sizeof (WCHAR), (UINT32) LSize / sizeof (WCHAR), DBFptr) != (UINT32) LSize / sizeof (WCHAR)) {
+  //
+  // Every string was written with its null terminator. Check for it, since
+  // the string is used in place.
+  //
+  LStr = (WCHAR *) (DBBuffer->Buffer + DBBuffer->Offset);
+  if ((LSize < sizeof (WCHAR)) ||
+      ((LSize % sizeof (WCHAR)) != 0) ||
+      (DBBuffer->Size - DBBuffer->Offset < LSize) ||
+      (LStr[LSize / sizeof (WCHAR) - 1] != 0)
+      ) {
     Error (NULL, 0, 0, "failed to read string from database", NULL);
-    Error (NULL, 0, 0, "database read failure", "offset 0x%X", ftell (DBFptr));
-    free (LStr);
+    Error (NULL, 0, 0, "database read failure", "offset 0x%X", DBBuffer->Offset);
     return STATUS_ERROR;
   }
+
+  DBBuffer->Offset += LSize;
   //
   // printf ("DBR: %S\n", LStr);
   //
@@ -1787,10 +1954,11 @@ StringDBFindString (
   for (Lang = mDBData.LanguageList; Lang != NULL; Lang = Lang->Next) {
     if (wcscmp (LanguageName, Lang->LanguageName) == 0) {
       //
-      // Found language match. Try to find string name match
+      // Found language match. Try to find string name match in its hash chain
       //
-      for (CurrString = Lang->String; CurrString != NULL; CurrString = CurrString->Next) {
-        if (wcscmp (StringName, CurrString->StringName) == 0) {
+      CurrString = mDBData.StringHash[StringDBHashName (StringName, StringDBHashName (Lang->LanguageName, 0)) & (STRING_HASH_SIZE - 1)];
+      for (; CurrString != NULL; CurrString = CurrString->HashNext) {
+        if ((CurrString->Lang == Lang) && (wcscmp (StringName, CurrString->StringName) == 0)) {
           //
           // Found a string name match. See if we're supposed to find
           // a scope match.
@@ -1941,6 +2109,7 @@ StringDBAssignStringIndexes (
   }
 
   mDBData.NumStringIdentifiers = Index;
+  mDBData.IdentifierTableValid = FALSE;
 }
 
 static
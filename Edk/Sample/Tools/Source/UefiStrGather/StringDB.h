@@ -80,13 +80,15 @@ typedef struct {
 // their list of strings.
 //
 typedef struct _STRING_LIST {
-  struct _STRING_LIST *Next;
-  UINT32              Size;         // number of bytes in string, including null terminator
-  WCHAR               *LanguageName;
-  WCHAR               *StringName;  // for example STR_ID_TEXT1
-  WCHAR               *Scope;       //
-  WCHAR               *Str;         // the actual string
-  UINT16              Flags;        // properties of this string (used, undefined)
+  struct _STRING_LIST   *Next;
+  struct _STRING_LIST   *HashNext;    // next string in the same StringHash[] bucket
+  struct _LANGUAGE_LIST *Lang;        // language list the string is on
+  UINT32                Size;         // number of bytes in string, including null terminator
+  WCHAR                 *LanguageName;
+  WCHAR                 *StringName;  // for example STR_ID_TEXT1
+  WCHAR                 *Scope;       //
+  WCHAR                 *Str;         // the actual string
+  UINT16                Flags;        // properties of this string (used, undefined)
 } STRING_LIST;
 
 typedef struct _LANGUAGE_LIST {
@@ -104,10 +106,19 @@ typedef struct _LANGUAGE_LIST {
 //
 typedef struct _STRING_IDENTIFIER {
   struct _STRING_IDENTIFIER *Next;
+  struct _STRING_IDENTIFIER *HashNext;  // next identifier in the same IdentifierHash[] bucket
   UINT32                    Index;  // only need 16 bits, but makes it easier with UINT32
   WCHAR                     *StringName;
   UINT16                    Flags;  // if someone referenced it via STRING_TOKEN()
 } STRING_IDENTIFIER;
+
+//
+// String identifiers are hashed by name, and strings by language name plus
+// string name. Both sizes must be powers of 2.
+//
+#define IDENTIFIER_HASH_SIZE  0x1000
+#define STRING_HASH_SIZE      0x2000
+
 //
 // Keep our globals in this structure to be as modular as possible.
 //
@@ -123,8 +134,22 @@ typedef struct {
   UINT32            NumStringIdentifiersReferenced;
   STRING_IDENTIFIER *CurrentStringIdentifier; // keep track of the last string identifier they added
   WCHAR             *CurrentScope;
+  STRING_IDENTIFIER *IdentifierHash[IDENTIFIER_HASH_SIZE];
+  STRING_LIST       *StringHash[STRING_HASH_SIZE];
+  STRING_IDENTIFIER **IdentifierTable;        // string identifiers by index, built on demand
+  UINT32            IdentifierTableSize;
+  BOOLEAN           IdentifierTableValid;
 } STRING_DB_DATA;
 
+//
+// The database file is read into memory in one piece and parsed from there.
+//
+typedef struct {
+  UINT8   *Buffer;
+  UINT32  Size;
+  UINT32  Offset;
+} DB_READ_BUFFER;
+
 typedef struct _SPkgBlkBuffer {
   UINT32                mBlkSize;
   VOID                  *mBlkBuffer;
@@ -0,0 +1,1077 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  VfrStressTest.cpp
+
+Abstract:
+
+  Test and stress benchmark for the name databases of the VFR compiler in
+  VfrUtilityLib.cpp.
+
+  The test declares thousands of struct fields, varstores, questions,
+  default stores and rules, and checks every lookup against the values the
+  declarations imply: field offsets, types and sizes, varstore ids and
+  types, question ids and masks, default ids and rule ids. Same-named
+  fields of different types, a varstore name used by two kinds of store,
+  date questions, questions without a name, redefinitions and question id
+  updates are covered.
+
+  With -b the program makes the database calls VfrSyntax.g makes while it
+  parses the generated VFR written by -g, for 1000 to 16000 questions, and
+  times them.
+
+  With -g File Count the program writes that generated VFR: a struct of
+  Count fields, a buffer varstore of the struct and a form of Count numeric
+  questions, each but the first grayed out by an ideqval on the previous
+  one. With -c VfrCompile OutputDir it writes the VFR for each benchmark
+  size to OutputDir and times VfrCompile on it.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "VfrUtilityLib.h"
+#include "VfrFormPkg.h"
+
+#define TEST_TYPES            4
+#define TEST_FIELDS           3000
+#define TEST_VARSTORES        300
+#define TEST_QUESTIONS        3000
+#define TEST_FIXED_QUESTIONS  100
+#define TEST_FIXED_QID_BASE   0x4000
+#define TEST_DATES            50
+#define TEST_DEFAULT_STORES   100
+#define TEST_RULES            200
+
+#define COUNT_OF(Array)  (sizeof (Array) / sizeof ((Array)[0]))
+
+//
+// Internal field types, their size, alignment and IFR type
+//
+typedef struct {
+  char    *Name;
+  UINT32  Size;
+  UINT8   Type;
+} TEST_FIELD_TYPE;
+
+static TEST_FIELD_TYPE  mFieldTypes[] = {
+  { "UINT8",   1, EFI_IFR_TYPE_NUM_SIZE_8  },
+  { "UINT16",  2, EFI_IFR_TYPE_NUM_SIZE_16 },
+  { "UINT32",  4, EFI_IFR_TYPE_NUM_SIZE_32 },
+  { "UINT64",  8, EFI_IFR_TYPE_NUM_SIZE_64 },
+  { "BOOLEAN", 1, EFI_IFR_TYPE_BOOLEAN     }
+};
+
+static EFI_GUID  mStressGuid = { 0x3a1f3c6e, 0x5e2b, 0x4d4b, { 0x9c, 0x1a, 0x6f, 0x2e, 0x0d, 0x5b, 0x7a, 0x11 } };
+
+static UINT32    mBenchCounts[] = { 1000, 2000, 4000, 8000, 16000 };
+
+static UINT32    mFailures = 0;
+
+static
+VOID
+Check (
+  IN BOOLEAN  Condition,
+  IN char     *Test,
+  IN char     *What
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Condition - The result of the check
+  Test      - Name of the test
+  What      - The condition that was checked
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Condition) {
+    return ;
+  }
+
+  if (mFailures < 20) {
+    printf ("FAIL: %s: %s\n", Test, What);
+  }
+
+  mFailures++;
+}
+
+static
+INT8 *
+Name (
+  OUT INT8        *Buffer,
+  IN  const char  *Format,
+  IN  UINT32      Index
+  )
+/*++
+
+Routine Description:
+
+  Print a generated name, the way the tokens reach the databases.
+
+Arguments:
+
+  Buffer - Buffer of MAX_NAME_LEN * 2 characters
+  Format - printf format with one %u
+  Index  - The number in the name
+
+Returns:
+
+  Buffer
+
+--*/
+{
+  sprintf ((char *) Buffer, Format, (unsigned) Index);
+  return Buffer;
+}
+
+static
+UINT32
+FieldTypeIndex (
+  IN UINT32  Type,
+  IN UINT32  Field
+  )
+/*++
+
+Routine Description:
+
+  The type of a field of the test structs, each struct uses the types in
+  a different order.
+
+Arguments:
+
+  Type  - Number of the struct
+  Field - Number of the field
+
+Returns:
+
+  Index in mFieldTypes.
+
+--*/
+{
+  return (Field + Type) % COUNT_OF (mFieldTypes);
+}
+
+static
+UINT32
+FieldArrayNum (
+  IN UINT32  Field
+  )
+/*++
+
+Routine Description:
+
+  The array size of a field of the test structs, 0 if it is not an array.
+
+Arguments:
+
+  Field - Number of the field
+
+Returns:
+
+  The array size.
+
+--*/
+{
+  return (Field % 7 == 3) ? (Field % 5) + 2 : 0;
+}
+
+static
+VOID
+DeclareTestTypes (
+  IN  CVfrVarDataTypeDB  &TypeDB,
+  OUT UINT32             Offsets[TEST_TYPES][TEST_FIELDS],
+  OUT UINT32             Sizes[TEST_TYPES]
+  )
+/*++
+
+Routine Description:
+
+  Declare TEST_TYPES structs of TEST_FIELDS fields named Field0, Field1 ...
+  and compute the offsets the default pack(8) layout gives the fields.
+
+Arguments:
+
+  TypeDB  - The data type database
+  Offsets - Returns the offset of each field
+  Sizes   - Returns the size of each struct
+
+Returns:
+
+  None
+
+--*/
+{
+  INT8    Buffer[MAX_NAME_LEN * 2];
+  UINT32  Type;
+  UINT32  Field;
+  UINT32  Size;
+  UINT32  Align;
+  UINT32  TypeAlign;
+  UINT32  Count;
+  BOOLEAN Ok;
+
+  for (Type = 0; Type < TEST_TYPES; Type++) {
+    TypeDB.DeclareDataTypeBegin ();
+    Ok = (BOOLEAN) (TypeDB.SetNewTypeName (Name (Buffer, "STRESS_TYPE_%u", Type)) == VFR_RETURN_SUCCESS);
+    Check (Ok, "DeclareTestTypes", "SetNewTypeName of a new type succeeds");
+
+    Size      = 0;
+    TypeAlign = 1;
+    for (Field = 0; Field < TEST_FIELDS; Field++) {
+      Align = mFieldTypes[FieldTypeIndex (Type, Field)].Size;
+      if (Size % Align != 0) {
+        Size += Align - Size % Align;
+      }
+
+      Offsets[Type][Field] = Size;
+      Count = FieldArrayNum (Field);
+      Size += Align * ((Count == 0) ? 1 : Count);
+      if (Align > TypeAlign) {
+        TypeAlign = Align;
+      }
+
+      Ok = (BOOLEAN) (TypeDB.DataTypeAddField (
+                               Name (Buffer, "Field%u", Field),
+                               (INT8 *) mFieldTypes[FieldTypeIndex (Type, Field)].Name,
+                               Count
+                               ) == VFR_RETURN_SUCCESS);
+      Check (Ok, "DeclareTestTypes", "DataTypeAddField of a new field succeeds");
+    }
+
+    Ok = (BOOLEAN) (TypeDB.DataTypeAddField ((INT8 *) "Field7", (INT8 *) "UINT8", 0) == VFR_RETURN_REDEFINED);
+    Check (Ok, "DeclareTestTypes", "DataTypeAddField of a field of the struct is a redefinition");
+
+    TypeDB.DeclareDataTypeEnd ();
+
+    if (Size % TypeAlign != 0) {
+      Size += TypeAlign - Size % TypeAlign;
+    }
+
+    Sizes[Type] = Size;
+  }
+}
+
+static
+VOID
+TestDataTypes (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check the field lookups of GetDataFieldInfo on structs that share their
+  field names, a struct nesting another and an EFI_HII_DATE, and the
+  redefinition and undefined name errors.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  static UINT32      Offsets[TEST_TYPES][TEST_FIELDS];
+  UINT32             Sizes[TEST_TYPES];
+  CVfrVarDataTypeDB  *TypeDB;
+  INT8               Buffer[MAX_NAME_LEN * 2];
+  INT8               Path[MAX_NAME_LEN * 4];
+  UINT32             Type;
+  UINT32             Field;
+  UINT32             Count;
+  UINT32             Size;
+  UINT16             Offset;
+  UINT8              IfrType;
+  BOOLEAN            Ok;
+  TEST_FIELD_TYPE    *FieldType;
+
+  TypeDB = new CVfrVarDataTypeDB;
+  DeclareTestTypes (*TypeDB, Offsets, Sizes);
+
+  for (Type = 0; Type < TEST_TYPES; Type++) {
+    Ok = (BOOLEAN) (TypeDB->GetDataTypeSize (Name (Buffer, "STRESS_TYPE_%u", Type), &Size) == VFR_RETURN_SUCCESS);
+    Check (Ok && Size == Sizes[Type], "TestDataTypes", "GetDataTypeSize returns the padded struct size");
+    Check (TypeDB->IsTypeNameDefined (Buffer), "TestDataTypes", "IsTypeNameDefined finds the struct");
+
+    for (Field = 0; Field < TEST_FIELDS; Field++) {
+      FieldType = &mFieldTypes[FieldTypeIndex (Type, Field)];
+      Count     = FieldArrayNum (Field);
+
+      sprintf ((char *) Path, "STRESS_TYPE_%u.Field%u", (unsigned) Type, (unsigned) Field);
+      Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo (Path, Offset, IfrType, Size) == VFR_RETURN_SUCCESS);
+      Check (Ok, "TestDataTypes", "GetDataFieldInfo finds every field");
+      Check (Offset == Offsets[Type][Field], "TestDataTypes", "field offset");
+      Check (IfrType == FieldType->Type, "TestDataTypes", "field type");
+      Check (Size == FieldType->Size * ((Count == 0) ? 1 : Count), "TestDataTypes", "field size");
+
+      if (Count != 0) {
+        sprintf ((char *) Path, "STRESS_TYPE_%u.Field%u[%u]", (unsigned) Type, (unsigned) Field, (unsigned) (Count - 1));
+        Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo (Path, Offset, IfrType, Size) == VFR_RETURN_SUCCESS);
+        Check (Ok, "TestDataTypes", "GetDataFieldInfo finds the last array element");
+        Check (Offset == Offsets[Type][Field] + FieldType->Size * (Count - 1), "TestDataTypes", "array element offset");
+        Check (Size == FieldType->Size, "TestDataTypes", "array element size");
+
+        sprintf ((char *) Path, "STRESS_TYPE_%u.Field%u[%u]", (unsigned) Type, (unsigned) Field, (unsigned) Count);
+        Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo (Path, Offset, IfrType, Size) == VFR_RETURN_ERROR_ARRARY_NUM);
+        Check (Ok, "TestDataTypes", "an index past the array is an error");
+      }
+    }
+
+    sprintf ((char *) Path, "STRESS_TYPE_%u.Field%u", (unsigned) Type, (unsigned) TEST_FIELDS);
+    Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo (Path, Offset, IfrType, Size) == VFR_RETURN_UNDEFINED);
+    Check (Ok, "TestDataTypes", "a field of no struct is undefined");
+  }
+
+  //
+  // A struct nesting a test struct and a date
+  //
+  TypeDB->DeclareDataTypeBegin ();
+  TypeDB->SetNewTypeName ((INT8 *) "STRESS_NESTED");
+  TypeDB->DataTypeAddField ((INT8 *) "Flag", (INT8 *) "UINT8", 0);
+  TypeDB->DataTypeAddField ((INT8 *) "Inner", (INT8 *) "STRESS_TYPE_1", 0);
+  TypeDB->DataTypeAddField ((INT8 *) "Date", (INT8 *) "EFI_HII_DATE", 0);
+  Ok = (BOOLEAN) (TypeDB->DataTypeAddField ((INT8 *) "Outer", (INT8 *) "STRESS_TYPE_9", 0) == VFR_RETURN_UNDEFINED);
+  Check (Ok, "TestDataTypes", "a field of an undefined type is an error");
+  TypeDB->DeclareDataTypeEnd ();
+
+  sprintf ((char *) Path, "STRESS_NESTED.Inner.Field%u", (unsigned) (TEST_FIELDS - 1));
+  Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo (Path, Offset, IfrType, Size) == VFR_RETURN_SUCCESS);
+  Check (Ok && Offset == 8 + Offsets[1][TEST_FIELDS - 1], "TestDataTypes", "offset of a field of a nested struct");
+
+  Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo ((INT8 *) "STRESS_NESTED.Date.Day", Offset, IfrType, Size) == VFR_RETURN_SUCCESS);
+  Check (Ok && Offset == 8 + Sizes[1] + 2 && Size == 1, "TestDataTypes", "offset of the day of a date field");
+
+  Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo ((INT8 *) "STRESS_NESTED.Flag.Field0", Offset, IfrType, Size) == VFR_RETURN_UNDEFINED);
+  Check (Ok, "TestDataTypes", "a UINT8 has no fields");
+
+  Ok = (BOOLEAN) (TypeDB->GetDataFieldInfo ((INT8 *) "STRESS_NOSUCH.Field0", Offset, IfrType, Size) != VFR_RETURN_SUCCESS);
+  Check (Ok, "TestDataTypes", "a field of an undefined struct is an error");
+
+  TypeDB->DeclareDataTypeBegin ();
+  Ok = (BOOLEAN) (TypeDB->SetNewTypeName ((INT8 *) "STRESS_TYPE_2") == VFR_RETURN_REDEFINED);
+  Check (Ok, "TestDataTypes", "SetNewTypeName of a declared struct is a redefinition");
+  Ok = (BOOLEAN) (TypeDB->SetNewTypeName ((INT8 *) "UINT32") == VFR_RETURN_REDEFINED);
+  Check (Ok, "TestDataTypes", "SetNewTypeName of an internal type is a redefinition");
+  TypeDB->DeclareDataTypeEnd ();
+
+  delete TypeDB;
+}
+
+static
+VOID
+TestVarStores (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check the varstore lookups by name and id on buffer, EFI and name/value
+  varstores, the search order when two kinds of store have the same name,
+  and the redefinition and undefined name errors.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  static UINT32          Offsets[TEST_TYPES][TEST_FIELDS];
+  UINT32                 Sizes[TEST_TYPES];
+  CVfrVarDataTypeDB      *TypeDB;
+  CVfrDataStorage        *Storage;
+  INT8                   Buffer[MAX_NAME_LEN * 2];
+  INT8                   *StoreName;
+  INT8                   *TypeName;
+  UINT32                 Index;
+  EFI_VARSTORE_ID        Expected;
+  EFI_VARSTORE_ID        VarStoreId;
+  EFI_VFR_VARSTORE_TYPE  StoreType;
+  BOOLEAN                Ok;
+
+  TypeDB  = new CVfrVarDataTypeDB;
+  Storage = new CVfrDataStorage;
+  DeclareTestTypes (*TypeDB, Offsets, Sizes);
+
+  //
+  // Varstore ids are handed out from 1 in declaration order
+  //
+  for (Index = 0; Index < TEST_VARSTORES; Index++) {
+    switch (Index % 3) {
+    case 0:
+      Ok = (BOOLEAN) (Storage->DeclareBufferVarStore (
+                                 Name (Buffer, "Store%u", Index),
+                                 &mStressGuid,
+                                 TypeDB,
+                                 (INT8 *) ((Index % 2 == 0) ? "STRESS_TYPE_0" : "STRESS_TYPE_3"),
+                                 EFI_VARSTORE_ID_INVALID
+                                 ) == VFR_RETURN_SUCCESS);
+      break;
+
+    case 1:
+      Ok = (BOOLEAN) (Storage->DeclareEfiVarStore (
+                                 Name (Buffer, "Store%u", Index),
+                                 &mStressGuid,
+                                 (EFI_STRING_ID) Index,
+                                 1 << (Index % 4)
+                                 ) == VFR_RETURN_SUCCESS);
+      break;
+
+    default:
+      Ok = (BOOLEAN) (Storage->DeclareNameVarStoreBegin (Name (Buffer, "Store%u", Index)) == VFR_RETURN_SUCCESS);
+      Storage->NameTableAddItem ((EFI_STRING_ID) Index);
+      Storage->DeclareNameVarStoreEnd (&mStressGuid);
+      break;
+    }
+
+    Check (Ok, "TestVarStores", "a new varstore is declared");
+  }
+
+  for (Index = 0; Index < TEST_VARSTORES; Index++) {
+    Expected = (EFI_VARSTORE_ID) (Index + 1);
+    Name (Buffer, "Store%u", Index);
+
+    Ok = (BOOLEAN) (Storage->GetVarStoreId (Buffer, &VarStoreId) == VFR_RETURN_SUCCESS);
+    Check (Ok && VarStoreId == Expected, "TestVarStores", "GetVarStoreId returns the declared id");
+
+    Ok = (BOOLEAN) (Storage->GetVarStoreType (Buffer, StoreType) == VFR_RETURN_SUCCESS);
+    Check (
+      Ok && StoreType == ((Index % 3 == 0) ? EFI_VFR_VARSTORE_BUFFER : (Index % 3 == 1) ? EFI_VFR_VARSTORE_EFI : EFI_VFR_VARSTORE_NAME),
+      "TestVarStores",
+      "GetVarStoreType by name returns the kind of store"
+      );
+    Check (Storage->GetVarStoreType (Expected) == StoreType, "TestVarStores", "GetVarStoreType by id agrees with the name");
+
+    Ok = (BOOLEAN) (Storage->GetVarStoreName (Expected, &StoreName) == VFR_RETURN_SUCCESS);
+    Check (Ok && strcmp ((char *) StoreName, (char *) Buffer) == 0, "TestVarStores", "GetVarStoreName returns the declared name");
+
+    if (Index % 3 == 0) {
+      Ok = (BOOLEAN) (Storage->GetBufferVarStoreDataTypeName (Buffer, &TypeName) == VFR_RETURN_SUCCESS);
+      Check (
+        Ok && strcmp ((char *) TypeName, (Index % 2 == 0) ? "STRESS_TYPE_0" : "STRESS_TYPE_3") == 0,
+        "TestVarStores",
+        "GetBufferVarStoreDataTypeName returns the struct of the store"
+        );
+    } else {
+      Ok = (BOOLEAN) (Storage->GetBufferVarStoreDataTypeName (Buffer, &TypeName) == VFR_RETURN_UNDEFINED);
+      Check (Ok, "TestVarStores", "only buffer varstores have a struct");
+    }
+  }
+
+  Ok = (BOOLEAN) (Storage->GetVarStoreId ((INT8 *) "StoreNone", &VarStoreId) == VFR_RETURN_UNDEFINED);
+  Check (Ok && VarStoreId == EFI_VARSTORE_ID_INVALID, "TestVarStores", "an undeclared varstore is undefined");
+  Ok = (BOOLEAN) (Storage->GetVarStoreType ((INT8 *) "StoreNone", StoreType) == VFR_RETURN_UNDEFINED);
+  Check (Ok && StoreType == EFI_VFR_VARSTORE_INVALID, "TestVarStores", "an undeclared varstore has no type");
+
+  //
+  // A buffer store is found before a name/value store of the same name
+  //
+  Storage->DeclareNameVarStoreBegin ((INT8 *) "Shared");
+  Storage->NameTableAddItem (1);
+  Storage->DeclareNameVarStoreEnd (&mStressGuid);
+  Storage->DeclareBufferVarStore ((INT8 *) "Shared", &mStressGuid, TypeDB, (INT8 *) "STRESS_TYPE_1", EFI_VARSTORE_ID_INVALID);
+  Ok = (BOOLEAN) (Storage->GetVarStoreType ((INT8 *) "Shared", StoreType) == VFR_RETURN_SUCCESS);
+  Check (Ok && StoreType == EFI_VFR_VARSTORE_BUFFER, "TestVarStores", "the buffer store is found first");
+  Ok = (BOOLEAN) (Storage->GetVarStoreId ((INT8 *) "Shared", &VarStoreId) == VFR_RETURN_SUCCESS);
+  Check (Ok && VarStoreId == TEST_VARSTORES + 2, "TestVarStores", "the buffer store id is found first");
+
+  Ok = (BOOLEAN) (Storage->DeclareNameVarStoreBegin ((INT8 *) "Store2") == VFR_RETURN_REDEFINED);
+  Check (Ok, "TestVarStores", "a name/value store name is defined once");
+  Ok = (BOOLEAN) (Storage->DeclareBufferVarStore ((INT8 *) "Fixed", &mStressGuid, TypeDB, (INT8 *) "STRESS_TYPE_0", 5) == VFR_RETURN_VARSTOREID_REDEFINED);
+  Check (Ok, "TestVarStores", "a varstore id is used once");
+  Ok = (BOOLEAN) (Storage->DeclareBufferVarStore ((INT8 *) "Fixed", &mStressGuid, TypeDB, (INT8 *) "STRESS_NOSUCH", EFI_VARSTORE_ID_INVALID) != VFR_RETURN_SUCCESS);
+  Check (Ok, "TestVarStores", "a buffer store of an undefined struct is an error");
+
+  delete Storage;
+  delete TypeDB;
+}
+
+static
+VOID
+TestQuestions (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check the question lookups by name, by varid and by both, date questions,
+  a question without a name, question id updates, and the redefinition
+  errors.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  CVfrQuestionDB   *QuestionDB;
+  INT8             Buffer[MAX_NAME_LEN * 2];
+  INT8             VarId[MAX_NAME_LEN * 2];
+  UINT32           Index;
+  EFI_QUESTION_ID  QuestionId;
+  EFI_QUESTION_ID  Expected;
+  UINT32           Mask;
+  BOOLEAN          Ok;
+
+  QuestionDB = new CVfrQuestionDB;
+
+  //
+  // Questions with a fixed id first, the rest are handed out from 1
+  //
+  for (Index = 0; Index < TEST_FIXED_QUESTIONS; Index++) {
+    QuestionId = (EFI_QUESTION_ID) (TEST_FIXED_QID_BASE + Index);
+    Ok = (BOOLEAN) (QuestionDB->RegisterQuestion (
+                                  Name (Buffer, "Fixed%u", Index),
+                                  Name (VarId, "Data.Fixed%u", Index),
+                                  QuestionId
+                                  ) == VFR_RETURN_SUCCESS);
+    Check (Ok && QuestionId == TEST_FIXED_QID_BASE + Index, "TestQuestions", "a question keeps its fixed id");
+  }
+
+  for (Index = 0; Index < TEST_QUESTIONS; Index++) {
+    QuestionId = EFI_QUESTION_ID_INVALID;
+    Ok = (BOOLEAN) (QuestionDB->RegisterQuestion (
+                                  Name (Buffer, "Question%u", Index),
+                                  Name (VarId, "Data.Field%u", Index),
+                                  QuestionId
+                                  ) == VFR_RETURN_SUCCESS);
+    Check (Ok && QuestionId == Index + 1, "TestQuestions", "a question gets the next free id");
+  }
+
+  for (Index = 0; Index < TEST_QUESTIONS; Index++) {
+    Expected = (EFI_QUESTION_ID) (Index + 1);
+    Name (Buffer, "Question%u", Index);
+    Name (VarId, "Data.Field%u", Index);
+
+    QuestionDB->GetQuestionId (Buffer, NULL, QuestionId, Mask);
+    Check (QuestionId == Expected && Mask == 0, "TestQuestions", "GetQuestionId by name");
+    QuestionDB->GetQuestionId (NULL, VarId, QuestionId, Mask);
+    Check (QuestionId == Expected && Mask == 0, "TestQuestions", "GetQuestionId by varid");
+    QuestionDB->GetQuestionId (Buffer, VarId, QuestionId, Mask);
+    Check (QuestionId == Expected, "TestQuestions", "GetQuestionId by name and varid");
+
+    Name (VarId, "Data.Field%u", (Index + 1) % TEST_QUESTIONS);
+    QuestionDB->GetQuestionId (Buffer, VarId, QuestionId, Mask);
+    Check (QuestionId == EFI_QUESTION_ID_INVALID, "TestQuestions", "a name and the varid of another question match nothing");
+
+    Check (QuestionDB->FindQuestion (Buffer) == VFR_RETURN_SUCCESS, "TestQuestions", "FindQuestion by name");
+    Check (QuestionDB->FindQuestion (Expected) == VFR_RETURN_SUCCESS, "TestQuestions", "FindQuestion by id");
+  }
+
+  for (Index = 0; Index < TEST_FIXED_QUESTIONS; Index++) {
+    QuestionDB->GetQuestionId (NULL, Name (VarId, "Data.Fixed%u", Index), QuestionId, Mask);
+    Check (QuestionId == TEST_FIXED_QID_BASE + Index, "TestQuestions", "GetQuestionId by varid of a fixed id question");
+  }
+
+  QuestionDB->GetQuestionId ((INT8 *) "QuestionNone", NULL, QuestionId, Mask);
+  Check (QuestionId == EFI_QUESTION_ID_INVALID, "TestQuestions", "an undefined name has no id");
+  QuestionDB->GetQuestionId (NULL, (INT8 *) "Data.FieldNone", QuestionId, Mask);
+  Check (QuestionId == EFI_QUESTION_ID_INVALID, "TestQuestions", "an undefined varid has no id");
+  Check (QuestionDB->FindQuestion ((INT8 *) "QuestionNone") == VFR_RETURN_UNDEFINED, "TestQuestions", "FindQuestion of an undefined name");
+  Check (QuestionDB->FindQuestion ((EFI_QUESTION_ID) (TEST_QUESTIONS + 1)) == VFR_RETURN_UNDEFINED, "TestQuestions", "FindQuestion of a free id");
+
+  QuestionId = EFI_QUESTION_ID_INVALID;
+  Ok = (BOOLEAN) (QuestionDB->RegisterQuestion ((INT8 *) "Question5", NULL, QuestionId) == VFR_RETURN_REDEFINED);
+  Check (Ok, "TestQuestions", "a question name is defined once");
+  QuestionId = TEST_FIXED_QID_BASE;
+  Ok = (BOOLEAN) (QuestionDB->RegisterQuestion ((INT8 *) "QuestionNew", NULL, QuestionId) == VFR_RETURN_QUESTIONID_REDEFINED);
+  Check (Ok, "TestQuestions", "a question id is used once");
+
+  //
+  // Date questions register a question per date field, the name finds the
+  // year, each field its own mask
+  //
+  for (Index = 0; Index < TEST_DATES; Index++) {
+    QuestionId = EFI_QUESTION_ID_INVALID;
+    QuestionDB->RegisterNewDateQuestion (Name (Buffer, "Date%u", Index), Name (VarId, "Data.Date%u", Index), QuestionId);
+    Check (QuestionId == TEST_QUESTIONS + 1 + Index, "TestQuestions", "a date question gets one id");
+  }
+
+  for (Index = 0; Index < TEST_DATES; Index++) {
+    Expected = (EFI_QUESTION_ID) (TEST_QUESTIONS + 1 + Index);
+    QuestionDB->GetQuestionId (Name (Buffer, "Date%u", Index), NULL, QuestionId, Mask);
+    Check (QuestionId == Expected && Mask == DATE_YEAR_BITMASK, "TestQuestions", "GetQuestionId by date name");
+    QuestionDB->GetQuestionId (NULL, Name (VarId, "Data.Date%u.Month", Index), QuestionId, Mask);
+    Check (QuestionId == Expected && Mask == DATE_MONTH_BITMASK, "TestQuestions", "GetQuestionId by date month");
+    QuestionDB->GetQuestionId (Buffer, Name (VarId, "Data.Date%u.Day", Index), QuestionId, Mask);
+    Check (QuestionId == Expected && Mask == DATE_DAY_BITMASK, "TestQuestions", "GetQuestionId by date name and day");
+  }
+
+  //
+  // A question without a name is named $DEFAULT
+  //
+  QuestionId = EFI_QUESTION_ID_INVALID;
+  QuestionDB->RegisterQuestion (NULL, (INT8 *) "Data.Anonymous", QuestionId);
+  Expected = (EFI_QUESTION_ID) (TEST_QUESTIONS + TEST_DATES + 1);
+  Check (QuestionId == Expected, "TestQuestions", "a question without a name gets an id");
+  Check (QuestionDB->FindQuestion ((INT8 *) "$DEFAULT") == VFR_RETURN_SUCCESS, "TestQuestions", "FindQuestion of $DEFAULT");
+  QuestionDB->GetQuestionId ((INT8 *) "$DEFAULT", NULL, QuestionId, Mask);
+  Check (QuestionId == Expected, "TestQuestions", "GetQuestionId of $DEFAULT");
+  QuestionDB->GetQuestionId (NULL, (INT8 *) "Data.Anonymous", QuestionId, Mask);
+  Check (QuestionId == Expected, "TestQuestions", "GetQuestionId by varid of a question without a name");
+
+  //
+  // Moving a question to a new id
+  //
+  Ok = (BOOLEAN) (QuestionDB->UpdateQuestionId (6, 0x7000) == VFR_RETURN_SUCCESS);
+  Check (Ok, "TestQuestions", "UpdateQuestionId to a free id");
+  Check (QuestionDB->FindQuestion ((EFI_QUESTION_ID) 6) == VFR_RETURN_UNDEFINED, "TestQuestions", "the old id is free");
+  Check (QuestionDB->FindQuestion ((EFI_QUESTION_ID) 0x7000) == VFR_RETURN_SUCCESS, "TestQuestions", "the new id is used");
+  QuestionDB->GetQuestionId ((INT8 *) "Question5", NULL, QuestionId, Mask);
+  Check (QuestionId == 0x7000, "TestQuestions", "GetQuestionId returns the new id");
+  QuestionDB->GetQuestionId (NULL, (INT8 *) "Data.Field5", QuestionId, Mask);
+  Check (QuestionId == 0x7000, "TestQuestions", "GetQuestionId by varid returns the new id");
+  Ok = (BOOLEAN) (QuestionDB->UpdateQuestionId (7, 8) == VFR_RETURN_REDEFINED);
+  Check (Ok, "TestQuestions", "UpdateQuestionId to a used id");
+  Ok = (BOOLEAN) (QuestionDB->UpdateQuestionId (6, 0x7001) == VFR_RETURN_UNDEFINED);
+  Check (Ok, "TestQuestions", "UpdateQuestionId of a free id");
+
+  QuestionId = EFI_QUESTION_ID_INVALID;
+  QuestionDB->RegisterQuestion ((INT8 *) "QuestionNew", NULL, QuestionId);
+  Check (QuestionId == 6, "TestQuestions", "the freed id is handed out again");
+
+  delete QuestionDB;
+}
+
+static
+VOID
+TestDefaultStoresAndRules (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check the default store and rule lookups by name.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  CVfrDefaultStore  *DefaultStore;
+  CVfrRulesDB       *RulesDB;
+  INT8              Buffer[MAX_NAME_LEN * 2];
+  UINT32            Index;
+  UINT16            DefaultId;
+  BOOLEAN           Ok;
+
+  DefaultStore = new CVfrDefaultStore;
+  for (Index = 0; Index < TEST_DEFAULT_STORES; Index++) {
+    Ok = (BOOLEAN) (DefaultStore->RegisterDefaultStore (
+                                    NULL,
+                                    Name (Buffer, "Default%u", Index),
+                                    (EFI_STRING_ID) Index,
+                                    (UINT16) (Index * 3)
+                                    ) == VFR_RETURN_SUCCESS);
+    Check (Ok, "TestDefaultStoresAndRules", "a new default store is registered");
+  }
+
+  for (Index = 0; Index < TEST_DEFAULT_STORES; Index++) {
+    Ok = (BOOLEAN) (DefaultStore->GetDefaultId (Name (Buffer, "Default%u", Index), &DefaultId) == VFR_RETURN_SUCCESS);
+    Check (Ok && DefaultId == Index * 3, "TestDefaultStoresAndRules", "GetDefaultId returns the registered id");
+    Check (DefaultStore->DefaultIdRegistered ((UINT16) (Index * 3)), "TestDefaultStoresAndRules", "DefaultIdRegistered");
+  }
+
+  Ok = (BOOLEAN) (DefaultStore->GetDefaultId ((INT8 *) "DefaultNone", &DefaultId) == VFR_RETURN_UNDEFINED);
+  Check (Ok, "TestDefaultStoresAndRules", "an undefined default store has no id");
+  Ok = (BOOLEAN) (DefaultStore->RegisterDefaultStore (NULL, (INT8 *) "Default9", 1, 1) == VFR_RETURN_REDEFINED);
+  Check (Ok, "TestDefaultStoresAndRules", "a default store name is registered once");
+  delete DefaultStore;
+
+  //
+  // Rule ids are handed out from EFI_VARSTORE_ID_START
+  //
+  RulesDB = new CVfrRulesDB;
+  for (Index = 0; Index < TEST_RULES; Index++) {
+    RulesDB->RegisterRule (Name (Buffer, "Rule%u", Index));
+  }
+
+  for (Index = 0; Index < TEST_RULES; Index++) {
+    Check (
+      RulesDB->GetRuleId (Name (Buffer, "Rule%u", Index)) == EFI_VARSTORE_ID_START + Index,
+      "TestDefaultStoresAndRules",
+      "GetRuleId returns the registered id"
+      );
+  }
+
+  Check (RulesDB->GetRuleId ((INT8 *) "RuleNone") == EFI_RULE_ID_INVALID, "TestDefaultStoresAndRules", "an undefined rule has no id");
+  delete RulesDB;
+}
+
+static
+UINT32
+CompileLikeVfrSyntax (
+  IN UINT32  Count
+  )
+/*++
+
+Routine Description:
+
+  Make the database calls VfrSyntax.g makes for the VFR -g writes: declare
+  the struct and its varstore, then for every numeric question check its
+  name, resolve its varid, register it, and resolve the varid of the
+  ideqval that grays it out.
+
+Arguments:
+
+  Count - Number of questions
+
+Returns:
+
+  The number of ideqvals that found the previous question.
+
+--*/
+{
+  CVfrVarDataTypeDB      *TypeDB;
+  CVfrDataStorage        *Storage;
+  CVfrQuestionDB         *QuestionDB;
+  INT8                   Buffer[MAX_NAME_LEN * 2];
+  INT8                   VarId[MAX_NAME_LEN * 2];
+  INT8                   VarStr[MAX_NAME_LEN * 2];
+  INT8                   *TypeName;
+  UINT32                 Index;
+  UINT32                 Found;
+  EFI_VFR_VARSTORE_TYPE  StoreType;
+  EFI_VARSTORE_ID        VarStoreId;
+  EFI_QUESTION_ID        QuestionId;
+  UINT32                 Mask;
+  UINT16                 Offset;
+  UINT8                  IfrType;
+  UINT32                 Size;
+
+  TypeDB     = new CVfrVarDataTypeDB;
+  Storage    = new CVfrDataStorage;
+  QuestionDB = new CVfrQuestionDB;
+
+  TypeDB->DeclareDataTypeBegin ();
+  TypeDB->SetNewTypeName ((INT8 *) "STRESS_CONFIGURATION");
+  for (Index = 0; Index < Count; Index++) {
+    TypeDB->DataTypeAddField (Name (Buffer, "Field%u", Index), (INT8 *) ((Index % 2 == 0) ? "UINT8" : "UINT16"), 0);
+  }
+  TypeDB->DeclareDataTypeEnd ();
+
+  //
+  // gCVfrBufferConfig is global, on later runs it fails to register the
+  // store a second time after the store is declared
+  //
+  Storage->DeclareBufferVarStore ((INT8 *) "StressData", &mStressGuid, TypeDB, (INT8 *) "STRESS_CONFIGURATION", EFI_VARSTORE_ID_INVALID);
+
+  Found = 0;
+  for (Index = 0; Index < Count; Index++) {
+    if (Index != 0) {
+      QuestionDB->GetQuestionId (NULL, Name (VarId, "StressData.Field%u", Index - 1), QuestionId, Mask);
+      if (QuestionId != EFI_QUESTION_ID_INVALID) {
+        Found++;
+      }
+    }
+
+    QuestionDB->FindQuestion (Name (Buffer, "Question%u", Index));
+
+    Storage->GetVarStoreType ((INT8 *) "StressData", StoreType);
+    Storage->GetVarStoreId ((INT8 *) "StressData", &VarStoreId);
+    Storage->GetBufferVarStoreDataTypeName ((INT8 *) "StressData", &TypeName);
+    sprintf ((char *) VarStr, "%s.Field%u", (char *) TypeName, (unsigned) Index);
+    TypeDB->GetDataFieldInfo (VarStr, Offset, IfrType, Size);
+
+    QuestionId = EFI_QUESTION_ID_INVALID;
+    QuestionDB->RegisterQuestion (Buffer, Name (VarId, "StressData.Field%u", Index), QuestionId);
+  }
+
+  delete QuestionDB;
+  delete Storage;
+  delete TypeDB;
+
+  return Found;
+}
+
+static
+BOOLEAN
+WriteStressVfr (
+  IN char    *FileName,
+  IN UINT32  Count
+  )
+/*++
+
+Routine Description:
+
+  Write a VFR with a struct of Count fields, a buffer varstore of it and a
+  form of Count numeric questions, each but the first grayed out by an
+  ideqval on the previous one.
+
+Arguments:
+
+  FileName - The VFR file to write
+  Count    - Number of questions
+
+Returns:
+
+  TRUE if the file was written.
+
+--*/
+{
+  FILE    *File;
+  UINT32  Index;
+  char    *Indent;
+
+  if ((File = fopen (FileName, "w")) == NULL) {
+    printf ("VfrStressTest: could not open %s\n", FileName);
+    return FALSE;
+  }
+
+  fprintf (File, "//\n// Generated by VfrStressTest -g, %u questions\n//\n\n", (unsigned) Count);
+  fprintf (
+    File,
+    "#define STRESS_FORMSET_GUID { 0x%08x, 0x%04x, 0x%04x, 0x%02x, 0x%02x, 0x%02x, 0x%02x, 0x%02x, 0x%02x, 0x%02x, 0x%02x }\n\n",
+    (unsigned) mStressGuid.Data1,
+    (unsigned) mStressGuid.Data2,
+    (unsigned) mStressGuid.Data3,
+    (unsigned) mStressGuid.Data4[0],
+    (unsigned) mStressGuid.Data4[1],
+    (unsigned) mStressGuid.Data4[2],
+    (unsigned) mStressGuid.Data4[3],
+    (unsigned) mStressGuid.Data4[4],
+    (unsigned) mStressGuid.Data4[5],
+    (unsigned) mStressGuid.Data4[6],
+    (unsigned) mStressGuid.Data4[7]
+    );
+
+  fprintf (File, "typedef struct {\n");
+  for (Index = 0; Index < Count; Index++) {
+    fprintf (File, "  %-7s Field%u;\n", (Index % 2 == 0) ? "UINT8" : "UINT16", (unsigned) Index);
+  }
+  fprintf (File, "} STRESS_CONFIGURATION;\n\n");
+
+  fprintf (File, "formset\n");
+  fprintf (File, "  guid     = STRESS_FORMSET_GUID,\n");
+  fprintf (File, "  title    = STRING_TOKEN(0x0002),\n");
+  fprintf (File, "  help     = STRING_TOKEN(0x0003),\n\n");
+  fprintf (File, "  varstore STRESS_CONFIGURATION,\n");
+  fprintf (File, "    name  = StressData,\n");
+  fprintf (File, "    guid  = STRESS_FORMSET_GUID;\n\n");
+  fprintf (File, "  form formid = 1,\n");
+  fprintf (File, "       title  = STRING_TOKEN(0x0002);\n\n");
+
+  for (Index = 0; Index < Count; Index++) {
+    Indent = "    ";
+    if (Index != 0) {
+      fprintf (File, "    grayoutif ideqval StressData.Field%u == 0x1;\n", (unsigned) (Index - 1));
+      Indent = "      ";
+    }
+
+    fprintf (File, "%snumeric name    = Question%u,\n", Indent, (unsigned) Index);
+    fprintf (File, "%s        varid   = StressData.Field%u,\n", Indent, (unsigned) Index);
+    fprintf (File, "%s        prompt  = STRING_TOKEN(0x0004),\n", Indent);
+    fprintf (File, "%s        help    = STRING_TOKEN(0x0005),\n", Indent);
+    fprintf (File, "%s        minimum = 0,\n", Indent);
+    fprintf (File, "%s        maximum = 0xf0,\n", Indent);
+    fprintf (File, "%s        step    = 1,\n", Indent);
+    fprintf (File, "%sendnumeric;\n", Indent);
+
+    if (Index != 0) {
+      fprintf (File, "    endif;\n");
+    }
+
+    fprintf (File, "\n");
+  }
+
+  fprintf (File, "  endform;\n\n");
+  fprintf (File, "endformset;\n");
+
+  fclose (File);
+  return TRUE;
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Time the database calls made while parsing the generated VFR of growing
+  size.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT32   Index;
+  UINT32   Runs;
+  UINT32   Run;
+  UINT32   Found;
+  clock_t  Start;
+  double   Elapsed;
+
+  printf ("Questions   ideqval found   time (ms)\n");
+  for (Index = 0; Index < COUNT_OF (mBenchCounts); Index++) {
+    Runs  = (mBenchCounts[Index] <= 4000) ? 4 : 1;
+    Found = 0;
+
+    Start = clock ();
+    for (Run = 0; Run < Runs; Run++) {
+      Found = CompileLikeVfrSyntax (mBenchCounts[Index]);
+    }
+
+    Elapsed = (double) (clock () - Start) * 1000 / CLOCKS_PER_SEC / Runs;
+
+    if (Found != mBenchCounts[Index] - 1) {
+      printf ("VfrStressTest: %u of %u ideqvals found their question\n", (unsigned) Found, (unsigned) (mBenchCounts[Index] - 1));
+    }
+
+    printf ("%9u %15u %11.1f\n", (unsigned) mBenchCounts[Index], (unsigned) Found, Elapsed);
+  }
+}
+
+static
+int
+BenchmarkVfrCompile (
+  IN char  *VfrCompile,
+  IN char  *OutputDir
+  )
+/*++
+
+Routine Description:
+
+  Write the generated VFR for each benchmark size and time VfrCompile on it.
+  clock () is the elapsed time with the Microsoft C library, so it covers
+  the child process.
+
+Arguments:
+
+  VfrCompile - Path of VfrCompile.exe
+  OutputDir  - Directory for the VFR files and the compiler output
+
+Returns:
+
+  0 if every VFR compiled, 1 otherwise.
+
+--*/
+{
+  char     FileName[_MAX_PATH];
+  char     Command[_MAX_PATH * 3];
+  UINT32   Index;
+  int      Status;
+  clock_t  Start;
+  double   Elapsed;
+
+  printf ("Questions   VfrCompile (ms)\n");
+  for (Index = 0; Index < COUNT_OF (mBenchCounts); Index++) {
+    sprintf (FileName, "%s\\Stress%u.vfr", OutputDir, (unsigned) mBenchCounts[Index]);
+    if (!WriteStressVfr (FileName, mBenchCounts[Index])) {
+      return 1;
+    }
+
+    sprintf (Command, "\"%s\" -od \"%s\" \"%s\"", VfrCompile, OutputDir, FileName);
+    Start   = clock ();
+    Status  = system (Command);
+    Elapsed = (double) (clock () - Start) * 1000 / CLOCKS_PER_SEC;
+
+    if (Status != 0) {
+      printf ("VfrStressTest: %s failed on %s\n", VfrCompile, FileName);
+      return 1;
+    }
+
+    printf ("%9u %17.1f\n", (unsigned) mBenchCounts[Index], Elapsed);
+  }
+
+  return 0;
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, the benchmark with -b, write a generated VFR with
+  -g File Count or time VfrCompile on generated VFRs with
+  -c VfrCompile OutputDir.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  if (argc > 3 && strcmp (argv[1], "-g") == 0) {
+    return WriteStressVfr (argv[2], (UINT32) atoi (argv[3])) ? 0 : 1;
+  }
+
+  if (argc > 3 && strcmp (argv[1], "-c") == 0) {
+    return BenchmarkVfrCompile (argv[2], argv[3]);
+  }
+
+  TestDataTypes ();
+  TestVarStores ();
+  TestQuestions ();
+  TestDefaultStoresAndRules ();
+
+  if (mFailures != 0) {
+    printf ("VfrStressTest: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("VfrStressTest: all checks passed\n");
+  return 0;
+}
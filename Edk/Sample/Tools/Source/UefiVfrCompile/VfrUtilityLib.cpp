@@ -553,6 +553,120 @@ CVfrBufferConfig::~CVfrBufferConfig (
 
 CVfrBufferConfig gCVfrBufferConfig;
 
+CVfrHashTable::CVfrHashTable (
+  VOID
+  )
+{
+  UINT32 Index;
+
+  for (Index = 0; Index < VFR_HASH_TABLE_SIZE; Index++) {
+    mBucket[Index] = NULL;
+  }
+}
+
+CVfrHashTable::~CVfrHashTable (
+  VOID
+  )
+{
+  SVfrHashNode *pNode;
+  UINT32       Index;
+
+  for (Index = 0; Index < VFR_HASH_TABLE_SIZE; Index++) {
+    while (mBucket[Index] != NULL) {
+      pNode = mBucket[Index];
+      mBucket[Index] = mBucket[Index]->mNext;
+      delete pNode;
+    }
+  }
+}
+
+UINT32
+CVfrHashTable::Hash (
+  IN INT8   *Name,
+  IN VOID   *Scope
+  )
+{
+  UINT32 Value;
+
+  Value = (UINT32)(UINTN) Scope;
+  if (Name != NULL) {
+    for (; *Name != '\0'; Name++) {
+      Value = Value * 31 + (UINT8) *Name;
+    }
+  }
+
+  return Value % VFR_HASH_TABLE_SIZE;
+}
+
+EFI_VFR_RETURN_CODE
+CVfrHashTable::Insert (
+  IN INT8   *Name,
+  IN VOID   *Scope,
+  IN VOID   *Data
+  )
+{
+  SVfrHashNode *pNew;
+  UINT32       Index;
+
+  if ((pNew = new SVfrHashNode) == NULL) {
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
+  Index          = Hash (Name, Scope);
+  pNew->mName    = Name;
+  pNew->mScope   = Scope;
+  pNew->mData    = Data;
+  pNew->mNext    = mBucket[Index];
+  mBucket[Index] = pNew;
+
+  return VFR_RETURN_SUCCESS;
+}
+
+VOID
+CVfrHashTable::Remove (
+  IN INT8   *Name,
+  IN VOID   *Scope,
+  IN VOID   *Data
+  )
+{
+  SVfrHashNode **ppNode;
+  SVfrHashNode *pNode;
+
+  for (ppNode = &mBucket[Hash (Name, Scope)]; *ppNode != NULL; ppNode = &(*ppNode)->mNext) {
+    if ((*ppNode)->mData == Data) {
+      pNode   = *ppNode;
+      *ppNode = pNode->mNext;
+      delete pNode;
+      return;
+    }
+  }
+}
+
+VOID *
+CVfrHashTable::Find (
+  IN INT8   *Name,
+  IN VOID   *Scope
+  )
+{
+  SVfrHashNode *pNode;
+
+  for (pNode = mBucket[Hash (Name, Scope)]; pNode != NULL; pNode = pNode->mNext) {
+    if (pNode->mScope != Scope) {
+      continue;
+    }
+
+    if ((Name == NULL) || (pNode->mName == NULL)) {
+      if (Name == pNode->mName) {
+        return pNode->mData;
+      }
+    } else if (strcmp (pNode->mName, Name) == 0) {
+      return pNode->mData;
+    }
+  }
+
+  return NULL;
+}
+
 static struct {
   INT8   *mTypeName;
   UINT8  mType;
@@ -651,6 +765,8 @@ CVfrVarDataTypeDB::RegisterNewType (
 {
   New->mNext               = mDataTypeList;
   mDataTypeList            = New;
+
+  mDataTypeHash.Insert (New->mTypeName, NULL, New);
 }
 
 EFI_VFR_RETURN_CODE
@@ -742,11 +858,9 @@ CVfrVarDataTypeDB::GetTypeField (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pField = Type->mMembers; pField != NULL; pField = pField->mNext) {
-    if (strcmp (pField->mFieldName, FName) == 0) {
-      Field = pField;
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pField = (SVfrDataField *) mDataFieldHash.Find (FName, Type)) != NULL) {
+    Field = pField;
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -805,8 +919,9 @@ CVfrVarDataTypeDB::InternalTypesListInit (
   VOID
   )
 {
-  SVfrDataType *New   = NULL;
-  UINT32       Index;
+  SVfrDataType  *New   = NULL;
+  SVfrDataField *pField;
+  UINT32        Index;
 
   for (Index = 0; gInternalTypesTable[Index].mTypeName != NULL; Index++) {
     New                 = new SVfrDataType;
@@ -866,6 +981,9 @@ CVfrVarDataTypeDB::InternalTypesListInit (
       } else {
         New->mMembers            = NULL;
       }
+      for (pField = New->mMembers; pField != NULL; pField = pField->mNext) {
+        mDataFieldHash.Insert (pField->mFieldName, New, pField);
+      }
       New->mNext                 = NULL;
       RegisterNewType (New);
       New                        = NULL;
@@ -985,6 +1103,7 @@ CVfrVarDataTypeDB::DeclareDataTypeBegin (
   pNewType->mNext        = NULL;
 
   mNewDataType           = pNewType;
+  mCurrDataField         = NULL;
 }
 
 EFI_VFR_RETURN_CODE
@@ -1004,10 +1123,8 @@ CVfrVarDataTypeDB::SetNewTypeName (
     return VFR_RETURN_INVALID_PARAMETER;
   }
 
-  for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
-    if (strcmp(pType->mTypeName, TypeName) == 0) {
-      return VFR_RETURN_REDEFINED;
-    }
+  if ((pType = (SVfrDataType *) mDataTypeHash.Find (TypeName)) != NULL) {
+    return VFR_RETURN_REDEFINED;
   }
 
   strcpy(mNewDataType->mTypeName, TypeName);
@@ -1023,7 +1140,6 @@ CVfrVarDataTypeDB::DataTypeAddField (
 {
   SVfrDataField       *pNewField  = NULL;
   SVfrDataType        *pFieldType = NULL;
-  SVfrDataField       *pTmp;
   UINT32              Align;
 
   CHECK_ERROR_RETURN (GetDataType (TypeName, &pFieldType), VFR_RETURN_SUCCESS);
@@ -1032,10 +1148,8 @@ CVfrVarDataTypeDB::DataTypeAddField (
    return VFR_RETURN_INVALID_PARAMETER;
   }
 
-  for (pTmp = mNewDataType->mMembers; pTmp != NULL; pTmp = pTmp->mNext) {
-    if (strcmp (pTmp->mFieldName, FieldName) == 0) {
-      return VFR_RETURN_REDEFINED;
-    }
+  if (mDataFieldHash.Find (FieldName, mNewDataType) != NULL) {
+    return VFR_RETURN_REDEFINED;
   }
 
   Align = MIN (mPackAlign, pFieldType->mAlign);
@@ -1051,15 +1165,21 @@ CVfrVarDataTypeDB::DataTypeAddField (
   } else {
     pNewField->mOffset     = mNewDataType->mTotalSize + ALIGN_STUFF(mNewDataType->mTotalSize, Align);
   }
+  if (mDataFieldHash.Insert (pNewField->mFieldName, mNewDataType, pNewField) != VFR_RETURN_SUCCESS) {
+    delete pNewField;
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+  //
+  // mCurrDataField is the last field of the new type
+  //
   if (mNewDataType->mMembers == NULL) {
     mNewDataType->mMembers = pNewField;
     pNewField->mNext       = NULL;
   } else {
-    for (pTmp = mNewDataType->mMembers; pTmp->mNext != NULL; pTmp = pTmp->mNext)
-      ;
-    pTmp->mNext            = pNewField;
+    mCurrDataField->mNext  = pNewField;
     pNewField->mNext       = NULL;
   }
+  mCurrDataField           = pNewField;
 
   mNewDataType->mAlign     = MIN (mPackAlign, MAX (pFieldType->mAlign, mNewDataType->mAlign));
   mNewDataType->mTotalSize = pNewField->mOffset + (pNewField->mFieldType->mTotalSize) * ((ArrayNum == 0) ? 1 : ArrayNum);
@@ -1103,11 +1223,9 @@ CVfrVarDataTypeDB::GetDataType (
 
   *DataType = NULL;
 
-  for (pDataType = mDataTypeList; pDataType != NULL; pDataType = pDataType->mNext) {
-    if (strcmp (TypeName, pDataType->mTypeName) == 0) {
-      *DataType = pDataType;
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pDataType = (SVfrDataType *) mDataTypeHash.Find (TypeName)) != NULL) {
+    *DataType = pDataType;
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -1159,11 +1277,9 @@ CVfrVarDataTypeDB::GetDataTypeSize (
 
   *Size = 0;
 
-  for (pDataType = mDataTypeList; pDataType != NULL; pDataType = pDataType->mNext) {
-    if (strcmp (TypeName, pDataType->mTypeName) == 0) {
-      *Size = pDataType->mTotalSize;
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pDataType = (SVfrDataType *) mDataTypeHash.Find (TypeName)) != NULL) {
+    *Size = pDataType->mTotalSize;
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -1257,10 +1373,8 @@ CVfrVarDataTypeDB::IsTypeNameDefined (
     return FALSE;
   }
 
-  for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
-    if (strcmp (pType->mTypeName, TypeName) == 0) {
-      return TRUE;
-    }
+  if ((pType = (SVfrDataType *) mDataTypeHash.Find (TypeName)) != NULL) {
+    return TRUE;
   }
 
   return FALSE;
@@ -1485,10 +1599,8 @@ CVfrDataStorage::DeclareNameVarStoreBegin (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pNode = mNameVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      return VFR_RETURN_REDEFINED;
-    }
+  if (mNameVarStoreHash.Find (StoreName) != NULL) {
+    return VFR_RETURN_REDEFINED;
   }
 
   VarStoreId = GetFreeVarStoreId ();
@@ -1531,6 +1643,10 @@ CVfrDataStorage::DeclareNameVarStoreEnd (
   IN EFI_GUID *Guid
   )
 {
+  if (mNameVarStoreHash.Insert (mNewVarStorageNode->mVarStoreName, NULL, mNewVarStorageNode) != VFR_RETURN_SUCCESS) {
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
   mNewVarStorageNode->mGuid = *Guid;
   mNewVarStorageNode->mNext = mNameVarStoreList;
   mNameVarStoreList         = mNewVarStorageNode;
@@ -1559,10 +1675,8 @@ CVfrDataStorage::DeclareEfiVarStore (
     return VFR_RETURN_EFIVARSTORE_SIZE_ERROR;
   }
 
-  for (pNode = mEfiVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      return VFR_RETURN_REDEFINED;
-    }
+  if (mEfiVarStoreHash.Find (StoreName) != NULL) {
+    return VFR_RETURN_REDEFINED;
   }
 
   VarStoreId = GetFreeVarStoreId ();
@@ -1570,6 +1684,11 @@ CVfrDataStorage::DeclareEfiVarStore (
     return VFR_RETURN_OUT_FOR_RESOURCES;
   }
 
+  if (mNameVarStoreHash.Insert (pNode->mVarStoreName, NULL, pNode) != VFR_RETURN_SUCCESS) {
+    delete pNode;
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
   pNode->mNext       = mNameVarStoreList;
   mNameVarStoreList  = pNode;
 
@@ -1607,6 +1726,11 @@ CVfrDataStorage::DeclareBufferVarStore (
     return VFR_RETURN_OUT_FOR_RESOURCES;
   }
 
+  if (mBufferVarStoreHash.Insert (pNew->mVarStoreName, NULL, pNew) != VFR_RETURN_SUCCESS) {
+    delete pNew;
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
   pNew->mNext         = mBufferVarStoreList;
   mBufferVarStoreList = pNew;
 
@@ -1625,28 +1749,12 @@ CVfrDataStorage::GetVarStoreId (
 {
   SVfrVarStorageNode    *pNode;
 
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      mCurrVarStorageNode = pNode;
-      *VarStoreId = pNode->mVarStoreId;
-      return VFR_RETURN_SUCCESS;
-    }
-  }
-
-  for (pNode = mEfiVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      mCurrVarStorageNode = pNode;
-      *VarStoreId = pNode->mVarStoreId;
-      return VFR_RETURN_SUCCESS;
-    }
-  }
-
-  for (pNode = mNameVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      mCurrVarStorageNode = pNode;
-      *VarStoreId = pNode->mVarStoreId;
-      return VFR_RETURN_SUCCESS;
-    }
+  if (((pNode = (SVfrVarStorageNode *) mBufferVarStoreHash.Find (StoreName)) != NULL) ||
+      ((pNode = (SVfrVarStorageNode *) mEfiVarStoreHash.Find (StoreName)) != NULL) ||
+      ((pNode = (SVfrVarStorageNode *) mNameVarStoreHash.Find (StoreName)) != NULL)) {
+    mCurrVarStorageNode = pNode;
+    *VarStoreId = pNode->mVarStoreId;
+    return VFR_RETURN_SUCCESS;
   }
 
   mCurrVarStorageNode = NULL;
@@ -1666,12 +1774,7 @@ CVfrDataStorage::GetBufferVarStoreDataTypeName (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      break;
-    }
-  }
-
+  pNode = (SVfrVarStorageNode *) mBufferVarStoreHash.Find (StoreName);
   if (pNode == NULL) {
     return VFR_RETURN_UNDEFINED;
   }
@@ -1696,25 +1799,11 @@ CVfrDataStorage::GetVarStoreType (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == NULL) {
-      VarStoreType = pNode->mVarStoreType;
-      return VFR_RETURN_SUCCESS;
-    }
-  }
-
-  for (pNode = mEfiVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == NULL) {
-      VarStoreType = pNode->mVarStoreType;
-      return VFR_RETURN_SUCCESS;
-    }
-  }
-
-  for (pNode = mNameVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == NULL) {
-      VarStoreType = pNode->mVarStoreType;
-      return VFR_RETURN_SUCCESS;
-    }
+  if (((pNode = (SVfrVarStorageNode *) mBufferVarStoreHash.Find (StoreName)) != NULL) ||
+      ((pNode = (SVfrVarStorageNode *) mEfiVarStoreHash.Find (StoreName)) != NULL) ||
+      ((pNode = (SVfrVarStorageNode *) mNameVarStoreHash.Find (StoreName)) != NULL)) {
+    VarStoreType = pNode->mVarStoreType;
+    return VFR_RETURN_SUCCESS;
   }
 
   VarStoreType = EFI_VFR_VARSTORE_INVALID;
@@ -1861,12 +1950,7 @@ CVfrDataStorage::BufferVarStoreRequestElementAdd (
   SVfrVarStorageNode    *pNode = NULL;
   EFI_IFR_TYPE_VALUE    Value = {0};
 
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == NULL) {
-      break;
-    }
-  }
-
+  pNode = (SVfrVarStorageNode *) mBufferVarStoreHash.Find (StoreName);
   if (pNode == NULL) {
     return VFR_RETURN_UNDEFINED;
   }
@@ -1945,16 +2029,19 @@ CVfrDefaultStore::RegisterDefaultStore (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pNode = mDefaultStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mRefName, RefName) == 0) {
-      return VFR_RETURN_REDEFINED;
-    }
+  if (mDefaultStoreHash.Find (RefName) != NULL) {
+    return VFR_RETURN_REDEFINED;
   }
 
   if ((pNode = new SVfrDefaultStoreNode ((EFI_IFR_DEFAULTSTORE *)ObjBinAddr, RefName, DefaultStoreNameId, DefaultId)) == NULL) {
     return VFR_RETURN_OUT_FOR_RESOURCES;
   }
 
+  if (mDefaultStoreHash.Insert (pNode->mRefName, NULL, pNode) != VFR_RETURN_SUCCESS) {
+    delete pNode;
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
   pNode->mNext               = mDefaultStoreList;
   mDefaultStoreList          = pNode;
 
@@ -1993,10 +2080,12 @@ CVfrDefaultStore::ReRegisterDefaultStoreById (
     }
 
     if (RefName != NULL) {
+      mDefaultStoreHash.Remove (pNode->mRefName, NULL, pNode);
       delete pNode->mRefName;
       pNode->mRefName = new INT8[strlen (RefName) + 1];
       if (pNode->mRefName != NULL) {
         strcpy (pNode->mRefName, RefName);
+        mDefaultStoreHash.Insert (pNode->mRefName, NULL, pNode);
       }
     }
   }
@@ -2032,11 +2121,9 @@ CVfrDefaultStore::GetDefaultId (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pTmp = mDefaultStoreList; pTmp != NULL; pTmp = pTmp->mNext) {
-    if (strcmp (pTmp->mRefName, RefName) == 0) {
-      *DefaultId = pTmp->mDefaultId;
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pTmp = (SVfrDefaultStoreNode *) mDefaultStoreHash.Find (RefName)) != NULL) {
+    *DefaultId = pTmp->mDefaultId;
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -2223,6 +2310,11 @@ CVfrRulesDB::RegisterRule (
     return ;
   }
 
+  if (mRuleHash.Insert (pNew->mRuleName, NULL, pNew) != VFR_RETURN_SUCCESS) {
+    delete pNew;
+    return ;
+  }
+
   mFreeRuleId++;
 
   pNew->mNext = mRuleList;
@@ -2240,10 +2332,8 @@ CVfrRulesDB::GetRuleId (
     return EFI_RULE_ID_INVALID;
   }
 
-  for (pNode = mRuleList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mRuleName, RuleName) == 0) {
-      return pNode->mRuleId;
-    }
+  if ((pNode = (SVfrRuleNode *) mRuleHash.Find (RuleName)) != NULL) {
+    return pNode->mRuleId;
   }
 
   return EFI_RULE_ID_INVALID;
@@ -2413,6 +2503,27 @@ CVfrQuestionDB::~CVfrQuestionDB ()
   }
 }
 
+VOID
+CVfrQuestionDB::InsertQuestion (
+  IN SVfrQuestionNode *pNode
+  )
+{
+  pNode->mNext  = mQuestionList;
+  mQuestionList = pNode;
+
+  //
+  // The "$DEFAULT" name and "$" VarIdStr given to the questions without
+  // them are not indexed, lookups of names starting with '$' walk the list.
+  //
+  if (pNode->mName[0] != '$') {
+    mQuestionNameHash.Insert (pNode->mName, NULL, pNode);
+  }
+  if (pNode->mVarIdStr[0] != '$') {
+    mQuestionVarIdHash.Insert (pNode->mVarIdStr, NULL, pNode);
+  }
+  mQuestionIdHash.Insert (NULL, (VOID *)(UINTN) pNode->mQuestionId, pNode);
+}
+
 EFI_VFR_RETURN_CODE
 CVfrQuestionDB::RegisterQuestion (
   IN     INT8              *Name,
@@ -2441,8 +2552,7 @@ CVfrQuestionDB::RegisterQuestion (
   }
   pNode->mQuestionId = QuestionId;
 
-  pNode->mNext       = mQuestionList;
-  mQuestionList      = pNode;
+  InsertQuestion (pNode);
 
   gCFormPkg.DoPendingAssign (VarIdStr, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
 
@@ -2486,10 +2596,9 @@ CVfrQuestionDB::RegisterOldDateQuestion (
   pNode[0]->mQuestionId = QuestionId;
   pNode[1]->mQuestionId = QuestionId;
   pNode[2]->mQuestionId = QuestionId;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   gCFormPkg.DoPendingAssign (YearVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (MonthVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -2562,10 +2671,9 @@ CVfrQuestionDB::RegisterNewDateQuestion (
   pNode[0]->mQuestionId = QuestionId;
   pNode[1]->mQuestionId = QuestionId;
   pNode[2]->mQuestionId = QuestionId;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   for (Index = 0; Index < 3; Index++) {
     if (VarIdStr[Index] != NULL) {
@@ -2628,10 +2736,9 @@ CVfrQuestionDB::RegisterOldTimeQuestion (
   pNode[0]->mQuestionId = QuestionId;
   pNode[1]->mQuestionId = QuestionId;
   pNode[2]->mQuestionId = QuestionId;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   gCFormPkg.DoPendingAssign (HourVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (MinuteVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -2704,10 +2811,9 @@ CVfrQuestionDB::RegisterNewTimeQuestion (
   pNode[0]->mQuestionId = QuestionId;
   pNode[1]->mQuestionId = QuestionId;
   pNode[2]->mQuestionId = QuestionId;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   for (Index = 0; Index < 3; Index++) {
     if (VarIdStr[Index] != NULL) {
@@ -2745,16 +2851,16 @@ CVfrQuestionDB::UpdateQuestionId (
     return VFR_RETURN_REDEFINED;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
-    if (pNode->mQuestionId == QId) {
-      break;
-    }
-  }
-
+  pNode = (SVfrQuestionNode *) mQuestionIdHash.Find (NULL, (VOID *)(UINTN) QId);
   if (pNode == NULL) {
     return VFR_RETURN_UNDEFINED;
   }
 
+  mQuestionIdHash.Remove (NULL, (VOID *)(UINTN) QId, pNode);
+  if (mQuestionIdHash.Insert (NULL, (VOID *)(UINTN) NewQId, pNode) != VFR_RETURN_SUCCESS) {
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
   MarkQuestionIdUnused (QId);
   pNode->mQuestionId = NewQId;
   MarkQuestionIdUsed (NewQId);
@@ -2781,22 +2887,30 @@ CVfrQuestionDB::GetQuestionId (
     return ;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
-    if (Name != NULL) {
-      if (strcmp (pNode->mName, Name) != 0) {
+  //
+  // Look up either key in its index, only a lookup by both keys or of an
+  // unindexed '$' name needs to walk the list.
+  //
+  pNode = NULL;
+  if ((VarIdStr == NULL) && (Name[0] != '$')) {
+    pNode = (SVfrQuestionNode *) mQuestionNameHash.Find (Name);
+  } else if ((Name == NULL) && (VarIdStr[0] != '$')) {
+    pNode = (SVfrQuestionNode *) mQuestionVarIdHash.Find (VarIdStr);
+  } else {
+    for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
+      if ((Name != NULL) && (strcmp (pNode->mName, Name) != 0)) {
         continue;
       }
-    }
-
-    if (VarIdStr != NULL) {
-      if (strcmp (pNode->mVarIdStr, VarIdStr) != 0) {
+      if ((VarIdStr != NULL) && (strcmp (pNode->mVarIdStr, VarIdStr) != 0)) {
         continue;
       }
-  	}
+      break;
+    }
+  }
 
+  if (pNode != NULL) {
     QuestionId = pNode->mQuestionId;
     BitMask    = pNode->mBitMask;
-    break;
   }
 
   return ;
@@ -2813,10 +2927,8 @@ CVfrQuestionDB::FindQuestion (
     return VFR_RETURN_INVALID_PARAMETER;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
-    if (pNode->mQuestionId == QuestionId) {
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pNode = (SVfrQuestionNode *) mQuestionIdHash.Find (NULL, (VOID *)(UINTN) QuestionId)) != NULL) {
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -2833,6 +2945,13 @@ CVfrQuestionDB::FindQuestion (
     return VFR_RETURN_FATAL_ERROR;
   }
 
+  if (Name[0] != '$') {
+    if ((pNode = (SVfrQuestionNode *) mQuestionNameHash.Find (Name)) != NULL) {
+      return VFR_RETURN_SUCCESS;
+    }
+    return VFR_RETURN_UNDEFINED;
+  }
+
   for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
     if (strcmp (pNode->mName, Name) == 0) {
       return VFR_RETURN_SUCCESS;
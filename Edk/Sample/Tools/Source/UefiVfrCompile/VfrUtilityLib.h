@@ -94,6 +94,36 @@ extern CVfrBufferConfig gCVfrBufferConfig;
 #define ALIGN_STUFF(Size, Align) ((Align) - (Size) % (Align))
 #define INVALID_ARRAY_INDEX      0xFFFFFFFF
 
+//
+// Name index of the databases below. The lists of the databases keep the
+// declaration order, the hash table only finds the nodes. An entry is keyed
+// by a name and a scope, entries with the same key are found in the reverse
+// order they are inserted, the same as a list built by inserting at the head.
+//
+#define VFR_HASH_TABLE_SIZE      0x400
+
+struct SVfrHashNode {
+  INT8                      *mName;
+  VOID                      *mScope;
+  VOID                      *mData;
+  SVfrHashNode              *mNext;
+};
+
+class CVfrHashTable {
+private:
+  SVfrHashNode              *mBucket[VFR_HASH_TABLE_SIZE];
+
+  UINT32 Hash (IN INT8 *, IN VOID *);
+
+public:
+  CVfrHashTable (VOID);
+  ~CVfrHashTable (VOID);
+
+  EFI_VFR_RETURN_CODE Insert (IN INT8 *, IN VOID *, IN VOID *);
+  VOID                Remove (IN INT8 *, IN VOID *, IN VOID *);
+  VOID *              Find (IN INT8 *, IN VOID *Scope = NULL);
+};
+
 struct SVfrDataType;
 
 struct SVfrDataField {
@@ -166,6 +196,8 @@ public:
 
 private:
   SVfrDataType              *mDataTypeList;
+  CVfrHashTable             mDataTypeHash;
+  CVfrHashTable             mDataFieldHash;   // Fields scoped by their type
 
   SVfrDataType              *mNewDataType;
   SVfrDataType              *mCurrDataType;
@@ -266,6 +298,10 @@ private:
   struct SVfrVarStorageNode *mEfiVarStoreList;
   struct SVfrVarStorageNode *mNameVarStoreList;
 
+  CVfrHashTable             mBufferVarStoreHash;
+  CVfrHashTable             mEfiVarStoreHash;
+  CVfrHashTable             mNameVarStoreHash;
+
   struct SVfrVarStorageNode *mCurrVarStorageNode;
   struct SVfrVarStorageNode *mNewVarStorageNode;
 
@@ -325,9 +361,13 @@ struct SVfrQuestionNode {
 class CVfrQuestionDB {
 private:
   SVfrQuestionNode          *mQuestionList;
+  CVfrHashTable             mQuestionNameHash;
+  CVfrHashTable             mQuestionVarIdHash;
+  CVfrHashTable             mQuestionIdHash;
   UINT32                    mFreeQIdBitMap[EFI_FREE_QUESTION_ID_BITMAP_SIZE];
 
 private:
+  VOID            InsertQuestion (IN SVfrQuestionNode *);
   EFI_QUESTION_ID GetFreeQuestionId (VOID);
   BOOLEAN         ChekQuestionIdFree (IN EFI_QUESTION_ID);
   VOID            MarkQuestionIdUsed (IN EFI_QUESTION_ID);
@@ -363,6 +403,7 @@ struct SVfrDefaultStoreNode {
 class CVfrDefaultStore {
 private:
   SVfrDefaultStoreNode      *mDefaultStoreList;
+  CVfrHashTable             mDefaultStoreHash;
 
 public:
   CVfrDefaultStore ();
@@ -390,6 +431,7 @@ struct SVfrRuleNode {
 class CVfrRulesDB {
 private:
   SVfrRuleNode              *mRuleList;
+  CVfrHashTable             mRuleHash;
   UINT8                     mFreeRuleId;
 
 public:
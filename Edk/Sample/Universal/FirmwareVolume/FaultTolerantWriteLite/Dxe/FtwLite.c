@@ -82,10 +82,103 @@ Returns:
     EFI_OUT_OF_RESOURCES - Cannot allocate memory.
     EFI_ABORTED          - The function could not complete successfully.
 
+--*/
+{
+  EFI_FTW_LITE_WRITE_DATA             Write;
+
+  Write.Offset    = Offset;
+  Write.NumBytes  = *NumBytes;
+  Write.Buffer    = Buffer;
+
+  return FtwLiteWriteRecords (FTW_LITE_CONTEXT_FROM_THIS (This), FvbHandle, Lba, 1, &Write);
+}
+
+EFI_STATUS
+EFIAPI
+FtwLiteWriteMultiple (
+  IN EFI_FTW_LITE_MULTIPLE_PROTOCOL        *This,
+  IN EFI_HANDLE                            FvbHandle,
+  IN EFI_LBA                               Lba,
+  IN UINTN                                 WriteCount,
+  IN EFI_FTW_LITE_WRITE_DATA               *Writes
+  )
+/*++
+
+Routine Description:
+    Applies several writes to the same target block as one fault tolerant
+    update, sharing one write record and one spare block cycle.
+
+Arguments:
+    This             - Calling context
+    FvbHandle        - The handle of FVB protocol that provides services for 
+                       reading, writing, and erasing the target block.
+    Lba              - The logical block address of the target block.  
+    WriteCount       - The number of entries in Writes.
+    Writes           - The writes, applied in array order.
+
+Returns:
+    EFI_SUCCESS          - The function completed successfully
+    EFI_INVALID_PARAMETER - WriteCount is 0 or Writes is NULL.
+    EFI_BAD_BUFFER_SIZE  - A write would span a target block, which is not 
+                           a valid action.
+    EFI_ACCESS_DENIED    - No writes have been allocated.
+    EFI_NOT_FOUND        - Cannot find FVB by handle.
+    EFI_OUT_OF_RESOURCES - Cannot allocate memory.
+    EFI_ABORTED          - The function could not complete successfully.
+
+--*/
+{
+  if ((WriteCount == 0) || (Writes == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return FtwLiteWriteRecords (
+           FTW_LITE_CONTEXT_FROM_MULTIPLE_THIS (This),
+           FvbHandle,
+           Lba,
+           WriteCount,
+           Writes
+           );
+}
+
+STATIC
+EFI_STATUS
+FtwLiteWriteRecords (
+  IN EFI_FTW_LITE_DEVICE                   *FtwLiteDevice,
+  IN EFI_HANDLE                            FvbHandle,
+  IN EFI_LBA                               Lba,
+  IN UINTN                                 WriteCount,
+  IN EFI_FTW_LITE_WRITE_DATA               *Writes
+  )
+/*++
+
+Routine Description:
+    Applies WriteCount writes to the same target block as one fault tolerant
+    update. The writes share one write record in the work space and one
+    spare block cycle, so the flash is erased and programmed once for all
+    of them rather than once per write. The record covers the range from
+    the lowest offset to the highest end of the writes.
+
+Arguments:
+    FtwLiteDevice    - The private data of FTW_LITE driver
+    FvbHandle        - The handle of FVB protocol that provides services for 
+                       reading, writing, and erasing the target block.
+    Lba              - The logical block address of the target block.  
+    WriteCount       - The number of entries in Writes, at least 1.
+    Writes           - The writes, applied in array order.
+
+Returns:
+    EFI_SUCCESS          - The function completed successfully
+    EFI_BAD_BUFFER_SIZE  - A write would span a target block, which is not 
+                           a valid action.
+    EFI_ACCESS_DENIED    - No writes have been allocated.
+    EFI_NOT_FOUND        - Cannot find FVB by handle.
+    EFI_OUT_OF_RESOURCES - Cannot allocate memory.
+    EFI_ABORTED          - The function could not complete successfully.
+
 --*/
 {
   EFI_STATUS                          Status;
-  EFI_FTW_LITE_DEVICE                 *FtwLiteDevice;
   EFI_FTW_LITE_RECORD                 *Record;
   EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *Fvb;
   EFI_PHYSICAL_ADDRESS                FvbPhysicalAddress;
@@ -98,12 +191,15 @@ Returns:
   UINTN                               Index;
   UINT8                               *Ptr;
   EFI_DEV_PATH_PTR                    DevPtr;
+  UINTN                               Offset;
+  UINTN                               NumBytes;
+  UINTN                               EndOffset;
+  UINTN                               BlockOffset;
 
   //
   // Refresh work space and get last record
   //
-  FtwLiteDevice = FTW_LITE_CONTEXT_FROM_THIS (This);
-  Status        = WorkSpaceRefresh (FtwLiteDevice);
+  Status = WorkSpaceRefresh (FtwLiteDevice);
   if (EFI_ERROR (Status)) {
     return EFI_ABORTED;
   }
@@ -127,11 +223,26 @@ Returns:
   MyOffset = (UINT8 *) Record - FtwLiteDevice->FtwWorkSpace;
 
   //
-  // Check if the input data can fit within the target block
+  // Check if the input data can fit within the target block, the record
+  // covers all the writes
   //
-  if ((Offset +*NumBytes) > FtwLiteDevice->SpareAreaLength) {
-    return EFI_BAD_BUFFER_SIZE;
+  Offset    = Writes[0].Offset;
+  EndOffset = 0;
+  for (Index = 0; Index < WriteCount; Index += 1) {
+    if ((Writes[Index].Offset + Writes[Index].NumBytes) > FtwLiteDevice->SpareAreaLength) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+
+    if (Writes[Index].Offset < Offset) {
+      Offset = Writes[Index].Offset;
+    }
+
+    if ((Writes[Index].Offset + Writes[Index].NumBytes) > EndOffset) {
+      EndOffset = Writes[Index].Offset + Writes[Index].NumBytes;
+    }
   }
+
+  NumBytes = EndOffset - Offset;
   //
   // Check if there is enough free space for allocate a record
   //
@@ -183,13 +294,13 @@ Returns:
 
   DevPtr.MemMap->MemoryType       = EfiMemoryMappedIO;
   DevPtr.MemMap->StartingAddress  = FvbPhysicalAddress;
-  DevPtr.MemMap->EndingAddress    = FvbPhysicalAddress +*NumBytes;
+  DevPtr.MemMap->EndingAddress    = FvbPhysicalAddress + NumBytes;
   //
   // ignored!
   //
   Record->Lba       = Lba;
   Record->Offset    = Offset;
-  Record->NumBytes  = *NumBytes;
+  Record->NumBytes  = NumBytes;
 
   //
   // Write the record to the work space.
@@ -225,6 +336,7 @@ Returns:
   //
   // Read all original data from target block to memory buffer
   //
+  BlockOffset = 0;
   if (IsInWorkingBlock (FtwLiteDevice, Fvb, Lba)) {
     //
     // If target block falls into working block, we must follow the process of
@@ -251,8 +363,8 @@ Returns:
     // Update Offset by adding the offset from the start LBA of working block to
     // the target LBA. The target block can not span working block!
     //
-    Offset = (((UINTN) (Lba - FtwLiteDevice->FtwWorkBlockLba)) * FtwLiteDevice->SizeOfSpareBlock + Offset);
-    ASSERT ((Offset +*NumBytes) <= FtwLiteDevice->SpareAreaLength);
+    BlockOffset = ((UINTN) (Lba - FtwLiteDevice->FtwWorkBlockLba)) * FtwLiteDevice->SizeOfSpareBlock;
+    ASSERT ((BlockOffset + EndOffset) <= FtwLiteDevice->SpareAreaLength);
 
   } else {
 
@@ -272,7 +384,13 @@ Returns:
   // Overwrite the updating range data with
   // the input buffer content
   //
-  EfiCopyMem (MyBuffer + Offset, Buffer, *NumBytes);
+  for (Index = 0; Index < WriteCount; Index += 1) {
+    EfiCopyMem (
+      MyBuffer + BlockOffset + Writes[Index].Offset,
+      Writes[Index].Buffer,
+      Writes[Index].NumBytes
+      );
+  }
 
   //
   // Try to keep the content of spare block
@@ -389,10 +507,11 @@ Returns:
 
   DEBUG (
     (EFI_D_FTW_LITE,
-    "FtwLite: Write() success, (Lba:Offset)=(%lx:0x%x), NumBytes: 0x%x\n",
+    "FtwLite: Write() success, (Lba:Offset)=(%lx:0x%x), NumBytes: 0x%x, Writes: %d\n",
     Lba,
     Offset,
-    *NumBytes)
+    NumBytes,
+    WriteCount)
     );
 
   return EFI_SUCCESS;
@@ -900,7 +1019,8 @@ InitializeFtwLite (
   //
   // Hook the protocol API
   //
-  FtwLiteDevice->FtwLiteInstance.Write = FtwLiteWrite;
+  FtwLiteDevice->FtwLiteInstance.Write                 = FtwLiteWrite;
+  FtwLiteDevice->FtwLiteMultipleInstance.WriteMultiple = FtwLiteWriteMultiple;
 
   //
   // Install protocol interface
@@ -914,6 +1034,16 @@ InitializeFtwLite (
   if (EFI_ERROR (Status)) {
     return EFI_ABORTED;
   }
+
+  Status = gBS->InstallProtocolInterface (
+                  &FtwLiteDevice->Handle,
+                  &gEfiFaultTolerantWriteLiteMultipleProtocolGuid,
+                  EFI_NATIVE_INTERFACE,
+                  &FtwLiteDevice->FtwLiteMultipleInstance
+                  );
+  if (EFI_ERROR (Status)) {
+    return EFI_ABORTED;
+  }
   //
   // If (!SpareCompleted)  THEN  Abort to rollback.
   //
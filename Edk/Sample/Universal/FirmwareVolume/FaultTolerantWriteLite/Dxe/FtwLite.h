@@ -37,6 +37,7 @@ Abstract:
 #include EFI_PROTOCOL_CONSUMER (FirmwareVolumeBlock)
 #include EFI_PROTOCOL_CONSUMER (PciRootBridgeIo)
 #include EFI_PROTOCOL_PRODUCER (FaultTolerantWriteLite)
+#include EFI_PROTOCOL_PRODUCER (FaultTolerantWriteLiteMultiple)
 
 #define EFI_D_FTW_LITE  EFI_D_ERROR
 #define EFI_D_FTW_INFO  EFI_D_INFO
@@ -112,6 +113,7 @@ typedef struct {
   UINTN                                   Signature;
   EFI_HANDLE                              Handle;
   EFI_FTW_LITE_PROTOCOL                   FtwLiteInstance;
+  EFI_FTW_LITE_MULTIPLE_PROTOCOL          FtwLiteMultipleInstance;
   EFI_PHYSICAL_ADDRESS                    WorkSpaceAddress;
   UINTN                                   WorkSpaceLength;
   EFI_PHYSICAL_ADDRESS                    SpareAreaAddress;
@@ -135,6 +137,8 @@ typedef struct {
 } EFI_FTW_LITE_DEVICE;
 
 #define FTW_LITE_CONTEXT_FROM_THIS(a) CR (a, EFI_FTW_LITE_DEVICE, FtwLiteInstance, FTW_LITE_DEVICE_SIGNATURE)
+#define FTW_LITE_CONTEXT_FROM_MULTIPLE_THIS(a) \
+  CR (a, EFI_FTW_LITE_DEVICE, FtwLiteMultipleInstance, FTW_LITE_DEVICE_SIGNATURE)
 
 //
 // Driver entry point
@@ -204,9 +208,75 @@ Returns:
 --*/
 ;
 
+EFI_STATUS
+EFIAPI
+FtwLiteWriteMultiple (
+  IN EFI_FTW_LITE_MULTIPLE_PROTOCOL        *This,
+  IN EFI_HANDLE                            FvbHandle,
+  IN EFI_LBA                               Lba,
+  IN UINTN                                 WriteCount,
+  IN EFI_FTW_LITE_WRITE_DATA               *Writes
+  )
+/*++
+
+Routine Description:
+    Applies several writes to the same target block as one fault tolerant
+    update, sharing one write record and one spare block cycle.
+
+Arguments:
+    This             - Calling context
+    FvbHandle        - The handle of FVB protocol that provides services for 
+                       reading, writing, and erasing the target block.
+    Lba              - The logical block address of the target block.  
+    WriteCount       - The number of entries in Writes.
+    Writes           - The writes, applied in array order.
+
+Returns:
+    EFI_SUCCESS          - The function completed successfully
+    EFI_INVALID_PARAMETER - WriteCount is 0 or Writes is NULL.
+    EFI_BAD_BUFFER_SIZE  - A write would span a target block, which is not 
+                           a valid action.
+    EFI_ACCESS_DENIED    - No writes have been allocated.
+    EFI_NOT_FOUND        - Cannot find FVB by handle.
+    EFI_OUT_OF_RESOURCES - Cannot allocate memory.
+    EFI_ABORTED          - The function could not complete successfully.
+
+--*/
+;
+
 //
 // Internal functions
 //
+STATIC
+EFI_STATUS
+FtwLiteWriteRecords (
+  IN EFI_FTW_LITE_DEVICE                   *FtwLiteDevice,
+  IN EFI_HANDLE                            FvbHandle,
+  IN EFI_LBA                               Lba,
+  IN UINTN                                 WriteCount,
+  IN EFI_FTW_LITE_WRITE_DATA               *Writes
+  )
+/*++
+
+Routine Description:
+    Applies the writes of Write () and WriteMultiple () to the same target
+    block as one fault tolerant update.
+
+Arguments:
+    FtwLiteDevice    - The private data of FTW_LITE driver
+    FvbHandle        - The handle of FVB protocol that provides services for 
+                       reading, writing, and erasing the target block.
+    Lba              - The logical block address of the target block.  
+    WriteCount       - The number of entries in Writes, at least 1.
+    Writes           - The writes, applied in array order.
+
+Returns:
+    EFI_SUCCESS          - The function completed successfully
+    Others               - As returned by Write ()
+
+--*/
+;
+
 STATIC
 EFI_STATUS
 FtwRestart (
@@ -0,0 +1,1274 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  FtwLiteTest.c
+
+Abstract:
+
+  Host test and benchmark for the FTW Lite driver.
+
+  FtwLite.c, FtwMisc.c and FtwWorkSpace.c are linked into a host program
+  against a model of a NOR flash part: a program operation can only clear
+  bits, an erase sets a whole block back to 0xFF, and the model counts
+  erases, program operations and programmed bytes. The flash map HOB and
+  the boot services the driver uses are provided here. The test checks that
+
+    - the FTW Lite protocol still has Write as its only member, and the
+      driver installs the WriteMultiple protocol on the same handle,
+    - random Write and WriteMultiple calls leave the target block the same
+      as a reference copy, later writes winning where writes overlap,
+    - a batch of writes costs the same erases as a single Write,
+    - bad parameters are refused without touching the flash,
+    - a target inside the working block is updated without breaking the
+      work space,
+    - when the power is cut at every flash operation of a WriteMultiple,
+      the target holds either all the old or all the new data once the
+      driver has been started again, and the next write succeeds.
+
+  With -b the program compares K single writes against one WriteMultiple
+  of K writes, and the variable driver reclaim before and after it
+  batched the new variable into the FTW update.
+
+--*/
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FtwLite.h"
+#include "EfiFlashMap.h"
+#include EFI_GUID_DEFINITION (Hob)
+#include EFI_GUID_DEFINITION (FlashMapHob)
+
+#define TEST_BLOCK_SIZE       0x1000
+#define TEST_BLOCK_COUNT      32
+#define TEST_FLASH_SIZE       (TEST_BLOCK_SIZE * TEST_BLOCK_COUNT)
+#define TEST_SPARE_BLOCKS     4
+#define TEST_AREA_SIZE        (TEST_SPARE_BLOCKS * TEST_BLOCK_SIZE)
+#define TEST_TARGET_LBA       4           // the target area, LBA 4 - 7
+#define TEST_WORK_SPACE_LBA   12          // the working block is LBA 9 - 12
+#define TEST_WORK_BLOCK_LBA   (TEST_WORK_SPACE_LBA - TEST_SPARE_BLOCKS + 1)
+#define TEST_SPARE_LBA        16          // the spare area, LBA 16 - 19
+#define TEST_NO_POWER_CUT     ((UINTN) -1)
+#define TEST_MAX_PROTOCOLS    8
+#define TEST_MAX_WRITES       64
+
+//
+// Typical SPI NOR timings used to turn the operation counts of the
+// benchmark into flash time: a 4 KB sector erase and a 256 byte page
+// program.
+//
+#define TEST_ERASE_US         45000
+#define TEST_PAGE_SIZE        256
+#define TEST_PAGE_PROGRAM_US  700
+
+typedef struct {
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  Fvb;
+  UINT8                               *Base;
+  UINTN                               Erases;     // blocks erased
+  UINTN                               Programs;   // Write () calls
+  UINTN                               Pages;      // program pages touched
+  UINTN                               Bytes;      // bytes programmed
+  UINTN                               BitsSet;    // programs that tried to set a cleared bit
+  UINTN                               Budget;     // operations left before the power is cut
+} TEST_FLASH;
+
+typedef struct {
+  EFI_HANDLE  Handle;
+  EFI_GUID    *Guid;
+  VOID        *Interface;
+} TEST_PROTOCOL;
+
+typedef struct _TEST_POOL {
+  struct _TEST_POOL *Next;
+  struct _TEST_POOL *Prev;
+} TEST_POOL;
+
+#pragma pack(1)
+typedef struct {
+  EFI_FIRMWARE_VOLUME_HEADER  Header;
+  EFI_FV_BLOCK_MAP_ENTRY      End;
+} TEST_FV_HEADER;
+#pragma pack()
+
+static TEST_FLASH                     mFlash;
+static jmp_buf                        mPowerCut;
+static UINT8                          mFvbHandle;
+static UINT8                          mFtwHandle;
+static TEST_PROTOCOL                  mProtocols[TEST_MAX_PROTOCOLS];
+static UINTN                          mProtocolCount;
+static TEST_POOL                      mPools = { &mPools, &mPools };
+static EFI_FLASH_MAP_ENTRY_DATA       mFlashMap[2];
+static EFI_BOOT_SERVICES              mBootServices;
+static EFI_FTW_LITE_PROTOCOL          *mFtw;
+static EFI_FTW_LITE_MULTIPLE_PROTOCOL *mFtwMultiple;
+static UINT8                          mExpected[TEST_AREA_SIZE];
+static UINT8                          mOld[TEST_AREA_SIZE];
+static UINT8                          mData[TEST_MAX_WRITES][TEST_AREA_SIZE];
+static UINT32                         mSeed = 0x2545f491;
+static UINTN                          mFailures;
+
+EFI_BOOT_SERVICES                     *gBS = &mBootServices;
+
+static
+VOID
+Check (
+  IN BOOLEAN      Condition,
+  IN CONST CHAR8  *Test,
+  IN CONST CHAR8  *What
+  )
+{
+  if (!Condition) {
+    if (mFailures < 20) {
+      printf ("FAIL %s: %s\n", Test, What);
+    }
+
+    mFailures++;
+  }
+}
+
+static
+UINT32
+Random (
+  VOID
+  )
+{
+  mSeed ^= mSeed << 13;
+  mSeed ^= mSeed >> 17;
+  mSeed ^= mSeed << 5;
+  return mSeed;
+}
+
+static
+UINT8 *
+FlashAt (
+  IN EFI_LBA  Lba
+  )
+{
+  return mFlash.Base + (UINTN) Lba * TEST_BLOCK_SIZE;
+}
+
+//
+// NOR flash model behind the firmware volume block protocol
+//
+static
+EFI_STATUS
+EFIAPI
+TestFvbGetAttributes (
+  IN  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT EFI_FVB_ATTRIBUTES                  *Attributes
+  )
+{
+  *Attributes = EFI_FVB_READ_STATUS | EFI_FVB_WRITE_STATUS | EFI_FVB_ERASE_POLARITY | EFI_FVB_MEMORY_MAPPED;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbSetAttributes (
+  IN     EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN OUT EFI_FVB_ATTRIBUTES                  *Attributes
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbGetPhysicalAddress (
+  IN  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT EFI_PHYSICAL_ADDRESS                *Address
+  )
+{
+  *Address = (EFI_PHYSICAL_ADDRESS) (UINTN) mFlash.Base;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbGetBlockSize (
+  IN  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN  EFI_LBA                             Lba,
+  OUT UINTN                               *BlockSize,
+  OUT UINTN                               *NumberOfBlocks
+  )
+{
+  if (Lba >= TEST_BLOCK_COUNT) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *BlockSize      = TEST_BLOCK_SIZE;
+  *NumberOfBlocks = TEST_BLOCK_COUNT - (UINTN) Lba;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbRead (
+  IN     EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN     EFI_LBA                             Lba,
+  IN     UINTN                               Offset,
+  IN OUT UINTN                               *NumBytes,
+  OUT    UINT8                               *Buffer
+  )
+{
+  EFI_STATUS  Status;
+
+  if ((Lba >= TEST_BLOCK_COUNT) || (Offset > TEST_BLOCK_SIZE)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = EFI_SUCCESS;
+  if (Offset + *NumBytes > TEST_BLOCK_SIZE) {
+    *NumBytes = TEST_BLOCK_SIZE - Offset;
+    Status    = EFI_BAD_BUFFER_SIZE;
+  }
+
+  memcpy (Buffer, FlashAt (Lba) + Offset, *NumBytes);
+  return Status;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbWrite (
+  IN     EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN     EFI_LBA                             Lba,
+  IN     UINTN                               Offset,
+  IN OUT UINTN                               *NumBytes,
+  IN     UINT8                               *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Flash;
+  UINTN       Count;
+  UINTN       Index;
+  BOOLEAN     BitSet;
+
+  if ((Lba >= TEST_BLOCK_COUNT) || (Offset > TEST_BLOCK_SIZE)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = EFI_SUCCESS;
+  if (Offset + *NumBytes > TEST_BLOCK_SIZE) {
+    *NumBytes = TEST_BLOCK_SIZE - Offset;
+    Status    = EFI_BAD_BUFFER_SIZE;
+  }
+
+  //
+  // A program cut by a power loss only gets the first half of its bytes
+  // to the part.
+  //
+  Count = *NumBytes;
+  if (mFlash.Budget == 0) {
+    Count /= 2;
+  }
+
+  Flash   = FlashAt (Lba) + Offset;
+  BitSet  = FALSE;
+  for (Index = 0; Index < Count; Index++) {
+    if ((Buffer[Index] & ~Flash[Index]) != 0) {
+      BitSet = TRUE;
+    }
+
+    Flash[Index] &= Buffer[Index];
+  }
+
+  if (mFlash.Budget == 0) {
+    longjmp (mPowerCut, 1);
+  }
+
+  if (mFlash.Budget != TEST_NO_POWER_CUT) {
+    mFlash.Budget--;
+  }
+
+  if (BitSet) {
+    mFlash.BitsSet++;
+  }
+
+  mFlash.Programs++;
+  mFlash.Bytes += Count;
+  if (Count != 0) {
+    mFlash.Pages += (Offset + Count - 1) / TEST_PAGE_SIZE - Offset / TEST_PAGE_SIZE + 1;
+  }
+
+  return Status;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFvbEraseBlocks (
+  IN EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  ...
+  )
+{
+  va_list   Marker;
+  EFI_LBA   Lba;
+  UINTN     Count;
+
+  va_start (Marker, This);
+  for (;;) {
+    Lba = va_arg (Marker, EFI_LBA);
+    if (Lba == EFI_LBA_LIST_TERMINATOR) {
+      break;
+    }
+
+    Count = va_arg (Marker, UINTN);
+    if (Lba + Count > TEST_BLOCK_COUNT) {
+      va_end (Marker);
+      return EFI_INVALID_PARAMETER;
+    }
+
+    for (; Count > 0; Count--, Lba++) {
+      if (mFlash.Budget == 0) {
+        va_end (Marker);
+        longjmp (mPowerCut, 1);
+      }
+
+      if (mFlash.Budget != TEST_NO_POWER_CUT) {
+        mFlash.Budget--;
+      }
+
+      memset (FlashAt (Lba), 0xFF, TEST_BLOCK_SIZE);
+      mFlash.Erases++;
+    }
+  }
+
+  va_end (Marker);
+  return EFI_SUCCESS;
+}
+
+static
+VOID
+ResetCounters (
+  VOID
+  )
+{
+  mFlash.Erases   = 0;
+  mFlash.Programs = 0;
+  mFlash.Pages    = 0;
+  mFlash.Bytes    = 0;
+  mFlash.BitsSet  = 0;
+}
+
+static
+VOID
+EraseFlash (
+  VOID
+  )
+{
+  TEST_FV_HEADER  *Fv;
+
+  memset (mFlash.Base, 0xFF, TEST_FLASH_SIZE);
+
+  //
+  // LBA 0 holds the volume header the driver reads the block map from
+  //
+  Fv = (TEST_FV_HEADER *) mFlash.Base;
+  memset (Fv, 0, sizeof (TEST_FV_HEADER));
+  Fv->Header.FvLength                 = TEST_FLASH_SIZE;
+  Fv->Header.Signature                = EFI_FVH_SIGNATURE;
+  Fv->Header.HeaderLength             = (UINT16) sizeof (TEST_FV_HEADER);
+  Fv->Header.FvBlockMap[0].NumBlocks  = TEST_BLOCK_COUNT;
+  Fv->Header.FvBlockMap[0].BlockLength = TEST_BLOCK_SIZE;
+
+  mFlash.Budget = TEST_NO_POWER_CUT;
+  ResetCounters ();
+}
+
+//
+// Boot services and driver library used by the driver
+//
+static
+EFI_STATUS
+EFIAPI
+TestAllocatePool (
+  IN  EFI_MEMORY_TYPE  PoolType,
+  IN  UINTN            Size,
+  OUT VOID             **Buffer
+  )
+{
+  TEST_POOL *Pool;
+
+  Pool = malloc (sizeof (TEST_POOL) + Size);
+  if (Pool == NULL) {
+    *Buffer = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Pool->Next        = mPools.Next;
+  Pool->Prev        = &mPools;
+  mPools.Next->Prev = Pool;
+  mPools.Next       = Pool;
+  *Buffer           = Pool + 1;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFreePool (
+  IN VOID  *Buffer
+  )
+{
+  TEST_POOL *Pool;
+
+  Pool              = (TEST_POOL *) Buffer - 1;
+  Pool->Prev->Next  = Pool->Next;
+  Pool->Next->Prev  = Pool->Prev;
+  free (Pool);
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestLocateHandleBuffer (
+  IN     EFI_LOCATE_SEARCH_TYPE  SearchType,
+  IN     EFI_GUID                *Protocol OPTIONAL,
+  IN     VOID                    *SearchKey OPTIONAL,
+  IN OUT UINTN                   *NumberHandles,
+  OUT    EFI_HANDLE              **Buffer
+  )
+{
+  if ((SearchType != ByProtocol) || !EfiCompareGuid (Protocol, &gEfiFirmwareVolumeBlockProtocolGuid)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (TestAllocatePool (EfiBootServicesData, sizeof (EFI_HANDLE), (VOID **) Buffer) != EFI_SUCCESS) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  (*Buffer)[0]    = &mFvbHandle;
+  *NumberHandles  = 1;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestHandleProtocol (
+  IN  EFI_HANDLE  Handle,
+  IN  EFI_GUID    *Protocol,
+  OUT VOID        **Interface
+  )
+{
+  UINTN Index;
+
+  if ((Handle == &mFvbHandle) && EfiCompareGuid (Protocol, &gEfiFirmwareVolumeBlockProtocolGuid)) {
+    *Interface = &mFlash.Fvb;
+    return EFI_SUCCESS;
+  }
+
+  for (Index = 0; Index < mProtocolCount; Index++) {
+    if ((mProtocols[Index].Handle == Handle) && EfiCompareGuid (Protocol, mProtocols[Index].Guid)) {
+      *Interface = mProtocols[Index].Interface;
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_UNSUPPORTED;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestInstallProtocolInterface (
+  IN OUT EFI_HANDLE          *Handle,
+  IN     EFI_GUID            *Protocol,
+  IN     EFI_INTERFACE_TYPE  InterfaceType,
+  IN     VOID                *Interface
+  )
+{
+  if (mProtocolCount == TEST_MAX_PROTOCOLS) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (*Handle == NULL) {
+    *Handle = &mFtwHandle;
+  }
+
+  mProtocols[mProtocolCount].Handle    = *Handle;
+  mProtocols[mProtocolCount].Guid      = Protocol;
+  mProtocols[mProtocolCount].Interface = Interface;
+  mProtocolCount++;
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestLocateProtocol (
+  IN  EFI_GUID  *Protocol,
+  IN  VOID      *Registration OPTIONAL,
+  OUT VOID      **Interface
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < mProtocolCount; Index++) {
+    if (EfiCompareGuid (Protocol, mProtocols[Index].Guid)) {
+      *Interface = mProtocols[Index].Interface;
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestCalculateCrc32 (
+  IN  VOID    *Data,
+  IN  UINTN   DataSize,
+  OUT UINT32  *CrcOut
+  )
+{
+  UINT8   *Byte;
+  UINT32  Crc;
+  UINTN   Bit;
+
+  Crc = 0xFFFFFFFF;
+  for (Byte = Data; DataSize > 0; DataSize--, Byte++) {
+    Crc ^= *Byte;
+    for (Bit = 0; Bit < 8; Bit++) {
+      Crc = (Crc >> 1) ^ (0xEDB88320 & (0 - (Crc & 1)));
+    }
+  }
+
+  *CrcOut = ~Crc;
+  return EFI_SUCCESS;
+}
+
+static
+VOID
+EFIAPI
+TestCopyMem (
+  IN VOID   *Destination,
+  IN VOID   *Source,
+  IN UINTN  Length
+  )
+{
+  memmove (Destination, Source, Length);
+}
+
+static
+VOID
+EFIAPI
+TestSetMem (
+  IN VOID   *Buffer,
+  IN UINTN  Size,
+  IN UINT8  Value
+  )
+{
+  memset (Buffer, Value, Size);
+}
+
+EFI_STATUS
+EfiInitializeDriverLib (
+  IN EFI_HANDLE           ImageHandle,
+  IN EFI_SYSTEM_TABLE     *SystemTable
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EfiLibGetSystemConfigurationTable (
+  IN EFI_GUID *TableGuid,
+  OUT VOID **Table
+  )
+{
+  if (!EfiCompareGuid (TableGuid, &gEfiHobListGuid)) {
+    return EFI_NOT_FOUND;
+  }
+
+  *Table = &mFlashMap[0];
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+GetNextGuidHob (
+  IN OUT VOID      **HobStart,
+  IN     EFI_GUID  * Guid,
+  OUT    VOID      **Buffer,
+  OUT    UINTN     *BufferSize OPTIONAL
+  )
+{
+  EFI_FLASH_MAP_ENTRY_DATA  *Entry;
+
+  //
+  // The "HOB list" is the array of flash map entries
+  //
+  Entry = *HobStart;
+  if (!EfiCompareGuid (Guid, &gEfiFlashMapHobGuid) || (Entry == &mFlashMap[2])) {
+    return EFI_NOT_FOUND;
+  }
+
+  *Buffer   = Entry;
+  *HobStart = Entry + 1;
+  if (BufferSize != NULL) {
+    *BufferSize = sizeof (EFI_FLASH_MAP_ENTRY_DATA);
+  }
+
+  return EFI_SUCCESS;
+}
+
+//
+// Boot block swapping needs the chipset; the flash has no boot block.
+//
+BOOLEAN
+IsBootBlock (
+  EFI_FTW_LITE_DEVICE                 *FtwLiteDevice,
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *FvBlock,
+  EFI_LBA                             Lba
+  )
+{
+  return FALSE;
+}
+
+EFI_STATUS
+FlushSpareBlockToBootBlock (
+  EFI_FTW_LITE_DEVICE                 *FtwLiteDevice
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+static
+VOID
+InitializeHost (
+  VOID
+  )
+{
+  mFlash.Base = malloc (TEST_FLASH_SIZE);
+  if (mFlash.Base == NULL) {
+    printf ("FtwLiteTest: out of memory\n");
+    exit (2);
+  }
+
+  mFlash.Fvb.GetVolumeAttributes = TestFvbGetAttributes;
+  mFlash.Fvb.SetVolumeAttributes = TestFvbSetAttributes;
+  mFlash.Fvb.GetPhysicalAddress  = TestFvbGetPhysicalAddress;
+  mFlash.Fvb.GetBlockSize        = TestFvbGetBlockSize;
+  mFlash.Fvb.Read                = TestFvbRead;
+  mFlash.Fvb.Write               = TestFvbWrite;
+  mFlash.Fvb.EraseBlocks         = TestFvbEraseBlocks;
+
+  mBootServices.AllocatePool              = TestAllocatePool;
+  mBootServices.FreePool                  = TestFreePool;
+  mBootServices.LocateHandleBuffer        = TestLocateHandleBuffer;
+  mBootServices.HandleProtocol            = TestHandleProtocol;
+  mBootServices.InstallProtocolInterface  = TestInstallProtocolInterface;
+  mBootServices.LocateProtocol            = TestLocateProtocol;
+  mBootServices.CalculateCrc32            = TestCalculateCrc32;
+  mBootServices.CopyMem                   = TestCopyMem;
+  mBootServices.SetMem                    = TestSetMem;
+
+  mFlashMap[0].AreaType           = EFI_FLASH_AREA_FTW_STATE;
+  mFlashMap[0].NumEntries         = 1;
+  mFlashMap[0].Entries[0].Base    = (UINTN) FlashAt (TEST_WORK_SPACE_LBA);
+  mFlashMap[0].Entries[0].Length  = TEST_BLOCK_SIZE;
+  mFlashMap[1].AreaType           = EFI_FLASH_AREA_FTW_BACKUP;
+  mFlashMap[1].NumEntries         = 1;
+  mFlashMap[1].Entries[0].Base    = (UINTN) FlashAt (TEST_SPARE_LBA);
+  mFlashMap[1].Entries[0].Length  = TEST_AREA_SIZE;
+}
+
+static
+EFI_STATUS
+Boot (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Starts the driver the way a reset does: all memory of the previous
+  instance, including anything a cut operation left allocated, is dropped
+  and InitializeFtwLite runs against the flash contents.
+
+--*/
+{
+  EFI_STATUS  Status;
+
+  while (mPools.Next != &mPools) {
+    TestFreePool (mPools.Next + 1);
+  }
+
+  mProtocolCount  = 0;
+  mFtw            = NULL;
+  mFtwMultiple    = NULL;
+  mFlash.Budget   = TEST_NO_POWER_CUT;
+
+  Status = InitializeFtwLite (NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  TestLocateProtocol (&gEfiFaultTolerantWriteLiteProtocolGuid, NULL, (VOID **) &mFtw);
+  TestLocateProtocol (&gEfiFaultTolerantWriteLiteMultipleProtocolGuid, NULL, (VOID **) &mFtwMultiple);
+  if ((mFtw == NULL) || (mFtwMultiple == NULL)) {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+WriteOne (
+  IN EFI_LBA  Lba,
+  IN UINTN    Offset,
+  IN UINTN    NumBytes,
+  IN UINT8    *Buffer
+  )
+{
+  return mFtw->Write (mFtw, &mFvbHandle, Lba, Offset, &NumBytes, Buffer);
+}
+
+static
+VOID
+RandomWrites (
+  IN  UINTN                   Count,
+  IN  UINTN                   Limit,
+  OUT EFI_FTW_LITE_WRITE_DATA *Writes
+  )
+{
+  UINTN Index;
+  UINTN Byte;
+
+  for (Index = 0; Index < Count; Index++) {
+    Writes[Index].Offset   = Random () % Limit;
+    Writes[Index].NumBytes = 1 + Random () % 512;
+    if (Writes[Index].Offset + Writes[Index].NumBytes > Limit) {
+      Writes[Index].NumBytes = Limit - Writes[Index].Offset;
+    }
+
+    for (Byte = 0; Byte < Writes[Index].NumBytes; Byte++) {
+      mData[Index][Byte] = (UINT8) Random ();
+    }
+
+    Writes[Index].Buffer = mData[Index];
+  }
+}
+
+static
+VOID
+ApplyWrites (
+  IN     UINTN                   Count,
+  IN     EFI_FTW_LITE_WRITE_DATA *Writes,
+  IN OUT UINT8                   *Area
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    memcpy (Area + Writes[Index].Offset, Writes[Index].Buffer, Writes[Index].NumBytes);
+  }
+}
+
+static
+VOID
+TestProtocols (
+  VOID
+  )
+{
+  EFI_HANDLE  FtwHandle;
+  EFI_HANDLE  MultipleHandle;
+  UINTN       Index;
+
+  EraseFlash ();
+  Check (Boot () == EFI_SUCCESS, "Protocols", "driver starts on blank flash");
+  if (mFtw == NULL) {
+    return;
+  }
+
+  Check (sizeof (EFI_FTW_LITE_PROTOCOL) == sizeof (EFI_FTW_LITE_WRITE), "Protocols", "FTW Lite still only has Write");
+  Check (!EfiCompareGuid (&gEfiFaultTolerantWriteLiteProtocolGuid, &gEfiFaultTolerantWriteLiteMultipleProtocolGuid), "Protocols", "WriteMultiple has its own GUID");
+  Check (mFtw->Write == FtwLiteWrite, "Protocols", "Write is FtwLiteWrite");
+  Check (mFtwMultiple->WriteMultiple == FtwLiteWriteMultiple, "Protocols", "WriteMultiple is FtwLiteWriteMultiple");
+
+  FtwHandle       = NULL;
+  MultipleHandle  = NULL;
+  for (Index = 0; Index < mProtocolCount; Index++) {
+    if (mProtocols[Index].Interface == mFtw) {
+      FtwHandle = mProtocols[Index].Handle;
+    }
+
+    if (mProtocols[Index].Interface == mFtwMultiple) {
+      MultipleHandle = mProtocols[Index].Handle;
+    }
+  }
+
+  Check ((FtwHandle != NULL) && (FtwHandle == MultipleHandle), "Protocols", "both protocols are on one handle");
+}
+
+static
+VOID
+TestRandomWrites (
+  VOID
+  )
+{
+  EFI_FTW_LITE_WRITE_DATA Writes[8];
+  EFI_STATUS              Status;
+  UINTN                   Round;
+  UINTN                   Count;
+  UINTN                   Failed;
+
+  EraseFlash ();
+  if (Boot () != EFI_SUCCESS) {
+    Check (FALSE, "RandomWrites", "driver starts");
+    return;
+  }
+
+  memcpy (mExpected, FlashAt (TEST_TARGET_LBA), TEST_AREA_SIZE);
+
+  //
+  // Enough updates to reclaim the work space several times
+  //
+  Failed = 0;
+  for (Round = 0; Round < 300; Round++) {
+    Count = 1 + Random () % 8;
+    RandomWrites (Count, TEST_AREA_SIZE, Writes);
+    if ((Round % 3) == 0) {
+      Count   = 1;
+      Status  = WriteOne (TEST_TARGET_LBA, Writes[0].Offset, Writes[0].NumBytes, Writes[0].Buffer);
+    } else {
+      Status = mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, Count, Writes);
+    }
+
+    ApplyWrites (Count, Writes, mExpected);
+    if ((Status != EFI_SUCCESS) || (memcmp (mExpected, FlashAt (TEST_TARGET_LBA), TEST_AREA_SIZE) != 0)) {
+      Failed++;
+    }
+  }
+
+  Check (Failed == 0, "RandomWrites", "target matches the reference after every update");
+  Check (mFlash.BitsSet == 0, "RandomWrites", "no program sets a cleared bit");
+
+  //
+  // The work space survives a restart with the same contents
+  //
+  Check (Boot () == EFI_SUCCESS, "RandomWrites", "driver restarts");
+  Check (memcmp (mExpected, FlashAt (TEST_TARGET_LBA), TEST_AREA_SIZE) == 0, "RandomWrites", "restart leaves the target alone");
+}
+
+static
+VOID
+TestOverlap (
+  VOID
+  )
+{
+  EFI_FTW_LITE_WRITE_DATA Writes[3];
+  UINT8                   First[64];
+  UINT8                   Second[16];
+  UINT8                   Third[4];
+  UINT8                   *Target;
+
+  EraseFlash ();
+  if (Boot () != EFI_SUCCESS) {
+    Check (FALSE, "Overlap", "driver starts");
+    return;
+  }
+
+  memset (First, 0x11, sizeof (First));
+  memset (Second, 0x22, sizeof (Second));
+  memset (Third, 0x33, sizeof (Third));
+  Writes[0].Offset    = 0x100;
+  Writes[0].NumBytes  = sizeof (First);
+  Writes[0].Buffer    = First;
+  Writes[1].Offset    = 0x110;
+  Writes[1].NumBytes  = sizeof (Second);
+  Writes[1].Buffer    = Second;
+  Writes[2].Offset    = 0x118;
+  Writes[2].NumBytes  = sizeof (Third);
+  Writes[2].Buffer    = Third;
+
+  Check (
+    mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 3, Writes) == EFI_SUCCESS,
+    "Overlap",
+    "WriteMultiple succeeds"
+    );
+
+  Target = FlashAt (TEST_TARGET_LBA);
+  Check (Target[0x100] == 0x11 && Target[0x13f] == 0x11, "Overlap", "first write outside the others");
+  Check (Target[0x110] == 0x22 && Target[0x11f] == 0x22, "Overlap", "second write over the first");
+  Check (Target[0x118] == 0x33 && Target[0x11b] == 0x33, "Overlap", "last write wins");
+  Check (Target[0xff] == 0xff && Target[0x140] == 0xff, "Overlap", "bytes around the writes untouched");
+}
+
+static
+VOID
+TestSameCost (
+  VOID
+  )
+{
+  EFI_FTW_LITE_WRITE_DATA Writes[8];
+  UINTN                   SingleErases;
+  UINTN                   SinglePrograms;
+
+  EraseFlash ();
+  if (Boot () != EFI_SUCCESS) {
+    Check (FALSE, "SameCost", "driver starts");
+    return;
+  }
+
+  RandomWrites (8, TEST_AREA_SIZE, Writes);
+
+  ResetCounters ();
+  WriteOne (TEST_TARGET_LBA, Writes[0].Offset, Writes[0].NumBytes, Writes[0].Buffer);
+  SingleErases    = mFlash.Erases;
+  SinglePrograms  = mFlash.Programs;
+
+  ResetCounters ();
+  mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 8, Writes);
+  Check (mFlash.Erases == SingleErases, "SameCost", "eight writes erase as much as one");
+  Check (mFlash.Programs == SinglePrograms, "SameCost", "eight writes program as often as one");
+}
+
+static
+VOID
+TestParameters (
+  VOID
+  )
+{
+  EFI_FTW_LITE_WRITE_DATA Writes[2];
+  UINT8                   Data[16];
+
+  EraseFlash ();
+  if (Boot () != EFI_SUCCESS) {
+    Check (FALSE, "Parameters", "driver starts");
+    return;
+  }
+
+  memset (Data, 0, sizeof (Data));
+  memcpy (mOld, FlashAt (TEST_TARGET_LBA), TEST_AREA_SIZE);
+
+  Writes[0].Offset    = 0;
+  Writes[0].NumBytes  = sizeof (Data);
+  Writes[0].Buffer    = Data;
+  Writes[1].Offset    = TEST_AREA_SIZE - 8;
+  Writes[1].NumBytes  = sizeof (Data);
+  Writes[1].Buffer    = Data;
+
+  ResetCounters ();
+  Check (
+    mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 0, Writes) == EFI_INVALID_PARAMETER,
+    "Parameters",
+    "no writes"
+    );
+  Check (
+    mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 1, NULL) == EFI_INVALID_PARAMETER,
+    "Parameters",
+    "no write array"
+    );
+  Check (
+    mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 2, Writes) == EFI_BAD_BUFFER_SIZE,
+    "Parameters",
+    "a write past the spare size"
+    );
+  Check (
+    WriteOne (TEST_TARGET_LBA, TEST_AREA_SIZE - 8, sizeof (Data), Data) == EFI_BAD_BUFFER_SIZE,
+    "Parameters",
+    "Write past the spare size"
+    );
+  Check (mFlash.Programs == 0 && mFlash.Erases == 0, "Parameters", "refused writes leave the flash alone");
+  Check (memcmp (mOld, FlashAt (TEST_TARGET_LBA), TEST_AREA_SIZE) == 0, "Parameters", "target unchanged");
+}
+
+static
+VOID
+TestWorkingBlockTarget (
+  VOID
+  )
+{
+  EFI_FTW_LITE_WRITE_DATA Writes[4];
+  UINTN                   Round;
+  UINTN                   Failed;
+
+  EraseFlash ();
+  if (Boot () != EFI_SUCCESS) {
+    Check (FALSE, "WorkingBlock", "driver starts");
+    return;
+  }
+
+  //
+  // The first three blocks of the working block are free for data; the
+  // last one holds the work space.
+  //
+  memcpy (mExpected, FlashAt (TEST_WORK_BLOCK_LBA), TEST_AREA_SIZE);
+  Failed = 0;
+  for (Round = 0; Round < 40; Round++) {
+    RandomWrites (4, TEST_AREA_SIZE - TEST_BLOCK_SIZE, Writes);
+    if (mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_WORK_BLOCK_LBA, 4, Writes) != EFI_SUCCESS) {
+      Failed++;
+    }
+
+    ApplyWrites (4, Writes, mExpected);
+    if (memcmp (mExpected, FlashAt (TEST_WORK_BLOCK_LBA), TEST_AREA_SIZE - TEST_BLOCK_SIZE) != 0) {
+      Failed++;
+    }
+  }
+
+  Check (Failed == 0, "WorkingBlock", "data blocks of the working block match the reference");
+  Check (Boot () == EFI_SUCCESS, "WorkingBlock", "work space still valid after a restart");
+  Check (
+    memcmp (mExpected, FlashAt (TEST_WORK_BLOCK_LBA), TEST_AREA_SIZE - TEST_BLOCK_SIZE) == 0,
+    "WorkingBlock",
+    "restart keeps the data"
+    );
+  RandomWrites (1, TEST_AREA_SIZE, Writes);
+  Check (
+    WriteOne (TEST_TARGET_LBA, Writes[0].Offset, Writes[0].NumBytes, Writes[0].Buffer) == EFI_SUCCESS,
+    "WorkingBlock",
+    "a later write elsewhere succeeds"
+    );
+}
+
+static
+VOID
+TestPowerCut (
+  VOID
+  )
+{
+  static EFI_FTW_LITE_WRITE_DATA  Writes[6];
+  static UINTN                    Budget;
+  static BOOLEAN                  Completed;
+  static UINTN                    OldCount;
+  static UINTN                    NewCount;
+  static UINTN                    Torn;
+  static UINTN                    Unusable;
+  UINTN                           Round;
+  UINT8                           *Target;
+
+  OldCount  = 0;
+  NewCount  = 0;
+  Torn      = 0;
+  Unusable  = 0;
+  Completed = FALSE;
+  for (Budget = 0; !Completed && Budget < 1000; Budget++) {
+    EraseFlash ();
+    if (Boot () != EFI_SUCCESS) {
+      Check (FALSE, "PowerCut", "driver starts");
+      return;
+    }
+
+    //
+    // Put some history in the work space, then the update to cut
+    //
+    for (Round = 0; Round < 3; Round++) {
+      RandomWrites (2, TEST_AREA_SIZE, Writes);
+      mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 2, Writes);
+    }
+
+    memcpy (mOld, FlashAt (TEST_TARGET_LBA), TEST_AREA_SIZE);
+    RandomWrites (6, TEST_AREA_SIZE, Writes);
+    memcpy (mExpected, mOld, TEST_AREA_SIZE);
+    ApplyWrites (6, Writes, mExpected);
+
+    mFlash.Budget = Budget;
+    if (setjmp (mPowerCut) == 0) {
+      mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 6, Writes);
+      Completed = TRUE;
+    }
+
+    mFlash.Budget = TEST_NO_POWER_CUT;
+    if (Boot () != EFI_SUCCESS) {
+      Unusable++;
+      continue;
+    }
+
+    Target = FlashAt (TEST_TARGET_LBA);
+    if (memcmp (Target, mOld, TEST_AREA_SIZE) == 0) {
+      OldCount++;
+    } else if (memcmp (Target, mExpected, TEST_AREA_SIZE) == 0) {
+      NewCount++;
+    } else {
+      Torn++;
+    }
+
+    //
+    // The driver takes the next update after the recovery
+    //
+    RandomWrites (3, TEST_AREA_SIZE, Writes);
+    memcpy (mOld, Target, TEST_AREA_SIZE);
+    ApplyWrites (3, Writes, mOld);
+    if ((mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 3, Writes) != EFI_SUCCESS) ||
+        (memcmp (Target, mOld, TEST_AREA_SIZE) != 0)) {
+      Unusable++;
+    }
+  }
+
+  Check (Completed, "PowerCut", "the update completes with enough power");
+  Check (Torn == 0, "PowerCut", "target is all old or all new after a cut");
+  Check (Unusable == 0, "PowerCut", "driver recovers and takes the next update");
+  Check (OldCount != 0 && NewCount != 0, "PowerCut", "cuts land on both sides of the spare commit");
+}
+
+static
+VOID
+PrintCost (
+  IN CONST CHAR8  *Name,
+  IN UINTN        Updates,
+  IN double       HostUs
+  )
+{
+  printf (
+    "%-28s %4u %7u %9u %9u %10.1f %9.1f\n",
+    Name,
+    (unsigned) Updates,
+    (unsigned) mFlash.Erases,
+    (unsigned) mFlash.Programs,
+    (unsigned) mFlash.Bytes,
+    (mFlash.Erases * (double) TEST_ERASE_US + mFlash.Pages * (double) TEST_PAGE_PROGRAM_US) / 1000.0,
+    HostUs
+    );
+}
+
+static
+double
+Elapsed (
+  IN clock_t  Start
+  )
+{
+  return (double) (clock () - Start) * 1000000.0 / CLOCKS_PER_SEC;
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+{
+  static CONST UINTN      Sizes[] = { 1, 4, 16, 64 };
+  EFI_FTW_LITE_WRITE_DATA Writes[TEST_MAX_WRITES];
+  UINTN                   SizeIndex;
+  UINTN                   Count;
+  UINTN                   Index;
+  clock_t                 Start;
+  UINTN                   Header;
+
+  printf ("Flash time: %u us per %u byte erase, %u us per %u byte page\n\n",
+    TEST_ERASE_US, TEST_BLOCK_SIZE, TEST_PAGE_PROGRAM_US, TEST_PAGE_SIZE);
+  printf ("%-28s %4s %7s %9s %9s %10s %9s\n", "Update", "K", "Erases", "Programs", "Bytes", "Flash ms", "Host us");
+
+  for (SizeIndex = 0; SizeIndex < sizeof (Sizes) / sizeof (Sizes[0]); SizeIndex++) {
+    Count = Sizes[SizeIndex];
+    for (Index = 0; Index < Count; Index++) {
+      Writes[Index].Offset    = Index * (TEST_AREA_SIZE / TEST_MAX_WRITES);
+      Writes[Index].NumBytes  = 64;
+      Writes[Index].Buffer    = mData[Index];
+      memset (mData[Index], (UINT8) Index, 64);
+    }
+
+    EraseFlash ();
+    Boot ();
+    ResetCounters ();
+    Start = clock ();
+    for (Index = 0; Index < Count; Index++) {
+      WriteOne (TEST_TARGET_LBA, Writes[Index].Offset, Writes[Index].NumBytes, Writes[Index].Buffer);
+    }
+
+    PrintCost ("Write per update", Count, Elapsed (Start));
+
+    EraseFlash ();
+    Boot ();
+    ResetCounters ();
+    Start = clock ();
+    mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, Count, Writes);
+    PrintCost ("WriteMultiple", Count, Elapsed (Start));
+  }
+
+  //
+  // The variable driver reclaim with a new variable that did not fit:
+  // before, the reclaimed store went through Write and the variable was
+  // then programmed header, data and state outside of FTW; now both go
+  // into one WriteMultiple.
+  //
+  printf ("\n");
+  Header = 0x20;
+  memset (mData[0], 0xff, TEST_AREA_SIZE);
+  memset (mData[0], 0x5a, TEST_AREA_SIZE / 2);
+  memset (mData[1], 0xa5, 0x400);
+
+  EraseFlash ();
+  Boot ();
+  ResetCounters ();
+  Start = clock ();
+  WriteOne (TEST_TARGET_LBA, 0, TEST_AREA_SIZE, mData[0]);
+  for (Index = 0; Index < 3; Index++) {
+    Count = (Index == 0) ? Header : ((Index == 1) ? 0x400 - Header : 1);
+    mFlash.Fvb.Write (
+      &mFlash.Fvb,
+      TEST_TARGET_LBA + 2,
+      (Index == 0) ? 0 : ((Index == 1) ? Header : 0x10),
+      &Count,
+      mData[1]
+      );
+  }
+
+  PrintCost ("Reclaim, then 3 programs", 1, Elapsed (Start));
+
+  EraseFlash ();
+  Boot ();
+  ResetCounters ();
+  Writes[0].Offset    = 0;
+  Writes[0].NumBytes  = TEST_AREA_SIZE;
+  Writes[0].Buffer    = mData[0];
+  Writes[1].Offset    = TEST_AREA_SIZE / 2;
+  Writes[1].NumBytes  = 0x400;
+  Writes[1].Buffer    = mData[1];
+  Start = clock ();
+  mFtwMultiple->WriteMultiple (mFtwMultiple, &mFvbHandle, TEST_TARGET_LBA, 2, Writes);
+  PrintCost ("Reclaim with the variable", 1, Elapsed (Start));
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  InitializeHost ();
+
+  if ((argc > 1) && (strcmp (argv[1], "-b") == 0)) {
+    Benchmark ();
+    return 0;
+  }
+
+  TestProtocols ();
+  TestRandomWrites ();
+  TestOverlap ();
+  TestSameCost ();
+  TestParameters ();
+  TestWorkingBlockTarget ();
+  TestPowerCut ();
+
+  if (mFailures != 0) {
+    printf ("FtwLiteTest: %u checks failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("FtwLiteTest: all checks passed\n");
+  return 0;
+}
@@ -56,6 +56,7 @@ Returns:
 --*/
 {
   EFI_STATUS  Status;
+  UINTN       Index;
 
   ASSERT (ArpService != NULL);
 
@@ -187,6 +188,10 @@ Returns:
   NetListInit (&ArpService->DeniedCacheTable);
   NetListInit (&ArpService->ResolvedCacheTable);
 
+  for (Index = 0; Index < ARP_CACHE_HASH_SIZE; Index++) {
+    NetListInit (&ArpService->CacheHashTable[Index]);
+  }
+
 ERROR_EXIT:
 
   return Status;
@@ -219,9 +219,9 @@ Returns:
   // Check whether the sender's address information is already in the cache.
   //
   MergeFlag  = FALSE;
-  CacheEntry = ArpFindNextCacheEntryInTable (
+  CacheEntry = ArpLookupCacheEntry (
+                 ArpService,
                  &ArpService->ResolvedCacheTable,
-                 NULL,
                  ByProtoAddress,
                  &SenderAddress[Protocol],
                  NULL
@@ -247,9 +247,9 @@ Returns:
     // Add the triplet <protocol type, sender protocol address, sender hardware address>
     // to the translation table.
     //
-    CacheEntry = ArpFindNextCacheEntryInTable (
+    CacheEntry = ArpLookupCacheEntry (
+                   ArpService,
                    &ArpService->PendingRequestTable,
-                   NULL,
                    ByProtoAddress,
                    &SenderAddress[Protocol],
                    NULL
@@ -264,7 +264,7 @@ Returns:
       }
     } 
 
-    NetListRemoveEntry (&CacheEntry->List);
+    ArpRemoveCacheEntry (CacheEntry);
 
     //
     // Fill the addresses into the CacheEntry.
@@ -283,7 +283,7 @@ Returns:
     //
     // Add this entry into the ResolvedCacheTable
     //
-    NetListInsertHead (&ArpService->ResolvedCacheTable, &CacheEntry->List);
+    ArpInsertCacheEntry (ArpService, &ArpService->ResolvedCacheTable, CacheEntry);
   }
 
   if (Head->OpCode == ARP_OPCODE_REQUEST) {
@@ -471,7 +471,7 @@ Returns:
         ArpAddressResolved (CacheEntry, NULL, NULL);
         ASSERT (NetListIsEmpty (&CacheEntry->UserRequestList));
 
-        NetListRemoveEntry (&CacheEntry->List);
+        ArpRemoveCacheEntry (CacheEntry);
         NetFreePool (CacheEntry);
       } else {
         //
@@ -513,7 +513,7 @@ Returns:
       //
       // Time out, remove it.
       //
-      NetListRemoveEntry (&CacheEntry->List);
+      ArpRemoveCacheEntry (CacheEntry);
       NetFreePool (CacheEntry);
     } else {
       //
@@ -541,7 +541,7 @@ Returns:
       //
       // Time out, remove it.
       //
-      NetListRemoveEntry (&CacheEntry->List);
+      ArpRemoveCacheEntry (CacheEntry);
       NetFreePool (CacheEntry);
     } else {
       //
@@ -675,6 +675,191 @@ Returns:
   return NULL;
 }
 
+STATIC
+UINT32
+ArpHashProtoAddress (
+  IN NET_ARP_ADDRESS  *Address
+  )
+/*++
+
+Routine Description:
+
+  Compute the bucket of the protocol address in the cache hash table.
+
+Arguments:
+
+  Address - Pointer to the protocol address, AddressPtr must not be NULL.
+
+Returns:
+
+  The index of the bucket.
+
+--*/
+{
+  UINT32  Hash;
+  UINT32  Index;
+  UINT32  Length;
+
+  Hash   = Address->Type;
+  Length = (UINT32) NET_MIN (Address->Length, ARP_MAX_PROTOCOL_ADDRESS_LEN);
+
+  for (Index = 0; Index < Length; Index++) {
+    Hash = (Hash * 31) + Address->AddressPtr[Index];
+  }
+
+  //
+  // Fold the high bits in so addresses differing only in the
+  // leading bytes don't collide.
+  //
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 7;
+
+  return Hash & (ARP_CACHE_HASH_SIZE - 1);
+}
+
+ARP_CACHE_ENTRY *
+ArpLookupCacheEntry (
+  IN ARP_SERVICE_DATA  *ArpService,
+  IN NET_LIST_ENTRY    *CacheTable,
+  IN FIND_OPTYPE       FindOpType,
+  IN NET_ARP_ADDRESS   *ProtocolAddress OPTIONAL,
+  IN NET_ARP_ADDRESS   *HardwareAddress OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Find the first CacheEntry which matches the requirements in the specified
+  CacheTable. If the protocol address is part of the key, only the entries in
+  its hash bucket are checked, otherwise the whole table is searched.
+
+Arguments:
+
+  ArpService      - Pointer to the arp service context data.
+  CacheTable      - Pointer to the arp cache table.
+  FindOpType      - The search type.
+  ProtocolAddress - Pointer to the protocol address to match.
+  HardwareAddress - Pointer to the hardware address to match.
+
+Returns:
+
+  Pointer to the matched arp cache entry, if NULL, no match is found.
+
+--*/
+{
+  NET_LIST_ENTRY   *Bucket;
+  NET_LIST_ENTRY   *Entry;
+  ARP_CACHE_ENTRY  *CacheEntry;
+
+  if (!(FindOpType & MATCH_SW_ADDRESS) || (ProtocolAddress->AddressPtr == NULL)) {
+    //
+    // A NULL AddressPtr matches any address, it can't be hashed.
+    //
+    return ArpFindNextCacheEntryInTable (
+             CacheTable,
+             NULL,
+             FindOpType,
+             ProtocolAddress,
+             HardwareAddress
+             );
+  }
+
+  Bucket = &ArpService->CacheHashTable[ArpHashProtoAddress (ProtocolAddress)];
+
+  NET_LIST_FOR_EACH (Entry, Bucket) {
+    CacheEntry = NET_LIST_USER_STRUCT (Entry, ARP_CACHE_ENTRY, HashLink);
+
+    if ((CacheEntry->CacheTable != CacheTable) ||
+      !ArpMatchAddress (ProtocolAddress, &CacheEntry->Addresses[Protocol])) {
+      continue;
+    }
+
+    if ((FindOpType & MATCH_HW_ADDRESS) &&
+      !ArpMatchAddress (HardwareAddress, &CacheEntry->Addresses[Hardware])) {
+      continue;
+    }
+
+    return CacheEntry;
+  }
+
+  return NULL;
+}
+
+VOID
+ArpInsertCacheEntry (
+  IN ARP_SERVICE_DATA  *ArpService,
+  IN NET_LIST_ENTRY    *CacheTable,
+  IN ARP_CACHE_ENTRY   *CacheEntry
+  )
+/*++
+
+Routine Description:
+
+  Add the CacheEntry into the CacheTable and hash it by its protocol address.
+  The protocol address must be filled before and not changed until the entry
+  is removed by ArpRemoveCacheEntry.
+
+Arguments:
+
+  ArpService - Pointer to the arp service context data.
+  CacheTable - Pointer to the arp cache table.
+  CacheEntry - Pointer to the cache entry to add.
+
+Returns:
+
+  None.
+
+--*/
+{
+  UINT32  Bucket;
+
+  //
+  // The pending requests are retried in the order they are issued, the
+  // latest resolved or denied entries are searched first.
+  //
+  if (CacheTable == &ArpService->PendingRequestTable) {
+    NetListInsertTail (CacheTable, &CacheEntry->List);
+  } else {
+    NetListInsertHead (CacheTable, &CacheEntry->List);
+  }
+
+  Bucket = ArpHashProtoAddress (&CacheEntry->Addresses[Protocol]);
+  NetListInsertHead (&ArpService->CacheHashTable[Bucket], &CacheEntry->HashLink);
+
+  CacheEntry->CacheTable = CacheTable;
+}
+
+VOID
+ArpRemoveCacheEntry (
+  IN ARP_CACHE_ENTRY  *CacheEntry
+  )
+/*++
+
+Routine Description:
+
+  Remove the CacheEntry from its cache table and hash bucket. It's a no-op
+  for a new entry which isn't added to any table.
+
+Arguments:
+
+  CacheEntry - Pointer to the cache entry to remove.
+
+Returns:
+
+  None.
+
+--*/
+{
+  if (CacheEntry->CacheTable == NULL) {
+    return ;
+  }
+
+  NetListRemoveEntry (&CacheEntry->List);
+  NetListRemoveEntry (&CacheEntry->HashLink);
+
+  CacheEntry->CacheTable = NULL;
+}
+
 ARP_CACHE_ENTRY *
 ArpFindDeniedCacheEntry (
   IN ARP_SERVICE_DATA  *ArpService,
@@ -711,9 +896,9 @@ Returns:
     //
     // Find the cache entry in the DeniedCacheTable by the protocol address.
     //
-    CacheEntry = ArpFindNextCacheEntryInTable (
+    CacheEntry = ArpLookupCacheEntry (
+                   ArpService,
                    &ArpService->DeniedCacheTable,
-                   NULL,
                    ByProtoAddress,
                    ProtocolAddress,
                    NULL
@@ -778,7 +963,9 @@ Returns:
   // Init the lists.
   //
   NetListInit (&CacheEntry->List);
+  NetListInit (&CacheEntry->HashLink);
   NetListInit (&CacheEntry->UserRequestList);
+  CacheEntry->CacheTable = NULL;
 
   for (Index = 0; Index < 2; Index++) {
     //
@@ -1365,7 +1552,7 @@ MATCHED:
     //
     // Delete this entry.
     //
-    NetListRemoveEntry (&CacheEntry->List);
+    ArpRemoveCacheEntry (CacheEntry);
     ASSERT (NetListIsEmpty (&CacheEntry->UserRequestList));
     NetFreePool (CacheEntry);
 
@@ -1488,7 +1675,7 @@ Returns:
         //
         // No user requests any more, remove this request cache entry.
         //
-        NetListRemoveEntry (&CacheEntry->List);
+        ArpRemoveCacheEntry (CacheEntry);
         NetFreePool (CacheEntry);
       }
     }
@@ -43,6 +43,12 @@ Abstract:
 #define ARP_DEFAULT_RETRY_INTERVAL   (5   * TICKS_PER_MS)
 #define ARP_PERIODIC_TIMER_INTERVAL  (500 * TICKS_PER_MS)
 
+//
+// The cache entries of all the tables are also hashed by the protocol address
+// so the per-packet lookups don't walk the whole cache. Must be a power of 2.
+//
+#define ARP_CACHE_HASH_SIZE          128
+
 #pragma pack(1)
 typedef struct _ARP_HEAD {
   UINT16  HwType;
@@ -123,6 +129,7 @@ typedef struct _ARP_SERVICE_DATA {
   NET_LIST_ENTRY                   PendingRequestTable;
   NET_LIST_ENTRY                   DeniedCacheTable;
   NET_LIST_ENTRY                   ResolvedCacheTable;
+  NET_LIST_ENTRY                   CacheHashTable[ARP_CACHE_HASH_SIZE];
 
   EFI_EVENT                        PeriodicTimer;
 } ARP_SERVICE_DATA;
@@ -154,6 +161,8 @@ typedef enum {
 
 typedef struct _ARP_CACHE_ENTRY {
   NET_LIST_ENTRY  List;
+  NET_LIST_ENTRY  HashLink;
+  NET_LIST_ENTRY  *CacheTable;
 
   UINT32          RetryCount;
   UINT32          DefaultDecayTime;
@@ -248,6 +257,27 @@ ArpFindNextCacheEntryInTable (
   IN NET_ARP_ADDRESS   *HardwareAddress OPTIONAL
   );
 
+ARP_CACHE_ENTRY *
+ArpLookupCacheEntry (
+  IN ARP_SERVICE_DATA  *ArpService,
+  IN NET_LIST_ENTRY    *CacheTable,
+  IN FIND_OPTYPE       FindOpType,
+  IN NET_ARP_ADDRESS   *ProtocolAddress OPTIONAL,
+  IN NET_ARP_ADDRESS   *HardwareAddress OPTIONAL
+  );
+
+VOID
+ArpInsertCacheEntry (
+  IN ARP_SERVICE_DATA  *ArpService,
+  IN NET_LIST_ENTRY    *CacheTable,
+  IN ARP_CACHE_ENTRY   *CacheEntry
+  );
+
+VOID
+ArpRemoveCacheEntry (
+  IN ARP_CACHE_ENTRY   *CacheEntry
+  );
+
 ARP_CACHE_ENTRY *
 ArpAllocCacheEntry (
   IN ARP_INSTANCE_DATA  *Instance  
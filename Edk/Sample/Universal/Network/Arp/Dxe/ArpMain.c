@@ -186,9 +186,9 @@ Returns:
     //
     // Check the ResolvedCacheTable
     //
-    CacheEntry = ArpFindNextCacheEntryInTable (
+    CacheEntry = ArpLookupCacheEntry (
+                   ArpService,
                    &ArpService->ResolvedCacheTable,
-                   NULL,
                    ByBoth,
                    &MatchAddress[Protocol],
                    &MatchAddress[Hardware]
@@ -207,9 +207,9 @@ Returns:
     //
     // Check whether there are pending requests matching the entry to be added.
     //
-    CacheEntry = ArpFindNextCacheEntryInTable (
+    CacheEntry = ArpLookupCacheEntry (
+                   ArpService,
                    &ArpService->PendingRequestTable,
-                   NULL,
                    ByProtoAddress,
                    &MatchAddress[Protocol],
                    NULL
@@ -220,7 +220,7 @@ Returns:
     //
     // Remove it from the Table.
     //
-    NetListRemoveEntry (&CacheEntry->List);
+    ArpRemoveCacheEntry (CacheEntry);
   } else {
     //
     // It's a new entry, allocate memory for the entry.
@@ -258,9 +258,9 @@ Returns:
   // Add this CacheEntry to the corresponding CacheTable.
   //
   if (DenyFlag) {
-    NetListInsertHead (&ArpService->DeniedCacheTable, &CacheEntry->List);
+    ArpInsertCacheEntry (ArpService, &ArpService->DeniedCacheTable, CacheEntry);
   } else {
-    NetListInsertHead (&ArpService->ResolvedCacheTable, &CacheEntry->List);
+    ArpInsertCacheEntry (ArpService, &ArpService->ResolvedCacheTable, CacheEntry);
   }
 
 UNLOCK_EXIT:
@@ -580,9 +580,9 @@ Returns:
   //
   // Check whether the software address is already resolved.
   //
-  CacheEntry = ArpFindNextCacheEntryInTable (
+  CacheEntry = ArpLookupCacheEntry (
+                 ArpService,
                  &ArpService->ResolvedCacheTable,
-                 NULL,
                  ByProtoAddress,
                  &ProtocolAddress,
                  NULL
@@ -624,9 +624,9 @@ Returns:
   //
   // Check whether there is a same request.
   //
-  CacheEntry = ArpFindNextCacheEntryInTable (
+  CacheEntry = ArpLookupCacheEntry (
+                 ArpService,
                  &ArpService->PendingRequestTable,
-                 NULL,
                  ByProtoAddress,
                  &ProtocolAddress,
                  NULL
@@ -656,7 +656,7 @@ Returns:
     //
     // Add this entry into the PendingRequestTable.
     //
-    NetListInsertTail (&ArpService->PendingRequestTable, &CacheEntry->List);
+    ArpInsertCacheEntry (ArpService, &ArpService->PendingRequestTable, CacheEntry);
   }
 
   //
@@ -0,0 +1,583 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  ArpCacheTest.c
+
+Abstract:
+
+  Host test and benchmark for the hashed ARP cache lookup.
+
+  The driver's ArpImpl.c is linked into a host program with a service
+  context that has no MNP child. The test fills the resolved, denied and
+  pending tables, then checks that ArpLookupCacheEntry returns the same
+  entry as the linear ArpFindNextCacheEntryInTable walk for every search
+  type the driver issues, before and after entries are deleted. With -b
+  the program times both lookups for caches of 64 to 16384 neighbours.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ArpImpl.h"
+#include "NetHostLib.h"
+
+#define TEST_ETHER_TYPE         1
+#define TEST_IP4_TYPE           0x0800
+#define TEST_ENTRIES            4096
+#define TEST_ABSENT             512
+
+static UINTN              mFailures = 0;
+
+static
+VOID
+Check (
+  IN BOOLEAN  Condition,
+  IN char     *Test,
+  IN char     *What
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Condition - The result of the check
+  Test      - Name of the test
+  What      - The condition that was checked
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Condition) {
+    return ;
+  }
+
+  if (mFailures < 20) {
+    printf ("FAIL: %s: %s\n", Test, What);
+  }
+
+  mFailures++;
+}
+
+static
+VOID
+InitService (
+  OUT ARP_SERVICE_DATA      *ArpService,
+  OUT ARP_INSTANCE_DATA     *Instance
+  )
+/*++
+
+Routine Description:
+
+  Initialize the cache tables of a service the way ArpCreateService does,
+  and an IPv4 instance bound to it.
+
+Arguments:
+
+  ArpService - The service to initialize
+  Instance   - The instance to initialize
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN  Index;
+
+  memset (ArpService, 0, sizeof (*ArpService));
+  ArpService->Signature = ARP_SERVICE_DATA_SIGNATURE;
+
+  NetListInit (&ArpService->ChildrenList);
+  NetListInit (&ArpService->PendingRequestTable);
+  NetListInit (&ArpService->DeniedCacheTable);
+  NetListInit (&ArpService->ResolvedCacheTable);
+
+  for (Index = 0; Index < ARP_CACHE_HASH_SIZE; Index++) {
+    NetListInit (&ArpService->CacheHashTable[Index]);
+  }
+
+  memset (Instance, 0, sizeof (*Instance));
+  Instance->Signature                = ARP_INSTANCE_DATA_SIGNATURE;
+  Instance->ArpService               = ArpService;
+  Instance->ConfigData.SwAddressType = TEST_IP4_TYPE;
+  Instance->ConfigData.SwAddressLength = 4;
+}
+
+static
+VOID
+MakeAddresses (
+  IN  UINT32                Ip,
+  IN  UINT32                Mac,
+  OUT NET_ARP_ADDRESS       *SwAddr,
+  OUT NET_ARP_ADDRESS       *HwAddr
+  )
+/*++
+
+Routine Description:
+
+  Build the search keys for an IPv4 address and an Ethernet address whose
+  low four bytes are Mac.
+
+Arguments:
+
+  Ip     - The IPv4 address, in host byte order
+  Mac    - The low four bytes of the Ethernet address
+  SwAddr - The protocol address key
+  HwAddr - The hardware address key
+
+Returns:
+
+  None
+
+--*/
+{
+  memset (SwAddr, 0, sizeof (*SwAddr));
+  SwAddr->Type       = TEST_IP4_TYPE;
+  SwAddr->Length     = 4;
+  SwAddr->AddressPtr = SwAddr->Buffer.ProtoAddress;
+  SwAddr->Buffer.ProtoAddress[0] = (UINT8) (Ip >> 24);
+  SwAddr->Buffer.ProtoAddress[1] = (UINT8) (Ip >> 16);
+  SwAddr->Buffer.ProtoAddress[2] = (UINT8) (Ip >> 8);
+  SwAddr->Buffer.ProtoAddress[3] = (UINT8) Ip;
+
+  memset (HwAddr, 0, sizeof (*HwAddr));
+  HwAddr->Type       = TEST_ETHER_TYPE;
+  HwAddr->Length     = 6;
+  HwAddr->AddressPtr = HwAddr->Buffer.HwAddress;
+  HwAddr->Buffer.HwAddress[0] = 0x00;
+  HwAddr->Buffer.HwAddress[1] = 0x16;
+  HwAddr->Buffer.HwAddress[2] = (UINT8) (Mac >> 24);
+  HwAddr->Buffer.HwAddress[3] = (UINT8) (Mac >> 16);
+  HwAddr->Buffer.HwAddress[4] = (UINT8) (Mac >> 8);
+  HwAddr->Buffer.HwAddress[5] = (UINT8) Mac;
+}
+
+static
+ARP_CACHE_ENTRY *
+AddEntry (
+  IN ARP_SERVICE_DATA       *ArpService,
+  IN NET_LIST_ENTRY         *CacheTable,
+  IN UINT32                 Ip,
+  IN UINT32                 Mac
+  )
+/*++
+
+Routine Description:
+
+  Add a cache entry for Ip and Mac to the CacheTable, the way ArpAdd and
+  ArpRequest do.
+
+Arguments:
+
+  ArpService - The service that owns the table
+  CacheTable - The table to add the entry to
+  Ip         - The IPv4 address, in host byte order
+  Mac        - The low four bytes of the Ethernet address
+
+Returns:
+
+  The new cache entry.
+
+--*/
+{
+  ARP_CACHE_ENTRY  *CacheEntry;
+  NET_ARP_ADDRESS  SwAddr;
+  NET_ARP_ADDRESS  HwAddr;
+
+  CacheEntry = ArpAllocCacheEntry (NULL);
+
+  if (CacheEntry == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  MakeAddresses (Ip, Mac, &SwAddr, &HwAddr);
+  ArpFillAddressInCacheEntry (CacheEntry, &HwAddr, &SwAddr);
+  ArpInsertCacheEntry (ArpService, CacheTable, CacheEntry);
+
+  return CacheEntry;
+}
+
+static
+VOID
+FreeTable (
+  IN NET_LIST_ENTRY         *CacheTable
+  )
+/*++
+
+Routine Description:
+
+  Remove and free every entry in the CacheTable.
+
+--*/
+{
+  ARP_CACHE_ENTRY  *CacheEntry;
+
+  while (!NetListIsEmpty (CacheTable)) {
+    CacheEntry = NET_LIST_HEAD (CacheTable, ARP_CACHE_ENTRY, List);
+    ArpRemoveCacheEntry (CacheEntry);
+    free (CacheEntry);
+  }
+}
+
+static
+UINT32
+TestIp (
+  IN UINT32                 Index
+  )
+/*++
+
+Routine Description:
+
+  The address of the Index'th neighbour. The addresses are spread over
+  several subnets so that the hash sees more than the last byte change.
+
+--*/
+{
+  return 0x0A000000 | ((Index % 7) << 16) | (Index * 13 + 1);
+}
+
+static
+VOID
+CheckLookup (
+  IN char                   *Test,
+  IN ARP_SERVICE_DATA       *ArpService,
+  IN NET_LIST_ENTRY         *CacheTable,
+  IN FIND_OPTYPE            FindOpType,
+  IN NET_ARP_ADDRESS        *SwAddr,
+  IN NET_ARP_ADDRESS        *HwAddr
+  )
+/*++
+
+Routine Description:
+
+  Check that the hashed lookup finds the same entry as the linear walk.
+
+--*/
+{
+  ARP_CACHE_ENTRY  *Hashed;
+  ARP_CACHE_ENTRY  *Linear;
+
+  Hashed = ArpLookupCacheEntry (ArpService, CacheTable, FindOpType, SwAddr, HwAddr);
+  Linear = ArpFindNextCacheEntryInTable (CacheTable, NULL, FindOpType, SwAddr, HwAddr);
+
+  Check ((BOOLEAN) (Hashed == Linear), Test, "hashed lookup finds the linear walk's entry");
+}
+
+static
+VOID
+CheckAllLookups (
+  IN char                   *Test,
+  IN ARP_SERVICE_DATA       *ArpService,
+  IN UINT32                 Count
+  )
+/*++
+
+Routine Description:
+
+  Compare the two lookups in every table for the Count test addresses and
+  some that were never added, with the right, a wrong and a wildcard
+  hardware address.
+
+--*/
+{
+  NET_LIST_ENTRY   *Tables[3];
+  NET_ARP_ADDRESS  SwAddr;
+  NET_ARP_ADDRESS  HwAddr;
+  NET_ARP_ADDRESS  BadHwAddr;
+  NET_ARP_ADDRESS  AnySwAddr;
+  NET_ARP_ADDRESS  Unused;
+  ARP_CACHE_ENTRY  *Linear;
+  UINT32           Index;
+  UINT32           Table;
+
+  Tables[0] = &ArpService->ResolvedCacheTable;
+  Tables[1] = &ArpService->DeniedCacheTable;
+  Tables[2] = &ArpService->PendingRequestTable;
+
+  for (Index = 0; Index < Count + TEST_ABSENT; Index++) {
+    MakeAddresses (TestIp (Index), Index, &SwAddr, &HwAddr);
+    MakeAddresses (0, Index + 1, &Unused, &BadHwAddr);
+
+    for (Table = 0; Table < 3; Table++) {
+      CheckLookup (Test, ArpService, Tables[Table], ByProtoAddress, &SwAddr, NULL);
+      CheckLookup (Test, ArpService, Tables[Table], ByBoth, &SwAddr, &HwAddr);
+      CheckLookup (Test, ArpService, Tables[Table], ByBoth, &SwAddr, &BadHwAddr);
+
+      if ((Index % 64) == 0) {
+        CheckLookup (Test, ArpService, Tables[Table], ByHwAddress, NULL, &HwAddr);
+      }
+    }
+
+    //
+    // The denied table is searched by protocol address first, then by
+    // hardware address.
+    //
+    Linear = ArpFindNextCacheEntryInTable (&ArpService->DeniedCacheTable, NULL, ByProtoAddress, &SwAddr, NULL);
+    if (Linear == NULL) {
+      Linear = ArpFindNextCacheEntryInTable (&ArpService->DeniedCacheTable, NULL, ByHwAddress, NULL, &HwAddr);
+    }
+
+    Check (
+      (BOOLEAN) (ArpFindDeniedCacheEntry (ArpService, &SwAddr, &HwAddr) == Linear),
+      Test,
+      "denied lookup finds the linear walk's entry"
+      );
+  }
+
+  //
+  // A NULL AddressPtr matches any address of the type and length, the
+  // lookup has to fall back to the walk for it.
+  //
+  MakeAddresses (0, 0, &AnySwAddr, &HwAddr);
+  AnySwAddr.AddressPtr = NULL;
+
+  for (Table = 0; Table < 3; Table++) {
+    CheckLookup (Test, ArpService, Tables[Table], ByProtoAddress, &AnySwAddr, NULL);
+  }
+}
+
+static
+VOID
+TestLookup (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Fill the three tables, with duplicate protocol addresses in the resolved
+  and denied tables, and compare the lookups. Then delete entries through
+  ArpDeleteCacheEntry and compare again.
+
+--*/
+{
+  ARP_SERVICE_DATA   ArpService;
+  ARP_INSTANCE_DATA  Instance;
+  NET_ARP_ADDRESS    SwAddr;
+  NET_ARP_ADDRESS    HwAddr;
+  UINT32             Index;
+  UINTN              Deleted;
+  UINTN              Expected;
+
+  InitService (&ArpService, &Instance);
+
+  for (Index = 0; Index < TEST_ENTRIES; Index++) {
+    switch (Index % 4) {
+    case 0:
+    case 1:
+      AddEntry (&ArpService, &ArpService.ResolvedCacheTable, TestIp (Index), Index);
+      break;
+
+    case 2:
+      AddEntry (&ArpService, &ArpService.DeniedCacheTable, TestIp (Index), Index);
+      break;
+
+    default:
+      AddEntry (&ArpService, &ArpService.PendingRequestTable, TestIp (Index), 0);
+      break;
+    }
+
+    //
+    // The same protocol address with another hardware address, added
+    // later so that it's searched first.
+    //
+    if ((Index % 37) == 0) {
+      AddEntry (&ArpService, &ArpService.ResolvedCacheTable, TestIp (Index), Index + 1);
+    } else if ((Index % 41) == 2) {
+      AddEntry (&ArpService, &ArpService.DeniedCacheTable, TestIp (Index), Index + 1);
+    }
+  }
+
+  CheckAllLookups ("lookup", &ArpService, TEST_ENTRIES);
+
+  //
+  // Delete a third of the neighbours by protocol address and a few by
+  // hardware address, as ArpDelete does.
+  //
+  Expected = 0;
+  Deleted  = 0;
+
+  for (Index = 0; Index < TEST_ENTRIES; Index += 3) {
+    if ((Index % 4) == 3) {
+      continue;
+    }
+
+    MakeAddresses (TestIp (Index), Index, &SwAddr, &HwAddr);
+    Expected += (((Index % 37) == 0) || ((Index % 41) == 2)) ? 2 : 1;
+    Deleted  += ArpDeleteCacheEntry (&Instance, TRUE, SwAddr.AddressPtr, TRUE);
+
+    Check (
+      (BOOLEAN) (ArpLookupCacheEntry (&ArpService, &ArpService.ResolvedCacheTable, ByProtoAddress, &SwAddr, NULL) == NULL),
+      "delete",
+      "deleted protocol address isn't found"
+      );
+  }
+
+  Check ((BOOLEAN) (Deleted == Expected), "delete", "every entry of the address is deleted");
+
+  for (Index = 1; Index < TEST_ENTRIES; Index += 97) {
+    MakeAddresses (TestIp (Index), Index, &SwAddr, &HwAddr);
+    ArpDeleteCacheEntry (&Instance, FALSE, HwAddr.AddressPtr, TRUE);
+  }
+
+  CheckAllLookups ("lookup after delete", &ArpService, TEST_ENTRIES);
+
+  //
+  // Removing everything has to leave every hash bucket empty.
+  //
+  FreeTable (&ArpService.ResolvedCacheTable);
+  FreeTable (&ArpService.DeniedCacheTable);
+  FreeTable (&ArpService.PendingRequestTable);
+
+  for (Index = 0; Index < ARP_CACHE_HASH_SIZE; Index++) {
+    Check ((BOOLEAN) NetListIsEmpty (&ArpService.CacheHashTable[Index]), "flush", "hash bucket is empty");
+  }
+}
+
+static
+double
+TimeLookups (
+  IN ARP_SERVICE_DATA       *ArpService,
+  IN UINT32                 Count,
+  IN UINT32                 Lookups,
+  IN BOOLEAN                Hashed
+  )
+/*++
+
+Routine Description:
+
+  Time Lookups searches of the resolved table, by protocol address, for
+  neighbours picked evenly from the Count in the cache.
+
+Returns:
+
+  The nanoseconds per lookup.
+
+--*/
+{
+  NET_ARP_ADDRESS  SwAddr;
+  NET_ARP_ADDRESS  HwAddr;
+  ARP_CACHE_ENTRY  *CacheEntry;
+  clock_t          Start;
+  UINT32           Index;
+  UINT32           Found;
+
+  Found = 0;
+  Start = clock ();
+
+  for (Index = 0; Index < Lookups; Index++) {
+    MakeAddresses (TestIp ((Index * 7919) % Count), 0, &SwAddr, &HwAddr);
+
+    if (Hashed) {
+      CacheEntry = ArpLookupCacheEntry (ArpService, &ArpService->ResolvedCacheTable, ByProtoAddress, &SwAddr, NULL);
+    } else {
+      CacheEntry = ArpFindNextCacheEntryInTable (&ArpService->ResolvedCacheTable, NULL, ByProtoAddress, &SwAddr, NULL);
+    }
+
+    Found += (CacheEntry != NULL);
+  }
+
+  if (Found != Lookups) {
+    printf ("Benchmark lookup missed %u neighbours\n", (unsigned) (Lookups - Found));
+  }
+
+  return (double) (clock () - Start) * 1e9 / CLOCKS_PER_SEC / Lookups;
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+{
+  ARP_SERVICE_DATA   ArpService;
+  ARP_INSTANCE_DATA  Instance;
+  UINT32             Count;
+  UINT32             Index;
+  UINT32             Lookups;
+  double             Linear;
+  double             Hashed;
+
+  printf ("Lookup of a resolved neighbour by IPv4 address, ns per lookup\n");
+  printf ("%-10s %12s %12s %8s\n", "Neighbours", "Linear", "Hashed", "Speedup");
+
+  for (Count = 64; Count <= 16384; Count *= 4) {
+    InitService (&ArpService, &Instance);
+
+    for (Index = 0; Index < Count; Index++) {
+      AddEntry (&ArpService, &ArpService.ResolvedCacheTable, TestIp (Index), Index);
+    }
+
+    Lookups = 64 * 1024 * 1024 / Count;
+    if (Lookups > 1000000) {
+      Lookups = 1000000;
+    }
+
+    Linear = TimeLookups (&ArpService, Count, Lookups, FALSE);
+    Hashed = TimeLookups (&ArpService, Count, Lookups * 4, TRUE);
+
+    printf ("%-10u %12.1f %12.1f %7.1fx\n", (unsigned) Count, Linear, Hashed, Linear / Hashed);
+
+    FreeTable (&ArpService.ResolvedCacheTable);
+  }
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, or the benchmark when called with -b.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  NetHostLibInit ();
+
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  TestLookup ();
+
+  if (mFailures != 0) {
+    printf ("ArpCacheTest: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("ArpCacheTest: all checks passed\n");
+  return 0;
+}
@@ -56,6 +56,7 @@ Returns:
   }
 
   NetListInit (&RtEntry->Link);
+  NetListInit (&RtEntry->TrieLink);
 
   RtEntry->RefCnt  = 1;
   RtEntry->Dest    = Dest;
@@ -233,6 +234,240 @@ Returns:
 }
 
 
+STATIC
+IP4_ROUTE_TRIE_NODE *
+Ip4CreateTrieNode (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Allocate an empty route trie node.
+
+Arguments:
+
+  None
+
+Returns:
+
+  NULL if failed to allocate memory, otherwise the newly created node.
+
+--*/
+{
+  IP4_ROUTE_TRIE_NODE       *Node;
+
+  Node = NetAllocatePool (sizeof (IP4_ROUTE_TRIE_NODE));
+
+  if (Node == NULL) {
+    return NULL;
+  }
+
+  Node->Child[0] = NULL;
+  Node->Child[1] = NULL;
+  NetListInit (&Node->Routes);
+
+  return Node;
+}
+
+STATIC
+VOID
+Ip4FreeTrieNode (
+  IN IP4_ROUTE_TRIE_NODE    *Node
+  )
+/*++
+
+Routine Description:
+
+  Free the trie node and all its descendants. The route entries 
+  linked to the nodes are owned by the route area, they aren't freed.
+
+Arguments:
+
+  Node - The root of the sub-trie to free.
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Node->Child[0] != NULL) {
+    Ip4FreeTrieNode (Node->Child[0]);
+  }
+
+  if (Node->Child[1] != NULL) {
+    Ip4FreeTrieNode (Node->Child[1]);
+  }
+
+  NetFreePool (Node);
+}
+
+STATIC
+EFI_STATUS
+Ip4TrieInsert (
+  IN IP4_ROUTE_TABLE        *RtTable,
+  IN IP4_ROUTE_ENTRY        *RtEntry,
+  IN INTN                   Len
+  )
+/*++
+
+Routine Description:
+
+  Link the route entry to the trie node of its destination network,
+  creating the nodes on the path as necessary.
+
+Arguments:
+
+  RtTable - The route table to add the route entry to
+  RtEntry - The route entry
+  Len     - The length of the route entry's netmask
+
+Returns:
+
+  EFI_OUT_OF_RESOURCES - Failed to allocate memory for the trie node
+  EFI_SUCCESS          - The route entry is linked to the trie.
+
+--*/
+{
+  IP4_ROUTE_TRIE_NODE       *Node;
+  INTN                      Depth;
+  UINT32                    Bit;
+
+  Node = RtTable->Trie;
+
+  for (Depth = 0; Depth < Len; Depth++) {
+    Bit = (RtEntry->Dest >> (IP4_MASK_NUM - 2 - Depth)) & 0x01;
+
+    if (Node->Child[Bit] == NULL) {
+      Node->Child[Bit] = Ip4CreateTrieNode ();
+
+      if (Node->Child[Bit] == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+    }
+
+    Node = Node->Child[Bit];
+  }
+
+  NetListInsertHead (&Node->Routes, &RtEntry->TrieLink);
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+Ip4TrieRemove (
+  IN IP4_ROUTE_TABLE        *RtTable,
+  IN IP4_ROUTE_ENTRY        *RtEntry,
+  IN INTN                   Len
+  )
+/*++
+
+Routine Description:
+
+  Unlink the route entry from the trie, then release the nodes
+  on its path that are left without routes and children.
+
+Arguments:
+
+  RtTable - The route table to remove the route entry from
+  RtEntry - The route entry
+  Len     - The length of the route entry's netmask
+
+Returns:
+
+  None
+
+--*/
+{
+  IP4_ROUTE_TRIE_NODE       *Path[IP4_MASK_NUM];
+  IP4_ROUTE_TRIE_NODE       *Node;
+  INTN                      Depth;
+  UINT32                    Bit;
+
+  NetListRemoveEntry (&RtEntry->TrieLink);
+
+  Node    = RtTable->Trie;
+  Path[0] = Node;
+
+  for (Depth = 0; (Depth < Len) && (Node != NULL); Depth++) {
+    Bit             = (RtEntry->Dest >> (IP4_MASK_NUM - 2 - Depth)) & 0x01;
+    Node            = Node->Child[Bit];
+    Path[Depth + 1] = Node;
+  }
+
+  if (Node == NULL) {
+    return ;
+  }
+
+  //
+  // Never free the root, it is released with the route table.
+  //
+  for (Depth = Len; Depth > 0; Depth--) {
+    Node = Path[Depth];
+
+    if (!NetListIsEmpty (&Node->Routes) || 
+        (Node->Child[0] != NULL) || (Node->Child[1] != NULL)) {
+      break;
+    }
+
+    Bit = (RtEntry->Dest >> (IP4_MASK_NUM - 1 - Depth)) & 0x01;
+    Path[Depth - 1]->Child[Bit] = NULL;
+
+    NetFreePool (Node);
+  }
+}
+
+STATIC
+IP4_ROUTE_ENTRY *
+Ip4TrieLookup (
+  IN  IP4_ROUTE_TABLE       *RtTable,
+  IN  IP4_ADDR              Dst,
+  OUT INTN                  *Len
+  )
+/*++
+
+Routine Description:
+
+  Find the longest prefix match of the Dst in the route table's trie.
+
+Arguments:
+
+  RtTable - The route table to search
+  Dst     - The destination address to search for
+  Len     - Return the netmask length of the matched route
+
+Returns:
+
+  NULL if no route in this table matches the Dst, otherwise the first
+  route entry of the most specific matching network.
+
+--*/
+{
+  IP4_ROUTE_TRIE_NODE       *Node;
+  IP4_ROUTE_ENTRY           *RtEntry;
+  INTN                      Depth;
+
+  RtEntry = NULL;
+  *Len    = -1;
+  Node    = RtTable->Trie;
+
+  for (Depth = 0; Node != NULL; Depth++) {
+    if (!NetListIsEmpty (&Node->Routes)) {
+      RtEntry = NET_LIST_HEAD (&Node->Routes, IP4_ROUTE_ENTRY, TrieLink);
+      *Len    = Depth;
+    }
+
+    if (Depth == IP4_MASK_NUM - 1) {
+      break;
+    }
+
+    Node = Node->Child[(Dst >> (IP4_MASK_NUM - 2 - Depth)) & 0x01];
+  }
+
+  return RtEntry;
+}
+
 IP4_ROUTE_TABLE *
 Ip4CreateRouteTable (
   VOID
@@ -263,6 +498,13 @@ Returns:
     return NULL;
   }
 
+  RtTable->Trie = Ip4CreateTrieNode ();
+
+  if (RtTable->Trie == NULL) {
+    NetFreePool (RtTable);
+    return NULL;
+  }
+
   RtTable->RefCnt   = 1;
   RtTable->TotalNum = 0;
 
@@ -320,6 +562,7 @@ Returns:
     }
   }
 
+  Ip4FreeTrieNode (RtTable->Trie);
   Ip4CleanRouteCache (&RtTable->Cache);
   
   NetFreePool (RtTable);
@@ -402,12 +645,14 @@ Returns:
   NET_LIST_ENTRY            *Head;
   NET_LIST_ENTRY            *Entry;
   IP4_ROUTE_ENTRY           *RtEntry;
+  INTN                      Len;
 
   //
   // All the route entries with the same netmask length are 
   // linke to the same route area
   //
-  Head = &(RtTable->RouteArea[NetGetMaskLength (Netmask)]);
+  Len  = NetGetMaskLength (Netmask);
+  Head = &(RtTable->RouteArea[Len]);
 
   //
   // First check whether the route exists
@@ -433,6 +678,11 @@ Returns:
     RtEntry->Flag = IP4_DIRECT_ROUTE;
   }
 
+  if (EFI_ERROR (Ip4TrieInsert (RtTable, RtEntry, Len))) {
+    Ip4FreeRouteEntry (RtEntry);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   NetListInsertHead (Head, &RtEntry->Link);
   RtTable->TotalNum++;
 
@@ -470,14 +720,17 @@ Returns:
   NET_LIST_ENTRY            *Entry;
   NET_LIST_ENTRY            *Next;
   IP4_ROUTE_ENTRY           *RtEntry;
+  INTN                      Len;
 
-  Head = &(RtTable->RouteArea[NetGetMaskLength (Netmask)]);
+  Len  = NetGetMaskLength (Netmask);
+  Head = &(RtTable->RouteArea[Len]);
 
   NET_LIST_FOR_EACH_SAFE (Entry, Next, Head) {
     RtEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_ENTRY, Link);
 
     if (IP4_NET_EQUAL (RtEntry->Dest, Dest, Netmask) && (RtEntry->NextHop == Gateway)) {
       Ip4PurgeRouteCache (&RtTable->Cache, (UINTN) RtEntry);
+      Ip4TrieRemove (RtTable, RtEntry, Len);
       NetListRemoveEntry (Entry);
       Ip4FreeRouteEntry  (RtEntry);
 
@@ -545,10 +798,10 @@ Ip4FindRouteEntry (
 
 Routine Description:
 
-  Search the route table for a most specific match to the Dst. It searches 
-  from the longest route area (mask length == 32) to the shortest route area (
-  default routes). In each route area, it will first search the instance's 
-  route table, then the default route table. This is required by the following
+  Search the route table for a most specific match to the Dst. It looks up
+  the longest prefix match in the trie of the instance's route table and the
+  default route table. The longer match wins, and the instance's route wins 
+  if both have the same length. This is required by the following
   requirements:
     1. IP search the route table for a most specific match
     2. The local route entries have precedence over the default route entry.
@@ -565,28 +818,29 @@ Returns:
 
 --*/
 {
-  NET_LIST_ENTRY            *Entry;
   IP4_ROUTE_ENTRY           *RtEntry;
+  IP4_ROUTE_ENTRY           *Match;
   IP4_ROUTE_TABLE           *Table;
-  INTN                      Index;
+  INTN                      Len;
+  INTN                      MatchLen;
 
   RtEntry = NULL;
-    
-  for (Index = IP4_MASK_NUM - 1; Index >= 0; Index--) {
-    for (Table = RtTable; Table != NULL; Table = Table->Next) {
-      NET_LIST_FOR_EACH (Entry, &Table->RouteArea[Index]) {
-        RtEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_ENTRY, Link);
-        
-        if (IP4_NET_EQUAL (RtEntry->Dest, Dst, RtEntry->Netmask)) {
-          NET_GET_REF (RtEntry);
-          return RtEntry;
-        }      
-      }
+  Len     = -1;
+
+  for (Table = RtTable; Table != NULL; Table = Table->Next) {
+    Match = Ip4TrieLookup (Table, Dst, &MatchLen);
+
+    if ((Match != NULL) && (MatchLen > Len)) {
+      RtEntry = Match;
+      Len     = MatchLen;
     }
   }
 
+  if (RtEntry != NULL) {
+    NET_GET_REF (RtEntry);
+  }
 
-  return NULL;
+  return RtEntry;
 }
 
 IP4_ROUTE_CACHE_ENTRY *
@@ -43,6 +43,7 @@ enum {
 //
 typedef struct {
   NET_LIST_ENTRY            Link;
+  NET_LIST_ENTRY            TrieLink;
   INTN                      RefCnt;
   IP4_ADDR                  Dest;
   IP4_ADDR                  Netmask;
@@ -50,6 +51,20 @@ typedef struct {
   UINT32                    Flag;
 } IP4_ROUTE_ENTRY;
 
+//
+// The route entries are also indexed by a binary trie of the
+// destination network for the longest prefix match. The node at 
+// depth N covers the network of the N leading address bits. Routes 
+// links the route entries of exactly that network, in the same 
+// order as they are in the route area.
+//
+typedef struct _IP4_ROUTE_TRIE_NODE IP4_ROUTE_TRIE_NODE;
+
+typedef struct _IP4_ROUTE_TRIE_NODE {
+  IP4_ROUTE_TRIE_NODE       *Child[2];
+  NET_LIST_ENTRY            Routes;
+};
+
 //
 // The route cache entry. The route cache entry is optional. 
 // But it is necessary to support the ICMP redirect message.
@@ -86,7 +101,8 @@ typedef struct {
 //
 // All the route table entries with the same mask are linked 
 // together in one route area. For example, RouteArea[0] contains
-// the default routes. A route table also contains a route cache.
+// the default routes. Trie is the root of the prefix trie over the
+// same entries. A route table also contains a route cache.
 //
 typedef struct _IP4_ROUTE_TABLE IP4_ROUTE_TABLE;
 
@@ -94,6 +110,7 @@ typedef struct _IP4_ROUTE_TABLE {
   INTN                      RefCnt;
   UINT32                    TotalNum;
   NET_LIST_ENTRY            RouteArea[IP4_MASK_NUM];
+  IP4_ROUTE_TRIE_NODE       *Trie;
   IP4_ROUTE_TABLE           *Next;
   IP4_ROUTE_CACHE           Cache;
 };
@@ -0,0 +1,532 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  Ip4RouteTest.c
+
+Abstract:
+
+  Host test and benchmark for the IP4 route lookup.
+
+  The driver's Ip4Route.c is linked into a host program. The test builds
+  an instance route table chained to a default route table, with random
+  routes of every prefix length, and checks that Ip4Route picks the same
+  next hop as the route area walk the driver used before the prefix trie:
+  from the longest netmask to the shortest, the instance table before the
+  default table, the first matching entry of the area. The check is done
+  again after routes are deleted. With -b the program times both lookups
+  for tables of 256 to 16384 routes.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Ip4Impl.h"
+#include "NetHostLib.h"
+
+#define TEST_ROUTES             2000
+#define TEST_LOOKUPS            20000
+
+//
+// The sentinel next hop for "no route"
+//
+#define TEST_NO_ROUTE           0xFFFFFFFF
+
+typedef struct {
+  IP4_ADDR                  Dest;
+  IP4_ADDR                  Netmask;
+  IP4_ADDR                  Gateway;
+  BOOLEAN                   Instance;
+} TEST_ROUTE;
+
+static UINTN              mFailures = 0;
+static UINT32             mSeed     = 1;
+
+//
+// Every Ip4Route call gets a new source address, so that the lookup
+// isn't answered by the route cache.
+//
+static IP4_ADDR           mSrc      = 0;
+
+static
+VOID
+Check (
+  IN BOOLEAN  Condition,
+  IN char     *Test,
+  IN char     *What
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Condition - The result of the check
+  Test      - Name of the test
+  What      - The condition that was checked
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Condition) {
+    return ;
+  }
+
+  if (mFailures < 20) {
+    printf ("FAIL: %s: %s\n", Test, What);
+  }
+
+  mFailures++;
+}
+
+static
+UINT32
+Random (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  A repeatable pseudo random number, so that a failure can be reproduced.
+
+--*/
+{
+  mSeed ^= mSeed << 13;
+  mSeed ^= mSeed >> 17;
+  mSeed ^= mSeed << 5;
+
+  return mSeed;
+}
+
+static
+IP4_ADDR
+ReferenceRoute (
+  IN IP4_ROUTE_TABLE        *RtTable,
+  IN IP4_ADDR               Dest
+  )
+/*++
+
+Routine Description:
+
+  Route the Dest the way Ip4FindRouteEntry did before the trie: walk the
+  route areas from the most specific netmask, and for each netmask the
+  tables from the instance's to the default one.
+
+Arguments:
+
+  RtTable - The route table to search from
+  Dest    - The destination address to search for
+
+Returns:
+
+  The next hop, or TEST_NO_ROUTE if no route matches.
+
+--*/
+{
+  NET_LIST_ENTRY            *Entry;
+  IP4_ROUTE_ENTRY           *RtEntry;
+  IP4_ROUTE_TABLE           *Table;
+  INTN                      Index;
+
+  for (Index = IP4_MASK_NUM - 1; Index >= 0; Index--) {
+    for (Table = RtTable; Table != NULL; Table = Table->Next) {
+      NET_LIST_FOR_EACH (Entry, &Table->RouteArea[Index]) {
+        RtEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_ENTRY, Link);
+
+        if (IP4_NET_EQUAL (RtEntry->Dest, Dest, RtEntry->Netmask)) {
+          return (RtEntry->Flag & IP4_DIRECT_ROUTE) ? Dest : RtEntry->NextHop;
+        }
+      }
+    }
+  }
+
+  return TEST_NO_ROUTE;
+}
+
+static
+IP4_ADDR
+TrieRoute (
+  IN IP4_ROUTE_TABLE        *RtTable,
+  IN IP4_ADDR               Dest
+  )
+/*++
+
+Routine Description:
+
+  Route the Dest through Ip4Route, missing the route cache.
+
+Arguments:
+
+  RtTable - The route table to search from
+  Dest    - The destination address to search for
+
+Returns:
+
+  The next hop, or TEST_NO_ROUTE if no route matches.
+
+--*/
+{
+  IP4_ROUTE_CACHE_ENTRY     *RtCacheEntry;
+  IP4_ADDR                  NextHop;
+
+  RtCacheEntry = Ip4Route (RtTable, Dest, ++mSrc);
+
+  if (RtCacheEntry == NULL) {
+    return TEST_NO_ROUTE;
+  }
+
+  NextHop = RtCacheEntry->NextHop;
+  Ip4FreeRouteCacheEntry (RtCacheEntry);
+
+  return NextHop;
+}
+
+static
+VOID
+MakeRoutes (
+  OUT TEST_ROUTE            *Routes,
+  IN  UINT32                Count
+  )
+/*++
+
+Routine Description:
+
+  Make Count random routes. Most are /8 to /32 networks, some are shorter,
+  a few repeat an earlier network with another gateway, and about a third
+  go to the instance table.
+
+Arguments:
+
+  Routes - The routes made
+  Count  - The number of routes to make
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT32                    Index;
+  UINT32                    Len;
+
+  for (Index = 0; Index < Count; Index++) {
+    if ((Index > 0) && ((Random () % 16) == 0)) {
+      Routes[Index] = Routes[Random () % Index];
+    } else {
+      Len = ((Random () % 8) == 0) ? (Random () % 9) : (8 + Random () % 25);
+
+      Routes[Index].Netmask = mIp4AllMasks[Len];
+      Routes[Index].Dest    = Random () & Routes[Index].Netmask;
+    }
+
+    Routes[Index].Gateway  = ((Random () % 4) == 0) ? IP4_ALLZERO_ADDRESS : (Random () | 1);
+    Routes[Index].Instance = (BOOLEAN) ((Random () % 3) == 0);
+  }
+}
+
+static
+VOID
+AddRoutes (
+  IN IP4_ROUTE_TABLE        *InstanceTable,
+  IN IP4_ROUTE_TABLE        *DefaultTable,
+  IN TEST_ROUTE             *Routes,
+  IN UINT32                 Count
+  )
+/*++
+
+Routine Description:
+
+  Add the routes to the table each belongs to. A repeated route is
+  refused by Ip4AddRoute, as it would be for the driver's user.
+
+--*/
+{
+  UINT32                    Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    Ip4AddRoute (
+      Routes[Index].Instance ? InstanceTable : DefaultTable,
+      Routes[Index].Dest,
+      Routes[Index].Netmask,
+      Routes[Index].Gateway
+      );
+  }
+}
+
+static
+IP4_ADDR
+PickDest (
+  IN TEST_ROUTE             *Routes,
+  IN UINT32                 Count
+  )
+/*++
+
+Routine Description:
+
+  Pick a destination. Half are random, the others are in, or next to, the
+  network of one of the routes.
+
+--*/
+{
+  TEST_ROUTE                *Route;
+
+  if ((Random () % 2) == 0) {
+    return Random ();
+  }
+
+  Route = &Routes[Random () % Count];
+
+  if ((Random () % 4) == 0) {
+    return (Route->Dest | (Random () & ~Route->Netmask)) ^ (Route->Netmask & (0 - Route->Netmask));
+  }
+
+  return Route->Dest | (Random () & ~Route->Netmask);
+}
+
+static
+VOID
+CheckRoutes (
+  IN char                   *Test,
+  IN IP4_ROUTE_TABLE        *RtTable,
+  IN TEST_ROUTE             *Routes,
+  IN UINT32                 Count
+  )
+/*++
+
+Routine Description:
+
+  Check that Ip4Route and the area walk route destinations the same way.
+
+--*/
+{
+  IP4_ADDR                  Dest;
+  UINT32                    Index;
+  UINT32                    Found;
+
+  Found = 0;
+
+  for (Index = 0; Index < TEST_LOOKUPS; Index++) {
+    Dest = PickDest (Routes, Count);
+
+    if (ReferenceRoute (RtTable, Dest) != TEST_NO_ROUTE) {
+      Found++;
+    }
+
+    Check ((BOOLEAN) (TrieRoute (RtTable, Dest) == ReferenceRoute (RtTable, Dest)), Test, "same next hop as the area walk");
+  }
+
+  Check ((BOOLEAN) (Found != 0), Test, "some destinations have a route");
+}
+
+static
+VOID
+TestRoute (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Compare the lookups without a default route, with default routes in
+  both tables, and after deleting a half of the routes.
+
+--*/
+{
+  IP4_ROUTE_TABLE           *InstanceTable;
+  IP4_ROUTE_TABLE           *DefaultTable;
+  TEST_ROUTE                *Routes;
+  UINT32                    Index;
+  UINT32                    Count;
+
+  Routes        = malloc (sizeof (TEST_ROUTE) * TEST_ROUTES);
+  InstanceTable = Ip4CreateRouteTable ();
+  DefaultTable  = Ip4CreateRouteTable ();
+
+  if ((Routes == NULL) || (InstanceTable == NULL) || (DefaultTable == NULL)) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  InstanceTable->Next = DefaultTable;
+
+  //
+  // Keep the /0 routes out for the first pass.
+  //
+  MakeRoutes (Routes, TEST_ROUTES);
+
+  for (Index = 0, Count = 0; Index < TEST_ROUTES; Index++) {
+    if (Routes[Index].Netmask != 0) {
+      Routes[Count++] = Routes[Index];
+    }
+  }
+
+  AddRoutes (InstanceTable, DefaultTable, Routes, Count);
+  CheckRoutes ("no default route", InstanceTable, Routes, Count);
+
+  Ip4AddRoute (DefaultTable, 0, 0, 0x0A000001);
+  CheckRoutes ("default route", InstanceTable, Routes, Count);
+
+  Ip4AddRoute (InstanceTable, 0, 0, 0x0A000002);
+  CheckRoutes ("instance default route", InstanceTable, Routes, Count);
+
+  //
+  // Deleting a route has to unlink it from the trie, and has to leave the
+  // other routes of the same network in place.
+  //
+  for (Index = 0; Index < Count; Index += 2) {
+    Ip4DelRoute (
+      Routes[Index].Instance ? InstanceTable : DefaultTable,
+      Routes[Index].Dest,
+      Routes[Index].Netmask,
+      Routes[Index].Gateway
+      );
+  }
+
+  Ip4DelRoute (InstanceTable, 0, 0, 0x0A000002);
+  CheckRoutes ("after delete", InstanceTable, Routes, Count);
+
+  Ip4DelRoute (DefaultTable, 0, 0, 0x0A000001);
+  CheckRoutes ("after default delete", InstanceTable, Routes, Count);
+
+  Ip4FreeRouteTable (InstanceTable);
+  Ip4FreeRouteTable (DefaultTable);
+  free (Routes);
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+{
+  IP4_ROUTE_TABLE           *InstanceTable;
+  IP4_ROUTE_TABLE           *DefaultTable;
+  TEST_ROUTE                *Routes;
+  IP4_ADDR                  *Dests;
+  UINT32                    Count;
+  UINT32                    Index;
+  UINT32                    Lookups;
+  clock_t                   Start;
+  double                    Walk;
+  double                    Trie;
+  IP4_ADDR                  Sum;
+
+  Lookups = 100000;
+  Routes  = malloc (sizeof (TEST_ROUTE) * 16384);
+  Dests   = malloc (sizeof (IP4_ADDR) * Lookups);
+
+  if ((Routes == NULL) || (Dests == NULL)) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  printf ("Route lookup missing the route cache, ns per lookup. Ip4Route also\n");
+  printf ("creates and trims the route cache entry of each lookup.\n");
+  printf ("%-8s %12s %12s %8s\n", "Routes", "Area walk", "Ip4Route", "Speedup");
+
+  for (Count = 256; Count <= 16384; Count *= 4) {
+    InstanceTable = Ip4CreateRouteTable ();
+    DefaultTable  = Ip4CreateRouteTable ();
+
+    if ((InstanceTable == NULL) || (DefaultTable == NULL)) {
+      printf ("Out of memory\n");
+      exit (1);
+    }
+
+    InstanceTable->Next = DefaultTable;
+
+    MakeRoutes (Routes, Count);
+    AddRoutes (InstanceTable, DefaultTable, Routes, Count);
+    Ip4AddRoute (DefaultTable, 0, 0, 0x0A000001);
+
+    for (Index = 0; Index < Lookups; Index++) {
+      Dests[Index] = PickDest (Routes, Count);
+    }
+
+    Sum   = 0;
+    Start = clock ();
+
+    for (Index = 0; Index < Lookups; Index++) {
+      Sum += ReferenceRoute (InstanceTable, Dests[Index]);
+    }
+
+    Walk  = (double) (clock () - Start) * 1e9 / CLOCKS_PER_SEC / Lookups;
+    Start = clock ();
+
+    for (Index = 0; Index < Lookups; Index++) {
+      Sum -= TrieRoute (InstanceTable, Dests[Index]);
+    }
+
+    Trie = (double) (clock () - Start) * 1e9 / CLOCKS_PER_SEC / Lookups;
+
+    if (Sum != 0) {
+      printf ("Benchmark lookups disagree\n");
+    }
+
+    printf ("%-8u %12.1f %12.1f %7.1fx\n", (unsigned) Count, Walk, Trie, Walk / Trie);
+
+    Ip4FreeRouteTable (InstanceTable);
+    Ip4FreeRouteTable (DefaultTable);
+  }
+
+  free (Routes);
+  free (Dests);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, or the benchmark when called with -b.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  NetHostLibInit ();
+
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  TestRoute ();
+
+  if (mFailures != 0) {
+    printf ("Ip4RouteTest: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("Ip4RouteTest: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  NetHostLib.c
+
+Abstract:
+
+  Host environment for the network driver unit tests. Only the memory,
+  TPL and event services are implemented; the test must not reach the
+  other boot services, which are left NULL.
+
+--*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "NetHostLib.h"
+
+static EFI_BOOT_SERVICES  mHostBootServices;
+
+EFI_BOOT_SERVICES         *gBS = &mHostBootServices;
+EFI_RUNTIME_SERVICES      *gRT = NULL;
+
+static
+EFI_STATUS
+EFIAPI
+HostAllocatePool (
+  IN EFI_MEMORY_TYPE        PoolType,
+  IN UINTN                  Size,
+  OUT VOID                  **Buffer
+  )
+{
+  *Buffer = malloc (Size == 0 ? 1 : Size);
+  return (*Buffer == NULL) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+HostFreePool (
+  IN VOID                   *Buffer
+  )
+{
+  free (Buffer);
+  return EFI_SUCCESS;
+}
+
+static
+VOID
+EFIAPI
+HostCopyMem (
+  IN VOID                   *Destination,
+  IN VOID                   *Source,
+  IN UINTN                  Length
+  )
+{
+  memmove (Destination, Source, Length);
+}
+
+static
+VOID
+EFIAPI
+HostSetMem (
+  IN VOID                   *Buffer,
+  IN UINTN                  Size,
+  IN UINT8                  Value
+  )
+{
+  memset (Buffer, Value, Size);
+}
+
+static
+EFI_TPL
+EFIAPI
+HostRaiseTpl (
+  IN EFI_TPL                NewTpl
+  )
+{
+  return EFI_TPL_APPLICATION;
+}
+
+static
+VOID
+EFIAPI
+HostRestoreTpl (
+  IN EFI_TPL                OldTpl
+  )
+{
+}
+
+static
+EFI_STATUS
+EFIAPI
+HostSignalEvent (
+  IN EFI_EVENT              Event
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EfiLibInstallAllDriverProtocols2 (
+  IN EFI_HANDLE                         ImageHandle,
+  IN EFI_SYSTEM_TABLE                   *SystemTable,
+  IN EFI_DRIVER_BINDING_PROTOCOL        *DriverBinding,
+  IN EFI_HANDLE                         DriverBindingHandle,
+  IN EFI_COMPONENT_NAME2_PROTOCOL       *ComponentName2,
+  IN EFI_DRIVER_CONFIGURATION2_PROTOCOL *DriverConfiguration2,
+  IN EFI_DRIVER_DIAGNOSTICS2_PROTOCOL   *DriverDiagnostics2
+  )
+/*++
+
+Routine Description:
+
+  Referenced by NetLib's driver entry helpers, which the tests never call.
+
+--*/
+{
+  return EFI_UNSUPPORTED;
+}
+
+VOID
+NetHostLibInit (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Fill in the host boot services. Call it before any driver code runs.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  mHostBootServices.AllocatePool = HostAllocatePool;
+  mHostBootServices.FreePool     = HostFreePool;
+  mHostBootServices.CopyMem      = HostCopyMem;
+  mHostBootServices.SetMem       = HostSetMem;
+  mHostBootServices.RaiseTPL     = HostRaiseTpl;
+  mHostBootServices.RestoreTPL   = HostRestoreTpl;
+  mHostBootServices.SignalEvent  = HostSignalEvent;
+}
@@ -0,0 +1,34 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  NetHostLib.h
+
+Abstract:
+
+  Host environment for the network driver unit tests. It provides gBS
+  with the boot services NetLib and the drivers' data path use, backed
+  by the C library, so that driver sources link into a host program.
+
+--*/
+
+#ifndef _NET_HOST_LIB_H_
+#define _NET_HOST_LIB_H_
+
+#include "NetLib.h"
+
+VOID
+NetHostLibInit (
+  VOID
+  );
+
+#endif
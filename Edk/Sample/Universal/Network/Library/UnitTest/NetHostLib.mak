@@ -0,0 +1,93 @@
+#/*++
+#
+#  Copyright (c) 2007, Intel Corporation
+#  All rights reserved. This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+#  Module Name:  NetHostLib.mak
+#
+#  Abstract:
+#
+#    Included by the makefiles of the network driver unit tests after they
+#    set TARGET_OUTPUT_DIR. It builds NetLib, NetBuffer, the host boot
+#    services and the library code they depend on into NET_HOST_OBJECTS.
+#
+#--*/
+
+NET_LIBRARY_DIR    = $(EDK_SOURCE)\Sample\Universal\Network\Library
+COMMON_LIBRARY_DIR = $(EDK_SOURCE)\Foundation\Library\EfiCommonLib
+
+INC=$(INC) \
+    -I "$(EDK_SOURCE)\Foundation\Library\Dxe\Include" \
+    -I "$(NET_LIBRARY_DIR)" \
+    -I "$(NET_LIBRARY_DIR)\UnitTest"
+
+NET_HOST_OBJECTS = $(TARGET_OUTPUT_DIR)\NetHostLib.obj             \
+                   $(TARGET_OUTPUT_DIR)\Netbuffer.obj              \
+                   $(TARGET_OUTPUT_DIR)\NetLib.obj                 \
+                   $(TARGET_OUTPUT_DIR)\EfiLibAllocate.obj         \
+                   $(TARGET_OUTPUT_DIR)\String.obj                 \
+                   $(TARGET_OUTPUT_DIR)\LinkedList.obj             \
+                   $(TARGET_OUTPUT_DIR)\Math.obj                   \
+                   $(TARGET_OUTPUT_DIR)\EfiCompareMem.obj          \
+                   $(TARGET_OUTPUT_DIR)\ComponentName2.obj         \
+                   $(TARGET_OUTPUT_DIR)\DriverBinding.obj          \
+                   $(TARGET_OUTPUT_DIR)\DriverConfiguration2.obj   \
+                   $(TARGET_OUTPUT_DIR)\DriverDiagnostics2.obj     \
+                   $(TARGET_OUTPUT_DIR)\LoadedImage.obj            \
+                   $(TARGET_OUTPUT_DIR)\SimpleNetwork.obj          \
+                   $(TARGET_OUTPUT_DIR)\Dpc.obj                    \
+                   $(TARGET_OUTPUT_DIR)\NicIp4Config.obj
+
+$(TARGET_OUTPUT_DIR)\NetHostLib.obj: $(NET_LIBRARY_DIR)\UnitTest\NetHostLib.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(NET_LIBRARY_DIR)\UnitTest\NetHostLib.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\Netbuffer.obj: $(NET_LIBRARY_DIR)\Netbuffer.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(NET_LIBRARY_DIR)\Netbuffer.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\NetLib.obj: $(NET_LIBRARY_DIR)\NetLib.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(NET_LIBRARY_DIR)\NetLib.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\EfiLibAllocate.obj: $(EDK_SOURCE)\Foundation\Library\Dxe\EfiDriverLib\EfiLibAllocate.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Library\Dxe\EfiDriverLib\EfiLibAllocate.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\String.obj: $(COMMON_LIBRARY_DIR)\String.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(COMMON_LIBRARY_DIR)\String.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\LinkedList.obj: $(COMMON_LIBRARY_DIR)\LinkedList.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(COMMON_LIBRARY_DIR)\LinkedList.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\Math.obj: $(COMMON_LIBRARY_DIR)\Math.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(COMMON_LIBRARY_DIR)\Math.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\EfiCompareMem.obj: $(COMMON_LIBRARY_DIR)\EfiCompareMem.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(COMMON_LIBRARY_DIR)\EfiCompareMem.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\ComponentName2.obj: $(EDK_SOURCE)\Foundation\Efi\Protocol\ComponentName2\ComponentName2.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Efi\Protocol\ComponentName2\ComponentName2.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\DriverBinding.obj: $(EDK_SOURCE)\Foundation\Efi\Protocol\DriverBinding\DriverBinding.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Efi\Protocol\DriverBinding\DriverBinding.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\DriverConfiguration2.obj: $(EDK_SOURCE)\Foundation\Efi\Protocol\DriverConfiguration2\DriverConfiguration2.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Efi\Protocol\DriverConfiguration2\DriverConfiguration2.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\DriverDiagnostics2.obj: $(EDK_SOURCE)\Foundation\Efi\Protocol\DriverDiagnostics2\DriverDiagnostics2.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Efi\Protocol\DriverDiagnostics2\DriverDiagnostics2.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\LoadedImage.obj: $(EDK_SOURCE)\Foundation\Efi\Protocol\LoadedImage\LoadedImage.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Efi\Protocol\LoadedImage\LoadedImage.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\SimpleNetwork.obj: $(EDK_SOURCE)\Foundation\Efi\Protocol\SimpleNetwork\SimpleNetwork.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Efi\Protocol\SimpleNetwork\SimpleNetwork.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\Dpc.obj: $(EDK_SOURCE)\Foundation\Protocol\Dpc\Dpc.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Protocol\Dpc\Dpc.c /Fo$@
+
+$(TARGET_OUTPUT_DIR)\NicIp4Config.obj: $(EDK_SOURCE)\Foundation\Protocol\NicIp4Config\NicIp4Config.c $(TARGET_OUTPUT_DIR)
+  $(CC) $(C_FLAGS) $(INC) $(EDK_SOURCE)\Foundation\Protocol\NicIp4Config\NicIp4Config.c /Fo$@
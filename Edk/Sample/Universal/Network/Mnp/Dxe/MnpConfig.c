@@ -26,6 +26,12 @@ EFI_SERVICE_BINDING_PROTOCOL    mMnpServiceBindingProtocol = {
   MnpServiceBindingDestroyChild
 };
 
+EFI_MNP_POLL_DEBUG_PROTOCOL     mMnpPollDebugProtocol = {
+  MnpPollDebugGetStatistics,
+  MnpPollDebugResetStatistics,
+  MnpPollDebugSetParameters
+};
+
 EFI_MANAGED_NETWORK_PROTOCOL    mMnpProtocolTemplate = {
   MnpGetModeData,
   MnpConfigure,
@@ -324,6 +330,14 @@ Returns:
   //
   MnpServiceData->ServiceBinding = mMnpServiceBindingProtocol;
 
+  //
+  // Initialize the adaptive system poll.
+  //
+  MnpServiceData->PollDebug                   = mMnpPollDebugProtocol;
+  MnpServiceData->PollParameters.MinInterval  = MNP_SYS_POLL_MIN_INTERVAL;
+  MnpServiceData->PollParameters.MaxInterval  = MNP_SYS_POLL_MAX_INTERVAL;
+  MnpServiceData->PollParameters.PollBudget   = MNP_SYS_POLL_BUDGET;
+
   //
   // Open the Simple Network protocol.
   //
@@ -583,6 +597,7 @@ Returns:
   NetListInit (&Instance->GroupCtrlBlkList);
   NetListInit (&Instance->RcvdPacketQueue);
   NetListInit (&Instance->RxDeliveredPacketQueue);
+  NetListInit (&Instance->RxDataWrapPool);
 
   //
   // Initialize the RxToken Map.
@@ -853,11 +868,18 @@ Returns:
   if (MnpServiceData->EnableSystemPoll ^ EnableSystemPoll) {
     //
     // The EnableSystemPoll differs with the current state, disable or enable
-    // the system poll.
+    // the system poll. The poll timer is a one-shot timer re-armed by
+    // MnpSystemPoll with an interval adapted to the traffic, start with the
+    // shortest one.
     //
-    TimerOpType = EnableSystemPoll ? TimerPeriodic : TimerCancel;
-
-    Status      = gBS->SetTimer (MnpServiceData->PollTimer, TimerOpType, MNP_SYS_POLL_INTERVAL);
+    TimerOpType = EnableSystemPoll ? TimerRelative : TimerCancel;
+
+    MnpServiceData->PollStatistics.CurrentInterval = MnpServiceData->PollParameters.MinInterval;
+    Status = gBS->SetTimer (
+                    MnpServiceData->PollTimer,
+                    TimerOpType,
+                    MnpServiceData->PollStatistics.CurrentInterval
+                    );
     if (EFI_ERROR (Status)) {
 
       MNP_DEBUG_ERROR (("MnpStart: gBS->SetTimer for PollTimer failed, %r.\n", Status));
@@ -992,6 +1014,47 @@ Returns:
   NET_RESTORE_TPL (OldTpl);
 }
 
+VOID
+MnpFlushRxDataWrapPool (
+  IN MNP_INSTANCE_DATA  *Instance
+  )
+/*++
+
+Routine Description:
+
+  Free the recycled MNP_RXDATA_WRAPs cached by the instance.
+
+Arguments:
+
+  Instance - Pointer to the mnp instance context data.
+
+Returns:
+
+  None.
+
+--*/
+{
+  EFI_TPL          OldTpl;
+  MNP_RXDATA_WRAP *RxDataWrap;
+
+  NET_CHECK_SIGNATURE (Instance, MNP_INSTANCE_DATA_SIGNATURE);
+
+  OldTpl = NET_RAISE_TPL (NET_TPL_RECYCLE);
+
+  while (!NetListIsEmpty (&Instance->RxDataWrapPool)) {
+
+    RxDataWrap = NET_LIST_HEAD (&Instance->RxDataWrapPool, MNP_RXDATA_WRAP, WrapEntry);
+    NetListRemoveEntry (&RxDataWrap->WrapEntry);
+
+    gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+    NetFreePool (RxDataWrap);
+  }
+
+  Instance->RxDataWrapPoolSize = 0;
+
+  NET_RESTORE_TPL (OldTpl);
+}
+
 EFI_STATUS
 MnpConfigureInstance (
   IN MNP_INSTANCE_DATA                *Instance,
@@ -151,6 +151,8 @@ Returns:
                   &ControllerHandle,
                   &gEfiManagedNetworkServiceBindingProtocolGuid,
                   &MnpServiceData->ServiceBinding,
+                  &gEfiMnpPollDebugProtocolGuid,
+                  &MnpServiceData->PollDebug,
                   NULL
                   );
 
@@ -245,6 +247,8 @@ Returns:
            ControllerHandle,
            &gEfiManagedNetworkServiceBindingProtocolGuid,
            ServiceBinding,
+           &gEfiMnpPollDebugProtocolGuid,
+           &MnpServiceData->PollDebug,
            NULL
            );
 
@@ -514,6 +518,11 @@ Returns:
   //
   MnpFlushRcvdDataQueue (Instance);
 
+  //
+  // Free the cached RxDataWraps.
+  //
+  MnpFlushRxDataWrapPool (Instance);
+
   //
   // Clean the RxTokenMap.
   //
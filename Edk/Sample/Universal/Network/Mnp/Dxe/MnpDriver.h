@@ -36,6 +36,7 @@ Abstract:
 #include EFI_PROTOCOL_PRODUCER (ComponentName)
 #include EFI_PROTOCOL_PRODUCER (ComponentName2)
 #include EFI_PROTOCOL_PRODUCER (ManagedNetwork)
+#include EFI_PROTOCOL_PRODUCER (MnpPollDebug)
 
 //
 // Required Global Variables
@@ -74,6 +75,13 @@ typedef struct _MNP_SERVICE_DATA {
   EFI_EVENT                     PollTimer;
   BOOLEAN                       EnableSystemPoll;
 
+  //
+  // Adaptive system poll state, exported through PollDebug.
+  //
+  EFI_MNP_POLL_DEBUG_PROTOCOL   PollDebug;
+  EFI_MNP_POLL_PARAMETERS       PollParameters;
+  EFI_MNP_POLL_STATISTICS       PollStatistics;
+
   EFI_EVENT                     TimeoutCheckTimer;
 
   UINT32                        UnicastCount;
@@ -99,6 +107,14 @@ typedef struct _MNP_SERVICE_DATA {
   MNP_SERVICE_DATA_SIGNATURE \
   )
 
+#define MNP_SERVICE_DATA_FROM_POLL_DEBUG(a) \
+  CR ( \
+  (a), \
+  MNP_SERVICE_DATA, \
+  PollDebug, \
+  MNP_SERVICE_DATA_SIGNATURE \
+  )
+
 EFI_STATUS
 EFIAPI
 MnpDriverBindingSupported (
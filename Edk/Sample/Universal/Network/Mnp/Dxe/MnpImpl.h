@@ -26,7 +26,14 @@ Abstract:
 
 #define NET_ETHER_FCS_SIZE            4
 
-#define MNP_SYS_POLL_INTERVAL         (50 * TICKS_PER_MS)   // 50 milliseconds
+//
+// The system poll interval adapts to the traffic: it drops to the minimum
+// after a poll that received frames and doubles after every idle poll, up to
+// the maximum. Each poll drains at most MNP_SYS_POLL_BUDGET frames.
+//
+#define MNP_SYS_POLL_MIN_INTERVAL     (1 * TICKS_PER_MS)    // 1 millisecond
+#define MNP_SYS_POLL_MAX_INTERVAL     (100 * TICKS_PER_MS)  // 100 milliseconds
+#define MNP_SYS_POLL_BUDGET           32
 #define MNP_TIMEOUT_CHECK_INTERVAL    (50 * TICKS_PER_MS)   // 50 milliseconds
 #define MNP_TX_TIMEOUT_TIME           (500 * TICKS_PER_MS)  // 500 milliseconds
 #define MNP_INIT_NET_BUFFER_NUM       512
@@ -35,6 +42,11 @@ Abstract:
 
 #define MNP_MAX_RCVD_PACKET_QUE_SIZE  256
 
+//
+// Maximum number of recycled MNP_RXDATA_WRAPs kept by an instance for reuse.
+//
+#define MNP_MAX_RXDATA_WRAP_POOL_SIZE 64
+
 #define MNP_RECEIVE_UNICAST           0x01
 #define MNP_RECEIVE_BROADCAST         0x02
 
@@ -73,6 +85,13 @@ typedef struct _MNP_INSTANCE_DATA {
   NET_LIST_ENTRY                  RcvdPacketQueue;
   UINTN                           RcvdPacketQueueSize;
 
+  //
+  // Recycled MNP_RXDATA_WRAPs. They keep their RecycleEvent so that the
+  // next received packets need neither a pool allocation nor a new event.
+  //
+  NET_LIST_ENTRY                  RxDataWrapPool;
+  UINTN                           RxDataWrapPoolSize;
+
   EFI_MANAGED_NETWORK_CONFIG_DATA ConfigData;
 
   UINT8                           ReceiveFilter;
@@ -134,6 +153,11 @@ MnpFlushRcvdDataQueue (
   IN MNP_INSTANCE_DATA  *Instance
   );
 
+VOID
+MnpFlushRxDataWrapPool (
+  IN MNP_INSTANCE_DATA  *Instance
+  );
+
 EFI_STATUS
 MnpConfigureInstance (
   IN MNP_INSTANCE_DATA                *Instance,
@@ -212,6 +236,27 @@ MnpSystemPoll (
   IN VOID       *Context
   );
 
+EFI_STATUS
+EFIAPI
+MnpPollDebugGetStatistics (
+  IN  EFI_MNP_POLL_DEBUG_PROTOCOL  *This,
+  OUT EFI_MNP_POLL_STATISTICS      *Statistics,
+  OUT EFI_MNP_POLL_PARAMETERS      *Parameters OPTIONAL
+  );
+
+EFI_STATUS
+EFIAPI
+MnpPollDebugResetStatistics (
+  IN EFI_MNP_POLL_DEBUG_PROTOCOL  *This
+  );
+
+EFI_STATUS
+EFIAPI
+MnpPollDebugSetParameters (
+  IN EFI_MNP_POLL_DEBUG_PROTOCOL  *This,
+  IN EFI_MNP_POLL_PARAMETERS      *Parameters
+  );
+
 EFI_STATUS
 EFIAPI
 MnpGetModeData (
@@ -478,6 +478,8 @@ Returns:
 {
   MNP_RXDATA_WRAP   *RxDataWrap;
   MNP_SERVICE_DATA  *MnpServiceData;
+  MNP_INSTANCE_DATA *Instance;
+  EFI_TPL           OldTpl;
 
   ASSERT (Context != NULL);
 
@@ -496,14 +498,27 @@ Returns:
   RxDataWrap->Nbuf = NULL;
 
   //
-  // Close the recycle event.
+  // Remove this Wrap entry from the list.
   //
-  gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+  NetListRemoveEntry (&RxDataWrap->WrapEntry);
+
+  Instance = RxDataWrap->Instance;
+  if (!Instance->Destroyed && (Instance->RxDataWrapPoolSize < MNP_MAX_RXDATA_WRAP_POOL_SIZE)) {
+    //
+    // Keep the Wrap and its recycle event for the next received packet.
+    //
+    OldTpl = NET_RAISE_TPL (NET_TPL_RECYCLE);
+    NetListInsertHead (&Instance->RxDataWrapPool, &RxDataWrap->WrapEntry);
+    Instance->RxDataWrapPoolSize++;
+    NET_RESTORE_TPL (OldTpl);
+
+    return ;
+  }
 
   //
-  // Remove this Wrap entry from the list.
+  // Close the recycle event.
   //
-  NetListRemoveEntry (&RxDataWrap->WrapEntry);
+  gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
 
   NetFreePool (RxDataWrap);
 }
@@ -790,6 +805,31 @@ Returns:
 {
   EFI_STATUS      Status;
   MNP_RXDATA_WRAP *RxDataWrap;
+  EFI_EVENT       RecycleEvent;
+  EFI_TPL         OldTpl;
+
+  //
+  // Reuse a recycled Wrap if there is one, its recycle event is still valid.
+  // The pool is refilled by MnpRecycleRxData at NET_TPL_RECYCLE.
+  //
+  RxDataWrap = NULL;
+  OldTpl     = NET_RAISE_TPL (NET_TPL_RECYCLE);
+
+  if (!NetListIsEmpty (&Instance->RxDataWrapPool)) {
+    RxDataWrap = NET_LIST_HEAD (&Instance->RxDataWrapPool, MNP_RXDATA_WRAP, WrapEntry);
+    NetListRemoveEntry (&RxDataWrap->WrapEntry);
+    Instance->RxDataWrapPoolSize--;
+  }
+
+  NET_RESTORE_TPL (OldTpl);
+
+  if (RxDataWrap != NULL) {
+    RecycleEvent                    = RxDataWrap->RxData.RecycleEvent;
+    RxDataWrap->RxData              = *RxData;
+    RxDataWrap->RxData.RecycleEvent = RecycleEvent;
+
+    return RxDataWrap;
+  }
 
   //
   // Allocate memory.
@@ -927,7 +967,7 @@ Returns:
 
  EFI_SUCCESS      - add return value to function comment
  EFI_NOT_STARTED  - The simple network protocol is not started.
- EFI_NOT_READY    - No packet received.
+ EFI_NOT_READY    - No packet received, or there is no child to receive it.
  EFI_DEVICE_ERROR - An unexpected error occurs.
 
 --*/
@@ -952,9 +992,10 @@ Returns:
 
   if (NetListIsEmpty (&MnpServiceData->ChildrenList)) {
     //
-    // There is no child, no need to receive packets.
+    // There is no child, no need to receive packets. Report it as no
+    // packet received so that the system poll backs off.
     //
-    return EFI_SUCCESS;
+    return EFI_NOT_READY;
   }
 
   if (MnpServiceData->RxNbufCache == NULL) {
@@ -1160,15 +1201,62 @@ Returns:
 
 --*/
 {
-  MNP_SERVICE_DATA  *MnpServiceData;
+  MNP_SERVICE_DATA        *MnpServiceData;
+  EFI_MNP_POLL_PARAMETERS *Parameters;
+  EFI_MNP_POLL_STATISTICS *Statistics;
+  UINT32                  Received;
 
   MnpServiceData = (MNP_SERVICE_DATA *) Context;
   NET_CHECK_SIGNATURE (MnpServiceData, MNP_SERVICE_DATA_SIGNATURE);
 
+  Parameters = &MnpServiceData->PollParameters;
+  Statistics = &MnpServiceData->PollStatistics;
+
   //
-  // Try to receive packets from Snp.
+  // Drain up to PollBudget packets from Snp so that the NIC receive ring
+  // doesn't overflow between two polls under bulk receive.
   //
-  MnpReceivePacket (MnpServiceData);
+  for (Received = 0; Received < Parameters->PollBudget; Received++) {
+    if (MnpReceivePacket (MnpServiceData) != EFI_SUCCESS) {
+      break;
+    }
+  }
 
   NetLibDispatchDpc ();
+
+  Statistics->PollCount++;
+  Statistics->PacketCount += Received;
+  if (Received > Statistics->MaxPacketsPerPoll) {
+    Statistics->MaxPacketsPerPoll = Received;
+  }
+
+  if (Received == 0) {
+    //
+    // Idle, back off exponentially.
+    //
+    Statistics->IdlePollCount++;
+    Statistics->CurrentInterval = LShiftU64 (Statistics->CurrentInterval, 1);
+    if (Statistics->CurrentInterval < Parameters->MinInterval) {
+      Statistics->CurrentInterval = Parameters->MinInterval;
+    } else if (Statistics->CurrentInterval > Parameters->MaxInterval) {
+      Statistics->CurrentInterval = Parameters->MaxInterval;
+    }
+  } else {
+    //
+    // Traffic is flowing, poll again soon.
+    //
+    if (Received == Parameters->PollBudget) {
+      Statistics->BudgetExhaustedCount++;
+    }
+
+    Statistics->CurrentInterval = Parameters->MinInterval;
+  }
+
+  if (MnpServiceData->EnableSystemPoll) {
+    //
+    // Re-arm the one-shot poll timer, unless MnpStop has just cancelled it
+    // from the receive path.
+    //
+    gBS->SetTimer (MnpServiceData->PollTimer, TimerRelative, Statistics->CurrentInterval);
+  }
 }
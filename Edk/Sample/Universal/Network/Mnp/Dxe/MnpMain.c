@@ -688,3 +688,141 @@ ON_EXIT:
   return Status;
 }
 
+
+EFI_STATUS
+EFIAPI
+MnpPollDebugGetStatistics (
+  IN  EFI_MNP_POLL_DEBUG_PROTOCOL  *This,
+  OUT EFI_MNP_POLL_STATISTICS      *Statistics,
+  OUT EFI_MNP_POLL_PARAMETERS      *Parameters OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Get the statistics and the parameters of the adaptive system poll.
+
+Arguments:
+
+  This       - Pointer to the MNP poll debug protocol.
+  Statistics - Pointer to storage for the poll statistics.
+  Parameters - Pointer to storage for the current poll parameters.
+
+Returns:
+
+  EFI_SUCCESS           - The statistics are returned.
+  EFI_INVALID_PARAMETER - This or Statistics is NULL.
+
+--*/
+{
+  MNP_SERVICE_DATA  *MnpServiceData;
+  EFI_TPL           OldTpl;
+
+  if ((This == NULL) || (Statistics == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  MnpServiceData = MNP_SERVICE_DATA_FROM_POLL_DEBUG (This);
+
+  OldTpl = NET_RAISE_TPL (NET_TPL_LOCK);
+
+  *Statistics = MnpServiceData->PollStatistics;
+  if (Parameters != NULL) {
+    *Parameters = MnpServiceData->PollParameters;
+  }
+
+  NET_RESTORE_TPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+MnpPollDebugResetStatistics (
+  IN EFI_MNP_POLL_DEBUG_PROTOCOL  *This
+  )
+/*++
+
+Routine Description:
+
+  Clear the counters of the adaptive system poll.
+
+Arguments:
+
+  This - Pointer to the MNP poll debug protocol.
+
+Returns:
+
+  EFI_SUCCESS           - The counters are cleared.
+  EFI_INVALID_PARAMETER - This is NULL.
+
+--*/
+{
+  MNP_SERVICE_DATA        *MnpServiceData;
+  EFI_MNP_POLL_STATISTICS *Statistics;
+  EFI_TPL                 OldTpl;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  MnpServiceData = MNP_SERVICE_DATA_FROM_POLL_DEBUG (This);
+  Statistics     = &MnpServiceData->PollStatistics;
+
+  OldTpl = NET_RAISE_TPL (NET_TPL_LOCK);
+
+  Statistics->PollCount            = 0;
+  Statistics->IdlePollCount        = 0;
+  Statistics->PacketCount          = 0;
+  Statistics->BudgetExhaustedCount = 0;
+  Statistics->MaxPacketsPerPoll    = 0;
+
+  NET_RESTORE_TPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+MnpPollDebugSetParameters (
+  IN EFI_MNP_POLL_DEBUG_PROTOCOL  *This,
+  IN EFI_MNP_POLL_PARAMETERS      *Parameters
+  )
+/*++
+
+Routine Description:
+
+  Tune the adaptive system poll. The new parameters take effect from the
+  next poll.
+
+Arguments:
+
+  This       - Pointer to the MNP poll debug protocol.
+  Parameters - Pointer to the new poll parameters.
+
+Returns:
+
+  EFI_SUCCESS           - The parameters are updated.
+  EFI_INVALID_PARAMETER - This or Parameters is NULL, the intervals are zero
+                          or out of order, or the PollBudget is zero.
+
+--*/
+{
+  MNP_SERVICE_DATA  *MnpServiceData;
+  EFI_TPL           OldTpl;
+
+  if ((This == NULL) || (Parameters == NULL) || (Parameters->MinInterval == 0) ||
+      (Parameters->MaxInterval < Parameters->MinInterval) || (Parameters->PollBudget == 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  MnpServiceData = MNP_SERVICE_DATA_FROM_POLL_DEBUG (This);
+
+  OldTpl = NET_RAISE_TPL (NET_TPL_LOCK);
+
+  MnpServiceData->PollParameters = *Parameters;
+
+  NET_RESTORE_TPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
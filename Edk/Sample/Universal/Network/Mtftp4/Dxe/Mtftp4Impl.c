@@ -139,9 +139,15 @@ Returns:
   NetZeroMem (&Instance->RequestOption, sizeof (MTFTP4_OPTION));
 
   Instance->Operation     = 0;
+  Instance->ImplicitCount = 0;
+  Instance->ImplicitExist = 0;
 
   Instance->BlkSize       = MTFTP4_DEFAULT_BLKSIZE;
   Instance->LastBlock     = 0;
+  Instance->WindowSize    = MTFTP4_DEFAULT_WINDOWSIZE;
+  Instance->WindowReceived = 0;
+  Instance->LastAckedBlock = 0;
+  Instance->GapAcked      = FALSE;
   Instance->ServerIp      = 0;
   Instance->ListeningPort = 0;
   Instance->ConnectedPort = 0;
@@ -745,6 +751,16 @@ Returns:
     if (EFI_ERROR (Status)) {
       goto ON_ERROR;
     }
+
+    //
+    // The upload is still stop-and-wait, so don't let the user
+    // negotiate a window the WRQ side can't honor.
+    //
+    if ((Operation == EFI_MTFTP4_OPCODE_WRQ) &&
+        (Instance->RequestOption.Exist & MTFTP4_WINDOWSIZE_EXIST)) {
+      Status = EFI_UNSUPPORTED;
+      goto ON_ERROR;
+    }
   }
   
   //
@@ -753,6 +769,7 @@ Returns:
   Config                  = &Instance->Config;
   Instance->Token         = Token;
   Instance->BlkSize       = MTFTP4_DEFAULT_BLKSIZE;
+  Instance->WindowSize    = MTFTP4_DEFAULT_WINDOWSIZE;
 
   NetCopyMem (&Instance->ServerIp, &Config->ServerIp, sizeof (IP4_ADDR));
   Instance->ServerIp      = NTOHL (Instance->ServerIp);
@@ -21,6 +21,7 @@ Abstract:
    RFC2347 - TFTP Option Extension
    RFC2348 - TFTP Blocksize Option
    RFC2349 - TFTP Timeout Interval and Transfer Size Options
+   RFC7440 - TFTP Windowsize Option
 
 --*/
 
@@ -44,6 +45,11 @@ enum {
   MTFTP4_DEFAULT_TIMEOUT     = 3,
   MTFTP4_DEFAULT_RETRY       = 5,
   MTFTP4_DEFAULT_BLKSIZE     = 512,
+  MTFTP4_DEFAULT_WINDOWSIZE  = 1,
+  MTFTP4_IMPLICIT_WINDOWSIZE = 8,
+  MTFTP4_MAX_BLKSIZE         = 65464,
+  MTFTP4_IMPLICIT_OPTIONS    = 2,
+  MTFTP4_OPTION_VALUE_LEN    = 12,
   MTFTP4_TIME_TO_GETMAP      = 5,
 
   MTFTP4_STATE_UNCONFIGED    = 0,
@@ -93,6 +99,16 @@ typedef struct _MTFTP4_PROTOCOL {
   MTFTP4_OPTION                 RequestOption;
   UINT16                        Operation;
 
+  //
+  // Options the driver appends to the user's RRQ, such as a blksize
+  // derived from the MTU. They are dropped again if the server rejects
+  // the option negotiation.
+  //
+  UINT32                        ImplicitCount;
+  UINT32                        ImplicitExist;
+  EFI_MTFTP4_OPTION             ImplicitOption[MTFTP4_IMPLICIT_OPTIONS];
+  UINT8                         ImplicitValue[MTFTP4_IMPLICIT_OPTIONS][MTFTP4_OPTION_VALUE_LEN];
+
   //
   // Blocks is a list of MTFTP4_BLOCK_RANGE which contains 
   // holes in the file
@@ -101,6 +117,17 @@ typedef struct _MTFTP4_PROTOCOL {
   UINT16                        LastBlock;
   NET_LIST_ENTRY                Blocks;
 
+  //
+  // RFC7440 window: the number of blocks the server sends before it
+  // waits for an ACK, the blocks received in order in the current
+  // window, the block number last acknowledged, and whether a gap in
+  // the current window has been reported to the server.
+  //
+  UINT16                        WindowSize;
+  UINT16                        WindowReceived;
+  UINT16                        LastAckedBlock;
+  BOOLEAN                       GapAcked;
+
   //
   // The server's communication end point: IP and two ports. one for
   // initial request, one for its selected port.
@@ -153,6 +180,12 @@ Mtftp4RrqStart (
   IN UINT16                     Operation
   );
 
+EFI_STATUS
+Mtftp4RrqSendAck (
+  IN MTFTP4_PROTOCOL            *Instance,
+  IN UINT16                     BlkNo
+  );
+
 #define MTFTP4_SERVICE_FROM_THIS(a)   \
   CR (a, MTFTP4_SERVICE, ServiceBinding, MTFTP4_SERVICE_SIGNATURE)
 
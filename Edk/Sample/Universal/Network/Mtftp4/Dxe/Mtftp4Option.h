@@ -23,7 +23,7 @@ Abstract:
 #define __EFI_MTFTP4_OPTION_H__
 
 enum {
-  MTFTP4_SUPPORTED_OPTIONS = 4,
+  MTFTP4_SUPPORTED_OPTIONS = 5,
   MTFTP4_OPCODE_LEN        = 2,
   MTFTP4_ERRCODE_LEN       = 2,
   MTFTP4_BLKNO_LEN         = 2,
@@ -33,6 +33,7 @@ enum {
   MTFTP4_TIMEOUT_EXIST     = 0x02,
   MTFTP4_TSIZE_EXIST       = 0x04,
   MTFTP4_MCAST_EXIST       = 0x08,
+  MTFTP4_WINDOWSIZE_EXIST  = 0x10,
 };
 
 typedef struct {
@@ -42,6 +43,7 @@ typedef struct {
   IP4_ADDR                  McastIp;
   UINT16                    McastPort;
   BOOLEAN                   Master;
+  UINT16                    WindowSize;
   UINT32                    Exist;
 } MTFTP4_OPTION;
 
@@ -29,6 +29,133 @@ Mtftp4RrqInput (
   IN VOID                   *Context
   );
 
+STATIC
+VOID
+Mtftp4RrqAddImplicitOption (
+  IN MTFTP4_PROTOCOL        *Instance,
+  IN UINT8                  *OptionStr,
+  IN UINT32                 Value,
+  IN UINT32                 Exist
+  )
+/*++
+
+Routine Description:
+
+  Append an option the driver negotiates on its own to the RRQ. The
+  value is formatted as a decimal string in the instance.
+
+Arguments:
+
+  Instance  - The Mtftp session
+  OptionStr - The name of the option
+  Value     - The value of the option
+  Exist     - The MTFTP4_XXX_EXIST flag of the option
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_MTFTP4_OPTION         *Option;
+  UINT8                     Digits[MTFTP4_OPTION_VALUE_LEN];
+  UINT8                     *Cur;
+  UINTN                     Index;
+
+  ASSERT (Instance->ImplicitCount < MTFTP4_IMPLICIT_OPTIONS);
+
+  Index = 0;
+
+  do {
+    Digits[Index++] = (UINT8) ('0' + Value % 10);
+    Value          /= 10;
+  } while (Value != 0);
+
+  Cur = Instance->ImplicitValue[Instance->ImplicitCount];
+
+  while (Index > 0) {
+    *(Cur++) = Digits[--Index];
+  }
+
+  *Cur = '\0';
+
+  Option            = &Instance->ImplicitOption[Instance->ImplicitCount];
+  Option->OptionStr = OptionStr;
+  Option->ValueStr  = Instance->ImplicitValue[Instance->ImplicitCount];
+
+  Instance->ImplicitCount++;
+  Instance->ImplicitExist         |= Exist;
+  Instance->RequestOption.Exist   |= Exist;
+}
+
+STATIC
+VOID
+Mtftp4RrqSetImplicitOptions (
+  IN MTFTP4_PROTOCOL        *Instance
+  )
+/*++
+
+Routine Description:
+
+  Ask for a bigger block size and a transfer window if the user hasn't 
+  specified them. The block size is the largest that fits in an unfragmented
+  datagram. A server that doesn't support the options just ignores them 
+  and the download falls back to 512 byte stop-and-wait.
+
+Arguments:
+
+  Instance  - The Mtftp session
+
+Returns:
+
+  None
+
+--*/
+{
+  MTFTP4_OPTION             *Request;
+  EFI_IP4_MODE_DATA         Ip4Mode;
+  EFI_UDP4_PROTOCOL         *Udp;
+  EFI_STATUS                Status;
+  UINT32                    BlkSize;
+
+  Request = &Instance->RequestOption;
+
+  //
+  // Leave multicast download alone, all the clients share the 
+  // parameters the master negotiated.
+  //
+  if (Request->Exist & MTFTP4_MCAST_EXIST) {
+    return ;
+  }
+
+  if (!(Request->Exist & MTFTP4_BLKSIZE_EXIST)) {
+    Udp    = Instance->UnicastPort->Udp;
+    Status = Udp->GetModeData (Udp, NULL, &Ip4Mode, NULL, NULL);
+
+    if (!EFI_ERROR (Status) && 
+        (Ip4Mode.MaxPacketSize > sizeof (EFI_UDP4_HEADER) + MTFTP4_DATA_HEAD_LEN)) {
+
+      BlkSize = Ip4Mode.MaxPacketSize - sizeof (EFI_UDP4_HEADER) - MTFTP4_DATA_HEAD_LEN;
+      BlkSize = NET_MIN (BlkSize, MTFTP4_MAX_BLKSIZE);
+
+      if (BlkSize > MTFTP4_DEFAULT_BLKSIZE) {
+        Request->BlkSize = (UINT16) BlkSize;
+        Mtftp4RrqAddImplicitOption (Instance, "blksize", BlkSize, MTFTP4_BLKSIZE_EXIST);
+      }
+    }
+  }
+
+  if (!(Request->Exist & MTFTP4_WINDOWSIZE_EXIST)) {
+    Request->WindowSize = MTFTP4_IMPLICIT_WINDOWSIZE;
+    Mtftp4RrqAddImplicitOption (
+      Instance,
+      "windowsize",
+      MTFTP4_IMPLICIT_WINDOWSIZE,
+      MTFTP4_WINDOWSIZE_EXIST
+      );
+  }
+}
+
 EFI_STATUS
 Mtftp4RrqStart (
   IN MTFTP4_PROTOCOL        *Instance,
@@ -69,6 +196,8 @@ Returns:
     return Status;
   }
 
+  Mtftp4RrqSetImplicitOptions (Instance);
+
   Status = Mtftp4SendRequest (Instance);
 
   if (EFI_ERROR (Status)) {
@@ -120,6 +249,13 @@ Returns:
   Ack->Ack.OpCode   = HTONS (EFI_MTFTP4_OPCODE_ACK);
   Ack->Ack.Block[0] = HTONS (BlkNo);
 
+  //
+  // The server starts a new window after each ACK it receives
+  //
+  Instance->LastAckedBlock = BlkNo;
+  Instance->WindowReceived = 0;
+  Instance->GapAcked       = FALSE;
+
   return Mtftp4SendPacket (Instance, Packet);
 }
 
@@ -242,7 +378,8 @@ Mtftp4RrqHandleData (
 Routine Description:
 
   Function to process the received data packets. It will save the block
-  then send back an ACK if it is active. 
+  then send back an ACK if it is active. If a window is negotiated, only
+  the last block of each window is acknowledged.
 
 Arguments:
 
@@ -276,7 +413,31 @@ Returns:
   // the block.
   //
   if (Instance->Master && (Expected != BlockNum)) {
-    Mtftp4Retransmit (Instance);
+    if (Instance->WindowSize <= 1) {
+      Mtftp4Retransmit (Instance);
+      return EFI_SUCCESS;
+    }
+
+    //
+    // The server keeps streaming the window after a block is lost. ACK
+    // the last in-order block once so it restarts the window from there, 
+    // and drop the rest of the stale window. Also ACK again when the
+    // server resends the block we acked, which means our ACK got lost.
+    //
+    if (BlockNum > Expected) {
+      if (Instance->GapAcked) {
+        return EFI_SUCCESS;
+      }
+
+      Status             = Mtftp4RrqSendAck (Instance, (UINT16) (Expected - 1));
+      Instance->GapAcked = TRUE;
+      return Status;
+    }
+
+    if (BlockNum == Instance->LastAckedBlock) {
+      return Mtftp4RrqSendAck (Instance, (UINT16) (Expected - 1));
+    }
+
     return EFI_SUCCESS;
   }
 
@@ -315,6 +476,17 @@ Returns:
       
     } else {
       BlockNum = (UINT16) (Expected - 1);
+
+      //
+      // Wait for the rest of the window. Every block received in order
+      // restarts the timer, it only expires when the window stalls.
+      //
+      Instance->WindowReceived++;
+
+      if (Instance->WindowReceived < Instance->WindowSize) {
+        Mtftp4SetTimeout (Instance);
+        return EFI_SUCCESS;
+      }
     }
     
     Mtftp4RrqSendAck (Instance, BlockNum);
@@ -339,6 +511,7 @@ Routine Description:
     2. The server can only use smaller blksize than that is requested
     3. The server can only use the same timeout as requested
     4. The server doesn't change its multicast channel.
+    5. The server can only use smaller windowsize than that is requested
     
 
 Arguments:
@@ -370,6 +543,10 @@ Returns:
     return FALSE;
   }
 
+  if ((Reply->Exist & MTFTP4_WINDOWSIZE_EXIST) && (Reply->WindowSize > Request->WindowSize)) {
+    return FALSE;
+  }
+
   //
   // The server can send ",,master" to client to change its master
   // setting. But if it use the specific multicast channel, it can't 
@@ -609,6 +786,10 @@ Returns:
     if (Reply.Timeout != 0) {
       Instance->Timeout = Reply.Timeout;
     }
+
+    if (Reply.WindowSize != 0) {
+      Instance->WindowSize = Reply.WindowSize;
+    }
   }
   
   //
@@ -618,6 +799,57 @@ Returns:
   return Mtftp4RrqSendAck (Instance, (UINT16) (Expected - 1));
 }
 
+STATIC
+EFI_STATUS
+Mtftp4RrqHandleError (
+  IN MTFTP4_PROTOCOL        *Instance,
+  IN EFI_MTFTP4_PACKET      *Packet,
+  IN UINT32                 Len
+  )
+/*++
+
+Routine Description:
+
+  Function to process the ERROR packet. If the server refuses the option
+  negotiation and some of the options are added by the driver, resend the
+  request with only the user's options. Otherwise the download fails.
+
+Arguments:
+
+  Instance  - The download MTFTP session
+  Packet    - The ERROR packet received
+  Len       - The packet length
+
+Returns:
+
+  EFI_SUCCESS    - The request without the implicit options is sent
+  EFI_TFTP_ERROR - The server ends the download
+
+--*/
+{
+  if ((Instance->ImplicitCount == 0) || 
+      (Len < MTFTP4_OPCODE_LEN + MTFTP4_ERRCODE_LEN) ||
+      (NTOHS (Packet->Error.ErrorCode) != EFI_MTFTP4_ERRORCODE_REQUEST_DENIED) ||
+      (Mtftp4GetNextBlockNum (&Instance->Blocks) != 1)) {
+    return EFI_TFTP_ERROR;
+  }
+
+  Instance->RequestOption.Exist &= ~Instance->ImplicitExist;
+  Instance->ImplicitCount        = 0;
+  Instance->ImplicitExist        = 0;
+
+  //
+  // The server will select a new port for the new request.
+  //
+  Instance->ConnectedPort        = 0;
+
+  if (EFI_ERROR (Mtftp4SendRequest (Instance))) {
+    return EFI_TFTP_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
 VOID
 Mtftp4RrqInput (
   IN NET_BUF                *UdpPacket,
@@ -761,7 +993,7 @@ Returns:
     break;
 
   case EFI_MTFTP4_OPCODE_ERROR:
-    Status = EFI_TFTP_ERROR;
+    Status = Mtftp4RrqHandleError (Instance, Packet, Len);
     break;
   }
 
@@ -283,7 +283,8 @@ Mtftp4SendRequest (
 
 Routine Description:
 
-  Build then transmit the request packet for the MTFTP session. 
+  Build then transmit the request packet for the MTFTP session. The
+  options appended by the driver itself follow the user's options.
 
 Arguments:
 
@@ -323,6 +324,11 @@ Returns:
     Len += (UINT32) (EfiAsciiStrLen (Options[Index].OptionStr) + 
                      EfiAsciiStrLen (Options[Index].ValueStr) + 2);
   }
+
+  for (Index = 0; Index < Instance->ImplicitCount; Index++) {
+    Len += (UINT32) (EfiAsciiStrLen (Instance->ImplicitOption[Index].OptionStr) + 
+                     EfiAsciiStrLen (Instance->ImplicitOption[Index].ValueStr) + 2);
+  }
   
   //
   // Allocate a packet then copy the data over
@@ -342,6 +348,11 @@ Returns:
     Cur = EfiAsciiStrCpy (Cur, Options[Index].ValueStr);
   }
 
+  for (Index = 0; Index < Instance->ImplicitCount; ++Index) {
+    Cur = EfiAsciiStrCpy (Cur, Instance->ImplicitOption[Index].OptionStr);
+    Cur = EfiAsciiStrCpy (Cur, Instance->ImplicitOption[Index].ValueStr);
+  }
+
   return Mtftp4SendPacket (Instance, Nbuf);
 }
 
@@ -647,6 +658,16 @@ Returns:
       continue;
     }
 
+    //
+    // A windowed download that stalls in the middle of a window acks the
+    // blocks it has received, so that the server restarts the window from
+    // the first missing block rather than resending the whole window.
+    //
+    if (Instance->WindowReceived != 0) {
+      Mtftp4RrqSendAck (Instance, (UINT16) (Mtftp4GetNextBlockNum (&Instance->Blocks) - 1));
+      continue;
+    }
+
     //
     // Retransmit the packet if haven't reach the maxmium retry count,
     // otherwise exit the transfer.
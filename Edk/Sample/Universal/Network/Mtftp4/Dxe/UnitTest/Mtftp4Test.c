@@ -0,0 +1,1267 @@
+/*++
+
+Copyright (c) 2007, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  Mtftp4Test.c
+
+Abstract:
+
+  Host test and benchmark for the MTFTP4 download path.
+
+  The driver's Mtftp4Rrq.c, Mtftp4Option.c and Mtftp4Support.c are linked
+  against a loopback UDP_IO that hands every datagram to a TFTP server
+  stand-in in this file, instead of the UDP4 driver. The server implements
+  RFC1350 with the blksize (RFC2348) and windowsize (RFC7440) options, and
+  can be told to ignore or refuse options, to cap the values it accepts
+  and to drop DATA or ACK packets.
+
+  The test downloads files through the server and checks the data, the
+  negotiated options and the number of ACKs. With -b the program compares
+  the packets, round trips and estimated transfer time of a stop-and-wait
+  512 byte download with those of the implicit blksize and windowsize.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Mtftp4Impl.h"
+#include "NetHostLib.h"
+
+#define TEST_CLIENT_IP          0xC0A80002
+#define TEST_SERVER_IP          0xC0A80001
+#define TEST_CLIENT_PORT        1024
+#define TEST_SERVER_PORT_BASE   2000
+#define TEST_MTU                1500
+#define TEST_IP_HEAD_LEN        20
+#define TEST_MAX_TICKS          1000
+
+//
+// How the server stand-in treats the options in a request
+//
+typedef enum {
+  ServerOptions,
+  ServerIgnoreOptions,
+  ServerDenyOptions
+} SERVER_MODE;
+
+typedef struct _TEST_DATAGRAM {
+  struct _TEST_DATAGRAM     *Next;
+  UINT16                    Port;
+  UINT32                    Len;
+  UINT8                     Data[1];
+} TEST_DATAGRAM;
+
+typedef struct {
+  //
+  // Configuration
+  //
+  SERVER_MODE               Mode;
+  UINT8                     *File;
+  UINT32                    FileSize;
+  UINT32                    MaxBlkSize;
+  UINT32                    MaxWindowSize;
+  UINT32                    DropDataEvery;
+  UINT32                    DropAckEvery;
+  UINT32                    OackBlkSize;
+  UINT32                    OackWindowSize;
+
+  //
+  // Session state
+  //
+  UINT16                    Port;
+  UINT32                    BlkSize;
+  UINT32                    WindowSize;
+  UINT32                    LastBlock;
+  BOOLEAN                   Done;
+
+  //
+  // What the last request asked for
+  //
+  UINT32                    RequestedBlkSize;
+  UINT32                    RequestedWindowSize;
+  UINT32                    RequestedOptions;
+
+  //
+  // Statistics
+  //
+  UINT32                    Requests;
+  UINT32                    DataSent;
+  UINT32                    DataDropped;
+  UINT32                    AcksReceived;
+  UINT32                    AcksDropped;
+  UINT32                    Errors;
+} TEST_SERVER;
+
+typedef struct {
+  TEST_SERVER               Server;
+  MTFTP4_SERVICE            Service;
+  MTFTP4_PROTOCOL           Instance;
+  EFI_MTFTP4_TOKEN          Token;
+  UDP_IO_PORT               UnicastPort;
+  UINT32                    Ticks;
+} TEST_SESSION;
+
+static UINTN              mFailures = 0;
+
+static EFI_UDP4_PROTOCOL  mHostUdp;
+
+static TEST_SERVER        *mServer      = NULL;
+static TEST_DATAGRAM      *mQueueHead   = NULL;
+static TEST_DATAGRAM      *mQueueTail   = NULL;
+static UDP_IO_CALLBACK    mRecvCallBack = NULL;
+static VOID               *mRecvContext = NULL;
+
+static
+VOID
+Check (
+  IN BOOLEAN  Condition,
+  IN char     *Test,
+  IN char     *What
+  )
+/*++
+
+Routine Description:
+
+  Report a failed check. Only the first few failures are printed.
+
+Arguments:
+
+  Condition - The result of the check
+  Test      - Name of the test
+  What      - The condition that was checked
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Condition) {
+    return ;
+  }
+
+  if (mFailures < 20) {
+    printf ("FAIL: %s: %s\n", Test, What);
+  }
+
+  mFailures++;
+}
+
+static
+EFI_STATUS
+EFIAPI
+HostUdpGetModeData (
+  IN  EFI_UDP4_PROTOCOL                 *This,
+  OUT EFI_UDP4_CONFIG_DATA              *Udp4ConfigData OPTIONAL,
+  OUT EFI_IP4_MODE_DATA                 *Ip4ModeData    OPTIONAL,
+  OUT EFI_MANAGED_NETWORK_CONFIG_DATA   *MnpConfigData  OPTIONAL,
+  OUT EFI_SIMPLE_NETWORK_MODE           *SnpModeData    OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Report an Ethernet sized IP4 MTU, the only mode data Mtftp4 asks for.
+
+--*/
+{
+  if (Ip4ModeData != NULL) {
+    memset (Ip4ModeData, 0, sizeof (EFI_IP4_MODE_DATA));
+    Ip4ModeData->MaxPacketSize = TEST_MTU - TEST_IP_HEAD_LEN;
+  }
+
+  return EFI_SUCCESS;
+}
+
+//
+// The server stand-in
+//
+static
+VOID
+ServerQueue (
+  IN TEST_SERVER            *Server,
+  IN UINT8                  *Data,
+  IN UINT32                 Len
+  )
+/*++
+
+Routine Description:
+
+  Queue a datagram from the server's session port to the client.
+
+Arguments:
+
+  Server  - The server
+  Data    - The datagram
+  Len     - The length of the datagram
+
+Returns:
+
+  None
+
+--*/
+{
+  TEST_DATAGRAM             *Datagram;
+
+  Datagram = malloc (sizeof (TEST_DATAGRAM) + Len);
+
+  if (Datagram == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  Datagram->Next = NULL;
+  Datagram->Port = Server->Port;
+  Datagram->Len  = Len;
+  memcpy (Datagram->Data, Data, Len);
+
+  if (mQueueTail == NULL) {
+    mQueueHead = Datagram;
+  } else {
+    mQueueTail->Next = Datagram;
+  }
+
+  mQueueTail = Datagram;
+}
+
+static
+VOID
+ServerSendError (
+  IN TEST_SERVER            *Server,
+  IN UINT16                 ErrorCode,
+  IN char                   *Message
+  )
+{
+  UINT8                     Packet[128];
+  UINT32                    Len;
+
+  *(UINT16 *) Packet       = HTONS (EFI_MTFTP4_OPCODE_ERROR);
+  *(UINT16 *) (Packet + 2) = HTONS (ErrorCode);
+  Len                      = (UINT32) strlen (Message) + 1;
+
+  memcpy (Packet + 4, Message, Len);
+  ServerQueue (Server, Packet, Len + 4);
+}
+
+static
+VOID
+ServerSendWindow (
+  IN TEST_SERVER            *Server,
+  IN UINT32                 Start
+  )
+/*++
+
+Routine Description:
+
+  Send the window of DATA blocks that starts at Start, dropping those
+  the loss pattern selects.
+
+Arguments:
+
+  Server  - The server
+  Start   - The first block of the window
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT8                     Packet[MTFTP4_DATA_HEAD_LEN + MTFTP4_MAX_BLKSIZE];
+  UINT32                    Block;
+  UINT32                    Offset;
+  UINT32                    Len;
+
+  for (Block = Start; (Block < Start + Server->WindowSize) && (Block <= Server->LastBlock); Block++) {
+    Server->DataSent++;
+
+    if ((Server->DropDataEvery != 0) && (Server->DataSent % Server->DropDataEvery == 0)) {
+      Server->DataDropped++;
+      continue;
+    }
+
+    Offset = (Block - 1) * Server->BlkSize;
+    Len    = Server->FileSize - Offset;
+
+    if (Len > Server->BlkSize) {
+      Len = Server->BlkSize;
+    }
+
+    *(UINT16 *) Packet       = HTONS (EFI_MTFTP4_OPCODE_DATA);
+    *(UINT16 *) (Packet + 2) = HTONS ((UINT16) Block);
+    memcpy (Packet + MTFTP4_DATA_HEAD_LEN, Server->File + Offset, Len);
+
+    ServerQueue (Server, Packet, Len + MTFTP4_DATA_HEAD_LEN);
+  }
+}
+
+static
+VOID
+ServerRequest (
+  IN TEST_SERVER            *Server,
+  IN UINT8                  *Packet,
+  IN UINT32                 Len
+  )
+/*++
+
+Routine Description:
+
+  Start a session for a RRQ. Parse the options, then either refuse them,
+  answer with an OACK, or start sending the file without options.
+
+Arguments:
+
+  Server  - The server
+  Packet  - The RRQ
+  Len     - The length of the RRQ
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT8                     Oack[128];
+  UINT8                     *Cur;
+  UINT8                     *End;
+  char                      *Name;
+  char                      *Value;
+  UINT32                    OackLen;
+
+  Server->Requests++;
+  Server->Port                = (UINT16) (TEST_SERVER_PORT_BASE + Server->Requests);
+  Server->Done                = FALSE;
+  Server->BlkSize             = MTFTP4_DEFAULT_BLKSIZE;
+  Server->WindowSize          = 1;
+  Server->RequestedBlkSize    = 0;
+  Server->RequestedWindowSize = 0;
+  Server->RequestedOptions    = 0;
+
+  //
+  // Skip the file name and the mode, then parse the option pairs
+  //
+  Cur = Packet + MTFTP4_OPCODE_LEN;
+  End = Packet + Len;
+  Cur += strlen ((char *) Cur) + 1;
+  Cur += strlen ((char *) Cur) + 1;
+
+  while (Cur < End) {
+    Name   = (char *) Cur;
+    Cur   += strlen (Name) + 1;
+    Value  = (char *) Cur;
+    Cur   += strlen (Value) + 1;
+
+    Server->RequestedOptions++;
+
+    if (strcmp (Name, "blksize") == 0) {
+      Server->RequestedBlkSize = (UINT32) atoi (Value);
+    } else if (strcmp (Name, "windowsize") == 0) {
+      Server->RequestedWindowSize = (UINT32) atoi (Value);
+    }
+  }
+
+  if ((Server->Mode == ServerDenyOptions) && (Server->RequestedOptions != 0)) {
+    ServerSendError (Server, EFI_MTFTP4_ERRORCODE_REQUEST_DENIED, "Option negotiation failed");
+    return ;
+  }
+
+  if ((Server->Mode == ServerIgnoreOptions) ||
+      ((Server->RequestedBlkSize == 0) && (Server->RequestedWindowSize == 0))) {
+    Server->LastBlock = Server->FileSize / Server->BlkSize + 1;
+    ServerSendWindow (Server, 1);
+    return ;
+  }
+
+  *(UINT16 *) Oack = HTONS (EFI_MTFTP4_OPCODE_OACK);
+  OackLen          = MTFTP4_OPCODE_LEN;
+
+  if (Server->RequestedBlkSize != 0) {
+    Server->BlkSize = NET_MIN (Server->RequestedBlkSize, Server->MaxBlkSize);
+
+    if (Server->OackBlkSize != 0) {
+      Server->BlkSize = Server->OackBlkSize;
+    }
+
+    OackLen        += sprintf ((char *) Oack + OackLen, "blksize") + 1;
+    OackLen        += sprintf ((char *) Oack + OackLen, "%u", (unsigned) Server->BlkSize) + 1;
+  }
+
+  if (Server->RequestedWindowSize != 0) {
+    Server->WindowSize = NET_MIN (Server->RequestedWindowSize, Server->MaxWindowSize);
+
+    if (Server->OackWindowSize != 0) {
+      Server->WindowSize = Server->OackWindowSize;
+    }
+
+    OackLen           += sprintf ((char *) Oack + OackLen, "windowsize") + 1;
+    OackLen           += sprintf ((char *) Oack + OackLen, "%u", (unsigned) Server->WindowSize) + 1;
+  }
+
+  Server->LastBlock = Server->FileSize / Server->BlkSize + 1;
+  ServerQueue (Server, Oack, OackLen);
+}
+
+static
+VOID
+ServerInput (
+  IN TEST_SERVER            *Server,
+  IN UINT8                  *Packet,
+  IN UINT32                 Len,
+  IN UINT16                 Port
+  )
+/*++
+
+Routine Description:
+
+  Process a datagram the client sent to the server.
+
+Arguments:
+
+  Server  - The server
+  Packet  - The datagram
+  Len     - The length of the datagram
+  Port    - The server port the datagram is sent to
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT16                    Opcode;
+  UINT32                    Block;
+
+  Opcode = NTOHS (*(UINT16 *) Packet);
+
+  if (Opcode == EFI_MTFTP4_OPCODE_RRQ) {
+    if (Port == MTFTP4_DEFAULT_SERVER_PORT) {
+      ServerRequest (Server, Packet, Len);
+    }
+
+    return ;
+  }
+
+  if (Port != Server->Port) {
+    return ;
+  }
+
+  if (Opcode == EFI_MTFTP4_OPCODE_ERROR) {
+    Server->Errors++;
+    Server->Done = TRUE;
+    return ;
+  }
+
+  if (Opcode != EFI_MTFTP4_OPCODE_ACK) {
+    return ;
+  }
+
+  Server->AcksReceived++;
+
+  if ((Server->DropAckEvery != 0) && (Server->AcksReceived % Server->DropAckEvery == 0)) {
+    Server->AcksDropped++;
+    return ;
+  }
+
+  Block = NTOHS (*(UINT16 *) (Packet + 2));
+
+  if (Block >= Server->LastBlock) {
+    Server->Done = TRUE;
+    return ;
+  }
+
+  ServerSendWindow (Server, Block + 1);
+}
+
+//
+// The loopback UDP_IO the driver code is linked against
+//
+UDP_IO_PORT *
+UdpIoCreatePort (
+  IN  EFI_HANDLE            Controller,
+  IN  EFI_HANDLE            ImageHandle,
+  IN  UDP_IO_CONFIG         Configure,
+  IN  VOID                  *Context
+  )
+{
+  //
+  // Only the unicast port is supported, fail the multicast download.
+  //
+  return NULL;
+}
+
+EFI_STATUS
+UdpIoFreePort (
+  IN  UDP_IO_PORT           *UdpIo
+  )
+{
+  return EFI_SUCCESS;
+}
+
+VOID
+UdpIoCleanPort (
+  IN  UDP_IO_PORT           *UdpIo
+  )
+{
+  mRecvCallBack = NULL;
+  mRecvContext  = NULL;
+}
+
+EFI_STATUS
+UdpIoSendDatagram (
+  IN  UDP_IO_PORT           *UdpIo,
+  IN  NET_BUF               *Packet,
+  IN  UDP_POINTS            *EndPoint, OPTIONAL
+  IN  IP4_ADDR              Gateway,
+  IN  UDP_IO_CALLBACK       CallBack,
+  IN  VOID                  *Context
+  )
+/*++
+
+Routine Description:
+
+  Hand the datagram to the server, then complete the transmit.
+
+--*/
+{
+  UINT8                     Data[MTFTP4_DATA_HEAD_LEN + MTFTP4_MAX_BLKSIZE];
+  UINT32                    Len;
+
+  Len = Packet->TotalSize;
+  NetbufCopy (Packet, 0, Len, Data);
+
+  ServerInput (mServer, Data, Len, EndPoint->RemotePort);
+  CallBack (Packet, EndPoint, EFI_SUCCESS, Context);
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+UdpIoRecvDatagram (
+  IN  UDP_IO_PORT           *UdpIo,
+  IN  UDP_IO_CALLBACK       CallBack,
+  IN  VOID                  *Context,
+  IN  UINT32                HeadLen
+  )
+{
+  if (mRecvCallBack != NULL) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  mRecvCallBack = CallBack;
+  mRecvContext  = Context;
+  return EFI_SUCCESS;
+}
+
+VOID
+Mtftp4CleanOperation (
+  IN MTFTP4_PROTOCOL        *Instance,
+  IN EFI_STATUS             Result
+  )
+/*++
+
+Routine Description:
+
+  The part of the driver's Mtftp4CleanOperation the download path
+  depends on: complete the token, stop the timer and free the packet
+  and the block ranges.
+
+--*/
+{
+  NET_LIST_ENTRY            *Entry;
+  NET_LIST_ENTRY            *Next;
+  MTFTP4_BLOCK_RANGE        *Block;
+
+  if (Instance->Token != NULL) {
+    Instance->Token->Status = Result;
+    Instance->Token         = NULL;
+  }
+
+  UdpIoCleanPort (Instance->UnicastPort);
+
+  if (Instance->LastPacket != NULL) {
+    NetbufFree (Instance->LastPacket);
+    Instance->LastPacket = NULL;
+  }
+
+  NET_LIST_FOR_EACH_SAFE (Entry, Next, &Instance->Blocks) {
+    Block = NET_LIST_USER_STRUCT (Entry, MTFTP4_BLOCK_RANGE, Link);
+    NetListRemoveEntry (Entry);
+    NetFreePool (Block);
+  }
+
+  Instance->Operation    = 0;
+  Instance->PacketToLive = 0;
+}
+
+static
+BOOLEAN
+DeliverDatagram (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Deliver the oldest queued datagram to the pending receive.
+
+Returns:
+
+  TRUE if a datagram was delivered.
+
+--*/
+{
+  TEST_DATAGRAM             *Datagram;
+  UDP_IO_CALLBACK           CallBack;
+  UDP_POINTS                Points;
+  NET_BUF                   *Packet;
+
+  if ((mQueueHead == NULL) || (mRecvCallBack == NULL)) {
+    return FALSE;
+  }
+
+  Datagram   = mQueueHead;
+  mQueueHead = Datagram->Next;
+
+  if (mQueueHead == NULL) {
+    mQueueTail = NULL;
+  }
+
+  Packet = NetbufAlloc (Datagram->Len);
+
+  if (Packet == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  memcpy (NetbufAllocSpace (Packet, Datagram->Len, FALSE), Datagram->Data, Datagram->Len);
+
+  Points.LocalAddr  = TEST_CLIENT_IP;
+  Points.LocalPort  = TEST_CLIENT_PORT;
+  Points.RemoteAddr = TEST_SERVER_IP;
+  Points.RemotePort = Datagram->Port;
+  free (Datagram);
+
+  CallBack      = mRecvCallBack;
+  mRecvCallBack = NULL;
+  CallBack (Packet, &Points, EFI_SUCCESS, mRecvContext);
+  return TRUE;
+}
+
+static
+VOID
+FlushQueue (
+  VOID
+  )
+{
+  TEST_DATAGRAM             *Datagram;
+
+  while (mQueueHead != NULL) {
+    Datagram   = mQueueHead;
+    mQueueHead = Datagram->Next;
+    free (Datagram);
+  }
+
+  mQueueTail = NULL;
+}
+
+static
+EFI_STATUS
+Download (
+  IN TEST_SESSION           *Session,
+  IN EFI_MTFTP4_OPTION      *Options,
+  IN UINT32                 OptionCount,
+  IN VOID                   *Buffer,
+  IN UINT64                 BufferSize
+  )
+/*++
+
+Routine Description:
+
+  Download the server's file into Buffer. The instance is set up the way
+  Mtftp4Start does it for a RRQ. Datagrams are delivered while there are
+  any; when the link is idle, the timer ticks so that the client times out
+  and retransmits.
+
+Arguments:
+
+  Session     - The session with the server already configured
+  Options     - The user's options
+  OptionCount - The number of the user's options
+  Buffer      - The buffer to download to
+  BufferSize  - The size of the buffer
+
+Returns:
+
+  The status the download completes the token with.
+
+--*/
+{
+  MTFTP4_PROTOCOL           *Instance;
+  EFI_MTFTP4_TOKEN          *Token;
+  EFI_STATUS                Status;
+
+  Instance = &Session->Instance;
+  Token    = &Session->Token;
+  mServer  = &Session->Server;
+
+  NetListInit (&Session->Service.Children);
+  NetListInit (&Instance->Blocks);
+  NetListInsertTail (&Session->Service.Children, &Instance->Link);
+
+  Session->UnicastPort.Udp = &mHostUdp;
+
+  Token->Filename    = "file";
+  Token->OptionCount = OptionCount;
+  Token->OptionList  = Options;
+  Token->Buffer      = Buffer;
+  Token->BufferSize  = BufferSize;
+
+  Instance->Signature     = MTFTP4_PROTOCOL_SIGNATURE;
+  Instance->Service       = &Session->Service;
+  Instance->UnicastPort   = &Session->UnicastPort;
+  Instance->Operation     = EFI_MTFTP4_OPCODE_RRQ;
+  Instance->Token         = Token;
+  Instance->BlkSize       = MTFTP4_DEFAULT_BLKSIZE;
+  Instance->WindowSize    = MTFTP4_DEFAULT_WINDOWSIZE;
+  Instance->ServerIp      = TEST_SERVER_IP;
+  Instance->ListeningPort = MTFTP4_DEFAULT_SERVER_PORT;
+  Instance->MaxRetry      = MTFTP4_DEFAULT_RETRY;
+  Instance->Timeout       = MTFTP4_DEFAULT_TIMEOUT;
+  Instance->Master        = TRUE;
+
+  if (OptionCount != 0) {
+    Status = Mtftp4ParseOption (Options, OptionCount, TRUE, &Instance->RequestOption);
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Status = Mtftp4RrqStart (Instance, EFI_MTFTP4_OPCODE_RRQ);
+
+  if (EFI_ERROR (Status)) {
+    Mtftp4CleanOperation (Instance, Status);
+    return Status;
+  }
+
+  Token->Status = EFI_NOT_READY;
+
+  while (Token->Status == EFI_NOT_READY) {
+    if (DeliverDatagram ()) {
+      continue;
+    }
+
+    if (++Session->Ticks > TEST_MAX_TICKS) {
+      Mtftp4CleanOperation (Instance, EFI_TIMEOUT);
+      break;
+    }
+
+    Mtftp4OnTimerTick (NULL, &Session->Service);
+  }
+
+  FlushQueue ();
+  return Token->Status;
+}
+
+static
+UINT8 *
+MakeFile (
+  IN UINT32                 Size
+  )
+{
+  UINT8                     *File;
+  UINT32                    Index;
+
+  File = malloc (Size + 1);
+
+  if (File == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  for (Index = 0; Index < Size; Index++) {
+    File[Index] = (UINT8) ((Index * 131 + (Index >> 9)) & 0xFF);
+  }
+
+  return File;
+}
+
+static
+VOID
+InitSession (
+  OUT TEST_SESSION          *Session,
+  IN  SERVER_MODE           Mode,
+  IN  UINT8                 *File,
+  IN  UINT32                FileSize
+  )
+{
+  memset (Session, 0, sizeof (TEST_SESSION));
+
+  Session->Server.Mode          = Mode;
+  Session->Server.File          = File;
+  Session->Server.FileSize      = FileSize;
+  Session->Server.MaxBlkSize    = MTFTP4_MAX_BLKSIZE;
+  Session->Server.MaxWindowSize = 64;
+}
+
+static
+VOID
+TestDownload (
+  IN char                   *Test,
+  IN SERVER_MODE            Mode,
+  IN UINT32                 FileSize,
+  IN UINT32                 MaxBlkSize,
+  IN UINT32                 MaxWindowSize,
+  IN UINT32                 DropDataEvery,
+  IN UINT32                 DropAckEvery,
+  IN UINT32                 ExpectBlkSize,
+  IN UINT32                 ExpectWindowSize
+  )
+/*++
+
+Routine Description:
+
+  Download a file and check the data, the parameters the client ended up
+  with and, when nothing is lost, that the client acked once per window.
+
+Arguments:
+
+  Test             - Name of the test
+  Mode             - How the server treats the options
+  FileSize         - The size of the file
+  MaxBlkSize       - The largest blksize the server accepts
+  MaxWindowSize    - The largest windowsize the server accepts
+  DropDataEvery    - Drop every Nth DATA packet, 0 for none
+  DropAckEvery     - Drop every Nth ACK, 0 for none
+  ExpectBlkSize    - The block size the download should use
+  ExpectWindowSize - The window size the download should use
+
+Returns:
+
+  None
+
+--*/
+{
+  TEST_SESSION              Session;
+  EFI_STATUS                Status;
+  UINT8                     *File;
+  UINT8                     *Buffer;
+  UINT32                    Blocks;
+
+  File   = MakeFile (FileSize);
+  Buffer = malloc (FileSize + 1);
+
+  if (Buffer == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  memset (Buffer, 0, FileSize + 1);
+
+  InitSession (&Session, Mode, File, FileSize);
+  Session.Server.MaxBlkSize    = MaxBlkSize;
+  Session.Server.MaxWindowSize = MaxWindowSize;
+  Session.Server.DropDataEvery = DropDataEvery;
+  Session.Server.DropAckEvery  = DropAckEvery;
+
+  Status = Download (&Session, NULL, 0, Buffer, FileSize + 1);
+
+  Check ((BOOLEAN) (Status == EFI_SUCCESS), Test, "download succeeds");
+  Check ((BOOLEAN) (Session.Token.BufferSize == FileSize), Test, "file size");
+  Check ((BOOLEAN) (memcmp (Buffer, File, FileSize) == 0), Test, "file data");
+  Check ((BOOLEAN) ((DropAckEvery != 0) || Session.Server.Done), Test, "server saw the last ACK");
+  Check ((BOOLEAN) (Session.Instance.BlkSize == ExpectBlkSize), Test, "block size");
+  Check ((BOOLEAN) (Session.Instance.WindowSize == ExpectWindowSize), Test, "window size");
+
+  if ((DropDataEvery == 0) && (DropAckEvery == 0)) {
+    //
+    // One ACK per window, plus the ACK of the OACK if options are used.
+    //
+    Blocks = FileSize / ExpectBlkSize + 1;
+    Check (
+      (BOOLEAN) (Session.Server.AcksReceived ==
+                 (Blocks + ExpectWindowSize - 1) / ExpectWindowSize + ((Mode == ServerOptions) ? 1 : 0)),
+      Test,
+      "one ACK per window"
+      );
+    Check ((BOOLEAN) (Session.Ticks == 0), Test, "no timeout");
+  } else {
+    Check ((BOOLEAN) (Session.Server.DataDropped + Session.Server.AcksDropped != 0), Test, "packets were dropped");
+  }
+
+  free (File);
+  free (Buffer);
+}
+
+static
+VOID
+TestImplicitOptions (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Check the options the client adds to a request: blksize from the MTU
+  and the implicit windowsize when the user asks for neither, only the
+  missing one when the user asks for one, and none when the user asks for
+  both.
+
+--*/
+{
+  TEST_SESSION              Session;
+  EFI_MTFTP4_OPTION         Options[2];
+  EFI_STATUS                Status;
+  UINT8                     *File;
+  UINT8                     *Buffer;
+  char                      *Test;
+
+  File   = MakeFile (20000);
+  Buffer = malloc (20001);
+
+  if (Buffer == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  Test = "implicit options";
+  InitSession (&Session, ServerOptions, File, 20000);
+  Status = Download (&Session, NULL, 0, Buffer, 20001);
+  Check ((BOOLEAN) (Status == EFI_SUCCESS), Test, "download succeeds");
+  Check ((BOOLEAN) (Session.Server.RequestedOptions == 2), Test, "two options requested");
+  Check (
+    (BOOLEAN) (Session.Server.RequestedBlkSize == TEST_MTU - TEST_IP_HEAD_LEN - sizeof (EFI_UDP4_HEADER) - MTFTP4_DATA_HEAD_LEN),
+    Test,
+    "blksize fills an unfragmented datagram"
+    );
+  Check ((BOOLEAN) (Session.Server.RequestedWindowSize == MTFTP4_IMPLICIT_WINDOWSIZE), Test, "implicit windowsize");
+
+  Test = "user blksize";
+  Options[0].OptionStr = "blksize";
+  Options[0].ValueStr  = "1024";
+  InitSession (&Session, ServerOptions, File, 20000);
+  Status = Download (&Session, Options, 1, Buffer, 20001);
+  Check ((BOOLEAN) (Status == EFI_SUCCESS), Test, "download succeeds");
+  Check ((BOOLEAN) (memcmp (Buffer, File, 20000) == 0), Test, "file data");
+  Check ((BOOLEAN) (Session.Server.RequestedOptions == 2), Test, "windowsize added");
+  Check ((BOOLEAN) (Session.Server.RequestedBlkSize == 1024), Test, "user blksize kept");
+  Check ((BOOLEAN) (Session.Instance.BlkSize == 1024), Test, "block size");
+
+  Test = "user stop-and-wait";
+  Options[0].OptionStr = "blksize";
+  Options[0].ValueStr  = "512";
+  Options[1].OptionStr = "windowsize";
+  Options[1].ValueStr  = "1";
+  InitSession (&Session, ServerOptions, File, 20000);
+  Status = Download (&Session, Options, 2, Buffer, 20001);
+  Check ((BOOLEAN) (Status == EFI_SUCCESS), Test, "download succeeds");
+  Check ((BOOLEAN) (memcmp (Buffer, File, 20000) == 0), Test, "file data");
+  Check ((BOOLEAN) (Session.Server.RequestedOptions == 2), Test, "nothing added");
+  Check ((BOOLEAN) (Session.Instance.ImplicitCount == 0), Test, "no implicit option");
+  Check ((BOOLEAN) (Session.Server.AcksReceived == 20000 / 512 + 2), Test, "one ACK per block");
+
+  free (File);
+  free (Buffer);
+}
+
+static
+VOID
+TestRefusedOptions (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  A server that refuses option negotiation makes the client send the
+  request again without the options it added itself, and the download
+  falls back to 512 byte stop-and-wait. If the user asked for the options,
+  the refusal ends the download.
+
+--*/
+{
+  TEST_SESSION              Session;
+  EFI_MTFTP4_OPTION         Options[1];
+  EFI_STATUS                Status;
+  UINT8                     *File;
+  UINT8                     *Buffer;
+  char                      *Test;
+
+  File   = MakeFile (5000);
+  Buffer = malloc (5001);
+
+  if (Buffer == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  Test = "refused implicit options";
+  InitSession (&Session, ServerDenyOptions, File, 5000);
+  Status = Download (&Session, NULL, 0, Buffer, 5001);
+  Check ((BOOLEAN) (Status == EFI_SUCCESS), Test, "download succeeds");
+  Check ((BOOLEAN) (memcmp (Buffer, File, 5000) == 0), Test, "file data");
+  Check ((BOOLEAN) (Session.Server.Requests == 2), Test, "request sent again");
+  Check ((BOOLEAN) (Session.Server.RequestedOptions == 0), Test, "second request has no option");
+  Check ((BOOLEAN) (Session.Instance.BlkSize == MTFTP4_DEFAULT_BLKSIZE), Test, "block size");
+
+  Test = "refused user options";
+  Options[0].OptionStr = "blksize";
+  Options[0].ValueStr  = "1024";
+  InitSession (&Session, ServerDenyOptions, File, 5000);
+
+  //
+  // The user's own option stays, so the client gives up after the
+  // windowsize it added is dropped and the server refuses again.
+  //
+  Status = Download (&Session, Options, 1, Buffer, 5001);
+  Check ((BOOLEAN) (Status == EFI_TFTP_ERROR), Test, "download fails");
+  Check ((BOOLEAN) (Session.Server.Requests == 2), Test, "one retry only");
+
+  free (File);
+  free (Buffer);
+}
+
+static
+VOID
+TestBadOack (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  An OACK with a bigger window or block than requested is refused with
+  an ERROR packet and ends the download.
+
+--*/
+{
+  TEST_SESSION              Session;
+  EFI_STATUS                Status;
+  UINT8                     *File;
+  UINT8                     *Buffer;
+
+  File   = MakeFile (5000);
+  Buffer = malloc (5001);
+
+  if (Buffer == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  InitSession (&Session, ServerOptions, File, 5000);
+  Session.Server.OackWindowSize = MTFTP4_IMPLICIT_WINDOWSIZE + 1;
+  Status = Download (&Session, NULL, 0, Buffer, 5001);
+  Check ((BOOLEAN) (Status == EFI_TFTP_ERROR), "bigger window", "download fails");
+  Check ((BOOLEAN) (Session.Server.Errors == 1), "bigger window", "server told");
+
+  InitSession (&Session, ServerOptions, File, 5000);
+  Session.Server.OackBlkSize = MTFTP4_MAX_BLKSIZE;
+  Status = Download (&Session, NULL, 0, Buffer, 5001);
+  Check ((BOOLEAN) (Status == EFI_TFTP_ERROR), "bigger block", "download fails");
+  Check ((BOOLEAN) (Session.Server.Errors == 1), "bigger block", "server told");
+
+  free (File);
+  free (Buffer);
+}
+
+static
+VOID
+TestBufferTooSmall (
+  VOID
+  )
+{
+  TEST_SESSION              Session;
+  EFI_STATUS                Status;
+  UINT8                     *File;
+  UINT8                     *Buffer;
+
+  File   = MakeFile (30000);
+  Buffer = malloc (30000);
+
+  if (Buffer == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  InitSession (&Session, ServerOptions, File, 30000);
+  Status = Download (&Session, NULL, 0, Buffer, 10000);
+  Check ((BOOLEAN) (Status == EFI_BUFFER_TOO_SMALL), "buffer too small", "status");
+  Check ((BOOLEAN) (Session.Token.BufferSize == 30000), "buffer too small", "file size reported");
+  Check ((BOOLEAN) (Session.Server.Errors == 1), "buffer too small", "server told");
+
+  free (File);
+  free (Buffer);
+}
+
+static
+VOID
+TimeDownload (
+  IN char                   *Name,
+  IN EFI_MTFTP4_OPTION      *Options,
+  IN UINT32                 OptionCount,
+  IN UINT8                  *File,
+  IN UINT32                 FileSize,
+  IN UINT8                  *Buffer,
+  IN UINT32                 DropDataEvery
+  )
+/*++
+
+Routine Description:
+
+  Download the file and print the packets, the round trips and the time
+  the download would take on a link with the given round trip time. A
+  round trip is counted for every ACK the server receives, and every
+  timer tick the link is idle waiting for a timeout costs a second.
+
+--*/
+{
+  TEST_SESSION              Session;
+  EFI_STATUS                Status;
+  clock_t                   Start;
+  double                    Cpu;
+  double                    Wire;
+
+  InitSession (&Session, ServerOptions, File, FileSize);
+  Session.Server.DropDataEvery = DropDataEvery;
+
+  Start  = clock ();
+  Status = Download (&Session, Options, OptionCount, Buffer, FileSize + 1);
+  Cpu    = (double) (clock () - Start) / CLOCKS_PER_SEC;
+
+  if ((Status != EFI_SUCCESS) || (memcmp (Buffer, File, FileSize) != 0)) {
+    printf ("%-28s download failed\n", Name);
+    mFailures++;
+    return ;
+  }
+
+  //
+  // Serialization at 100Mb/s plus the round trips
+  //
+  Wire = (double) Session.Server.DataSent * (Session.Instance.BlkSize + 46) * 8 / 100e6;
+
+  printf (
+    "%-28s %5u %5u %8u %6u %7u %9.2f %9.2f %8.3f\n",
+    Name,
+    (unsigned) Session.Instance.BlkSize,
+    (unsigned) Session.Instance.WindowSize,
+    (unsigned) Session.Server.DataSent,
+    (unsigned) Session.Server.AcksReceived,
+    (unsigned) Session.Ticks,
+    Wire + Session.Server.AcksReceived * 0.001 + Session.Ticks,
+    Wire + Session.Server.AcksReceived * 0.010 + Session.Ticks,
+    Cpu
+    );
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+{
+  EFI_MTFTP4_OPTION         Legacy[2];
+  UINT8                     *File;
+  UINT8                     *Buffer;
+  UINT32                    FileSize;
+
+  FileSize = 16 * 1024 * 1024;
+  File     = MakeFile (FileSize);
+  Buffer   = malloc (FileSize + 1);
+
+  if (Buffer == NULL) {
+    printf ("Out of memory\n");
+    exit (1);
+  }
+
+  Legacy[0].OptionStr = "blksize";
+  Legacy[0].ValueStr  = "512";
+  Legacy[1].OptionStr = "windowsize";
+  Legacy[1].ValueStr  = "1";
+
+  printf ("16MB download, 100Mb/s link, estimated seconds at 1ms and 10ms round trip\n");
+  printf (
+    "%-28s %5s %5s %8s %6s %7s %9s %9s %8s\n",
+    "Download", "Blk", "Win", "DATA", "ACK", "Idle s", "1ms RTT", "10ms RTT", "CPU s"
+    );
+
+  TimeDownload ("512 stop-and-wait", Legacy, 2, File, FileSize, Buffer, 0);
+  TimeDownload ("implicit blksize/window", NULL, 0, File, FileSize, Buffer, 0);
+  TimeDownload ("512 stop-and-wait, 0.1% loss", Legacy, 2, File, FileSize, Buffer, 997);
+  TimeDownload ("implicit, 0.1% loss", NULL, 0, File, FileSize, Buffer, 997);
+
+  free (File);
+  free (Buffer);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the tests, or the benchmark when called with -b.
+
+Arguments:
+
+  argc  - Number of command line arguments
+  argv  - Command line arguments
+
+Returns:
+
+  0 if every check passed, 1 otherwise.
+
+--*/
+{
+  NetHostLibInit ();
+  mHostUdp.GetModeData = HostUdpGetModeData;
+
+  if (argc > 1 && strcmp (argv[1], "-b") == 0) {
+    Benchmark ();
+    return 0;
+  }
+
+  //
+  // Option negotiation with a server that supports the options, one that
+  // caps them, one that predates them, and one that refuses them.
+  //
+  TestDownload ("windowed", ServerOptions, 100000, MTFTP4_MAX_BLKSIZE, 64, 0, 0, 1468, 8);
+  TestDownload ("windowed, exact blocks", ServerOptions, 1468 * 16, MTFTP4_MAX_BLKSIZE, 64, 0, 0, 1468, 8);
+  TestDownload ("server caps", ServerOptions, 100000, 1024, 4, 0, 0, 1024, 4);
+  TestDownload ("old server", ServerIgnoreOptions, 100000, 0, 0, 0, 0, 512, 1);
+  TestImplicitOptions ();
+  TestRefusedOptions ();
+  TestBadOack ();
+
+  //
+  // Recovery from lost DATA and lost ACKs, anywhere in the window
+  //
+  TestDownload ("lost data", ServerOptions, 300000, MTFTP4_MAX_BLKSIZE, 64, 7, 0, 1468, 8);
+  TestDownload ("lost window end", ServerOptions, 300000, MTFTP4_MAX_BLKSIZE, 64, 8, 0, 1468, 8);
+  TestDownload ("lost ack", ServerOptions, 300000, MTFTP4_MAX_BLKSIZE, 64, 0, 5, 1468, 8);
+  TestDownload ("lost data and ack", ServerOptions, 300000, MTFTP4_MAX_BLKSIZE, 64, 11, 3, 1468, 8);
+  TestDownload ("old server, lost data", ServerIgnoreOptions, 50000, 0, 0, 9, 0, 512, 1);
+
+  TestBufferTooSmall ();
+
+  if (mFailures != 0) {
+    printf ("Mtftp4Test: %u check(s) failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("Mtftp4Test: all checks passed\n");
+  return 0;
+}
@@ -368,78 +368,126 @@ AppendToMultiString (
   return EFI_SUCCESS;
 }
 
+STATIC CHAR16 mHexLowerDigit[] = L"0123456789abcdef";
+
 STATIC
-EFI_STATUS
+UINTN
+GetLengthOfNumber (
+  IN  EFI_STRING                   StringPtr,
+  OUT UINTN                        *HexCount
+  )
+/*++
+
+  Routine Description:
+    Get the length of <Number> in <BlockConfig> format, i.e. the length of the
+    value of OFFSET or WIDTH or VALUE.
+
+  Arguments:
+    StringPtr              - String in <BlockConfig> format and points to the
+                             first character of <Number>.
+    HexCount               - Number of leading hex digits of <Number>, the
+                             digits which make up its value.
+
+  Returns:
+    Length of the <Number>, in characters.
+
+--*/
+{
+  UINTN  Length;
+  UINT8  Digit;
+
+  ASSERT (StringPtr != NULL && HexCount != NULL);
+
+  for (*HexCount = 0; IsHexDigit (&Digit, StringPtr[*HexCount]); (*HexCount)++);
+
+  for (Length = *HexCount; StringPtr[Length] != 0 && StringPtr[Length] != L'&'; Length++);
+
+  return Length;
+}
+
+STATIC
+VOID
 GetValueOfNumber (
   IN EFI_STRING                    StringPtr,
-  OUT UINT8                        **Number,
+  OUT UINTN                        *Number,
   OUT UINTN                        *Len
   )
 /*++
 
   Routine Description:
-    Get the value of <Number> in <BlockConfig> format, i.e. the value of OFFSET 
-    or WIDTH or VALUE.
+    Get the value of <Number> in <BlockConfig> format, i.e. the value of OFFSET
+    or WIDTH.
 
-    <BlockConfig> ::= 'OFFSET='<Number>&'WIDTH='<Number>&'VALUE'=<Number> 
-    
-  Arguments:          
-    StringPtr              - String in <BlockConfig> format and points to the 
+    <BlockConfig> ::= 'OFFSET='<Number>&'WIDTH='<Number>&'VALUE'=<Number>
+
+  Arguments:
+    StringPtr              - String in <BlockConfig> format and points to the
                              first character of <Number>.
-    Number                 - The output value. Caller takes the responsibility to
-                             free memory.
+    Number                 - The output value. Digits beyond the size of UINTN
+                             are truncated from the most significant side.
     Len                    - Length of the <Number>, in characters.
-    
-  Returns:              
-    EFI_OUT_OF_RESOURCES   - Insufficient resources to store neccessary structures.
-    EFI_SUCCESS            - Value of <Number> is outputted in Number successfully.
-                             
---*/      
+
+  Returns:
+    None.
+
+--*/
 {
-  EFI_STRING               TmpPtr;
-  UINTN                    Length;
-  EFI_STRING               Str;
-  UINT8                    *Buf;
-  EFI_STATUS               Status;
+  UINTN  HexCount;
+  UINTN  Index;
+  UINT8  Digit;
 
   ASSERT (StringPtr != NULL && Number != NULL && Len != NULL);
-  ASSERT (*StringPtr != 0);
-
-  Buf = NULL;
 
-  TmpPtr = StringPtr;
-  while (*StringPtr != 0 && *StringPtr != L'&') {
-    StringPtr++;
+  *Len    = GetLengthOfNumber (StringPtr, &HexCount);
+  *Number = 0;
+  for (Index = 0; Index < HexCount; Index++) {
+    IsHexDigit (&Digit, StringPtr[Index]);
+    *Number = (*Number << 4) | Digit;
   }
-  *Len   = StringPtr - TmpPtr;
-  Length = *Len + 1;
+}
 
-  Str = (EFI_STRING) EfiLibAllocateZeroPool (Length * sizeof (EFI_STRING));
-  if (Str == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto Exit;
-  }
-  EfiCopyMem (Str, TmpPtr, *Len * sizeof (CHAR16));    
-  *(Str + *Len) = 0;
-
-  Length = (Length + 1) / 2;
-  Buf = (UINT8 *) EfiLibAllocateZeroPool (Length);
-  if (Buf == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto Exit;    
-  }
+STATIC
+VOID
+HexStringToBlock (
+  IN  EFI_STRING                   StringPtr,
+  IN  UINTN                        HexCount,
+  OUT UINT8                        *Block,
+  IN  UINTN                        Width
+  )
+/*++
 
-  Status = HexStringToBuf (Buf, &Length, Str, NULL);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
+  Routine Description:
+    Convert the value of VALUE in <BlockConfig> format to bytes of a block.
+    As HexStringToBuf() does, the last two hex digits make up the first byte.
 
-  *Number = Buf;
-  Status  = EFI_SUCCESS;
-    
-Exit:
-  EfiLibSafeFreePool (Str);
-  return Status;
+  Arguments:
+    StringPtr              - Points to the first character of <Number>.
+    HexCount               - Number of leading hex digits of <Number>.
+    Block                  - Points to the first byte to be updated.
+    Width                  - Number of bytes to be updated, bytes which have no
+                             hex digits are zeroed.
+
+  Returns:
+    None.
+
+--*/
+{
+  UINTN  Index;
+  UINT8  Digit;
+  UINT8  Byte;
+
+  for (Index = 0; Index < Width; Index++) {
+    Byte = 0;
+    if (Index * 2 < HexCount) {
+      IsHexDigit (&Digit, StringPtr[HexCount - 1 - Index * 2]);
+      Byte = Digit;
+    }
+    if (Index * 2 + 1 < HexCount) {
+      IsHexDigit (&Digit, StringPtr[HexCount - 2 - Index * 2]);
+      Byte = (UINT8) (Byte | (Digit << 4));
+    }
+    Block[Index] = Byte;
+  }
 }
 
 EFI_STATUS
@@ -1030,15 +1078,17 @@ HiiBlockToConfig (
 {
   HII_DATABASE_PRIVATE_DATA           *Private;
   EFI_STRING                          StringPtr;
+  EFI_STRING                          ElementPtr;
   UINTN                               Length;
   EFI_STATUS                          Status;
   EFI_STRING                          TmpPtr;
-  UINT8                               *TmpBuffer;
   UINTN                               Offset;
   UINTN                               Width;
-  UINT8                               *Value;
+  UINTN                               Index;
+  UINT8                               Byte;
+  EFI_STRING                          Str;
   EFI_STRING                          ValueStr;
-  EFI_STRING                          ConfigElement;
+  UINTN                               ConfigLength;
 
   if (This == NULL || Progress == NULL || Config == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -1049,40 +1099,27 @@ HiiBlockToConfig (
     return EFI_INVALID_PARAMETER;
   }
 
- 
+
   Private = CONFIG_ROUTING_DATABASE_PRIVATE_DATA_FROM_THIS (This);
 
-  StringPtr     = ConfigRequest;
-  ValueStr      = NULL;
-  Value         = NULL;
-  ConfigElement = NULL; 
+  StringPtr = ConfigRequest;
+  Str       = NULL;
 
   //
-  // Allocate a fix length of memory to store Results. Reallocate memory for 
-  // Results if this fix length is insufficient.
-  //
-  *Config = (EFI_STRING) EfiLibAllocateZeroPool (MAX_STRING_LENGTH);
-  if (*Config == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
+  // Jump <ConfigHdr>
   //
-  // Jump <ConfigHdr> 
-  //  
   if (EfiStrnCmp (StringPtr, L"GUID=", EfiStrLen (L"GUID=")) != 0) {
     *Progress = StringPtr;
-    Status = EFI_INVALID_PARAMETER;
-    goto Exit;
+    return EFI_INVALID_PARAMETER;
   }
-  
+
   while (*StringPtr != 0 && EfiStrnCmp (StringPtr, L"PATH=", EfiStrLen (L"PATH=")) != 0) {
     StringPtr++;
   }
-  
+
   if (*StringPtr == 0) {
     *Progress = StringPtr;
-    Status = EFI_INVALID_PARAMETER;
-    goto Exit;
+    return EFI_INVALID_PARAMETER;
   }
 
   while (*StringPtr != L'&' && *StringPtr != 0) {
@@ -1090,163 +1127,127 @@ HiiBlockToConfig (
   }
   if (*StringPtr == 0) {
     *Progress = StringPtr;
-    Status = EFI_INVALID_PARAMETER;
-    goto Exit;
+    return EFI_INVALID_PARAMETER;
   }
   //
   // Skip '&'
   //
   StringPtr++;
+  ElementPtr = StringPtr;
 
   //
-  // Copy <ConfigHdr> and an additional '&' to <ConfigResp>
-  //
-  Length = StringPtr - ConfigRequest;
-  EfiCopyMem (*Config, ConfigRequest, Length * sizeof (CHAR16));
-  
-  //
-  // Parse each <RequestElement> if exists
-  // Only <BlockName> format is supported by this help function.
-  // <BlockName> ::= 'OFFSET='<Number>&'WIDTH='<Number>
+  // The <ConfigResp> is built in two passes over the <RequestElement>s: the
+  // first one validates them and sizes the result, the second one fills in
+  // a single allocation instead of growing it element by element.
   //
-  while (*StringPtr != 0 && EfiStrnCmp (StringPtr, L"OFFSET=", EfiStrLen (L"OFFSET=")) == 0) {
-    //
-    // Back up the header of one <BlockName>
+  do {
     //
-    TmpPtr = StringPtr;
-    
-    StringPtr += EfiStrLen (L"OFFSET=");
-    //
-    // Get Offset
+    // Copy <ConfigHdr> and an additional '&' to <ConfigResp>
     //
-    Status = GetValueOfNumber (StringPtr, &TmpBuffer, &Length);
-    if (Status == EFI_OUT_OF_RESOURCES) {
-      *Progress = ConfigRequest;
-      goto Exit;
+    StringPtr    = ElementPtr;
+    ConfigLength = StringPtr - ConfigRequest;
+    if (Str != NULL) {
+      EfiCopyMem (Str, ConfigRequest, ConfigLength * sizeof (CHAR16));
     }
-    Offset = 0;
-    EfiCopyMem (
-      &Offset,
-      TmpBuffer,
-      (((Length + 1) / 2) < sizeof (UINTN)) ? ((Length + 1) / 2) : sizeof (UINTN)
-      );
-    EfiLibSafeFreePool (TmpBuffer);
-    
-    StringPtr += Length;
-    if (EfiStrnCmp (StringPtr, L"&WIDTH=", EfiStrLen (L"&WIDTH=")) != 0) {
-      *Progress = StringPtr - Length - EfiStrLen (L"OFFSET=") - 1;
-      Status = EFI_INVALID_PARAMETER;
-      goto Exit;
-    }
-    StringPtr += EfiStrLen (L"&WIDTH=");
-    
+
     //
-    // Get Width
+    // Parse each <RequestElement> if exists
+    // Only <BlockName> format is supported by this help function.
+    // <BlockName> ::= 'OFFSET='<Number>&'WIDTH='<Number>
     //
-    Status = GetValueOfNumber (StringPtr, &TmpBuffer, &Length);
-    if (Status == EFI_OUT_OF_RESOURCES) {
-      *Progress = ConfigRequest;
-      goto Exit;
-    }
-    Width = 0;
-    EfiCopyMem (
-      &Width,
-      TmpBuffer,
-      (((Length + 1) / 2) < sizeof (UINTN)) ? ((Length + 1) / 2) : sizeof (UINTN)
-      );
-    EfiLibSafeFreePool (TmpBuffer);    
+    while (*StringPtr != 0 && EfiStrnCmp (StringPtr, L"OFFSET=", EfiStrLen (L"OFFSET=")) == 0) {
+      //
+      // Back up the header of one <BlockName>
+      //
+      TmpPtr = StringPtr;
 
-    StringPtr += Length;
-    if (*StringPtr != 0 && *StringPtr != L'&') {
-      *Progress = StringPtr - Length - EfiStrLen (L"&WIDTH=");      
-      Status = EFI_INVALID_PARAMETER;      
-      goto Exit;
-    }
+      StringPtr += EfiStrLen (L"OFFSET=");
+      //
+      // Get Offset
+      //
+      GetValueOfNumber (StringPtr, &Offset, &Length);
+      StringPtr += Length;
+      if (EfiStrnCmp (StringPtr, L"&WIDTH=", EfiStrLen (L"&WIDTH=")) != 0) {
+        *Progress = StringPtr - Length - EfiStrLen (L"OFFSET=") - 1;
+        Status = EFI_INVALID_PARAMETER;
+        goto Exit;
+      }
+      StringPtr += EfiStrLen (L"&WIDTH=");
 
-    //
-    // Calculate Value and convert it to hex string.
-    //
-    if (Offset + Width > BlockSize) {
-      *Progress = StringPtr;
-      Status = EFI_DEVICE_ERROR;
-      goto Exit;
-    }
+      //
+      // Get Width
+      //
+      GetValueOfNumber (StringPtr, &Width, &Length);
+      StringPtr += Length;
+      if (*StringPtr != 0 && *StringPtr != L'&') {
+        *Progress = StringPtr - Length - EfiStrLen (L"&WIDTH=");
+        Status = EFI_INVALID_PARAMETER;
+        goto Exit;
+      }
 
-    Value = (UINT8 *) EfiLibAllocateZeroPool (Width);
-    if (Value == NULL) {
-      *Progress = ConfigRequest;
-      Status = EFI_OUT_OF_RESOURCES;
-      goto Exit;
-    }
+      if (Offset + Width > BlockSize) {
+        *Progress = StringPtr;
+        Status = EFI_DEVICE_ERROR;
+        goto Exit;
+      }
 
-    EfiCopyMem (Value, (UINT8 *) Block + Offset, Width);
+      //
+      // Build a ConfigElement: <BlockName>&VALUE=<Number>, where <Number> is
+      // the block data as a lowercase hex number, the last byte coming first
+      //
+      Length = StringPtr - TmpPtr;
+      if (Str != NULL) {
+        EfiCopyMem (Str + ConfigLength, TmpPtr, Length * sizeof (CHAR16));
+        EfiCopyMem (Str + ConfigLength + Length, L"&VALUE=", EfiStrLen (L"&VALUE=") * sizeof (CHAR16));
+
+        ValueStr = Str + ConfigLength + Length + EfiStrLen (L"&VALUE=");
+        for (Index = 0; Index < Width; Index++) {
+          Byte = Block[Offset + Width - 1 - Index];
+          ValueStr[Index * 2]     = mHexLowerDigit[Byte >> 4];
+          ValueStr[Index * 2 + 1] = mHexLowerDigit[Byte & 0x0F];
+        }
+      }
+      ConfigLength += Length + EfiStrLen (L"&VALUE=") + Width * 2;
 
-    Length = Width * 2 + 1;
-    ValueStr = (EFI_STRING) EfiLibAllocateZeroPool (Length  * sizeof (CHAR16));
-    if (ValueStr == NULL) {
-      *Progress = ConfigRequest;
-      Status = EFI_OUT_OF_RESOURCES;
-      goto Exit;
+      //
+      // If '\0', parsing is finished. Otherwise skip '&' to continue
+      //
+      if (*StringPtr == 0) {
+        break;
+      }
+
+      if (Str != NULL) {
+        Str[ConfigLength] = L'&';
+      }
+      ConfigLength++;
+      StringPtr++;
     }
-      
-    Status = BufToHexString (ValueStr, &Length, Value, Width);        
-    ASSERT_EFI_ERROR (Status);
-    ToLower (ValueStr);
-    
-    EfiLibSafeFreePool (Value);
-    Value = NULL;
-    
-    //
-    // Build a ConfigElement
-    //
-    Length += StringPtr - TmpPtr + 1 + EfiStrLen (L"VALUE=");
-    ConfigElement = (EFI_STRING) EfiLibAllocateZeroPool (Length * sizeof (CHAR16));
-    if (ConfigElement == NULL) {
-      Status = EFI_OUT_OF_RESOURCES;
+
+    if (*StringPtr != 0) {
+      *Progress = StringPtr - 1;
+      Status = EFI_INVALID_PARAMETER;
       goto Exit;
     }
-    EfiCopyMem (ConfigElement, TmpPtr, (StringPtr - TmpPtr + 1) * sizeof (CHAR16));
-    if (*StringPtr == 0) {
-      *(ConfigElement + (StringPtr - TmpPtr)) = L'&';
-    }
-    *(ConfigElement + (StringPtr - TmpPtr) + 1) = 0;
-    EfiStrCat (ConfigElement, L"VALUE=");
-    EfiStrCat (ConfigElement, ValueStr);
-
-    AppendToMultiString (Config, ConfigElement);
-    
-    EfiLibSafeFreePool (ConfigElement);    
-    EfiLibSafeFreePool (ValueStr);
-    ConfigElement = NULL;
-    ValueStr = NULL;    
 
-    //
-    // If '\0', parsing is finished. Otherwise skip '&' to continue
-    //
-    if (*StringPtr == 0) {
+    if (Str != NULL) {
       break;
     }
 
-    AppendToMultiString (Config, L"&");
-    StringPtr++;
-  }
-
-  if (*StringPtr != 0) {
-    *Progress = StringPtr - 1;    
-    Status = EFI_INVALID_PARAMETER;
-    goto Exit;
-  }
+    Str = (EFI_STRING) EfiLibAllocatePool ((ConfigLength + 1) * sizeof (CHAR16));
+    if (Str == NULL) {
+      *Progress = ConfigRequest;
+      return EFI_OUT_OF_RESOURCES;
+    }
+  } while (TRUE);
 
+  Str[ConfigLength] = 0;
+  *Config   = Str;
   *Progress = StringPtr;
   return EFI_SUCCESS;
-  
+
 Exit:
-  
-  EfiLibSafeFreePool (*Config);
-  EfiLibSafeFreePool (ValueStr);
-  EfiLibSafeFreePool (Value);
-  EfiLibSafeFreePool (ConfigElement);
-  
+
+  EfiLibSafeFreePool (Str);
   return Status;
 
 }
@@ -1311,10 +1312,9 @@ HiiConfigToBlock (
   EFI_STRING                          StringPtr;
   UINTN                               Length;
   EFI_STATUS                          Status;
-  UINT8                               *TmpBuffer;
   UINTN                               Offset;
   UINTN                               Width;
-  UINT8                               *Value;
+  UINTN                               HexCount;
   UINTN                               BufferSize;
 
   if (This == NULL || BlockSize == NULL || Progress == NULL) {
@@ -1330,7 +1330,6 @@ HiiConfigToBlock (
 
   StringPtr  = ConfigResp;
   BufferSize = *BlockSize;
-  Value      = NULL;
   
   //
   // Jump <ConfigHdr> 
@@ -1374,18 +1373,7 @@ HiiConfigToBlock (
     //
     // Get Offset
     //
-    Status = GetValueOfNumber (StringPtr, &TmpBuffer, &Length);
-    if (Status == EFI_OUT_OF_RESOURCES) {
-      *Progress = ConfigResp;
-      goto Exit;
-    }
-    Offset = 0;
-    EfiCopyMem (
-      &Offset,
-      TmpBuffer,
-      (((Length + 1) / 2) < sizeof (UINTN)) ? ((Length + 1) / 2) : sizeof (UINTN)
-      );
-    EfiLibSafeFreePool (TmpBuffer);    
+    GetValueOfNumber (StringPtr, &Offset, &Length);
     
     StringPtr += Length;
     if (EfiStrnCmp (StringPtr, L"&WIDTH=", EfiStrLen (L"&WIDTH=")) != 0) {
@@ -1398,18 +1386,7 @@ HiiConfigToBlock (
     //
     // Get Width
     //
-    Status = GetValueOfNumber (StringPtr, &TmpBuffer, &Length);
-    if (Status == EFI_OUT_OF_RESOURCES) {
-      *Progress = ConfigResp;
-      goto Exit;
-    }
-    Width = 0;
-    EfiCopyMem (
-      &Width,
-      TmpBuffer,
-      (((Length + 1) / 2) < sizeof (UINTN)) ? ((Length + 1) / 2) : sizeof (UINTN)
-      );
-    EfiLibSafeFreePool (TmpBuffer);
+    GetValueOfNumber (StringPtr, &Width, &Length);
 
     StringPtr += Length;
     if (EfiStrnCmp (StringPtr, L"&VALUE=", EfiStrLen (L"&VALUE=")) != 0) {
@@ -1420,13 +1397,9 @@ HiiConfigToBlock (
     StringPtr += EfiStrLen (L"&VALUE=");
 
     //
-    // Get Value
+    // Get the length of Value, it is converted straight into the Block
     //
-    Status = GetValueOfNumber (StringPtr, &Value, &Length);
-    if (Status == EFI_OUT_OF_RESOURCES) {
-      *Progress = ConfigResp;
-      goto Exit;
-    }
+    Length = GetLengthOfNumber (StringPtr, &HexCount);
 
     StringPtr += Length;
     if (*StringPtr != 0 && *StringPtr != L'&') {
@@ -1443,11 +1416,8 @@ HiiConfigToBlock (
       return EFI_DEVICE_ERROR;
     }
 
-    EfiCopyMem (Block + Offset, Value, Width);
+    HexStringToBlock (StringPtr - Length, HexCount, Block + Offset, Width);
     *BlockSize = Offset + Width - 1;
-
-    EfiLibSafeFreePool (Value);
-    Value = NULL;
     
     //
     // If '\0', parsing is finished. Otherwise skip '&' to continue
@@ -1469,8 +1439,7 @@ HiiConfigToBlock (
   return EFI_SUCCESS;
 
 Exit:
-  
-  EfiLibSafeFreePool (Value);
+
   return Status;
 }
 
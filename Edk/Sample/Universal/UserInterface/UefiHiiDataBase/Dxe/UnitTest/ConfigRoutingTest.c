@@ -0,0 +1,735 @@
+/*++
+
+Copyright (c) 2010, Intel Corporation
+All rights reserved. This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+Module Name:
+
+  ConfigRoutingTest.c
+
+Abstract:
+
+  Host test and benchmark for HiiBlockToConfig and HiiConfigToBlock.
+
+  ConfigRouting.c is linked into a host program with the string and pool
+  helpers it uses. The test checks that
+
+    - a set of requests and responses, valid and malformed, give the same
+      status, Progress, <ConfigResp> and block as the ConfigRouting.c
+      that grew the string element by element,
+    - the <ConfigResp> for a 64 KB varstore matches that ConfigRouting.c,
+      compared by length and CRC32,
+    - random requests on random blocks round trip: ConfigToBlock of the
+      BlockToConfig result rebuilds the requested bytes and leaves the
+      others alone.
+
+  The expected values were recorded with -r from the ConfigRouting.c
+  before the single allocation builder.
+
+  With -b the program times both functions on a 64 KB varstore.
+
+--*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "HiiDatabase.h"
+
+#define TEST_HEADER           L"GUID=00112233445566778899aabbccddeeff&NAME=0041&PATH=0102030405060708&"
+#define TEST_GOLDEN_SIZE      64
+#define TEST_VARSTORE_SIZE    0x10000
+#define TEST_NO_PROGRESS      ((UINTN) -1)
+
+typedef struct {
+  CHAR16      *Request;
+  EFI_STATUS  Status;
+  UINTN       Progress;   // characters from the start of the request
+  CHAR16      *Config;    // NULL unless the call succeeds
+} TEST_BLOCK_TO_CONFIG;
+
+typedef struct {
+  CHAR16      *Response;
+  EFI_STATUS  Status;
+  UINTN       Progress;   // characters from the start of the response
+  UINTN       BlockSize;  // *BlockSize on return
+  UINT32      BlockCrc;   // CRC32 of the block on return
+} TEST_CONFIG_TO_BLOCK;
+
+static HII_DATABASE_PRIVATE_DATA  mPrivate;
+static EFI_BOOT_SERVICES          mBootServices;
+static UINT32                     mSeed = 0x6b8b4567;
+static UINTN                      mFailures;
+static BOOLEAN                    mRecord;
+
+EFI_SYSTEM_TABLE                  *gST;
+EFI_BOOT_SERVICES                 *gBS = &mBootServices;
+
+static TEST_BLOCK_TO_CONFIG mBlockToConfig[] = {
+  { TEST_HEADER L"OFFSET=0&WIDTH=1",
+    EFI_SUCCESS, 86, TEST_HEADER L"OFFSET=0&WIDTH=1&VALUE=0b" },
+  { TEST_HEADER L"OFFSET=0&WIDTH=2&OFFSET=2&WIDTH=4&OFFSET=8&WIDTH=8&OFFSET=10&WIDTH=10",
+    EFI_SUCCESS, 139, TEST_HEADER L"OFFSET=0&WIDTH=2&VALUE=300b&OFFSET=2&WIDTH=4&VALUE=c49f7a55&OFFSET=8&WIDTH=8&VALUE=3611ecc7a27d5833&OFFSET=10&WIDTH=10&VALUE=86613c17f2cda8835e3914efcaa5805b" },
+  { TEST_HEADER L"OFFSET=003f&WIDTH=0001",
+    EFI_SUCCESS, 92, TEST_HEADER L"OFFSET=003f&WIDTH=0001&VALUE=26" },
+  { TEST_HEADER L"OFFSET=3F&WIDTH=1",
+    EFI_SUCCESS, 87, TEST_HEADER L"OFFSET=3F&WIDTH=1&VALUE=26" },
+  { TEST_HEADER L"OFFSET=20&WIDTH=20",
+    EFI_SUCCESS, 88, TEST_HEADER L"OFFSET=20&WIDTH=20&VALUE=2601dcb7926d4823fed9b48f6a4520fbd6b18c67421df8d3ae89643f1af5d0ab" },
+  { TEST_HEADER L"OFFSET=4&WIDTH=2&OFFSET=4&WIDTH=2",
+    EFI_SUCCESS, 103, TEST_HEADER L"OFFSET=4&WIDTH=2&VALUE=c49f&OFFSET=4&WIDTH=2&VALUE=c49f" },
+  { TEST_HEADER L"OFFSET=0&WIDTH=0",
+    EFI_SUCCESS, 86, TEST_HEADER L"OFFSET=0&WIDTH=0&VALUE=" },
+  { TEST_HEADER L"OFFSET=30&WIDTH=11",
+    EFI_DEVICE_ERROR, 88, NULL },
+  { TEST_HEADER L"OFFSET=0&WIDTH=1&LENGTH=2",
+    EFI_INVALID_PARAMETER, 86, NULL },
+  { TEST_HEADER L"OFFSET=0&WITH=1",
+    EFI_INVALID_PARAMETER, 69, NULL },
+  { TEST_HEADER L"OFFSET=1g&WIDTH=1",
+    EFI_SUCCESS, 87, TEST_HEADER L"OFFSET=1g&WIDTH=1&VALUE=30" },
+  { TEST_HEADER L"OFFSET=0&WIDTH=1&",
+    EFI_SUCCESS, 87, TEST_HEADER L"OFFSET=0&WIDTH=1&VALUE=0b&" },
+  { TEST_HEADER,
+    EFI_SUCCESS, 70, TEST_HEADER },
+  { L"NAME=0041&PATH=00&OFFSET=0&WIDTH=1",
+    EFI_INVALID_PARAMETER, 0, NULL },
+  { L"GUID=00&NAME=0041&OFFSET=0&WIDTH=1",
+    EFI_INVALID_PARAMETER, 34, NULL },
+  { L"GUID=00&NAME=0041&PATH=00",
+    EFI_INVALID_PARAMETER, 25, NULL }
+};
+
+static TEST_CONFIG_TO_BLOCK mConfigToBlock[] = {
+  { TEST_HEADER L"OFFSET=0&WIDTH=1&VALUE=5a",
+    EFI_SUCCESS, 95, 0x0, 0xeef7ba63 },
+  { TEST_HEADER L"OFFSET=2&WIDTH=4&VALUE=12345678",
+    EFI_SUCCESS, 101, 0x5, 0x6ec20e16 },
+  //
+  // The old code copied WIDTH bytes out of a buffer sized for the digits;
+  // the bytes without digits are now zero.
+  //
+  { TEST_HEADER L"OFFSET=8&WIDTH=4&VALUE=abc",
+    EFI_SUCCESS, 96, 0xb, 0x86b7bb1f },
+  { TEST_HEADER L"OFFSET=8&WIDTH=2&VALUE=11223344",
+    EFI_SUCCESS, 101, 0x9, 0x2fa9abbe },
+  { TEST_HEADER L"OFFSET=10&WIDTH=8&VALUE=DEADBEEFCAFEF00D",
+    EFI_SUCCESS, 110, 0x17, 0x836964fc },
+  { TEST_HEADER L"OFFSET=0&WIDTH=2&VALUE=0102&OFFSET=3e&WIDTH=2&VALUE=fffe&OFFSET=1&WIDTH=1&VALUE=77",
+    EFI_SUCCESS, 152, 0x1, 0xcbe909f6 },
+  { TEST_HEADER L"OFFSET=0&WIDTH=1&VALUE=",
+    EFI_SUCCESS, 93, 0x0, 0x0320b08c },
+  { TEST_HEADER L"OFFSET=3c&WIDTH=8&VALUE=00",
+    EFI_DEVICE_ERROR, TEST_NO_PROGRESS, 0x40, 0xcc9d1aec },
+  { TEST_HEADER L"OFFSET=0&WIDTH=1",
+    EFI_INVALID_PARAMETER, 78, 0x40, 0xcc9d1aec },
+  { TEST_HEADER L"OFFSET=0&WIDTH=1&VALUE=12&NAME=1",
+    EFI_INVALID_PARAMETER, 95, 0x0, 0x585419fa },
+  { TEST_HEADER L"OFFSET=0&WIDTH=1&VALUE=1x2",
+    EFI_SUCCESS, 96, 0x0, 0x8c159d19 },
+  { L"NAME=0041&PATH=00&OFFSET=0&WIDTH=1&VALUE=00",
+    EFI_INVALID_PARAMETER, 0, 0x40, 0xcc9d1aec },
+  { L"GUID=00&NAME=0041&PATH=00",
+    EFI_INVALID_PARAMETER, 25, 0x40, 0xcc9d1aec }
+};
+
+//
+// Length and CRC32 of the <ConfigResp> for the 64 KB varstore
+//
+#define TEST_VARSTORE_CONFIG_LENGTH 601853
+#define TEST_VARSTORE_CONFIG_CRC    0xa651a750
+
+static
+VOID
+Check (
+  IN BOOLEAN      Condition,
+  IN CONST CHAR8  *Test,
+  IN CONST CHAR8  *What
+  )
+{
+  if (!Condition) {
+    if (mFailures < 20) {
+      printf ("FAIL %s: %s\n", Test, What);
+    }
+
+    mFailures++;
+  }
+}
+
+static
+UINT32
+Random (
+  VOID
+  )
+{
+  mSeed ^= mSeed << 13;
+  mSeed ^= mSeed >> 17;
+  mSeed ^= mSeed << 5;
+  return mSeed;
+}
+
+static
+UINT32
+Crc32 (
+  IN CONST VOID  *Data,
+  IN UINTN       Size
+  )
+{
+  CONST UINT8 *Byte;
+  UINT32      Crc;
+  UINTN       Bit;
+
+  Crc = 0xFFFFFFFF;
+  for (Byte = Data; Size > 0; Size--, Byte++) {
+    Crc ^= *Byte;
+    for (Bit = 0; Bit < 8; Bit++) {
+      Crc = (Crc >> 1) ^ (0xEDB88320 & (0 - (Crc & 1)));
+    }
+  }
+
+  return ~Crc;
+}
+
+static
+VOID
+PrintString (
+  IN CONST CHAR16  *String
+  )
+{
+  for (; *String != 0; String++) {
+    putchar ((int) *String);
+  }
+}
+
+//
+// Boot services used by the pool and memory helpers
+//
+static
+EFI_STATUS
+EFIAPI
+TestAllocatePool (
+  IN  EFI_MEMORY_TYPE  PoolType,
+  IN  UINTN            Size,
+  OUT VOID             **Buffer
+  )
+{
+  *Buffer = malloc (Size != 0 ? Size : 1);
+  return (*Buffer == NULL) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+}
+
+static
+EFI_STATUS
+EFIAPI
+TestFreePool (
+  IN VOID  *Buffer
+  )
+{
+  free (Buffer);
+  return EFI_SUCCESS;
+}
+
+static
+VOID
+EFIAPI
+TestCopyMem (
+  IN VOID   *Destination,
+  IN VOID   *Source,
+  IN UINTN  Length
+  )
+{
+  memmove (Destination, Source, Length);
+}
+
+static
+VOID
+EFIAPI
+TestSetMem (
+  IN VOID   *Buffer,
+  IN UINTN  Size,
+  IN UINT8  Value
+  )
+{
+  memset (Buffer, Value, Size);
+}
+
+static
+VOID
+InitializeHost (
+  VOID
+  )
+{
+  mBootServices.AllocatePool            = TestAllocatePool;
+  mBootServices.FreePool                = TestFreePool;
+  mBootServices.CopyMem                 = TestCopyMem;
+  mBootServices.SetMem                  = TestSetMem;
+  mPrivate.Signature                    = HII_DATABASE_PRIVATE_DATA_SIGNATURE;
+  mPrivate.ConfigRouting.BlockToConfig  = HiiBlockToConfig;
+  mPrivate.ConfigRouting.ConfigToBlock  = HiiConfigToBlock;
+}
+
+static
+VOID
+FillGolden (
+  OUT UINT8  *Block
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < TEST_GOLDEN_SIZE; Index++) {
+    Block[Index] = (UINT8) (Index * 37 + 11);
+  }
+}
+
+static
+UINTN
+HexValue (
+  IN CONST CHAR16  *String
+  )
+{
+  UINTN Value;
+  UINT8 Digit;
+
+  for (Value = 0; IsHexDigit (&Digit, *String); String++) {
+    Value = (Value << 4) | Digit;
+  }
+
+  return Value;
+}
+
+static
+UINTN
+ProgressOffset (
+  IN CONST CHAR16  *String,
+  IN CONST CHAR16  *Progress
+  )
+{
+  if (Progress == NULL) {
+    return TEST_NO_PROGRESS;
+  }
+
+  return (UINTN) (Progress - String);
+}
+
+static
+VOID
+TestBlockToConfigGolden (
+  VOID
+  )
+{
+  UINT8       Block[TEST_GOLDEN_SIZE];
+  EFI_STRING  Config;
+  EFI_STRING  Progress;
+  EFI_STATUS  Status;
+  UINTN       Index;
+  BOOLEAN     Same;
+  CHAR8       What[64];
+
+  FillGolden (Block);
+  for (Index = 0; Index < sizeof (mBlockToConfig) / sizeof (mBlockToConfig[0]); Index++) {
+    Config    = NULL;
+    Progress  = NULL;
+    Status    = mPrivate.ConfigRouting.BlockToConfig (
+                                         &mPrivate.ConfigRouting,
+                                         mBlockToConfig[Index].Request,
+                                         Block,
+                                         sizeof (Block),
+                                         &Config,
+                                         &Progress
+                                         );
+    if (mRecord) {
+      printf ("BlockToConfig %u: status 0x%llx, progress %u, config ", (unsigned) Index, (unsigned long long) Status, (unsigned) ProgressOffset (mBlockToConfig[Index].Request, Progress));
+      if (EFI_ERROR (Status)) {
+        printf ("NULL\n");
+      } else {
+        PrintString (Config);
+        printf ("\n");
+      }
+    } else {
+      sprintf (What, "request %u", (unsigned) Index);
+      Check (Status == mBlockToConfig[Index].Status, "BlockToConfig", What);
+      Check (ProgressOffset (mBlockToConfig[Index].Request, Progress) == mBlockToConfig[Index].Progress, "BlockToConfig progress", What);
+      if (!EFI_ERROR (Status)) {
+        Same = (BOOLEAN) (mBlockToConfig[Index].Config != NULL && EfiStrCmp (Config, mBlockToConfig[Index].Config) == 0);
+        Check (Same, "BlockToConfig config", What);
+      }
+    }
+
+    if (!EFI_ERROR (Status)) {
+      gBS->FreePool (Config);
+    }
+  }
+}
+
+static
+VOID
+TestConfigToBlockGolden (
+  VOID
+  )
+{
+  UINT8       Block[TEST_GOLDEN_SIZE];
+  EFI_STRING  Progress;
+  EFI_STATUS  Status;
+  UINTN       BlockSize;
+  UINTN       Index;
+  CHAR8       What[64];
+
+  for (Index = 0; Index < sizeof (mConfigToBlock) / sizeof (mConfigToBlock[0]); Index++) {
+    memset (Block, 0xcc, sizeof (Block));
+    BlockSize = sizeof (Block);
+    Progress  = NULL;
+    Status    = mPrivate.ConfigRouting.ConfigToBlock (
+                                         &mPrivate.ConfigRouting,
+                                         mConfigToBlock[Index].Response,
+                                         Block,
+                                         &BlockSize,
+                                         &Progress
+                                         );
+    if (mRecord) {
+      printf (
+        "ConfigToBlock %u: status 0x%llx, progress %d, size 0x%x, crc 0x%08x\n",
+        (unsigned) Index,
+        (unsigned long long) Status,
+        (int) ProgressOffset (mConfigToBlock[Index].Response, Progress),
+        (unsigned) BlockSize,
+        (unsigned) Crc32 (Block, sizeof (Block))
+        );
+    } else {
+      sprintf (What, "response %u", (unsigned) Index);
+      Check (Status == mConfigToBlock[Index].Status, "ConfigToBlock", What);
+      Check (ProgressOffset (mConfigToBlock[Index].Response, Progress) == mConfigToBlock[Index].Progress, "ConfigToBlock progress", What);
+      Check (BlockSize == mConfigToBlock[Index].BlockSize, "ConfigToBlock size", What);
+      Check (Crc32 (Block, sizeof (Block)) == mConfigToBlock[Index].BlockCrc, "ConfigToBlock block", What);
+    }
+  }
+}
+
+static
+EFI_STRING
+BuildRequest (
+  IN  UINTN    BlockSize,
+  IN  UINTN    MaxElements,
+  IN  BOOLEAN  Cover,
+  OUT UINTN    *LastEnd
+  )
+/*++
+
+Routine Description:
+
+  Builds a <ConfigRequest> of random <BlockName> elements. With Cover the
+  elements walk the whole block with the widths a form uses, otherwise
+  they are random, with random case and leading zeros in the numbers.
+
+--*/
+{
+  EFI_STRING  Request;
+  CHAR16      *Ptr;
+  UINTN       Offset;
+  UINTN       Width;
+  UINTN       Count;
+  CHAR8       Element[64];
+  CHAR8       *Source;
+  UINTN       Size;
+
+  Size    = EfiStrLen (TEST_HEADER) + MaxElements * 48 + 1;
+  Request = malloc (Size * sizeof (CHAR16));
+  EfiStrCpy (Request, TEST_HEADER);
+  Ptr       = Request + EfiStrLen (TEST_HEADER);
+  Offset    = 0;
+  *LastEnd  = 0;
+  for (Count = 0; Count < MaxElements; Count++) {
+    if (Cover) {
+      Width = (UINTN) 1 << (Count % 4);
+      if (Offset + Width > BlockSize) {
+        break;
+      }
+    } else {
+      Width   = 1 + Random () % (BlockSize < 32 ? BlockSize : 32);
+      Offset  = Random () % (BlockSize - Width + 1);
+    }
+
+    switch (Cover ? 0 : Random () % 3) {
+    case 0:
+      sprintf (Element, "OFFSET=%x&WIDTH=%x", (unsigned) Offset, (unsigned) Width);
+      break;
+    case 1:
+      sprintf (Element, "OFFSET=%04X&WIDTH=%04X", (unsigned) Offset, (unsigned) Width);
+      break;
+    default:
+      sprintf (Element, "OFFSET=%08x&WIDTH=%X", (unsigned) Offset, (unsigned) Width);
+      break;
+    }
+
+    if (Count != 0) {
+      *Ptr++ = L'&';
+    }
+
+    for (Source = Element; *Source != 0; Source++) {
+      *Ptr++ = (CHAR16) *Source;
+    }
+
+    *LastEnd  = Offset + Width;
+    if (Cover) {
+      Offset += Width;
+    }
+  }
+
+  *Ptr = 0;
+  return Request;
+}
+
+static
+VOID
+TestRoundTrip (
+  VOID
+  )
+{
+  UINT8       *Block;
+  UINT8       *Copy;
+  UINT8       *Covered;
+  EFI_STRING  Request;
+  EFI_STRING  Config;
+  EFI_STRING  Progress;
+  EFI_STRING  Element;
+  UINTN       BlockSize;
+  UINTN       CopySize;
+  UINTN       LastEnd;
+  UINTN       Round;
+  UINTN       Index;
+  UINTN       Offset;
+  UINTN       Width;
+  UINTN       Failed;
+
+  Block   = malloc (4096);
+  Copy    = malloc (4096);
+  Covered = malloc (4096);
+  Failed  = 0;
+  for (Round = 0; Round < 500; Round++) {
+    BlockSize = 1 + Random () % 4096;
+    for (Index = 0; Index < BlockSize; Index++) {
+      Block[Index] = (UINT8) Random ();
+    }
+
+    Request = BuildRequest (BlockSize, 1 + Random () % 40, FALSE, &LastEnd);
+    if (mPrivate.ConfigRouting.BlockToConfig (&mPrivate.ConfigRouting, Request, Block, BlockSize, &Config, &Progress) != EFI_SUCCESS ||
+        *Progress != 0) {
+      Failed++;
+      free (Request);
+      continue;
+    }
+
+    //
+    // Mark the bytes the request covers
+    //
+    memset (Covered, 0, BlockSize);
+    for (Element = EfiStrStr (Request, L"OFFSET="); Element != NULL; Element = EfiStrStr (Element + 1, L"OFFSET=")) {
+      Offset  = HexValue (Element + 7);
+      Width   = HexValue (EfiStrStr (Element, L"WIDTH=") + 6);
+      memset (Covered + Offset, 1, Width);
+    }
+
+    memset (Copy, 0xee, BlockSize);
+    CopySize = BlockSize;
+    if (mPrivate.ConfigRouting.ConfigToBlock (&mPrivate.ConfigRouting, Config, Copy, &CopySize, &Progress) != EFI_SUCCESS ||
+        *Progress != 0 ||
+        CopySize != LastEnd - 1) {
+      Failed++;
+    } else {
+      for (Index = 0; Index < BlockSize; Index++) {
+        if (Copy[Index] != (Covered[Index] ? Block[Index] : 0xee)) {
+          Failed++;
+          break;
+        }
+      }
+    }
+
+    gBS->FreePool (Config);
+    free (Request);
+  }
+
+  Check (Failed == 0, "RoundTrip", "random requests rebuild the requested bytes");
+  free (Block);
+  free (Copy);
+  free (Covered);
+}
+
+static
+VOID
+FillVarstore (
+  OUT UINT8  *Block
+  )
+{
+  UINTN Index;
+
+  mSeed = 0x12345678;
+  for (Index = 0; Index < TEST_VARSTORE_SIZE; Index++) {
+    Block[Index] = (UINT8) Random ();
+  }
+}
+
+static
+VOID
+TestVarstore (
+  VOID
+  )
+{
+  UINT8       *Block;
+  UINT8       *Copy;
+  EFI_STRING  Request;
+  EFI_STRING  Config;
+  EFI_STRING  Progress;
+  EFI_STATUS  Status;
+  UINTN       LastEnd;
+  UINTN       CopySize;
+  UINTN       Length;
+  UINT32      Crc;
+
+  Block = malloc (TEST_VARSTORE_SIZE);
+  Copy  = malloc (TEST_VARSTORE_SIZE);
+  FillVarstore (Block);
+
+  Request = BuildRequest (TEST_VARSTORE_SIZE, TEST_VARSTORE_SIZE, TRUE, &LastEnd);
+  Status  = mPrivate.ConfigRouting.BlockToConfig (&mPrivate.ConfigRouting, Request, Block, TEST_VARSTORE_SIZE, &Config, &Progress);
+  if (EFI_ERROR (Status)) {
+    Check (FALSE, "Varstore", "BlockToConfig of the 64 KB varstore");
+    free (Request);
+    return;
+  }
+
+  Length  = EfiStrLen (Config);
+  Crc     = Crc32 (Config, Length * sizeof (CHAR16));
+  if (mRecord) {
+    printf ("Varstore: length %u, crc 0x%08x\n", (unsigned) Length, (unsigned) Crc);
+  } else {
+    Check (Length == TEST_VARSTORE_CONFIG_LENGTH, "Varstore", "length of the <ConfigResp>");
+    Check (Crc == TEST_VARSTORE_CONFIG_CRC, "Varstore", "CRC32 of the <ConfigResp>");
+  }
+
+  memset (Copy, 0, TEST_VARSTORE_SIZE);
+  CopySize = TEST_VARSTORE_SIZE;
+  Status   = mPrivate.ConfigRouting.ConfigToBlock (&mPrivate.ConfigRouting, Config, Copy, &CopySize, &Progress);
+  Check (Status == EFI_SUCCESS && *Progress == 0, "Varstore", "ConfigToBlock of the 64 KB varstore");
+  Check (CopySize == TEST_VARSTORE_SIZE - 1, "Varstore", "ConfigToBlock reports the last byte");
+  Check (memcmp (Block, Copy, TEST_VARSTORE_SIZE) == 0, "Varstore", "64 KB varstore round trips");
+
+  gBS->FreePool (Config);
+  free (Request);
+  free (Block);
+  free (Copy);
+}
+
+static
+double
+Elapsed (
+  IN clock_t  Start,
+  IN UINTN    Count
+  )
+{
+  return (double) (clock () - Start) * 1000000.0 / CLOCKS_PER_SEC / Count;
+}
+
+static
+VOID
+Benchmark (
+  VOID
+  )
+{
+  UINT8       *Block;
+  EFI_STRING  Request;
+  EFI_STRING  Config;
+  EFI_STRING  Progress;
+  UINTN       LastEnd;
+  UINTN       BlockSize;
+  UINTN       Count;
+  UINTN       Round;
+  clock_t     Start;
+  double      ToConfig;
+  double      ToBlock;
+
+  Block = malloc (TEST_VARSTORE_SIZE);
+  FillVarstore (Block);
+
+  printf ("%-34s %8s %14s %14s\n", "64 KB varstore", "Elements", "BlockToConfig", "ConfigToBlock");
+  for (Round = 0; Round < 2; Round++) {
+    if (Round == 0) {
+      Request = BuildRequest (TEST_VARSTORE_SIZE, TEST_VARSTORE_SIZE, TRUE, &LastEnd);
+      Count   = 0;
+      for (Config = Request; (Config = EfiStrStr (Config, L"OFFSET=")) != NULL; Config++) {
+        Count++;
+      }
+    } else {
+      Request = malloc ((EfiStrLen (TEST_HEADER) + 32) * sizeof (CHAR16));
+      EfiStrCpy (Request, TEST_HEADER);
+      EfiStrCat (Request, L"OFFSET=0&WIDTH=10000");
+      Count = 1;
+    }
+
+    Start = clock ();
+    for (LastEnd = 0; LastEnd < 20; LastEnd++) {
+      mPrivate.ConfigRouting.BlockToConfig (&mPrivate.ConfigRouting, Request, Block, TEST_VARSTORE_SIZE, &Config, &Progress);
+      gBS->FreePool (Config);
+    }
+
+    ToConfig = Elapsed (Start, 20);
+
+    mPrivate.ConfigRouting.BlockToConfig (&mPrivate.ConfigRouting, Request, Block, TEST_VARSTORE_SIZE, &Config, &Progress);
+    Start = clock ();
+    for (LastEnd = 0; LastEnd < 20; LastEnd++) {
+      BlockSize = TEST_VARSTORE_SIZE;
+      mPrivate.ConfigRouting.ConfigToBlock (&mPrivate.ConfigRouting, Config, Block, &BlockSize, &Progress);
+    }
+
+    ToBlock = Elapsed (Start, 20);
+    gBS->FreePool (Config);
+    free (Request);
+
+    printf (
+      "%-34s %8u %11.0f us %11.0f us\n",
+      (Round == 0) ? "Widths 1, 2, 4, 8 over the store" : "One 64 KB element",
+      (unsigned) Count,
+      ToConfig,
+      ToBlock
+      );
+  }
+
+  free (Block);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  InitializeHost ();
+
+  if ((argc > 1) && (strcmp (argv[1], "-b") == 0)) {
+    Benchmark ();
+    return 0;
+  }
+
+  mRecord = (BOOLEAN) ((argc > 1) && (strcmp (argv[1], "-r") == 0));
+
+  TestBlockToConfigGolden ();
+  TestConfigToBlockGolden ();
+  TestVarstore ();
+  if (mRecord) {
+    return 0;
+  }
+
+  TestRoundTrip ();
+
+  if (mFailures != 0) {
+    printf ("ConfigRoutingTest: %u checks failed\n", (unsigned) mFailures);
+    return 1;
+  }
+
+  printf ("ConfigRoutingTest: all checks passed\n");
+  return 0;
+}
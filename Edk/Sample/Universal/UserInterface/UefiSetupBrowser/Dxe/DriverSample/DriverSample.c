@@ -648,6 +648,201 @@ RouteConfig (
   return Status;
 }
 
+STATIC
+BOOLEAN
+IsBlockElementValid (
+  IN  UINTN                                  ElementCount,
+  IN  CONST EFI_HII_BLOCK_ELEMENT            *Element,
+  IN  UINTN                                  BlockSize
+  )
+/*++
+
+  Routine Description:
+    Check that every element fits in both the caller's block and the
+    DRIVER_SAMPLE_CONFIGURATION variable.
+
+  Arguments:
+    ElementCount  - Number of entries in Element.
+    Element       - The (Offset, Width) ranges to check.
+    BlockSize     - Size in bytes of the caller's block.
+
+  Returns:
+    TRUE          - All the elements are in range.
+    FALSE         - At least one element is out of range.
+
+--*/
+{
+  UINTN  Index;
+  UINTN  End;
+
+  for (Index = 0; Index < ElementCount; Index++) {
+    End = (UINTN) Element[Index].Offset + Element[Index].Width;
+    if ((End > BlockSize) || (End > sizeof (DRIVER_SAMPLE_CONFIGURATION))) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+EFI_STATUS
+EFIAPI
+ExtractBlock (
+  IN  EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL   *This,
+  IN  CONST EFI_STRING                       ConfigHdr,
+  IN  UINTN                                  ElementCount,
+  IN  CONST EFI_HII_BLOCK_ELEMENT            *Element,
+  IN OUT UINT8                               *Block,
+  IN  UINTN                                  BlockSize
+  )
+/*++
+
+  Routine Description:
+    This function returns the current settings of the Buffer storage
+    without converting them to a <ConfigResp> string.
+
+  Arguments:
+    This          - Points to the EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL.
+    ConfigHdr     - <ConfigHdr> of the Buffer storage.
+    ElementCount  - Number of entries in Element.
+    Element       - The (Offset, Width) ranges to read.
+    Block         - The storage buffer, only the ranges in Element are updated.
+    BlockSize     - Size in bytes of Block.
+
+  Returns:
+    EFI_SUCCESS           - The requested ranges are copied to Block.
+    EFI_NOT_FOUND         - Routing data doesn't match any storage in this driver.
+    EFI_INVALID_PARAMETER - An element is out of range.
+
+--*/
+{
+  EFI_STATUS                       Status;
+  UINTN                            BufferSize;
+  UINTN                            Index;
+  DRIVER_SAMPLE_PRIVATE_DATA       *PrivateData;
+
+  if ((ConfigHdr == NULL) || (Block == NULL) || ((ElementCount != 0) && (Element == NULL))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsConfigHdrMatch (ConfigHdr, &mFormSetGuid, VariableName)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (!IsBlockElementValid (ElementCount, Element, BlockSize)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  PrivateData = DRIVER_SAMPLE_PRIVATE_FROM_CONFIG_ACCESS_BLOCK (This);
+
+  BufferSize = sizeof (DRIVER_SAMPLE_CONFIGURATION);
+  Status = gRT->GetVariable (
+                  VariableName,
+                  &mFormSetGuid,
+                  NULL,
+                  &BufferSize,
+                  &PrivateData->Configuration
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (Index = 0; Index < ElementCount; Index++) {
+    EfiCopyMem (
+      Block + Element[Index].Offset,
+      (UINT8 *) &PrivateData->Configuration + Element[Index].Offset,
+      Element[Index].Width
+      );
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+RouteBlock (
+  IN  EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL   *This,
+  IN  CONST EFI_STRING                       ConfigHdr,
+  IN  UINTN                                  ElementCount,
+  IN  CONST EFI_HII_BLOCK_ELEMENT            *Element,
+  IN  CONST UINT8                            *Block,
+  IN  UINTN                                  BlockSize
+  )
+/*++
+
+  Routine Description:
+    This function processes the changes of the Buffer storage without
+    parsing a <ConfigResp> string.
+
+  Arguments:
+    This          - Points to the EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL.
+    ConfigHdr     - <ConfigHdr> of the Buffer storage.
+    ElementCount  - Number of entries in Element.
+    Element       - The (Offset, Width) ranges to write.
+    Block         - The storage buffer, only the ranges in Element are used.
+    BlockSize     - Size in bytes of Block.
+
+  Returns:
+    EFI_SUCCESS           - The requested ranges are saved.
+    EFI_NOT_FOUND         - Routing data doesn't match any storage in this driver.
+    EFI_INVALID_PARAMETER - An element is out of range.
+
+--*/
+{
+  EFI_STATUS                       Status;
+  UINTN                            BufferSize;
+  UINTN                            Index;
+  DRIVER_SAMPLE_PRIVATE_DATA       *PrivateData;
+
+  if ((ConfigHdr == NULL) || (Block == NULL) || ((ElementCount != 0) && (Element == NULL))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsConfigHdrMatch (ConfigHdr, &mFormSetGuid, VariableName)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (!IsBlockElementValid (ElementCount, Element, BlockSize)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  PrivateData = DRIVER_SAMPLE_PRIVATE_FROM_CONFIG_ACCESS_BLOCK (This);
+
+  //
+  // Get Buffer Storage data from EFI variable, so that the bytes changed
+  // by the callbacks are kept
+  //
+  BufferSize = sizeof (DRIVER_SAMPLE_CONFIGURATION);
+  Status = gRT->GetVariable (
+                  VariableName,
+                  &mFormSetGuid,
+                  NULL,
+                  &BufferSize,
+                  &PrivateData->Configuration
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (Index = 0; Index < ElementCount; Index++) {
+    EfiCopyMem (
+      (UINT8 *) &PrivateData->Configuration + Element[Index].Offset,
+      (UINT8 *) Block + Element[Index].Offset,
+      Element[Index].Width
+      );
+  }
+
+  Status = gRT->SetVariable(
+                  VariableName,
+                  &mFormSetGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                  sizeof (DRIVER_SAMPLE_CONFIGURATION),
+                  &PrivateData->Configuration
+                  );
+
+  return Status;
+}
+
 EFI_STATUS
 EFIAPI
 DriverCallback (
@@ -949,6 +1144,8 @@ DriverSampleInit (
   PrivateData->ConfigAccess.ExtractConfig = ExtractConfig;
   PrivateData->ConfigAccess.RouteConfig = RouteConfig;
   PrivateData->ConfigAccess.Callback = DriverCallback;
+  PrivateData->ConfigAccessBlock.ExtractBlock = ExtractBlock;
+  PrivateData->ConfigAccessBlock.RouteBlock = RouteBlock;
   PrivateData->PasswordState = BROWSER_STATE_VALIDATE_PASSWORD;
 
   //
@@ -1004,6 +1201,14 @@ DriverSampleInit (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  Status = gBS->InstallProtocolInterface (
+                  &DriverHandle[0],
+                  &gEfiHiiConfigAccessBlockProtocolGuid,
+                  EFI_NATIVE_INTERFACE,
+                  &PrivateData->ConfigAccessBlock
+                  );
+  ASSERT_EFI_ERROR (Status);
+
   //
   // Publish our HII data
   //
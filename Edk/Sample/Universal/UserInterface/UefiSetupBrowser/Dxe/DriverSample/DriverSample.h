@@ -35,6 +35,7 @@ Revision History
 #include EFI_PROTOCOL_CONSUMER (FormBrowser2)
 
 #include EFI_PROTOCOL_PRODUCER (HiiConfigAccess)
+#include EFI_PROTOCOL_PRODUCER (HiiConfigAccessBlock)
 
 #include "NVDataStruc.h"
 
@@ -110,8 +111,11 @@ typedef struct {
   // Produced protocol
   //
   EFI_HII_CONFIG_ACCESS_PROTOCOL   ConfigAccess;
+  EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL  ConfigAccessBlock;
 } DRIVER_SAMPLE_PRIVATE_DATA;
 
 #define DRIVER_SAMPLE_PRIVATE_FROM_THIS(a)  CR (a, DRIVER_SAMPLE_PRIVATE_DATA, ConfigAccess, DRIVER_SAMPLE_PRIVATE_SIGNATURE)
+#define DRIVER_SAMPLE_PRIVATE_FROM_CONFIG_ACCESS_BLOCK(a)  \
+          CR (a, DRIVER_SAMPLE_PRIVATE_DATA, ConfigAccessBlock, DRIVER_SAMPLE_PRIVATE_SIGNATURE)
 
 #endif
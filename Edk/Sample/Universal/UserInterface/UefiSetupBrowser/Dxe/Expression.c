@@ -482,6 +482,271 @@ Returns:
   return NULL;
 }
 
+STATIC
+VOID
+AddExpressionDependency (
+  IN OUT FORM_BROWSER_STATEMENT  *Question,
+  IN FORM_EXPRESSION             *Expression
+  )
+/*++
+
+Routine Description:
+  Record that an Expression references a Question, so that a change of the
+  Question value invalidates the cached result of the Expression.
+
+Arguments:
+  Question    - The Question being referenced.
+  Expression  - The Expression referencing the Question.
+
+Returns:
+  None.
+
+--*/
+{
+  EFI_LIST_ENTRY          *Link;
+  EXPRESSION_DEPENDENCY   *Dependency;
+
+  Link = GetFirstNode (&Question->DependentListHead);
+  while (!IsNull (&Question->DependentListHead, Link)) {
+    Dependency = EXPRESSION_DEPENDENCY_FROM_LINK (Link);
+    if (Dependency->Expression == Expression) {
+      return;
+    }
+
+    Link = GetNextNode (&Question->DependentListHead, Link);
+  }
+
+  Dependency = EfiLibAllocatePool (sizeof (EXPRESSION_DEPENDENCY));
+  if (Dependency == NULL) {
+    //
+    // Without the dependency the result could go stale, never cache it
+    //
+    Expression->Volatile = TRUE;
+    return;
+  }
+
+  Dependency->Signature  = EXPRESSION_DEPENDENCY_SIGNATURE;
+  Dependency->Expression = Expression;
+  InsertTailList (&Question->DependentListHead, &Dependency->Link);
+}
+
+STATIC
+FORM_BROWSER_STATEMENT *
+ResolveQuestionReference (
+  IN FORM_BROWSER_FORMSET  *FormSet,
+  IN FORM_BROWSER_FORM     *Form,
+  IN OUT FORM_EXPRESSION   *Expression,
+  IN UINT16                QuestionId
+  )
+/*++
+
+Routine Description:
+  Resolve a QuestionId referenced by an Expression to the Question it names
+  and record the Expression as a dependent of that Question.
+
+Arguments:
+  FormSet     - The formset which contains this form.
+  Form        - The form which contains this Expression.
+  Expression  - The Expression referencing the Question.
+  QuestionId  - Id of the referenced Question.
+
+Returns:
+  Pointer - The Question.
+  NULL    - The reference has to be resolved by IdToQuestion() at evaluation
+            time, the Expression is marked volatile.
+
+--*/
+{
+  EFI_LIST_ENTRY          *Link;
+  FORM_BROWSER_FORM       *QuestionForm;
+  FORM_BROWSER_STATEMENT  *Question;
+
+  Question = IdToQuestion2 (Form, QuestionId);
+  if (Question == NULL) {
+    Link = GetFirstNode (&FormSet->FormListHead);
+    while (!IsNull (&FormSet->FormListHead, Link)) {
+      QuestionForm = FORM_BROWSER_FORM_FROM_LINK (Link);
+
+      Question = IdToQuestion2 (QuestionForm, QuestionId);
+      if (Question != NULL) {
+        break;
+      }
+
+      Link = GetNextNode (&FormSet->FormListHead, Link);
+    }
+
+    //
+    // IdToQuestion() reloads EFI variable Questions of other forms on every
+    // lookup since Callback() may update them asynchronous, keep doing so.
+    //
+    if ((Question == NULL) ||
+        ((Question->Storage != NULL) && (Question->Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE))) {
+      Expression->Volatile = TRUE;
+      return NULL;
+    }
+  }
+
+  AddExpressionDependency (Question, Expression);
+  return Question;
+}
+
+STATIC
+VOID
+CompileExpression (
+  IN FORM_BROWSER_FORMSET  *FormSet,
+  IN FORM_BROWSER_FORM     *Form,
+  IN OUT FORM_EXPRESSION   *Expression
+  )
+/*++
+
+Routine Description:
+  Resolve the Question references of an Expression to direct pointers and
+  register the Expression as a dependent of each referenced Question.
+
+Arguments:
+  FormSet    - FormSet associated with this expression.
+  Form       - Form associated with this expression.
+  Expression - Expression to be compiled.
+
+Returns:
+  None.
+
+--*/
+{
+  EFI_LIST_ENTRY     *Link;
+  EXPRESSION_OPCODE  *OpCode;
+
+  Link = GetFirstNode (&Expression->OpCodeListHead);
+  while (!IsNull (&Expression->OpCodeListHead, Link)) {
+    OpCode = EXPRESSION_OPCODE_FROM_LINK (Link);
+    Link = GetNextNode (&Expression->OpCodeListHead, Link);
+
+    switch (OpCode->Operand) {
+    case EFI_IFR_EQ_ID_ID_OP:
+      OpCode->Question2 = ResolveQuestionReference (FormSet, Form, Expression, OpCode->QuestionId2);
+      //
+      // Fall through to resolve the first Question
+      //
+    case EFI_IFR_EQ_ID_VAL_OP:
+    case EFI_IFR_EQ_ID_LIST_OP:
+    case EFI_IFR_QUESTION_REF1_OP:
+    case EFI_IFR_THIS_OP:
+      OpCode->Question = ResolveQuestionReference (FormSet, Form, Expression, OpCode->QuestionId);
+      break;
+
+    case EFI_IFR_QUESTION_REF3_OP:
+      if (OpCode->DevicePath != 0) {
+        break;
+      }
+      //
+      // Fall through, EFI_IFR_QUESTION_REF3 takes its QuestionId from the stack
+      //
+    case EFI_IFR_QUESTION_REF2_OP:
+    case EFI_IFR_RULE_REF_OP:
+      //
+      // The referenced Question is only known at evaluation time
+      //
+      Expression->Volatile = TRUE;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  Expression->Compiled    = TRUE;
+  Expression->ResultValid = FALSE;
+}
+
+VOID
+CompileFormSetExpressions (
+  IN OUT FORM_BROWSER_FORMSET  *FormSet
+  )
+/*++
+
+Routine Description:
+  Compile all expressions of a FormSet after its IFR has been parsed, so that
+  EvaluateExpression() uses direct Question pointers and only re-evaluates an
+  expression after a Question it depends on has changed.
+
+Arguments:
+  FormSet    - The FormSet to be compiled.
+
+Returns:
+  None.
+
+--*/
+{
+  EFI_LIST_ENTRY          *FormLink;
+  EFI_LIST_ENTRY          *Link;
+  EFI_LIST_ENTRY          *ExpressionLink;
+  FORM_BROWSER_FORM       *Form;
+  FORM_BROWSER_STATEMENT  *Question;
+
+  FormLink = GetFirstNode (&FormSet->FormListHead);
+  while (!IsNull (&FormSet->FormListHead, FormLink)) {
+    Form = FORM_BROWSER_FORM_FROM_LINK (FormLink);
+    FormLink = GetNextNode (&FormSet->FormListHead, FormLink);
+
+    Link = GetFirstNode (&Form->ExpressionListHead);
+    while (!IsNull (&Form->ExpressionListHead, Link)) {
+      CompileExpression (FormSet, Form, FORM_EXPRESSION_FROM_LINK (Link));
+      Link = GetNextNode (&Form->ExpressionListHead, Link);
+    }
+
+    //
+    // InconsistentIf and NoSubmitIf are queued to their Question instead of the Form
+    //
+    Link = GetFirstNode (&Form->StatementListHead);
+    while (!IsNull (&Form->StatementListHead, Link)) {
+      Question = FORM_BROWSER_STATEMENT_FROM_LINK (Link);
+      Link = GetNextNode (&Form->StatementListHead, Link);
+
+      ExpressionLink = GetFirstNode (&Question->InconsistentListHead);
+      while (!IsNull (&Question->InconsistentListHead, ExpressionLink)) {
+        CompileExpression (FormSet, Form, FORM_EXPRESSION_FROM_LINK (ExpressionLink));
+        ExpressionLink = GetNextNode (&Question->InconsistentListHead, ExpressionLink);
+      }
+
+      ExpressionLink = GetFirstNode (&Question->NoSubmitListHead);
+      while (!IsNull (&Question->NoSubmitListHead, ExpressionLink)) {
+        CompileExpression (FormSet, Form, FORM_EXPRESSION_FROM_LINK (ExpressionLink));
+        ExpressionLink = GetNextNode (&Question->NoSubmitListHead, ExpressionLink);
+      }
+    }
+  }
+}
+
+VOID
+InvalidateQuestionDependents (
+  IN FORM_BROWSER_STATEMENT  *Question
+  )
+/*++
+
+Routine Description:
+  Discard the cached results of all expressions referencing a Question,
+  called whenever the value of the Question may have changed.
+
+Arguments:
+  Question   - The Question whose value changed.
+
+Returns:
+  None.
+
+--*/
+{
+  EFI_LIST_ENTRY          *Link;
+  EXPRESSION_DEPENDENCY   *Dependency;
+
+  Link = GetFirstNode (&Question->DependentListHead);
+  while (!IsNull (&Question->DependentListHead, Link)) {
+    Dependency = EXPRESSION_DEPENDENCY_FROM_LINK (Link);
+    Dependency->Expression->ResultValid = FALSE;
+
+    Link = GetNextNode (&Question->DependentListHead, Link);
+  }
+}
+
 FORM_EXPRESSION *
 RuleIdToExpression (
   IN FORM_BROWSER_FORM  *Form,
@@ -1394,6 +1659,14 @@ Returns:
   INTN                    Result;
   CHAR16                  *StrPtr;
 
+  //
+  // None of the Questions this Expression depends on has changed since
+  // its last evaluation, the result is still valid
+  //
+  if (Expression->Compiled && !Expression->Volatile && Expression->ResultValid) {
+    return EFI_SUCCESS;
+  }
+
   //
   // Always reset the stack before evaluating an Expression
   //
@@ -1420,7 +1693,10 @@ Returns:
     // Built-in functions
     //
     case EFI_IFR_EQ_ID_VAL_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCode->Question;
+      if (Question == NULL) {
+        Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      }
       if (Question == NULL) {
         return EFI_NOT_FOUND;
       }
@@ -1433,12 +1709,18 @@ Returns:
       break;
 
     case EFI_IFR_EQ_ID_ID_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCode->Question;
+      if (Question == NULL) {
+        Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      }
       if (Question == NULL) {
         return EFI_NOT_FOUND;
       }
 
-      Question2 = IdToQuestion (FormSet, Form, OpCode->QuestionId2);
+      Question2 = OpCode->Question2;
+      if (Question2 == NULL) {
+        Question2 = IdToQuestion (FormSet, Form, OpCode->QuestionId2);
+      }
       if (Question2 == NULL) {
         return EFI_NOT_FOUND;
       }
@@ -1451,7 +1733,10 @@ Returns:
       break;
 
     case EFI_IFR_EQ_ID_LIST_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCode->Question;
+      if (Question == NULL) {
+        Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      }
       if (Question == NULL) {
         return EFI_NOT_FOUND;
       }
@@ -1476,7 +1761,10 @@ Returns:
 
     case EFI_IFR_QUESTION_REF1_OP:
     case EFI_IFR_THIS_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCode->Question;
+      if (Question == NULL) {
+        Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      }
       if (Question == NULL) {
         return EFI_NOT_FOUND;
       }
@@ -2006,6 +2294,7 @@ Returns:
   }
 
   EfiCopyMem (&Expression->Result, Value, sizeof (EFI_HII_VALUE));
+  Expression->ResultValid = TRUE;
 
   return EFI_SUCCESS;
 }
@@ -73,6 +73,7 @@ Returns:
   InitializeListHead (&Statement->OptionListHead);
   InitializeListHead (&Statement->InconsistentListHead);
   InitializeListHead (&Statement->NoSubmitListHead);
+  InitializeListHead (&Statement->DependentListHead);
 
   Statement->Signature = FORM_BROWSER_STATEMENT_SIGNATURE;
 
@@ -331,6 +332,7 @@ Returns:
   UINTN            StrSize;
   CHAR16           *NewStr;
   CHAR16           RequestElement[30];
+  EFI_HII_BLOCK_ELEMENT  *NewElement;
 
   Storage = Question->Storage;
   if (Storage == NULL) {
@@ -369,6 +371,27 @@ Returns:
     return EFI_SUCCESS;
   }
 
+  //
+  // Keep a binary copy of the <BlockName> for EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL
+  //
+  if (Storage->Type == EFI_HII_VARSTORE_BUFFER) {
+    if (Storage->ElementCount >= Storage->MaxBlockElement) {
+      NewElement = EfiLibAllocatePool ((Storage->MaxBlockElement + BLOCK_ELEMENT_INCREMENTAL) * sizeof (EFI_HII_BLOCK_ELEMENT));
+      if (NewElement == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+      if (Storage->BlockElement != NULL) {
+        EfiCopyMem (NewElement, Storage->BlockElement, Storage->ElementCount * sizeof (EFI_HII_BLOCK_ELEMENT));
+        gBS->FreePool (Storage->BlockElement);
+      }
+      Storage->BlockElement = NewElement;
+      Storage->MaxBlockElement += BLOCK_ELEMENT_INCREMENTAL;
+    }
+
+    Storage->BlockElement[Storage->ElementCount].Offset = Question->VarStoreInfo.VarOffset;
+    Storage->BlockElement[Storage->ElementCount].Width  = Question->StorageWidth;
+  }
+
   //
   // Append <RequestElement> to <ConfigRequest>
   //
@@ -468,6 +491,7 @@ Returns:
 
   EfiLibSafeFreePool (Storage->ConfigHdr);
   EfiLibSafeFreePool (Storage->ConfigRequest);
+  EfiLibSafeFreePool (Storage->BlockElement);
 
   gBS->FreePool (Storage);
 }
@@ -489,10 +513,11 @@ Returns:
 
 --*/
 {
-  EFI_LIST_ENTRY    *Link;
-  QUESTION_DEFAULT  *Default;
-  QUESTION_OPTION   *Option;
-  FORM_EXPRESSION   *Expression;
+  EFI_LIST_ENTRY        *Link;
+  QUESTION_DEFAULT      *Default;
+  QUESTION_OPTION       *Option;
+  FORM_EXPRESSION       *Expression;
+  EXPRESSION_DEPENDENCY *Dependency;
 
   //
   // Free Default value List
@@ -538,6 +563,17 @@ Returns:
     DestroyExpression (Expression);
   }
 
+  //
+  // Free Dependent Expression List
+  //
+  while (!IsListEmpty (&Statement->DependentListHead)) {
+    Link = GetFirstNode (&Statement->DependentListHead);
+    Dependency = EXPRESSION_DEPENDENCY_FROM_LINK (Link);
+    RemoveEntryList (&Dependency->Link);
+
+    gBS->FreePool (Dependency);
+  }
+
   EfiLibSafeFreePool (Statement->VariableName);
   EfiLibSafeFreePool (Statement->BlockName);
   EfiLibSafeFreePool (Statement->BufferValue);
@@ -1784,5 +1820,11 @@ Returns:
     }
   }
 
+  //
+  // Resolve Question references of the expressions now that all Questions
+  // are known, and build the Question to dependent expression graph
+  //
+  CompileFormSetExpressions (FormSet);
+
   return EFI_SUCCESS;
 }
@@ -887,6 +887,11 @@ SetupBrowser (
           // Clean the String in HII Database
           //
           DeleteString (HiiValue->Value.string, Selection->FormSet->HiiHandle);
+
+          //
+          // The String Id held by the Question value has changed
+          //
+          InvalidateQuestionDependents (Statement);
         }
 
         if (!EFI_ERROR (Status)) {
@@ -367,6 +367,11 @@ Returns:
     DeleteString (QuestionValue->Value.string, Selection->FormSet->HiiHandle);
   }
 
+  //
+  // The String Id held by the Question value has changed
+  //
+  InvalidateQuestionDependents (MenuOption->ThisTag);
+
   return Status;
 }
 
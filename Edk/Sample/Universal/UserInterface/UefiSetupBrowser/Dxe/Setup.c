@@ -1057,8 +1057,9 @@ Returns:
   return Status;
 }
 
+STATIC
 EFI_STATUS
-GetQuestionValue (
+GetQuestionValueWorker (
   IN FORM_BROWSER_FORMSET             *FormSet,
   IN FORM_BROWSER_FORM                *Form,
   IN OUT FORM_BROWSER_STATEMENT       *Question,
@@ -1067,7 +1068,7 @@ GetQuestionValue (
 /*++
 
 Routine Description:
-  Get Question's current Value.
+  Read Question's current Value into HiiValue or BufferValue.
 
 Arguments:
   FormSet    -  FormSet data structure.
@@ -1325,6 +1326,78 @@ Returns:
   return Status;
 }
 
+EFI_STATUS
+GetQuestionValue (
+  IN FORM_BROWSER_FORMSET             *FormSet,
+  IN FORM_BROWSER_FORM                *Form,
+  IN OUT FORM_BROWSER_STATEMENT       *Question,
+  IN BOOLEAN                          Cached
+  )
+/*++
+
+Routine Description:
+  Get Question's current Value. The cached results of the expressions
+  which depend on the Question are dropped if the Value has changed.
+
+Arguments:
+  FormSet    -  FormSet data structure.
+  Form       -  Form data structure.
+  Question   -  Question to be initialized.
+  Cached     -  TRUE:  get from Edit copy
+                FALSE: get from original Storage
+
+Returns:
+  EFI_SUCCESS - The function completed successfully.
+
+--*/
+{
+  EFI_STATUS          Status;
+  EFI_HII_VALUE       OldValue;
+  UINT8               *OldBuffer;
+  BOOLEAN             Changed;
+
+  //
+  // Statement don't have storage, skip them
+  //
+  if (Question->QuestionId == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Keep the old Value to see if it changes. Without memory for a copy
+  // of the buffer, take it as changed.
+  //
+  EfiCopyMem (&OldValue, &Question->HiiValue, sizeof (EFI_HII_VALUE));
+  OldBuffer = NULL;
+  if (Question->BufferValue != NULL) {
+    OldBuffer = EfiLibAllocateCopyPool (Question->StorageWidth, Question->BufferValue);
+  }
+
+  Status = GetQuestionValueWorker (FormSet, Form, Question, Cached);
+
+  Changed = (BOOLEAN) (EfiCompareMem (&OldValue, &Question->HiiValue, sizeof (EFI_HII_VALUE)) != 0);
+  if (Question->BufferValue != NULL) {
+    if (OldBuffer == NULL) {
+      Changed = TRUE;
+    } else if (EfiCompareMem (OldBuffer, Question->BufferValue, Question->StorageWidth) != 0) {
+      Changed = TRUE;
+    }
+  }
+
+  if (OldBuffer != NULL) {
+    gBS->FreePool (OldBuffer);
+  }
+
+  //
+  // Drop the cached results of the expressions which depend on the Value
+  //
+  if (Changed) {
+    InvalidateQuestionDependents (Question);
+  }
+
+  return Status;
+}
+
 EFI_STATUS
 SetQuestionValue (
   IN FORM_BROWSER_FORMSET             *FormSet,
@@ -1374,6 +1447,12 @@ Returns:
     return Status;
   }
 
+  //
+  // Question value is about to change, drop the cached results of the
+  // expressions which depend on it
+  //
+  InvalidateQuestionDependents (Question);
+
   //
   // If Question value is provided by an Expression, then it is read only
   //
@@ -1601,6 +1680,13 @@ Returns:
     return EFI_UNSUPPORTED;
   }
 
+  //
+  // The Question value under validation is edited in place and will be
+  // restored by the caller if validation fails, so neither trust nor keep
+  // the cached results of the expressions which depend on it
+  //
+  InvalidateQuestionDependents (Question);
+
   Link = GetFirstNode (ListHead);
   while (!IsNull (ListHead, Link)) {
     Expression = FORM_EXPRESSION_FROM_LINK (Link);
@@ -1610,6 +1696,7 @@ Returns:
     //
     Status = EvaluateExpression (FormSet, Form, Expression);
     if (EFI_ERROR (Status)) {
+      InvalidateQuestionDependents (Question);
       return Status;
     }
 
@@ -1625,6 +1712,7 @@ Returns:
         gBS->FreePool (PopUp);
       }
 
+      InvalidateQuestionDependents (Question);
       return EFI_NOT_READY;
     }
 
@@ -1725,6 +1813,24 @@ Returns:
       continue;
     }
 
+    //
+    // Send Buffer storage in binary if Configuration Driver supports it
+    //
+    if ((Storage->Type == EFI_HII_VARSTORE_BUFFER) && (FormSet->ConfigAccessBlock != NULL)) {
+      Status = FormSet->ConfigAccessBlock->RouteBlock (
+                                             FormSet->ConfigAccessBlock,
+                                             Storage->ConfigHdr,
+                                             Storage->ElementCount,
+                                             Storage->BlockElement,
+                                             Storage->EditBuffer,
+                                             Storage->Size
+                                             );
+      if (!EFI_ERROR (Status)) {
+        SynchronizeStorage (Storage);
+        continue;
+      }
+    }
+
     //
     // Prepare <ConfigResp>
     //
@@ -1797,6 +1903,12 @@ Returns:
     return Status;
   }
 
+  //
+  // Question value is about to change, drop the cached results of the
+  // expressions which depend on it
+  //
+  InvalidateQuestionDependents (Question);
+
   //
   // There are three ways to specify default value for a Question:
   //  1, use nested EFI_IFR_DEFAULT (highest priority)
@@ -2107,6 +2219,24 @@ Returns:
     return EFI_SUCCESS;
   }
 
+  //
+  // Read Buffer storage in binary if Configuration Driver supports it,
+  // fall back to <ConfigRequest> if it doesn't know this storage
+  //
+  if ((Storage->Type == EFI_HII_VARSTORE_BUFFER) && (FormSet->ConfigAccessBlock != NULL)) {
+    Status = FormSet->ConfigAccessBlock->ExtractBlock (
+                                           FormSet->ConfigAccessBlock,
+                                           Storage->ConfigHdr,
+                                           Storage->ElementCount,
+                                           Storage->BlockElement,
+                                           Storage->EditBuffer,
+                                           Storage->Size
+                                           );
+    if (!EFI_ERROR (Status)) {
+      return EFI_SUCCESS;
+    }
+  }
+
   //
   // Request current settings from Configuration Driver
   //
@@ -2499,6 +2629,21 @@ Returns:
     FormSet->ConfigAccess = NULL;
   }
 
+  //
+  // Configuration Driver may also accept Buffer storage settings in binary
+  //
+  FormSet->ConfigAccessBlock = NULL;
+  if (FormSet->ConfigAccess != NULL) {
+    Status = gBS->HandleProtocol (
+                    DriverHandle,
+                    &gEfiHiiConfigAccessBlockProtocolGuid,
+                    &FormSet->ConfigAccessBlock
+                    );
+    if (EFI_ERROR (Status)) {
+      FormSet->ConfigAccessBlock = NULL;
+    }
+  }
+
   //
   // Parse the IFR binary OpCodes
   //
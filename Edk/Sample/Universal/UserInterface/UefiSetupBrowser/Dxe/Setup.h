@@ -33,6 +33,7 @@ Revision History
 #include EFI_PROTOCOL_DEFINITION (HiiString)
 #include EFI_PROTOCOL_DEFINITION (HiiConfigRouting)
 #include EFI_PROTOCOL_DEFINITION (HiiConfigAccess)
+#include EFI_PROTOCOL_DEFINITION (HiiConfigAccessBlock)
 #include EFI_PROTOCOL_DEFINITION (FormBrowser2)
 
 #include EFI_GUID_DEFINITION (GlobalVariable)
@@ -141,6 +142,11 @@ typedef struct {
 //
 #define CONFIG_REQUEST_STRING_INCREMENTAL  1024
 
+//
+// Incremental number of binary <BlockName>s of Buffer storage
+//
+#define BLOCK_ELEMENT_INCREMENTAL          64
+
 //
 // HII value compare result
 //
@@ -242,6 +248,9 @@ typedef struct {
   CHAR16           *ConfigRequest; // <ConfigRequest> = <ConfigHdr> + <RequestElement>
   UINTN            ElementCount;   // Number of <RequestElement> in the <ConfigRequest>
   UINTN            SpareStrLen;    // Spare length of ConfigRequest string buffer
+
+  EFI_HII_BLOCK_ELEMENT *BlockElement;  // Binary copy of the <BlockName>s in <ConfigRequest>, Buffer storage only
+  UINTN            MaxBlockElement;     // Number of entries allocated for BlockElement
 } FORMSET_STORAGE;
 
 #define FORMSET_STORAGE_FROM_LINK(a)  CR (a, FORMSET_STORAGE, Link, FORMSET_STORAGE_SIGNATURE)
@@ -263,6 +272,9 @@ typedef struct {
   EFI_QUESTION_ID   QuestionId;  // For EFI_IFR_EQ_ID_ID, EFI_IFR_EQ_ID_LIST, EFI_IFR_QUESTION_REF1
   EFI_QUESTION_ID   QuestionId2;
 
+  struct _FORM_BROWSER_STATEMENT *Question;  // QuestionId resolved by CompileFormSetExpressions (), NULL if not resolved
+  struct _FORM_BROWSER_STATEMENT *Question2; // QuestionId2 resolved by CompileFormSetExpressions ()
+
   UINT16            ListLength;  // For EFI_IFR_EQ_ID_LIST
   UINT16            *ValueList;
 
@@ -285,11 +297,26 @@ typedef struct {
 
   EFI_HII_VALUE     Result;          // Expression evaluation result
 
+  BOOLEAN           Compiled;        // Question references resolved and recorded as dependencies
+  BOOLEAN           Volatile;        // Depends on something not tracked as a dependency, never cache Result
+  BOOLEAN           ResultValid;     // Result is up to date with the Questions this expression depends on
+
   EFI_LIST_ENTRY    OpCodeListHead;  // OpCodes consist of this expression (EXPRESSION_OPCODE)
 } FORM_EXPRESSION;
 
 #define FORM_EXPRESSION_FROM_LINK(a)  CR (a, FORM_EXPRESSION, Link, FORM_EXPRESSION_SIGNATURE)
 
+#define EXPRESSION_DEPENDENCY_SIGNATURE  EFI_SIGNATURE_32 ('E', 'X', 'D', 'P')
+
+typedef struct {
+  UINTN             Signature;
+  EFI_LIST_ENTRY    Link;
+
+  FORM_EXPRESSION   *Expression;     // Expression which references the Question owning this node
+} EXPRESSION_DEPENDENCY;
+
+#define EXPRESSION_DEPENDENCY_FROM_LINK(a)  CR (a, EXPRESSION_DEPENDENCY, Link, EXPRESSION_DEPENDENCY_SIGNATURE)
+
 #define QUESTION_DEFAULT_SIGNATURE  EFI_SIGNATURE_32 ('Q', 'D', 'F', 'T')
 
 typedef struct {
@@ -321,7 +348,7 @@ typedef struct {
 #define QUESTION_OPTION_FROM_LINK(a)  CR (a, QUESTION_OPTION, Link, QUESTION_OPTION_SIGNATURE)
 
 #define FORM_BROWSER_STATEMENT_SIGNATURE  EFI_SIGNATURE_32 ('F', 'S', 'T', 'A')
-typedef struct {
+typedef struct _FORM_BROWSER_STATEMENT {
   UINTN                 Signature;
   EFI_LIST_ENTRY        Link;
 
@@ -390,6 +417,7 @@ typedef struct {
   FORM_EXPRESSION       *SuppressExpression; // nesting inside of SuppressIf
   FORM_EXPRESSION       *DisableExpression;  // nesting inside of DisableIf
 
+  EFI_LIST_ENTRY        DependentListHead;   // Expressions referencing this Question (EXPRESSION_DEPENDENCY)
 } FORM_BROWSER_STATEMENT;
 
 #define FORM_BROWSER_STATEMENT_FROM_LINK(a)  CR (a, FORM_BROWSER_STATEMENT, Link, FORM_BROWSER_STATEMENT_SIGNATURE)
@@ -427,6 +455,7 @@ typedef struct {
   EFI_HII_HANDLE                  HiiHandle;
   EFI_HANDLE                      DriverHandle;
   EFI_HII_CONFIG_ACCESS_PROTOCOL  *ConfigAccess;
+  EFI_HII_CONFIG_ACCESS_BLOCK_PROTOCOL *ConfigAccessBlock;  // Optional binary access to Buffer storage
   EFI_DEVICE_PATH_PROTOCOL        *DevicePath;
 
   UINTN                           IfrBinaryLength;
@@ -447,6 +447,11 @@ Returns:
           // Clean the String in HII Database
           //
           DeleteString (HiiValue->Value.string, Selection->FormSet->HiiHandle);
+
+          //
+          // The String Id held by the Question value has changed
+          //
+          InvalidateQuestionDependents (Question);
         }
 
         if (!EFI_ERROR (Status)) {
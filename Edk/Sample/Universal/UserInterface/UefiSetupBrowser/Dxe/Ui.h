@@ -516,4 +516,16 @@ EvaluateExpression (
   )
 ;
 
+VOID
+CompileFormSetExpressions (
+  IN OUT FORM_BROWSER_FORMSET  *FormSet
+  )
+;
+
+VOID
+InvalidateQuestionDependents (
+  IN FORM_BROWSER_STATEMENT  *Question
+  )
+;
+
 #endif // _UI_H
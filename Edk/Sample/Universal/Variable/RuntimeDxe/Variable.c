@@ -386,7 +386,9 @@ Reclaim (
   IN  EFI_PHYSICAL_ADDRESS  VariableBase,
   OUT UINTN                 *LastVariableOffset,
   IN  BOOLEAN               IsVolatile,
-  IN  VARIABLE_HEADER       *CurrentVariable OPTIONAL
+  IN  VARIABLE_HEADER       *CurrentVariable OPTIONAL,
+  IN  VARIABLE_HEADER       *NewVariable OPTIONAL,
+  IN  UINTN                 NewVariableSize
   )
 /*++
 
@@ -402,9 +404,17 @@ Arguments:
                               if it is non-volatile, need FTW
   CurrentVairable             If it is not NULL, it means not to process
                               current variable for Reclaim.
+  NewVariable                 If it is not NULL, a variable to append to the
+                              reclaimed store in place of CurrentVariable.
+                              For the non-volatile store it is written in the
+                              same FTW update.
+  NewVariableSize             The size of NewVariable, including pad bytes
 
 Returns:
 
+  EFI_OUT_OF_RESOURCES        NewVariable does not fit in the reclaimed store,
+                              the store is reclaimed without it and keeps
+                              CurrentVariable
   EFI STATUS
 
 --*/
@@ -416,7 +426,10 @@ Returns:
   UINTN                 ValidBufferSize;
   UINTN                 VariableSize;
   UINT8                 *CurrPtr;
+  UINT8                 *CurrentCopy;
+  UINTN                 CurrentCopySize;
   EFI_STATUS            Status;
+  EFI_STATUS            AppendStatus;
 
   VariableStoreHeader = (VARIABLE_STORE_HEADER *) ((UINTN) VariableBase);
 
@@ -455,6 +468,8 @@ Returns:
   Variable = (VARIABLE_HEADER *) (VariableStoreHeader + 1);
   
   ValidBufferSize = sizeof (VARIABLE_STORE_HEADER);
+  CurrentCopy     = NULL;
+  CurrentCopySize = 0;
   while (IsValidVariableHeader (Variable)) {
     NextVariable = GetNextVariablePtr (Variable);
     //
@@ -479,6 +494,9 @@ Returns:
         //
         if (Variable != CurrentVariable){
           ((VARIABLE_HEADER *)CurrPtr)->State = VAR_ADDED;
+        } else {
+          CurrentCopy     = CurrPtr;
+          CurrentCopySize = VariableSize;
         }
         CurrPtr += VariableSize;
         ValidBufferSize += VariableSize;
@@ -487,13 +505,41 @@ Returns:
     Variable = NextVariable;
   }
 
+  //
+  // The new variable goes right after the valid ones, if there is room.
+  // It is written together with the reclaimed store, so the copy of
+  // CurrentVariable kept in delete transition is not needed any more.
+  //
+  AppendStatus = EFI_SUCCESS;
+  if (NewVariable != NULL) {
+    if ((ValidBufferSize - CurrentCopySize + NewVariableSize) > VariableStoreHeader->Size) {
+      NewVariable     = NULL;
+      NewVariableSize = 0;
+      AppendStatus    = EFI_OUT_OF_RESOURCES;
+    } else if (CurrentCopy != NULL) {
+      EfiCopyMem (
+        CurrentCopy,
+        CurrentCopy + CurrentCopySize,
+        (UINTN) (CurrPtr - CurrentCopy) - CurrentCopySize
+        );
+      CurrPtr         -= CurrentCopySize;
+      ValidBufferSize -= CurrentCopySize;
+      EfiSetMem (CurrPtr, CurrentCopySize, 0xff);
+    }
+  } else {
+    NewVariableSize = 0;
+  }
+
   if (IsVolatile) {
     //
     // If volatile variable store, just copy valid buffer
     //
     EfiSetMem ((UINT8 *) (UINTN) VariableBase, VariableStoreHeader->Size, 0xff);
     EfiCopyMem ((UINT8 *) (UINTN) VariableBase, ValidBuffer, ValidBufferSize);
-    *LastVariableOffset = ValidBufferSize;
+    if (NewVariable != NULL) {
+      EfiCopyMem ((UINT8 *) (UINTN) VariableBase + ValidBufferSize, NewVariable, NewVariableSize);
+    }
+    *LastVariableOffset = ValidBufferSize + NewVariableSize;
     Status              = EFI_SUCCESS;
   } else {
     //
@@ -502,10 +548,12 @@ Returns:
     Status = FtwVariableSpace (
               VariableBase,
               ValidBuffer,
-              ValidBufferSize
+              ValidBufferSize,
+              (UINT8 *) NewVariable,
+              NewVariableSize
               );
     if (!EFI_ERROR (Status)) {
-      *LastVariableOffset = ValidBufferSize;
+      *LastVariableOffset = ValidBufferSize + NewVariableSize;
     }
   }
 
@@ -513,9 +561,10 @@ Returns:
 
   if (EFI_ERROR (Status)) {
     *LastVariableOffset = 0;
+    return Status;
   }
 
-  return Status;
+  return AppendStatus;
 }
 
 EFI_STATUS
@@ -1084,22 +1133,20 @@ Returns:
         return EFI_OUT_OF_RESOURCES;
       }
       //
-      // Perform garbage collection & reclaim operation
+      // Perform garbage collection & reclaim operation. The new variable
+      // replaces the old one in the same fault tolerant update, instead of
+      // the three steps below. If still no enough space, Reclaim returns
+      // out of resources.
       //
-      Status = Reclaim (Global->NonVolatileVariableBase, NonVolatileOffset, FALSE, Variable.CurrPtr);
-      if (EFI_ERROR (Status)) {
-        return Status;
-      }
-      //
-      // If still no enough space, return out of resources
-      //
-      if ((UINT32) (VarSize +*NonVolatileOffset) >
-            ((VARIABLE_STORE_HEADER *) ((UINTN) (Global->NonVolatileVariableBase)))->Size
-            ) {
-        return EFI_OUT_OF_RESOURCES;
-      }
-      
-      Reclaimed = TRUE;
+      NextVariable->State = VAR_ADDED;
+      return Reclaim (
+               Global->NonVolatileVariableBase,
+               NonVolatileOffset,
+               FALSE,
+               Variable.CurrPtr,
+               NextVariable,
+               VarSize
+               );
     }
     //
     // Three steps
@@ -1169,7 +1216,7 @@ Returns:
       //
       // Perform garbage collection & reclaim operation
       //
-      Status = Reclaim (Global->VolatileVariableBase, VolatileOffset, TRUE, Variable.CurrPtr);
+      Status = Reclaim (Global->VolatileVariableBase, VolatileOffset, TRUE, Variable.CurrPtr, NULL, 0);
       if (EFI_ERROR (Status)) {
         return Status;
       }
@@ -1397,7 +1444,9 @@ ReclaimForOS(
               mVariableModuleGlobal->VariableBase[Physical].NonVolatileVariableBase,
               &mVariableModuleGlobal->NonVolatileLastVariableOffset,
               FALSE,
-              NULL
+              NULL,
+              NULL,
+              0
               );
     ASSERT(!EFI_ERROR(Status));
   }
@@ -1640,7 +1689,9 @@ Returns:
                   mVariableModuleGlobal->VariableBase[Physical].NonVolatileVariableBase,
                   &mVariableModuleGlobal->NonVolatileLastVariableOffset,
                   FALSE,
-                  NULL
+                  NULL,
+                  NULL,
+                  0
                   );
         break;
       }
@@ -158,17 +158,23 @@ EFI_STATUS
 FtwVariableSpace (
   IN EFI_PHYSICAL_ADDRESS   VariableBase,
   IN UINT8                  *Buffer,
-  IN UINTN                  BufferSize
+  IN UINTN                  BufferSize,
+  IN UINT8                  *Variable OPTIONAL,
+  IN UINTN                  VariableSize
   )
 /*++
 
 Routine Description:
-    Write a buffer to Variable space, in the working block.
+    Write a buffer to Variable space, in the working block. A variable
+    appended to the buffer is written in the same fault tolerant update.
 
 Arguments:
-    FvbHandle        - Indicates a handle to FVB to access variable store
-    Buffer           - Point to the input buffer
+    VariableBase     - Base address of the variable store
+    Buffer           - Point to the input buffer. It is as large as the
+                       variable store and erased after BufferSize bytes.
     BufferSize       - The number of bytes of the input Buffer
+    Variable         - The variable to write after BufferSize bytes, or NULL
+    VariableSize     - The number of bytes of the Variable
 
 Returns:
     EFI_SUCCESS            - The function completed successfully
@@ -177,13 +183,15 @@ Returns:
 
 --*/
 {
-  EFI_STATUS            Status;
-  EFI_HANDLE            FvbHandle;
-  EFI_FTW_LITE_PROTOCOL *FtwLiteProtocol;
-  EFI_LBA               VarLba;
-  UINTN                 VarOffset;
-  UINT8                 *FtwBuffer;
-  UINTN                 FtwBufferSize;
+  EFI_STATUS                      Status;
+  EFI_HANDLE                      FvbHandle;
+  EFI_FTW_LITE_PROTOCOL           *FtwLiteProtocol;
+  EFI_FTW_LITE_MULTIPLE_PROTOCOL  *FtwLiteMultipleProtocol;
+  EFI_FTW_LITE_WRITE_DATA         Writes[2];
+  EFI_LBA                         VarLba;
+  UINTN                           VarOffset;
+  UINT8                           *FtwBuffer;
+  UINTN                           FtwBufferSize;
 
   //
   // Locate fault tolerant write protocol
@@ -210,17 +218,47 @@ Returns:
   if (EFI_ERROR (Status)) {
     return EFI_ABORTED;
   }
+
+  FtwBufferSize = ((VARIABLE_STORE_HEADER *) ((UINTN) VariableBase))->Size;
+
+  //
+  // If the FTW driver takes several writes at once, write the store and the
+  // variable straight from the callers' buffers
+  //
+  Status = gBS->LocateProtocol (
+                  &gEfiFaultTolerantWriteLiteMultipleProtocolGuid,
+                  NULL,
+                  &FtwLiteMultipleProtocol
+                  );
+  if (!EFI_ERROR (Status)) {
+    Writes[0].Offset    = VarOffset;
+    Writes[0].NumBytes  = FtwBufferSize;
+    Writes[0].Buffer    = Buffer;
+    Writes[1].Offset    = VarOffset + BufferSize;
+    Writes[1].NumBytes  = VariableSize;
+    Writes[1].Buffer    = Variable;
+
+    return FtwLiteMultipleProtocol->WriteMultiple (
+                                      FtwLiteMultipleProtocol,
+                                      FvbHandle,
+                                      VarLba,
+                                      (Variable != NULL) ? 2 : 1,
+                                      Writes
+                                      );
+  }
   //
   // Prepare for the variable data
   //
-  FtwBufferSize = ((VARIABLE_STORE_HEADER *) ((UINTN) VariableBase))->Size;
-  Status        = gBS->AllocatePool (EfiRuntimeServicesData, FtwBufferSize, &FtwBuffer);
+  Status = gBS->AllocatePool (EfiRuntimeServicesData, FtwBufferSize, &FtwBuffer);
   if (EFI_ERROR (Status)) {
     return EFI_OUT_OF_RESOURCES;
   }
 
   EfiSetMem (FtwBuffer, FtwBufferSize, (UINT8) 0xff);
   EfiCopyMem (FtwBuffer, Buffer, BufferSize);
+  if (Variable != NULL) {
+    EfiCopyMem (FtwBuffer + BufferSize, Variable, VariableSize);
+  }
 
   //
   // FTW write record
@@ -34,6 +34,7 @@ Revision History
 #include EFI_ARCH_PROTOCOL_DEFINITION (Variable)
 #include EFI_PROTOCOL_DEFINITION (FirmwareVolumeBlock)
 #include EFI_PROTOCOL_DEFINITION (FaultTolerantWriteLite)
+#include EFI_PROTOCOL_DEFINITION (FaultTolerantWriteLiteMultiple)
 
 //
 // Functions
@@ -49,7 +50,9 @@ EFI_STATUS
 FtwVariableSpace (
   IN EFI_PHYSICAL_ADDRESS   VariableBaseAddress,
   IN UINT8                  *Buffer,
-  IN UINTN                  BufferSize
+  IN UINTN                  BufferSize,
+  IN UINT8                  *Variable OPTIONAL,
+  IN UINTN                  VariableSize
   )
 ;
 